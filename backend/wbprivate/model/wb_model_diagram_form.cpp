@@ -482,6 +482,9 @@ void ModelDiagramForm::attach_canvas_view(mdc::CanvasView *cview) {
                  std::bind(&ModelDiagramForm::selection_changed, this));
 
   _main_layer = _view->get_current_layer();
+  // The diagram is usually scrolled and edited in small parts, which the tiles of the main layer save from
+  // rendering everything again.
+  _main_layer->set_tile_cache_enabled(true);
   _badge_layer = _view->new_layer("badges");
   _floater_layer = _view->new_layer("floater");
 
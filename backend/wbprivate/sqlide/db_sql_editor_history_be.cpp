@@ -21,7 +21,6 @@
  * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
  */
 
-#include <fstream>
 #include <glib/gstdio.h>
 #include <stdlib.h>
 
@@ -36,8 +35,6 @@
 #include "base/util_functions.h"
 #include "base/log.h"
 #include "base/file_utilities.h"
-#include "base/scope_exit_trigger.h"
-#include "base/xml_functions.h"
 
 #include "mforms/utilities.h"
 
@@ -48,11 +45,20 @@ using namespace grt;
 using namespace base;
 
 const char *SQL_HISTORY_DIR_NAME = "sql_history";
+const char *SQL_HISTORY_STORE_NAME = "sql_history.db";
 
 DbSqlEditorHistory::DbSqlEditorHistory() : _current_entry_index(-1) {
+  std::string store_path = base::makePath(bec::GRTManager::get()->get_user_datadir(), SQL_HISTORY_STORE_NAME);
+  try {
+    _store = std::make_shared<SqlHistoryStore>(store_path);
+  } catch (const std::exception &exc) {
+    // Keep the history of this session at least, so the editor stays usable.
+    logError("Can't open SQL history store %s: %s\n", store_path.c_str(), exc.what());
+    _store = std::make_shared<SqlHistoryStore>(":memory:");
+  }
+
   _entries_model = EntriesModel::create(this);
   _details_model = DetailsModel::create();
-  _write_only_details_model = DetailsModel::create();
   load();
 }
 
@@ -69,9 +75,10 @@ void DbSqlEditorHistory::load() {
   _entries_model->load();
 }
 
-void DbSqlEditorHistory::add_entry(const std::list<std::string> &statements) {
+void DbSqlEditorHistory::add_entry(const std::list<std::string> &statements, const std::string &schema,
+                                   const std::string &connection) {
   size_t old_date_count = _details_model->count();
-  _entries_model->add_statements(statements);
+  _entries_model->add_statements(statements, schema, connection);
 
   if (_entries_model->get_ui_usage()) {
     _entries_model->refresh_ui();
@@ -83,10 +90,8 @@ void DbSqlEditorHistory::add_entry(const std::list<std::string> &statements) {
 void DbSqlEditorHistory::current_entry(int index) {
   if (index < 0)
     _details_model->reset();
-  else {
-    update_timestamp(_entries_model->entry_date(index));
-    _details_model->load(_entries_model->entry_path(index));
-  }
+  else
+    _details_model->load(*_store, _entries_model->entry_day(index));
 
   _current_entry_index = index;
 
@@ -105,7 +110,7 @@ std::string DbSqlEditorHistory::restore_sql_from_history(int entry_index, std::l
       details_model = _details_model;
     else {
       details_model = DetailsModel::create();
-      details_model->load(_entries_model->entry_path(entry_index));
+      details_model->load(*_store, _entries_model->entry_day(entry_index));
     }
     std::string statement;
     for (int row : detail_indexes) {
@@ -116,6 +121,21 @@ std::string DbSqlEditorHistory::restore_sql_from_history(int entry_index, std::l
   return sql;
 }
 
+/**
+ * Searches the entire history for statements containing all the given keywords, optionally restricted to a schema
+ * and/or connection. Returns the requested page of the results, newest first.
+ */
+std::vector<SqlHistoryStore::Entry> DbSqlEditorHistory::search(const std::string &keywords, const std::string &schema,
+                                                               const std::string &connection, std::size_t offset,
+                                                               std::size_t limit) {
+  try {
+    return _store->search(keywords, schema, connection, offset, limit);
+  } catch (const std::exception &exc) {
+    logError("Error searching the SQL history for \"%s\": %s\n", keywords.c_str(), exc.what());
+  }
+  return {};
+}
+
 //------------------------------
 
 DbSqlEditorHistory::EntriesModel::EntriesModel(DbSqlEditorHistory *owner)
@@ -136,76 +156,69 @@ void DbSqlEditorHistory::EntriesModel::reset() {
 }
 
 void DbSqlEditorHistory::EntriesModel::load() {
-  std::string sql_history_dir = base::makePath(bec::GRTManager::get()->get_user_datadir(), SQL_HISTORY_DIR_NAME);
-  g_mkdir_with_parents(sql_history_dir.c_str(), 0700);
-  {
-    GError *error = NULL;
-    GDir *dir = g_dir_open(sql_history_dir.c_str(), 0, &error);
-    if (!dir) {
-      grt::GRT::get()->send_error(_("Can't open SQL history directory"),
-                                  (error ? error->message : sql_history_dir.c_str()));
-      return;
-    }
-    // files are not read in alpha-order, so we need to sort them before inserting
-    std::set<std::string> entries;
-    base::ScopeExitTrigger on_scope_exit(std::bind(&g_dir_close, dir));
-    while (const char *name_ = g_dir_read_name(dir)) {
-      // file name is expected in "YYYY-MM-DD" format
-      std::string name(name_);
-      if (name.size() != 10)
-        continue;
-      name[4] = '\0';
-      name[7] = '\0';
-      entries.insert(name);
-    }
+  SqlHistoryStore &store = *_owner->_store;
+  try {
+    // Takes over the history of older versions, which was kept in one XML file per day.
+    store.import_directory(base::makePath(bec::GRTManager::get()->get_user_datadir(), SQL_HISTORY_DIR_NAME));
+  } catch (const std::exception &exc) {
+    logError("Error importing the SQL history files: %s\n", exc.what());
+  }
 
-    for (std::set<std::string>::const_iterator name = entries.begin(); name != entries.end(); ++name) {
-      tm t;
-      memset(&t, 0, sizeof(t));
-      t.tm_year = base::atoi<int>(&(*name)[0], 0) - 1900;
-      t.tm_mon = base::atoi<int>(&(*name)[5], 0) - 1;
-      t.tm_mday = base::atoi<int>(&(*name)[8], 0);
-      if (t.tm_year != 0)
-        insert_entry(t);
-    }
+  std::vector<std::string> days;
+  try {
+    days = store.days();
+  } catch (const std::exception &exc) {
+    grt::GRT::get()->send_error(_("Can't read the SQL history"), exc.what());
+    return;
   }
+
+  // Days come newest first, but entries are inserted at the top.
+  for (auto day = days.rbegin(); day != days.rend(); ++day)
+    insert_entry(*day);
 }
 
-void DbSqlEditorHistory::EntriesModel::add_statements(const std::list<std::string> &statements) {
+void DbSqlEditorHistory::EntriesModel::add_statements(const std::list<std::string> &statements,
+                                                      const std::string &schema, const std::string &connection) {
   if (statements.empty())
     return;
 
   std::tm timestamp = local_timestamp();
-  bool new_date = insert_entry(timestamp);
-
+  std::string day = format_time(timestamp, "%Y-%m-%d");
   std::string time = format_time(timestamp, "%X");
-  std::list<std::string> timed_statements;
 
-  for (std::string statement : statements) {
-    timed_statements.push_back(time);
-    timed_statements.push_back(base::strip_text(statement));
-  }
+  std::list<std::string> stripped_statements;
+  for (const std::string &statement : statements)
+    stripped_statements.push_back(base::strip_text(statement));
 
-  if (new_date) {
+  if (insert_entry(day)) {
     refresh_ui();
     _owner->current_entry((int)_row_count - 1);
-    _owner->update_timestamp(timestamp);
   }
 
-  if (_ui_usage)
+  // Stored only after switching to a new day above, which loads the entries of that day already in the store.
+  try {
+    _owner->_store->add_entries(day, time, stripped_statements, schema, connection);
+  } catch (const std::exception &exc) {
+    grt::GRT::get()->send_error("Can't write to the SQL history", exc.what());
+  }
+
+  if (_ui_usage) {
+    std::list<std::string> timed_statements;
+    for (const std::string &statement : stripped_statements) {
+      timed_statements.push_back(time);
+      timed_statements.push_back(statement);
+    }
     _owner->details_model()->add_entries(timed_statements);
-  else
-    _owner->write_only_details_model()->add_entries(timed_statements);
+  }
 }
 
-bool DbSqlEditorHistory::EntriesModel::insert_entry(const std::tm &t) {
+bool DbSqlEditorHistory::EntriesModel::insert_entry(const std::string &day) {
   std::string newest_date;
   if (_row_count > 0)
     get_field(NodeId(0), 0, newest_date);
-  std::string date = format_time(t, "%Y-%m-%d");
-  if (date != newest_date) {
+  if (day != newest_date) {
     base::RecMutexLock data_mutex(_data_mutex);
-    _data.insert(_data.begin(), date);
+    _data.insert(_data.begin(), day);
     ++_row_count;
     ++_data_frame_end;
     return true;
@@ -256,11 +269,19 @@ void DbSqlEditorHistory::EntriesModel::delete_all_entries() {
         "Delete All", "Cancel", "") == mforms::ResultCancel)
     return;
 
-  std::vector<std::size_t> rows;
-  rows.reserve(_row_count);
-  for (RowId row = 0; row < _row_count; ++row)
-    rows.push_back(row);
-  delete_entries(rows);
+  try {
+    _owner->_store->delete_all();
+  } catch (const std::exception &exc) {
+    logError("Error deleting the SQL history: %s\n", exc.what());
+  }
+  {
+    base::RecMutexLock data_mutex(_data_mutex);
+    _data.clear();
+    _row_count = 0;
+    _data_frame_end = 0;
+  }
+  refresh_ui();
+  _owner->current_entry(-1);
 }
 
 void DbSqlEditorHistory::EntriesModel::delete_entries(const std::vector<std::size_t> &rows) {
@@ -271,9 +292,9 @@ void DbSqlEditorHistory::EntriesModel::delete_entries(const std::vector<std::siz
     std::sort(sorted_rows.begin(), sorted_rows.end());
     BOOST_REVERSE_FOREACH(size_t row, sorted_rows) {
       try {
-        base::remove(entry_path(row));
+        _owner->_store->delete_day(entry_day(row));
       } catch (const std::exception &exc) {
-        logError("Error deleting log entry %s: %s\n", entry_path(row).c_str(), exc.what());
+        logError("Error deleting log entry %s: %s\n", entry_day(row).c_str(), exc.what());
       }
       Cell row_begin = _data.begin() + row * _column_count;
       _data.erase(row_begin, row_begin + _column_count);
@@ -284,25 +305,10 @@ void DbSqlEditorHistory::EntriesModel::delete_entries(const std::vector<std::siz
   _owner->current_entry(-1);
 }
 
-std::string DbSqlEditorHistory::EntriesModel::entry_path(std::size_t index) {
-  std::string name;
-  get_field(index, 0, name);
-  std::string storage_file_path = base::makePath(bec::GRTManager::get()->get_user_datadir(), SQL_HISTORY_DIR_NAME);
-  storage_file_path = base::makePath(storage_file_path, name);
-  return storage_file_path;
-}
-
-std::tm DbSqlEditorHistory::EntriesModel::entry_date(std::size_t index) {
-  tm t;
-  std::string name;
-  get_field(index, 0, name);
-
-  memset(&t, 0, sizeof(t));
-  t.tm_year = base::atoi<int>(&name[0], 0) - 1900;
-  t.tm_mon = base::atoi<int>(&name[5], 0) - 1;
-  t.tm_mday = base::atoi<int>(&name[8], 0);
-
-  return t;
+std::string DbSqlEditorHistory::EntriesModel::entry_day(std::size_t index) {
+  std::string day;
+  get_field(index, 0, day);
+  return day;
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -318,10 +324,8 @@ DbSqlEditorHistory::DetailsModel::DetailsModel() : VarGridModel() {
 void DbSqlEditorHistory::DetailsModel::reset() {
   VarGridModel::reset();
 
-  _last_loaded_row = -1;
   _last_timestamp = std::string("");
   _last_statement = std::string("");
-  _datestamp = local_timestamp();
 
   _readonly = true;
 
@@ -334,125 +338,29 @@ void DbSqlEditorHistory::DetailsModel::reset() {
   refresh_ui();
 }
 
-void DbSqlEditorHistory::DetailsModel::load(const std::string &storage_file_path) {
-  if (base::file_exists(storage_file_path)) {
-    std::ifstream historyXml(storage_file_path);
-    if (historyXml.is_open()) {
-      std::string line;
-
-      // Skips the first line in the file as is the xml header
-      std::getline(historyXml, line);
-      _row_count = 0;
-
-      base::RecMutexLock data_mutex(_data_mutex);
-      _data.clear();
-      _data.reserve(_data.size() + _column_count);
-      while (historyXml.good()) {
-        std::getline(historyXml, line);
-
-        if (line.empty())
-          continue;
-
-        xmlDocPtr xmlDoc = base::xml::xmlParseFragment(line);
-        if (xmlDoc == nullptr) {
-          logError("Can't parse %s, of file: %s\n", line.c_str(), storage_file_path.c_str());
-          continue;
-        }
-
-        // In history we've got one element per line.
-        auto element = xmlDoc->children;
-        if (element->next !=
-            nullptr) // If there's something more, we log proper information and parse only that one element.
-          logError("History line contains too many elements %s, of file: %s\n", line.c_str(),
-                   storage_file_path.c_str());
-
-        std::string timestamp = base::xml::getProp(element, "timestamp");
-        std::string statement = base::xml::getContent(element);
-        // decides whether to use or not the existing data
-        if (timestamp != _last_timestamp.toString() && timestamp != "~")
-          _last_timestamp = timestamp;
-
-        if (statement != _last_statement.toString() && statement != "~")
-          _last_statement = statement;
-
-        _data.push_back(_last_statement);
-        _data.push_back(_last_timestamp);
-
-        _row_count++;
-
-        xmlFree(xmlDoc);
-      }
-
-      std::reverse(_data.begin(), _data.end());
-
-      _data_frame_end = _row_count;
-
-      _last_loaded_row = (int)_row_count - 1;
-    }
-  } else
-    logError("Can't open SQL history file %s\n", storage_file_path.c_str());
-}
-
-std::string DbSqlEditorHistory::DetailsModel::storage_file_path() const {
-  std::string storage_file_path = base::makePath(bec::GRTManager::get()->get_user_datadir(), SQL_HISTORY_DIR_NAME);
-  storage_file_path = base::makePath(storage_file_path, format_time(_datestamp, "%Y-%m-%d"));
-  return storage_file_path;
-}
-
-void DbSqlEditorHistory::DetailsModel::save() {
-  std::string storage_file_path = this->storage_file_path();
-  std::ofstream ofs;
-  {
-    std::string storage_file_dir = base::makePath(bec::GRTManager::get()->get_user_datadir(), SQL_HISTORY_DIR_NAME);
-    if (g_mkdir_with_parents(storage_file_dir.c_str(), 0700) != -1) {
-      bool is_file_new = (g_file_test(storage_file_path.c_str(), G_FILE_TEST_EXISTS) == 0);
-      if (is_file_new || g_file_test(storage_file_path.c_str(), G_FILE_TEST_IS_REGULAR)) {
-        ofs.open(base::path_from_utf8(storage_file_path).c_str(), std::ios_base::app);
-        if (is_file_new)
-          ofs << "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n";
-      }
-    }
+void DbSqlEditorHistory::DetailsModel::load(SqlHistoryStore &store, const std::string &day) {
+  std::vector<SqlHistoryStore::Entry> entries;
+  try {
+    entries = store.entries(day);
+  } catch (const std::exception &exc) {
+    logError("Can't load the SQL history of %s: %s\n", day.c_str(), exc.what());
   }
 
-  if (!ofs.is_open() || !ofs) {
-    grt::GRT::get()->send_error("Can't write to SQL history file", storage_file_path);
-    return;
+  base::RecMutexLock data_mutex(_data_mutex);
+  _data.clear();
+  _data.reserve(entries.size() * _column_count);
+  for (const SqlHistoryStore::Entry &entry : entries) {
+    // Shares the values of consecutive rows, which repeat a lot.
+    if (entry.time != _last_timestamp.toString())
+      _last_timestamp = entry.time;
+    if (entry.statement != _last_statement.toString())
+      _last_statement = entry.statement;
+
+    _data.push_back(_last_timestamp);
+    _data.push_back(_last_statement);
   }
-
-  {
-
-    base::RecMutexLock data_mutex(_data_mutex);
-    std::reverse(_data.begin(), _data.end());
-    std::string last_saved_timestamp;
-    std::string last_saved_statement;
-    get_field(NodeId(_last_loaded_row), 1, last_saved_timestamp);
-    get_field(NodeId(_last_loaded_row), 0, last_saved_statement);
-
-    for (RowId row = _last_loaded_row + 1; row < _row_count; ++row) {
-      std::string time, sql;
-      get_field(NodeId((int)row), 1, time);
-      get_field(NodeId((int)row), 0, sql);
-
-      if (time == last_saved_timestamp)
-        time = "~";
-      else
-        last_saved_timestamp = time;
-
-      if (sql == last_saved_statement)
-        sql = "~";
-      else
-        last_saved_statement = sql;
-
-      std::string xml_time, xml_sql;
-      xml_time = base::xml::encodeEntities(time);
-      xml_sql = base::xml::encodeEntities(sql);
-      xml_sql = base::replaceString(xml_sql, "\n", "&#x0A;");
-      ofs << "<ENTRY timestamp=\'" << xml_time << "\'>" << xml_sql << "</ENTRY>\n";
-    }
-    _last_loaded_row = (int)_row_count - 1;
-    std::reverse(_data.begin(), _data.end());
-  }
-  ofs.flush();
+  _row_count = entries.size();
+  _data_frame_end = _row_count;
 }
 
 void DbSqlEditorHistory::DetailsModel::add_entries(const std::list<std::string> &statements) {
@@ -491,13 +399,6 @@ void DbSqlEditorHistory::DetailsModel::add_entries(const std::list<std::string>
     _data_frame_end = _row_count;
   }
 
-  save();
-
   // refresh_ui();
 }
-
-void DbSqlEditorHistory::update_timestamp(std::tm timestamp) {
-  details_model()->datestamp(timestamp);
-  write_only_details_model()->datestamp(timestamp);
-}
 //--------------------------------------------------------------------------------------------------
@@ -26,6 +26,7 @@
 
 #include "workbench/wb_backend_public_interface.h"
 #include "sqlide/var_grid_model_be.h"
+#include "sqlide/sql_history_store.h"
 #include <time.h>
 #include "mforms/menu.h"
 
@@ -42,15 +43,18 @@ protected:
 
 public:
   void reset();
-  void add_entry(const std::list<std::string> &statements);
+  void add_entry(const std::list<std::string> &statements, const std::string &schema, const std::string &connection);
   int current_entry() {
     return _current_entry_index;
   }
   void current_entry(int index);
   std::string restore_sql_from_history(int entry_index, std::list<int> &detail_indexes);
+  std::vector<SqlHistoryStore::Entry> search(const std::string &keywords, const std::string &schema,
+                                             const std::string &connection, std::size_t offset, std::size_t limit);
 
 protected:
   int _current_entry_index;
+  std::shared_ptr<SqlHistoryStore> _store;
 
 public:
   void load();
@@ -82,23 +86,7 @@ public:
 
     virtual void reset();
 
-    void save();
-    void load(const std::string &storage_file_path);
-
-  protected:
-    int _last_loaded_row; // required to skip duplication of existing entries when dumping contents
-
-  public:
-    std::tm datestamp() const {
-      return _datestamp;
-    }
-    void datestamp(const std::tm &val) {
-      _datestamp = val;
-    }
-
-  protected:
-    std::string storage_file_path() const;
-    std::tm _datestamp; // raw datestamp for locale independent storage file name
+    void load(SqlHistoryStore &store, const std::string &day);
 
   private:
     grt::StringRef _last_timestamp;
@@ -124,10 +112,11 @@ public:
 
     DbSqlEditorHistory *_owner;
 
-    void add_statements(const std::list<std::string> &statements);
+    void add_statements(const std::list<std::string> &statements, const std::string &schema,
+                        const std::string &connection);
 
   public:
-    bool insert_entry(const std::tm &t);
+    bool insert_entry(const std::string &day);
     void delete_all_entries();
     void delete_entries(const std::vector<std::size_t> &rows);
     void set_ui_usage(bool value) {
@@ -137,8 +126,7 @@ public:
       return _ui_usage;
     }
 
-    std::string entry_path(std::size_t index);
-    std::tm entry_date(std::size_t index);
+    std::string entry_day(std::size_t index);
 
     virtual void reset();
     void load();
@@ -154,16 +142,10 @@ public:
   DetailsModel::Ref details_model() {
     return _details_model;
   }
-  DetailsModel::Ref write_only_details_model() {
-    return _write_only_details_model;
-  }
 
 protected:
   EntriesModel::Ref _entries_model;
   DetailsModel::Ref _details_model;
-  DetailsModel::Ref _write_only_details_model;
-
-  void update_timestamp(std::tm timestamp);
 };
 
 #endif /* _DB_SQL_EDITOR_HISTORY_BE_H_ */
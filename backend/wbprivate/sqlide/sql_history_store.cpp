@@ -0,0 +1,442 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <fstream>
+#include <set>
+#include <glib.h>
+
+#include <sqlite/connection.hpp>
+#include <sqlite/execute.hpp>
+#include <sqlite/query.hpp>
+
+#include "base/boost_smart_ptr_helpers.h"
+#include "base/file_utilities.h"
+#include "base/log.h"
+#include "base/scope_exit_trigger.h"
+#include "base/string_utilities.h"
+#include "base/xml_functions.h"
+
+#include "sqlide/sqlide_generics.h"
+#include "sql_history_store.h"
+
+DEFAULT_LOG_DOMAIN("sqlide-history")
+
+//----------------------------------------------------------------------------------------------------------------------
+
+static const char *ENTRY_COLUMNS = "e.id, e.day, e.time, e.statement, e.schema_name, e.connection";
+
+static std::vector<SqlHistoryStore::Entry> fetch_entries(sqlite::query &query) {
+  std::vector<SqlHistoryStore::Entry> entries;
+  if (query.emit()) {
+    std::shared_ptr<sqlite::result> rs(BoostHelper::convertPointer(query.get_result()));
+    do {
+      SqlHistoryStore::Entry entry;
+      entry.id = rs->get_int64(0);
+      entry.day = rs->get_string(1);
+      entry.time = rs->get_string(2);
+      entry.statement = rs->get_string(3);
+      entry.schema = rs->get_string(4);
+      entry.connection = rs->get_string(5);
+      entries.push_back(entry);
+    } while (rs->next_row());
+  }
+  return entries;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// SQLite takes a negative limit as no limit at all.
+static std::int64_t sql_limit(std::size_t limit) {
+  return limit == 0 ? -1 : (std::int64_t)limit;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Inserts entries and adds their statements to the full text index.
+ */
+class SqlHistoryStore::EntryInserter {
+public:
+  EntryInserter(sqlite::connection &connection, bool fts5)
+    : _entry(connection, "insert into entries (day, time, statement, schema_name, connection) values (?, ?, ?, ?, ?)"),
+      _index(connection, fts5 ? "insert into entries_fts (rowid, statement) values (last_insert_rowid(), ?)"
+                              : "insert into entries_fts (docid, statement) values (last_insert_rowid(), ?)") {
+  }
+
+  void insert(const std::string &day, const std::string &time, const std::string &statement,
+              const std::string &schema, const std::string &connection) {
+    _entry.bind(1, day);
+    _entry.bind(2, time);
+    _entry.bind(3, statement);
+    _entry.bind(4, schema);
+    _entry.bind(5, connection);
+    _entry.emit();
+    _entry.clear();
+
+    _index.bind(1, statement);
+    _index.emit();
+    _index.clear();
+  }
+
+private:
+  sqlite::query _entry;
+  sqlite::query _index;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+SqlHistoryStore::SqlHistoryStore(const std::string &path) : _connection(new sqlite::connection(path)), _fts5(true) {
+  try {
+    sqlite::execute(*_connection, "PRAGMA temp_store=MEMORY", true);
+    sqlite::execute(*_connection, "PRAGMA synchronous=NORMAL", true);
+    init_db();
+  } catch (...) {
+    delete _connection;
+    throw;
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+SqlHistoryStore::~SqlHistoryStore() {
+  delete _connection;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void SqlHistoryStore::init_db() {
+  sqlide::Sqlite_transaction_guarder transaction(_connection);
+
+  sqlite::execute(*_connection,
+                  "create table if not exists entries (id integer primary key, day text not null, time text not null, "
+                  "statement text not null, schema_name text not null default '', "
+                  "connection text not null default '')",
+                  true);
+  sqlite::execute(*_connection, "create index if not exists entries_day on entries (day, id)", true);
+  sqlite::execute(*_connection, "create index if not exists entries_schema on entries (schema_name, id)", true);
+  sqlite::execute(*_connection, "create index if not exists entries_connection on entries (connection, id)", true);
+
+  // The names of the day files of the old XML history that were already copied into the store.
+  sqlite::execute(*_connection, "create table if not exists imported_files (name text primary key)", true);
+
+  init_full_text_index();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Sets up the full text index over the statement text. It is an external content index, so the text is not stored
+ * twice. FTS5 is used where the SQLite library has it, otherwise FTS4.
+ *
+ * The index is not maintained by triggers on the entries table, as that makes inserting several times slower. All
+ * code which adds or removes entries updates the index as well.
+ */
+void SqlHistoryStore::init_full_text_index() {
+  sqlite::query query(*_connection, "select sql from sqlite_master where type = 'table' and name = 'entries_fts'");
+  if (query.emit()) {
+    std::shared_ptr<sqlite::result> rs(BoostHelper::convertPointer(query.get_result()));
+    _fts5 = base::tolower(rs->get_string(0)).find("fts5") != std::string::npos;
+    return;
+  }
+
+  try {
+    sqlite::execute(*_connection,
+                    "create virtual table entries_fts using fts5(statement, content='entries', content_rowid='id')",
+                    true);
+    _fts5 = true;
+  } catch (std::exception &exc) {
+    logInfo("FTS5 not available (%s), using FTS4 for the SQL history\n", exc.what());
+    sqlite::execute(*_connection, "create virtual table entries_fts using fts4(content='entries', statement)", true);
+    _fts5 = false;
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void SqlHistoryStore::add_entries(const std::string &day, const std::string &time,
+                                  const std::list<std::string> &statements, const std::string &schema,
+                                  const std::string &connection) {
+  if (statements.empty())
+    return;
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  sqlide::Sqlite_transaction_guarder transaction(_connection);
+  EntryInserter inserter(*_connection, _fts5);
+  for (const std::string &statement : statements)
+    inserter.insert(day, time, statement, schema, connection);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Returns the days for which there are history entries, newest first.
+ */
+std::vector<std::string> SqlHistoryStore::days() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  std::vector<std::string> days;
+
+  // Walks the day index from the newest day down, instead of collecting the distinct values of all rows.
+  sqlite::query query(*_connection, "select day from entries where day < ? order by day desc limit 1");
+  std::string day = "~";
+  while (true) {
+    query.bind(1, day);
+    bool found = false;
+    if (query.emit()) {
+      std::shared_ptr<sqlite::result> rs(BoostHelper::convertPointer(query.get_result()));
+      day = rs->get_string(0);
+      found = true;
+    }
+    query.clear();
+    if (!found)
+      break;
+    days.push_back(day);
+  }
+  return days;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::size_t SqlHistoryStore::count(const std::string &day) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  sqlite::query query(*_connection, "select count(*) from entries where day = ?");
+  query.bind(1, day);
+  if (query.emit()) {
+    std::shared_ptr<sqlite::result> rs(BoostHelper::convertPointer(query.get_result()));
+    return (std::size_t)rs->get_int64(0);
+  }
+  return 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Returns a page of the entries of the given day, newest first. A limit of 0 returns all entries from the offset on.
+ */
+std::vector<SqlHistoryStore::Entry> SqlHistoryStore::entries(const std::string &day, std::size_t offset,
+                                                             std::size_t limit) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  sqlite::query query(*_connection, std::string("select ") + ENTRY_COLUMNS +
+                                      " from entries e where e.day = ? order by e.id desc limit ? offset ?");
+  query.bind(1, day);
+  query.bind(2, sql_limit(limit));
+  query.bind(3, (std::int64_t)offset);
+  return fetch_entries(query);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Returns a page of the entries that contain all the given keywords, newest first. Keywords match words in the
+ * statement text which start with them, case insensitively. Empty filters are ignored, so an empty keyword list
+ * returns all entries of the given schema and/or connection.
+ */
+std::vector<SqlHistoryStore::Entry> SqlHistoryStore::search(const std::string &keywords, const std::string &schema,
+                                                            const std::string &connection, std::size_t offset,
+                                                            std::size_t limit) {
+  std::string match = match_expression(keywords);
+
+  std::string sql = std::string("select ") + ENTRY_COLUMNS + " from ";
+  if (!match.empty())
+    // The cross join makes SQLite look up the matches in the full text index first, instead of walking all entries
+    // in id order and probing the index for each of them.
+    sql += "(select rowid as id from entries_fts where entries_fts match ?) m cross join entries e on e.id = m.id";
+  else
+    sql += "entries e where 1";
+  if (!schema.empty())
+    sql += " and e.schema_name = ?";
+  if (!connection.empty())
+    sql += " and e.connection = ?";
+  sql += " order by e.id desc limit ? offset ?";
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  sqlite::query query(*_connection, sql);
+  int index = 1;
+  if (!match.empty())
+    query.bind(index++, match);
+  if (!schema.empty())
+    query.bind(index++, schema);
+  if (!connection.empty())
+    query.bind(index++, connection);
+  query.bind(index++, sql_limit(limit));
+  query.bind(index++, (std::int64_t)offset);
+  return fetch_entries(query);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Turns the user's keywords into a full text query. Each keyword is quoted, so operators and punctuation in it are
+ * taken literally, and is matched as a prefix.
+ */
+std::string SqlHistoryStore::match_expression(const std::string &keywords) const {
+  std::string result;
+  for (const std::string &keyword : base::split_by_set(keywords, " \t\r\n")) {
+    if (keyword.empty())
+      continue;
+
+    std::string quoted = base::replaceString(keyword, "\"", "\"\"");
+    if (!result.empty())
+      result += " ";
+    if (_fts5)
+      result += "\"" + quoted + "\"*";
+    else
+      result += "\"" + quoted + "*\"";
+  }
+  return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void SqlHistoryStore::delete_day(const std::string &day) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  sqlide::Sqlite_transaction_guarder transaction(_connection);
+
+  // The index needs the statement text to remove an entry, so this must be done before deleting the entries.
+  sqlite::query unindex(*_connection,
+                        _fts5 ? "insert into entries_fts (entries_fts, rowid, statement) "
+                                "select 'delete', id, statement from entries where day = ?"
+                              : "delete from entries_fts where docid in (select id from entries where day = ?)");
+  unindex.bind(1, day);
+  unindex.emit();
+
+  sqlite::query query(*_connection, "delete from entries where day = ?");
+  query.bind(1, day);
+  query.emit();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void SqlHistoryStore::delete_all() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  sqlide::Sqlite_transaction_guarder transaction(_connection);
+  sqlite::execute(*_connection, "delete from entries", true);
+  sqlite::execute(*_connection, "insert into entries_fts (entries_fts) values ('rebuild')", true);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Copies the day files of the old XML based history in the given folder into the store. Files are only imported
+ * once, so this can be called on every start. The files themselves are left untouched.
+ *
+ * @return The number of imported entries.
+ */
+std::size_t SqlHistoryStore::import_directory(const std::string &directory) {
+  GError *error = nullptr;
+  GDir *dir = g_dir_open(directory.c_str(), 0, &error);
+  if (dir == nullptr) {
+    if (error != nullptr)
+      g_error_free(error);
+    return 0;
+  }
+
+  // Day files are named "YYYY-MM-DD". Import them in date order, so the entry ids keep the chronological order.
+  std::set<std::string> names;
+  {
+    base::ScopeExitTrigger on_scope_exit(std::bind(&g_dir_close, dir));
+    while (const char *name = g_dir_read_name(dir)) {
+      std::string day(name);
+      if (day.size() == 10 && day[4] == '-' && day[7] == '-')
+        names.insert(day);
+    }
+  }
+
+  std::size_t count = 0;
+  for (const std::string &name : names) {
+    {
+      std::lock_guard<std::mutex> lock(_mutex);
+      sqlite::query query(*_connection, "select 1 from imported_files where name = ?");
+      query.bind(1, name);
+      if (query.emit())
+        continue;
+    }
+
+    try {
+      count += import_file(base::makePath(directory, name), name);
+    } catch (std::exception &exc) {
+      logError("Can't import SQL history file %s: %s\n", name.c_str(), exc.what());
+    }
+  }
+
+  if (count > 0)
+    logInfo("Imported %lu entries from the SQL history folder %s\n", (unsigned long)count, directory.c_str());
+  return count;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Imports a single day file. Each line in it holds an ENTRY element with the statement as content and the time as
+ * attribute, where "~" stands for the value of the previous line.
+ */
+std::size_t SqlHistoryStore::import_file(const std::string &path, const std::string &day) {
+  std::ifstream historyXml(base::path_from_utf8(path));
+  if (!historyXml.is_open()) {
+    logError("Can't open SQL history file %s\n", path.c_str());
+    return 0;
+  }
+
+  std::lock_guard<std::mutex> lock(_mutex);
+  sqlide::Sqlite_transaction_guarder transaction(_connection);
+  EntryInserter inserter(*_connection, _fts5);
+
+  std::string line;
+  std::string lastTimestamp;
+  std::string lastStatement;
+  std::size_t count = 0;
+
+  // Skips the first line in the file as is the xml header.
+  std::getline(historyXml, line);
+  while (std::getline(historyXml, line)) {
+    if (line.empty())
+      continue;
+
+    xmlDocPtr xmlDoc = base::xml::xmlParseFragment(line);
+    if (xmlDoc == nullptr) {
+      logError("Can't parse %s, of file: %s\n", line.c_str(), path.c_str());
+      continue;
+    }
+
+    xmlNodePtr element = xmlDoc->children;
+    if (element != nullptr) {
+      std::string timestamp = base::xml::getProp(element, "timestamp");
+      std::string statement = base::xml::getContent(element);
+      if (timestamp != "~")
+        lastTimestamp = timestamp;
+      if (statement != "~")
+        lastStatement = statement;
+
+      inserter.insert(day, lastTimestamp, lastStatement, "", "");
+      ++count;
+    }
+    xmlFreeDoc(xmlDoc);
+  }
+
+  sqlite::query mark(*_connection, "insert or ignore into imported_files (name) values (?)");
+  mark.bind(1, day);
+  mark.emit();
+
+  return count;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
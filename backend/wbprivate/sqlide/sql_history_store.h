@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#pragma once
+
+#include "workbench/wb_backend_public_interface.h"
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace sqlite {
+  struct connection;
+}
+
+/**
+ * Persistent store for the SQL editor query history, kept in an SQLite database.
+ * Entries are indexed by day, connection and schema and the statement text is indexed for full text search,
+ * so the history can be loaded page by page and searched without reading it completely.
+ * All members are thread safe.
+ */
+class MYSQLWBBACKEND_PUBLIC_FUNC SqlHistoryStore {
+public:
+  struct Entry {
+    std::int64_t id = 0;
+    std::string day; // YYYY-MM-DD
+    std::string time;
+    std::string statement;
+    std::string schema;
+    std::string connection;
+  };
+
+  SqlHistoryStore(const std::string &path);
+  ~SqlHistoryStore();
+
+  SqlHistoryStore(const SqlHistoryStore &) = delete;
+  SqlHistoryStore &operator=(const SqlHistoryStore &) = delete;
+
+  void add_entries(const std::string &day, const std::string &time, const std::list<std::string> &statements,
+                   const std::string &schema, const std::string &connection);
+
+  std::vector<std::string> days();
+  std::size_t count(const std::string &day);
+  std::vector<Entry> entries(const std::string &day, std::size_t offset = 0, std::size_t limit = 0);
+  std::vector<Entry> search(const std::string &keywords, const std::string &schema, const std::string &connection,
+                            std::size_t offset = 0, std::size_t limit = 0);
+
+  void delete_day(const std::string &day);
+  void delete_all();
+
+  std::size_t import_directory(const std::string &directory);
+
+private:
+  class EntryInserter;
+
+  sqlite::connection *_connection;
+  std::mutex _mutex;
+  bool _fts5;
+
+  void init_db();
+  void init_full_text_index();
+  std::string match_expression(const std::string &keywords) const;
+  std::size_t import_file(const std::string &path, const std::string &day);
+};
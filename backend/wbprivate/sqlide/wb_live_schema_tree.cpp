@@ -578,6 +578,16 @@ void LiveSchemaTree::setup_node(mforms::TreeNodeRef node, ObjectType type, mform
     default:
       break;
   }
+
+  // The filter name index is filled as the data gets loaded, so filtering never has to compute the names itself.
+  // New data may also get the address of deleted data, it must not inherit its entry in the index.
+  mforms::TreeNodeData* data = node->get_data();
+  if (pdata == nullptr && data != nullptr) {
+    if (is_object_type(DatabaseObject, type))
+      _filter_names[data] = base::toupper(node->get_string(0));
+    else if (!_filter_names.empty())
+      _filter_names.erase(data);
+  }
 }
 
 void LiveSchemaTree::fill_node_icons() {
@@ -1022,8 +1032,11 @@ void LiveSchemaTree::update_live_object_state(ObjectType type, const std::string
         }
 
         if (changed && object_node) {
-          if (old_obj_name != new_obj_name)
+          if (old_obj_name != new_obj_name) {
             object_node->set_string(0, new_obj_name);
+            if (object_node->get_data())
+              (_base != nullptr ? _base : this)->_filter_names[object_node->get_data()] = base::toupper(new_obj_name);
+          }
 
           // As the object has changed we trigger a reload on
           // Its content
@@ -1672,6 +1685,7 @@ void LiveSchemaTree::is_schema_contents_enabled(bool value) {
 
 void LiveSchemaTree::set_no_connection() {
   _model_view->clear();
+  _filter_names.clear();
   mforms::TreeNodeRef node = _model_view->add_node();
   node->set_string(0, "Not connected");
 }
@@ -1715,12 +1729,19 @@ std::string LiveSchemaTree::get_filter_wildcard(const std::string& filter, Filte
 void LiveSchemaTree::filter_data() {
   _enabled_events = false;
 
-  // Removes all the objects on the target tree
-  _model_view->clear();
+  // A filter which only extends the one the current content was created with (e.g. while typing) can only match
+  // less, so the nodes no longer matching are removed from the current content instead of recreating everything.
+  if (!_applied_filter.empty() && _filter != _applied_filter && base::hasPrefix(_filter, _applied_filter))
+    refilter_children();
+  else {
+    // Removes all the objects on the target tree
+    _model_view->clear();
 
-  mforms::TreeNodeRef base_root = _base->_model_view->root_node();
-  mforms::TreeNodeRef this_root = _model_view->root_node();
-  filter_children(Schema, base_root, this_root, _schema_pattern);
+    mforms::TreeNodeRef base_root = _base->_model_view->root_node();
+    mforms::TreeNodeRef this_root = _model_view->root_node();
+    filter_children(Schema, base_root, this_root, _schema_pattern);
+  }
+  _applied_filter = _filter;
 
   // To keep the active schema on the filtered tree
   set_active_schema(_base->_active_schema);
@@ -1802,7 +1823,10 @@ bool LiveSchemaTree::filter_children(ObjectType type, mforms::TreeNodeRef& sourc
   int count = source->count();
   for (int index = 0; index < count; index++) {
     mforms::TreeNodeRef source_node = source->get_child(index);
-    if (!validate || g_pattern_match_string(pattern, base::toupper(source_node->get_string(0)).c_str())) {
+
+    bool matches = !validate || g_pattern_match_string(pattern, filter_name(source_node).c_str());
+
+    if (matches) {
       std::vector<mforms::TreeNodeRef> group_added_nodes;
       _node_collections[type].captions.clear();
       _node_collections[type].captions.push_back(source_node->get_string(0));
@@ -1832,6 +1856,68 @@ bool LiveSchemaTree::filter_children(ObjectType type, mforms::TreeNodeRef& sourc
 
 //--------------------------------------------------------------------------------------------------
 
+/*
+*  refilter_children: removes the schemas and schema objects not matching the current filter from this tree, used
+*                     when the filter was narrowed, so everything still matching is already here
+*/
+void LiveSchemaTree::refilter_children() {
+  static const int collections[] = {TABLES_NODE_INDEX, VIEWS_NODE_INDEX, PROCEDURES_NODE_INDEX,
+                                    FUNCTIONS_NODE_INDEX};
+
+  mforms::TreeNodeRef root = _model_view->root_node();
+  for (int schema_index = root->count() - 1; schema_index >= 0; schema_index--) {
+    mforms::TreeNodeRef schema_node = root->get_child(schema_index);
+    if (!filter_matches(schema_node, _schema_pattern)) {
+      schema_node->remove_from_parent();
+      continue;
+    }
+
+    if (_object_pattern) {
+      bool found = false;
+      for (int collection_index : collections) {
+        mforms::TreeNodeRef collection = schema_node->get_child(collection_index);
+        for (int index = collection->count() - 1; index >= 0; index--) {
+          mforms::TreeNodeRef object_node = collection->get_child(index);
+          if (!filter_matches(object_node, _object_pattern))
+            object_node->remove_from_parent();
+        }
+        found = found || collection->count() > 0;
+      }
+
+      if (!found)
+        schema_node->remove_from_parent();
+    }
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool LiveSchemaTree::filter_matches(mforms::TreeNodeRef& node, GPatternSpec* pattern) {
+  return pattern == nullptr || g_pattern_match_string(pattern, filter_name(node).c_str());
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Returns the upper case name of the given node as used for filtering. The name is looked up in the name index of
+ * the tree which loaded the data (the base tree for a filtered one) and only computed if it isn't there.
+ */
+std::string LiveSchemaTree::filter_name(mforms::TreeNodeRef& node) {
+  mforms::TreeNodeData* data = node->get_data();
+  if (data == nullptr)
+    return base::toupper(node->get_string(0));
+
+  auto& names = (_base != nullptr ? _base : this)->_filter_names;
+
+  auto entry = names.find(data);
+  if (entry == names.end())
+    entry = names.emplace(data, base::toupper(node->get_string(0))).first;
+
+  return entry->second;
+}
+
+//--------------------------------------------------------------------------------------------------
+
 void LiveSchemaTree::clean_filter() {
   if (_filter.length() > 0) {
     _filter_type = Any;
@@ -1983,6 +2069,7 @@ void LiveSchemaTree::update_schemata(base::StringListPtr schema_list) {
     if (root && root->count() > 0 && !root->get_child(0)->get_data()) {
       // the tree was in no-connection mode
       _model_view->clear();
+      _filter_names.clear();
       root = _model_view->root_node();
     }
 
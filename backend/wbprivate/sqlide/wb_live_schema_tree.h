@@ -23,6 +23,8 @@
 
 #pragma once
 
+#include <unordered_map>
+
 #include "base/symbol-info.h"
 
 #include "grt.h"
@@ -397,6 +399,9 @@ namespace wb {
     void filter_children_collection(mforms::TreeNodeRef& source, mforms::TreeNodeRef& target);
     bool filter_children(ObjectType type, mforms::TreeNodeRef& source, mforms::TreeNodeRef& target,
                          GPatternSpec* pattern = NULL);
+    void refilter_children();
+    bool filter_matches(mforms::TreeNodeRef& node, GPatternSpec* pattern);
+    std::string filter_name(mforms::TreeNodeRef& node);
     bool is_object_type(ObjectTypeValidation validation, ObjectType type);
 
   public:
@@ -477,6 +482,10 @@ namespace wb {
 
     void enable_events(bool enable) {
       _enabled_events = enable;
+
+      // A filtered tree is not kept up to date while it is hidden, so the next filter must be applied from scratch.
+      if (!enable)
+        _applied_filter.clear();
     }
 
     bool getEnabledEvents() { return _enabled_events; }
@@ -489,6 +498,12 @@ namespace wb {
     LiveSchemaTree *_base = nullptr;
     std::string _filter;
     ObjectType _filter_type;
+
+    // The filter the content of this (filtered) tree was created with and the upper case names of the schemas and
+    // schema objects of this tree, keyed by their node data. The names are stored when the data is loaded and are
+    // shared by the filtered trees using this one as their base.
+    std::string _applied_filter;
+    std::unordered_map<mforms::TreeNodeData*, std::string> _filter_names;
     LSTData *notify_on_reload_data = nullptr;
 
     static const char* _schema_tokens[16];
@@ -305,6 +305,13 @@ SqlEditorForm::SqlEditorForm(wb::WBContextSQLIDE *wbsql)
       TimerTimeSpan, keep_alive_interval, false, std::bind(&SqlEditorForm::send_message_keep_alive_bool_wrapper, this));
   }
 
+  // Pooled connections (used by plugins for background work) are otherwise only closed when the next one is taken.
+  double idle_timeout = std::chrono::duration<double>(sql::ConnectionPool::Options().idleTimeout).count();
+  _pool_eviction_timer = bec::GRTManager::get()->run_every([]() {
+    sql::DriverManager::getDriverManager()->evictExpiredConnections();
+    return true;
+  }, idle_timeout / 2);
+
   _lower_case_table_names = 0;
 
   _continueOnError = (bec::GRTManager::get()->get_app_option_int("DbSqlEditor:ContinueOnError", 0) != 0);
@@ -650,6 +657,19 @@ void SqlEditorForm::close() {
   exec_sql_task->exec(true, std::bind(&SqlEditorForm::do_disconnect, this));
   exec_sql_task->disconnect_callbacks();
   reset_keep_alive_thread();
+
+  if (_pool_eviction_timer != nullptr) {
+    bec::GRTManager::get()->cancel_timer(_pool_eviction_timer);
+    _pool_eviction_timer = nullptr;
+  }
+  if (_connection.is_valid()) {
+    sql::DriverManager *dm = sql::DriverManager::getDriverManager();
+    sql::ConnectionPool::Statistics statistics = dm->getPoolStatistics(_connection);
+    if (statistics.created > 0)
+      logDebug("Closing connection pool: %zu connections opened, %zu reused, %zu evicted, %zu waits\n",
+               statistics.created, statistics.reused, statistics.evicted, statistics.waits);
+    dm->closeConnectionPool(_connection);
+  }
   bec::GRTManager::get()->replace_status_text("SQL Editor closed");
 
   delete _menu;
@@ -2006,7 +2026,7 @@ grt::StringRef SqlEditorForm::do_exec_sql(Ptr self_ptr, std::shared_ptr<std::str
 
       warning.push_back(base::strfmt("Skipping history entries for %li statements, total %li bytes",
                                      (long)statement_ranges.size(), (long)sql->size()));
-      _history->add_entry(warning);
+      add_history_entry(warning);
       logging_queries = false;
     }
 
@@ -2041,7 +2061,7 @@ grt::StringRef SqlEditorForm::do_exec_sql(Ptr self_ptr, std::shared_ptr<std::str
         if (logging_queries) {
           std::list<std::string> statements;
           statements.push_back(statement);
-          _history->add_entry(statements);
+          add_history_entry(statements);
         }
 
         Recordset_cdbc_storage::Ref data_storage;
@@ -2727,7 +2747,7 @@ void SqlEditorForm::apply_object_alter_script(const std::string &alter_script, b
   }
 
   if (!max_query_size_to_log || max_query_size_to_log >= (int)alter_script.size())
-    _history->add_entry(sql_batch_exec.sql_log());
+    add_history_entry(sql_batch_exec.sql_log());
 
   // refresh object's state only on success, to not lose changes made by user
   if (obj_editor && (0 == sql_batch_exec_err_count)) {
@@ -2811,7 +2831,7 @@ void SqlEditorForm::apply_data_changes_commit(const std::string &sql_script_text
   rs->do_apply_changes(rs_ptr, Recordset_data_storage::Ptr(data_storage_ref), skip_commit);
 
   if (!max_query_size_to_log || max_query_size_to_log >= (int)sql_script_text.size())
-    _history->add_entry(sql_script.statements);
+    add_history_entry(sql_script.statements);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -2822,6 +2842,15 @@ std::string SqlEditorForm::active_schema() const {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+/**
+ * Records the statements in the query history, together with the schema and connection they were run in.
+ */
+void SqlEditorForm::add_history_entry(const std::list<std::string> &statements) {
+  _history->add_entry(statements, active_schema(), _connection.is_valid() ? *_connection->name() : "");
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 void SqlEditorForm::schemaListRefreshed(std::vector<std::string> const &schemas) {
   std::unique_lock<std::mutex> lock(_pimplMutex->_symbolsMutex);
   _databaseSymbols.clear(); // Doesn't clear the dependencies.
@@ -475,6 +475,7 @@ public:
 protected:
   DbSqlEditorLog::Ref _log;
   DbSqlEditorHistory::Ref _history;
+  void add_history_entry(const std::list<std::string> &statements);
   bool _serverIsOffline = false;
 
   std::string _title;
@@ -521,6 +522,7 @@ private:
 
   int _keep_alive_task_id = 0;
   base::Mutex _keep_alive_thread_mutex;
+  bec::GRTManager::Timer *_pool_eviction_timer = nullptr;
 
   Batch_exec_progress_cb on_sql_script_run_progress;
   Batch_exec_stat_cb on_sql_script_run_statistics;
@@ -99,6 +99,9 @@ DEFAULT_LOG_DOMAIN(DOMAIN_WB_CONTEXT)
 
 #define DEFAULT_UNDO_STACK_SIZE 10
 
+// Memory the undo history may use, in MB (0 for no limit).
+#define DEFAULT_UNDO_MEMORY_LIMIT 256
+
 // auto-save every 1 minute (default)
 #define AUTO_SAVE_MODEL_INTERVAL (60)
 
@@ -583,6 +586,9 @@ void WBContext::finalize() {
   }
 
   bec::GRTManager::get()->get_dispatcher()->shutdown();
+
+  // Pooled connections may still go through the tunnels, so they are closed first.
+  sql::DriverManager::getDriverManager()->closeConnectionPools();
   if (_tunnel_manager) {
     delete _tunnel_manager;
     _tunnel_manager = nullptr;
@@ -1387,6 +1393,7 @@ void WBContext::set_default_options(grt::DictRef options) {
   set_default(options, "workbench:ForceSWRendering", 0);
   set_default(options, "workbench:OSSHideMissing", 0);
   set_default(options, "workbench:UndoEntries", DEFAULT_UNDO_STACK_SIZE);
+  set_default(options, "workbench:UndoMemoryLimit", DEFAULT_UNDO_MEMORY_LIMIT);
   set_default(options, "workbench:AutoSaveModelInterval", AUTO_SAVE_MODEL_INTERVAL);
   set_default(options, "workbench:AutoSaveSQLEditorInterval", AUTO_SAVE_SQLEDITOR_INTERVAL);
   set_default(options, "workbench.AutoReopenLastModel", 0);
@@ -1945,6 +1952,11 @@ void WBContext::option_dict_changed(grt::internal::OwnedDict *options, bool, con
       undo_size = 1;
 
     grt::GRT::get()->get_undo_manager()->set_undo_limit(undo_size);
+
+    ssize_t undo_memory = get_wb_options().get_int("workbench:UndoMemoryLimit", DEFAULT_UNDO_MEMORY_LIMIT);
+    if (undo_memory < 0)
+      undo_memory = 0;
+    grt::GRT::get()->get_undo_manager()->set_undo_memory_limit((size_t)undo_memory * 1024 * 1024);
   }
 }
 
@@ -2225,7 +2237,7 @@ workbench_DocumentRef WBContext::openModelFile(const std::string &file) {
                                       "Error while including another model. A model cannot be added to itself.", "OK");
       return doc;
     }
-    _model_import_file->open(file);
+    _model_import_file->open(file, true);
     //    _manager->set_db_file_path(_file->get_db_file_path());
 
     doc = _model_import_file->retrieve_document();
@@ -2288,8 +2300,10 @@ bool WBContext::open_document(const std::string &file) {
                  std::bind(&WBContext::request_refresh, this, RefreshDocument, "", static_cast<NativeHandle>(0)));
 
   try {
-    _file->open(file);
-    bec::GRTManager::get()->set_db_file_path(_file->get_db_file_path());
+    _file->open(file, true);
+    // The data file is only extracted from the archive when something actually needs it.
+    ModelFile *model_file = _file;
+    bec::GRTManager::get()->set_db_file_path_slot([model_file]() { return model_file->get_db_file_path(); });
 
     doc = _file->retrieve_document();
   }
@@ -2498,6 +2512,7 @@ void WBContext::do_close_document(bool destroying) {
 
   delete _file;
   _file = 0;
+  bec::GRTManager::get()->set_db_file_path("");
 
   // reset undo manager before destroying views to make sure that old refs to
   // figures will be released and bridges will be deleted 1st
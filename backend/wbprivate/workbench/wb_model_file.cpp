@@ -25,11 +25,14 @@
 #include <fcntl.h>
 
 #include <zip.h>
+#include <zlib.h>
 #include "wb_model_file.h"
 
 #include <algorithm>
+#include <atomic>
 #include <set>
 #include <stdexcept>
+#include <thread>
 #include <errno.h>
 
 #include "grt.h"
@@ -48,6 +51,12 @@
 #include "grts/structs.workbench.h"
 #include <glib/gstdio.h>
 
+#ifdef _MSC_VER
+#include <sys/utime.h>
+#else
+#include <utime.h>
+#endif
+
 #define DOCUMENT_FORMAT "MySQL Workbench Model"
 // version history:
 // switched to 1.1.6 in 5.0.20
@@ -80,6 +89,32 @@
  * and if so, the recovery function will kick in, using the autosave XML file.
  */
 
+/* Binary document
+ *
+ * Next to the XML document, the same GRT tree is stored in the compact binary format as document.mwb.grtb,
+ * which loads much faster. The XML file stays the reference: the binary file is only used when its header
+ * carries the CRC-32 and size of the XML document in the archive, so files saved by versions that don't know
+ * about the binary file, or recovered from an auto-save, are loaded from XML as before. The archive records
+ * both for every entry, so checking them doesn't read the XML document.
+ */
+
+/* Saving
+ *
+ * The XML tree is built from the GRT values, so that happens on the calling thread. It's the snapshot both
+ * documents are then made from in the background: the XML is formatted while the binary document is encoded
+ * from the same tree on another thread, and both are written. save_to() prepares the target file meanwhile and
+ * only waits for them before the archive is put together. Auto-saves take the XML tree on the calling thread
+ * and format and write it in the background.
+ *
+ * When saving over the archive the document was opened from (or last saved to), that archive is updated
+ * in place: entries of files that weren't touched since are kept as they are, without being recompressed,
+ * and entries that were never extracted are not even read. Whether a file was touched is decided from its
+ * size and modification time, compared to a stamp taken when the file was last extracted or stored.
+ *
+ * The larger files that do have to be compressed are compressed in parallel, each into an archive of its own
+ * next to the document directory, from which the compressed entries are copied into the document archive.
+ */
+
 DEFAULT_LOG_DOMAIN("model")
 
 using namespace bec;
@@ -94,7 +129,7 @@ void ModelFile::copy_file(const std::string &srcfile, const std::string &destfil
   if (!sf)
     throw grt::os_error("Could not open file " + srcfile, errno);
 
-  FILE *tf = base_fopen(destfile.c_str(), "w+");
+  FILE *tf = base_fopen(destfile.c_str(), "wb+");
   if (!tf) {
     fclose(sf);
     throw grt::os_error("Could not create file " + destfile, errno);
@@ -147,6 +182,16 @@ static int rmdir_recursively(const char *path) {
   return res;
 }
 
+static std::string absolute_path(const std::string &path) {
+  if (g_path_is_absolute(path.c_str()))
+    return path;
+
+  char *prefix = g_get_current_dir();
+  std::string result = std::string(prefix).append("/").append(path);
+  g_free(prefix);
+  return result;
+}
+
 std::string ModelFile::create_document_dir(const std::string &dir, const std::string &prefix) {
   std::string path;
   char s[12];
@@ -176,6 +221,9 @@ std::string ModelFile::create_document_dir(const std::string &dir, const std::st
 
 ModelFile::ModelFile(const std::string &tmpdir) : _temp_dir_lock(0), _dirty(false) {
   _temp_dir = tmpdir;
+  _archive_stamp.size = 0;
+  _archive_stamp.mtime = 0;
+  _archive_stamp.taken = 0;
 }
 
 ModelFile::~ModelFile() {
@@ -186,7 +234,12 @@ void ModelFile::copy_file_to(const std::string &file, const std::string &dest) {
   copy_file(get_path_for(file), dest);
 }
 
-void ModelFile::open(const std::string &path) {
+/**
+ * Opens the given model file. With extract_on_demand set, the archive contents are not unpacked up front:
+ * the document is read directly from the archive and other entries (images, scripts, the @db data file)
+ * are only extracted to the document directory when first accessed.
+ */
+void ModelFile::open(const std::string &path, bool extract_on_demand) {
   bool file_is_zip;
   bool file_is_autosave = false;
 
@@ -318,9 +371,13 @@ void ModelFile::open(const std::string &path) {
     _content_dir = create_document_dir(_temp_dir, basename);
 
     if (file_is_zip) {
-      unpack_zip(path, _content_dir);
+      if (extract_on_demand)
+        scan_zip(path);
+      else
+        unpack_zip(path, _content_dir);
 
       check_and_fix_data_file_bug();
+      record_archive_state(absolute_path(path));
     } else {
       std::string destpath = _content_dir;
       destpath.append("/");
@@ -382,6 +439,9 @@ void ModelFile::create() {
 }
 
 std::string ModelFile::get_path_for(const std::string &file) {
+  wait_for_document_file(file);
+  extract_pending(file);
+
   return _content_dir + "/" + file;
 }
 
@@ -391,11 +451,15 @@ std::string ModelFile::get_path_for(const std::string &file) {
 workbench_DocumentRef ModelFile::retrieve_document() {
   RecMutexLock lock(_mutex);
 
-  xmlDocPtr xmldoc = grt::GRT::get()->load_xml(get_path_for(MAIN_DOCUMENT_NAME));
+  workbench_DocumentRef binary_doc(retrieve_binary_document());
+  if (binary_doc.is_valid())
+    return binary_doc;
+
+  xmlDocPtr xmldoc = load_document_xml();
 
 retry:
   try {
-    workbench_DocumentRef doc(unserialize_document(xmldoc, get_path_for(MAIN_DOCUMENT_NAME)));
+    workbench_DocumentRef doc(unserialize_document(xmldoc, _content_dir + "/" + MAIN_DOCUMENT_NAME));
     xmlFreeDoc(xmldoc);
     xmldoc = NULL;
 
@@ -419,6 +483,57 @@ retry:
 
 //--------------------------------------------------------------------------------------------------
 
+/**
+ * Loads the document from the binary file, if there is one that matches the XML document.
+ * Returns an invalid ref if the XML document must be loaded instead.
+ */
+workbench_DocumentRef ModelFile::retrieve_binary_document() {
+  if (!has_file(MAIN_DOCUMENT_BINARY_NAME))
+    return workbench_DocumentRef();
+
+  std::string data, doctype, version, token;
+  try {
+    data = read_document_data(MAIN_DOCUMENT_BINARY_NAME);
+  } catch (std::exception &exc) {
+    logWarning("Could not read binary document: %s", exc.what());
+    return workbench_DocumentRef();
+  }
+
+  if (!grt::GRT::get()->get_binary_data_metainfo(data, doctype, version, token) || doctype != DOCUMENT_FORMAT ||
+      version != DOCUMENT_VERSION) {
+    logInfo("Binary document has an unsupported format or version, loading XML document");
+    return workbench_DocumentRef();
+  }
+
+  if (token.empty() || token != document_token()) {
+    logInfo("Binary document is out of sync with the XML document, loading XML document");
+    return workbench_DocumentRef();
+  }
+
+  try {
+    grt::ValueRef value(grt::GRT::get()->unserialize_binary_data(data, doctype, version));
+
+    if (!workbench_DocumentRef::can_wrap(value))
+      throw std::runtime_error("Loaded file does not contain a valid Workbench document.");
+
+    workbench_DocumentRef doc(workbench_DocumentRef::cast_from(value));
+    if (!semantic_check(doc))
+      throw std::logic_error(_("Invalid model file content."));
+
+    _loaded_version = version;
+    _load_warnings.clear();
+
+    check_and_fix_inconsistencies(doc, version);
+
+    return doc;
+  } catch (std::exception &exc) {
+    logWarning("Could not load binary document, loading XML document instead: %s", exc.what());
+  }
+  return workbench_DocumentRef();
+}
+
+//--------------------------------------------------------------------------------------------------
+
 bool ModelFile::semantic_check(workbench_DocumentRef doc) {
   // 1) Is there a valid physical model in the document?
   if (!doc->physicalModels().is_valid() || doc->physicalModels().count() == 0)
@@ -429,12 +544,7 @@ bool ModelFile::semantic_check(workbench_DocumentRef doc) {
 
 //--------------------------------------------------------------------------------------------------
 
-std::list<std::string> ModelFile::unpack_zip(const std::string &zipfile, const std::string &destdir) {
-  std::list<std::string> unpacked_files;
-
-  if (g_mkdir_with_parents(destdir.c_str(), 0700) < 0)
-    throw grt::os_error(strfmt(_("Cannot create temporary directory for open document: %s"), destdir.c_str()), errno);
-
+static zip *open_zip_archive(const std::string &zipfile) {
   int err;
 #ifdef ZIP_DISABLE_DEPRECATED
   // Would be good if we could test for zip_fdopen, but there's no way in the preprocessor.
@@ -471,86 +581,540 @@ std::list<std::string> ModelFile::unpack_zip(const std::string &zipfile, const s
     zip_close(z);
     throw std::runtime_error(strfmt(_("Cannot open document file: %s"), msg.c_str()));
   }
+  return z;
+}
 
+static int zip_entry_count(zip *z) {
 #ifdef ZIP_DISABLE_DEPRECATED
-  zip_int64_t count = zip_get_num_entries(z, 0);
+  return (int)zip_get_num_entries(z, 0);
 #else
-  int count = zip_get_num_files(z);
+  return zip_get_num_files(z);
 #endif
-  for (int i = 0; i < count; i++) {
-    zip_file *file = zip_fopen_index(z, i, 0);
-    if (!file) {
-      const char *err = zip_strerror(z);
-      zip_close(z);
-      throw std::runtime_error(strfmt(_("Error opening document file: %s"), err));
-    }
+}
+
+/**
+ * Returns the name of the given archive entry, or NULL if the entry is not part of the document contents.
+ */
+static const char *document_entry_name(zip *z, int index) {
+  const char *zname = zip_get_name(z, index, 0);
+  if (!zname || strcmp(zname, "/") == 0 || strcmp(zname, "\\") == 0)
+    return NULL;
+
+  // skip lock file as it is already locked and inaccessible
+  if (base::basename(zname) == ModelFile::lock_filename)
+    return NULL;
+
+  return zname;
+}
+
+static std::string extract_zip_entry(zip *z, int index, const std::string &destdir) {
+  const char *zname = zip_get_name(z, index, 0);
+  std::string dirname = base::dirname(zname);
+  std::string basename = base::basename(zname);
+
+  std::string outpath = destdir;
+
+  if (!dirname.empty()) {
+    outpath.append("/");
+    outpath.append(dirname);
+    if (g_mkdir_with_parents(outpath.c_str(), 0700) < 0)
+      throw grt::os_error(_("Error creating temporary directory while opending document."), errno);
+  }
+  outpath.append("/");
+  outpath.append(basename);
 
-    const char *zname = zip_get_name(z, i, 0);
-    if (strcmp(zname, "/") == 0 || strcmp(zname, "\\") == 0) {
+  zip_file *file = zip_fopen_index(z, index, 0);
+  if (!file)
+    throw std::runtime_error(strfmt(_("Error opening document file: %s"), zip_strerror(z)));
+
+  FILE *outfile = base_fopen(outpath.c_str(), "w+");
+  if (!outfile) {
+    zip_fclose(file);
+    throw grt::os_error(_("Error creating temporary file while opending document."), errno);
+  }
+
+  char buffer[65536];
+  ssize_t c;
+  while ((c = (ssize_t)zip_fread(file, buffer, sizeof(buffer))) > 0) {
+    if ((ssize_t)fwrite(buffer, 1, c, outfile) < c) {
+      int err = ferror(outfile);
+      fclose(outfile);
       zip_fclose(file);
-      continue;
+      throw grt::os_error(_("Error writing temporary file while opending document."), err);
     }
-    std::string dirname = base::dirname(zname);
-    std::string basename = base::basename(zname);
+  }
+  fclose(outfile);
 
-    // skip lock file as it is already locked and inaccessible
-    if (basename == lock_filename) {
-      zip_fclose(file);
-      continue;
+  if (c < 0) {
+    std::string err = zip_file_strerror(file) ? zip_file_strerror(file) : "";
+    zip_fclose(file);
+    throw std::runtime_error(strfmt(_("Error opening document file: %s"), err.c_str()));
+  }
+  zip_fclose(file);
+
+  // Keep the time stamp of the archive entry, so that an extracted file is only seen as modified when it was.
+  struct zip_stat st;
+  zip_stat_init(&st);
+  if (zip_stat_index(z, index, 0, &st) == 0 && (st.valid & ZIP_STAT_MTIME)) {
+    struct utimbuf times;
+    times.actime = st.mtime;
+    times.modtime = st.mtime;
+    g_utime(outpath.c_str(), &times);
+  }
+
+  return outpath;
+}
+
+static std::string read_zip_entry(zip *z, int index) {
+  std::string data;
+
+  struct zip_stat st;
+  zip_stat_init(&st);
+  if (zip_stat_index(z, index, 0, &st) == 0 && (st.valid & ZIP_STAT_SIZE))
+    data.reserve((size_t)st.size);
+
+  zip_file *file = zip_fopen_index(z, index, 0);
+  if (!file)
+    throw std::runtime_error(strfmt(_("Error opening document file: %s"), zip_strerror(z)));
+
+  char buffer[65536];
+  ssize_t c;
+  while ((c = (ssize_t)zip_fread(file, buffer, sizeof(buffer))) > 0)
+    data.append(buffer, c);
+
+  if (c < 0) {
+    std::string err = zip_file_strerror(file) ? zip_file_strerror(file) : "";
+    zip_fclose(file);
+    throw std::runtime_error(strfmt(_("Error opening document file: %s"), err.c_str()));
+  }
+  zip_fclose(file);
+
+  return data;
+}
+
+std::list<std::string> ModelFile::unpack_zip(const std::string &zipfile, const std::string &destdir) {
+  std::list<std::string> unpacked_files;
+
+  if (g_mkdir_with_parents(destdir.c_str(), 0700) < 0)
+    throw grt::os_error(strfmt(_("Cannot create temporary directory for open document: %s"), destdir.c_str()), errno);
+
+  zip *z = open_zip_archive(zipfile);
+
+  try {
+    for (int count = zip_entry_count(z), i = 0; i < count; i++) {
+      if (document_entry_name(z, i))
+        unpacked_files.push_back(extract_zip_entry(z, i, destdir));
     }
+  } catch (...) {
+    zip_close(z);
+    throw;
+  }
 
-    std::string outpath = destdir;
+  zip_close(z);
 
-    if (!dirname.empty()) {
-      outpath.append("/");
-      outpath.append(dirname);
-      if (g_mkdir_with_parents(outpath.c_str(), 0700) < 0) {
-        zip_fclose(file);
-        zip_close(z);
-        throw grt::os_error(_("Error creating temporary directory while opending document."), errno);
-      }
+  return unpacked_files;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Records the contents of the archive without extracting anything. Entries are extracted to the
+ * document directory by extract_pending() when they are first needed.
+ */
+void ModelFile::scan_zip(const std::string &zipfile) {
+  zip *z = open_zip_archive(zipfile);
+
+  _pending_entries.clear();
+  for (int count = zip_entry_count(z), i = 0; i < count; i++) {
+    const char *zname = document_entry_name(z, i);
+    if (zname)
+      _pending_entries[zname] = i;
+  }
+  zip_close(z);
+
+  _archive_path = zipfile;
+}
+
+/**
+ * Returns true if the given file, or a directory with files, is still only in the archive.
+ */
+bool ModelFile::is_pending(const std::string &name) {
+  if (_pending_entries.empty())
+    return false;
+
+  if (_pending_entries.find(name) != _pending_entries.end())
+    return true;
+
+  std::string prefix = name + "/";
+  std::map<std::string, int>::const_iterator iter = _pending_entries.lower_bound(prefix);
+  return iter != _pending_entries.end() && base::hasPrefix(iter->first, prefix);
+}
+
+/**
+ * Extracts the given file, or all files in the given directory, if they weren't extracted yet.
+ */
+void ModelFile::extract_pending(const std::string &name) {
+  RecMutexLock lock(_mutex);
+
+  if (!is_pending(name))
+    return;
+
+  std::vector<std::map<std::string, int>::iterator> entries;
+  std::map<std::string, int>::iterator iter = _pending_entries.find(name);
+  if (iter != _pending_entries.end())
+    entries.push_back(iter);
+
+  std::string prefix = name + "/";
+  for (iter = _pending_entries.lower_bound(prefix);
+       iter != _pending_entries.end() && base::hasPrefix(iter->first, prefix); ++iter)
+    entries.push_back(iter);
+
+  zip *z = open_zip_archive(_archive_path);
+  try {
+    for (std::vector<std::map<std::string, int>::iterator>::const_iterator e = entries.begin(); e != entries.end();
+         ++e) {
+      extract_zip_entry(z, (*e)->second, _content_dir);
+      stamp_file((*e)->first);
+      _pending_entries.erase(*e);
     }
-    outpath.append("/");
-    outpath.append(basename);
+  } catch (...) {
+    zip_close(z);
+    throw;
+  }
+  zip_close(z);
+}
 
-    FILE *outfile = base_fopen(outpath.c_str(), "w+");
-    if (!outfile) {
-      zip_fclose(file);
+void ModelFile::extract_all_pending() {
+  RecMutexLock lock(_mutex);
+
+  if (_pending_entries.empty())
+    return;
+
+  zip *z = open_zip_archive(_archive_path);
+  try {
+    while (!_pending_entries.empty()) {
+      extract_zip_entry(z, _pending_entries.begin()->second, _content_dir);
+      stamp_file(_pending_entries.begin()->first);
+      _pending_entries.erase(_pending_entries.begin());
+    }
+  } catch (...) {
+    zip_close(z);
+    throw;
+  }
+  zip_close(z);
+}
+
+/**
+ * Returns the contents of a document file, reading it straight from the archive if it wasn't extracted.
+ */
+std::string ModelFile::read_document_data(const std::string &name) {
+  RecMutexLock lock(_mutex);
+
+  std::map<std::string, int>::const_iterator iter = _pending_entries.find(name);
+  if (iter != _pending_entries.end()) {
+    zip *z = open_zip_archive(_archive_path);
+    try {
+      std::string data = read_zip_entry(z, iter->second);
       zip_close(z);
-      throw grt::os_error(_("Error creating temporary file while opending document."), errno);
+      return data;
+    } catch (...) {
+      zip_close(z);
+      throw;
     }
+  }
+
+  gchar *contents = 0;
+  gsize length;
+  if (!g_file_get_contents((_content_dir + "/" + name).c_str(), &contents, &length, NULL))
+    throw std::runtime_error("Error reading document file " + name);
+
+  std::string data(contents, length);
+  g_free(contents);
+  return data;
+}
+
+xmlDocPtr ModelFile::load_document_xml() {
+  if (!is_pending(MAIN_DOCUMENT_NAME))
+    return grt::GRT::get()->load_xml(_content_dir + "/" + MAIN_DOCUMENT_NAME);
+
+  std::string data = read_document_data(MAIN_DOCUMENT_NAME);
+  xmlDocPtr xmldoc = xmlParseMemory(data.data(), (int)data.size());
+  if (xmldoc == NULL)
+    throw std::runtime_error("unable to parse XML file " MAIN_DOCUMENT_NAME);
+
+  return xmldoc;
+}
+
+//--------------------------------------------------------------------------------------------------
 
-    unpacked_files.push_back(outpath);
-
-    char buffer[4098];
-    ssize_t c;
-    while ((c = (size_t)zip_fread(file, buffer, sizeof(buffer))) > 0) {
-      if ((ssize_t)fwrite(buffer, 1, c, outfile) < c) {
-        int err = ferror(outfile);
-        fclose(outfile);
-        zip_fclose(file);
-        zip_close(z);
-        throw grt::os_error(_("Error writing temporary file while opending document."), err);
+static bool stat_file(const std::string &path, int64_t &size, time_t &mtime) {
+  GStatBuf st;
+  if (g_stat(path.c_str(), &st) != 0)
+    return false;
+
+  size = st.st_size;
+  mtime = st.st_mtime;
+  return true;
+}
+
+/**
+ * Collects the names of all files in the given directory and its subdirectories, relative to that directory.
+ */
+static void list_dir_files(const std::string &dir, const std::string &prefix, std::vector<std::string> &files) {
+  GError *error = 0;
+  GDir *gdir = g_dir_open(dir.c_str(), 0, &error);
+  if (!gdir) {
+    std::string err = error ? error->message : "Cannot open document directory.";
+    if (error)
+      g_error_free(error);
+    throw grt::os_error(err);
+  }
+
+  const gchar *entry;
+  while ((entry = g_dir_read_name(gdir))) {
+    std::string name = prefix.empty() ? entry : prefix + "/" + entry;
+    std::string path = dir + "/" + entry;
+
+    if (g_file_test(path.c_str(), G_FILE_TEST_IS_DIR)) {
+      try {
+        list_dir_files(path, name, files);
+      } catch (...) {
+        g_dir_close(gdir);
+        throw;
       }
+    } else
+      files.push_back(name);
+  }
+  g_dir_close(gdir);
+}
+
+void ModelFile::stamp_file(const std::string &name) {
+  FileStamp stamp;
+  if (stat_file(_content_dir + "/" + name, stamp.size, stamp.mtime)) {
+    stamp.taken = time(NULL);
+    _archived_files[name] = stamp;
+  } else
+    _archived_files.erase(name);
+}
+
+/**
+ * Returns true if the file is known to be stored in the archive as it is now.
+ */
+bool ModelFile::is_file_unchanged(const std::string &name) {
+  std::map<std::string, FileStamp>::const_iterator iter = _archived_files.find(name);
+  if (iter == _archived_files.end())
+    return false;
+
+  int64_t size;
+  time_t mtime;
+  if (!stat_file(_content_dir + "/" + name, size, mtime))
+    return false;
+
+  return size == iter->second.size && mtime == iter->second.mtime && mtime < iter->second.taken;
+}
+
+/**
+ * Remembers the given archive as the one the document directory is in sync with: stamps all extracted
+ * files and looks up where the entries that were not extracted yet are now.
+ */
+void ModelFile::record_archive_state(const std::string &zipfile) {
+  _archive_path = zipfile;
+  if (!stat_file(zipfile, _archive_stamp.size, _archive_stamp.mtime))
+    _archive_stamp.size = -1;
+  _archive_stamp.taken = time(NULL);
+
+  std::vector<std::string> files;
+  list_dir_files(_content_dir, "", files);
+
+  _archived_files.clear();
+  for (std::vector<std::string>::const_iterator iter = files.begin(); iter != files.end(); ++iter)
+    stamp_file(*iter);
+
+  if (_pending_entries.empty())
+    return;
+
+  zip *z = open_zip_archive(zipfile);
+  for (std::map<std::string, int>::iterator iter = _pending_entries.begin(); iter != _pending_entries.end(); ++iter) {
+    int index = (int)zip_name_locate(z, iter->first.c_str(), 0);
+    if (index < 0) {
+      zip_close(z);
+      throw std::runtime_error(strfmt(_("Entry %s is missing in document file"), iter->first.c_str()));
     }
+    iter->second = index;
+  }
+  zip_close(z);
+}
 
-    if (c < 0) {
-      std::string err = zip_file_strerror(file) ? zip_file_strerror(file) : "";
-      zip_fclose(file);
+/**
+ * Returns true if the given file is the archive the document directory is in sync with and nobody else
+ * has written to it since.
+ */
+bool ModelFile::can_update_archive(const std::string &zipfile) {
+  if (_archive_path.empty() || zipfile != _archive_path)
+    return false;
+
+  int64_t size;
+  time_t mtime;
+  return stat_file(zipfile, size, mtime) && size == _archive_stamp.size && mtime == _archive_stamp.mtime;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+static void set_archive_comment(zip *z, const std::string &comment) {
+  std::string zip_comment = ZIP_FILE_COMMENT;
+  if (!comment.empty()) {
+    zip_comment += '\n';
+    zip_comment += comment;
+  }
+
+#if defined(zip_uint16_t) || defined(_MSC_VER)
+  zip_set_archive_comment(z, zip_comment.c_str(), (zip_uint16_t)zip_comment.size());
+#else
+  zip_set_archive_comment(z, zip_comment.c_str(), (int)zip_comment.size());
+#endif
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Compresses the larger files of a document directory in parallel, each into an archive of its own. The
+ * entries are then copied from there into the document archive as they are, so zip_close() only has to
+ * compress the small files. Files which could not be compressed up front are simply read by libzip as before.
+ */
+class ParallelCompressor {
+public:
+  ParallelCompressor(const std::string &source_dir, const std::string &scratch_dir)
+    : _source_dir(source_dir), _scratch_dir(absolute_path(scratch_dir)) {
+  }
+
+  // Must only go after the document archive was closed, that's when the entries are copied.
+  ~ParallelCompressor() {
+    // Only read from, so closing doesn't write anything.
+    for (std::map<std::string, zip *>::iterator iter = _opened.begin(); iter != _opened.end(); ++iter)
+      zip_close(iter->second);
+    if (!_compressed.empty())
+      rmdir_recursively(_scratch_dir.c_str());
+  }
+
+  // Names are relative to the source directory.
+  void compress(const std::vector<std::string> &names) {
+    std::vector<std::string> candidates;
+    for (std::vector<std::string>::const_iterator name = names.begin(); name != names.end(); ++name) {
+      int64_t size;
+      time_t mtime;
+      if (stat_file(_source_dir + "/" + *name, size, mtime) && size >= min_size)
+        candidates.push_back(*name);
+    }
+
+    // Nothing to run side by side.
+    if (candidates.size() < 2)
+      return;
+
+    rmdir_recursively(_scratch_dir.c_str());
+    if (g_mkdir_with_parents(_scratch_dir.c_str(), 0700) < 0) {
+      logWarning("Could not create %s, compressing document files sequentially", _scratch_dir.c_str());
+      return;
+    }
+
+    std::vector<std::string> results(candidates.size());
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+      for (size_t i; (i = next++) < candidates.size();)
+        results[i] =
+          compress_file(_source_dir + "/" + candidates[i], strfmt("%s/%u.zip", _scratch_dir.c_str(), (unsigned)i));
+    };
+
+    size_t count = std::min<size_t>(std::max(1U, std::thread::hardware_concurrency()), candidates.size());
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < count; ++i)
+      threads.push_back(std::thread(worker));
+    for (std::vector<std::thread>::iterator thread = threads.begin(); thread != threads.end(); ++thread)
+      thread->join();
+
+    for (size_t i = 0; i < candidates.size(); ++i)
+      if (!results[i].empty())
+        _compressed[candidates[i]] = results[i];
+  }
+
+  // Returns a source with the already compressed data for the given file, if there is one, or one reading the file.
+  zip_source *source_for(zip *z, const std::string &name) {
+    std::string key = name;
+    std::replace(key.begin(), key.end(), '\\', '/');
+
+    std::map<std::string, std::string>::const_iterator iter = _compressed.find(key);
+    if (iter != _compressed.end()) {
+      int err = 0;
+      zip *compressed = zip_open(iter->second.c_str(), 0, &err);
+      if (compressed) {
+        _opened[key] = compressed;
+        zip_source *src = zip_source_zip(z, compressed, 0, 0, 0, -1);
+        if (src)
+          return src;
+      }
+      logWarning("Could not use compressed copy of %s", name.c_str());
+    }
+
+    return zip_source_file(z, name.c_str(), 0, 0);
+  }
+
+private:
+  static const int64_t min_size = 256 * 1024;
+
+  std::string _source_dir;
+  std::string _scratch_dir;
+  std::map<std::string, std::string> _compressed; //< file name -> archive with its compressed data
+  std::map<std::string, zip *> _opened;
+
+  // Runs on a worker thread. Returns the path of the archive or an empty string on failure.
+  static std::string compress_file(const std::string &path, const std::string &zipfile) {
+    int err = 0;
+    zip *z = zip_open(zipfile.c_str(), ZIP_CREATE, &err);
+    if (!z)
+      return "";
+
+    zip_source *src = zip_source_file(z, path.c_str(), 0, 0);
+#ifdef _MSC_VER
+    if (!src || zip_file_add(z, "data", src, 0) < 0) {
+#else
+    if (!src || zip_add(z, "data", src) < 0) {
+#endif
+      zip_source_free(src);
       zip_close(z);
-      throw std::runtime_error(strfmt(_("Error opening document file: %s"), err.c_str()));
+      return "";
     }
 
-    zip_fclose(file);
-    fclose(outfile);
+    if (zip_close(z) < 0) {
+      zip_unchange_all(z);
+      zip_close(z);
+      g_remove(zipfile.c_str());
+      return "";
+    }
+    return zipfile;
   }
+};
 
-  zip_close(z);
+/**
+ * Adds the file with the given (relative) name to the archive or, if index is not negative, replaces that entry.
+ */
+static void put_zip_file(zip *z, const std::string &name, int index, ParallelCompressor &compressor) {
+  zip_source *src = compressor.source_for(z, name);
+  if (!src)
+    throw std::runtime_error(zip_strerror(z));
 
-  return unpacked_files;
+#ifdef _MSC_VER
+  int rc = index < 0 ? (int)zip_file_add(z, name.c_str(), src, ZIP_FL_ENC_UTF_8) : zip_file_replace(z, index, src, 0);
+#else
+  int rc = index < 0 ? zip_add(z, name.c_str(), src) : zip_replace(z, index, src);
+#endif
+  if (rc < 0) {
+    zip_source_free(src);
+    throw std::runtime_error(zip_strerror(z));
+  }
 }
 
-static void zip_dir_contents(zip *z, const std::string &destdir, const std::string &partial) {
+
+static void zip_dir_contents(zip *z, const std::string &destdir, const std::string &partial,
+                             ParallelCompressor &compressor) {
   GError *error = 0;
   GDir *dir = g_dir_open(destdir.empty() ? "." : destdir.c_str(), 0, &error);
   if (!dir) {
@@ -574,7 +1138,7 @@ static void zip_dir_contents(zip *z, const std::string &destdir, const std::stri
       if (g_file_test(tmp.c_str(), G_FILE_TEST_IS_DIR)) {
         if (add_directories) {
           try {
-            zip_dir_contents(z, destdir.empty() ? entry : destdir + G_DIR_SEPARATOR + entry, tmp);
+            zip_dir_contents(z, destdir.empty() ? entry : destdir + G_DIR_SEPARATOR + entry, tmp, compressor);
           } catch (...) {
             g_dir_close(dir);
             throw;
@@ -582,7 +1146,7 @@ static void zip_dir_contents(zip *z, const std::string &destdir, const std::stri
         }
       } else {
         if (!add_directories) {
-          zip_source *src = zip_source_file(z, tmp.c_str(), 0, 0);
+          zip_source *src = compressor.source_for(z, tmp);
 #ifdef _MSC_VER
           if (!src || zip_file_add(z, tmp.c_str(), src, ZIP_FL_OVERWRITE | ZIP_FL_ENC_UTF_8) < 0) {
             zip_source_free(src);
@@ -605,6 +1169,16 @@ static void zip_dir_contents(zip *z, const std::string &destdir, const std::stri
 }
 
 void ModelFile::pack_zip(const std::string &zipfile, const std::string &destdir, const std::string &comment) {
+  // Declared first, the compressed data is only copied when the archive is closed.
+  ParallelCompressor compressor(destdir, destdir + "-zip");
+  try {
+    std::vector<std::string> files;
+    list_dir_files(destdir, "", files);
+    compressor.compress(files);
+  } catch (std::exception &) {
+    // Reported below, when zipping the directory.
+  }
+
   std::string curdir;
 
   {
@@ -641,20 +1215,84 @@ void ModelFile::pack_zip(const std::string &zipfile, const std::string &destdir,
       throw grt::os_error("Cannot create file.");
   }
 
-  std::string zip_comment = ZIP_FILE_COMMENT;
-  if (!comment.empty()) {
-    zip_comment += '\n';
-    zip_comment += comment;
+  set_archive_comment(z, comment);
+
+  try {
+    zip_dir_contents(z, "", "", compressor);
+
+    if (zip_close(z) < 0) {
+      std::string err = zip_strerror(z) ? zip_strerror(z) : "";
+
+      throw std::runtime_error(strfmt(_("Error writing zip file: %s"), err.c_str()));
+    }
+
+    g_chdir(curdir.c_str());
+  } catch (...) {
+    zip_close(z);
+    g_chdir(curdir.c_str());
+    throw;
   }
+}
 
-#if defined(zip_uint16_t) || defined(_MSC_VER)
-  zip_set_archive_comment(z, zip_comment.c_str(), (zip_uint16_t)zip_comment.size());
-#else
-  zip_set_archive_comment(z, zip_comment.c_str(), (int)zip_comment.size());
-#endif
+/**
+ * Brings the archive the document was read from in sync with the document directory. Entries of files
+ * that were not modified and entries that were never extracted are left alone, so that libzip copies
+ * them over as they are instead of compressing them again.
+ */
+void ModelFile::update_zip(const std::string &zipfile, const std::string &comment) {
+  std::vector<std::string> files;
+  list_dir_files(_content_dir, "", files);
+  std::set<std::string> new_files(files.begin(), files.end());
+
+  std::vector<std::string> changed_files;
+  for (std::vector<std::string>::const_iterator file = files.begin(); file != files.end(); ++file)
+    if (!is_file_unchanged(*file))
+      changed_files.push_back(*file);
+  ParallelCompressor compressor(_content_dir, _content_dir + "-zip");
+  compressor.compress(changed_files);
+
+  std::string curdir;
+  {
+    gchar *cwd = g_get_current_dir();
+    curdir = cwd;
+    g_free(cwd);
+  }
+
+  // Same as for pack_zip, so that the entries get relative names.
+  if (g_chdir(_content_dir.c_str()) < 0)
+    throw grt::os_error("chdir failed.");
+
+  int err = 0;
+  zip *z = zip_open(zipfile.c_str(), 0, &err);
+  if (!z) {
+    g_chdir(curdir.c_str());
+    if (err == ZIP_ER_MEMORY)
+      throw grt::os_error("Cannot allocate enough temporary memory to save document.");
+    throw grt::os_error("Cannot open document file for update.");
+  }
+
+  set_archive_comment(z, comment);
 
   try {
-    zip_dir_contents(z, "", "");
+    for (int count = zip_entry_count(z), i = 0; i < count; i++) {
+      const char *zname = zip_get_name(z, i, 0);
+      if (!zname || _pending_entries.find(zname) != _pending_entries.end())
+        continue;
+
+      std::set<std::string>::iterator file = new_files.find(zname);
+      if (file == new_files.end()) {
+        if (!base::hasSuffix(zname, "/") && zip_delete(z, i) < 0)
+          throw std::runtime_error(zip_strerror(z));
+        continue;
+      }
+
+      if (!is_file_unchanged(*file))
+        put_zip_file(z, *file, i, compressor);
+      new_files.erase(file);
+    }
+
+    for (std::set<std::string>::const_iterator file = new_files.begin(); file != new_files.end(); ++file)
+      put_zip_file(z, *file, -1, compressor);
 
     if (zip_close(z) < 0) {
       std::string err = zip_strerror(z) ? zip_strerror(z) : "";
@@ -664,6 +1302,8 @@ void ModelFile::pack_zip(const std::string &zipfile, const std::string &destdir,
 
     g_chdir(curdir.c_str());
   } catch (...) {
+    // Leave the archive as it was.
+    zip_unchange_all(z);
     zip_close(z);
     g_chdir(curdir.c_str());
     throw;
@@ -719,7 +1359,17 @@ workbench_DocumentRef ModelFile::unserialize_document(xmlDocPtr xmldoc, const st
  * model files can be renamed to .bak.
  */
 bool ModelFile::save_to(const std::string &path, const std::string &comment) {
+  // The auto-save takes the lock, the document write doesn't and goes on while the file is prepared.
+  wait_for_autosave_write();
+
   RecMutexLock lock(_mutex);
+
+  // Saving over the archive the document is in sync with only rewrites what changed. Otherwise a new archive
+  // is written and the old one goes away, so anything not yet extracted must be fetched now.
+  std::string zipfile = absolute_path(path);
+  bool update_in_place = can_update_archive(zipfile);
+  if (!update_in_place)
+    extract_all_pending();
 #ifdef _MSC_VER
   const int read_write = _S_IWRITE | _S_IREAD;
 #else
@@ -769,29 +1419,43 @@ bool ModelFile::save_to(const std::string &path, const std::string &comment) {
         return false;
       }
     }
-    if (g_rename(path.c_str(), tmp.c_str()) < 0)
+    // Errors writing the documents are reported before the existing file is touched.
+    finish_document_write();
+
+    if (update_in_place) {
+      // The archive is updated in place, so the backup must be a copy.
+      try {
+        copy_file(path, tmp);
+      } catch (std::exception &exc) {
+        throw grt::os_error("Saving the document failed. The existing model file " + path +
+                            " could not be backed up: " + exc.what());
+      }
+    } else if (g_rename(path.c_str(), tmp.c_str()) < 0)
       throw grt::os_error("Saving the document failed. The existing model file " + path +
                             " could not"
                             "be backed up. The system returned the error: \n\n",
                           errno);
   }
 
-  for (std::list<std::string>::const_iterator iter = _delete_queue.begin(); iter != _delete_queue.end(); ++iter)
-    g_remove(get_path_for(*iter).c_str());
+  for (std::list<std::string>::const_iterator iter = _delete_queue.begin(); iter != _delete_queue.end(); ++iter) {
+    _pending_entries.erase(*iter);
+    g_remove((_content_dir + "/" + *iter).c_str());
+  }
 
   _delete_queue.clear();
 
+  finish_document_write();
+
   // saving the file for real can delete the autosave
   g_remove(get_path_for("document-autosave.mwb.xml").c_str());
   g_remove(get_path_for("real_path").c_str());
 
-  if (g_path_is_absolute(path.c_str()))
-    pack_zip(path, _content_dir, comment);
-  else {
-    char *prefix = g_get_current_dir();
-    pack_zip(std::string(prefix).append("/").append(path), _content_dir, comment);
-    g_free(prefix);
-  }
+  if (update_in_place)
+    update_zip(zipfile, comment);
+  else
+    pack_zip(zipfile, _content_dir, comment);
+
+  record_archive_state(zipfile);
 
   _dirty = false;
   return true;
@@ -800,11 +1464,17 @@ bool ModelFile::save_to(const std::string &path, const std::string &comment) {
 //--------------------------------------------------------------------------------------------------
 
 void ModelFile::cleanup() {
+  wait_for_background_write();
+
   RecMutexLock lock(_mutex);
 
   delete _temp_dir_lock;
   _temp_dir_lock = 0;
 
+  _pending_entries.clear();
+  _archived_files.clear();
+  _archive_path.clear();
+
   if (!_content_dir.empty())
     rmdir_recursively(_content_dir.c_str());
 }
@@ -820,6 +1490,8 @@ std::string ModelFile::get_rel_db_file_path() {
 }
 
 std::string ModelFile::get_db_file_dir_path() {
+  extract_pending(DB_DIR);
+
   return _content_dir + "/" + DB_DIR;
 }
 
@@ -871,26 +1543,31 @@ std::string ModelFile::add_attachment_file(const std::string &destdir, const std
 
 std::string ModelFile::add_image_file(const std::string &path) {
   _dirty = true;
+  extract_pending(IMAGES_DIR); // so that the new file name doesn't clash with one still in the archive
 
   return add_attachment_file(_content_dir + "/" + IMAGES_DIR, path);
 }
 
 std::string ModelFile::add_script_file(const std::string &path) {
   _dirty = true;
+  extract_pending(SCRIPTS_DIR); // so that the new file name doesn't clash with one still in the archive
 
   return add_attachment_file(_content_dir + "/" + SCRIPTS_DIR, path);
 }
 
 std::string ModelFile::add_note_file(const std::string &path) {
   _dirty = true;
+  extract_pending(NOTES_DIR); // so that the new file name doesn't clash with one still in the archive
 
   return add_attachment_file(_content_dir + "/" + NOTES_DIR, path);
 }
 
 bool ModelFile::has_file(const std::string &name) {
+  wait_for_document_file(name);
+
   RecMutexLock lock(_mutex);
 
-  return g_file_test(get_path_for(name).c_str(), G_FILE_TEST_EXISTS) != 0;
+  return is_pending(name) || g_file_test((_content_dir + "/" + name).c_str(), G_FILE_TEST_EXISTS) != 0;
 }
 
 void ModelFile::set_file_contents(const std::string &path, const std::string &data) {
@@ -898,7 +1575,10 @@ void ModelFile::set_file_contents(const std::string &path, const std::string &da
 }
 
 void ModelFile::set_file_contents(const std::string &path, const char *data, size_t size) {
-  std::string fpath = get_path_for(path);
+  RecMutexLock lock(_mutex);
+
+  _pending_entries.erase(path);
+  std::string fpath = _content_dir + "/" + path;
 
   GError *error = NULL;
   g_file_set_contents(fpath.c_str(), data, (gssize)size, &error);
@@ -907,28 +1587,211 @@ void ModelFile::set_file_contents(const std::string &path, const char *data, siz
 }
 
 std::string ModelFile::get_file_contents(const std::string &path) {
-  gchar *contents = 0;
-  gsize length;
-  std::string tmp;
+  wait_for_document_file(path);
+  try {
+    return read_document_data(path);
+  } catch (std::exception &) {
+    throw std::runtime_error("Error reading attached file contents.");
+  }
+}
+
+/**
+ * The token which ties the binary document to the XML document it was stored with.
+ */
+static std::string make_document_token(unsigned long crc, uint64_t size) {
+  return strfmt("crc32:%08lx:%llu", crc & 0xffffffffUL, (unsigned long long)size);
+}
+
+static std::string make_document_token(const std::string &data) {
+  uLong crc = crc32(0L, Z_NULL, 0);
+  for (size_t offset = 0; offset < data.size(); offset += 0x40000000) {
+    uInt length = (uInt)std::min(data.size() - offset, (size_t)0x40000000);
+    crc = crc32(crc, (const Bytef *)data.data() + offset, length);
+  }
+
+  return make_document_token(crc, data.size());
+}
+
+/**
+ * Formats the XML tree of a document snapshot. Runs on a worker thread.
+ */
+static std::string format_xml_document(xmlDocPtr xmldoc) {
+  xmlChar *buffer = NULL;
+  int size = 0;
+
+  xmlDocDumpFormatMemory(xmldoc, &buffer, &size, 1);
+  if (buffer == NULL)
+    throw std::runtime_error("Could not format document data");
+
+  std::string data((const char *)buffer, size);
+  xmlFree(buffer);
+
+  return data;
+}
 
-  if (g_file_get_contents(get_path_for(path).c_str(), &contents, &length, NULL)) {
-    tmp = std::string(contents, length);
-    g_free(contents);
-    return tmp;
+static void write_document_file(const std::string &path, const std::string &data) {
+  GError *error = NULL;
+  if (!g_file_set_contents(path.c_str(), data.data(), (gssize)data.size(), &error)) {
+    std::string message = error ? error->message : "unknown error";
+    if (error)
+      g_error_free(error);
+    throw std::runtime_error("Could not save document data to file " + path + ": " + message);
   }
+}
 
-  throw std::runtime_error("Error reading attached file contents.");
+static void write_binary_document(std::string data, const std::string &token, const std::string &path) {
+  // The XML document is all that's needed to load the model, so a failure here must not fail the save.
+  if (data.empty() || !grt::GRT::get()->set_binary_data_source_tag(data, token)) {
+    g_remove(path.c_str());
+    return;
+  }
+
+  try {
+    write_document_file(path, data);
+  } catch (std::exception &exc) {
+    logWarning("Could not store binary document: %s", exc.what());
+    g_remove(path.c_str());
+  }
+}
+
+/**
+ * Writes both documents of a snapshot to the given directory and frees the XML tree. Runs on a worker thread,
+ * the binary document is encoded from the XML tree on another one while the XML is formatted.
+ */
+static void write_document_snapshot(xmlDocPtr xmldoc, const std::string &dir) {
+  std::future<std::string> binary_data = std::async(std::launch::async, [xmldoc]() {
+    try {
+      return grt::GRT::get()->serialize_binary_data(xmldoc);
+    } catch (std::exception &exc) {
+      logWarning("Could not encode binary document: %s", exc.what());
+      return std::string();
+    }
+  });
+
+  std::string data;
+  try {
+    data = format_xml_document(xmldoc);
+  } catch (...) {
+    binary_data.wait();
+    xmlFreeDoc(xmldoc);
+    throw;
+  }
+  std::string binary = binary_data.get();
+  xmlFreeDoc(xmldoc);
+
+  write_document_file(dir + "/" + MAIN_DOCUMENT_NAME, data);
+  write_binary_document(binary, make_document_token(data), dir + "/" + MAIN_DOCUMENT_BINARY_NAME);
+}
+
+// Rethrows what went wrong writing the documents.
+void ModelFile::finish_document_write() {
+  if (_document_write.valid())
+    _document_write.get();
+}
+
+void ModelFile::wait_for_autosave_write() {
+  if (_background_write.valid())
+    _background_write.get();
+}
+
+/**
+ * Waits for everything still being written. A document write that wasn't picked up by save_to() belongs
+ * to a save that didn't go through, so it has nothing left to report.
+ */
+void ModelFile::wait_for_background_write() {
+  wait_for_autosave_write();
+  if (_document_write.valid())
+    _document_write.wait();
+}
+
+/**
+ * Makes sure the documents are completely written before they are accessed as files.
+ */
+void ModelFile::wait_for_document_file(const std::string &name) {
+  if (_document_write.valid() && (name == MAIN_DOCUMENT_NAME || name == MAIN_DOCUMENT_BINARY_NAME))
+    _document_write.wait();
 }
 
 // writing
 void ModelFile::store_document(const workbench_DocumentRef &doc) {
-  grt::GRT::get()->serialize(doc, get_path_for(MAIN_DOCUMENT_NAME), DOCUMENT_FORMAT, DOCUMENT_VERSION);
+  wait_for_background_write();
+
+  RecMutexLock lock(_mutex);
+
+  _pending_entries.erase(MAIN_DOCUMENT_NAME);
+  _pending_entries.erase(MAIN_DOCUMENT_BINARY_NAME);
+
+  // GRT values can only be accessed from here, so only the XML tree is built on the calling thread. That
+  // tree is the snapshot both documents are made from in the background, save_to() waits for them.
+  xmlDocPtr xmldoc = grt::GRT::get()->create_xml_document(doc, DOCUMENT_FORMAT, DOCUMENT_VERSION);
+  _document_write = std::async(std::launch::async, write_document_snapshot, xmldoc, _content_dir);
 
   _dirty = true;
 }
 
+/**
+ * Returns the token of the XML document, to compare with the one in the binary document. For a document
+ * still in the archive that's taken from the CRC-32 and size the archive keeps for the entry.
+ */
+std::string ModelFile::document_token() {
+  RecMutexLock lock(_mutex);
+
+  std::map<std::string, int>::const_iterator iter = _pending_entries.find(MAIN_DOCUMENT_NAME);
+  if (iter != _pending_entries.end()) {
+    try {
+      zip *z = open_zip_archive(_archive_path);
+      struct zip_stat st;
+      zip_stat_init(&st);
+      bool found = zip_stat_index(z, iter->second, 0, &st) == 0 && (st.valid & ZIP_STAT_CRC) &&
+                   (st.valid & ZIP_STAT_SIZE);
+      zip_close(z);
+
+      return found ? make_document_token(st.crc, st.size) : "";
+    } catch (std::exception &) {
+      return "";
+    }
+  }
+
+  // Already extracted (e.g. when recovering an auto-save), the file has to be read.
+  std::string data;
+  try {
+    data = read_document_data(MAIN_DOCUMENT_NAME);
+  } catch (std::exception &) {
+    return "";
+  }
+
+  return make_document_token(data);
+}
+
+/**
+ * Only takes the snapshot of the document (the XML tree, built on the calling thread). Formatting and writing
+ * the auto-save file happens in the background.
+ */
 void ModelFile::store_document_autosave(const workbench_DocumentRef &doc) {
-  grt::GRT::get()->serialize(doc, get_path_for("document-autosave.mwb.xml"), DOCUMENT_FORMAT, DOCUMENT_VERSION);
+  wait_for_background_write();
+
+  xmlDocPtr xmldoc = grt::GRT::get()->create_xml_document(doc, DOCUMENT_FORMAT, DOCUMENT_VERSION);
+  std::string path = _content_dir + "/" + MAIN_DOCUMENT_AUTOSAVE_NAME;
+
+  _background_write = std::async(std::launch::async, [this, xmldoc, path]() {
+    try {
+      std::string data;
+      try {
+        data = format_xml_document(xmldoc);
+      } catch (...) {
+        xmlFreeDoc(xmldoc);
+        throw;
+      }
+      xmlFreeDoc(xmldoc);
+
+      RecMutexLock lock(_mutex);
+      // A recovered auto-save directory must be usable without the original archive.
+      extract_all_pending();
+      write_document_file(path, data);
+    } catch (std::exception &exc) {
+      logError("Could not store document data to autosave file: %s", exc.what());
+    }
+  });
 }
 
 void ModelFile::delete_file(const std::string &path) {
@@ -970,6 +1833,8 @@ void ModelFile::check_and_fix_data_file_bug() {
 // in a different platform and extra data was added since.
 
 #ifndef _MSC_VER
+  extract_pending(std::string(DB_DIR) + "\\" + DB_FILE);
+
   // check if @db\data.db exists and is a file
   std::string data_filename_in_windows = _content_dir + "/" + DB_DIR + "\\" + DB_FILE;
   if (g_file_test(data_filename_in_windows.c_str(), (GFileTest)(G_FILE_TEST_EXISTS | G_FILE_TEST_IS_REGULAR))) {
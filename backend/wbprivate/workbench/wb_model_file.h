@@ -26,6 +26,7 @@
 #include "wb_backend_public_interface.h"
 
 #include <string>
+#include <future>
 #include "grt.h"
 #include "base/file_utilities.h"
 #include "grts/structs.workbench.h"
@@ -37,6 +38,7 @@
 
 #define MAIN_DOCUMENT_NAME "document.mwb.xml"
 #define MAIN_DOCUMENT_AUTOSAVE_NAME "document-autosave.mwb.xml"
+#define MAIN_DOCUMENT_BINARY_NAME "document.mwb.grtb"
 
 namespace bec {
   class GRTManager;
@@ -49,7 +51,7 @@ namespace wb {
     ~ModelFile();
 
     void create();
-    void open(const std::string &path);
+    void open(const std::string &path, bool extract_on_demand = false);
 
     static std::string read_comment(const std::string &path);
 
@@ -67,7 +69,11 @@ namespace wb {
       return _load_warnings;
     }
 
+    // Both only build the XML tree on the calling thread, as that needs the GRT values, and return. The files
+    // are written from that snapshot in the background. save_to() waits for the ones of store_document() and
+    // reports their errors.
     void store_document(const workbench_DocumentRef &doc);
+    // Returns after taking the snapshot, the file is written in the background.
     void store_document_autosave(const workbench_DocumentRef &doc);
 
     std::list<std::string> get_file_list(const std::string &prefixdir = "");
@@ -120,6 +126,20 @@ namespace wb {
 
     std::list<std::string> _load_warnings; //< warnings from loaded model
 
+    struct FileStamp {
+      int64_t size;
+      time_t mtime;
+      time_t taken; //< when the stamp was taken, a file modified in that same second can't be told apart
+    };
+
+    std::string _archive_path;                     //< archive the document contents were last read from or saved to
+    FileStamp _archive_stamp;                      //< state of that archive, to detect changes by others
+    std::map<std::string, int> _pending_entries;   //< archive entries not yet extracted -> index in archive
+    std::map<std::string, FileStamp> _archived_files; //< extracted files, as they were when stored in the archive
+
+    std::future<void> _background_write; //< auto-save still being written
+    std::future<void> _document_write;   //< documents from store_document() still being written
+
     bool _dirty;
 
     typedef std::map<std::string, std::string> TableInsertsSqlScripts; // table guid -> sql script (inserts)
@@ -130,6 +150,15 @@ namespace wb {
 
     workbench_DocumentRef unserialize_document(xmlDocPtr xmldoc, const std::string &path);
 
+    bool is_pending(const std::string &name);
+    void extract_pending(const std::string &name);
+    void extract_all_pending();
+    std::string read_document_data(const std::string &name);
+    xmlDocPtr load_document_xml();
+
+    std::string document_token();
+    workbench_DocumentRef retrieve_binary_document();
+
   private:
     bool attempt_xml_document_upgrade(xmlDocPtr xmldoc, const std::string &version);
     workbench_DocumentRef attempt_document_upgrade(const workbench_DocumentRef &doc, xmlDocPtr xmldoc,
@@ -143,6 +172,17 @@ namespace wb {
 
     void check_and_fix_inconsistencies(const workbench_DocumentRef &doc, const std::string &version);
 
+    void scan_zip(const std::string &zipfile);
+    void record_archive_state(const std::string &zipfile);
+    void stamp_file(const std::string &name);
+    bool is_file_unchanged(const std::string &name);
+    bool can_update_archive(const std::string &zipfile);
+    void update_zip(const std::string &zipfile, const std::string &comment);
+    void wait_for_autosave_write();
+    void wait_for_background_write();
+    void wait_for_document_file(const std::string &name);
+    void finish_document_write();
+
   public:
     static std::list<std::string> unpack_zip(const std::string &zipfile, const std::string &destdir);
     void pack_zip(const std::string &zipfile, const std::string &destdir, const std::string &comment = "");
@@ -189,8 +189,18 @@ namespace bec {
 
     void set_db_file_path(const std::string &db_file_path) {
       _db_file_path = db_file_path;
+      _db_file_path_slot = nullptr;
+    }
+    // For documents that extract their data file on demand: the slot is called on first use to get the path.
+    void set_db_file_path_slot(const std::function<std::string()> &slot) {
+      _db_file_path.clear();
+      _db_file_path_slot = slot;
     }
     std::string get_db_file_path() {
+      if (_db_file_path_slot) {
+        _db_file_path = _db_file_path_slot();
+        _db_file_path_slot = nullptr;
+      }
       return _db_file_path;
     }
 
@@ -263,6 +273,7 @@ namespace bec {
     std::string _struct_pathlist;
     std::string _libraries_pathlist;
     std::string _db_file_path;
+    std::function<std::string()> _db_file_path_slot;
 
     std::string _user_module_path;
     std::string _user_library_path;
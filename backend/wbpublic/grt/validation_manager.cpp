@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2007, 2018, Oracle and/or its affiliates. All rights reserved.
+ * Copyright (c) 2007, 2019, Oracle and/or its affiliates. All rights reserved.
  *
  * This program is free software; you can redistribute it and/or modify
  * it under the terms of the GNU General Public License, version 2.0,
@@ -25,11 +25,27 @@
 
 #include "validation_manager.h"
 #include "grt/grt_manager.h"
+#include "grts/structs.db.h"
+#include "base/string_utilities.h"
 
 #include <algorithm>
+#include <atomic>
+#include <exception>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
 
 DEFAULT_LOG_DOMAIN("validation")
 
+// Set while a ValidationCache runs validators on the current thread, receives their messages.
+static thread_local std::vector<bec::ValidationCache::Message>* collected_messages = nullptr;
+
+// The caches handed out by ValidationManager::cache_for(), by root object id.
+static std::mutex caches_mutex;
+static std::map<std::string, std::unique_ptr<bec::ValidationCache>> caches;
+
 //--------------------------------------------------------------------------------------------------
 
 bec::ValidationMessagesBE::ValidationMessagesBE() {
@@ -156,6 +172,193 @@ void bec::ValidationMessagesBE::validation_message(const grt::Validator::Tag& ta
 
 bec::ValidationManager::MessageSignal* bec::ValidationManager::_signal_notify = 0;
 
+//----------------- Default validators -------------------------------------------------------------
+
+namespace {
+
+  // Whether a validation for the given tag includes the check.
+  bool wants(const grt::Validator::Tag& tag, const grt::Validator::Tag& check) {
+    return tag == "All" || tag == check;
+  }
+
+  // Reports objects of the list having the same name (names are compared case insensitively).
+  template <class T>
+  int check_unique_names(const grt::Validator::Tag& tag, const grt::ObjectRef& owner, const grt::ListRef<T>& list,
+                         const std::string& what, std::set<std::string>& names) {
+    int result = 0;
+    for (size_t i = 0; i < list.count(); ++i) {
+      std::string name = list[i]->name();
+      if (!name.empty() && !names.insert(base::toupper(name)).second) {
+        bec::ValidationManager::message(
+          tag, owner, "Duplicate " + what + " name '" + name + "' in '" + owner->get_string_member("name") + "'",
+          grt::ErrorMsg);
+        result = 1;
+      }
+    }
+    return result;
+  }
+
+  class SchemaValidator : public grt::Validator {
+  public:
+    virtual int validate(const Tag& tag, const grt::ObjectRef& object) {
+      if (!wants(tag, CHECK_NAME))
+        return 0;
+
+      db_SchemaRef schema(db_SchemaRef::cast_from(object));
+      if ((*schema->name()).empty()) {
+        bec::ValidationManager::message(tag, object, "Schema without name", grt::ErrorMsg);
+        return 1;
+      }
+
+      std::set<std::string> names;
+      int result = check_unique_names(tag, object, schema->tables(), "table or view", names);
+      if (check_unique_names(tag, object, schema->views(), "table or view", names))
+        result = 1;
+      return result;
+    }
+  };
+
+  class TableValidator : public grt::Validator {
+  public:
+    virtual int validate(const Tag& tag, const grt::ObjectRef& object) {
+      db_TableRef table(db_TableRef::cast_from(object));
+      int result = 0;
+
+      if (wants(tag, CHECK_NAME)) {
+        if ((*table->name()).empty()) {
+          bec::ValidationManager::message(tag, object, "Table without name", grt::ErrorMsg);
+          result = 1;
+        }
+
+        std::set<std::string> column_names;
+        if (check_unique_names(tag, object, table->columns(), "column", column_names))
+          result = 1;
+        std::set<std::string> index_names;
+        if (check_unique_names(tag, object, table->indices(), "index", index_names))
+          result = 1;
+      }
+
+      if (wants(tag, "columns-count") && table->columns().count() == 0)
+        bec::ValidationManager::message(tag, object, "Table '" + *table->name() + "' has no columns",
+                                        grt::WarningMsg);
+
+      if (wants(tag, CHECK_EFFICIENCY) && !table->primaryKey().is_valid())
+        bec::ValidationManager::message(tag, object, "Table '" + *table->name() + "' has no primary key",
+                                        grt::WarningMsg);
+
+      return result;
+    }
+  };
+
+  class ColumnValidator : public grt::Validator {
+  public:
+    virtual int validate(const Tag& tag, const grt::ObjectRef& object) {
+      db_ColumnRef column(db_ColumnRef::cast_from(object));
+      std::string table = column->owner().is_valid() ? *column->owner()->name() : "";
+      int result = 0;
+
+      if (wants(tag, CHECK_NAME)) {
+        if ((*column->name()).empty()) {
+          bec::ValidationManager::message(tag, object, "Column without name in table '" + table + "'",
+                                          grt::ErrorMsg);
+          result = 1;
+        } else if ((*column->name()).size() > 64) {
+          bec::ValidationManager::message(tag, object,
+                                          "Name of column '" + *column->name() + "' in table '" + table +
+                                            "' is longer than 64 characters",
+                                          grt::ErrorMsg);
+          result = 1;
+        }
+      }
+
+      if (wants(tag, CHECK_SYNTAX) && !column->simpleType().is_valid() && !column->userType().is_valid()) {
+        bec::ValidationManager::message(
+          tag, object, "Column '" + *column->name() + "' in table '" + table + "' has no data type", grt::ErrorMsg);
+        result = 1;
+      }
+
+      return result;
+    }
+  };
+
+  class IndexValidator : public grt::Validator {
+  public:
+    virtual int validate(const Tag& tag, const grt::ObjectRef& object) {
+      db_IndexRef index(db_IndexRef::cast_from(object));
+      std::string table = index->owner().is_valid() ? *index->owner()->name() : "";
+
+      if (wants(tag, CHECK_NAME) && (*index->name()).empty()) {
+        bec::ValidationManager::message(tag, object, "Index without name in table '" + table + "'", grt::ErrorMsg);
+        return 1;
+      }
+
+      if (wants(tag, CHECK_EFFICIENCY) && index->columns().count() == 0)
+        bec::ValidationManager::message(tag, object,
+                                        "Index '" + *index->name() + "' in table '" + table + "' has no columns",
+                                        grt::WarningMsg);
+      return 0;
+    }
+  };
+
+  class ForeignKeyValidator : public grt::Validator {
+  public:
+    virtual int validate(const Tag& tag, const grt::ObjectRef& object) {
+      db_ForeignKeyRef fk(db_ForeignKeyRef::cast_from(object));
+      int result = 0;
+
+      if (wants(tag, CHECK_NAME) && (*fk->name()).empty()) {
+        std::string table = fk->owner().is_valid() ? *fk->owner()->name() : "";
+        bec::ValidationManager::message(tag, object, "Foreign key without name in table '" + table + "'",
+                                        grt::ErrorMsg);
+        result = 1;
+      }
+
+      if (!wants(tag, "chk_fk_lgc"))
+        return result;
+
+      db_TableRef table(fk->referencedTable());
+      if (!table.is_valid()) {
+        bec::ValidationManager::message(tag, object, "Foreign key '" + *fk->name() + "' has no referenced table",
+                                        grt::ErrorMsg);
+        return 1;
+      }
+
+      if (fk->columns().count() != fk->referencedColumns().count()) {
+        bec::ValidationManager::message(
+          tag, object, "Foreign key '" + *fk->name() + "' has a different number of columns than it references",
+          grt::ErrorMsg);
+        return 1;
+      }
+
+      for (size_t i = 0; i < fk->referencedColumns().count(); ++i) {
+        db_ColumnRef column(fk->columns()[i]);
+        db_ColumnRef referenced(fk->referencedColumns()[i]);
+        if (!column.is_valid() || !referenced.is_valid())
+          continue;
+
+        if (table->columns().get_index(referenced) == grt::BaseListRef::npos) {
+          bec::ValidationManager::message(tag, object,
+                                          "Foreign key '" + *fk->name() + "' refers to column '" +
+                                            *referenced->name() + "' which is not in table '" + *table->name() +
+                                            "'",
+                                          grt::ErrorMsg);
+          result = 1;
+        } else if (column->simpleType().is_valid() && referenced->simpleType().is_valid() &&
+                   column->simpleType() != referenced->simpleType()) {
+          bec::ValidationManager::message(tag, object,
+                                          "Column '" + *column->name() + "' of foreign key '" + *fk->name() +
+                                            "' has a different type than the referenced column '" +
+                                            *referenced->name() + "'",
+                                          grt::WarningMsg);
+        }
+      }
+
+      return result;
+    }
+  };
+
+}
+
 //--------------------------------------------------------------------------------------------------
 
 bool bec::ValidationManager::is_validation_plugin(const app_PluginRef& plugin) {
@@ -164,17 +367,45 @@ bool bec::ValidationManager::is_validation_plugin(const app_PluginRef& plugin) {
 
 //--------------------------------------------------------------------------------------------------
 
+static std::atomic<size_t> validator_count(0);
+
 void bec::ValidationManager::register_validator(const std::string& type, grt::Validator* v) {
   grt::MetaClass* mc = grt::GRT::get()->get_metaclass(type);
-  if (mc)
+  if (mc) {
     mc->add_validator(v);
-  else
+    ++validator_count;
+  } else
     logWarning("Specified metaclass '%s' is not known.\n", type.c_str());
 }
 
 //--------------------------------------------------------------------------------------------------
 
+bool bec::ValidationManager::has_validators() {
+  return validator_count > 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void bec::ValidationManager::register_default_validators() {
+  static SchemaValidator schema_validator;
+  static TableValidator table_validator;
+  static ColumnValidator column_validator;
+  static IndexValidator index_validator;
+  static ForeignKeyValidator foreign_key_validator;
+
+  // Metaclasses take each validator only once.
+  register_validator("db.Schema", &schema_validator);
+  register_validator("db.Table", &table_validator);
+  register_validator("db.Column", &column_validator);
+  register_validator("db.Index", &index_validator);
+  register_validator("db.ForeignKey", &foreign_key_validator);
+}
+
+//--------------------------------------------------------------------------------------------------
+
 void bec::ValidationManager::scan() {
+  register_default_validators();
+
   const std::vector<app_PluginRef> plugins = bec::GRTManager::get()->get_plugin_manager()->get_plugins_for_group("");
 
   for (size_t i = 0; i < plugins.size(); ++i) {
@@ -195,11 +426,31 @@ void bec::ValidationManager::scan() {
 //--------------------------------------------------------------------------------------------------
 
 bool bec::ValidationManager::validate_instance(const grt::ObjectRef& obj, const grt::Validator::Tag& tag) {
-  bool ret = true;
+  // Use the cache of the tree the object belongs to, if there is one.
+  ValidationCache* cache = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(caches_mutex);
+    GrtObjectRef object(GrtObjectRef::can_wrap(obj) ? GrtObjectRef::cast_from(obj) : GrtObjectRef());
+    for (; object.is_valid() && cache == nullptr; object = object->owner()) {
+      auto iterator = caches.find(object->id());
+      if (iterator != caches.end())
+        cache = iterator->second.get();
+    }
+  }
+  if (cache != nullptr)
+    return cache->validate(obj, tag);
 
   // Clear messages with corresponding tag from the object.
   (*signal_notify())(tag, obj, tag, grt::NoErrorMsg);
 
+  return run_validators(obj, tag);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool bec::ValidationManager::run_validators(const grt::ObjectRef& obj, const grt::Validator::Tag& tag) {
+  bool ret = true;
+
   static const grt::MetaClass* mc_to_break_checks = grt::GRT::get()->get_metaclass("db.DatabaseObject");
   grt::MetaClass* mc = obj->get_metaclass();
 
@@ -215,6 +466,11 @@ bool bec::ValidationManager::validate_instance(const grt::ObjectRef& obj, const
 
 void bec::ValidationManager::message(const grt::Validator::Tag& tag, const grt::ObjectRef& o, const std::string& m,
                                      const int level) {
+  if (collected_messages != nullptr) {
+    collected_messages->push_back({o, m, level});
+    return;
+  }
+
   // Add message to the Object
   (*signal_notify())(tag, o, m, level);
 }
@@ -222,8 +478,492 @@ void bec::ValidationManager::message(const grt::Validator::Tag& tag, const grt::
 //--------------------------------------------------------------------------------------------------
 
 void bec::ValidationManager::clear() {
+  {
+    std::lock_guard<std::mutex> lock(caches_mutex);
+    caches.clear();
+  }
+
   // Clear messages from listeners
   (*signal_notify())("*", grt::ObjectRef(), "", grt::NoErrorMsg);
 }
 
 //--------------------------------------------------------------------------------------------------
+
+bec::ValidationCache* bec::ValidationManager::cache_for(const GrtObjectRef& root) {
+  std::lock_guard<std::mutex> lock(caches_mutex);
+  std::unique_ptr<ValidationCache>& cache = caches[root->id()];
+  if (!cache)
+    cache.reset(new ValidationCache(root));
+  return cache.get();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+//----------------- ValidationCache ----------------------------------------------------------------
+
+// Calls f(member, value) for each set member of the object which holds objects, owned or referenced ones.
+template <typename F>
+static void foreach_object_member(const grt::ObjectRef& object, F f) {
+  object->get_metaclass()->foreach_member([&](const grt::MetaClass::Member* member) {
+    grt::Type type = member->type.base.type;
+    if (type == grt::ObjectType || (type == grt::ListType && member->type.content.type == grt::ObjectType)) {
+      grt::ValueRef value(object->get_member(member->name));
+      if (value.is_valid())
+        f(member, value);
+    }
+    return true;
+  });
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bec::ValidationCache::ValidationCache(const GrtObjectRef& root) : _root(root), _next_order(0) {
+  track(root, "");
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bec::ValidationCache::~ValidationCache() {
+  for (auto& entry : _entries) {
+    for (auto& connection : entry.second.connections)
+      connection.disconnect();
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Adds the object and everything it owns, all of it to be validated.
+ */
+void bec::ValidationCache::track(const grt::ObjectRef& object, const std::string& owner_id) {
+  if (!object.is_valid() || _entries.find(object->id()) != _entries.end())
+    return;
+
+  std::string id = object->id();
+  Entry& entry = _entries[id];
+  entry.object = object;
+  entry.owner_id = owner_id;
+  entry.order = _next_order++;
+  entry.changes = 0;
+  entry.references_changed = false;
+
+  entry.connections.push_back(object->signal_changed()->connect(
+    std::bind(&ValidationCache::member_changed, this, id, std::placeholders::_1, std::placeholders::_2)));
+  entry.connections.push_back(object->signal_list_changed()->connect(std::bind(
+    &ValidationCache::list_changed, this, id, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3)));
+  entry.connections.push_back(
+    object->signal_dict_changed()->connect(std::bind(&ValidationCache::dict_changed, this, id)));
+  update_references(entry);
+
+  foreach_object_member(object, [&](const grt::MetaClass::Member* member, const grt::ValueRef& value) {
+    if (!member->owned_object || member->name == "owner")
+      return;
+
+    if (value.type() == grt::ObjectType)
+      track(grt::ObjectRef::cast_from(value), id);
+    else {
+      grt::BaseListRef list(grt::BaseListRef::cast_from(value));
+      for (size_t i = 0; i < list.count(); ++i) {
+        if (grt::ObjectRef::can_wrap(list[i]))
+          track(grt::ObjectRef::cast_from(list[i]), id);
+      }
+    }
+  });
+
+  // Whatever refers to it may become valid now.
+  mark(id, true);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Drops the object and everything it owns. What referred to any of them has to be validated again.
+ */
+void bec::ValidationCache::untrack(const grt::ObjectRef& object) {
+  if (!object.is_valid())
+    return;
+
+  auto iterator = _entries.find(object->id());
+  if (iterator == _entries.end())
+    return;
+
+  mark(iterator->first, true);
+
+  Entry& entry = iterator->second;
+  for (auto& connection : entry.connections)
+    connection.disconnect();
+  entry.connections.clear();
+  update_references(entry);
+
+  foreach_object_member(object, [&](const grt::MetaClass::Member* member, const grt::ValueRef& value) {
+    if (!member->owned_object || member->name == "owner")
+      return;
+
+    if (value.type() == grt::ObjectType)
+      untrack(grt::ObjectRef::cast_from(value));
+    else {
+      grt::BaseListRef list(grt::BaseListRef::cast_from(value));
+      for (size_t i = 0; i < list.count(); ++i) {
+        if (grt::ObjectRef::can_wrap(list[i]))
+          untrack(grt::ObjectRef::cast_from(list[i]));
+      }
+    }
+  });
+
+  // The results are gone with the mark above, but the listeners still show the messages.
+  for (auto& tag : entry.reported)
+    _removed.push_back(std::make_pair(entry.object, tag));
+  _entries.erase(iterator);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Brings the list of objects the entry refers to up to date. An empty list of references just removes
+ * the old ones.
+ */
+void bec::ValidationCache::update_references(Entry& entry) {
+  const std::string& id = entry.object->id();
+  for (auto& reference : entry.references) {
+    auto range = _dependents.equal_range(reference);
+    for (auto dependent = range.first; dependent != range.second; ++dependent) {
+      if (dependent->second == id) {
+        _dependents.erase(dependent);
+        break;
+      }
+    }
+  }
+  entry.references.clear();
+  entry.references_changed = false;
+
+  if (entry.connections.empty()) // Untracked.
+    return;
+
+  foreach_object_member(entry.object, [&](const grt::MetaClass::Member* member, const grt::ValueRef& value) {
+    if (member->owned_object || member->name == "owner")
+      return;
+
+    if (value.type() == grt::ObjectType)
+      entry.references.push_back(grt::ObjectRef::cast_from(value)->id());
+    else {
+      grt::BaseListRef list(grt::BaseListRef::cast_from(value));
+      for (size_t i = 0; i < list.count(); ++i) {
+        if (grt::ObjectRef::can_wrap(list[i]))
+          entry.references.push_back(grt::ObjectRef::cast_from(list[i])->id());
+      }
+    }
+  });
+
+  for (auto& reference : entry.references)
+    _dependents.emplace(reference, id);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Drops the results of the object and its owners. With with_dependents also those of the objects
+ * referring to any of them (and their owners).
+ */
+void bec::ValidationCache::mark(const std::string& id, bool with_dependents) {
+  for (std::string current = id; !current.empty();) {
+    auto entry = _entries.find(current);
+    if (entry == _entries.end())
+      break;
+
+    if (with_dependents) {
+      auto range = _dependents.equal_range(current);
+      for (auto dependent = range.first; dependent != range.second; ++dependent)
+        mark(dependent->second, false);
+    }
+
+    // Owners can have results for tags their objects have none for (validated one by one), so
+    // marking has to go up all the way.
+    entry->second.results.clear();
+    ++entry->second.changes;
+    current = entry->second.owner_id;
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void bec::ValidationCache::member_changed(const std::string& id, const std::string& member,
+                                          const grt::ValueRef& old_value) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto entry = _entries.find(id);
+  if (entry == _entries.end())
+    return;
+
+  grt::ObjectRef object(entry->second.object);
+  entry->second.references_changed = true;
+  mark(id, true);
+
+  const grt::MetaClass::Member* info = object->get_metaclass()->get_member_info(member);
+  if (info != nullptr && info->owned_object && member != "owner") {
+    if (grt::ObjectRef::can_wrap(old_value))
+      untrack(grt::ObjectRef::cast_from(old_value));
+    grt::ValueRef value(object->get_member(member));
+    if (grt::ObjectRef::can_wrap(value))
+      track(grt::ObjectRef::cast_from(value), id);
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void bec::ValidationCache::list_changed(const std::string& id, grt::internal::OwnedList* list, bool added,
+                                        const grt::ValueRef& value) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  auto entry = _entries.find(id);
+  if (entry == _entries.end())
+    return;
+
+  grt::ObjectRef object(entry->second.object);
+  entry->second.references_changed = true;
+  mark(id, true);
+
+  if (!grt::ObjectRef::can_wrap(value))
+    return;
+
+  // Only items of owned lists are objects of their own, the others are references.
+  bool owned = false;
+  foreach_object_member(object, [&](const grt::MetaClass::Member* member, const grt::ValueRef& member_value) {
+    if (member_value.valueptr() == list)
+      owned = member->owned_object;
+  });
+
+  if (owned) {
+    if (added)
+      track(grt::ObjectRef::cast_from(value), id);
+    else
+      untrack(grt::ObjectRef::cast_from(value));
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void bec::ValidationCache::dict_changed(const std::string& id) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  mark(id, true);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void bec::ValidationCache::invalidate(const grt::ObjectRef& object) {
+  std::lock_guard<std::mutex> lock(_mutex);
+  if (object.is_valid())
+    mark(object->id(), true);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void bec::ValidationCache::invalidate_all() {
+  std::lock_guard<std::mutex> lock(_mutex);
+  for (auto& entry : _entries) {
+    entry.second.results.clear();
+    ++entry.second.changes;
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool bec::ValidationCache::contains(const grt::ObjectRef& object) const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return object.is_valid() && _entries.find(object->id()) != _entries.end();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+size_t bec::ValidationCache::object_count() const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  return _entries.size();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+size_t bec::ValidationCache::pending_count(const grt::Validator::Tag& tag) const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  size_t count = 0;
+  for (auto& entry : _entries) {
+    if (entry.second.results.find(tag) == entry.second.results.end())
+      ++count;
+  }
+  return count;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Replaces the messages the listeners have for the object and tag.
+ */
+void bec::ValidationCache::notify(const grt::Validator::Tag& tag, const grt::ObjectRef& object,
+                                  const std::vector<Message>& messages) {
+  (*ValidationManager::signal_notify())(tag, object, tag, grt::NoErrorMsg);
+  for (auto& message : messages)
+    (*ValidationManager::signal_notify())(tag, message.object, message.text, message.level);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool bec::ValidationCache::validate(const grt::Validator::Tag& tag, size_t thread_count) {
+  // The objects to validate, copied so the validators can run while the tree changes.
+  struct Job {
+    grt::ObjectRef object;
+    size_t order;
+    size_t changes;
+    Result result;
+  };
+
+  std::vector<Job> jobs;
+  std::vector<std::pair<grt::ObjectRef, grt::Validator::Tag>> removed;
+  bool valid = true;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (auto& entry : _entries) {
+      auto result = entry.second.results.find(tag);
+      if (result == entry.second.results.end()) {
+        // What an object refers to can only have changed if the object itself was marked.
+        if (entry.second.references_changed)
+          update_references(entry.second);
+        jobs.push_back({entry.second.object, entry.second.order, entry.second.changes, {true, {}}});
+      } else if (!result->second.valid)
+        valid = false;
+    }
+
+    for (auto iterator = _removed.begin(); iterator != _removed.end();) {
+      if (iterator->second == tag) {
+        removed.push_back(*iterator);
+        iterator = _removed.erase(iterator);
+      } else
+        ++iterator;
+    }
+  }
+  std::sort(jobs.begin(), jobs.end(), [](const Job& a, const Job& b) { return a.order < b.order; });
+
+  // Threads are worth it only for a good number of objects each.
+  if (thread_count == 0)
+    thread_count = std::max(std::thread::hardware_concurrency(), 1U);
+  thread_count = std::max<size_t>(std::min(thread_count, jobs.size() / 16), 1);
+
+  std::atomic<size_t> next(0);
+  std::exception_ptr error;
+  std::mutex error_mutex;
+  auto run = [&]() {
+    try {
+      for (size_t index = next++; index < jobs.size(); index = next++) {
+        Job& job = jobs[index];
+        collected_messages = &job.result.messages;
+        job.result.valid = ValidationManager::run_validators(job.object, tag);
+        collected_messages = nullptr;
+      }
+    } catch (...) {
+      collected_messages = nullptr;
+      next = jobs.size();
+      std::lock_guard<std::mutex> lock(error_mutex);
+      if (!error)
+        error = std::current_exception();
+    }
+  };
+
+  if (thread_count == 1)
+    run();
+  else {
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < thread_count; ++i)
+      threads.push_back(std::thread(run));
+    for (auto& thread : threads)
+      thread.join();
+  }
+
+  if (error)
+    std::rethrow_exception(error);
+
+  // Keep the results of objects which did not change while the validators ran. The others stay pending,
+  // their results are reported all the same.
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    for (Job& job : jobs) {
+      if (!job.result.valid)
+        valid = false;
+
+      auto entry = _entries.find(job.object->id());
+      if (entry != _entries.end()) {
+        entry->second.reported.insert(tag);
+        if (entry->second.changes == job.changes)
+          entry->second.results[tag] = job.result;
+      }
+    }
+  }
+
+  // Tell the listeners, from this thread.
+  for (auto& object : removed)
+    (*ValidationManager::signal_notify())(tag, object.first, tag, grt::NoErrorMsg);
+  for (Job& job : jobs)
+    notify(tag, job.object, job.result.messages);
+
+  return valid;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool bec::ValidationCache::validate(const grt::ObjectRef& object, const grt::Validator::Tag& tag) {
+  Result result = {true, {}};
+  size_t changes = 0;
+  bool tracked = false;
+  bool cached = false;
+  {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto entry = _entries.find(object->id());
+    if (entry != _entries.end()) {
+      tracked = true;
+      changes = entry->second.changes;
+      auto found = entry->second.results.find(tag);
+      if (found != entry->second.results.end()) {
+        result = found->second;
+        cached = true;
+      }
+    }
+  }
+
+  if (!cached) {
+    collected_messages = &result.messages;
+    try {
+      result.valid = ValidationManager::run_validators(object, tag);
+    } catch (...) {
+      collected_messages = nullptr;
+      throw;
+    }
+    collected_messages = nullptr;
+
+    if (tracked) {
+      std::lock_guard<std::mutex> lock(_mutex);
+      auto entry = _entries.find(object->id());
+      if (entry != _entries.end()) {
+        entry->second.reported.insert(tag);
+        if (entry->second.changes == changes)
+          entry->second.results[tag] = result;
+      }
+    }
+  }
+
+  notify(tag, object, result.messages);
+  return result.valid;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::vector<bec::ValidationCache::Message> bec::ValidationCache::messages(const grt::Validator::Tag& tag) const {
+  std::lock_guard<std::mutex> lock(_mutex);
+  std::vector<const Entry*> entries;
+  for (auto& entry : _entries)
+    entries.push_back(&entry.second);
+  std::sort(entries.begin(), entries.end(), [](const Entry* a, const Entry* b) { return a->order < b->order; });
+
+  std::vector<Message> result;
+  for (const Entry* entry : entries) {
+    auto found = entry->results.find(tag);
+    if (found != entry->results.end())
+      result.insert(result.end(), found->second.messages.begin(), found->second.messages.end());
+  }
+  return result;
+}
+
+//--------------------------------------------------------------------------------------------------
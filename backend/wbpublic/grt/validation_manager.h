@@ -29,6 +29,11 @@
 #include "tree_model.h"
 #include "refresh_ui.h"
 #include <deque>
+#include <map>
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <vector>
 
 // Common tag names
 #define CHECK_NAME "name"
@@ -39,6 +44,7 @@
 namespace bec {
 
   class GRTManager;
+  class ValidationCache;
 
   class WBPUBLICBACKEND_PUBLIC_FUNC ValidationMessagesBE : public ListModel, public RefreshUI {
   public:
@@ -91,6 +97,13 @@ namespace bec {
 
     static void scan();
     static void register_validator(const std::string& type, grt::Validator* v);
+    static bool has_validators();
+
+    // Registers the validators for the db objects which come with Workbench. Called by scan().
+    static void register_default_validators();
+
+    // Validates a single object. Objects of a tree with a cache (see cache_for()) are validated through it,
+    // so an object which did not change since its last validation just reports the results of that.
     static bool validate_instance(const grt::ObjectRef& obj, const grt::Validator::Tag& tag);
 
     static MessageSignal* signal_notify();
@@ -98,12 +111,98 @@ namespace bec {
                         const int level); // level is grt::MessageType
     static void clear();
 
+    // The validation results for the objects under root, shared by everyone validating that tree. They are kept
+    // until clear() is called, which happens whenever a document is closed or loaded.
+    static ValidationCache* cache_for(const GrtObjectRef& root);
+
   private:
+    friend class ValidationCache;
+
     static bool is_validation_plugin(const app_PluginRef& plugin);
+    static bool run_validators(const grt::ObjectRef& obj, const grt::Validator::Tag& tag);
 
     static MessageSignal* _signal_notify;
   };
 
+  /**
+   * Keeps the validation results of all objects in a tree (usually a catalog) per tag, so that validating
+   * again only runs the validators for objects which changed since. Changes are picked up from the change
+   * signals of the objects. A change invalidates the object, its owners and everything that refers to any of
+   * them (e.g. the foreign keys referencing a table whose column was renamed), together with their owners.
+   *
+   * That means validators may look at the object they check, the objects it owns and the objects it refers to,
+   * but not at its siblings. Checks across siblings (like duplicate names) belong to the owner.
+   *
+   * The validators run on several threads, the messages they send through ValidationManager::message() are
+   * collected per object and passed on to the listeners on the thread calling validate(). Validation usually
+   * runs on the GRT thread while the change signals come from the UI thread: the cache is locked while its
+   * bookkeeping is updated but not while validators run. A result is dropped if its object changed meanwhile.
+   */
+  class WBPUBLICBACKEND_PUBLIC_FUNC ValidationCache {
+  public:
+    struct Message {
+      grt::ObjectRef object;
+      std::string text;
+      int level; // grt::MessageType
+    };
+
+    ValidationCache(const GrtObjectRef& root);
+    ~ValidationCache();
+
+    // Validates all objects changed since the last validation for the tag (all of them on the first call), with
+    // up to thread_count threads (0 for one per CPU). Returns false if any object in the tree failed validation.
+    bool validate(const grt::Validator::Tag& tag, size_t thread_count = 0);
+
+    // Validates one object of the tree if it changed since its last validation for the tag. Objects which are
+    // not part of the tree are validated without keeping the result.
+    bool validate(const grt::ObjectRef& object, const grt::Validator::Tag& tag);
+
+    bool contains(const grt::ObjectRef& object) const;
+    void invalidate(const grt::ObjectRef& object);
+    void invalidate_all();
+
+    // The messages of all objects, from the last validation of each for the tag.
+    std::vector<Message> messages(const grt::Validator::Tag& tag) const;
+
+    size_t object_count() const;
+    size_t pending_count(const grt::Validator::Tag& tag) const;
+
+  private:
+    struct Result {
+      bool valid;
+      std::vector<Message> messages;
+    };
+
+    struct Entry {
+      grt::ObjectRef object;
+      std::string owner_id;
+      size_t order;
+      size_t changes;          // Counts the marks, to tell whether a result is still up to date.
+      bool references_changed; // The references must be collected again.
+      std::vector<std::string> references;
+      std::map<grt::Validator::Tag, Result> results; // Nothing for tags it must be validated for.
+      std::set<grt::Validator::Tag> reported;         // Tags the listeners got results for.
+      std::vector<boost::signals2::connection> connections;
+    };
+
+    GrtObjectRef _root;
+    mutable std::mutex _mutex;
+    std::unordered_map<std::string, Entry> _entries;                // By object id.
+    std::unordered_multimap<std::string, std::string> _dependents; // Referenced id -> id of the referencing object.
+    std::vector<std::pair<grt::ObjectRef, grt::Validator::Tag>> _removed; // Messages to withdraw from listeners.
+    size_t _next_order;
+
+    void track(const grt::ObjectRef& object, const std::string& owner_id);
+    void untrack(const grt::ObjectRef& object);
+    void update_references(Entry& entry);
+    void mark(const std::string& id, bool with_dependents);
+    void notify(const grt::Validator::Tag& tag, const grt::ObjectRef& object, const std::vector<Message>& messages);
+
+    void member_changed(const std::string& id, const std::string& member, const grt::ValueRef& old_value);
+    void list_changed(const std::string& id, grt::internal::OwnedList* list, bool added, const grt::ValueRef& value);
+    void dict_changed(const std::string& id);
+  };
+
   //------------------------------------------------------------------------------
   inline bec::ValidationManager::MessageSignal* bec::ValidationManager::signal_notify() {
     if (!_signal_notify)
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include "recordset_row_cursor.h"
+
+//----------------------------------------------------------------------------------------------------------------------
+
+Recordset_row_cursor::Recordset_row_cursor(const mtemplate::CompiledTemplate &tpl, const Parameters &parameters,
+                                           const std::vector<std::string> &names,
+                                           const std::vector<std::string> *types, const std::string &row_separator)
+  : _parameters(tpl.slotCount(), nullptr), _names(names), _types(types), _row_separator(row_separator) {
+  for (const Parameters::value_type &param : parameters) {
+    std::size_t slot = tpl.slot(param.first);
+    if (slot != mtemplate::CompiledTemplate::npos)
+      _parameters[slot] = &param.second;
+  }
+
+  _row_slot = tpl.slot("ROW");
+  _row_separator_slot = tpl.slot("ROW_SEPARATOR");
+  _field_slot = tpl.slot("FIELD");
+  _field_name_slot = tpl.slot("FIELD_NAME");
+  _field_value_slot = tpl.slot("FIELD_VALUE");
+  _field_type_slot = tpl.slot("FIELD_TYPE");
+  _is_null_slot = tpl.slot("FIELD_is_null");
+  _is_not_null_slot = tpl.slot("FIELD_is_not_null");
+
+  _row.owner = this;
+  _field.owner = this;
+  values.resize(names.size());
+  nulls.resize(names.size());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool Recordset_row_cursor::getValue(std::size_t slot, std::string &value) {
+  if (_parameters[slot] == nullptr)
+    return false;
+  value = *_parameters[slot];
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+mtemplate::TemplateCursor *Recordset_row_cursor::getSection(std::size_t slot, std::size_t row) {
+  return slot == _row_slot && row == 0 ? &_row : nullptr;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool Recordset_row_cursor::Row_cursor::getValue(std::size_t slot, std::string &value) {
+  if (slot != owner->_row_separator_slot)
+    return false;
+  value = owner->last ? "" : owner->_row_separator;
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+mtemplate::TemplateCursor *Recordset_row_cursor::Row_cursor::getSection(std::size_t slot, std::size_t row) {
+  if (slot != owner->_field_slot || row >= owner->values.size())
+    return nullptr;
+  owner->_field.column = row;
+  return &owner->_field;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool Recordset_row_cursor::Row_cursor::isLast() {
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool Recordset_row_cursor::Field_cursor::getValue(std::size_t slot, std::string &value) {
+  if (slot == owner->_field_name_slot)
+    value = owner->_names[column];
+  else if (slot == owner->_field_value_slot)
+    value = owner->values[column];
+  else if (slot == owner->_field_type_slot && owner->_types != nullptr)
+    value = (*owner->_types)[column];
+  else
+    return false;
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+mtemplate::TemplateCursor *Recordset_row_cursor::Field_cursor::getSection(std::size_t slot, std::size_t row) {
+  bool is_null = owner->nulls[column];
+  if (row == 0 && ((slot == owner->_is_null_slot && is_null) || (slot == owner->_is_not_null_slot && !is_null)))
+    return &owner->_flag;
+  return nullptr;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool Recordset_row_cursor::Field_cursor::isLast() {
+  return column + 1 == owner->values.size();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool Recordset_row_cursor::Flag_cursor::getValue(std::size_t slot, std::string &value) {
+  return false;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+mtemplate::TemplateCursor *Recordset_row_cursor::Flag_cursor::getSection(std::size_t slot, std::size_t row) {
+  return nullptr;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+bool Recordset_row_cursor::Flag_cursor::isLast() {
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
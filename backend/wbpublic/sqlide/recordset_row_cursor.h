@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#ifndef _RECORDSET_ROW_CURSOR_H_
+#define _RECORDSET_ROW_CURSOR_H_
+
+#include "wbpublic_public_interface.h"
+#include "mtemplate/compiled_template.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * Feeds one row at a time to a compiled row template of a result set export, with the same names a row dictionary
+ * would have: the export parameters, a single ROW with ROW_SEPARATOR and a FIELD per column (FIELD_NAME, FIELD_VALUE,
+ * FIELD_TYPE and the FIELD_is_null/FIELD_is_not_null sections). Values are not copied, only pointed to.
+ */
+class WBPUBLICBACKEND_PUBLIC_FUNC Recordset_row_cursor : public mtemplate::TemplateCursor {
+public:
+  typedef std::map<std::string, std::string> Parameters;
+
+  // The current row, set by the caller before each expand.
+  std::vector<std::string> values;
+  std::vector<bool> nulls;
+  bool last = false;
+
+  /**
+   * The names (and types, if given) must stay valid as long as the cursor is used. Without types FIELD_TYPE is
+   * looked up in the parameters and the global dictionary, as with a row dictionary that has no such value.
+   */
+  Recordset_row_cursor(const mtemplate::CompiledTemplate &tpl, const Parameters &parameters,
+                       const std::vector<std::string> &names, const std::vector<std::string> *types,
+                       const std::string &row_separator);
+
+  virtual bool getValue(std::size_t slot, std::string &value);
+  virtual mtemplate::TemplateCursor *getSection(std::size_t slot, std::size_t row);
+
+private:
+  // A section without values (FIELD_is_null/FIELD_is_not_null).
+  class Flag_cursor : public mtemplate::TemplateCursor {
+  public:
+    virtual bool getValue(std::size_t slot, std::string &value);
+    virtual mtemplate::TemplateCursor *getSection(std::size_t slot, std::size_t row);
+    virtual bool isLast();
+  };
+
+  class Field_cursor : public mtemplate::TemplateCursor {
+  public:
+    Recordset_row_cursor *owner = nullptr;
+    std::size_t column = 0;
+
+    virtual bool getValue(std::size_t slot, std::string &value);
+    virtual mtemplate::TemplateCursor *getSection(std::size_t slot, std::size_t row);
+    virtual bool isLast();
+  };
+
+  // The single ROW section.
+  class Row_cursor : public mtemplate::TemplateCursor {
+  public:
+    Recordset_row_cursor *owner = nullptr;
+
+    virtual bool getValue(std::size_t slot, std::string &value);
+    virtual mtemplate::TemplateCursor *getSection(std::size_t slot, std::size_t row);
+    virtual bool isLast();
+  };
+
+  std::vector<const std::string *> _parameters; // By slot.
+  const std::vector<std::string> &_names;
+  const std::vector<std::string> *_types;
+  std::string _row_separator;
+
+  std::size_t _row_slot, _row_separator_slot, _field_slot, _field_name_slot, _field_value_slot, _field_type_slot;
+  std::size_t _is_null_slot, _is_not_null_slot;
+
+  Row_cursor _row;
+  Field_cursor _field;
+  Flag_cursor _flag;
+};
+
+#endif /* _RECORDSET_ROW_CURSOR_H_ */
@@ -25,6 +25,8 @@
 
 #include "recordset_sql_storage.h"
 #include "recordset_be.h"
+#include "sql_inserts_scanner.h"
+#include "grt/grt_manager.h"
 #include "grtsqlparser/sql_facade.h"
 #include "base/string_utilities.h"
 #include "base/sqlstring.h"
@@ -133,48 +135,48 @@ void Recordset_sql_storage::do_unserialize(Recordset *recordset, sqlite::connect
   Recordset::Column_flags &column_flags = get_column_flags(recordset);
 
   _pkey_columns.clear();
-  _fields_order.clear(); //! make auto var & bind like var_list
+  _fields_order.clear();
+  _fields_index.clear();
+  _fields_index_names.clear();
 
   if (!sql_script().empty()) // load data from sql script
   {
-    Var_list var_list;
-    SqlFacade::Ref sql_facade = SqlFacade::instance_for_rdbms_name("Mysql"); //!
-    Sql_inserts_loader::Ref loader = sql_facade->sqlInsertsLoader();
-    loader->process_insert_cb(std::bind(&Recordset_sql_storage::load_insert_statement, this, std::placeholders::_1,
-                                        std::placeholders::_2, std::placeholders::_3, std::placeholders::_4,
-                                        std::placeholders::_5, &column_names, &var_list));
-    loader->load(sql_script(), schema_name());
-
-    // column types
-    column_types.reserve(column_names.size());
-    std::fill_n(std::back_inserter(column_types), column_names.size(), std::string());
-
-    // real column types
-    real_column_types.reserve(column_names.size());
-    std::fill_n(std::back_inserter(real_column_types), column_names.size(), std::string());
-
-    column_flags.reserve(column_names.size());
-    std::fill_n(std::back_inserter(column_flags), column_names.size(), Recordset::NeedsQuoteFlag);
-
-    if (!column_names.empty()) {
-      // data
-      {
-        sqlide::Sqlite_transaction_guarder transaction_guarder(data_swap_db);
+    // Rows go to the swap db as soon as they are read. The swap tables are created for the first row, which
+    // determines the set of columns.
+    std::list<std::shared_ptr<sqlite::command> > insert_commands;
+    Var_vector row_values;
+    sqlide::Sqlite_transaction_guarder transaction_guarder(data_swap_db);
+
+    Sql_inserts_loader::Ref loader =
+      Sql_inserts_scanner::create(bec::GRTManager::get()->get_app_option_string("SqlMode"));
+    loader->process_insert_cb([&](const std::string &sql, const std::pair<std::string, std::string> &schema_table,
+                                  const Sql_inserts_loader::Strings &fields_names,
+                                  const Sql_inserts_loader::Strings &fields_values,
+                                  const std::vector<bool> &null_fields) {
+      if (!load_insert_statement(sql, schema_table, fields_names, fields_values, null_fields, &column_names,
+                                 &row_values))
+        return;
+
+      if (insert_commands.empty()) {
+        // column types
+        column_types.reserve(column_names.size());
+        std::fill_n(std::back_inserter(column_types), column_names.size(), std::string());
+
+        // real column types
+        real_column_types.reserve(column_names.size());
+        std::fill_n(std::back_inserter(real_column_types), column_names.size(), std::string());
+
+        column_flags.reserve(column_names.size());
+        std::fill_n(std::back_inserter(column_flags), column_names.size(), Recordset::NeedsQuoteFlag);
 
         create_data_swap_tables(data_swap_db, column_names, column_types);
-        Var_vector row_values(column_names.size());
-        std::list<std::shared_ptr<sqlite::command> > insert_commands =
-          prepare_data_swap_record_add_statement(data_swap_db, column_names);
-        Var_list::iterator var_list_iter = var_list.begin();
-        for (size_t n = 0, count = var_list.size() / column_names.size(); n < count; ++n) {
-          for (size_t l = 0, count = column_names.size(); l < count; ++l)
-            row_values[l] = *var_list_iter++;
-          add_data_swap_record(insert_commands, row_values);
-        }
-
-        transaction_guarder.commit();
+        insert_commands = prepare_data_swap_record_add_statement(data_swap_db, column_names);
       }
-    }
+      add_data_swap_record(insert_commands, row_values);
+    });
+    loader->load(sql_script(), schema_name());
+
+    transaction_guarder.commit();
 
     _readonly = column_names.empty();
     _valid = !column_names.empty();
@@ -186,20 +188,20 @@ void Recordset_sql_storage::do_unserialize(Recordset *recordset, sqlite::connect
   }
 }
 
-void Recordset_sql_storage::load_insert_statement(const std::string &sql,
+bool Recordset_sql_storage::load_insert_statement(const std::string &sql,
                                                   const std::pair<std::string, std::string> &schema_table,
                                                   const Sql_inserts_loader::Strings &fields_names,
                                                   const Sql_inserts_loader::Strings &fields_values,
                                                   const std::vector<bool> &null_fields,
-                                                  Recordset::Column_names *column_names, Var_list *var_list) {
+                                                  Recordset::Column_names *column_names, Var_vector *row_values) {
   if ((schema_table.first != _schema_name) || (schema_table.second != _table_name)) {
     grt::GRT::get()->send_error("Irrelevant insert statement (skipped): " + sql);
-    return;
+    return false;
   }
 
   if (fields_names.size() != fields_values.size()) {
     grt::GRT::get()->send_error("Invalid insert statement: " + sql);
-    return;
+    return false;
   }
 
   // 1st insert statement defines the set & order of fields in recordset
@@ -209,23 +211,31 @@ void Recordset_sql_storage::load_insert_statement(const std::string &sql,
     for (const auto &fn : *column_names)
       _fields_order.insert(std::make_pair(fn, (int)_fields_order.size()));
   }
+  if (column_names->empty())
+    return false;
 
-  // check fields names & determine fields order
-  std::map<int, int> col_index_map; // index of field in var_list : index of field in passed fields_names
-  for (ColumnId n = 0, count = fields_names.size(); n < count; ++n) {
-    Fields_order::const_iterator i = _fields_order.find(fields_names[n]);
-    if (_fields_order.end() != i)
-      col_index_map[i->second] = (int)n;
+  // check fields names & determine fields order, only when they differ from those of the previous row
+  if (_fields_index_names != fields_names) {
+    _fields_index_names = fields_names;
+    _fields_index.assign(_fields_order.size(), -1); // index of field in row : index of field in passed fields_names
+    for (ColumnId n = 0, count = fields_names.size(); n < count; ++n) {
+      Fields_order::const_iterator i = _fields_order.find(fields_names[n]);
+      if (_fields_order.end() != i)
+        _fields_index[i->second] = (int)n;
+    }
   }
 
-  // insert row
-  for (ColumnId n = 0, count = _fields_order.size(); n < count; ++n) {
-    std::map<int, int>::const_iterator i = col_index_map.find((int)n);
-    if ((col_index_map.end() != i) && !null_fields[i->second])
-      var_list->push_back(fields_values[i->second]);
+  // fill row
+  row_values->resize(column_names->size());
+  for (ColumnId n = 0, count = row_values->size(); n < count; ++n) {
+    int index = n < _fields_index.size() ? _fields_index[n] : -1;
+    if ((index >= 0) && !null_fields[index])
+      (*row_values)[n] = fields_values[index];
     else
-      var_list->push_back(sqlite::null_t());
+      (*row_values)[n] = sqlite::null_t();
   }
+
+  return true;
 }
 
 void Recordset_sql_storage::do_serialize(const Recordset *recordset, sqlite::connection *data_swap_db) {
@@ -167,11 +167,13 @@ private:
 private:
   typedef std::map<std::string, int> Fields_order;
   Fields_order _fields_order;
+  std::vector<int> _fields_index;                  // position of each column in the fields of the loaded row
+  Sql_inserts_loader::Strings _fields_index_names; // fields the index was determined for
 
-  void load_insert_statement(const std::string &sql, const std::pair<std::string, std::string> &schema_table,
+  bool load_insert_statement(const std::string &sql, const std::pair<std::string, std::string> &schema_table,
                              const Sql_inserts_loader::Strings &fields_names,
                              const Sql_inserts_loader::Strings &fields_values, const std::vector<bool> &null_fields,
-                             Recordset::Column_names *column_names, Var_list *var_list);
+                             Recordset::Column_names *column_names, Var_vector *row_values);
 
 public:
   db_mgmt_RdbmsRef rdbms() {
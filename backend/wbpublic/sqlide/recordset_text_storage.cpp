@@ -24,6 +24,8 @@
 #include <sqlite/query.hpp>
 
 #include "recordset_text_storage.h"
+#include "recordset_text_writer.h"
+#include "recordset_row_cursor.h"
 #include "recordset_be.h"
 #include "base/string_utilities.h"
 #include "base/file_functions.h"
@@ -36,6 +38,7 @@
 #include <errno.h>
 
 #include "mtemplate/template.h"
+#include "mtemplate/compiled_template.h"
 #include <iostream>
 
 DEFAULT_LOG_DOMAIN(DOMAIN_WQE_BE)
@@ -53,7 +56,7 @@ static const Recordset_text_storage::TemplateInfo &template_info(const std::stri
   return _templates[template_name];
 }
 
-static void process_templates(const std::list<std::string> &files) {
+static void process_templates(const std::list<std::string> &files, bool bundled) {
   for (std::list<std::string>::const_iterator f = files.begin(); f != files.end(); ++f) {
     ConfigurationFile cf(AutoCreateNothing);
     if (cf.load(*f)) {
@@ -67,6 +70,7 @@ static void process_templates(const std::list<std::string> &files) {
       info.include_column_types = cf.get_value("include_column_types");
       info.null_syntax = cf.get_value("null_syntax");
       info.row_separator = cf.get_value("row_separator");
+      info.bundled = bundled;
       if (info.include_column_types != "xls")
         info.include_column_types = "";
       std::string args = cf.get_value("arguments");
@@ -85,11 +89,11 @@ static void scan_templates() {
   if (_templates.empty()) {
     std::string template_dir = base::makePath(bec::GRTManager::get()->get_basedir(), "modules/data/sqlide");
     std::list<std::string> files = base::scan_for_files_matching(template_dir + "/*.tpli");
-    process_templates(files);
+    process_templates(files, true);
 
     template_dir = base::makePath(bec::GRTManager::get()->get_user_datadir(), "recordset_export_templates");
     files = base::scan_for_files_matching(template_dir + "/*.tpli");
-    process_templates(files);
+    process_templates(files, false);
   }
 }
 
@@ -147,6 +151,8 @@ static std::string escape_json_string_(const std::string &s) {
   return base::escape_json_string(s);
 }
 
+//----------------------------------------------------------------------------------------------------------------------
+
 void Recordset_text_storage::do_serialize(const Recordset *recordset, sqlite::connection *data_swap_db) {
   const TemplateInfo &info(template_info(_data_format));
   std::string template_name(info.name);
@@ -154,41 +160,12 @@ void Recordset_text_storage::do_serialize(const Recordset *recordset, sqlite::co
   std::string include_column_types(info.include_column_types);
   std::string null_syntax(info.null_syntax);
   std::string tpl_path(info.path);
-  mtemplate::Template *pre_template = NULL;
-  mtemplate::Template *post_template = NULL;
-  mtemplate::Template *mtpl = mtemplate::GetTemplate(tpl_path);
-
-  if (!mtpl) {
-    throw std::runtime_error(strfmt("Failed to open template file: `%s`", tpl_path.c_str()));
-  }
-
-  // templates can be all in a single file or be divided in 3 files (pre, body and post)
-  // to save memory when exporting large resultsets
-  std::string pre_tpl_path;
-  std::string post_tpl_path;
-  if (g_str_has_suffix(tpl_path.c_str(), ".tpl")) {
-    std::string name = tpl_path.substr(0, tpl_path.size() - 4);
-    if (g_file_test((name + ".pre.tpl").c_str(), G_FILE_TEST_EXISTS)) {
-      pre_tpl_path = name + ".pre.tpl";
-      pre_template = mtemplate::GetTemplate(pre_tpl_path);
-      if (!pre_template)
-        logWarning("Failed to open template file: `%s`\n", pre_tpl_path.c_str());
-    }
-    if (g_file_test((name + ".post.tpl").c_str(), G_FILE_TEST_EXISTS)) {
-      post_tpl_path = name + ".post.tpl";
-      post_template = mtemplate::GetTemplate(post_tpl_path);
-    }
-  }
 
   {
     if (!g_file_set_contents(_file_path.c_str(), "", 1, NULL))
       throw std::runtime_error(strfmt("Failed to open output file: `%s`", _file_path.c_str()));
   }
 
-  mtemplate::Dictionary *dictionary = mtemplate::CreateMainDictionary();
-  for (const Parameters::value_type &param : _parameters)
-    dictionary->setValue(param.first, param.second);
-
   const Recordset::Column_names *column_names = recordset->column_names();
   const Recordset::Column_types &column_types = get_column_types(recordset);
   const Recordset::Column_types &real_column_types = get_real_column_types(recordset);
@@ -210,6 +187,89 @@ void Recordset_text_storage::do_serialize(const Recordset *recordset, sqlite::co
       (true) ? sqlide::QuoteVar::Blob_to_string() : sqlide::QuoteVar::blob_to_hex_string;
   }
 
+  sqlide::VarToStr var_to_str;
+  auto format_value = [&](ColumnId col, const sqlite::variant_t &v) -> std::string {
+    if (strings_are_pre_quoted && ((column_flags[col] & Recordset::NeedsQuoteFlag) || sqlide::is_var_null(v)))
+      return boost::apply_visitor(qv, column_types[col], v);
+    return boost::apply_visitor(var_to_str, v);
+  };
+
+  // The bundled formats are written directly, user templates (even if they replace a bundled one) are expanded.
+  if (info.bundled) {
+    Recordset_text_writer::Variables variables(_parameters);
+    variables["GENERATOR_QUERY"] = recordset->generator_query();
+
+    std::vector<std::string> names(column_names->begin(), column_names->begin() + visible_col_count);
+    Recordset_text_writer::Ref writer = Recordset_text_writer::create(template_name, _file_path, names, variables);
+    if (writer) {
+      writer->write_header();
+
+      const size_t partition_count = recordset->data_swap_db_partition_count();
+      std::list<std::shared_ptr<sqlite::query> > data_queries(partition_count);
+      Recordset::prepare_partition_queries(data_swap_db, "select * from `data%s`", data_queries);
+      std::vector<std::shared_ptr<sqlite::result> > data_results(data_queries.size());
+
+      if (Recordset::emit_partition_queries(data_swap_db, data_queries, data_results)) {
+        std::vector<std::string> values(visible_col_count);
+        std::vector<bool> nulls(visible_col_count);
+        bool next_row_exists = true;
+        sqlite::variant_t v;
+        do {
+          for (size_t partition = 0; partition < partition_count; ++partition) {
+            std::shared_ptr<sqlite::result> &data_rs = data_results[partition];
+            for (ColumnId col_begin = partition * Recordset::DATA_SWAP_DB_TABLE_MAX_COL_COUNT, col = col_begin,
+                          col_end = std::min<ColumnId>(visible_col_count,
+                                                       (partition + 1) * Recordset::DATA_SWAP_DB_TABLE_MAX_COL_COUNT);
+                 col < col_end; ++col) {
+              v = data_rs->get_variant((int)(col - col_begin));
+              nulls[col] = sqlide::is_var_null(v);
+              values[col] = nulls[col] ? null_syntax : format_value(col, v);
+            }
+          }
+
+          for (std::shared_ptr<sqlite::result> &data_rs : data_results)
+            next_row_exists = data_rs->next_row();
+
+          writer->write_row(values, nulls, !next_row_exists);
+        } while (next_row_exists);
+      }
+
+      writer->write_footer();
+      writer->flush();
+      return;
+    }
+  }
+
+  std::unique_ptr<mtemplate::Template> pre_template;
+  std::unique_ptr<mtemplate::Template> post_template;
+  std::unique_ptr<mtemplate::Template> mtpl(mtemplate::GetTemplate(tpl_path));
+
+  if (!mtpl) {
+    throw std::runtime_error(strfmt("Failed to open template file: `%s`", tpl_path.c_str()));
+  }
+
+  // templates can be all in a single file or be divided in 3 files (pre, body and post)
+  // to save memory when exporting large resultsets
+  std::string pre_tpl_path;
+  std::string post_tpl_path;
+  if (g_str_has_suffix(tpl_path.c_str(), ".tpl")) {
+    std::string name = tpl_path.substr(0, tpl_path.size() - 4);
+    if (g_file_test((name + ".pre.tpl").c_str(), G_FILE_TEST_EXISTS)) {
+      pre_tpl_path = name + ".pre.tpl";
+      pre_template.reset(mtemplate::GetTemplate(pre_tpl_path));
+      if (!pre_template)
+        logWarning("Failed to open template file: `%s`\n", pre_tpl_path.c_str());
+    }
+    if (g_file_test((name + ".post.tpl").c_str(), G_FILE_TEST_EXISTS)) {
+      post_tpl_path = name + ".post.tpl";
+      post_template.reset(mtemplate::GetTemplate(post_tpl_path));
+    }
+  }
+
+  std::unique_ptr<mtemplate::Dictionary> dictionary(mtemplate::CreateMainDictionary());
+  for (const Parameters::value_type &param : _parameters)
+    dictionary->setValue(param.first, param.second);
+
   // global variables
   mtemplate::SetGlobalValue("INDENT", "\t");
 
@@ -250,10 +310,16 @@ void Recordset_text_storage::do_serialize(const Recordset *recordset, sqlite::co
   mtemplate::TemplateOutputFile output(_file_path);
   if (pre_template || post_template) {
     if (pre_template)
-      pre_template->expand(dictionary, &output);
+      pre_template->expand(dictionary.get(), &output);
 
-    // data
+    // data, the row template is compiled once and then expanded straight from the row values
     {
+      mtemplate::CompiledTemplate row_template(*mtpl);
+      std::vector<std::string> visible_column_names(column_names->begin(), column_names->begin() + visible_col_count);
+      Recordset_row_cursor cursor(row_template, _parameters, visible_column_names,
+                                  include_column_types.empty() ? nullptr : &out_column_types, info.row_separator);
+      mtemplate::TemplateWriter writer(&output);
+
       const size_t partition_count = recordset->data_swap_db_partition_count();
       std::list<std::shared_ptr<sqlite::query> > data_queries(partition_count);
       Recordset::prepare_partition_queries(data_swap_db, "select * from `data%s`", data_queries);
@@ -263,12 +329,6 @@ void Recordset_text_storage::do_serialize(const Recordset *recordset, sqlite::co
         bool next_row_exists = true;
         sqlite::variant_t v;
         do {
-          mtemplate::DictionaryInterface *row_dictionary_base = mtemplate::CreateMainDictionary();
-          mtemplate::DictionaryInterface *row_dictionary = row_dictionary_base->addSectionDictionary("ROW");
-
-          for (const Parameters::value_type &param : _parameters)
-            row_dictionary_base->setValue(param.first, param.second);
-
           // process a single row
           for (size_t partition = 0; partition < partition_count; ++partition) {
             std::shared_ptr<sqlite::result> &data_rs = data_results[partition];
@@ -277,54 +337,26 @@ void Recordset_text_storage::do_serialize(const Recordset *recordset, sqlite::co
                                                        (partition + 1) * Recordset::DATA_SWAP_DB_TABLE_MAX_COL_COUNT);
                  col < col_end; ++col) {
               ColumnId partition_column = col - col_begin;
-              bool is_null;
               v = data_rs->get_variant((int)partition_column);
 
-              is_null = sqlide::is_var_null(v); // for some reason, the apply_visitor stuff isnt handling NULL
-
-              mtemplate::DictionaryInterface *field_dictionary = row_dictionary->addSectionDictionary("FIELD");
-
-              if (is_null)
-                field_dictionary->addSectionDictionary("FIELD_is_null");
-              else
-                field_dictionary->addSectionDictionary("FIELD_is_not_null");
-
-              if (!include_column_types.empty())
-                field_dictionary->setValue("FIELD_TYPE", out_column_types[col]);
-
-              field_dictionary->setValue("FIELD_NAME", (*column_names)[col]);
-
-              std::string field_value;
-              sqlide::VarToStr var_to_str;
-
-              if (is_null)
-                field_value = null_syntax;
-              else if (strings_are_pre_quoted)
-                field_value = (column_flags[col] & Recordset::NeedsQuoteFlag) || sqlide::is_var_null(v)
-                                ? boost::apply_visitor(qv, column_types[col], v)
-                                : boost::apply_visitor(var_to_str, v);
-              else
-                field_value = boost::apply_visitor(var_to_str, v);
-              field_dictionary->setValue("FIELD_VALUE", field_value);
+              bool is_null = sqlide::is_var_null(v); // for some reason, the apply_visitor stuff isnt handling NULL
+              cursor.nulls[col] = is_null;
+              cursor.values[col] = is_null ? null_syntax : format_value(col, v);
             }
           }
 
           for (std::shared_ptr<sqlite::result> &data_rs : data_results)
             next_row_exists = data_rs->next_row();
+          cursor.last = !next_row_exists;
 
-          if (next_row_exists)
-            row_dictionary->setValue("ROW_SEPARATOR", info.row_separator);
-          else
-            row_dictionary->setValue("ROW_SEPARATOR", "");
-
-          // expand template & flush row
-          mtpl->expand(row_dictionary_base, &output);
+          row_template.expand(&cursor, writer);
         } while (next_row_exists);
       }
+      writer.flush();
     }
 
     if (post_template)
-      post_template->expand(dictionary, &output);
+      post_template->expand(dictionary.get(), &output);
   } else // no pre/post separation
   {
     // data
@@ -348,16 +380,7 @@ void Recordset_text_storage::do_serialize(const Recordset *recordset, sqlite::co
               v = data_rs->get_variant((int)partition_column);
               mtemplate::DictionaryInterface *field_dictionary = row_dictionary->addSectionDictionary("FIELD");
               field_dictionary->setValue("FIELD_NAME", (*column_names)[col]);
-              std::string field_value;
-              sqlide::VarToStr var_to_str;
-
-              if (strings_are_pre_quoted)
-                field_value = (column_flags[col] & Recordset::NeedsQuoteFlag) || sqlide::is_var_null(v)
-                                ? boost::apply_visitor(qv, column_types[col], v)
-                                : boost::apply_visitor(var_to_str, v);
-              else
-                field_value = boost::apply_visitor(var_to_str, v);
-              field_dictionary->setValue("FIELD_VALUE", field_value);
+              field_dictionary->setValue("FIELD_VALUE", format_value(col, v));
             }
           }
           for (std::shared_ptr<sqlite::result> &data_rs : data_results)
@@ -367,7 +390,7 @@ void Recordset_text_storage::do_serialize(const Recordset *recordset, sqlite::co
     }
 
     // expand tempalte & flush result
-    mtpl->expand(dictionary, &output);
+    mtpl->expand(dictionary.get(), &output);
   }
 }
 
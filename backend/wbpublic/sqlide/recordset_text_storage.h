@@ -38,6 +38,7 @@ public:
     std::string row_separator;
     bool pre_quote_strings;
     std::string quote;
+    bool bundled; // shipped with the application, not a user template
   };
   static std::vector<Recordset_storage_info> storage_types();
 
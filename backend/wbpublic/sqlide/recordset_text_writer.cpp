@@ -0,0 +1,345 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+
+#include "recordset_text_writer.h"
+#include "base/string_utilities.h"
+
+#include <stdexcept>
+
+// The buffer is written out once it grows beyond this size.
+static const size_t FLUSH_THRESHOLD = 1024 * 1024;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+Recordset_text_writer::Recordset_text_writer(const std::string &path, const std::vector<std::string> &column_names,
+                                             const Variables &variables)
+  : _column_names(column_names), _variables(variables), _file(path, "w+") {
+  _buffer.reserve(FLUSH_THRESHOLD + FLUSH_THRESHOLD / 4);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+Recordset_text_writer::~Recordset_text_writer() {
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void Recordset_text_writer::write_header() {
+  append_header();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void Recordset_text_writer::write_row(const std::vector<std::string> &values, const std::vector<bool> &nulls,
+                                      bool last) {
+  append_row(values, nulls, last);
+  if (_buffer.size() >= FLUSH_THRESHOLD)
+    flush();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void Recordset_text_writer::write_footer() {
+  append_footer();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void Recordset_text_writer::flush() {
+  if (_buffer.empty())
+    return;
+
+  if (fwrite(_buffer.data(), 1, _buffer.size(), _file.file()) != _buffer.size())
+    throw std::runtime_error(base::strfmt("Failed to write output file: `%s`", _file.getPath().c_str()));
+  _buffer.clear();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::string Recordset_text_writer::variable(const std::string &name) const {
+  Variables::const_iterator iter = _variables.find(name);
+  return iter != _variables.end() ? iter->second : std::string();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Note: mtemplate has no stock modifiers registered, so the xml_escape and html_escape markers used in the bundled
+// templates have no effect. Values and names are therefore written unchanged by the XML, HTML and JSON writers.
+namespace {
+
+  class CSV_writer : public Recordset_text_writer {
+  public:
+    CSV_writer(const std::string &path, const std::vector<std::string> &column_names, const Variables &variables,
+               char separator, const char *special_characters)
+      : Recordset_text_writer(path, column_names, variables),
+        _separator(separator),
+        _special_characters(special_characters) {
+    }
+
+  protected:
+    virtual void append_header() {
+      for (size_t i = 0; i < _column_names.size(); ++i) {
+        if (i > 0)
+          _buffer += _separator;
+        append_token(_column_names[i]);
+      }
+      _buffer += '\n';
+    }
+
+    virtual void append_row(const std::vector<std::string> &values, const std::vector<bool> &nulls, bool last) {
+      for (size_t i = 0; i < values.size(); ++i) {
+        if (i > 0)
+          _buffer += _separator;
+        append_token(values[i]);
+      }
+      _buffer += '\n';
+    }
+
+  private:
+    char _separator;
+    const char *_special_characters;
+
+    // Same rules as the x-csv_quote template modifier: a token is enclosed in double quotes (doubling the quotes it
+    // contains) if it has any of the special characters of the format.
+    void append_token(const std::string &token) {
+      if (token.find_first_of(_special_characters) == std::string::npos) {
+        _buffer += token;
+        return;
+      }
+
+      _buffer += '"';
+      size_t start = 0;
+      for (size_t quote = token.find('"'); quote != std::string::npos; quote = token.find('"', start)) {
+        _buffer.append(token, start, quote + 1 - start);
+        _buffer += '"';
+        start = quote + 1;
+      }
+      _buffer.append(token, start, std::string::npos);
+      _buffer += '"';
+    }
+  };
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  class JSON_writer : public Recordset_text_writer {
+  public:
+    JSON_writer(const std::string &path, const std::vector<std::string> &column_names, const Variables &variables)
+      : Recordset_text_writer(path, column_names, variables) {
+    }
+
+  protected:
+    virtual void append_header() {
+      _buffer += "[\n";
+    }
+
+    virtual void append_row(const std::vector<std::string> &values, const std::vector<bool> &nulls, bool last) {
+      _buffer += "\t{";
+      for (size_t i = 0; i < values.size(); ++i) {
+        if (i > 0)
+          _buffer += ',';
+        _buffer += "\n\t\t\"";
+        _buffer += _column_names[i];
+        _buffer += "\" : ";
+        _buffer += values[i];
+      }
+      _buffer += last ? "\n\t}\n" : "\n\t},\n";
+    }
+
+    virtual void append_footer() {
+      _buffer += "]\n";
+    }
+  };
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  class XML_writer : public Recordset_text_writer {
+  public:
+    XML_writer(const std::string &path, const std::vector<std::string> &column_names, const Variables &variables)
+      : Recordset_text_writer(path, column_names, variables) {
+    }
+
+  protected:
+    virtual void append_header() {
+      _buffer += "<DATA>\n";
+    }
+
+    virtual void append_row(const std::vector<std::string> &values, const std::vector<bool> &nulls, bool last) {
+      _buffer += "\n\t<ROW>";
+      for (size_t i = 0; i < values.size(); ++i) {
+        _buffer += "\n\t\t<";
+        _buffer += _column_names[i];
+        _buffer += '>';
+        _buffer += values[i];
+        _buffer += "</";
+        _buffer += _column_names[i];
+        _buffer += '>';
+      }
+      _buffer += "\n\t</ROW>\n";
+    }
+
+    virtual void append_footer() {
+      _buffer += "</DATA>\n";
+    }
+  };
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  class XML_mysql_writer : public Recordset_text_writer {
+  public:
+    XML_mysql_writer(const std::string &path, const std::vector<std::string> &column_names,
+                     const Variables &variables)
+      : Recordset_text_writer(path, column_names, variables) {
+    }
+
+  protected:
+    virtual void append_header() {
+      _buffer += "<?xml version=\"1.0\"?>\n\n<resultset statement=\"";
+      _buffer += variable("GENERATOR_QUERY");
+      _buffer += "\"\nxmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\">\n";
+    }
+
+    virtual void append_row(const std::vector<std::string> &values, const std::vector<bool> &nulls, bool last) {
+      _buffer += "\n\t<row>";
+      for (size_t i = 0; i < values.size(); ++i) {
+        _buffer += "\n\t\t<field name=\"";
+        _buffer += _column_names[i];
+        if (nulls[i])
+          _buffer += "\" xsi:nil=\"true\" />";
+        else {
+          _buffer += "\">";
+          _buffer += values[i];
+          _buffer += "</field>";
+        }
+      }
+      _buffer += "\n\t</row>\n";
+    }
+
+    virtual void append_footer() {
+      _buffer += "</resultset>\n";
+    }
+  };
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  class HTML_writer : public Recordset_text_writer {
+  public:
+    HTML_writer(const std::string &path, const std::vector<std::string> &column_names, const Variables &variables)
+      : Recordset_text_writer(path, column_names, variables) {
+    }
+
+  protected:
+    virtual void append_header() {
+      _buffer +=
+        "<html>\n<head>\n<meta http-equiv=\"Content-Type\" content=\"text/html; charset=utf-8\"><title>Data</title>\n"
+        "</head>\n<body>\n<table border=1>\n<tr>";
+      for (const std::string &name : _column_names) {
+        _buffer += "\n<td bgcolor=silver class='medium'>";
+        _buffer += name;
+        _buffer += "</td>";
+      }
+      _buffer += "\n</tr>\n";
+    }
+
+    virtual void append_row(const std::vector<std::string> &values, const std::vector<bool> &nulls, bool last) {
+      _buffer += "\n<tr>";
+      for (const std::string &value : values) {
+        _buffer += "\n<td class='normal' valign='top'>";
+        _buffer += value;
+        _buffer += "</td>";
+      }
+      _buffer += "\n</tr>\n";
+    }
+
+    virtual void append_footer() {
+      _buffer += "</table>\n</body></html>\n";
+    }
+  };
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  class SQL_inserts_writer : public Recordset_text_writer {
+  public:
+    SQL_inserts_writer(const std::string &path, const std::vector<std::string> &column_names,
+                       const Variables &variables)
+      : Recordset_text_writer(path, column_names, variables) {
+      // Everything up to the values is the same for all rows.
+      _insert_prefix = "INSERT INTO `" + variable("TABLE_NAME") + "` (";
+      for (size_t i = 0; i < _column_names.size(); ++i) {
+        if (i > 0)
+          _insert_prefix += ',';
+        _insert_prefix += '`' + _column_names[i] + '`';
+      }
+      _insert_prefix += ") VALUES (";
+    }
+
+  protected:
+    virtual void append_header() {
+      _buffer += "/*\n-- Query: ";
+      _buffer += variable("GENERATOR_QUERY");
+      _buffer += "\n-- Date: ";
+      _buffer += variable("GENERATE_DATE");
+      _buffer += "\n*/\n";
+    }
+
+    virtual void append_row(const std::vector<std::string> &values, const std::vector<bool> &nulls, bool last) {
+      _buffer += _insert_prefix;
+      for (size_t i = 0; i < values.size(); ++i) {
+        if (i > 0)
+          _buffer += ',';
+        _buffer += values[i];
+      }
+      _buffer += ");\n";
+    }
+
+  private:
+    std::string _insert_prefix;
+  };
+
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+Recordset_text_writer::Ref Recordset_text_writer::create(const std::string &format, const std::string &path,
+                                                         const std::vector<std::string> &column_names,
+                                                         const Variables &variables) {
+  // The special characters are those the x-csv_quote modifier looks for with the argument used by each template.
+  if (format == "CSV")
+    return Ref(new CSV_writer(path, column_names, variables, ',', " \"\t\r\n,"));
+  if (format == "CSV_semicolon")
+    return Ref(new CSV_writer(path, column_names, variables, ';', " \"\t\r\n;"));
+  if (format == "tab")
+    return Ref(new CSV_writer(path, column_names, variables, '\t', "\t"));
+  if (format == "JSON")
+    return Ref(new JSON_writer(path, column_names, variables));
+  if (format == "XML")
+    return Ref(new XML_writer(path, column_names, variables));
+  if (format == "XML_mysql")
+    return Ref(new XML_mysql_writer(path, column_names, variables));
+  if (format == "HTML")
+    return Ref(new HTML_writer(path, column_names, variables));
+  if (format == "SQL_inserts")
+    return Ref(new SQL_inserts_writer(path, column_names, variables));
+
+  return Ref();
+}
@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+
+#ifndef _RECORDSET_TEXT_WRITER_H_
+#define _RECORDSET_TEXT_WRITER_H_
+
+#include "wbpublic_public_interface.h"
+#include "base/file_utilities.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Streams a result set in one of the bundled export formats (CSV, tab separated, JSON, XML, HTML and SQL INSERTs)
+ * into a file. The output is byte-identical to what the templates shipped in modules/data/sqlide produce, but values
+ * are escaped straight into one output buffer instead of going through a template dictionary per row and field.
+ * The buffer is written out whenever it grows beyond a fixed size, so memory use doesn't depend on the row count.
+ */
+class WBPUBLICBACKEND_PUBLIC_FUNC Recordset_text_writer {
+public:
+  typedef std::unique_ptr<Recordset_text_writer> Ref;
+  typedef std::map<std::string, std::string> Variables;
+
+  /**
+   * Returns a writer for the given bundled format or an empty reference if there is none, in which case the
+   * template must be expanded instead. The variables are those the templates can refer to (e.g. TABLE_NAME).
+   */
+  static Ref create(const std::string &format, const std::string &path, const std::vector<std::string> &column_names,
+                    const Variables &variables);
+
+  virtual ~Recordset_text_writer();
+
+  void write_header();
+
+  /**
+   * Writes a single row. Null values must already be replaced by the format's null syntax, the null flags are only
+   * needed for formats that mark them explicitly.
+   */
+  void write_row(const std::vector<std::string> &values, const std::vector<bool> &nulls, bool last);
+  void write_footer();
+
+  void flush();
+
+protected:
+  Recordset_text_writer(const std::string &path, const std::vector<std::string> &column_names,
+                        const Variables &variables);
+
+  virtual void append_header() = 0;
+  virtual void append_row(const std::vector<std::string> &values, const std::vector<bool> &nulls, bool last) = 0;
+  virtual void append_footer() {
+  }
+
+  std::string variable(const std::string &name) const;
+
+  std::vector<std::string> _column_names;
+  Variables _variables;
+  std::string _buffer;
+
+private:
+  base::FileHandle _file;
+};
+
+#endif /* _RECORDSET_TEXT_WRITER_H_ */
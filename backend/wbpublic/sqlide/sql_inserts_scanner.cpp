@@ -0,0 +1,467 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <sstream>
+
+#include "base/string_utilities.h"
+#include "grt.h"
+
+#include "sql_inserts_scanner.h"
+
+namespace {
+
+  enum TokenType { EndToken, WordToken, QuotedIdentifierToken, TextToken, SymbolToken };
+
+  struct Token {
+    TokenType type = EndToken;
+    const char *begin = nullptr; // Quoted identifiers begin and end inside of their quotes, like the parser has them.
+    const char *end = nullptr;
+
+    bool is(char c) const {
+      return type == SymbolToken && *begin == c;
+    }
+
+    // The word must be given in upper case.
+    bool is_word(const char *word) const {
+      if (type != WordToken || (size_t)(end - begin) != strlen(word))
+        return false;
+      for (const char *c = begin; c != end; ++c, ++word)
+        if (toupper((unsigned char)*c) != *word)
+          return false;
+      return true;
+    }
+
+    bool is_identifier() const {
+      return type == WordToken || type == QuotedIdentifierToken;
+    }
+
+    // NULL or its \N shortcut.
+    bool is_null() const {
+      return is_word("NULL") || (type == SymbolToken && end - begin == 2 && begin[1] == 'N');
+    }
+
+    std::string identifier() const {
+      if (type != QuotedIdentifierToken)
+        return std::string(begin, end);
+
+      // Doubled quotes stand for one.
+      std::string result;
+      result.reserve(end - begin);
+      char quote = begin[-1];
+      for (const char *c = begin; c != end; ++c) {
+        result.push_back(*c);
+        if (*c == quote)
+          ++c;
+      }
+      return result;
+    }
+  };
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  /**
+   * Splits a script into statements and those into tokens. Whitespace and comments are skipped, the content of
+   * version comments is read like any other code. DELIMITER commands are handled between statements.
+   */
+  class Tokenizer {
+  public:
+    Tokenizer(const std::string &sql, bool ansi_quotes, bool no_backslash_escapes)
+      : _begin(sql.data()),
+        _position(sql.data()),
+        _end(sql.data() + sql.size()),
+        _delimiter(";"),
+        _ansi_quotes(ansi_quotes),
+        _no_backslash_escapes(no_backslash_escapes) {
+    }
+
+    // Moves to the start of the next statement, returns false at the end of the script.
+    bool next_statement() {
+      while (true) {
+        _statement_end = false;
+        skip_whitespace();
+        if (_position == _end)
+          return false;
+        if (!read_delimiter_command())
+          return true;
+      }
+    }
+
+    // Returns the next token of the current statement or an EndToken once its delimiter was reached.
+    Token next() {
+      Token token;
+      if (!_statement_end)
+        skip_whitespace();
+      token.begin = token.end = _position;
+      if (_statement_end || _position == _end) {
+        _statement_end = true;
+        return token;
+      }
+
+      if ((size_t)(_end - _position) >= _delimiter.size() &&
+          memcmp(_position, _delimiter.data(), _delimiter.size()) == 0) {
+        _position += _delimiter.size();
+        _statement_end = true;
+        return token;
+      }
+
+      char c = *_position;
+      if (c == '`' || (c == '"' && _ansi_quotes)) {
+        token.type = QuotedIdentifierToken;
+        token.begin = ++_position;
+        token.end = skip_quoted(c, false);
+      } else if (c == '\'' || c == '"') {
+        token.type = TextToken;
+        ++_position;
+        skip_quoted(c, !_no_backslash_escapes);
+        token.end = _position;
+      } else if (c == '\\' && _end - _position > 1 && _position[1] == 'N') {
+        token.type = SymbolToken;
+        token.end = _position += 2;
+      } else if (is_word_char(c)) {
+        token.type = WordToken;
+        while (_position != _end && is_word_char(*_position))
+          ++_position;
+        token.end = _position;
+      } else {
+        token.type = SymbolToken;
+        token.end = ++_position;
+      }
+
+      return token;
+    }
+
+    void skip_statement() {
+      while (next().type != EndToken)
+        ;
+    }
+
+    const char *position() const {
+      return _position;
+    }
+
+    size_t line_of(const char *position) const {
+      return 1 + std::count(_begin, position, '\n');
+    }
+
+  private:
+    const char *_begin;
+    const char *_position;
+    const char *_end;
+    std::string _delimiter;
+    bool _ansi_quotes;
+    bool _no_backslash_escapes;
+    bool _statement_end = false;
+    bool _in_version_comment = false;
+
+    static bool is_word_char(char c) {
+      return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '$' ||
+             (unsigned char)c >= 0x80;
+    }
+
+    void skip_line() {
+      while (_position != _end && *_position != '\n')
+        ++_position;
+    }
+
+    void skip_whitespace() {
+      while (_position != _end) {
+        char c = *_position;
+        char next = _end - _position > 1 ? _position[1] : '\0';
+        if (isspace((unsigned char)c))
+          ++_position;
+        else if (c == '#')
+          skip_line();
+        else if (c == '-' && next == '-' && (_end - _position == 2 || isspace((unsigned char)_position[2]) ||
+                                             iscntrl((unsigned char)_position[2])))
+          skip_line();
+        else if (c == '/' && next == '*') {
+          if (_end - _position > 2 && _position[2] == '!') {
+            // /*!40101 ... */, the content is read as code.
+            _position += 3;
+            while (_position != _end && *_position >= '0' && *_position <= '9')
+              ++_position;
+            _in_version_comment = true;
+          } else {
+            static const char comment_end[] = "*/";
+            const char *end = std::search(_position + 2, _end, comment_end, comment_end + 2);
+            _position = end == _end ? _end : end + 2;
+          }
+        } else if (c == '*' && next == '/' && _in_version_comment) {
+          _position += 2;
+          _in_version_comment = false;
+        } else
+          break;
+      }
+    }
+
+    // Moves past the closing quote and returns its position (the end of the script if there is none).
+    const char *skip_quoted(char quote, bool backslash_escapes) {
+      while (_position != _end) {
+        char c = *_position;
+        if (backslash_escapes && c == '\\' && _end - _position > 1)
+          _position += 2;
+        else if (c == quote && _end - _position > 1 && _position[1] == quote)
+          _position += 2;
+        else if (c == quote)
+          return _position++;
+        else
+          ++_position;
+      }
+      return _end;
+    }
+
+    bool read_delimiter_command() {
+      static const char command[] = "DELIMITER";
+      static const size_t length = sizeof(command) - 1;
+      if ((size_t)(_end - _position) <= length || !isspace((unsigned char)_position[length]))
+        return false;
+      for (size_t i = 0; i < length; ++i)
+        if (toupper((unsigned char)_position[i]) != command[i])
+          return false;
+
+      _position += length;
+      while (_position != _end && (*_position == ' ' || *_position == '\t'))
+        ++_position;
+      const char *begin = _position;
+      while (_position != _end && !isspace((unsigned char)*_position))
+        ++_position;
+      if (_position != begin)
+        _delimiter.assign(begin, _position);
+      skip_line();
+      return true;
+    }
+  };
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  /**
+   * Reads INSERT statements and passes their rows on. Names and values are taken as the parser based loader
+   * does: field names and values are the text of their tokens, quoted strings lose their outer quotes (but are not
+   * unescaped) and anything other than a number is marked as function call (\func ...).
+   */
+  class Insert_reader {
+  public:
+    Insert_reader(Tokenizer &tokenizer, const std::string &schema_name,
+                  const Sql_inserts_loader::Process_insert &process_insert)
+      : _tokenizer(tokenizer), _schema_name(schema_name), _process_insert(process_insert) {
+    }
+
+    // Returns false if the statement is a malformed INSERT. Rows read up to the error have been passed on already.
+    bool read_statement() {
+      Token token = _tokenizer.next();
+      if (!token.is_word("INSERT"))
+        return true;
+      const char *statement_begin = token.begin;
+
+      token = _tokenizer.next();
+      if (token.is_word("LOW_PRIORITY") || token.is_word("DELAYED") || token.is_word("HIGH_PRIORITY"))
+        token = _tokenizer.next();
+      if (token.is_word("IGNORE"))
+        token = _tokenizer.next();
+      if (token.is_word("INTO"))
+        token = _tokenizer.next();
+
+      if (!token.is_identifier())
+        return false;
+      _schema_table.first = _schema_name;
+      _schema_table.second = token.identifier();
+      token = _tokenizer.next();
+      if (token.is('.')) {
+        token = _tokenizer.next();
+        if (!token.is_identifier())
+          return false;
+        _schema_table.first = _schema_table.second;
+        _schema_table.second = token.identifier();
+        token = _tokenizer.next();
+      }
+
+      _fields_names.clear();
+      if (token.is('(')) {
+        token = _tokenizer.next();
+        if (token.is_word("SELECT") || token.is('('))
+          return true; // INSERT ... (SELECT ...), no rows to load.
+
+        while (!token.is(')')) {
+          // [[schema.]table.]column or table.*
+          if (!token.is_identifier())
+            return false;
+          const char *begin = token.begin;
+          const char *end = token.end;
+          token = _tokenizer.next();
+          while (token.is('.')) {
+            token = _tokenizer.next();
+            if (!token.is_identifier() && !token.is('*'))
+              return false;
+            end = token.end;
+            token = _tokenizer.next();
+          }
+          _fields_names.push_back(std::string(begin, end));
+
+          if (token.is(','))
+            token = _tokenizer.next();
+          else if (!token.is(')'))
+            return false;
+        }
+        token = _tokenizer.next();
+      }
+
+      if (!token.is_word("VALUES") && !token.is_word("VALUE"))
+        return token.is_word("SET") || token.is_word("SELECT") || token.is('('); // Nothing to load in these forms.
+
+      // Passed on with each row instead of the whole statement, which isn't read yet.
+      _sql.assign(statement_begin, token.end);
+      size_t header_length = _sql.size();
+
+      token = _tokenizer.next();
+      while (true) {
+        if (!token.is('('))
+          return false;
+        const char *row_begin = token.begin;
+
+        size_t count = 0;
+        token = _tokenizer.next();
+        if (!token.is(')')) {
+          while (true) {
+            // A value ends at the next comma or closing parenthesis outside of nested parentheses.
+            const char *begin = token.begin;
+            const char *end = token.end;
+            bool is_null = token.is_null();
+            size_t token_count = 0;
+            int depth = 0;
+            while (token.type != EndToken && (depth > 0 || (!token.is(',') && !token.is(')')))) {
+              if (token.is('('))
+                ++depth;
+              else if (token.is(')'))
+                --depth;
+              end = token.end;
+              ++token_count;
+              token = _tokenizer.next();
+            }
+            if (token.type == EndToken || token_count == 0)
+              return false;
+
+            set_value(count++, begin, end, is_null && token_count == 1);
+            if (token.is(')'))
+              break;
+            token = _tokenizer.next();
+          }
+        }
+        _fields_values.resize(count);
+        _null_fields.resize(count);
+
+        _sql.resize(header_length);
+        _sql.append(" ").append(row_begin, token.end);
+        _process_insert(_sql, _schema_table, _fields_names, _fields_values, _null_fields);
+
+        token = _tokenizer.next();
+        if (!token.is(','))
+          break;
+        token = _tokenizer.next();
+      }
+
+      return token.type == EndToken || token.is_word("ON"); // ON DUPLICATE KEY UPDATE ...
+    }
+
+  private:
+    Tokenizer &_tokenizer;
+    const std::string &_schema_name;
+    const Sql_inserts_loader::Process_insert &_process_insert;
+
+    std::string _sql;
+    std::pair<std::string, std::string> _schema_table;
+    Sql_inserts_loader::Strings _fields_names;
+    Sql_inserts_loader::Strings _fields_values;
+    std::vector<bool> _null_fields;
+
+    void set_value(size_t index, const char *begin, const char *end, bool is_null) {
+      if (index == _fields_values.size()) {
+        _fields_values.emplace_back();
+        _null_fields.push_back(false);
+      }
+
+      std::string &value = _fields_values[index];
+      _null_fields[index] = is_null;
+      if (is_null) {
+        value.clear();
+        return;
+      }
+
+      static const char func_call_seq[] = "\\func ";
+      static const size_t func_call_seq_length = sizeof(func_call_seq) - 1;
+      size_t length = end - begin;
+      if (length > 1 && (*begin == '\'' || *begin == '"'))
+        value.assign(begin + 1, end - 1);
+      else if (length > 1 && *begin == '\\') {
+        value.clear();
+        if (length > func_call_seq_length && strncmp(begin, func_call_seq, func_call_seq_length) == 0)
+          value.push_back('\\');
+        value.append(begin, end);
+      } else if (length > 1 && std::find_if(begin, end, [](char c) {
+                                 return (c < '0' || c > '9') && c != '.' && c != ',';
+                               }) != end)
+        value.assign(func_call_seq).append(begin, end);
+      else
+        value.assign(begin, end);
+    }
+  };
+
+} // namespace
+
+//----------------------------------------------------------------------------------------------------------------------
+
+Sql_inserts_scanner::Sql_inserts_scanner(const std::string &sql_mode)
+  : _ansi_quotes(false), _no_backslash_escapes(false) {
+  std::istringstream modes(base::toupper(sql_mode));
+  std::string mode;
+  while (std::getline(modes, mode, ',')) {
+    if (mode == "ANSI" || mode == "DB2" || mode == "MSSQL" || mode == "ORACLE" || mode == "POSTGRESQL" ||
+        mode == "ANSI_QUOTES")
+      _ansi_quotes = true;
+    else if (mode == "NO_BACKSLASH_ESCAPES")
+      _no_backslash_escapes = true;
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void Sql_inserts_scanner::load(const std::string &sql, const std::string &schema_name) {
+  if (!_process_insert)
+    return;
+
+  Tokenizer tokenizer(sql, _ansi_quotes, _no_backslash_escapes);
+  Insert_reader reader(tokenizer, schema_name, _process_insert);
+  while (tokenizer.next_statement()) {
+    const char *statement = tokenizer.position();
+    bool valid = reader.read_statement();
+    tokenizer.skip_statement();
+    if (!valid) {
+      std::string text(statement, std::min<size_t>(tokenizer.position() - statement, 200));
+      grt::GRT::get()->send_error(base::strfmt("Invalid insert statement at line %u, the rest of it was skipped",
+                                               (unsigned int)tokenizer.line_of(statement)),
+                                  text);
+    }
+  }
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#ifndef _SQL_INSERTS_SCANNER_H_
+#define _SQL_INSERTS_SCANNER_H_
+
+#include "wbpublic_public_interface.h"
+#include "grtsqlparser/sql_inserts_loader.h"
+
+/**
+ * Loads the rows of an inserts script (like the one stored for a table's Inserts tab) with a plain tokenizer,
+ * without building a parse tree for the statements. It reports the same INSERT forms with the same field names and
+ * values as the parser based loader of the MySQL module, but each row of a multi row VALUES list is passed on as
+ * soon as it was read and the value buffers are reused from row to row.
+ *
+ * The sql mode is only needed for ANSI_QUOTES and NO_BACKSLASH_ESCAPES, which change how quotes are read.
+ */
+class WBPUBLICBACKEND_PUBLIC_FUNC Sql_inserts_scanner : public Sql_inserts_loader {
+public:
+  typedef std::shared_ptr<Sql_inserts_scanner> Ref;
+  static Ref create(const std::string &sql_mode) {
+    return Ref(new Sql_inserts_scanner(sql_mode));
+  }
+
+  virtual void load(const std::string &sql, const std::string &schema_name) override;
+
+protected:
+  Sql_inserts_scanner(const std::string &sql_mode);
+
+private:
+  bool _ansi_quotes;
+  bool _no_backslash_escapes;
+};
+
+#endif /* _SQL_INSERTS_SCANNER_H_ */
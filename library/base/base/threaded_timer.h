@@ -26,8 +26,12 @@
 #include "common.h"
 
 #include "glib.h"
-#include <list>
+#include <condition_variable>
 #include <functional>
+#include <mutex>
+#include <memory>
+#include <unordered_map>
+#include <vector>
 
 #include "base/threading.h"
 
@@ -36,30 +40,80 @@
 // immediately be stopped. For one-shot tasks the return value has no meaning.
 typedef std::function<bool(int)> TimerFunction;
 
+// Returns the current time in seconds, counted from an arbitrary but fixed point. The timer uses a steady clock,
+// tests can use a clock they advance by hand.
+typedef std::function<double()> TimerClock;
+
 #ifdef _MSC_VER
 #pragma warning(disable : 4251) // We don't want to DLL export TimerTask, and we don't need a warning for that.
 #endif
 
+struct TimerTaskStatistics {
+  size_t runs;
+  double total_run_time; // Seconds spent in the callback, over all runs.
+  double max_run_time;
+  double max_delay;      // The longest time the task had to wait after getting due before it was started.
+};
+
 struct TimerTask {
   int task_id;
-  gdouble next_time;      // Precomputed target time when this task must be triggered again.
-  gdouble wait_time;      // The time in seconds to wait until this task is executed again.
+  double next_time;       // Precomputed target time when this task must be triggered again.
+  double wait_time;       // The time in seconds to wait until this task is executed again.
   TimerFunction callback; // The callback to trigger when the timer fires.
   bool stop;              // Tells the scheduler to remove this task.
   bool single_shot;       // If true then this task will only run once.
   bool scheduled;         // True if the task has been scheduled currently (it is waiting in the pool to get executed).
+  size_t heap_index;      // Position in the scheduler's heap, only valid while the task is not scheduled.
+  TimerTaskStatistics statistics;
 };
 
-typedef std::list<TimerTask> TaskList;
-
 // The unit type of the timer value given to ThreadedTimer::add_task.
 enum TimerUnit { TimerFrequency, TimerTimeSpan };
 
+/**
+ * Keeps the timer tasks in a min-heap ordered by the time they are due next, so finding the next task as well as
+ * adding and cancelling tasks don't depend on the number of tasks. It does no locking and doesn't run anything
+ * itself: due tasks are taken out, run by the caller and then handed back to be rescheduled.
+ */
+class BASELIBRARY_PUBLIC_FUNC TimerScheduler {
+public:
+  TimerScheduler(TimerClock clock);
+  TimerScheduler(const TimerScheduler &) = delete;
+  TimerScheduler &operator=(const TimerScheduler &) = delete;
+  ~TimerScheduler();
+
+  double now() const;
+
+  int add(double wait_time, bool single_shot, TimerFunction callback);
+  bool cancel(int task_id);
+  TimerTask *find(int task_id);
+
+  double next_time() const;
+  TimerTask *take_due();
+  void finished(TimerTask *task, double start_time, bool stop);
+
+  bool statistics(int task_id, TimerTaskStatistics &statistics) const;
+  size_t count() const;
+
+private:
+  TimerClock _clock;
+  int _next_id; // A counter for task ids.
+  std::unordered_map<int, std::unique_ptr<TimerTask>> _tasks;
+  std::vector<TimerTask *> _heap;
+
+  void push(TimerTask *task);
+  void erase(size_t index);
+  void swap(size_t a, size_t b);
+  void sift_up(size_t index);
+  void sift_down(size_t index);
+};
+
 /**
  * The threaded timer is supposed to run as a singleton and provide scheduled timer events. It takes orders when to
  * trigger
  * a timer event, depending on the given frequency (if it is a repeating timer) or delay (for one-shot timers).
  * It forms the base for timed services like animations, server pings in the background etc.
+ * The timer thread sleeps until the next task is due (or a new task is added), instead of polling the tasks.
  */
 class BASELIBRARY_PUBLIC_FUNC ThreadedTimer {
 public:
@@ -68,18 +122,18 @@ public:
 
   static int add_task(TimerUnit unit, double value, bool single_shot, TimerFunction callback);
   static bool remove_task(int task_id);
+  static bool task_statistics(int task_id, TimerTaskStatistics &statistics);
 
 private:
-  base::Mutex _timer_lock; // Synchronize access to the timer class.
+  std::mutex _timer_lock;          // Synchronize access to the timer class.
+  std::condition_variable _wakeup; // Wakes up the timer thread when a task was added or the timer shuts down.
   GThreadPool* _pool;      // A number of threads which trigger the callbacks (to make them independant of each other).
-  int _wait_time;          // The time the timer thread has to wait until looking for new tasks to execute.
   bool _terminate;         // Set to true when shutting down the timer.
-  int _next_id;            // A counter for task ids.
 
   GThread* _thread; // This thread loops endlessly executing tasks as they come in.
-  TaskList _tasks;
+  TimerScheduler _scheduler;
 
-  ThreadedTimer(int base_frequency);
+  ThreadedTimer();
   ~ThreadedTimer();
 
   static gpointer start(gpointer data);
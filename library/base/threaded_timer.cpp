@@ -23,12 +23,16 @@
 
 #include <stdio.h>
 #include <stdexcept>
+#include <chrono>
+#include <cmath>
+#include <limits>
 
 #include "base/threaded_timer.h"
 #include "base/log.h"
 #include "base/threading.h"
 
 // 30 fps should ensure smooth animations. Higher values are better, but put higher load on a system.
+// Tasks are run when they are due, this only limits the timer values accepted by add_task.
 #define BASE_FREQUENCY 30
 
 // Define the maximum number of worker threads. If they are used up tasks have to wait.
@@ -36,6 +40,219 @@
 
 DEFAULT_LOG_DOMAIN(DOMAIN_BASE)
 
+static const size_t NOT_IN_HEAP = std::numeric_limits<size_t>::max();
+
+//--------------------------------------------------------------------------------------------------
+
+TimerScheduler::TimerScheduler(TimerClock clock) : _clock(clock), _next_id(1) {
+}
+
+//--------------------------------------------------------------------------------------------------
+
+TimerScheduler::~TimerScheduler() {
+}
+
+//--------------------------------------------------------------------------------------------------
+
+double TimerScheduler::now() const {
+  return _clock();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Adds a new task, which gets due for the first time after the given wait time.
+ *
+ * @result The id of the new task.
+ */
+int TimerScheduler::add(double wait_time, bool single_shot, TimerFunction callback) {
+  // in theory, it is possible to wrap around to 0 again.  Not a very likely scenario, but better safe than sorry
+  if (_next_id == 0) // 0 is special, skip it over
+    _next_id++;
+
+  TimerTask *task = new TimerTask();
+  task->task_id = _next_id++;
+  task->next_time = now() + wait_time;
+  task->wait_time = wait_time;
+  task->callback = callback;
+  task->stop = false;
+  task->single_shot = single_shot;
+  task->scheduled = false;
+  task->heap_index = NOT_IN_HEAP;
+  task->statistics = {0, 0, 0, 0};
+  _tasks[task->task_id].reset(task);
+  push(task);
+
+  return task->task_id;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Removes the given task. A task which was taken out to run is only flagged and removed once it is finished.
+ *
+ * @returns true if the task is gone (or didn't exist), false if it is currently taken out to run.
+ */
+bool TimerScheduler::cancel(int task_id) {
+  auto entry = _tasks.find(task_id);
+  if (entry == _tasks.end())
+    return true;
+
+  TimerTask *task = entry->second.get();
+  if (task->scheduled) {
+    task->stop = true;
+    return false;
+  }
+
+  erase(task->heap_index);
+  _tasks.erase(entry);
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+TimerTask *TimerScheduler::find(int task_id) {
+  auto entry = _tasks.find(task_id);
+  return entry == _tasks.end() ? nullptr : entry->second.get();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Returns the time the next task is due or a negative value if there are no tasks waiting.
+ */
+double TimerScheduler::next_time() const {
+  return _heap.empty() ? -1 : _heap.front()->next_time;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Takes the task that is due next out of the heap, if it is due already. It must be handed back with finished()
+ * after it ran, to be scheduled again.
+ */
+TimerTask *TimerScheduler::take_due() {
+  if (_heap.empty() || _heap.front()->next_time > now())
+    return nullptr;
+
+  TimerTask *task = _heap.front();
+  erase(0);
+  task->scheduled = true;
+  return task;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Records the run of a task taken out with take_due and either schedules its next run or removes it.
+ *
+ * @param task The task that ran.
+ * @param start_time When the callback was started.
+ * @param stop True if the task should not run again.
+ */
+void TimerScheduler::finished(TimerTask *task, double start_time, bool stop) {
+  double end_time = now();
+  double run_time = end_time - start_time;
+  TimerTaskStatistics &statistics = task->statistics;
+  ++statistics.runs;
+  statistics.total_run_time += run_time;
+  statistics.max_run_time = std::max(statistics.max_run_time, run_time);
+  statistics.max_delay = std::max(statistics.max_delay, start_time - task->next_time);
+
+  task->scheduled = false;
+  if (stop || task->stop || task->single_shot) {
+    _tasks.erase(task->task_id);
+    return;
+  }
+
+  // Keep the original rhythm. If the task ran longer than its interval the runs it missed are skipped, instead of
+  // running it back to back to catch up.
+  task->next_time += task->wait_time;
+  if (task->next_time <= end_time)
+    task->next_time += (std::floor((end_time - task->next_time) / task->wait_time) + 1) * task->wait_time;
+  push(task);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool TimerScheduler::statistics(int task_id, TimerTaskStatistics &statistics) const {
+  auto entry = _tasks.find(task_id);
+  if (entry == _tasks.end())
+    return false;
+
+  statistics = entry->second->statistics;
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+size_t TimerScheduler::count() const {
+  return _tasks.size();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void TimerScheduler::push(TimerTask *task) {
+  task->heap_index = _heap.size();
+  _heap.push_back(task);
+  sift_up(task->heap_index);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void TimerScheduler::erase(size_t index) {
+  TimerTask *task = _heap[index];
+  size_t last = _heap.size() - 1;
+  if (index != last) {
+    swap(index, last);
+    _heap.pop_back();
+
+    // The task moved into the gap can be out of order in either direction.
+    sift_down(index);
+    sift_up(index);
+  } else
+    _heap.pop_back();
+  task->heap_index = NOT_IN_HEAP;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void TimerScheduler::swap(size_t a, size_t b) {
+  std::swap(_heap[a], _heap[b]);
+  _heap[a]->heap_index = a;
+  _heap[b]->heap_index = b;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void TimerScheduler::sift_up(size_t index) {
+  while (index > 0) {
+    size_t parent = (index - 1) / 2;
+    if (_heap[parent]->next_time <= _heap[index]->next_time)
+      break;
+    swap(parent, index);
+    index = parent;
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void TimerScheduler::sift_down(size_t index) {
+  while (true) {
+    size_t smallest = index;
+    size_t left = 2 * index + 1;
+    size_t right = left + 1;
+    if (left < _heap.size() && _heap[left]->next_time < _heap[smallest]->next_time)
+      smallest = left;
+    if (right < _heap.size() && _heap[right]->next_time < _heap[smallest]->next_time)
+      smallest = right;
+    if (smallest == index)
+      break;
+    swap(smallest, index);
+    index = smallest;
+  }
+}
+
 //--------------------------------------------------------------------------------------------------
 
 static ThreadedTimer *_timer = NULL;
@@ -47,7 +264,7 @@ G_LOCK_DEFINE(_timer);
 ThreadedTimer *ThreadedTimer::get() {
   G_LOCK(_timer);
   if (_timer == NULL) {
-    _timer = new ThreadedTimer(BASE_FREQUENCY);
+    _timer = new ThreadedTimer();
   }
   G_UNLOCK(_timer);
   return _timer;
@@ -78,7 +295,7 @@ void ThreadedTimer::stop() {
  * @result The id of the new task (can be used in the callback) or -1 if the task could not be added.
  */
 int ThreadedTimer::add_task(TimerUnit unit, double value, bool single_shot, TimerFunction callback) {
-  TimerTask task = {0, 0.0, 0.0, callback, false, single_shot, false};
+  double wait_time = 0;
 
   if (value <= 0)
     throw std::logic_error("The given timer value is invalid.");
@@ -90,29 +307,24 @@ int ThreadedTimer::add_task(TimerUnit unit, double value, bool single_shot, Time
       //       support this nonetheless.
       if (value > BASE_FREQUENCY)
         throw std::logic_error("The given task frequency is higher than the base frequency.");
-      task.wait_time = 1 / value;
+      wait_time = 1 / value;
       break;
     case TimerTimeSpan:
       // The given value is a time span given in seconds.
       // It must not be lower than the minimal time span we support.
       if (value < 1.0 / BASE_FREQUENCY)
         throw std::logic_error("The given task time span is smaller than the smallest supported value.");
-      task.wait_time = value;
+      wait_time = value;
       break;
   }
-  if (task.wait_time > 0) {
+  if (wait_time > 0) {
     ThreadedTimer *timer = ThreadedTimer::get();
-    base::MutexLock lock(timer->_timer_lock);
-
-    // in theory, it is possible to wrap around to 0 again.  Not a very likely scenario, but better safe than sorry
-    if (timer->_next_id == 0) // 0 is special, skip it over
-      timer->_next_id++;
+    std::lock_guard<std::mutex> lock(timer->_timer_lock);
+    int task_id = timer->_scheduler.add(wait_time, single_shot, callback);
 
-    // We have the lock acquired so it is save to increment the id counter.
-    task.task_id = timer->_next_id++;
-    timer->_tasks.push_back(task);
-
-    return task.task_id;
+    // The new task might be due before the one the timer thread is waiting for.
+    timer->_wakeup.notify_one();
+    return task_id;
   }
   return -1;
 }
@@ -120,8 +332,8 @@ int ThreadedTimer::add_task(TimerUnit unit, double value, bool single_shot, Time
 //--------------------------------------------------------------------------------------------------
 
 /**
- * Removes the given task from the task list by setting its stop flag. If the task is running
- * currently it can finish as usual. It is then removed on the next run of the scheduler.
+ * Removes the given task from the task list. If the task is running currently it can finish as usual.
+ * It is then removed instead of being scheduled again.
  *
  * @param task_id The id of the task to remove. If it does not exist nothing happens.
  */
@@ -132,11 +344,28 @@ bool ThreadedTimer::remove_task(int task_id) {
 
 //--------------------------------------------------------------------------------------------------
 
-ThreadedTimer::ThreadedTimer(int base_frequency) : _terminate(false), _next_id(1) {
-  // Wait time in microseconds.
-  _wait_time = 1000 * 1000 / base_frequency;
-  _thread = base::create_thread(start, this);
+/**
+ * Returns run time statistics for the given task.
+ *
+ * @returns false if there is no such task (anymore).
+ */
+bool ThreadedTimer::task_statistics(int task_id, TimerTaskStatistics &statistics) {
+  ThreadedTimer *timer = ThreadedTimer::get();
+  std::lock_guard<std::mutex> lock(timer->_timer_lock);
+  return timer->_scheduler.statistics(task_id, statistics);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+static double steady_clock_seconds() {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+ThreadedTimer::ThreadedTimer() : _terminate(false), _scheduler(steady_clock_seconds) {
   _pool = g_thread_pool_new((GFunc)pool_function, this, WORKER_THREAD_COUNT, FALSE, NULL);
+  _thread = base::create_thread(start, this);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -149,8 +378,11 @@ ThreadedTimer::~ThreadedTimer() {
   // Pending tasks are discarded.
   logDebug2("Threaded timer shutdown...\n");
 
-  // Don't lock the mutex or we might deadlock here if the mutex is currently held by the work loop.
-  _terminate = true;
+  {
+    std::lock_guard<std::mutex> lock(_timer_lock);
+    _terminate = true;
+    _wakeup.notify_one();
+  }
 
   // Wait for the timer thread to terminate.
   g_thread_join(_thread);
@@ -180,80 +412,45 @@ void ThreadedTimer::pool_function(gpointer data, gpointer user_data) {
   ThreadedTimer *timer = static_cast<ThreadedTimer *>(user_data);
   TimerTask *task = static_cast<TimerTask *>(data);
 
+  double start_time = timer->_scheduler.now();
+  bool do_stop;
   try {
-    bool do_stop = task->callback(task->task_id);
-    base::MutexLock lock(timer->_timer_lock);
-    task->stop = do_stop || task->single_shot;
-    task->scheduled = false;
+    do_stop = task->callback(task->task_id);
   } catch (std::exception &e) {
     // In the case of an exception we remove the task silently.
-    base::MutexLock lock(timer->_timer_lock);
-    task->stop = true;
-    task->scheduled = false;
+    do_stop = true;
     logWarning("Threaded timer: exception in pool function: %s\n", e.what());
   } catch (...) {
     // Most exceptions should be caught by the part above. Just to be on the safe side
     // do this extra branch.
-    base::MutexLock(timer->_timer_lock);
-    task->stop = true;
-    task->scheduled = false;
+    do_stop = true;
     logWarning("Threaded timer: unknown exception in pool function\n");
   }
 
-}
-
-//--------------------------------------------------------------------------------------------------
+  std::lock_guard<std::mutex> lock(timer->_timer_lock);
+  timer->_scheduler.finished(task, start_time, do_stop);
 
-// Helper predicate for removing finished tasks.
-class IsStopped : public std::function<TimerTask (bool)> {
-public:
-  bool operator()(TimerTask &task) {
-    return task.stop;
-  }
-};
+  // A repeating task is back in the heap now, possibly as the next one due.
+  timer->_wakeup.notify_one();
+}
 
 //--------------------------------------------------------------------------------------------------
 
 void ThreadedTimer::main_loop() {
-  // Provides a high-quality clock which is used to compute execution times of tasks.
-  GTimer *clock = g_timer_new();
-  g_timer_start(clock);
+  std::unique_lock<std::mutex> lock(_timer_lock);
   while (!_terminate) {
-    // This sleep call forms our base frequency.
-    g_usleep(_wait_time);
-
-    if (_terminate)
-      break;
-
-    // 1. Compute next execution time for new tasks.
-    base::MutexLock lock(_timer_lock);
-    for (std::list<TimerTask>::iterator iterator = _tasks.begin(); iterator != _tasks.end(); iterator++) {
-      if (iterator->next_time == 0)
-        iterator->next_time = g_timer_elapsed(clock, NULL) + iterator->wait_time;
-    }
-
-    // 2. Execute all tasks which are due now.
-    // Processing of the task entries should be very fast here. No need to make a copy of them.
-    gdouble current_time = g_timer_elapsed(clock, NULL);
-    for (std::list<TimerTask>::iterator iterator = _tasks.begin(); iterator != _tasks.end(); ++iterator) {
-      if (_terminate)
-        break;
-
-      if (!iterator->scheduled && iterator->next_time <= current_time && !iterator->stop) {
-        // When the task is due push it to our thread pool. It will then get one of the
-        // free threads assigned to run in and pool_function is called in this thread's context.
-        // Do it only if it isn't already scheduled.
-        TimerTask &task = *iterator;
-        task.scheduled = true;
-        task.next_time += task.wait_time;
-        g_thread_pool_push(_pool, &task, NULL);
-      }
-    }
-
-    // 3. Remove stopped task.
-    _tasks.remove_if(IsStopped());
+    // Push all tasks which are due now to our thread pool. They will then get one of the free threads
+    // assigned to run in and pool_function is called in this thread's context.
+    while (TimerTask *task = _scheduler.take_due())
+      g_thread_pool_push(_pool, task, NULL);
+
+    // Sleep until the next task is due. Adding a task or shutting down wakes us up earlier.
+    double next_time = _scheduler.next_time();
+    if (next_time < 0)
+      _wakeup.wait(lock);
+    else
+      _wakeup.wait_for(lock, std::chrono::duration<double>(next_time - _scheduler.now()));
   }
-  g_timer_destroy(clock);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -264,15 +461,15 @@ void ThreadedTimer::main_loop() {
  * If the task is already scheduled for execution it cannot be removed anymore.
  */
 bool ThreadedTimer::remove(int task_id) {
-  base::MutexLock lock(_timer_lock);
-  for (std::list<TimerTask>::iterator iterator = _tasks.begin(); iterator != _tasks.end(); iterator++) {
-    if (iterator->task_id == task_id) {
-      iterator->stop = true;
-      TimerTask &task = *iterator;
-      return !static_cast<bool>(g_thread_pool_move_to_front(_pool, &task));
-    }
-  }
-  return true;
+  std::lock_guard<std::mutex> lock(_timer_lock);
+  TimerTask *task = _scheduler.find(task_id);
+  if (task == nullptr)
+    return true;
+
+  // Still waiting in the pool, so it's going to run once more.
+  bool queued = task->scheduled && g_thread_pool_move_to_front(_pool, task);
+  _scheduler.cancel(task_id);
+  return !queued;
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -0,0 +1,267 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+
+#ifndef _CONNECTION_POOL_H_
+#define _CONNECTION_POOL_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace sql {
+
+  /**
+   * A bounded pool of open connections for one set of connection properties.
+   *
+   * acquire() hands out an idle connection (checking first that it is still alive) or opens a new one if fewer than
+   * the maximum are open. Otherwise it waits for a connection to be returned. The handle it returns gives the
+   * connection back to the pool when the last reference to it is dropped. Before a returned connection becomes
+   * idle, its session state is reset. Connections that stay idle for longer than the idle timeout are closed.
+   *
+   * The pool doesn't depend on a particular connection type: opening, checking and resetting connections are done
+   * by the functions given to it. This also lets it be tested without a server.
+   */
+  template <class T>
+  class BasicConnectionPool {
+  public:
+    typedef std::shared_ptr<T> Handle;
+    typedef std::function<std::shared_ptr<T>()> ConnectFunction;
+    typedef std::function<bool(T &)> CheckFunction;
+    typedef std::chrono::steady_clock Clock;
+
+    struct Options {
+      size_t maxConnections = 8;
+      std::chrono::milliseconds idleTimeout = std::chrono::minutes(5);
+      std::chrono::milliseconds waitTimeout = std::chrono::seconds(60);
+    };
+
+    struct Statistics {
+      size_t created = 0;   // Connections opened by the pool.
+      size_t reused = 0;    // Checkouts served by an idle connection.
+      size_t evicted = 0;   // Idle connections closed after the idle timeout.
+      size_t discarded = 0; // Connections that failed the health check or the session reset.
+      size_t waits = 0;     // Checkouts that had to wait for a connection to be returned.
+      size_t inUse = 0;
+      size_t idle = 0;
+    };
+
+    /**
+     * @param isAlive Called on checkout for idle connections, those returning false are closed.
+     * @param reset Called when a connection is returned, to restore its session state. Those for which it returns
+     *              false or throws are closed.
+     */
+    BasicConnectionPool(const Options &options, CheckFunction isAlive, CheckFunction reset)
+      : _state(std::make_shared<State>()) {
+      _state->options = options;
+      _state->isAlive = isAlive;
+      _state->reset = reset;
+    }
+
+    ~BasicConnectionPool() {
+      close();
+    }
+
+    BasicConnectionPool(const BasicConnectionPool &) = delete;
+    BasicConnectionPool &operator=(const BasicConnectionPool &) = delete;
+
+    /**
+     * Returns a connection from the pool or opens one with the given function. Throws std::runtime_error if no
+     * connection was returned to a full pool within the wait timeout. Exceptions from connect are passed on.
+     */
+    Handle acquire(const ConnectFunction &connect) {
+      std::unique_lock<std::mutex> lock(_state->mutex);
+      Clock::time_point deadline = Clock::now() + _state->options.waitTimeout;
+      bool waited = false;
+      while (true) {
+        evictExpired(lock);
+
+        while (!_state->idle.empty()) {
+          // Most recently used first, which lets the others time out when the load drops.
+          std::shared_ptr<T> connection = _state->idle.back().connection;
+          _state->idle.pop_back();
+          ++_state->open;
+          lock.unlock();
+
+          bool alive = false;
+          try {
+            alive = !_state->isAlive || _state->isAlive(*connection);
+          } catch (...) {
+          }
+
+          if (alive) {
+            lock.lock();
+            ++_state->statistics.reused;
+            return lend(connection);
+          }
+
+          connection.reset();
+          lock.lock();
+          --_state->open;
+          ++_state->statistics.discarded;
+          _state->available.notify_one();
+        }
+
+        if (_state->open < _state->options.maxConnections)
+          break;
+
+        if (!waited) {
+          waited = true;
+          ++_state->statistics.waits;
+        }
+        if (_state->available.wait_until(lock, deadline) == std::cv_status::timeout && _state->idle.empty() &&
+            _state->open >= _state->options.maxConnections)
+          throw std::runtime_error("Timed out waiting for a free connection in the connection pool");
+      }
+
+      // Reserve the slot before connecting, so that concurrent checkouts respect the limit.
+      ++_state->open;
+      lock.unlock();
+
+      std::shared_ptr<T> connection;
+      try {
+        connection = connect();
+      } catch (...) {
+        lock.lock();
+        --_state->open;
+        _state->available.notify_one();
+        throw;
+      }
+
+      lock.lock();
+      if (!connection) {
+        --_state->open;
+        _state->available.notify_one();
+        throw std::runtime_error("Could not open a connection for the connection pool");
+      }
+      ++_state->statistics.created;
+      return lend(connection);
+    }
+
+    /**
+     * Closes all idle connections. Connections in use are closed when they are returned instead of becoming idle.
+     */
+    void close() {
+      std::vector<Entry> idle;
+      {
+        std::lock_guard<std::mutex> lock(_state->mutex);
+        _state->closed = true;
+        idle.swap(_state->idle);
+        _state->open -= idle.size();
+      }
+      _state->available.notify_all();
+    }
+
+    /**
+     * Closes the connections that have been idle for longer than the idle timeout.
+     */
+    void evictExpired() {
+      std::unique_lock<std::mutex> lock(_state->mutex);
+      evictExpired(lock);
+    }
+
+    Statistics statistics() const {
+      std::lock_guard<std::mutex> lock(_state->mutex);
+      Statistics result = _state->statistics;
+      result.idle = _state->idle.size();
+      result.inUse = _state->open - result.idle;
+      return result;
+    }
+
+  private:
+    struct Entry {
+      std::shared_ptr<T> connection;
+      Clock::time_point idleSince;
+    };
+
+    // Shared with the handles given out, so that connections can be returned after the pool is gone.
+    struct State {
+      std::mutex mutex;
+      std::condition_variable available;
+      Options options;
+      CheckFunction isAlive;
+      CheckFunction reset;
+      std::vector<Entry> idle; // Sorted by the time they became idle.
+      size_t open = 0;         // Idle and in use.
+      bool closed = false;
+      Statistics statistics;
+    };
+
+    std::shared_ptr<State> _state;
+
+    // Must be called with the lock held. The connections are closed after it is released.
+    void evictExpired(std::unique_lock<std::mutex> &lock) {
+      Clock::time_point limit = Clock::now() - _state->options.idleTimeout;
+      size_t count = 0;
+      while (count < _state->idle.size() && _state->idle[count].idleSince <= limit)
+        ++count;
+      if (count == 0)
+        return;
+
+      std::vector<Entry> expired(_state->idle.begin(), _state->idle.begin() + count);
+      _state->idle.erase(_state->idle.begin(), _state->idle.begin() + count);
+      _state->open -= count;
+      _state->statistics.evicted += count;
+      _state->available.notify_all();
+
+      lock.unlock();
+      expired.clear();
+      lock.lock();
+    }
+
+    // Wraps a connection in a handle that gives it back to the pool when released.
+    Handle lend(std::shared_ptr<T> connection) {
+      std::weak_ptr<State> weakState = _state;
+      return Handle(connection.get(), [weakState, connection](T *) mutable {
+        std::shared_ptr<State> state = weakState.lock();
+        if (!state)
+          return;
+
+        bool clean = false;
+        try {
+          clean = !state->reset || state->reset(*connection);
+        } catch (...) {
+        }
+
+        std::unique_lock<std::mutex> lock(state->mutex);
+        if (clean && !state->closed)
+          state->idle.push_back({ connection, Clock::now() });
+        else {
+          --state->open;
+          if (!clean)
+            ++state->statistics.discarded;
+          lock.unlock();
+          connection.reset();
+        }
+        state->available.notify_one();
+      });
+    }
+  };
+
+} // namespace sql
+
+#endif // _CONNECTION_POOL_H_
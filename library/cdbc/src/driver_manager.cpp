@@ -133,6 +133,20 @@ namespace sql {
     return uri;
   }
 
+  //--------------------------------------------------------------------------------------------------
+
+  // Connections can be shared if they were opened with the same settings. The password is left out, it is
+  // looked up the same way for all of them.
+  static std::string pool_key(const db_mgmt_ConnectionRef &connectionProperties) {
+    std::string key = *connectionProperties->driver()->name();
+    grt::DictRef parameter_values = connectionProperties->parameterValues();
+    for (grt::DictRef::const_iterator iter = parameter_values.begin(); iter != parameter_values.end(); ++iter) {
+      if (iter->first != "password")
+        key.append("\n").append(iter->first).append("=").append(iter->second.toString());
+    }
+    return key;
+  }
+
   //----------------- DriverManager ------------------------------------------------------------------
 
   DriverManager *DriverManager::getDriverManager() {
@@ -190,6 +204,104 @@ namespace sql {
     }
     return getConnection(connectionProperties, tunnel, Authentication::Ref(), connection_init_slot);
   }
+  //--------------------------------------------------------------------------------------------------
+
+  std::shared_ptr<ConnectionPool> DriverManager::getPool(const db_mgmt_ConnectionRef &connectionProperties) {
+    db_mgmt_DriverRef drv = connectionProperties->driver();
+    if (!drv.is_valid())
+      throw SQLException("Invalid connection settings: undefined connection driver");
+
+    std::string key = pool_key(connectionProperties);
+    std::lock_guard<std::mutex> lock(_poolMutex);
+    std::shared_ptr<ConnectionPool> &pool = _connectionPools[key];
+    if (!pool) {
+      std::string default_schema = connectionProperties->parameterValues().get_string("schema", "");
+      pool = std::make_shared<ConnectionPool>(_poolOptions, [](Connection &conn) { return conn.isValid(); },
+                                              [default_schema](Connection &conn) {
+                                                if (!conn.getAutoCommit()) {
+                                                  conn.rollback();
+                                                  conn.setAutoCommit(true);
+                                                }
+                                                if (!default_schema.empty())
+                                                  conn.setSchema(default_schema);
+                                                return true;
+                                              });
+    }
+    return pool;
+  }
+
+  //--------------------------------------------------------------------------------------------------
+
+  ConnectionWrapper DriverManager::getPooledConnection(const db_mgmt_ConnectionRef &connectionProperties) {
+    std::shared_ptr<ConnectionPool> pool = getPool(connectionProperties);
+    ConnectionPtr connection = pool->acquire([this, connectionProperties]() {
+      // The pooled connection keeps its wrapper alive, and with it the tunnel it was opened through.
+      std::shared_ptr<ConnectionWrapper> wrapper(new ConnectionWrapper(getConnection(connectionProperties)));
+      return ConnectionPtr(wrapper, wrapper->get());
+    });
+    return ConnectionWrapper(connection, std::shared_ptr<SSHTunnel>());
+  }
+
+  //--------------------------------------------------------------------------------------------------
+
+  ConnectionPool::Statistics DriverManager::getPoolStatistics(const db_mgmt_ConnectionRef &connectionProperties) {
+    if (!connectionProperties.is_valid() || !connectionProperties->driver().is_valid())
+      return ConnectionPool::Statistics();
+
+    std::shared_ptr<ConnectionPool> pool;
+    {
+      std::lock_guard<std::mutex> lock(_poolMutex);
+      auto iterator = _connectionPools.find(pool_key(connectionProperties));
+      if (iterator == _connectionPools.end())
+        return ConnectionPool::Statistics();
+      pool = iterator->second;
+    }
+    return pool->statistics();
+  }
+
+  //--------------------------------------------------------------------------------------------------
+
+  void DriverManager::evictExpiredConnections() {
+    std::vector<std::shared_ptr<ConnectionPool> > pools;
+    {
+      std::lock_guard<std::mutex> lock(_poolMutex);
+      for (auto &pool : _connectionPools)
+        pools.push_back(pool.second);
+    }
+    for (auto &pool : pools)
+      pool->evictExpired();
+  }
+
+  //--------------------------------------------------------------------------------------------------
+
+  void DriverManager::closeConnectionPool(const db_mgmt_ConnectionRef &connectionProperties) {
+    if (!connectionProperties.is_valid() || !connectionProperties->driver().is_valid())
+      return;
+
+    std::shared_ptr<ConnectionPool> pool;
+    {
+      std::lock_guard<std::mutex> lock(_poolMutex);
+      auto iterator = _connectionPools.find(pool_key(connectionProperties));
+      if (iterator == _connectionPools.end())
+        return;
+      pool = iterator->second;
+      _connectionPools.erase(iterator);
+    }
+    pool->close();
+  }
+
+  //--------------------------------------------------------------------------------------------------
+
+  void DriverManager::closeConnectionPools() {
+    std::map<std::string, std::shared_ptr<ConnectionPool> > pools;
+    {
+      std::lock_guard<std::mutex> lock(_poolMutex);
+      pools.swap(_connectionPools);
+    }
+    for (auto &pool : pools)
+      pool.second->close();
+  }
+
   //--------------------------------------------------------------------------------------------------
   // This method is called when each dispatcher is ending is about to be gone
   // it needs to be called right after that to cleanup the thread storage allocated by driver.
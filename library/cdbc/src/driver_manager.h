@@ -25,9 +25,11 @@
 #define _DRIVER_MANAGER_H_
 
 #include "cppdbc_public_interface.h"
+#include "connection_pool.h"
 
 #include <cppconn/driver.h>
 #include <memory>
+#include <mutex>
 #include <set>
 
 #include "grts/structs.db.mgmt.h"
@@ -39,6 +41,7 @@ namespace wb {
 
 namespace sql {
   typedef std::shared_ptr<Connection> ConnectionPtr;
+  typedef BasicConnectionPool<Connection> ConnectionPool;
 
   class ConnectionWrapper {
     ConnectionPtr _conn;
@@ -143,6 +146,23 @@ namespace sql {
                                     std::shared_ptr<wb::SSHTunnel> tunnel, Authentication::Ref password,
                                     ConnectionInitSlot connection_init_slot = ConnectionInitSlot());
 
+    // Returns a connection from the pool kept for the given connection properties, opening a new one if needed.
+    // It goes back to the pool when the last copy of the wrapper is released, after rolling back an open transaction
+    // and switching back to the default schema. Other session state (variables, temporary tables) is kept, so use
+    // this only for work that doesn't change it.
+    ConnectionWrapper getPooledConnection(const db_mgmt_ConnectionRef &connectionProperties);
+    // Statistics of the pool for the given connection properties, all zero if there is none.
+    ConnectionPool::Statistics getPoolStatistics(const db_mgmt_ConnectionRef &connectionProperties);
+
+    // Closes the connections that have been idle for longer than the idle timeout, in all pools. Without this
+    // they are only closed when the next connection is taken from the same pool.
+    void evictExpiredConnections();
+
+    // Closes the idle connections of the pool for the given connection properties and drops the pool.
+    // Connections still in use are closed when they are released.
+    void closeConnectionPool(const db_mgmt_ConnectionRef &connectionProperties);
+    void closeConnectionPools();
+
     void thread_cleanup();
 
     std::shared_ptr<wb::SSHTunnel> getTunnel(const db_mgmt_ConnectionRef &connectionProperties);
@@ -170,6 +190,7 @@ namespace sql {
 
   private:
     void getClientLibVersion(Driver *driver);
+    std::shared_ptr<ConnectionPool> getPool(const db_mgmt_ConnectionRef &connectionProperties);
 
     TunnelFactoryFunction _createTunnel;
     PasswordFindFunction _findPassword;
@@ -179,6 +200,10 @@ namespace sql {
     std::string _cacheKey;
     time_t _cacheTime;
     std::string _versionInfo;
+
+    std::mutex _poolMutex;
+    std::map<std::string, std::shared_ptr<ConnectionPool> > _connectionPools;
+    ConnectionPool::Options _poolOptions;
   };
 
   class Dbc_connection_handler {
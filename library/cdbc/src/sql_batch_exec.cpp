@@ -25,6 +25,32 @@
 #include <cppconn/exception.h>
 #include <cppconn/resultset.h>
 #include <memory>
+#include <cctype>
+
+namespace {
+
+  // Length of the statement without trailing white space and delimiter, or 0 if it can't be sent as part of a
+  // multi-statement packet. That is also the case for CALL, as it returns an extra result for its status, so the
+  // results can't be matched to the statements anymore.
+  size_t batchable_length(const std::string &statement) {
+    static const char *whitespace = " \t\r\n";
+
+    size_t end = statement.find_last_not_of(whitespace);
+    if (end != std::string::npos && statement[end] == ';')
+      end = end > 0 ? statement.find_last_not_of(whitespace, end - 1) : std::string::npos;
+    if (end == std::string::npos)
+      return 0;
+
+    size_t start = statement.find_first_not_of(whitespace);
+    if (end - start >= 4 && tolower(statement[start]) == 'c' && tolower(statement[start + 1]) == 'a' &&
+        tolower(statement[start + 2]) == 'l' && tolower(statement[start + 3]) == 'l' &&
+        !isalnum((unsigned char)statement[start + 4]) && statement[start + 4] != '_')
+      return 0;
+
+    return end + 1;
+  }
+
+} // namespace
 
 namespace sql {
 
@@ -33,7 +59,9 @@ namespace sql {
       _batch_exec_err_count(0),
       _batch_exec_progress_state(0),
       _batch_exec_progress_inc(0),
-      _stop_on_error(true) {
+      _stop_on_error(true),
+      _batch_size(0),
+      _sql_log_limit(0) {
   }
 
   long SqlBatchExec::operator()(sql::Statement *stmt, std::list<std::string> &statements) {
@@ -59,29 +87,108 @@ namespace sql {
     _batch_exec_progress_state = 0;
     _batch_exec_progress_inc = 1.f / statements.size();
 
-    for (std::list<std::string>::const_iterator i = statements.begin(), i_end = statements.end(); i != i_end; ++i) {
-      try {
-        _sql_log.push_back(*i);
-        if (stmt->execute(*i))
-          std::unique_ptr<sql::ResultSet> rs(stmt->getResultSet());
-        ++_batch_exec_success_count;
-      } catch (SQLException &e) {
-        ++batch_exec_err_count;
-        if (!_error_cb)
-          throw;
-        else {
-          if (&_batch_exec_err_count != &batch_exec_err_count) // applies only to failback scripts
-            _error_cb(-1, "Error when running failback script. Details follow.", "");
-          _error_cb(e.getErrorCode(), e.what(), *i);
-        }
+    if (_batch_size == 0) {
+      for (std::list<std::string>::const_iterator i = statements.begin(), i_end = statements.end(); i != i_end; ++i) {
+        exec_statement(stmt, *i, batch_exec_err_count);
+        if (batch_exec_err_count && _stop_on_error)
+          break;
       }
-      _batch_exec_progress_state += _batch_exec_progress_inc;
-      if (_batch_exec_progress_cb)
-        _batch_exec_progress_cb(_batch_exec_progress_state);
+      return;
+    }
+
+    std::vector<const std::string *> script;
+    script.reserve(statements.size());
+    for (std::list<std::string>::const_iterator i = statements.begin(), i_end = statements.end(); i != i_end; ++i)
+      script.push_back(&*i);
 
+    size_t next = 0;
+    while (next < script.size()) {
+      next = exec_packet(stmt, script, next, batch_exec_err_count);
       if (batch_exec_err_count && _stop_on_error)
         break;
     }
   }
 
+  void SqlBatchExec::exec_statement(sql::Statement *stmt, const std::string &statement, long &batch_exec_err_count) {
+    try {
+      log_statement(statement);
+      if (stmt->execute(statement))
+        std::unique_ptr<sql::ResultSet> rs(stmt->getResultSet());
+      ++_batch_exec_success_count;
+    } catch (SQLException &e) {
+      if (!report_error(e, statement, batch_exec_err_count))
+        throw;
+    }
+    update_progress();
+  }
+
+  /**
+   * Sends the statements starting at begin as one multi-statement packet, as many as fit into the batch size (but at
+   * least one). The server runs them in order and stops at the first error, so the failing statement is the one whose
+   * result was about to be read. Returns the index of the first statement that was not run.
+   */
+  size_t SqlBatchExec::exec_packet(sql::Statement *stmt, const std::vector<const std::string *> &statements,
+                                   size_t begin, long &batch_exec_err_count) {
+    std::string packet;
+    size_t end = begin;
+    for (; end < statements.size(); ++end) {
+      size_t length = batchable_length(*statements[end]);
+      if (length == 0 || (end > begin && packet.size() + length + 3 > _batch_size))
+        break;
+      packet.append(*statements[end], 0, length).append("\n;\n"); // Line break in case it ends with a comment.
+    }
+
+    if (end == begin) {
+      exec_statement(stmt, *statements[begin], batch_exec_err_count);
+      return begin + 1;
+    }
+
+    size_t current = begin;
+    try {
+      bool has_result_set = stmt->execute(packet);
+      while (true) {
+        if (has_result_set)
+          std::unique_ptr<sql::ResultSet> rs(stmt->getResultSet());
+        log_statement(*statements[current]);
+        ++_batch_exec_success_count;
+        update_progress();
+
+        if (++current == end)
+          break;
+        has_result_set = stmt->getMoreResults();
+      }
+    } catch (SQLException &e) {
+      log_statement(*statements[current]);
+      if (!report_error(e, *statements[current], batch_exec_err_count))
+        throw;
+      update_progress();
+      ++current;
+    }
+    return current;
+  }
+
+  // Counts the error and passes it on to the error callback. Returns false if there is none, the caller then rethrows.
+  bool SqlBatchExec::report_error(SQLException &e, const std::string &statement, long &batch_exec_err_count) {
+    ++batch_exec_err_count;
+    if (!_error_cb)
+      return false;
+
+    if (&_batch_exec_err_count != &batch_exec_err_count) // applies only to failback scripts
+      _error_cb(-1, "Error when running failback script. Details follow.", "");
+    _error_cb(e.getErrorCode(), e.what(), statement);
+    return true;
+  }
+
+  void SqlBatchExec::update_progress() {
+    _batch_exec_progress_state += _batch_exec_progress_inc;
+    if (_batch_exec_progress_cb)
+      _batch_exec_progress_cb(_batch_exec_progress_state);
+  }
+
+  void SqlBatchExec::log_statement(const std::string &statement) {
+    _sql_log.push_back(statement);
+    if (_sql_log_limit > 0 && _sql_log.size() > _sql_log_limit)
+      _sql_log.pop_front();
+  }
+
 } // namespace sql
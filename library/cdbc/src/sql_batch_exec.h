@@ -27,8 +27,10 @@
 #include "cppdbc_public_interface.h"
 #include <cppconn/statement.h>
 #include <cppconn/connection.h>
+#include <cppconn/exception.h>
 #include <list>
 #include <string>
+#include <vector>
 #include <functional>
 
 namespace sql {
@@ -42,6 +44,12 @@ namespace sql {
 
   private:
     void exec_sql_script(sql::Statement *stmt, std::list<std::string> &statements, long &batch_exec_err_count);
+    void exec_statement(sql::Statement *stmt, const std::string &statement, long &batch_exec_err_count);
+    size_t exec_packet(sql::Statement *stmt, const std::vector<const std::string *> &statements, size_t begin,
+                       long &batch_exec_err_count);
+    bool report_error(SQLException &e, const std::string &statement, long &batch_exec_err_count);
+    void update_progress();
+    void log_statement(const std::string &statement);
 
   public:
     typedef std::function<int(long long, const std::string &, const std::string &)> Error_cb;
@@ -79,6 +87,19 @@ namespace sql {
   private:
     bool _stop_on_error;
 
+  public:
+    // Maximum size in bytes of the multi-statement packets sent to the server (the connection must allow multiple
+    // statements). Statements are sent one by one if this is 0, which is the default.
+    void batch_size(size_t value) {
+      _batch_size = value;
+    }
+    size_t batch_size() const {
+      return _batch_size;
+    }
+
+  private:
+    size_t _batch_size;
+
   public:
     void failback_statements(const std::list<std::string> &value) {
       _failback_statements = value;
@@ -95,8 +116,17 @@ namespace sql {
       return _sql_log;
     }
 
+    // Number of most recent statements kept in the sql log, 0 (the default) keeps all of them.
+    void sql_log_limit(size_t value) {
+      _sql_log_limit = value;
+    }
+    size_t sql_log_limit() const {
+      return _sql_log_limit;
+    }
+
   private:
     std::list<std::string> _sql_log;
+    size_t _sql_log_limit;
   };
 
 } // namespace sql
@@ -25,6 +25,7 @@
 #include <sstream>
 #include <cctype>
 #include <future>
+#include <deque>
 
 #ifdef __APPLE__
 #pragma GCC diagnostic push
@@ -46,6 +47,7 @@
 #include "mforms/button.h"
 #include "mforms/label.h"
 #include "mforms/textentry.h"
+#include "mforms/utilities.h"
 
 #include "base/string_utilities.h"
 
@@ -83,6 +85,61 @@ static void findNode(TreeNodeRef parent, const std::string &text, JsonTreeBaseVi
 
 //--------------------------------------------------------------------------------------------------
 
+// The text the tree view shows in the value column for a scalar value.
+static std::string valueText(const Value &value) {
+  switch (value.GetType()) {
+    case kStringType:
+      return value.GetString();
+    case kNumberType:
+      if (value.IsDouble())
+        return std::to_string(value.GetDouble());
+      if (value.IsInt64())
+        return std::to_string(value.GetInt64());
+      if (value.IsUint64())
+        return std::to_string(value.GetUint64());
+      return "";
+    case kTrueType:
+      return "true";
+    case kFalseType:
+      return "false";
+    default:
+      return "";
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Collects the paths to all scalar values below the given one whose text contains the search text. If a scope
+ * is given only values within it are considered. Returns early once cancelled is set.
+ */
+static void findValue(Value &value, const std::string &text, Value *scope, bool inScope,
+                      JsonTreeView::JsonValuePath &path, JsonTreeView::JsonValuePathList &found,
+                      const std::atomic<bool> &cancelled) {
+  if (cancelled)
+    return;
+
+  inScope = inScope || &value == scope;
+  path.push_back(&value);
+  switch (value.GetType()) {
+    case kObjectType:
+      for (auto it = value.MemberBegin(); it != value.MemberEnd(); ++it)
+        findValue(it->value, text, scope, inScope, path, found, cancelled);
+      break;
+    case kArrayType:
+      for (auto &item : value.GetArray())
+        findValue(item, text, scope, inScope, path, found, cancelled);
+      break;
+    default:
+      if (inScope && base::contains_string(valueText(value), text, false))
+        found.push_back(path);
+      break;
+  }
+  path.pop_back();
+}
+
+//--------------------------------------------------------------------------------------------------
+
 static std::string getParseErrorText(ParseErrorCode code) {
   std::string text = "No error.";
   switch (code) {
@@ -397,6 +454,7 @@ void JsonTreeBaseView::prepareMenu() {
 //--------------------------------------------------------------------------------------------------
 
 void JsonTreeBaseView::handleMenuCommand(const std::string &command) {
+  stopSearch();
   auto node = _treeView->get_selected_node();
   if (command == "add_new_doc") {
     openInputJsonWindow(node);
@@ -407,6 +465,9 @@ void JsonTreeBaseView::handleMenuCommand(const std::string &command) {
     if (data != nullptr) {
       auto &jv = data->getData();
       auto parent = node->get_parent();
+      while (parent != nullptr && parent->get_data() != nullptr &&
+             dynamic_cast<JsonValueNodeData *>(parent->get_data()) == nullptr)
+        parent = parent->get_parent(); // A range row of a big array.
       if (parent != nullptr) {
         auto parentData = dynamic_cast<JsonValueNodeData *>(parent->get_data());
         if (parentData != nullptr) {
@@ -460,9 +521,10 @@ void JsonTreeBaseView::openInputJsonWindow(TreeNodeRef node, bool updateMode /*=
       switch (jv.GetType()) {
         case kObjectType: {
           jv.AddMember(Value(objectName, _document.GetAllocator()), value, _document.GetAllocator());
-          if (updateMode) {
+          if (updateMode)
             node->remove_children();
-          }
+          else
+            loadChildren(node);
           auto newNode = (updateMode) ? node : node->add_child();
           generateTree(objectName.empty() ? jv : jv[objectName], 0, newNode);
           newNode->set_string(0, objectName + "{" + std::to_string(jv.MemberCount()) + "}");
@@ -476,6 +538,7 @@ void JsonTreeBaseView::openInputJsonWindow(TreeNodeRef node, bool updateMode /*=
             node->remove_children();
             jv.CopyFrom(value, _document.GetAllocator());
           } else {
+            loadChildren(node);
             jv.PushBack(value, _document.GetAllocator());
           }
           auto newNode = (updateMode) ? node : node->add_child();
@@ -634,6 +697,7 @@ void JsonTreeBaseView::generateTree(rapidjson::Value &value, int columnId, TreeN
 //--------------------------------------------------------------------------------------------------
 
 void JsonTreeBaseView::setCellValue(mforms::TreeNodeRef node, int column, const std::string &value) {
+  stopSearch();
   auto data = dynamic_cast<JsonValueNodeData *>(node->get_data());
   bool setData = false;
   if (data != nullptr) {
@@ -820,6 +884,8 @@ JsonTreeView::JsonTreeView(Document &doc) : JsonTreeBaseView(doc) {
   _treeView->set_cell_edit_handler(std::bind(&JsonTreeBaseView::setCellValue, this, ph::_1, ph::_2, ph::_3));
   _treeView->set_selection_mode(TreeSelectSingle);
   _treeView->set_context_menu(_contextMenu);
+  _treeView->signal_expand_toggle()->connect(std::bind(&JsonTreeView::expandToggled, this, ph::_1, ph::_2));
+  _dataChanged.connect([this](bool) { _matches.clear(); });
   init();
 }
 
@@ -833,14 +899,17 @@ void JsonTreeView::init() {
 //--------------------------------------------------------------------------------------------------
 
 JsonTreeView::~JsonTreeView() {
+  stopSearch();
   _treeView->clear();
 }
 
 //--------------------------------------------------------------------------------------------------
 
 void JsonTreeView::clear() {
+  stopSearch();
   _treeView->clear();
   _viewFindResult.clear();
+  _matches.clear();
   _textToFind = "";
   _searchIdx = 0;
   _useFilter = false;
@@ -850,46 +919,366 @@ void JsonTreeView::clear() {
 
 void JsonTreeView::setJson(rapidjson::Value &value) {
   clear();
+  _treeView->BeginUpdate();
   auto node = _treeView->root_node()->add_child();
   generateTree(value, 0, node);
+  expandTree(node);
+  _treeView->EndUpdate();
 }
 
 //--------------------------------------------------------------------------------------------------
 
 void JsonTreeView::appendJson(rapidjson::Value &value) {
+  stopSearch();
   TreeNodeRef node = _treeView->root_node();
   _viewFindResult.clear();
+  _matches.clear();
   _textToFind = "";
   _searchIdx = 0;
   generateTree(value, 0, node);
+  expandTree(node);
 }
 
 //--------------------------------------------------------------------------------------------------
 
-void JsonTreeView::generateObjectInTree(rapidjson::Value &value, int /*columnId*/, TreeNodeRef node, bool addNew) {
-  if (_useFilter && _filterGuard.count(&value) == 0)
+void JsonTreeView::reCreateTree(rapidjson::Value &value) {
+  setJson(value);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void JsonTreeView::highlightMatchNode(const std::string &text, bool backward) {
+  if (_textToFind != text || _matches.empty() || _searchIdx >= _matches.size() ||
+      !base::contains_string(valueText(*_matches[_searchIdx].back()), text, false)) {
+    if (_search && _textToFind == text)
+      return; // Still searching, the first match is selected when done.
+
+    _textToFind = text;
+    _searchIdx = 0;
+    _matches.clear();
+
+    // Search all documents shown. appendJson() puts them into the root node itself.
+    std::vector<rapidjson::Value *> values;
+    auto root = _treeView->root_node();
+    auto rootData = dynamic_cast<JsonValueNodeData *>(root->get_data());
+    if (rootData != nullptr)
+      values.push_back(&rootData->getData());
+    else {
+      for (int i = 0; i < root->count(); ++i) {
+        auto data = dynamic_cast<JsonValueNodeData *>(root->get_child(i)->get_data());
+        if (data != nullptr)
+          values.push_back(&data->getData());
+      }
+    }
+
+    findValues(text, values, nullptr, [this, backward](JsonValuePathList &found) {
+      _matches.swap(found);
+      if (_matches.empty())
+        return;
+      _searchIdx = backward ? _matches.size() - 1 : 0;
+      selectMatch();
+    });
     return;
-  size_t size = 0;
-  node->set_data(new JsonTreeBaseView::JsonValueNodeData(value));
+  }
 
-  for (auto it = value.MemberBegin(); it != value.MemberEnd(); ++it) {
+  if (backward)
+    _searchIdx = (_searchIdx == 0) ? _matches.size() - 1 : _searchIdx - 1;
+  else
+    _searchIdx = (_searchIdx + 1) % _matches.size();
+  selectMatch();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void JsonTreeView::selectMatch() {
+  auto node = revealPath(_matches[_searchIdx]);
+  if (node.is_valid()) {
+    _treeView->select_node(node);
+    _treeView->scrollToNode(node);
+    _treeView->focus();
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Starts filtering the view and returns whether it is filtered now. The new filter is applied when the search is done,
+ * if it found anything.
+ */
+bool JsonTreeView::filterView(const std::string &text, rapidjson::Value &value) {
+  rapidjson::Value *scope = nullptr;
+  auto selectedNode = _treeView->get_selected_node();
+  if (selectedNode.is_valid()) {
+    auto data = dynamic_cast<JsonValueNodeData *>(selectedNode->get_data());
+    if (data != nullptr)
+      scope = &data->getData();
+  }
+
+  findValues(text, { &value }, scope, [this, &value](JsonValuePathList &found) {
+    if (found.empty())
+      return;
+
+    // The filter guard holds the matches and their parents, generateTree() skips everything else.
+    _filterGuard.clear();
+    for (auto &path : found)
+      _filterGuard.insert(path.begin(), path.end());
+
+    clear();
+    _useFilter = true;
+    _treeView->BeginUpdate();
+    auto node = _treeView->root_node()->add_child();
+    generateTree(value, 0, node);
+    expandTree(node);
+    _treeView->EndUpdate();
+  });
+  return _useFilter;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Searches the given documents for scalar values containing the text, in a background thread. This works on the
+ * document only, as most rows of a big document were never created. A search still running is cancelled first.
+ * The matches are passed to done on the main thread, unless the search was cancelled in the meantime.
+ */
+void JsonTreeView::findValues(const std::string &text, const std::vector<rapidjson::Value *> &values,
+                              rapidjson::Value *scope, const std::function<void(JsonValuePathList &found)> &done) {
+  stopSearch();
+
+  auto task = std::make_shared<SearchTask>();
+  _search = task;
+  _searchThread = std::thread([this, task, text, values, scope, done]() {
+    auto found = std::make_shared<JsonValuePathList>();
+    JsonValuePath path;
+    for (auto value : values)
+      findValue(*value, text, scope, scope == nullptr, path, *found, task->cancelled);
+    if (task->cancelled)
+      return;
+
+    // The view cancels its search before it goes away, so it is still there if the task wasn't cancelled.
+    mforms::Utilities::perform_from_main_thread(
+      [this, task, found, done]() -> void * {
+        if (!task->cancelled) {
+          _search.reset();
+          done(*found);
+        }
+        return nullptr;
+      },
+      false);
+  });
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void JsonTreeView::stopSearch() {
+  if (_search) {
+    _search->cancelled = true;
+    _search.reset();
+  }
+
+  // Without a separate main thread (e.g. in tests) the result is delivered from the search thread itself,
+  // which then must not wait for itself.
+  if (_searchThread.joinable() && _searchThread.get_id() != std::this_thread::get_id())
+    _searchThread.join();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void JsonTreeView::waitForSearch() {
+  if (_searchThread.joinable() && _searchThread.get_id() != std::this_thread::get_id())
+    _searchThread.join();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Creates the rows down to the last value in the path, expands its parents and returns the row of the value.
+ */
+TreeNodeRef JsonTreeView::revealPath(const JsonValuePath &path) {
+  TreeNodeRef node = _treeView->root_node();
+  for (auto value : path) {
+    auto data = dynamic_cast<JsonValueNodeData *>(node->get_data());
+    if (data != nullptr) {
+      if (&data->getData() == value)
+        continue;
+      node->expand();
+    }
+    node = findChildRow(node, value);
+    if (!node.is_valid())
+      break;
+  }
+  return node;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+TreeNodeRef JsonTreeView::findChildRow(TreeNodeRef node, rapidjson::Value *value) {
+  loadChildren(node);
+  for (int i = 0; i < node->count(); ++i) {
+    auto child = node->get_child(i);
+    auto range = dynamic_cast<JsonRangeNodeData *>(child->get_data());
+    if (range != nullptr) {
+      std::ptrdiff_t index = value - range->container.Begin();
+      if (index >= (std::ptrdiff_t)range->begin && index < (std::ptrdiff_t)range->end) {
+        child->expand();
+        return findChildRow(child, value);
+      }
+      continue;
+    }
+
+    auto data = dynamic_cast<JsonValueNodeData *>(child->get_data());
+    if (data != nullptr && &data->getData() == value)
+      return child;
+  }
+  return TreeNodeRef();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Expands the tree from the given node on, breadth first, until about pageSize rows were created. Small documents
+ * are so fully expanded, like they always were, while big ones show only their first levels.
+ */
+void JsonTreeView::expandTree(TreeNodeRef node) {
+  std::deque<TreeNodeRef> pending = { node };
+  std::size_t rowCount = 0;
+  while (!pending.empty() && rowCount < pageSize) {
+    auto current = pending.front();
+    pending.pop_front();
+    loadChildren(current);
+    int count = current->count();
+    if (count == 0)
+      continue;
+
+    rowCount += count;
+    current->expand();
+    for (int i = 0; i < count; ++i)
+      pending.push_back(current->get_child(i));
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void JsonTreeView::expandToggled(TreeNodeRef node, bool expanded) {
+  if (expanded)
+    loadChildren(node);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Replaces the placeholder row of the node (if there is one) by the real child rows.
+ */
+void JsonTreeView::loadChildren(TreeNodeRef node) {
+  if (node->count() == 0)
+    return;
+
+  auto placeholder = node->get_child(0);
+  auto range = dynamic_cast<JsonRangeNodeData *>(placeholder->get_data());
+  if (range == nullptr || placeholder->count() > 0) // Not a placeholder but a range row.
+    return;
+
+  rapidjson::Value &value = range->container;
+  rapidjson::SizeType begin = range->begin;
+  rapidjson::SizeType end = range->end;
+  placeholder->remove_from_parent();
+
+  if (value.IsArray())
+    addArrayItems(node, value, begin, end);
+  else if (value.IsObject())
+    addObjectMembers(node, value, begin, end);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void JsonTreeView::addPlaceholder(TreeNodeRef node, rapidjson::Value &value, rapidjson::SizeType begin,
+                                  rapidjson::SizeType end) {
+  auto placeholder = node->add_child();
+  placeholder->set_data(new JsonRangeNodeData(value, begin, end));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void JsonTreeView::addArrayItems(TreeNodeRef node, rapidjson::Value &value, rapidjson::SizeType begin,
+                                 rapidjson::SizeType end) {
+  rapidjson::SizeType count = end - begin;
+  if (_useFilter) {
+    count = 0;
+    for (rapidjson::SizeType i = begin; i < end; ++i)
+      count += (rapidjson::SizeType)_filterGuard.count(&value[i]);
+  }
+
+  if (count > pageSize) {
+    // Too many items for a single level. Split them into ranges of pageSize items (or multiples of it).
+    rapidjson::SizeType step = pageSize;
+    while ((end - begin) / step > pageSize)
+      step *= pageSize;
+
+    for (rapidjson::SizeType first = begin; first < end;) {
+      rapidjson::SizeType last = (end - first > step) ? first + step : end;
+      bool hasItems = !_useFilter;
+      for (rapidjson::SizeType i = first; i < last && !hasItems; ++i)
+        hasItems = _filterGuard.count(&value[i]) > 0;
+
+      if (hasItems) {
+        auto rangeNode = node->add_child();
+        rangeNode->set_icon_path(0, "JS_Datatype_Array.png");
+        rangeNode->set_string(0, base::strfmt("[%u..%u]", first, last - 1));
+        rangeNode->set_string(1, "");
+        rangeNode->set_string(2, "");
+        rangeNode->set_data(new JsonRangeNodeData(value, first, last));
+        addPlaceholder(rangeNode, value, first, last);
+      }
+      first = last;
+    }
+    return;
+  }
+
+  // Items are named after the array row, which is not the parent of a range row.
+  auto arrayNode = node;
+  while (dynamic_cast<JsonValueNodeData *>(arrayNode->get_data()) == nullptr)
+    arrayNode = arrayNode->get_parent();
+  std::string tagName = arrayNode->get_tag();
+  std::string keyName = tagName.empty() ? "key[%d]" : tagName + "[%d]";
+
+  for (rapidjson::SizeType i = begin; i < end; ++i) {
+    auto &v = value[i];
+    if (_useFilter && _filterGuard.count(&v) == 0)
+      continue;
+    auto arrrayNode = node->add_child();
+    bool addNew = false;
+    if (v.GetType() == kArrayType || v.GetType() == kObjectType)
+      addNew = true;
+    arrrayNode->set_string(0, base::strfmt(keyName.c_str(), (int)i));
+    arrrayNode->set_string(1, "");
+    generateTree(v, 1, arrrayNode, addNew);
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void JsonTreeView::addObjectMembers(TreeNodeRef node, rapidjson::Value &value, rapidjson::SizeType begin,
+                                    rapidjson::SizeType end) {
+  for (auto it = value.MemberBegin() + begin; it != value.MemberBegin() + end; ++it) {
     std::string text = it->name.GetString();
     std::stringstream textSize;
     switch (it->value.GetType()) {
       case kArrayType: {
+        if (_useFilter && _filterGuard.count(&it->value) == 0)
+          continue;
         auto &arrayVal = it->value;
-        size = arrayVal.Size();
         node->set_tag(text);
-        textSize << size;
+        textSize << arrayVal.Size();
         text += "[";
         text += textSize.str();
         text += "]";
         break;
       }
       case kObjectType: {
+        if (_useFilter && _filterGuard.count(&it->value) == 0)
+          continue;
         auto &objectVal = it->value;
-        size = objectVal.MemberCount();
-        textSize << size;
+        textSize << objectVal.MemberCount();
         text += "{";
         text += textSize.str();
         text += "}";
@@ -898,24 +1287,37 @@ void JsonTreeView::generateObjectInTree(rapidjson::Value &value, int /*columnId*
       default:
         break;
     }
-    auto node2 = (addNew) ? node->add_child() : node;
-    if (addNew) {
-      node->set_icon_path(0, "JS_Datatype_Object.png");
-      std::string name = node->get_string(0);
-      if (name.empty())
-        node->set_string(0, "<unnamed>");
-      node->set_string(1, "");
-      node->set_string(2, "Object");
-    }
+    auto node2 = node->add_child();
     node2->set_string(0, text);
     node2->set_tag(text);
     generateTree(it->value, 1, node2);
-    node2->expand();
   }
 }
 
 //--------------------------------------------------------------------------------------------------
 
+void JsonTreeView::generateObjectInTree(rapidjson::Value &value, int /*columnId*/, TreeNodeRef node, bool addNew) {
+  if (_useFilter && _filterGuard.count(&value) == 0)
+    return;
+  node->set_data(new JsonTreeBaseView::JsonValueNodeData(value));
+  if (value.MemberCount() == 0)
+    return;
+
+  if (addNew) {
+    node->set_icon_path(0, "JS_Datatype_Object.png");
+    std::string name = node->get_string(0);
+    if (name.empty())
+      node->set_string(0, "<unnamed>");
+    node->set_string(1, "");
+    node->set_string(2, "Object");
+  }
+
+  // Members are added when the node gets expanded.
+  addPlaceholder(node, value, 0, value.MemberCount());
+}
+
+//--------------------------------------------------------------------------------------------------
+
 void JsonTreeView::generateArrayInTree(rapidjson::Value &value, int /*columnId*/, TreeNodeRef node) {
   if (_useFilter && _filterGuard.count(&value) == 0)
     return;
@@ -926,24 +1328,11 @@ void JsonTreeView::generateArrayInTree(rapidjson::Value &value, int /*columnId*/
     node->set_string(0, "<unnamed>");
   node->set_string(1, "");
   node->set_string(2, "Array");
-  std::string tagName = node->get_tag();
   node->set_data(new JsonTreeBaseView::JsonValueNodeData(value));
 
-  int index = 0;
-  for (auto &v : value.GetArray()) {
-    if (_useFilter && _filterGuard.count(&v) == 0)
-      continue;
-    auto arrrayNode = node->add_child();
-    bool addNew = false;
-    if (v.GetType() == kArrayType || v.GetType() == kObjectType)
-      addNew = true;
-    std::string keyName = tagName.empty() ? "key[%d]" : tagName + "[%d]";
-    arrrayNode->set_string(0, base::strfmt(keyName.c_str(), index));
-    arrrayNode->set_string(1, "");
-    generateTree(v, 1, arrrayNode, addNew);
-    index++;
-  }
-  node->expand();
+  // Items are added when the node gets expanded.
+  if (!value.Empty())
+    addPlaceholder(node, value, 0, value.Size());
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -1516,10 +1905,13 @@ JsonTabView::JsonTabView(bool tabLess, JsonTabViewType defaultView)
 //--------------------------------------------------------------------------------------------------
 
 JsonTabView::~JsonTabView() {
+  // The tree view goes away after the document it may still be searching.
+  _treeView->stopSearch();
 }
 
 //--------------------------------------------------------------------------------------------------
 void JsonTabView::setJson(const rapidjson::Value &value) {
+  _treeView->stopSearch();
   Document d;
   _json.CopyFrom(value, d.GetAllocator());
   _ident = 0;
@@ -1593,6 +1985,7 @@ void JsonTabView::dataChanged(bool forceUpdate) {
   } else {
     if (_textView->validate()) {
       _jsonText = _textView->getText();
+      _treeView->stopSearch();
       _json.CopyFrom(_textView->getJson(), _document.GetAllocator());
     } else
       return;
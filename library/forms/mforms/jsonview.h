@@ -30,8 +30,11 @@
 
 #include "Scintilla.h"
 
-#include <set>
+#include <atomic>
 #include <functional>
+#include <memory>
+#include <set>
+#include <thread>
 
 
 /**
@@ -145,12 +148,18 @@ namespace mforms {
     virtual ~JsonTreeBaseView();
     enum JsonNodeIcons { JsonObjectIcon, JsonArrayIcon, JsonStringIcon, JsonNumericIcon, JsonNullIcon };
     void setCellValue(mforms::TreeNodeRef node, int column, const std::string &value);
-    void highlightMatchNode(const std::string &text, bool bacward = false);
-    bool filterView(const std::string &text, rapidjson::Value &value);
-    void reCreateTree(rapidjson::Value &value);
+    virtual void highlightMatchNode(const std::string &text, bool bacward = false);
+    virtual bool filterView(const std::string &text, rapidjson::Value &value);
+    virtual void reCreateTree(rapidjson::Value &value);
+    // Cancels a search running in the background. Must be called before the document is changed.
+    virtual void stopSearch() {
+    }
 
   protected:
     void generateTree(rapidjson::Value &value, int columnId, mforms::TreeNodeRef node, bool addNew = true);
+    // Creates the child rows of the node, for views which do not create them together with the node itself.
+    virtual void loadChildren(TreeNodeRef /*node*/) {
+    }
     virtual void generateArrayInTree(rapidjson::Value &value, int columnId, TreeNodeRef node) = 0;
     virtual void generateObjectInTree(rapidjson::Value &value, int columnId, TreeNodeRef node, bool addNew) = 0;
     virtual void generateNumberInTree(rapidjson::Value &value, int columnId, TreeNodeRef node) = 0;
@@ -178,24 +187,76 @@ namespace mforms {
   };
 
   /**
-   * @brief Json grid view control class definition.
+   * @brief Json tree view control class definition.
+   *
+   * Rows are created on demand: a container gets its child rows only when it is expanded and big arrays are split
+   * into range rows of at most pageSize items each. Search and filter work on the document instead of the rows,
+   * in a background thread. Their result is applied from the main thread once the search is done, unless another
+   * search was started in the meantime.
    */
   class JsonTreeView : public JsonTreeBaseView {
   public:
+    typedef std::vector<rapidjson::Value *> JsonValuePath;
+    typedef std::vector<JsonValuePath> JsonValuePathList;
+
+    static const rapidjson::SizeType pageSize = 1000;
+
     JsonTreeView(rapidjson::Document &doc);
     virtual ~JsonTreeView();
     void setJson(rapidjson::Value &val);
     void appendJson(rapidjson::Value &val);
     virtual void clear();
+    virtual void highlightMatchNode(const std::string &text, bool backward = false);
+    virtual bool filterView(const std::string &text, rapidjson::Value &value);
+    virtual void reCreateTree(rapidjson::Value &value);
+    virtual void stopSearch();
+    // Blocks until the search thread is done. Its result is applied from the main thread afterwards.
+    void waitForSearch();
+
+  protected:
+    virtual void loadChildren(TreeNodeRef node);
 
   private:
+    // Describes a part of a container: the items [begin, end) of an array or the members of an object.
+    // Attached to the range rows of big arrays and to the placeholder row of a container not expanded yet.
+    struct JsonRangeNodeData : public mforms::TreeNodeData {
+      JsonRangeNodeData(rapidjson::Value &value, rapidjson::SizeType first, rapidjson::SizeType last)
+        : container(value), begin(first), end(last) {
+      }
+      rapidjson::Value &container;
+      rapidjson::SizeType begin;
+      rapidjson::SizeType end;
+    };
+
     void init();
+    void expandToggled(TreeNodeRef node, bool expanded);
+    void addPlaceholder(TreeNodeRef node, rapidjson::Value &value, rapidjson::SizeType begin, rapidjson::SizeType end);
+    void addArrayItems(TreeNodeRef node, rapidjson::Value &value, rapidjson::SizeType begin, rapidjson::SizeType end);
+    void addObjectMembers(TreeNodeRef node, rapidjson::Value &value, rapidjson::SizeType begin,
+                          rapidjson::SizeType end);
+    void expandTree(TreeNodeRef node);
+    TreeNodeRef findChildRow(TreeNodeRef node, rapidjson::Value *value);
+    TreeNodeRef revealPath(const JsonValuePath &path);
+    void findValues(const std::string &text, const std::vector<rapidjson::Value *> &values, rapidjson::Value *scope,
+                    const std::function<void(JsonValuePathList &found)> &done);
+    void selectMatch();
     virtual void generateArrayInTree(rapidjson::Value &value, int columnId, TreeNodeRef node);
     virtual void generateObjectInTree(rapidjson::Value &value, int columnId, TreeNodeRef node, bool addNew);
     virtual void generateNumberInTree(rapidjson::Value &value, int columnId, TreeNodeRef node);
     virtual void generateBoolInTree(rapidjson::Value &value, int columnId, TreeNodeRef node);
     virtual void generateNullInTree(rapidjson::Value &value, int columnId, TreeNodeRef node);
     virtual void setStringData(int columnId, TreeNodeRef node, const std::string &text);
+
+    // Shared with the search thread, which stops as soon as the search is cancelled.
+    struct SearchTask {
+      std::atomic<bool> cancelled;
+      SearchTask() : cancelled(false) {
+      }
+    };
+
+    JsonValuePathList _matches;
+    std::shared_ptr<SearchTask> _search;
+    std::thread _searchThread;
   };
 
   /**
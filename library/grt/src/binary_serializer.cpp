@@ -0,0 +1,993 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include "binary_serializer.h"
+
+#include "grtpp_util.h"
+
+#include <glib.h>
+#include <errno.h>
+#include <string.h>
+
+#include "base/log.h"
+#include "base/string_utilities.h"
+#include "base/file_functions.h"
+#include "base/xml_functions.h"
+
+#define GRT_BINARY_MAGIC "GRTB"
+#define GRT_BINARY_MAGIC_SIZE 4
+#define GRT_BINARY_VERSION 2
+
+// Strings longer than this are written inline and not added to the string table.
+#define MAX_INTERNED_STRING_LENGTH 256
+
+DEFAULT_LOG_DOMAIN(DOMAIN_GRT)
+
+using namespace grt;
+using namespace grt::internal;
+
+enum BinaryTag {
+  TagNull = 0,
+  TagInteger = 1,
+  TagDouble = 2,
+  TagString = 3,
+  TagList = 4,
+  TagDict = 5,
+  TagObject = 6,
+  TagContainerLink = 7,
+  TagObjectLink = 8
+};
+
+// String references in the value tree: 0 = new interned string, 1 = inline string, n = string table entry n - 2.
+enum StringRefKind { StringNew = 0, StringInline = 1, StringFirstIndex = 2 };
+
+static void append_varint(std::string &out, uint64_t value) {
+  while (value >= 0x80) {
+    out.push_back((char)((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out.push_back((char)value);
+}
+
+static void append_raw_string(std::string &out, const std::string &value) {
+  append_varint(out, value.size());
+  out.append(value);
+}
+
+static void append_uint32(std::string &out, uint32_t value) {
+  for (int i = 0; i < 4; ++i)
+    out.push_back((char)((value >> (8 * i)) & 0xff));
+}
+
+static void append_double(std::string &out, double value) {
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  for (int i = 0; i < 8; ++i)
+    out.push_back((char)((bits >> (8 * i)) & 0xff));
+}
+
+static inline uint64_t zigzag_encode(int64_t value) {
+  return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static inline int64_t zigzag_decode(uint64_t value) {
+  return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+internal::BinarySerializer::BinarySerializer() : _container_count(0) {
+}
+
+void internal::BinarySerializer::reset() {
+  _body.clear();
+  _seen.clear();
+  _containers.clear();
+  _strings.clear();
+  _classes.clear();
+  _class_index.clear();
+  _objects.clear();
+  _object_index.clear();
+  _xml_classes.clear();
+  _xml_class_index.clear();
+  _xml_object_index.clear();
+  _xml_containers.clear();
+  _container_count = 0;
+}
+
+void internal::BinarySerializer::write_string(const std::string &value) {
+  if (value.size() > MAX_INTERNED_STRING_LENGTH) {
+    append_varint(_body, StringInline);
+    append_raw_string(_body, value);
+    return;
+  }
+
+  std::unordered_map<std::string, size_t>::const_iterator iter = _strings.find(value);
+  if (iter != _strings.end())
+    append_varint(_body, iter->second + StringFirstIndex);
+  else {
+    size_t index = _strings.size();
+    _strings[value] = index;
+    append_varint(_body, StringNew);
+    append_raw_string(_body, value);
+  }
+}
+
+size_t internal::BinarySerializer::class_index(MetaClass *mc) {
+  std::unordered_map<MetaClass *, size_t>::const_iterator iter = _class_index.find(mc);
+  if (iter != _class_index.end())
+    return iter->second;
+
+  size_t index = _classes.size();
+  _classes.push_back(mc);
+  _class_index[mc] = index;
+  return index;
+}
+
+/**
+ * Returns the index of the object in the object table, adding it if needed. Objects are keyed by
+ * their instance and not by id, so documents affected by the duplicate uuid bug are preserved as they are.
+ */
+size_t internal::BinarySerializer::object_index(const ObjectRef &object, bool defined) {
+  std::unordered_map<void *, size_t>::const_iterator iter = _object_index.find(object.valueptr());
+  if (iter != _object_index.end()) {
+    if (defined)
+      _objects[iter->second].defined = true;
+    return iter->second;
+  }
+
+  ObjectEntry entry;
+  entry.class_index = class_index(object.get_metaclass());
+  entry.id = object->id();
+  entry.defined = defined;
+
+  size_t index = _objects.size();
+  _objects.push_back(entry);
+  _object_index[object.valueptr()] = index;
+  return index;
+}
+
+/**
+ * Encodes a GRT value and its sub-values. Lists, dicts and objects are written in full at their
+ * first reference and as links on further ones, following the same rules as the XML serializer.
+ */
+void internal::BinarySerializer::serialize_value(const ValueRef &value, bool list_objects_as_links) {
+  if (!value.is_valid()) {
+    _body.push_back((char)TagNull);
+    return;
+  }
+
+  switch (value.type()) {
+    case IntegerType:
+      _body.push_back((char)TagInteger);
+      append_varint(_body, zigzag_encode((int64_t)*IntegerRef::cast_from(value)));
+      break;
+
+    case DoubleType:
+      _body.push_back((char)TagDouble);
+      append_double(_body, *DoubleRef::cast_from(value));
+      break;
+
+    case StringType:
+      _body.push_back((char)TagString);
+      write_string(*StringRef::cast_from(value));
+      break;
+
+    case ListType: {
+      BaseListRef list(BaseListRef::cast_from(value));
+
+      if (!_seen.insert(value.valueptr()).second) {
+        _body.push_back((char)TagContainerLink);
+        append_varint(_body, _containers[value.valueptr()]);
+        break;
+      }
+      size_t index = _containers.size();
+      _containers[value.valueptr()] = index;
+
+      _body.push_back((char)TagList);
+      _body.push_back((char)list.content_type());
+      write_string(list.content_class_name());
+      append_varint(_body, list.count());
+
+      for (size_t c = list.count(), i = 0; i < c; i++) {
+        ValueRef item(list.get(i));
+
+        if (item.is_valid() && list_objects_as_links && item.type() == ObjectType) {
+          _body.push_back((char)TagObjectLink);
+          append_varint(_body, object_index(ObjectRef::cast_from(item), false));
+        } else
+          serialize_value(item, false);
+      }
+      break;
+    }
+
+    case DictType: {
+      DictRef dict(DictRef::cast_from(value));
+
+      if (!_seen.insert(value.valueptr()).second) {
+        _body.push_back((char)TagContainerLink);
+        append_varint(_body, _containers[value.valueptr()]);
+        break;
+      }
+      size_t index = _containers.size();
+      _containers[value.valueptr()] = index;
+
+      size_t count = 0;
+      for (Dict::const_iterator iter = dict.begin(); iter != dict.end(); ++iter)
+        if (iter->second.is_valid())
+          ++count;
+
+      _body.push_back((char)TagDict);
+      _body.push_back((char)dict.content_type());
+      write_string(dict.content_class_name());
+      append_varint(_body, count);
+      for (Dict::const_iterator iter = dict.begin(); iter != dict.end(); ++iter) {
+        if (iter->second.is_valid()) {
+          write_string(iter->first);
+          serialize_value(iter->second, false);
+        }
+      }
+      break;
+    }
+
+    case ObjectType: {
+      ObjectRef object(ObjectRef::cast_from(value));
+
+      if (!_seen.insert(value.valueptr()).second) {
+        _body.push_back((char)TagObjectLink);
+        append_varint(_body, object_index(object, false));
+      } else
+        serialize_object(object);
+      break;
+    }
+
+    case UnknownType:
+      _body.push_back((char)TagNull);
+      break;
+  }
+}
+
+bool internal::BinarySerializer::serialize_member(const MetaClass::Member *member, const ObjectRef &object) {
+  ValueRef v = object->get_member(member->name);
+
+  write_string(member->name);
+
+  // if 'owned' for this member is not set, then we just dump a link instead of the whole object
+  // 'owned' can be set for objects or lists, if its set on a list the *contents* will be saved as links
+  if (!member->owned_object && v.type() == ObjectType) {
+    _body.push_back((char)TagObjectLink);
+    append_varint(_body, object_index(ObjectRef::cast_from(v), false));
+  } else
+    serialize_value(v, !member->owned_object);
+
+  return true;
+}
+
+void internal::BinarySerializer::serialize_object(const ObjectRef &object) {
+  MetaClass *mc = object->get_metaclass();
+
+  // calculated and unset members are not stored
+  std::vector<const MetaClass::Member *> members;
+  mc->foreach_member([&](const MetaClass::Member *member) {
+    if (!member->calculated && object->get_member(member->name).is_valid())
+      members.push_back(member);
+    return true;
+  });
+
+  _body.push_back((char)TagObject);
+  append_varint(_body, object_index(object, true));
+  append_varint(_body, members.size());
+
+  for (std::vector<const MetaClass::Member *>::const_iterator iter = members.begin(); iter != members.end(); ++iter)
+    serialize_member(*iter, object);
+}
+
+std::string internal::BinarySerializer::serialize_to_data(const ValueRef &value, const std::string &doctype,
+                                                          const std::string &docversion,
+                                                          const std::string &source_tag) {
+  reset();
+  serialize_value(value, false);
+
+  std::vector<ClassEntry> classes;
+  for (std::vector<MetaClass *>::const_iterator iter = _classes.begin(); iter != _classes.end(); ++iter)
+    classes.push_back({ (*iter)->name(), (*iter)->crc32(), true });
+
+  std::string data = compose_data(classes, doctype, docversion, source_tag);
+  reset();
+
+  return data;
+}
+
+/**
+ * Puts header, class and object tables in front of the encoded value tree.
+ */
+std::string internal::BinarySerializer::compose_data(const std::vector<ClassEntry> &classes,
+                                                     const std::string &doctype, const std::string &docversion,
+                                                     const std::string &source_tag) {
+  std::string data;
+  data.reserve(_body.size() + _objects.size() * 40 + 1024);
+
+  data.append(GRT_BINARY_MAGIC, GRT_BINARY_MAGIC_SIZE);
+  data.push_back((char)GRT_BINARY_VERSION);
+  append_raw_string(data, doctype);
+  append_raw_string(data, docversion);
+  append_raw_string(data, source_tag);
+
+  append_varint(data, classes.size());
+  for (std::vector<ClassEntry>::const_iterator iter = classes.begin(); iter != classes.end(); ++iter) {
+    append_raw_string(data, iter->name);
+    append_uint32(data, iter->checksum);
+  }
+
+  append_varint(data, _objects.size());
+  for (std::vector<ObjectEntry>::const_iterator iter = _objects.begin(); iter != _objects.end(); ++iter) {
+    append_varint(data, iter->class_index);
+    append_raw_string(data, iter->id);
+    data.push_back(iter->defined ? 1 : 0);
+  }
+
+  data.append(_body);
+
+  return data;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+size_t internal::BinarySerializer::xml_class_index(const std::string &name) {
+  std::unordered_map<std::string, size_t>::const_iterator iter = _xml_class_index.find(name);
+  if (iter != _xml_class_index.end())
+    return iter->second;
+
+  size_t index = _xml_classes.size();
+  _xml_classes.push_back({ name, 0, false });
+  _xml_class_index[name] = index;
+  return index;
+}
+
+/**
+ * Objects of an XML tree are keyed by id, which gives duplicate ids the same meaning they have when the
+ * XML is loaded: all definitions go to one object. The class of an object which is only linked doesn't
+ * matter, it's looked up by id when loaded.
+ */
+size_t internal::BinarySerializer::xml_object_index(const std::string &id, const std::string &class_name,
+                                                    bool defined) {
+  std::unordered_map<std::string, size_t>::const_iterator iter = _xml_object_index.find(id);
+  if (iter != _xml_object_index.end()) {
+    ObjectEntry &entry = _objects[iter->second];
+    if (defined && !entry.defined) {
+      entry.class_index = xml_class_index(class_name);
+      entry.defined = true;
+    }
+    return iter->second;
+  }
+
+  ObjectEntry entry;
+  entry.class_index = class_name.empty() ? (size_t)-1 : xml_class_index(class_name);
+  entry.id = id;
+  entry.defined = defined;
+
+  size_t index = _objects.size();
+  _objects.push_back(entry);
+  _xml_object_index[id] = index;
+  return index;
+}
+
+void internal::BinarySerializer::serialize_xml_link(xmlNodePtr node, const std::string &class_name) {
+  std::string type = base::xml::getProp(node, "type");
+  std::string content = base::xml::getContent(node);
+
+  if (type == "list" || type == "dict") {
+    std::unordered_map<std::string, size_t>::const_iterator iter = _xml_containers.find(content);
+    _body.push_back((char)TagContainerLink);
+    append_varint(_body, iter != _xml_containers.end() ? iter->second : (uint64_t)-1); // unresolvable
+    return;
+  }
+
+  std::string link_class = base::xml::getProp(node, "struct-name");
+  _body.push_back((char)TagObjectLink);
+  append_varint(_body, xml_object_index(content, link_class.empty() ? class_name : link_class, false));
+}
+
+/**
+ * Encodes a value node and its children, to what the XML unserializer would make of them.
+ */
+void internal::BinarySerializer::serialize_xml_value(xmlNodePtr node) {
+  std::string type = base::xml::getProp(node, "type");
+  if (type.empty())
+    throw std::runtime_error(
+      std::string("Node '").append((char *)node->name).append("' in xml doesn't have a type property"));
+
+  switch (str_to_type(type)) {
+    case IntegerType:
+      _body.push_back((char)TagInteger);
+      append_varint(_body, zigzag_encode((int64_t)strtol(base::xml::getContent(node).c_str(), NULL, 0)));
+      break;
+
+    case DoubleType:
+      _body.push_back((char)TagDouble);
+      append_double(_body, base::atof<double>(base::xml::getContent(node)));
+      break;
+
+    case StringType:
+      _body.push_back((char)TagString);
+      write_string(base::xml::getContent(node));
+      break;
+
+    case ListType: {
+      std::string ptr = base::xml::getProp(node, "_ptr_");
+      if (!ptr.empty())
+        _xml_containers[ptr] = _container_count;
+      ++_container_count;
+
+      std::string content_class = base::xml::getProp(node, "content-struct-name");
+      _body.push_back((char)TagList);
+      _body.push_back((char)str_to_type(base::xml::getProp(node, "content-type")));
+      write_string(content_class);
+
+      size_t count = 0;
+      for (xmlNodePtr child = node->children; child; child = child->next)
+        if (child->type == XML_ELEMENT_NODE)
+          ++count;
+      append_varint(_body, count);
+
+      for (xmlNodePtr child = node->children; child; child = child->next) {
+        if (child->type != XML_ELEMENT_NODE)
+          continue;
+        if (xmlStrcmp(child->name, (xmlChar *)"value") == 0)
+          serialize_xml_value(child);
+        else if (xmlStrcmp(child->name, (xmlChar *)"link") == 0)
+          serialize_xml_link(child, content_class);
+        else
+          _body.push_back((char)TagNull);
+      }
+      break;
+    }
+
+    case DictType: {
+      std::string ptr = base::xml::getProp(node, "_ptr_");
+      if (!ptr.empty())
+        _xml_containers[ptr] = _container_count;
+      ++_container_count;
+
+      std::string content_type = base::xml::getProp(node, "content-type");
+      _body.push_back((char)TagDict);
+      _body.push_back((char)(content_type.empty() ? AnyType : str_to_type(content_type)));
+      write_string(base::xml::getProp(node, "content-struct-name"));
+
+      std::vector<std::pair<std::string, xmlNodePtr> > items;
+      for (xmlNodePtr child = node->children; child; child = child->next) {
+        if (child->type == XML_ELEMENT_NODE) {
+          std::string key = base::xml::getProp(child, "key");
+          if (!key.empty())
+            items.push_back(std::make_pair(key, child));
+        }
+      }
+
+      append_varint(_body, items.size());
+      for (auto &item : items) {
+        write_string(item.first);
+        if (xmlStrcmp(item.second->name, (xmlChar *)"value") == 0)
+          serialize_xml_value(item.second);
+        else if (xmlStrcmp(item.second->name, (xmlChar *)"link") == 0)
+          serialize_xml_link(item.second, "");
+        else
+          _body.push_back((char)TagNull);
+      }
+      break;
+    }
+
+    case ObjectType: {
+      std::string class_name = base::xml::getProp(node, "struct-name");
+      std::string id = base::xml::getProp(node, "id");
+      if (class_name.empty())
+        throw std::runtime_error("error unserializing object (missing struct-name)");
+      if (id.empty())
+        throw std::runtime_error("missing id in unserialized object");
+
+      size_t index = xml_object_index(id, class_name, true);
+      ClassEntry &entry = _xml_classes[xml_class_index(class_name)];
+      std::string checksum = base::xml::getProp(node, "struct-checksum");
+      if (!entry.has_checksum && !checksum.empty()) {
+        entry.checksum = (unsigned int)strtol(checksum.c_str(), NULL, 0);
+        entry.has_checksum = true;
+      }
+
+      std::vector<xmlNodePtr> members;
+      for (xmlNodePtr child = node->children; child; child = child->next)
+        if (child->type == XML_ELEMENT_NODE && !base::xml::getProp(child, "key").empty())
+          members.push_back(child);
+
+      _body.push_back((char)TagObject);
+      append_varint(_body, index);
+      append_varint(_body, members.size());
+      for (auto member : members) {
+        write_string(base::xml::getProp(member, "key"));
+        if (xmlStrcmp(member->name, (xmlChar *)"value") == 0)
+          serialize_xml_value(member);
+        else if (xmlStrcmp(member->name, (xmlChar *)"link") == 0)
+          serialize_xml_link(member, "");
+        else
+          _body.push_back((char)TagNull);
+      }
+      break;
+    }
+
+    default:
+      _body.push_back((char)TagNull);
+      break;
+  }
+}
+
+std::string internal::BinarySerializer::serialize_xmldoc(xmlDocPtr doc, const std::string &source_tag) {
+  reset();
+
+  xmlNodePtr root = xmlDocGetRootElement(doc);
+  if (!root)
+    throw std::runtime_error("Empty XML document");
+
+  xmlNodePtr node = root->children;
+  while (node && (node->type != XML_ELEMENT_NODE || xmlStrcmp(node->name, (xmlChar *)"value") != 0))
+    node = node->next;
+  if (node)
+    serialize_xml_value(node);
+  else
+    _body.push_back((char)TagNull);
+
+  // Linked objects only need some valid class, classes without a checksum (only known from links or
+  // from hand written XML) take the current one.
+  for (std::vector<ObjectEntry>::iterator iter = _objects.begin(); iter != _objects.end(); ++iter) {
+    if (iter->class_index == (size_t)-1)
+      iter->class_index = _xml_classes.empty() ? xml_class_index("GrtObject") : 0;
+  }
+  for (std::vector<ClassEntry>::iterator iter = _xml_classes.begin(); iter != _xml_classes.end(); ++iter) {
+    if (!iter->has_checksum) {
+      MetaClass *mc = grt::GRT::get()->get_metaclass(iter->name);
+      iter->checksum = mc ? mc->crc32() : 0;
+    }
+  }
+
+  std::string data = compose_data(_xml_classes, base::xml::getProp(root, "document_type"),
+                                  base::xml::getProp(root, "version"), source_tag);
+  reset();
+
+  return data;
+}
+
+void internal::BinarySerializer::save_to_file(const ValueRef &value, const std::string &path,
+                                              const std::string &doctype, const std::string &docversion,
+                                              const std::string &source_tag) {
+  std::string data = serialize_to_data(value, doctype, docversion, source_tag);
+
+  FILE *file = base_fopen(path.c_str(), "wb");
+  if (!file)
+    throw grt::os_error("Could not create file " + path, errno);
+
+  if (fwrite(data.data(), 1, data.size(), file) < data.size()) {
+    int err = errno;
+    fclose(file);
+    throw grt::os_error("Could not save binary data to file " + path, err);
+  }
+  fclose(file);
+}
+
+static bool skip_header_string(const std::string &data, size_t &pos) {
+  uint64_t length = 0;
+  for (int shift = 0;; shift += 7) {
+    if (pos >= data.size() || shift >= 64)
+      return false;
+    unsigned char byte = (unsigned char)data[pos++];
+    length |= (uint64_t)(byte & 0x7f) << shift;
+    if (!(byte & 0x80))
+      break;
+  }
+  if (length > data.size() - pos)
+    return false;
+  pos += (size_t)length;
+  return true;
+}
+
+/**
+ * Replaces the source tag in the header of already serialized data. This allows the tag to be computed
+ * from something that is only available after the value was serialized (e.g. a checksum of its XML form).
+ */
+bool internal::BinarySerializer::set_source_tag(std::string &data, const std::string &source_tag) {
+  if (!BinaryUnserializer::is_binary_data(data.data(), data.size()) ||
+      (unsigned char)data[GRT_BINARY_MAGIC_SIZE] != GRT_BINARY_VERSION)
+    return false;
+
+  size_t pos = GRT_BINARY_MAGIC_SIZE + 1;
+  if (!skip_header_string(data, pos) || !skip_header_string(data, pos))
+    return false;
+
+  size_t start = pos;
+  if (!skip_header_string(data, pos))
+    return false;
+
+  std::string tag;
+  append_raw_string(tag, source_tag);
+  data.replace(start, pos - start, tag);
+
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+internal::BinaryUnserializer::BinaryUnserializer(bool check_crc)
+  : _check_serialized_crc(check_crc), _ptr(0), _end(0) {
+}
+
+bool internal::BinaryUnserializer::is_binary_data(const char *data, size_t size) {
+  return size > GRT_BINARY_MAGIC_SIZE && memcmp(data, GRT_BINARY_MAGIC, GRT_BINARY_MAGIC_SIZE) == 0;
+}
+
+unsigned char internal::BinaryUnserializer::read_byte() {
+  if (_ptr >= _end)
+    throw std::runtime_error("Unexpected end of binary GRT data");
+  return *_ptr++;
+}
+
+uint64_t internal::BinaryUnserializer::read_varint() {
+  uint64_t value = 0;
+  for (int shift = 0; shift < 64; shift += 7) {
+    unsigned char byte = read_byte();
+    value |= (uint64_t)(byte & 0x7f) << shift;
+    if (!(byte & 0x80))
+      return value;
+  }
+  throw std::runtime_error("Invalid varint in binary GRT data");
+}
+
+std::string internal::BinaryUnserializer::read_raw_string() {
+  uint64_t length = read_varint();
+  if (length > (uint64_t)(_end - _ptr))
+    throw std::runtime_error("Unexpected end of binary GRT data");
+
+  std::string value((const char *)_ptr, (size_t)length);
+  _ptr += length;
+  return value;
+}
+
+std::string internal::BinaryUnserializer::read_string() {
+  uint64_t kind = read_varint();
+  switch (kind) {
+    case StringNew:
+      _strings.push_back(read_raw_string());
+      return _strings.back();
+    case StringInline:
+      return read_raw_string();
+    default:
+      if (kind - StringFirstIndex >= _strings.size())
+        throw std::runtime_error("Invalid string reference in binary GRT data");
+      return _strings[(size_t)(kind - StringFirstIndex)];
+  }
+}
+
+void internal::BinaryUnserializer::read_header(std::string *doctype, std::string *docversion,
+                                               std::string *source_tag) {
+  if (!is_binary_data((const char *)_ptr, _end - _ptr))
+    throw std::runtime_error("Data is not in binary GRT format");
+  _ptr += GRT_BINARY_MAGIC_SIZE;
+
+  unsigned char version = read_byte();
+  if (version != GRT_BINARY_VERSION)
+    throw std::runtime_error(base::strfmt("Unsupported binary GRT format version %i", version));
+
+  std::string tmp = read_raw_string();
+  if (doctype)
+    *doctype = tmp;
+  tmp = read_raw_string();
+  if (docversion)
+    *docversion = tmp;
+  tmp = read_raw_string();
+  if (source_tag)
+    *source_tag = tmp;
+}
+
+/**
+ * Reads the class and object tables and allocates all objects stored in the data, which is what
+ * the 1st pass over the tree does in the XML unserializer.
+ */
+void internal::BinaryUnserializer::read_tables() {
+  uint64_t count = read_varint();
+  for (uint64_t i = 0; i < count; i++) {
+    std::string name = read_raw_string();
+    unsigned int checksum = 0;
+    for (int b = 0; b < 4; ++b)
+      checksum |= (unsigned int)read_byte() << (8 * b);
+
+    MetaClass *mc = grt::GRT::get()->get_metaclass(name);
+    if (!mc) {
+      logWarning("%s: error unserializing object: struct '%s' unknown", _source_name.c_str(), name.c_str());
+      throw std::runtime_error(base::strfmt("error unserializing object (struct '%s' unknown)", name.c_str()));
+    }
+    if (_check_serialized_crc && checksum != mc->crc32())
+      logWarning("current checksum of struct %s differs from the one when it was saved", name.c_str());
+    _classes.push_back(mc);
+  }
+
+  count = read_varint();
+  for (uint64_t i = 0; i < count; i++) {
+    uint64_t class_index = read_varint();
+    std::string id = read_raw_string();
+    bool defined = read_byte() != 0;
+
+    if (class_index >= _classes.size())
+      throw std::runtime_error("Invalid class reference in binary GRT data");
+    if (id.empty())
+      throw std::runtime_error("missing id in unserialized object");
+
+    _object_ids.push_back(id);
+    if (defined) {
+      ObjectRef object = _classes[(size_t)class_index]->allocate();
+      object->__set_id(id);
+      _objects.push_back(object);
+    } else
+      _objects.push_back(ObjectRef());
+    _resolved.push_back(defined);
+  }
+}
+
+ObjectRef internal::BinaryUnserializer::resolve_object(size_t index) {
+  if (index >= _objects.size())
+    throw std::runtime_error("Invalid object reference in binary GRT data");
+
+  if (!_resolved[index]) {
+    // the linked object is not in the current tree, look for it in the global tree
+    _objects[index] = grt::GRT::get()->find_object_by_id(_object_ids[index], "/");
+    _resolved[index] = true;
+
+    if (!_objects[index].is_valid())
+      logWarning("%s: link '%s' could not be resolved", _source_name.c_str(), _object_ids[index].c_str());
+  }
+  return _objects[index];
+}
+
+ValueRef internal::BinaryUnserializer::unserialize_value(unsigned char tag, const ValueRef &existing) {
+  switch (tag) {
+    case TagNull:
+      return ValueRef();
+
+    case TagInteger:
+      return IntegerRef((ssize_t)zigzag_decode(read_varint()));
+
+    case TagDouble: {
+      uint64_t bits = 0;
+      for (int i = 0; i < 8; ++i)
+        bits |= (uint64_t)read_byte() << (8 * i);
+      double value;
+      memcpy(&value, &bits, sizeof(value));
+      return DoubleRef(value);
+    }
+
+    case TagString:
+      return StringRef(read_string());
+
+    case TagList: {
+      Type content_type = (Type)read_byte();
+      std::string content_class = read_string();
+      uint64_t count = read_varint();
+
+      // owned lists are created together with their object, fill these instead of replacing them
+      BaseListRef list;
+      if (existing.is_valid() && existing.type() == ListType)
+        list = BaseListRef::cast_from(existing);
+      else
+        list = BaseListRef(content_type, content_class);
+      _containers.push_back(list);
+
+      bool skipping = false;
+      for (uint64_t i = 0; i < count; i++) {
+        unsigned char item_tag = read_byte();
+        if (item_tag == TagNull) {
+          if (skipping)
+            continue;
+          if (!list->null_allowed())
+            logWarning("%s: Attempt o add null value to %s list", _source_name.c_str(), content_class.c_str());
+          list.ginsert(ValueRef());
+        } else {
+          ValueRef item = unserialize_value(item_tag);
+          if (skipping)
+            continue;
+
+          if (item.is_valid()) {
+            try {
+              list.ginsert(item);
+            } catch (const std::exception &exc) {
+              logWarning("%s: Error inserting %s to list: %s", _source_name.c_str(), item.debugDescription().c_str(),
+                         exc.what());
+              throw;
+            }
+          } else {
+            // same as with XML: an unresolvable element invalidates the rest of the list
+            logWarning("%s: skipping element %i in unserialized document", _source_name.c_str(), (int)i);
+            skipping = true;
+          }
+        }
+      }
+      return skipping ? ValueRef() : ValueRef(list);
+    }
+
+    case TagDict: {
+      Type content_type = (Type)read_byte();
+      std::string content_class = read_string();
+
+      // owned dicts are created together with their object, fill these instead of replacing them
+      DictRef dict;
+      if (existing.is_valid() && existing.type() == DictType)
+        dict = DictRef::cast_from(existing);
+      else
+        dict = DictRef(content_type, content_class);
+      _containers.push_back(dict);
+
+      uint64_t count = read_varint();
+      for (uint64_t i = 0; i < count; i++) {
+        std::string key = read_string();
+        ValueRef item = unserialize_value(read_byte());
+        dict.set(key, item);
+      }
+      return dict;
+    }
+
+    case TagObject: {
+      uint64_t index = read_varint();
+      if (index >= _objects.size() || !_objects[(size_t)index].is_valid())
+        throw std::runtime_error("Invalid object definition in binary GRT data");
+
+      ObjectRef object(_objects[(size_t)index]);
+      unserialize_object_contents(object);
+      return object;
+    }
+
+    case TagContainerLink: {
+      uint64_t index = read_varint();
+      if (index >= _containers.size()) {
+        logWarning("%s: link to container %i could not be resolved during unserialize", _source_name.c_str(),
+                   (int)index);
+        return ValueRef();
+      }
+      return _containers[(size_t)index];
+    }
+
+    case TagObjectLink:
+      return resolve_object((size_t)read_varint());
+
+    default:
+      throw std::runtime_error(base::strfmt("Invalid value tag %i in binary GRT data", tag));
+  }
+}
+
+void internal::BinaryUnserializer::unserialize_object_contents(const ObjectRef &object) {
+  MetaClass *mc = object->get_metaclass();
+
+  uint64_t count = read_varint();
+  for (uint64_t i = 0; i < count; i++) {
+    std::string key = read_string();
+    unsigned char tag = read_byte();
+    bool has_member = object->has_member(key);
+
+    ValueRef existing;
+    if (has_member && (tag == TagList || tag == TagDict))
+      existing = object->get_member(key);
+
+    ValueRef sub_value;
+    try {
+      sub_value = unserialize_value(tag, existing);
+    } catch (grt::null_value &exc) {
+      logWarning("%s in %s:%s %s", exc.what(), object->class_name().c_str(), key.c_str(), object->id().c_str());
+      throw;
+    }
+
+    if (!has_member) {
+      logWarning("in %s: %s", object.id().c_str(),
+                 std::string("unserialized data contains invalid member " + object.class_name() + "::" + key).c_str());
+      continue;
+    }
+
+    if (sub_value.is_valid()) {
+      try {
+        mc->set_member_internal((internal::Object *)object.valueptr(), key, sub_value, true);
+      } catch (const std::exception &exc) {
+        logWarning("exception setting %s<%s>:%s to %s %s", object.id().c_str(), object.class_name().c_str(),
+                   key.c_str(), sub_value.debugDescription().c_str(), exc.what());
+        throw;
+      }
+    }
+  }
+}
+
+ValueRef internal::BinaryUnserializer::unserialize_data(const char *data, size_t size, std::string *doctype,
+                                                        std::string *docversion, std::string *source_tag) {
+  _ptr = (const unsigned char *)data;
+  _end = _ptr + size;
+
+  _strings.clear();
+  _containers.clear();
+  _classes.clear();
+  _object_ids.clear();
+  _objects.clear();
+  _resolved.clear();
+
+  read_header(doctype, docversion, source_tag);
+  read_tables();
+
+  ValueRef value = unserialize_value(read_byte());
+
+  _containers.clear();
+  _objects.clear();
+
+  return value;
+}
+
+ValueRef internal::BinaryUnserializer::load_from_file(const std::string &path, std::string *doctype,
+                                                      std::string *docversion, std::string *source_tag) {
+  gchar *contents = NULL;
+  gsize length = 0;
+  GError *error = NULL;
+
+  if (!g_file_get_contents(path.c_str(), &contents, &length, &error)) {
+    std::string msg = error ? error->message : "Could not read file " + path;
+    if (error)
+      g_error_free(error);
+    throw std::runtime_error(msg);
+  }
+
+  _source_name = path;
+  try {
+    ValueRef value = unserialize_data(contents, length, doctype, docversion, source_tag);
+    g_free(contents);
+    return value;
+  } catch (...) {
+    g_free(contents);
+    throw;
+  }
+}
+
+/**
+ * Reads only the header of a binary GRT file, so callers can decide whether the file is usable before
+ * loading it.
+ */
+bool internal::BinaryUnserializer::read_metainfo(const std::string &path, std::string &doctype,
+                                                 std::string &docversion, std::string &source_tag) {
+  FILE *file = base_fopen(path.c_str(), "rb");
+  if (!file)
+    return false;
+
+  char buffer[4096];
+  size_t size = fread(buffer, 1, sizeof(buffer), file);
+  fclose(file);
+
+  return read_metainfo(buffer, size, doctype, docversion, source_tag);
+}
+
+bool internal::BinaryUnserializer::read_metainfo(const char *data, size_t size, std::string &doctype,
+                                                 std::string &docversion, std::string &source_tag) {
+  BinaryUnserializer unserializer(false);
+  unserializer._ptr = (const unsigned char *)data;
+  unserializer._end = unserializer._ptr + size;
+  try {
+    unserializer.read_header(&doctype, &docversion, &source_tag);
+  } catch (std::exception &) {
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#pragma once
+
+#include "grt.h"
+
+#include <set>
+#include <unordered_map>
+
+/* Compact binary encoding of GRT values.
+ *
+ * The format carries the same information as the XML serialization, but avoids formatting and parsing
+ * text for every value node:
+ *
+ *  - a header with magic, format version, document type/version and an opaque source tag
+ *  - a class table with the name and checksum of every metaclass used (checksums are verified on load,
+ *    just like the struct-checksum attribute in XML)
+ *  - an object table with the id of every object referenced in the data, so that links are written as
+ *    varint indexes instead of UUID strings and forward links can be resolved in a single pass
+ *  - the value tree, where every value is prefixed by a type tag, integers are zigzag varints and
+ *    strings are interned (repeated member names, class names etc. are written only once)
+ */
+namespace grt {
+  namespace internal {
+    class BinarySerializer {
+    public:
+      BinarySerializer();
+
+      void save_to_file(const ValueRef &value, const std::string &path, const std::string &doctype = "",
+                        const std::string &docversion = "", const std::string &source_tag = "");
+
+      std::string serialize_to_data(const ValueRef &value, const std::string &doctype = "",
+                                    const std::string &docversion = "", const std::string &source_tag = "");
+
+      // Encodes the value tree of an XML document as created by the XML serializer. Only the XML tree is
+      // accessed, so this can run on any thread.
+      std::string serialize_xmldoc(xmlDocPtr doc, const std::string &source_tag = "");
+
+      static bool set_source_tag(std::string &data, const std::string &source_tag);
+
+    protected:
+      std::string _body;
+      std::set<void *> _seen;
+      std::unordered_map<void *, size_t> _containers;
+      std::unordered_map<std::string, size_t> _strings;
+      std::vector<MetaClass *> _classes;
+      std::unordered_map<MetaClass *, size_t> _class_index;
+      struct ObjectEntry {
+        size_t class_index;
+        std::string id;
+        bool defined;
+      };
+      std::vector<ObjectEntry> _objects;
+      std::unordered_map<void *, size_t> _object_index;
+
+      // Used when encoding an XML tree, where classes are only known by name and objects by id.
+      struct ClassEntry {
+        std::string name;
+        unsigned int checksum;
+        bool has_checksum;
+      };
+      std::vector<ClassEntry> _xml_classes;
+      std::unordered_map<std::string, size_t> _xml_class_index;
+      std::unordered_map<std::string, size_t> _xml_object_index;
+      std::unordered_map<std::string, size_t> _xml_containers;
+      size_t _container_count;
+
+      void reset();
+      std::string compose_data(const std::vector<ClassEntry> &classes, const std::string &doctype,
+                               const std::string &docversion, const std::string &source_tag);
+
+      void write_string(const std::string &value);
+
+      size_t object_index(const ObjectRef &object, bool defined);
+      size_t class_index(MetaClass *mc);
+
+      void serialize_value(const ValueRef &value, bool list_objects_as_links);
+      void serialize_object(const ObjectRef &object);
+      bool serialize_member(const MetaClass::Member *member, const ObjectRef &object);
+
+      size_t xml_class_index(const std::string &name);
+      size_t xml_object_index(const std::string &id, const std::string &class_name, bool defined);
+      void serialize_xml_link(xmlNodePtr node, const std::string &class_name);
+      void serialize_xml_value(xmlNodePtr node);
+    };
+
+    class BinaryUnserializer {
+    public:
+      BinaryUnserializer(bool check_crc);
+
+      ValueRef load_from_file(const std::string &path, std::string *doctype = 0, std::string *docversion = 0,
+                              std::string *source_tag = 0);
+
+      ValueRef unserialize_data(const char *data, size_t size, std::string *doctype = 0, std::string *docversion = 0,
+                                std::string *source_tag = 0);
+
+      static bool is_binary_data(const char *data, size_t size);
+      static bool read_metainfo(const std::string &path, std::string &doctype, std::string &docversion,
+                                std::string &source_tag);
+      static bool read_metainfo(const char *data, size_t size, std::string &doctype, std::string &docversion,
+                                std::string &source_tag);
+
+    protected:
+      std::string _source_name;
+      bool _check_serialized_crc;
+
+      const unsigned char *_ptr;
+      const unsigned char *_end;
+
+      std::vector<std::string> _strings;
+      std::vector<ValueRef> _containers;
+      std::vector<MetaClass *> _classes;
+      std::vector<std::string> _object_ids;
+      std::vector<ObjectRef> _objects;
+      std::vector<bool> _resolved;
+
+      void read_header(std::string *doctype, std::string *docversion, std::string *source_tag);
+      void read_tables();
+
+      unsigned char read_byte();
+      uint64_t read_varint();
+      std::string read_raw_string();
+      std::string read_string();
+
+      ObjectRef resolve_object(size_t index);
+
+      ValueRef unserialize_value(unsigned char tag, const ValueRef &existing = ValueRef());
+      void unserialize_object_contents(const ObjectRef &object);
+    };
+  };
+};
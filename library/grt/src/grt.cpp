@@ -41,6 +41,7 @@
 
 #include "serializer.h"
 #include "unserializer.h"
+#include "binary_serializer.h"
 #include <iostream>
 
 DEFAULT_LOG_DOMAIN(DOMAIN_GRT)
@@ -716,6 +717,15 @@ ValueRef GRT::unserialize_xml(xmlDocPtr doc, const std::string &source_path) {
   }
 }
 
+/**
+ * Serializes the value into an XML tree without writing it anywhere. The tree is independent of the GRT,
+ * so it can be formatted or written from another thread. The caller must free it with xmlFreeDoc().
+ */
+xmlDocPtr GRT::create_xml_document(const ValueRef &value, const std::string &doctype, const std::string &version,
+                                   bool list_objects_as_links) {
+  return internal::Serializer().create_xmldoc_for_value(value, doctype, version, list_objects_as_links);
+}
+
 std::string GRT::serialize_xml_data(const ValueRef &value, const std::string &doctype, const std::string &version,
                                     bool list_objects_as_links) {
   return internal::Serializer().serialize_to_xmldata(value, doctype, version, list_objects_as_links);
@@ -725,6 +735,60 @@ ValueRef GRT::unserialize_xml_data(const std::string &data) {
   return internal::Unserializer(_check_serialized_crc).unserialize_xmldata(data.data(), data.size());
 }
 
+void GRT::serialize_binary(const ValueRef &value, const std::string &path, const std::string &doctype,
+                           const std::string &version, const std::string &source_tag) {
+  internal::BinarySerializer().save_to_file(value, path, doctype, version, source_tag);
+}
+
+ValueRef GRT::unserialize_binary(const std::string &path, std::string &doctype_ret, std::string &version_ret,
+                                 std::string *source_tag_ret) {
+  internal::BinaryUnserializer unser(_check_serialized_crc);
+
+  if (!g_file_test(path.c_str(), G_FILE_TEST_EXISTS))
+    throw os_error(path);
+  try {
+    return unser.load_from_file(path, &doctype_ret, &version_ret, source_tag_ret);
+  } catch (std::exception &exc) {
+    throw grt_runtime_error("Error unserializing GRT data from " + path, exc.what());
+  }
+}
+
+bool GRT::get_binary_metainfo(const std::string &path, std::string &doctype_ret, std::string &version_ret,
+                              std::string &source_tag_ret) {
+  return internal::BinaryUnserializer::read_metainfo(path, doctype_ret, version_ret, source_tag_ret);
+}
+
+std::string GRT::serialize_binary_data(const ValueRef &value, const std::string &doctype, const std::string &version,
+                                       const std::string &source_tag) {
+  return internal::BinarySerializer().serialize_to_data(value, doctype, version, source_tag);
+}
+
+// Encodes a document created by create_xml_document(). Only the XML tree is read, so the values may
+// change while this runs.
+std::string GRT::serialize_binary_data(xmlDocPtr xmldoc, const std::string &source_tag) {
+  return internal::BinarySerializer().serialize_xmldoc(xmldoc, source_tag);
+}
+
+bool GRT::set_binary_data_source_tag(std::string &data, const std::string &source_tag) {
+  return internal::BinarySerializer::set_source_tag(data, source_tag);
+}
+
+ValueRef GRT::unserialize_binary_data(const std::string &data, std::string &doctype_ret, std::string &version_ret,
+                                      std::string *source_tag_ret) {
+  try {
+    return internal::BinaryUnserializer(_check_serialized_crc)
+      .unserialize_data(data.data(), data.size(), &doctype_ret, &version_ret, source_tag_ret);
+  } catch (std::exception &exc) {
+    throw grt_runtime_error("Error unserializing binary GRT data", exc.what());
+  }
+}
+
+bool GRT::get_binary_data_metainfo(const std::string &data, std::string &doctype_ret, std::string &version_ret,
+                                   std::string &source_tag_ret) {
+  return internal::BinaryUnserializer::read_metainfo(data.data(), data.size(), doctype_ret, version_ret,
+                                                     source_tag_ret);
+}
+
 //--------------------------------------------------------------------------------
 
 void GRT::add_module_loader(ModuleLoader *loader) {
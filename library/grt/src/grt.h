@@ -2534,11 +2534,28 @@ namespace grt {
     xmlDocPtr load_xml(const std::string &path);
     void get_xml_metainfo(xmlDocPtr doc, std::string &doctype_ret, std::string &version_ret);
     ValueRef unserialize_xml(xmlDocPtr doc, const std::string &source_path);
+    xmlDocPtr create_xml_document(const ValueRef &value, const std::string &doctype = "",
+                                  const std::string &version = "", bool list_objects_as_links = false);
 
     std::string serialize_xml_data(const ValueRef &value, const std::string &doctype = "",
                                    const std::string &version = "", bool list_objects_as_links = false);
     ValueRef unserialize_xml_data(const std::string &data);
 
+    void serialize_binary(const ValueRef &value, const std::string &path, const std::string &doctype = "",
+                          const std::string &version = "", const std::string &source_tag = "");
+    ValueRef unserialize_binary(const std::string &path, std::string &doctype_ret, std::string &version_ret,
+                                std::string *source_tag_ret = nullptr);
+    bool get_binary_metainfo(const std::string &path, std::string &doctype_ret, std::string &version_ret,
+                             std::string &source_tag_ret);
+    std::string serialize_binary_data(const ValueRef &value, const std::string &doctype, const std::string &version,
+                                      const std::string &source_tag = "");
+    std::string serialize_binary_data(xmlDocPtr xmldoc, const std::string &source_tag = "");
+    bool set_binary_data_source_tag(std::string &data, const std::string &source_tag);
+    ValueRef unserialize_binary_data(const std::string &data, std::string &doctype_ret, std::string &version_ret,
+                                     std::string *source_tag_ret = nullptr);
+    bool get_binary_data_metainfo(const std::string &data, std::string &doctype_ret, std::string &version_ret,
+                                  std::string &source_tag_ret);
+
     // globals
 
     inline ValueRef root() const {
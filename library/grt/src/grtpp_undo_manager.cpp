@@ -24,10 +24,16 @@
 #include "base/log.h"
 
 #include "grtpp_undo_manager.h"
+#include "base/file_utilities.h"
 #include "base/string_utilities.h"
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
+#include <set>
 #include <time.h>
+#include <typeinfo>
+#include <vector>
 
 #ifdef _MSC_VER
 #undef max
@@ -106,6 +112,140 @@ static std::string member_for_object_dict(const ObjectRef &object, const DictRef
 
 //---------------------------------------------------------------------------------------------------
 
+namespace {
+
+  /**
+   * Estimates the memory kept alive by values an undo action refers to. Starting at the given values, the walk
+   * follows owning references the same way the model serializer does (owned objects, the content of lists and
+   * dicts). A value counts only if all of its references were found in the walk, i.e. it is kept alive by the action
+   * alone (an old value that was replaced or a removed object with everything it owns). Values still in use
+   * elsewhere (the model itself) cost nothing.
+   */
+  class RetainedSize {
+  public:
+    void add(const ValueRef &value) {
+      walk(value, false);
+    }
+
+    size_t size() const {
+      size_t total = 0;
+      for (auto &node : _nodes) {
+        if (node.second.walked && node.second.references >= (size_t)node.first->refcount())
+          total += node.second.size;
+      }
+      return total;
+    }
+
+  private:
+    // Large model parts are shared anyway, no need to walk all of them.
+    static const size_t max_nodes = 50000;
+
+    struct Node {
+      size_t size = 0;
+      size_t references = 0;
+      bool walked = false;
+    };
+    std::map<internal::Value *, Node> _nodes;
+
+    void reference(const ValueRef &value) {
+      if (value.is_valid())
+        _nodes[value.valueptr()].references++;
+    }
+
+    void walk(const ValueRef &value, bool links) {
+      if (!value.is_valid() || _nodes.size() > max_nodes)
+        return;
+
+      Node &node = _nodes[value.valueptr()];
+      node.references++;
+      if (node.walked)
+        return;
+      node.walked = true;
+
+      switch (value.type()) {
+        case IntegerType:
+          node.size = sizeof(internal::Integer);
+          break;
+
+        case DoubleType:
+          node.size = sizeof(internal::Double);
+          break;
+
+        case StringType:
+          node.size = sizeof(internal::String) + (**static_cast<internal::String *>(value.valueptr())).size();
+          break;
+
+        case ListType: {
+          internal::List *list = static_cast<internal::List *>(value.valueptr());
+          node.size = sizeof(internal::List) + list->count() * sizeof(ValueRef);
+          for (internal::List::raw_const_iterator iter = list->raw_begin(); iter != list->raw_end(); ++iter)
+            content(*iter, links);
+          break;
+        }
+
+        case DictType: {
+          internal::Dict *dict = static_cast<internal::Dict *>(value.valueptr());
+          node.size = sizeof(internal::Dict);
+          for (internal::Dict::const_iterator iter = dict->begin(); iter != dict->end(); ++iter) {
+            node.size += sizeof(*iter) + 4 * sizeof(void *) + iter->first.size();
+            content(iter->second, links);
+          }
+          break;
+        }
+
+        case ObjectType: {
+          internal::Object *object = static_cast<internal::Object *>(value.valueptr());
+          MetaClass *meta = object->get_metaclass();
+          size_t size = sizeof(internal::Object);
+          meta->foreach_member([&](const MetaClass::Member *member) {
+            if (member->calculated || member->private_ || member->delegate_get)
+              return true;
+
+            size += sizeof(ValueRef);
+            ValueRef member_value(meta->get_member_value(object, member));
+            if (member_value.type() == ObjectType) {
+              if (member->owned_object)
+                walk(member_value, false);
+              else
+                reference(member_value);
+            } else // For lists and dicts "owned" means their content are references.
+              walk(member_value, member->owned_object);
+            return true;
+          });
+          node.size = size;
+          break;
+        }
+
+        default:
+          break;
+      }
+    }
+
+    void content(const ValueRef &value, bool links) {
+      if (links && value.type() == ObjectType)
+        reference(value);
+      else
+        walk(value, links);
+    }
+  };
+
+  size_t retained_size(const ValueRef &value) {
+    RetainedSize size;
+    size.add(value);
+    return size.size();
+  }
+
+  // Overhead of an entry in an undo group's action list.
+  const size_t action_entry_size = 3 * sizeof(void *);
+
+} // namespace
+
+//---------------------------------------------------------------------------------------------------
+
+size_t UndoAction::memory_size() const {
+  return sizeof(*this) + _description.size();
+}
+
 void UndoAction::set_description(const std::string &description) {
   _description = description;
 }
@@ -116,6 +256,10 @@ void SimpleUndoAction::dump(std::ostream &out, int indent) const {
   out << strfmt("%*s custom_action ", indent, "") << ": " << _description << std::endl;
 }
 
+size_t SimpleUndoAction::memory_size() const {
+  return sizeof(*this) + description().size();
+}
+
 //---------------------------------------------------------------------------------------------------
 
 UndoObjectChangeAction::UndoObjectChangeAction(const ObjectRef &object, const std::string &member)
@@ -151,6 +295,10 @@ void UndoObjectChangeAction::dump(std::ostream &out, int indent) const {
       << "> ->" << new_value << ": " << description() << std::endl;
 }
 
+size_t UndoObjectChangeAction::memory_size() const {
+  return sizeof(*this) + description().size() + _member.size() + retained_size(_value);
+}
+
 //---------------------------------------------------------------------------------------------------
 
 UndoListInsertAction::UndoListInsertAction(const BaseListRef &list, size_t index) : _list(list), _index(index) {
@@ -192,6 +340,10 @@ void UndoListInsertAction::dump(std::ostream &out, int indent) const {
   out << ": " << description() << std::endl;
 }
 
+size_t UndoListInsertAction::memory_size() const {
+  return sizeof(*this) + description().size();
+}
+
 //---------------------------------------------------------------------------------------------------
 
 UndoListReorderAction::UndoListReorderAction(const BaseListRef &list, size_t oindex, size_t nindex)
@@ -225,12 +377,20 @@ void UndoListReorderAction::dump(std::ostream &out, int indent) const {
   out << ": " << description() << std::endl;
 }
 
+size_t UndoListReorderAction::memory_size() const {
+  return sizeof(*this) + description().size();
+}
+
 //---------------------------------------------------------------------------------------------------
 
 UndoListSetAction::UndoListSetAction(const BaseListRef &list, size_t index) : _list(list), _index(index) {
   _value = list.get(index);
 }
 
+UndoListSetAction::UndoListSetAction(const BaseListRef &list, size_t index, const ValueRef &value)
+  : _list(list), _index(index), _value(value) {
+}
+
 void UndoListSetAction::undo(UndoManager *owner) {
   /*
   owner->add_undo(new UndoListSetAction(_list, _index));
@@ -258,6 +418,10 @@ void UndoListSetAction::dump(std::ostream &out, int indent) const {
   out << ": " << description() << std::endl;
 }
 
+size_t UndoListSetAction::memory_size() const {
+  return sizeof(*this) + description().size() + retained_size(_value);
+}
+
 //---------------------------------------------------------------------------------------------------
 
 UndoListRemoveAction::UndoListRemoveAction(const BaseListRef &list, const ValueRef &value)
@@ -279,6 +443,10 @@ UndoListRemoveAction::UndoListRemoveAction(const BaseListRef &list, size_t index
   : _list(list), _value(list.get(index)), _index(index) {
 }
 
+UndoListRemoveAction::UndoListRemoveAction(const BaseListRef &list, size_t index, const ValueRef &value)
+  : _list(list), _value(value), _index(index) {
+}
+
 void UndoListRemoveAction::undo(UndoManager *owner) {
   grt::GRT::get()->start_tracking_changes();
   _list.ginsert(_value, _index);
@@ -301,6 +469,10 @@ void UndoListRemoveAction::dump(std::ostream &out, int indent) const {
   out << ": " << description() << std::endl;
 }
 
+size_t UndoListRemoveAction::memory_size() const {
+  return sizeof(*this) + description().size() + retained_size(_value);
+}
+
 //---------------------------------------------------------------------------------------------------
 
 UndoDictSetAction::UndoDictSetAction(const DictRef &dict, const std::string &key) : _dict(dict), _key(key) {
@@ -311,6 +483,11 @@ UndoDictSetAction::UndoDictSetAction(const DictRef &dict, const std::string &key
     _had_value = false;
 }
 
+UndoDictSetAction::UndoDictSetAction(const DictRef &dict, const std::string &key, const ValueRef &value,
+                                     bool had_value)
+  : _dict(dict), _key(key), _value(value), _had_value(had_value) {
+}
+
 void UndoDictSetAction::undo(UndoManager *owner) {
   if (_had_value) {
     grt::GRT::get()->start_tracking_changes();
@@ -339,6 +516,10 @@ void UndoDictSetAction::dump(std::ostream &out, int indent) const {
   out << ": " << description() << std::endl;
 }
 
+size_t UndoDictSetAction::memory_size() const {
+  return sizeof(*this) + description().size() + _key.size() + retained_size(_value);
+}
+
 //---------------------------------------------------------------------------------------------------
 
 UndoDictRemoveAction::UndoDictRemoveAction(const DictRef &dict, const std::string &key) : _dict(dict), _key(key) {
@@ -349,6 +530,11 @@ UndoDictRemoveAction::UndoDictRemoveAction(const DictRef &dict, const std::strin
     _had_value = false;
 }
 
+UndoDictRemoveAction::UndoDictRemoveAction(const DictRef &dict, const std::string &key, const ValueRef &value,
+                                           bool had_value)
+  : _dict(dict), _key(key), _value(value), _had_value(had_value) {
+}
+
 void UndoDictRemoveAction::undo(UndoManager *owner) {
   if (_had_value) {
     grt::GRT::get()->start_tracking_changes();
@@ -376,6 +562,10 @@ void UndoDictRemoveAction::dump(std::ostream &out, int indent) const {
   out << ": " << description() << std::endl;
 }
 
+size_t UndoDictRemoveAction::memory_size() const {
+  return sizeof(*this) + description().size() + _key.size() + retained_size(_value);
+}
+
 //---------------------------------------------------------------------------------------------------
 
 UndoGroup::UndoGroup() {
@@ -494,6 +684,490 @@ void UndoGroup::dump(std::ostream &out, int indent) const {
   out << strfmt("%*s }", indent, "") << ": " << description() << std::endl;
 }
 
+size_t UndoGroup::memory_size() const {
+  size_t size = sizeof(*this) + UndoAction::description().size();
+  for (std::list<UndoAction *>::const_iterator iter = _actions.begin(); iter != _actions.end(); ++iter)
+    size += action_entry_size + (*iter)->memory_size();
+  return size;
+}
+
+//---------------------------------------------------------------------------------------------------
+
+namespace {
+
+  enum SpillRecordKind {
+    SpilledGroup = 1,
+    SpilledObjectChange,
+    SpilledListInsert,
+    SpilledListSet,
+    SpilledListReorder,
+    SpilledListRemove,
+    SpilledDictSet,
+    SpilledDictRemove
+  };
+
+  enum SpillValueTag { SpilledNull = 0, SpilledInteger, SpilledDouble, SpilledString, SpilledAnchor };
+
+  void put_number(std::string &out, uint64_t value) {
+    while (value >= 0x80) {
+      out.push_back((char)((value & 0x7f) | 0x80));
+      value >>= 7;
+    }
+    out.push_back((char)value);
+  }
+
+  void put_string(std::string &out, const std::string &value) {
+    put_number(out, value.size());
+    out.append(value);
+  }
+
+  struct SpillReader {
+    const char *pos;
+    const char *end;
+
+    void need(size_t count) {
+      if ((size_t)(end - pos) < count)
+        throw std::runtime_error("Undo spill record is truncated");
+    }
+
+    uint8_t byte() {
+      need(1);
+      return (uint8_t)*pos++;
+    }
+
+    uint64_t number() {
+      uint64_t value = 0;
+      for (int shift = 0; shift < 64; shift += 7) {
+        uint8_t next = byte();
+        value |= (uint64_t)(next & 0x7f) << shift;
+        if ((next & 0x80) == 0)
+          return value;
+      }
+      throw std::runtime_error("Invalid number in undo spill record");
+    }
+
+    std::string string() {
+      size_t length = (size_t)number();
+      need(length);
+      std::string value(pos, length);
+      pos += length;
+      return value;
+    }
+  };
+
+} // namespace
+
+namespace grt {
+
+  /**
+   * A temporary file that keeps undo groups which were moved out of memory, in a compact binary form. Model values
+   * cannot be written out: the changed objects, lists and dicts and all old values other than numbers and strings
+   * stay in memory as anchors of the spilled group and are referred to by their index in the record.
+   */
+  class UndoSpillLog {
+  public:
+    UndoSpillLog() : _failed(false), _end(0), _live(0) {
+    }
+
+    ~UndoSpillLog() {
+      std::string path = _file.getPath();
+      _file.dispose();
+      if (!path.empty())
+        base::tryRemove(path);
+    }
+
+    // Only plain groups (no subclasses with own behavior) of the stock actions can be written out.
+    static bool can_spill(UndoAction *action) {
+      const std::type_info &type = typeid(*action);
+      if (type == typeid(UndoGroup)) {
+        UndoGroup *group = static_cast<UndoGroup *>(action);
+        if (group->is_open())
+          return false;
+        for (UndoAction *child : group->get_actions()) {
+          if (!can_spill(child))
+            return false;
+        }
+        return true;
+      }
+
+      return type == typeid(UndoObjectChangeAction) || type == typeid(UndoListInsertAction) ||
+             type == typeid(UndoListSetAction) || type == typeid(UndoListReorderAction) ||
+             type == typeid(UndoListRemoveAction) || type == typeid(UndoDictSetAction) ||
+             type == typeid(UndoDictRemoveAction);
+    }
+
+    UndoGroup *spill(UndoGroup *group);
+    void load(size_t offset, size_t length, const std::vector<ValueRef> &anchors, std::list<UndoAction *> &actions);
+
+    // Called when a spilled group is gone. Once none is left the file is written from the start again.
+    void release(size_t length) {
+      _live -= std::min(_live, length);
+      if (_live == 0)
+        _end = 0;
+    }
+
+  private:
+    base::FileHandle _file;
+    bool _failed;
+    size_t _end;
+    size_t _live;
+
+    struct Anchors {
+      std::vector<ValueRef> values;
+      std::map<internal::Value *, size_t> indexes;
+    };
+
+    bool open();
+
+    void write_anchor(std::string &out, const ValueRef &value, Anchors &anchors);
+    void write_value(std::string &out, const ValueRef &value, Anchors &anchors);
+    void write_action(std::string &out, UndoAction *action, Anchors &anchors);
+
+    ValueRef read_anchor(SpillReader &in, const std::vector<ValueRef> &anchors);
+    ValueRef read_value(SpillReader &in, const std::vector<ValueRef> &anchors);
+    UndoAction *read_action(SpillReader &in, const std::vector<ValueRef> &anchors);
+  };
+
+  /**
+   * Stands in for an undo group that was written to the spill log. Only the anchors of the group are kept, its
+   * actions are read back when it gets undone.
+   */
+  class SpilledUndoGroup : public UndoGroup {
+  public:
+    SpilledUndoGroup(UndoSpillLog *log, const std::string &description, const std::vector<ValueRef> &anchors,
+                     size_t offset, size_t length)
+      : _log(log), _anchors(anchors), _offset(offset), _length(length) {
+      close();
+      set_description(description);
+    }
+
+    virtual ~SpilledUndoGroup() {
+      _log->release(_length);
+    }
+
+    // Reads the actions back from the spill log, if not done yet. Returns false if the record could not be read.
+    bool load() {
+      if (!get_actions().empty())
+        return true;
+      try {
+        _log->load(_offset, _length, _anchors, get_actions());
+      } catch (std::exception &) {
+        return false; // Already logged.
+      }
+      return true;
+    }
+
+    virtual void undo(UndoManager *owner) {
+      if (!load())
+        throw std::runtime_error("Could not read undo group from undo spill file");
+      UndoGroup::undo(owner);
+    }
+
+    virtual void dump(std::ostream &out, int indent = 0) const {
+      if (const_cast<SpilledUndoGroup *>(this)->get_actions().empty())
+        out << strfmt("%*s spilled_group (%i bytes on disk)", indent, "", (int)_length) << ": " << description()
+            << std::endl;
+      else
+        UndoGroup::dump(out, indent);
+    }
+
+    virtual size_t memory_size() const {
+      RetainedSize size;
+      for (const ValueRef &anchor : _anchors)
+        size.add(anchor);
+      return size.size();
+    }
+
+  private:
+    UndoSpillLog *_log;
+    std::vector<ValueRef> _anchors;
+    size_t _offset;
+    size_t _length;
+  };
+
+} // namespace grt
+
+bool UndoSpillLog::open() {
+  if (_file.file() != nullptr)
+    return true;
+  if (_failed)
+    return false;
+
+  try {
+    std::string path = makeTmpFile(makePath(g_get_tmp_dir(), "wb_undo_")).getPath();
+    _file = FileHandle(path, "w+b"); // makeTmpFile() opens the file in text mode.
+  } catch (std::exception &exc) {
+    logWarning("Could not create undo spill file, undo history will be kept in memory: %s\n", exc.what());
+    _failed = true;
+    return false;
+  }
+  return true;
+}
+
+UndoGroup *UndoSpillLog::spill(UndoGroup *group) {
+  if (!open())
+    return nullptr;
+
+  std::string record;
+  Anchors anchors;
+  put_number(record, group->get_actions().size());
+  for (UndoAction *action : group->get_actions())
+    write_action(record, action, anchors);
+
+  FILE *file = _file.file();
+  if (fseek(file, (long)_end, SEEK_SET) != 0 || fwrite(record.data(), 1, record.size(), file) != record.size()) {
+    logWarning("Could not write to undo spill file, undo history will be kept in memory\n");
+    _failed = true;
+    _file.dispose();
+    return nullptr;
+  }
+
+  size_t offset = _end;
+  _end += record.size();
+  _live += record.size();
+  return new SpilledUndoGroup(this, group->description(), anchors.values, offset, record.size());
+}
+
+void UndoSpillLog::load(size_t offset, size_t length, const std::vector<ValueRef> &anchors,
+                        std::list<UndoAction *> &actions) {
+  std::string record(length, '\0');
+  FILE *file = _file.file();
+  if (file == nullptr || fseek(file, (long)offset, SEEK_SET) != 0 || fread(&record[0], 1, length, file) != length) {
+    logError("Could not read undo group from undo spill file\n");
+    throw std::runtime_error("Could not read undo group from undo spill file");
+  }
+
+  SpillReader in = { record.data(), record.data() + record.size() };
+  try {
+    for (size_t count = (size_t)in.number(); count > 0; --count)
+      actions.push_back(read_action(in, anchors));
+  } catch (std::exception &exc) {
+    logError("Invalid undo group in undo spill file: %s\n", exc.what());
+    for (UndoAction *action : actions)
+      delete action;
+    actions.clear();
+    throw;
+  }
+}
+
+void UndoSpillLog::write_anchor(std::string &out, const ValueRef &value, Anchors &anchors) {
+  std::map<internal::Value *, size_t>::iterator iter = anchors.indexes.find(value.valueptr());
+  if (iter == anchors.indexes.end()) {
+    iter = anchors.indexes.insert(std::make_pair(value.valueptr(), anchors.values.size())).first;
+    anchors.values.push_back(value);
+  }
+  put_number(out, iter->second);
+}
+
+void UndoSpillLog::write_value(std::string &out, const ValueRef &value, Anchors &anchors) {
+  switch (value.type()) {
+    case UnknownType:
+      out.push_back((char)SpilledNull);
+      break;
+
+    case IntegerType: {
+      int64_t number = *IntegerRef::cast_from(value);
+      out.push_back((char)SpilledInteger);
+      put_number(out, ((uint64_t)number << 1) ^ (uint64_t)(number >> 63));
+      break;
+    }
+
+    case DoubleType: {
+      double number = *DoubleRef::cast_from(value);
+      char bytes[sizeof(number)];
+      memcpy(bytes, &number, sizeof(number));
+      out.push_back((char)SpilledDouble);
+      out.append(bytes, sizeof(bytes));
+      break;
+    }
+
+    case StringType:
+      out.push_back((char)SpilledString);
+      put_string(out, *StringRef::cast_from(value));
+      break;
+
+    default:
+      out.push_back((char)SpilledAnchor);
+      write_anchor(out, value, anchors);
+      break;
+  }
+}
+
+void UndoSpillLog::write_action(std::string &out, UndoAction *action, Anchors &anchors) {
+  const std::type_info &type = typeid(*action);
+
+  if (type == typeid(UndoGroup)) {
+    UndoGroup *group = static_cast<UndoGroup *>(action);
+    out.push_back((char)SpilledGroup);
+    put_string(out, group->description());
+    put_number(out, group->get_actions().size());
+    for (UndoAction *child : group->get_actions())
+      write_action(out, child, anchors);
+  } else if (type == typeid(UndoObjectChangeAction)) {
+    UndoObjectChangeAction *change = static_cast<UndoObjectChangeAction *>(action);
+    out.push_back((char)SpilledObjectChange);
+    put_string(out, change->description());
+    write_anchor(out, change->_object, anchors);
+    put_string(out, change->_member);
+    write_value(out, change->_value, anchors);
+  } else if (type == typeid(UndoListInsertAction)) {
+    UndoListInsertAction *insert = static_cast<UndoListInsertAction *>(action);
+    out.push_back((char)SpilledListInsert);
+    put_string(out, insert->description());
+    write_anchor(out, insert->_list, anchors);
+    put_number(out, insert->_index);
+  } else if (type == typeid(UndoListSetAction)) {
+    UndoListSetAction *set = static_cast<UndoListSetAction *>(action);
+    out.push_back((char)SpilledListSet);
+    put_string(out, set->description());
+    write_anchor(out, set->_list, anchors);
+    put_number(out, set->_index);
+    write_value(out, set->_value, anchors);
+  } else if (type == typeid(UndoListReorderAction)) {
+    UndoListReorderAction *reorder = static_cast<UndoListReorderAction *>(action);
+    out.push_back((char)SpilledListReorder);
+    put_string(out, reorder->description());
+    write_anchor(out, reorder->_list, anchors);
+    put_number(out, reorder->_oindex);
+    put_number(out, reorder->_nindex);
+  } else if (type == typeid(UndoListRemoveAction)) {
+    UndoListRemoveAction *remove = static_cast<UndoListRemoveAction *>(action);
+    out.push_back((char)SpilledListRemove);
+    put_string(out, remove->description());
+    write_anchor(out, remove->_list, anchors);
+    put_number(out, remove->_index);
+    write_value(out, remove->_value, anchors);
+  } else if (type == typeid(UndoDictSetAction)) {
+    UndoDictSetAction *set = static_cast<UndoDictSetAction *>(action);
+    out.push_back((char)SpilledDictSet);
+    put_string(out, set->description());
+    write_anchor(out, set->_dict, anchors);
+    put_string(out, set->_key);
+    write_value(out, set->_value, anchors);
+    out.push_back(set->_had_value ? 1 : 0);
+  } else if (type == typeid(UndoDictRemoveAction)) {
+    UndoDictRemoveAction *remove = static_cast<UndoDictRemoveAction *>(action);
+    out.push_back((char)SpilledDictRemove);
+    put_string(out, remove->description());
+    write_anchor(out, remove->_dict, anchors);
+    put_string(out, remove->_key);
+    write_value(out, remove->_value, anchors);
+    out.push_back(remove->_had_value ? 1 : 0);
+  } else
+    throw std::logic_error(std::string("undo action cannot be spilled: ") + type.name());
+}
+
+ValueRef UndoSpillLog::read_anchor(SpillReader &in, const std::vector<ValueRef> &anchors) {
+  size_t index = (size_t)in.number();
+  if (index >= anchors.size())
+    throw std::runtime_error("Invalid anchor index in undo spill record");
+  return anchors[index];
+}
+
+ValueRef UndoSpillLog::read_value(SpillReader &in, const std::vector<ValueRef> &anchors) {
+  switch (in.byte()) {
+    case SpilledNull:
+      return ValueRef();
+
+    case SpilledInteger: {
+      uint64_t number = in.number();
+      return IntegerRef((ssize_t)((int64_t)(number >> 1) ^ -(int64_t)(number & 1)));
+    }
+
+    case SpilledDouble: {
+      double number;
+      in.need(sizeof(number));
+      memcpy(&number, in.pos, sizeof(number));
+      in.pos += sizeof(number);
+      return DoubleRef(number);
+    }
+
+    case SpilledString:
+      return StringRef(in.string());
+
+    case SpilledAnchor:
+      return read_anchor(in, anchors);
+
+    default:
+      throw std::runtime_error("Invalid value in undo spill record");
+  }
+}
+
+UndoAction *UndoSpillLog::read_action(SpillReader &in, const std::vector<ValueRef> &anchors) {
+  uint8_t kind = in.byte();
+  std::string description = in.string();
+  UndoAction *action = nullptr;
+
+  switch (kind) {
+    case SpilledGroup: {
+      UndoGroup *group = new UndoGroup();
+      try {
+        for (size_t count = (size_t)in.number(); count > 0; --count)
+          group->get_actions().push_back(read_action(in, anchors));
+      } catch (...) {
+        delete group;
+        throw;
+      }
+      group->close();
+      action = group;
+      break;
+    }
+
+    case SpilledObjectChange: {
+      ObjectRef object(ObjectRef::cast_from(read_anchor(in, anchors)));
+      std::string member = in.string();
+      action = new UndoObjectChangeAction(object, member, read_value(in, anchors));
+      break;
+    }
+
+    case SpilledListInsert: {
+      BaseListRef list(BaseListRef::cast_from(read_anchor(in, anchors)));
+      action = new UndoListInsertAction(list, (size_t)in.number());
+      break;
+    }
+
+    case SpilledListSet: {
+      BaseListRef list(BaseListRef::cast_from(read_anchor(in, anchors)));
+      size_t index = (size_t)in.number();
+      action = new UndoListSetAction(list, index, read_value(in, anchors));
+      break;
+    }
+
+    case SpilledListReorder: {
+      BaseListRef list(BaseListRef::cast_from(read_anchor(in, anchors)));
+      size_t oindex = (size_t)in.number();
+      action = new UndoListReorderAction(list, oindex, (size_t)in.number());
+      break;
+    }
+
+    case SpilledListRemove: {
+      BaseListRef list(BaseListRef::cast_from(read_anchor(in, anchors)));
+      size_t index = (size_t)in.number();
+      action = new UndoListRemoveAction(list, index, read_value(in, anchors));
+      break;
+    }
+
+    case SpilledDictSet:
+    case SpilledDictRemove: {
+      DictRef dict(DictRef::cast_from(read_anchor(in, anchors)));
+      std::string key = in.string();
+      ValueRef value(read_value(in, anchors));
+      bool had_value = in.byte() != 0;
+      if (kind == SpilledDictSet)
+        action = new UndoDictSetAction(dict, key, value, had_value);
+      else
+        action = new UndoDictRemoveAction(dict, key, value, had_value);
+      break;
+    }
+
+    default:
+      throw std::runtime_error("Invalid action in undo spill record");
+  }
+
+  action->set_description(description);
+  return action;
+}
+
 //---------------------------------------------------------------------------------------------------
 
 UndoManager::UndoManager() {
@@ -501,12 +1175,16 @@ UndoManager::UndoManager() {
   _is_undoing = false;
   _is_redoing = false;
   _undo_limit = 0;
+  _memory_limit = 0;
+  _memory_usage = 0;
+  _spill_log = nullptr;
   _blocks = 0;
 }
 
 UndoManager::~UndoManager() {
   _changed_signal.disconnect_all_slots(); // prevent emission in reset()
   reset();
+  delete _spill_log;
 }
 
 void UndoManager::enable_logging_to(std::ostream *stream) {
@@ -550,9 +1228,176 @@ void UndoManager::set_undo_limit(size_t limit) {
 
 void UndoManager::trim_undo_stack() {
   lock();
-  if (_undo_limit > 0)
-    _undo_stack.erase(_undo_stack.begin(), _undo_stack.begin() + std::max(0, (int)(_undo_stack.size() - _undo_limit)));
+  if (_undo_limit > 0) {
+    while (_undo_stack.size() > _undo_limit) {
+      UndoAction *action = _undo_stack.front();
+      _undo_stack.pop_front();
+      forget_undo_entry(action);
+      delete action;
+    }
+  }
+  unlock();
+}
+
+void UndoManager::set_undo_memory_limit(size_t bytes) {
+  _memory_limit = bytes;
+
+  if (enforce_memory_limit())
+    _changed_signal();
+}
+
+size_t UndoManager::get_undo_memory_usage() {
+  lock();
+  update_memory_usage();
+  size_t usage = _memory_usage;
+  unlock();
+  return usage;
+}
+
+size_t UndoManager::get_spilled_undo_count() const {
+  size_t count = 0;
+  lock();
+  for (std::deque<UndoAction *>::const_iterator iter = _undo_stack.begin(); iter != _undo_stack.end(); ++iter) {
+    if (dynamic_cast<SpilledUndoGroup *>(*iter))
+      count++;
+  }
+  unlock();
+  return count;
+}
+
+/** Sizes the closed top level undo entries that were not accounted for yet.
+ */
+void UndoManager::update_memory_usage() {
+  for (std::deque<UndoAction *>::iterator iter = _undo_stack.begin(); iter != _undo_stack.end(); ++iter) {
+    UndoGroup *group = dynamic_cast<UndoGroup *>(*iter);
+    if ((group && group->is_open()) || _memory_sizes.find(*iter) != _memory_sizes.end())
+      continue;
+
+    size_t size = (*iter)->memory_size();
+    _memory_sizes[*iter] = size;
+    _memory_usage += size;
+  }
+}
+
+/** Must be called for every entry that leaves the undo stack.
+ */
+void UndoManager::forget_undo_entry(UndoAction *action) {
+  std::map<UndoAction *, size_t>::iterator iter = _memory_sizes.find(action);
+  if (iter != _memory_sizes.end()) {
+    _memory_usage -= iter->second;
+    _memory_sizes.erase(iter);
+  }
+}
+
+/** Returns the object all changes of the action are made to, if it consists of nothing else than member changes of
+ *  a single object. The changed members are collected in members.
+ */
+static internal::Value *changed_object(UndoAction *action, std::set<std::string> &members) {
+  if (typeid(*action) == typeid(UndoObjectChangeAction)) {
+    UndoObjectChangeAction *change = static_cast<UndoObjectChangeAction *>(action);
+    members.insert(change->get_member());
+    return change->get_object().valueptr();
+  }
+
+  UndoGroup *group = dynamic_cast<UndoGroup *>(action);
+  if (!group || group->is_open() || group->empty())
+    return nullptr;
+
+  internal::Value *object = nullptr;
+  for (std::list<UndoAction *>::iterator iter = group->get_actions().begin(); iter != group->get_actions().end();
+       ++iter) {
+    internal::Value *changed = changed_object(*iter, members);
+    if (!changed || (object && changed != object))
+      return nullptr;
+    object = changed;
+  }
+  return object;
+}
+
+/** Merges consecutive entries (among the first end ones) that only change members of the same object. If the newer
+ *  entry changes no member the older one doesn't, undoing the older one alone gets all of them back to the state
+ *  before both, so the newer entry is dropped.
+ */
+void UndoManager::coalesce_undo_entries(size_t end) {
+  size_t i = 0;
+  while (i + 1 < end) {
+    std::set<std::string> older_members, newer_members;
+    internal::Value *older = changed_object(_undo_stack[i], older_members);
+    internal::Value *newer = older ? changed_object(_undo_stack[i + 1], newer_members) : nullptr;
+
+    if (newer == older && older != nullptr &&
+        std::includes(older_members.begin(), older_members.end(), newer_members.begin(), newer_members.end())) {
+      UndoAction *action = _undo_stack[i + 1];
+      _undo_stack.erase(_undo_stack.begin() + i + 1);
+      forget_undo_entry(action);
+      delete action;
+      end--;
+    } else
+      i++;
+  }
+}
+
+/** Moves entries (among the first end ones, oldest first) to the spill log until the memory limit is met.
+ */
+void UndoManager::spill_undo_entries(size_t end) {
+  if (!_spill_log)
+    _spill_log = new UndoSpillLog();
+
+  for (size_t i = 0; i < end && _memory_usage > _memory_limit; i++) {
+    UndoGroup *group = dynamic_cast<UndoGroup *>(_undo_stack[i]);
+    if (!group || !UndoSpillLog::can_spill(group))
+      continue;
+
+    UndoGroup *spilled = _spill_log->spill(group);
+    if (!spilled)
+      break;
+
+    _undo_stack[i] = spilled;
+    forget_undo_entry(group);
+    delete group;
+
+    size_t size = spilled->memory_size();
+    _memory_sizes[spilled] = size;
+    _memory_usage += size;
+  }
+}
+
+/** Keeps the undo stack within the memory limit, if one is set. All entries except the latest one are first merged
+ *  where possible, then moved to the spill log and if that still isn't enough, the oldest ones are dropped.
+ *  Nothing is done while the latest entry is still open.
+ *
+ *  @return true if the undo stack was changed
+ */
+bool UndoManager::enforce_memory_limit() {
+  if (_memory_limit == 0)
+    return false;
+
+  lock();
+  UndoGroup *latest = _undo_stack.empty() ? nullptr : dynamic_cast<UndoGroup *>(_undo_stack.back());
+  if (latest && latest->is_open()) {
+    unlock();
+    return false;
+  }
+
+  update_memory_usage();
+  if (_memory_usage <= _memory_limit) {
+    unlock();
+    return false;
+  }
+
+  coalesce_undo_entries(_undo_stack.size() - 1);
+  if (_memory_usage > _memory_limit)
+    spill_undo_entries(_undo_stack.size() - 1);
+
+  while (_memory_usage > _memory_limit && _undo_stack.size() > 1) {
+    UndoAction *action = _undo_stack.front();
+    _undo_stack.pop_front();
+    forget_undo_entry(action);
+    delete action;
+  }
   unlock();
+
+  return true;
 }
 
 bool UndoManager::can_undo() const {
@@ -634,6 +1479,9 @@ void UndoManager::reset() {
     delete *iter;
   _redo_stack.clear();
 
+  _memory_sizes.clear();
+  _memory_usage = 0;
+
   unlock();
   _changed_signal();
 }
@@ -688,6 +1536,7 @@ bool UndoManager::end_undo_group(const std::string &description, bool trim) {
 
   if (group->empty()) {
     stack->pop_back();
+    forget_undo_entry(group);
     delete group;
     if (getenv("DEBUG_UNDO"))
       g_message("undo group '%s' was empty, so it was deleted", description.c_str());
@@ -701,6 +1550,9 @@ bool UndoManager::end_undo_group(const std::string &description, bool trim) {
     if (!group->is_open() && _undo_log && _undo_log->good())
       group->dump(*_undo_log);
 
+    if (!_is_undoing && !group->is_open())
+      enforce_memory_limit();
+
     if (description != "cancelled")
       _changed_signal();
     /* have to 1st merge or check for signal_apply from the deleted groups
@@ -760,6 +1612,7 @@ void UndoManager::cancel_undo_group() {
       // if this was the top-level undo group, delete it from the stack
       if (subgroup == group) {
         stack->pop_back();
+        forget_undo_entry(group);
         delete group;
       } else {
         g_assert(parent->get_actions().back() == subgroup);
@@ -810,6 +1663,23 @@ void UndoManager::undo() {
   lock();
   if (can_undo()) {
     UndoAction *cmd = _undo_stack.back();
+
+    // A spilled entry is read back before anything is undone. If that fails it can't be undone, and neither can
+    // the older entries, which depend on its changes. So the undo history is dropped.
+    SpilledUndoGroup *spilled = dynamic_cast<SpilledUndoGroup *>(cmd);
+    if (spilled && !spilled->load()) {
+      logError("Could not read back the latest undo entry, the undo history was dropped\n");
+      while (!_undo_stack.empty()) {
+        UndoAction *action = _undo_stack.back();
+        _undo_stack.pop_back();
+        forget_undo_entry(action);
+        delete action;
+      }
+      unlock();
+      _changed_signal();
+      return;
+    }
+
     _is_undoing = true;
     unlock();
 
@@ -817,12 +1687,20 @@ void UndoManager::undo() {
       std::cout << "UNDOING: ";
       cmd->dump(std::cout, 0);
     }
-    cmd->undo(this);
+    try {
+      cmd->undo(this);
+    } catch (...) {
+      lock();
+      _is_undoing = false;
+      unlock();
+      throw;
+    }
 
     lock();
     _is_undoing = false;
 
     _undo_stack.pop_back();
+    forget_undo_entry(cmd);
     unlock();
 
     _undo_signal(cmd);
@@ -842,7 +1720,14 @@ void UndoManager::redo() {
     _is_redoing = true;
     unlock();
 
-    cmd->undo(this);
+    try {
+      cmd->undo(this);
+    } catch (...) {
+      lock();
+      _is_redoing = false;
+      unlock();
+      throw;
+    }
 
     lock();
     _is_redoing = false;
@@ -863,6 +1748,7 @@ void UndoManager::add_undo(UndoAction *cmd) {
     return;
   }
 
+  bool compacted = false;
   lock();
   if (_is_undoing) {
     bool flag = false;
@@ -889,6 +1775,7 @@ void UndoManager::add_undo(UndoAction *cmd) {
         logDebug2("added undo action that's not a group to top");
       _undo_stack.push_back(cmd);
       trim_undo_stack();
+      compacted = enforce_memory_limit();
     }
 
     // if we're not undoing neither redoing, then reset the redo stack
@@ -901,7 +1788,7 @@ void UndoManager::add_undo(UndoAction *cmd) {
   unlock();
 
   UndoGroup *ugrp = dynamic_cast<UndoGroup *>(cmd);
-  if (ugrp && !ugrp->is_open())
+  if (compacted || (ugrp && !ugrp->is_open()))
     _changed_signal();
 }
 
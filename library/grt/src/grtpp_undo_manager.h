@@ -26,12 +26,14 @@
 #include "grt.h"
 
 #include <deque>
+#include <map>
 #include <boost/signals2.hpp>
 #include <ostream>
 
 namespace grt {
 
   class UndoManager;
+  class UndoSpillLog;
 
   class MYSQLGRT_PUBLIC UndoAction {
     std::string _description;
@@ -47,6 +49,9 @@ namespace grt {
     }
 
     virtual void dump(std::ostream &out, int indent = 0) const = 0;
+
+    // Estimated number of bytes kept alive by this action (including old values nothing else refers to).
+    virtual size_t memory_size() const;
   };
 
   class MYSQLGRT_PUBLIC SimpleUndoAction : public UndoAction {
@@ -62,9 +67,13 @@ namespace grt {
     virtual void undo(UndoManager *owner) {
       _undo_slot();
     }
+
+    virtual size_t memory_size() const;
   };
 
   class MYSQLGRT_PUBLIC UndoObjectChangeAction : public UndoAction {
+    friend class UndoSpillLog;
+
   protected:
     ObjectRef _object;
     std::string _member;
@@ -84,9 +93,12 @@ namespace grt {
     }
 
     virtual void dump(std::ostream &out, int indent = 0) const;
+    virtual size_t memory_size() const;
   };
 
   class MYSQLGRT_PUBLIC UndoListInsertAction : public UndoAction {
+    friend class UndoSpillLog;
+
     BaseListRef _list;
     size_t _index;
 
@@ -96,22 +108,29 @@ namespace grt {
     virtual void undo(UndoManager *owner);
 
     virtual void dump(std::ostream &out, int indent = 0) const;
+    virtual size_t memory_size() const;
   };
 
   class MYSQLGRT_PUBLIC UndoListSetAction : public UndoAction {
+    friend class UndoSpillLog;
+
     BaseListRef _list;
     size_t _index;
     ValueRef _value;
 
   public:
     UndoListSetAction(const BaseListRef &list, size_t index);
+    UndoListSetAction(const BaseListRef &list, size_t index, const ValueRef &value);
 
     virtual void undo(UndoManager *owner);
 
     virtual void dump(std::ostream &out, int indent = 0) const;
+    virtual size_t memory_size() const;
   };
 
   class MYSQLGRT_PUBLIC UndoListReorderAction : public UndoAction {
+    friend class UndoSpillLog;
+
     BaseListRef _list;
     size_t _oindex;
     size_t _nindex;
@@ -121,9 +140,12 @@ namespace grt {
 
     virtual void undo(UndoManager *owner);
     virtual void dump(std::ostream &out, int indent = 0) const;
+    virtual size_t memory_size() const;
   };
 
   class MYSQLGRT_PUBLIC UndoListRemoveAction : public UndoAction {
+    friend class UndoSpillLog;
+
     BaseListRef _list;
     ValueRef _value;
     size_t _index;
@@ -131,12 +153,16 @@ namespace grt {
   public:
     UndoListRemoveAction(const BaseListRef &list, const ValueRef &value);
     UndoListRemoveAction(const BaseListRef &list, size_t index);
+    UndoListRemoveAction(const BaseListRef &list, size_t index, const ValueRef &value);
 
     virtual void undo(UndoManager *owner);
     virtual void dump(std::ostream &out, int indent = 0) const;
+    virtual size_t memory_size() const;
   };
 
   class MYSQLGRT_PUBLIC UndoDictSetAction : public UndoAction {
+    friend class UndoSpillLog;
+
     DictRef _dict;
     std::string _key;
     ValueRef _value;
@@ -144,12 +170,16 @@ namespace grt {
 
   public:
     UndoDictSetAction(const DictRef &dict, const std::string &key);
+    UndoDictSetAction(const DictRef &dict, const std::string &key, const ValueRef &value, bool had_value);
 
     virtual void undo(UndoManager *owner);
     virtual void dump(std::ostream &out, int indent = 0) const;
+    virtual size_t memory_size() const;
   };
 
   class MYSQLGRT_PUBLIC UndoDictRemoveAction : public UndoAction {
+    friend class UndoSpillLog;
+
     DictRef _dict;
     std::string _key;
     ValueRef _value;
@@ -157,9 +187,11 @@ namespace grt {
 
   public:
     UndoDictRemoveAction(const DictRef &dict, const std::string &key);
+    UndoDictRemoveAction(const DictRef &dict, const std::string &key, const ValueRef &value, bool had_value);
 
     virtual void undo(UndoManager *owner);
     virtual void dump(std::ostream &out, int indent = 0) const;
+    virtual size_t memory_size() const;
   };
 
   class MYSQLGRT_PUBLIC UndoGroup : public UndoAction {
@@ -182,6 +214,7 @@ namespace grt {
     virtual void undo(UndoManager *owner);
 
     virtual void dump(std::ostream &out, int indent = 0) const;
+    virtual size_t memory_size() const;
 
     void add(UndoAction *op);
     bool empty() const;
@@ -219,6 +252,16 @@ namespace grt {
       return _undo_limit;
     }
 
+    // Limits the (estimated) memory used by the undo history, 0 for no limit. See enforce_memory_limit().
+    // Entries moved to the spill file only leave their numbers and strings there. The changed objects, lists and
+    // dicts, removed objects and all other old values stay in memory until the entry is gone.
+    void set_undo_memory_limit(size_t bytes);
+    size_t get_undo_memory_limit() const {
+      return _memory_limit;
+    }
+    size_t get_undo_memory_usage();
+    size_t get_spilled_undo_count() const;
+
     void disable();
     void enable();
     bool is_enabled() const {
@@ -286,6 +329,11 @@ namespace grt {
 
     size_t _undo_limit;
 
+    size_t _memory_limit;
+    size_t _memory_usage;
+    std::map<UndoAction *, size_t> _memory_sizes; // Closed top level undo stack entries already accounted for.
+    UndoSpillLog *_spill_log;
+
     int _blocks;
     bool _is_undoing;
     bool _is_redoing;
@@ -295,6 +343,12 @@ namespace grt {
     boost::signals2::signal<void()> _changed_signal;
 
     void trim_undo_stack();
+
+    bool enforce_memory_limit();
+    void update_memory_usage();
+    void forget_undo_entry(UndoAction *action);
+    void coalesce_undo_entries(size_t end);
+    void spill_undo_entries(size_t end);
   };
 
   struct MYSQLGRT_PUBLIC AutoUndo {
@@ -29,6 +29,7 @@
 #include "grtpp_undo_manager.h"
 
 #include <glib.h>
+#include <atomic>
 
 using namespace grt;
 using namespace grt::internal;
@@ -203,11 +204,19 @@ std::string List::toString() const {
   return s;
 }
 
-List::List(bool allow_null) : _allow_null(allow_null) {
+// Revisions are taken from one counter for all lists, so a list never gets a revision another list had before,
+// not even one freed before it was created at the same address.
+static size_t next_revision() {
+  static std::atomic<size_t> revision(0);
+  return ++revision;
+}
+
+List::List(bool allow_null) : _allow_null(allow_null), _revision(next_revision()) {
   _is_global = 0;
 }
 
-List::List(Type content_type, const std::string& content_class, bool allow_null) : _allow_null(allow_null) {
+List::List(Type content_type, const std::string& content_class, bool allow_null)
+  : _allow_null(allow_null), _revision(next_revision()) {
   _content_type.type = content_type;
   _content_type.object_class = content_class;
 
@@ -240,6 +249,7 @@ void List::set_unchecked(size_t index, const ValueRef& value) {
     }
 
     _content[index] = value;
+    _revision = next_revision();
   }
 }
 
@@ -260,6 +270,7 @@ void List::insert_unchecked(const ValueRef& value, size_t index) {
 
     _content.insert(_content.begin() + index, value);
   }
+  _revision = next_revision();
 }
 
 void List::remove(const ValueRef& value) {
@@ -273,6 +284,7 @@ void List::remove(const ValueRef& value) {
         grt::GRT::get()->get_undo_manager()->add_undo(new UndoListRemoveAction(this, i));
 
       _content.erase(_content.begin() + i);
+      _revision = next_revision();
     }
   }
 }
@@ -288,6 +300,7 @@ void List::remove(size_t index) {
     grt::GRT::get()->get_undo_manager()->add_undo(new UndoListRemoveAction(this, index));
 
   _content.erase(_content.begin() + index);
+  _revision = next_revision();
 }
 
 void List::reorder(size_t oi, size_t ni) {
@@ -303,6 +316,7 @@ void List::reorder(size_t oi, size_t ni) {
     _content.insert(_content.end(), tmp);
   else
     _content.insert(_content.begin() + ni, tmp);
+  _revision = next_revision();
 }
 
 size_t List::get_index(const ValueRef& value) {
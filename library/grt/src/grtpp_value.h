@@ -304,6 +304,12 @@ namespace internal {
 
       size_t get_index(const ValueRef &value);
 
+      // Changes with every modification of the content, so caches built from it can tell when they are outdated.
+      // No two lists ever have the same revision, so together with the list's address it identifies the content.
+      inline size_t revision() const {
+        return _revision;
+      }
+
       inline const ValueRef &operator[](size_t i) const {
         return get(i);
       }
@@ -350,6 +356,7 @@ namespace internal {
       storage_type _content;
       SimpleTypeSpec _content_type;
       bool _allow_null;
+      size_t _revision;
 
       mutable short _is_global;
     };
@@ -21,6 +21,11 @@
  * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
  */
 
+#include <algorithm>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+
 #include "python_context.h"
 #include "grtpp_util.h"
 #include "base/string_utilities.h"
@@ -30,6 +35,138 @@
 using namespace grt;
 using namespace base;
 
+/**
+ * The Python wrappers created for the objects, lists and dicts of a list, so that accessing an item again
+ * (e.g. when iterating over the list more than once) returns the same wrapper instead of creating a new one.
+ * Dropped whenever the list content changes.
+ */
+struct PyGRTListProxies {
+  size_t revision = 0;
+  std::unordered_map<grt::internal::Value *, PyObject *> wrappers;
+
+  ~PyGRTListProxies() {
+    clear();
+  }
+
+  void clear() {
+    for (auto &entry : wrappers)
+      Py_DECREF(entry.second);
+    wrappers.clear();
+  }
+};
+
+/**
+ * Hashed lookup for membership tests on large object and string lists, which would otherwise scan the list for each
+ * test. Only built on the second test against an unchanged list, a single test is no faster with it.
+ * The list isn't referenced, so the cache doesn't keep it alive. Its address is only compared, never followed,
+ * and together with the revision it identifies the list content (see internal::List::revision()).
+ */
+struct MembershipIndex {
+  const grt::internal::List *list;
+  size_t revision;
+  bool built;
+  std::unordered_set<grt::internal::Value *> objects;
+  std::unordered_set<std::string> strings;
+};
+
+static const size_t MinIndexedListSize = 64;
+static const size_t MaxMembershipIndexes = 8;
+
+// Indexes for the lists tested last, most recently used first.
+static std::list<MembershipIndex> membershipIndexes;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Looks up value in the membership index for list. Returns 1 or 0 if the index can tell whether the value
+ * is in the list, -1 if the linear search must be used.
+ */
+static int indexed_contains(const grt::BaseListRef &list, const grt::ValueRef &value) {
+  grt::Type type = list.content_type();
+  if ((type != ObjectType && type != StringType) || list.count() < MinIndexedListSize)
+    return -1;
+
+  // The list may contain None, which only the linear search can find.
+  if (!value.is_valid())
+    return -1;
+
+  // Values of other types never compare equal to the list's items.
+  if (value.type() != type)
+    return 0;
+
+  const grt::internal::List *content = &list.content();
+  auto iterator = membershipIndexes.begin();
+  while (iterator != membershipIndexes.end() && iterator->list != content)
+    ++iterator;
+
+  size_t revision = content->revision();
+  if (iterator == membershipIndexes.end()) {
+    if (membershipIndexes.size() >= MaxMembershipIndexes)
+      membershipIndexes.pop_back();
+    membershipIndexes.push_front({ content, revision, false, {}, {} });
+    return -1;
+  }
+  membershipIndexes.splice(membershipIndexes.begin(), membershipIndexes, iterator);
+
+  MembershipIndex &index = membershipIndexes.front();
+  if (index.revision != revision) {
+    index.revision = revision;
+    index.built = false;
+    index.objects.clear();
+    index.strings.clear();
+    return -1;
+  }
+
+  if (!index.built) {
+    for (size_t i = 0, count = list.count(); i < count; ++i) {
+      grt::internal::Value *item = list[i].valueptr();
+      if (item == nullptr)
+        continue;
+      if (type == ObjectType)
+        index.objects.insert(item);
+      else
+        index.strings.insert(**static_cast<grt::internal::String *>(item));
+    }
+    index.built = true;
+  }
+
+  if (type == ObjectType)
+    return index.objects.count(value.valueptr()) > 0 ? 1 : 0;
+  return index.strings.count(*grt::StringRef::cast_from(value)) > 0 ? 1 : 0;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Converts the item at index (which must be valid) to a new Python reference. Objects, lists and dicts get the same
+ * wrapper as on earlier accesses as long as the list is unchanged.
+ */
+static PyObject *list_proxy(PythonContext *ctx, PyGRTListObject *self, size_t index) {
+  grt::ValueRef value(self->list->get(index));
+  if (!value.is_valid() || (value.type() != ObjectType && value.type() != ListType && value.type() != DictType))
+    return ctx->from_grt(value);
+
+  size_t revision = self->list->content().revision();
+  if (self->proxies == NULL)
+    self->proxies = new PyGRTListProxies();
+  else if (self->proxies->revision != revision)
+    self->proxies->clear();
+  self->proxies->revision = revision;
+
+  auto iterator = self->proxies->wrappers.find(value.valueptr());
+  if (iterator != self->proxies->wrappers.end()) {
+    Py_INCREF(iterator->second);
+    return iterator->second;
+  }
+
+  PyObject *wrapper = ctx->from_grt(value);
+  if (wrapper) {
+    Py_INCREF(wrapper);
+    self->proxies->wrappers[value.valueptr()] = wrapper;
+  }
+  return wrapper;
+}
+
 static int list_init(PyGRTListObject *self, PyObject *args, PyObject *kwds) {
   PythonContext *ctx = PythonContext::get_and_check();
   if (ctx) {
@@ -41,6 +178,8 @@ static int list_init(PyGRTListObject *self, PyObject *args, PyObject *kwds) {
       return -1;
 
     delete self->list;
+    delete self->proxies;
+    self->proxies = NULL;
 
     if (valueptr) {
       try {
@@ -81,6 +220,7 @@ static int list_init(PyGRTListObject *self, PyObject *args, PyObject *kwds) {
 
 static void list_dealloc(PyGRTListObject *self) {
   delete self->list;
+  delete self->proxies;
 
   self->ob_type->tp_free(self);
 }
@@ -107,7 +247,7 @@ static PyObject *list_item(PyGRTListObject *self, Py_ssize_t index) {
   }
 
   try {
-    return ctx->from_grt(self->list->get(index));
+    return list_proxy(ctx, self, index);
   } catch (grt::bad_item &exc) {
     PyErr_SetString(PyExc_IndexError, exc.what());
     return NULL;
@@ -117,6 +257,38 @@ static PyObject *list_item(PyGRTListObject *self, Py_ssize_t index) {
   }
 }
 
+// Returns the items from low to high as a Python list, converted in one go.
+static PyObject *list_slice(PyGRTListObject *self, Py_ssize_t low, Py_ssize_t high) {
+  PythonContext *ctx;
+
+  if (!(ctx = PythonContext::get_and_check()))
+    return NULL;
+
+  Py_ssize_t count = (Py_ssize_t)self->list->count();
+  low = std::max((Py_ssize_t)0, std::min(low, count));
+  high = std::max(low, std::min(high, count));
+
+  PyObject *slice = PyList_New(high - low);
+  if (!slice)
+    return NULL;
+
+  try {
+    for (Py_ssize_t i = low; i < high; ++i) {
+      PyObject *item = list_proxy(ctx, self, i);
+      if (!item) {
+        Py_DECREF(slice);
+        return NULL;
+      }
+      PyList_SET_ITEM(slice, i - low, item);
+    }
+  } catch (std::exception &exc) {
+    Py_DECREF(slice);
+    PyErr_SetString(PyExc_RuntimeError, exc.what());
+    return NULL;
+  }
+  return slice;
+}
+
 static int list_assign(PyGRTListObject *self, Py_ssize_t index, PyObject *value) {
   PythonContext *ctx = PythonContext::get_and_check();
   if (!ctx)
@@ -148,13 +320,148 @@ static int list_contains(PyGRTListObject *self, PyObject *value) {
     return -1;
 
   try {
-    if (self->list->get_index(ctx->from_pyobject(value)) != BaseListRef::npos)
+    grt::ValueRef item(ctx->from_pyobject(value));
+    int found = indexed_contains(*self->list, item);
+    if (found >= 0)
+      return found;
+    if (self->list->get_index(item) != BaseListRef::npos)
       return 1;
   } catch (...) {
   }
   return 0;
 }
 
+//----------------------------------------------------------------------------------------------------------------------
+
+/** Iterates over a GRT list. The context is looked up once for the whole loop, not for each item.
+ */
+struct PyGRTListIterObject {
+  PyObject_HEAD
+
+    PyGRTListObject *owner;
+  PythonContext *ctx;
+  Py_ssize_t index;
+};
+
+static void listiter_dealloc(PyGRTListIterObject *self) {
+  Py_XDECREF(self->owner);
+  PyObject_Del(self);
+}
+
+static PyObject *listiter_next(PyGRTListIterObject *self) {
+  // Checked on each step, the list may change while iterating over it.
+  if (self->owner == NULL || self->index >= (Py_ssize_t)self->owner->list->count()) {
+    Py_CLEAR(self->owner);
+    return NULL; // StopIteration.
+  }
+
+  try {
+    return list_proxy(self->ctx, self->owner, self->index++);
+  } catch (std::exception &exc) {
+    PyErr_SetString(PyExc_RuntimeError, exc.what());
+    return NULL;
+  }
+}
+
+static PyTypeObject PyGRTListIterObjectType = {
+  PyObject_HEAD_INIT(&PyType_Type) // PyObject_VAR_HEAD
+  0,
+  "grt.ListIterator",             // char *tp_name; /* For printing, in format "<module>.<name>" */
+  sizeof(PyGRTListIterObject), 0, // int tp_basicsize, tp_itemsize; /* For allocation */
+
+  /* Methods to implement standard operations */
+
+  (destructor)listiter_dealloc, //  destructor tp_dealloc;
+  0,                            //  printfunc tp_print;
+  0,                            //  getattrfunc tp_getattr;
+  0,                            //  setattrfunc tp_setattr;
+  0,                            //  cmpfunc tp_compare;
+  0,                            //  reprfunc tp_repr;
+
+  /* Method suites for standard classes */
+
+  0, //  PyNumberMethods *tp_as_number;
+  0, //  PySequenceMethods *tp_as_sequence;
+  0, //  PyMappingMethods *tp_as_mapping;
+
+  /* More standard operations (here for binary compatibility) */
+
+  0,                       //  hashfunc tp_hash;
+  0,                       //  ternaryfunc tp_call;
+  0,                       //  reprfunc tp_str;
+  PyObject_GenericGetAttr, //  getattrofunc tp_getattro;
+  0,                       //  setattrofunc tp_setattro;
+
+  /* Functions to access object as input/output buffer */
+  0, //  PyBufferProcs *tp_as_buffer;
+
+  /* Flags to define presence of optional/expanded features */
+  Py_TPFLAGS_DEFAULT, //  long tp_flags;
+
+  0, //  char *tp_doc; /* Documentation string */
+
+  /* Assigned meaning in release 2.0 */
+  /* call function for all accessible objects */
+  0, //  traverseproc tp_traverse;
+
+  /* delete references to contained objects */
+  0, //  inquiry tp_clear;
+
+  /* Assigned meaning in release 2.1 */
+  /* rich comparisons */
+  0, //  richcmpfunc tp_richcompare;
+
+  /* weak reference enabler */
+  0, //  long tp_weaklistoffset;
+
+  /* Added in release 2.2 */
+  /* Iterators */
+  PyObject_SelfIter,           //  getiterfunc tp_iter;
+  (iternextfunc)listiter_next, //  iternextfunc tp_iternext;
+
+  /* Attribute descriptor and subclassing stuff */
+  0, //  struct PyMethodDef *tp_methods;
+  0, //  struct PyMemberDef *tp_members;
+  0, //  struct PyGetSetDef *tp_getset;
+  0, //  struct _typeobject *tp_base;
+  0, //  PyObject *tp_dict;
+  0, //  descrgetfunc tp_descr_get;
+  0, //  descrsetfunc tp_descr_set;
+  0, //  long tp_dictoffset;
+  0, //  initproc tp_init;
+  0, //  allocfunc tp_alloc;
+  0, //  newfunc tp_new;
+  0, //  freefunc tp_free; /* Low-level free-memory routine */
+  0, //  inquiry tp_is_gc; /* For PyObject_IS_GC */
+  0, //  PyObject *tp_bases;
+  0, //  PyObject *tp_mro; /* method resolution order */
+  0, //  PyObject *tp_cache;
+  0, //  PyObject *tp_subclasses;
+  0, //  PyObject *tp_weaklist;
+  0, // tp_del
+#if (PY_MAJOR_VERSION == 2) && (PY_MINOR_VERSION > 5)
+  0 // tp_version_tag
+#endif
+};
+
+static PyObject *list_iter(PyGRTListObject *self) {
+  PythonContext *ctx = PythonContext::get_and_check();
+  if (!ctx)
+    return NULL;
+
+  PyGRTListIterObject *iterator = PyObject_New(PyGRTListIterObject, &PyGRTListIterObjectType);
+  if (!iterator)
+    return NULL;
+
+  Py_INCREF(self);
+  iterator->owner = self;
+  iterator->ctx = ctx;
+  iterator->index = 0;
+  return (PyObject *)iterator;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 static PyObject *list_inplace_concat(PyGRTListObject *self, PyObject *other) {
   PythonContext *ctx = PythonContext::get_and_check();
   if (!ctx)
@@ -338,14 +645,14 @@ static PyGetSetDef PyGRTListGetSetters[] = {
 };
 
 static PySequenceMethods PyGRTListObject_as_sequence = {
-  (lenfunc)list_length,         // lenfunc sq_length;
-  0,                            // binaryfunc sq_concat;
-  0,                            // ssizeargfunc sq_repeat;
-  (ssizeargfunc)list_item,      // ssizeargfunc sq_item;
-  0,                            //(ssizessizeargfunc)list_slice, // ssizessizeargfunc sq_slice;
-  (ssizeobjargproc)list_assign, // ssizeobjargproc sq_ass_item;
-  0,                            ///(ssizessizeobjargproc)list_assign_slice,// ssizessizeobjargproc sq_ass_slice;
-  (objobjproc)list_contains,    // objobjproc sq_contains;
+  (lenfunc)list_length,          // lenfunc sq_length;
+  0,                             // binaryfunc sq_concat;
+  0,                             // ssizeargfunc sq_repeat;
+  (ssizeargfunc)list_item,       // ssizeargfunc sq_item;
+  (ssizessizeargfunc)list_slice, // ssizessizeargfunc sq_slice;
+  (ssizeobjargproc)list_assign,  // ssizeobjargproc sq_ass_item;
+  0,                             ///(ssizessizeobjargproc)list_assign_slice,// ssizessizeobjargproc sq_ass_slice;
+  (objobjproc)list_contains,     // objobjproc sq_contains;
   /* Added in release 2.0 */
   (binaryfunc)list_inplace_concat, // binaryfunc sq_inplace_concat;
   0                                // ssizeargfunc sq_inplace_repeat;
@@ -404,8 +711,8 @@ static PyTypeObject PyGRTListObjectType = {
 
   /* Added in release 2.2 */
   /* Iterators */
-  0, //  getiterfunc tp_iter;
-  0, //  iternextfunc tp_iternext;
+  (getiterfunc)list_iter, //  getiterfunc tp_iter;
+  0,                      //  iternextfunc tp_iternext;
 
   /* Attribute descriptor and subclassing stuff */
   PyGRTListMethods,    //  struct PyMethodDef *tp_methods;
@@ -437,6 +744,9 @@ void grt::PythonContext::init_grt_list_type() {
   if (PyType_Ready(&PyGRTListObjectType) < 0) {
     throw std::runtime_error("Could not initialize GRT List type in python");
   }
+  if (PyType_Ready(&PyGRTListIterObjectType) < 0) {
+    throw std::runtime_error("Could not initialize GRT List iterator type in python");
+  }
 
   Py_INCREF(&PyGRTListObjectType);
   PyModule_AddObject(get_grt_module(), "List", (PyObject *)&PyGRTListObjectType);
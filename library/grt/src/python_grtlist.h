@@ -28,10 +28,13 @@
 
 #include "grt.h"
 
+struct PyGRTListProxies;
+
 /** Wraps a GRT list object as a Python sequence object
  */
 struct PyGRTListObject {
   PyObject_HEAD
 
     grt::BaseListRef *list;
+  PyGRTListProxies *proxies; // Wrappers handed out for the objects, lists and dicts in the list, created on demand.
 };
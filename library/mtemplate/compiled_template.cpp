@@ -0,0 +1,275 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include "compiled_template.h"
+#include "template.h"
+#include "modifier.h"
+
+#include <base/file_functions.h>
+#include <base/file_utilities.h>
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+namespace mtemplate {
+
+  //-----------------------------------------------------------------------------------
+  //  DictionaryCursor stuff
+  //-----------------------------------------------------------------------------------
+  bool DictionaryCursor::getValue(std::size_t slot, std::string &value) {
+    if (_dictionary == nullptr)
+      return false;
+
+    value = _dictionary->getValue(_template.name(slot));
+    return true;
+  }
+
+  TemplateCursor *DictionaryCursor::getSection(std::size_t slot, std::size_t row) {
+    if (_dictionary == nullptr)
+      return nullptr;
+
+    auto &sections = _dictionary->getSectionDictionaries(_template.name(slot));
+    if (row >= sections.size())
+      return nullptr;
+
+    if (!_child)
+      _child.reset(new DictionaryCursor(_template, sections[row]));
+    else
+      _child->_dictionary = sections[row];
+    return _child.get();
+  }
+
+  bool DictionaryCursor::isLast() {
+    return _dictionary != nullptr && _dictionary->isLast();
+  }
+
+  //-----------------------------------------------------------------------------------
+  //  TemplateWriter stuff
+  //-----------------------------------------------------------------------------------
+  TemplateWriter::TemplateWriter(TemplateOutput *output, std::size_t flushSize)
+    : _output(output), _flushSize(flushSize) {
+    _buffer.reserve(output != nullptr ? flushSize + flushSize / 4 : 0);
+  }
+
+  TemplateWriter::~TemplateWriter() {
+    flush();
+  }
+
+  void TemplateWriter::flush() {
+    if (_output == nullptr || _buffer.empty())
+      return;
+
+    _output->out(_buffer);
+    _buffer.clear();
+  }
+
+  //-----------------------------------------------------------------------------------
+  //  CompiledTemplate stuff
+  //-----------------------------------------------------------------------------------
+  struct CompiledTemplate::State {
+    TemplateWriter &writer;
+    std::vector<TemplateCursor *> cursors; //  The current section's cursor is the last one.
+    std::string value;
+
+    State(TemplateWriter &output) : writer(output) {
+    }
+  };
+
+  CompiledTemplate::CompiledTemplate(const TemplateDocument &document) {
+    compile(document);
+  }
+
+  CompiledTemplate::CompiledTemplate(const Template &tpl) {
+    compile(tpl.document());
+  }
+
+  std::size_t CompiledTemplate::addName(const base::utf8string &name) {
+    std::size_t index = slot(name);
+    if (index != npos)
+      return index;
+
+    _names.push_back(name);
+    return _names.size() - 1;
+  }
+
+  std::size_t CompiledTemplate::slot(const base::utf8string &name) const {
+    for (std::size_t index = 0; index < _names.size(); ++index) {
+      if (_names[index] == name)
+        return index;
+    }
+    return npos;
+  }
+
+  void CompiledTemplate::compile(const TemplateDocument &document) {
+    bool afterText = false; //  Consecutive text goes into one instruction.
+    for (NodeStorageType node : document) {
+      if (node->isHidden())
+        continue;
+
+      bool isText = node->type() == TemplateObject_Text || node->type() == TemplateObject_NewLine;
+      if (isText && !afterText)
+        _instructions.push_back({Text, npos, npos, "", {}});
+      afterText = isText;
+
+      switch (node->type()) {
+        case TemplateObject_Text:
+        case TemplateObject_NewLine:
+          _instructions.back().text += node->text().to_string();
+          break;
+
+        case TemplateObject_Variable: {
+          NodeVariable *variable = static_cast<NodeVariable *>(node.get());
+          _instructions.push_back({Variable, addName(variable->text()), 0, "", {}});
+          for (ModifierAndArgument &modifier : variable->_modifiers) {
+            Modifier *mod = GetModifier(modifier._name);
+            if (mod != nullptr)
+              _instructions.back().modifiers.push_back({mod, modifier._arg});
+          }
+          break;
+        }
+
+        case TemplateObject_Section:
+        case TemplateObject_SectionSeparator: {
+          NodeSection *section = static_cast<NodeSection *>(node.get());
+          std::size_t index = _instructions.size();
+          _instructions.push_back({section->is_separator() ? Separator : Section, addName(section->text()), 0, "", {}});
+          compile(section->_contents);
+          _instructions[index].end = _instructions.size();
+          break;
+        }
+      }
+    }
+  }
+
+  void CompiledTemplate::run(std::size_t begin, std::size_t end, State &state) const {
+    TemplateCursor *cursor = state.cursors.back();
+
+    for (std::size_t index = begin; index < end;) {
+      const Instruction &instruction = _instructions[index];
+
+      switch (instruction.operation) {
+        case Text:
+          state.writer.write(instruction.text);
+          ++index;
+          break;
+
+        case Variable: {
+          bool found = false;
+          for (std::size_t level = state.cursors.size(); level > 0 && !found; --level) {
+            TemplateCursor *owner = state.cursors[level - 1];
+            found = owner != nullptr && owner->getValue(instruction.slot, state.value);
+          }
+          if (!found)
+            state.value = GetGlobalValue(_names[instruction.slot]);
+
+          if (instruction.modifiers.empty())
+            state.writer.write(state.value);
+          else {
+            base::utf8string result(state.value);
+            for (auto &modifier : instruction.modifiers)
+              result = modifier.first->modify(result, modifier.second);
+            state.writer.write(result.data(), result.bytes());
+          }
+          ++index;
+          break;
+        }
+
+        case Separator:
+          //  Separators are expanded with the data of the section they are in, except for its last row.
+          //  For the last row they are handled like any other section.
+          if (cursor != nullptr && !cursor->isLast()) {
+            run(index + 1, instruction.end, state);
+            index = instruction.end;
+            break;
+          }
+          // fall through
+
+        case Section:
+          if (cursor != nullptr) {
+            for (std::size_t row = 0;; ++row) {
+              TemplateCursor *rowCursor = cursor->getSection(instruction.slot, row);
+              if (rowCursor == nullptr)
+                break;
+
+              state.cursors.push_back(rowCursor);
+              run(index + 1, instruction.end, state);
+              state.cursors.pop_back();
+            }
+          }
+          index = instruction.end;
+          break;
+      }
+    }
+  }
+
+  void CompiledTemplate::expand(TemplateCursor *cursor, TemplateWriter &writer) const {
+    State state(writer);
+    state.cursors.push_back(cursor);
+    run(0, _instructions.size(), state);
+  }
+
+  void CompiledTemplate::expand(DictionaryInterface *dict, TemplateWriter &writer) const {
+    DictionaryCursor cursor(*this, dict);
+    expand(&cursor, writer);
+  }
+
+  void CompiledTemplate::expand(DictionaryInterface *dict, TemplateOutput *output) const {
+    TemplateWriter writer(output);
+    expand(dict, writer);
+  }
+
+  void CompiledTemplate::dump(int indent) const {
+    base::utf8string indent_str(indent * 2, ' ');
+    static const char *operations[] = {"Text", "Variable", "Section", "Separator"};
+
+    std::cout << indent_str << "[CompiledTemplate] = " << std::endl << indent_str << "{" << std::endl;
+    for (std::size_t index = 0; index < _instructions.size(); ++index) {
+      const Instruction &instruction = _instructions[index];
+      std::cout << indent_str << "  " << index << ": " << operations[instruction.operation];
+      if (instruction.operation == Text)
+        std::cout << " = \"" << instruction.text << "\"";
+      else
+        std::cout << " = " << _names[instruction.slot];
+      if (instruction.operation == Section || instruction.operation == Separator)
+        std::cout << " (end " << instruction.end << ")";
+      std::cout << std::endl;
+    }
+    std::cout << indent_str << "}" << std::endl;
+  }
+
+  CompiledTemplate *GetCompiledTemplate(const base::utf8string &path, PARSE_TYPE type) {
+    if (type == STRIP_WHITESPACE)
+      throw std::invalid_argument("STRIP_WHITESPACE");
+
+    if (base::file_exists(path) == false)
+      return NULL;
+
+    std::ifstream file(path);
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+
+    return new CompiledTemplate(parseTemplate(buffer.str(), type));
+  }
+
+} //  namespace mtemplate
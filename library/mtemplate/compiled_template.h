@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#pragma once
+
+#include "common.h"
+#include "types.h"
+#include "dictionary.h"
+#include "output.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace mtemplate {
+
+  class Template;
+  class CompiledTemplate;
+
+  /**
+   * @brief The data a compiled template is expanded with.
+   *
+   * There is one cursor per section level, like there is one dictionary per section. Variables and sections
+   * are addressed by slot, the index the template compiler assigned to their name (see CompiledTemplate::slot()),
+   * so data sources can answer with an array access instead of a lookup by name, and produce values from their
+   * own typed data only when they are needed.
+   */
+  class MTEMPLATELIBRARY_PUBLIC_FUNC TemplateCursor {
+  public:
+    virtual ~TemplateCursor() {
+    }
+
+    //  Stores the value of the variable in value and returns true, or returns false if this cursor has no such
+    //  value. It is then taken from the enclosing cursors and finally from the global dictionary.
+    virtual bool getValue(std::size_t slot, std::string &value) = 0;
+
+    //  Returns the cursor for the given row of a section, or NULL if there is no such row. Rows are requested in
+    //  order, starting at 0. The cursor stays owned by this one and has to be valid only until the next call.
+    virtual TemplateCursor *getSection(std::size_t slot, std::size_t row) = 0;
+
+    //  Whether this is the last row of its section, which suppresses the section separator.
+    virtual bool isLast() {
+      return false;
+    }
+  };
+
+  /**
+   * @brief Lets a compiled template be expanded with dictionaries.
+   */
+  class MTEMPLATELIBRARY_PUBLIC_FUNC DictionaryCursor : public TemplateCursor {
+    const CompiledTemplate &_template;
+    DictionaryInterface *_dictionary;
+    std::unique_ptr<DictionaryCursor> _child;
+
+  public:
+    DictionaryCursor(const CompiledTemplate &tpl, DictionaryInterface *dictionary)
+      : _template(tpl), _dictionary(dictionary) {
+    }
+
+    virtual bool getValue(std::size_t slot, std::string &value);
+    virtual TemplateCursor *getSection(std::size_t slot, std::size_t row);
+    virtual bool isLast();
+  };
+
+  /**
+   * @brief Collects the output of compiled templates and passes it on in large chunks.
+   *
+   * Without an output everything is kept, see buffer().
+   */
+  class MTEMPLATELIBRARY_PUBLIC_FUNC TemplateWriter {
+    std::string _buffer;
+    TemplateOutput *_output;
+    std::size_t _flushSize;
+
+  public:
+    TemplateWriter(TemplateOutput *output = nullptr, std::size_t flushSize = 64 * 1024);
+    ~TemplateWriter();
+
+    void write(const char *data, std::size_t length) {
+      _buffer.append(data, length);
+      if (_output != nullptr && _buffer.size() >= _flushSize)
+        flush();
+    }
+    void write(const std::string &text) {
+      write(text.data(), text.size());
+    }
+
+    void flush();
+
+    const std::string &buffer() const {
+      return _buffer;
+    }
+  };
+
+  /**
+   * @brief A template compiled into a flat list of instructions.
+   *
+   * Text and line breaks between tags are merged, hidden nodes are left out, names are replaced by slots and
+   * modifiers are looked up once. Modifiers must therefore be registered before compiling. Expanding does not
+   * change the compiled template, so it can be used from several threads at the same time.
+   */
+  class MTEMPLATELIBRARY_PUBLIC_FUNC CompiledTemplate {
+  public:
+    static const std::size_t npos = static_cast<std::size_t>(-1);
+
+    CompiledTemplate(const TemplateDocument &document);
+    CompiledTemplate(const Template &tpl);
+
+    //  The slot of a variable or section name, npos if the template doesn't use it.
+    std::size_t slot(const base::utf8string &name) const;
+    const base::utf8string &name(std::size_t slot) const {
+      return _names[slot];
+    }
+    std::size_t slotCount() const {
+      return _names.size();
+    }
+
+    void expand(TemplateCursor *cursor, TemplateWriter &writer) const;
+    void expand(DictionaryInterface *dict, TemplateWriter &writer) const;
+    void expand(DictionaryInterface *dict, TemplateOutput *output) const;
+
+    void dump(int indent = 0) const;
+
+  private:
+    enum Operation { Text, Variable, Section, Separator };
+
+    struct Instruction {
+      Operation operation;
+      std::size_t slot;  //  Variable and sections.
+      std::size_t end;   //  Sections: the index of the first instruction after the section.
+      std::string text;  //  Text.
+      std::vector<std::pair<Modifier *, base::utf8string>> modifiers;
+    };
+
+    struct State;
+
+    std::vector<Instruction> _instructions;
+    std::vector<base::utf8string> _names;
+
+    void compile(const TemplateDocument &document);
+    std::size_t addName(const base::utf8string &name);
+    void run(std::size_t begin, std::size_t end, State &state) const;
+  };
+
+  MTEMPLATELIBRARY_PUBLIC_FUNC CompiledTemplate *GetCompiledTemplate(const base::utf8string &path,
+                                                                    PARSE_TYPE type = DO_NOT_STRIP);
+
+} //  namespace mtemplate
@@ -116,15 +116,22 @@ namespace mtemplate {
   }
 
   DictionaryInterface *Dictionary::addSectionDictionary(const base::utf8string &name) {
+    DictionaryInterface *_sectionDict = createSectionDictionary(name);
+    addSectionDictionary(name, _sectionDict);
+    return _sectionDict;
+  }
+
+  Dictionary *Dictionary::createSectionDictionary(const base::utf8string &name) {
     base::utf8string newName = _name + name + base::utf8string("/");
-    DictionaryInterface *_sectionDict = new Dictionary(newName, this);
+    return new Dictionary(newName, this);
+  }
 
+  void Dictionary::addSectionDictionary(const base::utf8string &name, DictionaryInterface *dictionary) {
     if (_section_dictionaries[name].size() > 0)
       _section_dictionaries[name].back()->setIsLast(false);
 
-    _sectionDict->setIsLast(true);
-    _section_dictionaries[name].push_back(_sectionDict);
-    return _sectionDict;
+    dictionary->setIsLast(true);
+    _section_dictionaries[name].push_back(dictionary);
   }
 
   Dictionary::section_dictionary_storage &Dictionary::getSectionDictionaries(const base::utf8string &section) {
@@ -166,4 +173,8 @@ namespace mtemplate {
     GlobalDictionary.setValue(key, value);
   }
 
+  base::utf8string GetGlobalValue(const base::utf8string &key) {
+    return GlobalDictionary.getValue(key);
+  }
+
 } //  namespace mtemplate
@@ -99,6 +99,9 @@ namespace mtemplate {
       : DictionaryInterface(name), _parent(parent) {
     }
     virtual ~Dictionary() {
+      for (auto &section : _section_dictionaries)
+        for (DictionaryInterface *dictionary : section.second)
+          delete dictionary;
     }
 
     //  DictionaryInterface
@@ -108,10 +111,16 @@ namespace mtemplate {
     virtual DictionaryInterface *addSectionDictionary(const base::utf8string &name);
     virtual section_dictionary_storage &getSectionDictionaries(const base::utf8string &section);
 
+    //  Creates a dictionary for the given section, like addSectionDictionary() does, but without adding it.
+    //  Such dictionaries can be filled independently (e.g. in parallel) and added later, in the wanted order.
+    Dictionary *createSectionDictionary(const base::utf8string &name);
+    void addSectionDictionary(const base::utf8string &name, DictionaryInterface *dictionary);
+
     virtual void dump(int indent = 0);
   };
 
   MTEMPLATELIBRARY_PUBLIC_FUNC Dictionary *CreateMainDictionary();
   MTEMPLATELIBRARY_PUBLIC_FUNC void SetGlobalValue(const base::utf8string &key, const base::utf8string &value);
+  MTEMPLATELIBRARY_PUBLIC_FUNC base::utf8string GetGlobalValue(const base::utf8string &key);
 
 } //  namespace mtemplate
@@ -23,6 +23,7 @@
 
 #include "template.h"
 #include <base/file_functions.h>
+#include <memory>
 #include <sstream>
 #include <iostream>
 #include "dictionary.h"
@@ -64,6 +65,43 @@ namespace mtemplate {
     }
   }
 
+  void Template::expand(DictionaryInterface *dict, TemplateOutput *output, const base::utf8string &section,
+                        const std::function<DictionaryInterface *(std::size_t index)> &nextSection) {
+    for (NodeStorageType node : _document) {
+      if (node->type() == TemplateObject_Section && node->_text == section) {
+        for (std::size_t index = 0;; ++index) {
+          std::unique_ptr<DictionaryInterface> section_dict(nextSection(index));
+          if (!section_dict)
+            break;
+          node->expand(output, section_dict.get());
+        }
+      } else if (node->type() == TemplateObject_Section) {
+        for (DictionaryInterface *section_dict : dict->getSectionDictionaries(node->_text))
+          node->expand(output, section_dict);
+      } else
+        node->expand(output, dict);
+    }
+  }
+
+  static bool containsSection(const TemplateDocument &document, const base::utf8string &name) {
+    for (NodeStorageType node : document) {
+      if (node->type() != TemplateObject_Section)
+        continue;
+      if (node->_text == name || containsSection(static_cast<NodeSection *>(node.get())->_contents, name))
+        return true;
+    }
+    return false;
+  }
+
+  bool Template::hasNestedSection(const base::utf8string &name) {
+    for (NodeStorageType node : _document) {
+      if (node->type() == TemplateObject_Section &&
+          containsSection(static_cast<NodeSection *>(node.get())->_contents, name))
+        return true;
+    }
+    return false;
+  }
+
   Template *GetTemplate(const base::utf8string &path, PARSE_TYPE type) {
     if (type == STRIP_WHITESPACE)
       throw std::invalid_argument("STRIP_WHITESPACE");
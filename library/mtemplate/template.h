@@ -29,6 +29,7 @@
 #include "modifier.h"
 #include "output.h"
 
+#include <functional>
 #include <string>
 
 namespace mtemplate {
@@ -42,6 +43,22 @@ namespace mtemplate {
     ~Template();
 
     void expand(DictionaryInterface *dict, TemplateOutput *output);
+
+    /**
+     * Like expand(), but the dictionaries for the top level sections with the given name are not taken from dict.
+     * They are requested one by one from nextSection (with a running index), until it returns NULL. Each of them
+     * is expanded and then deleted, so the data for large outputs never has to exist at once.
+     */
+    void expand(DictionaryInterface *dict, TemplateOutput *output, const base::utf8string &section,
+                const std::function<DictionaryInterface *(std::size_t index)> &nextSection);
+
+    //  Tells whether a section with this name is used anywhere but on the top level of the template.
+    bool hasNestedSection(const base::utf8string &name);
+
+    const TemplateDocument &document() const {
+      return _document;
+    }
+
     void dump(int indent = 0);
   };
 
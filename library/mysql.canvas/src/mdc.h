@@ -39,6 +39,7 @@
 #include "mdc_box_handle.h"
 #include "mdc_vertex_handle.h"
 #include "mdc_layer.h"
+#include "mdc_tile_cache.h"
 #include "mdc_back_layer.h"
 #include "mdc_interaction_layer.h"
 #include "mdc_layouter.h"
@@ -140,6 +140,26 @@ namespace mdc {
 
   //----------------------------------------------------------------------------------------------------------------------
 
+  /**
+   * Computes the smallest bounds enclosing both given bounds. Empty bounds are ignored.
+   *
+   * @param bounds1 One of the bounds to combine.
+   * @param bounds2 The other bounds to combine.
+   * @return The combined bounds.
+   * @note Bounds must be sorted.
+   */
+  inline base::Rect bounds_union(const base::Rect &bounds1, const base::Rect &bounds2) {
+    if (bounds1.empty())
+      return bounds2;
+    if (bounds2.empty())
+      return bounds1;
+
+    return base::Rect(base::Point(std::min(bounds1.left(), bounds2.left()), std::min(bounds1.top(), bounds2.top())),
+                      base::Point(std::max(bounds1.right(), bounds2.right()), std::max(bounds1.bottom(), bounds2.bottom())));
+  }
+
+  //----------------------------------------------------------------------------------------------------------------------
+
   inline base::Rect clip_bound(const base::Rect &bounds, const base::Rect &clip) {
     double x1 = bounds.left();
     double x2 = bounds.right();
@@ -36,7 +36,7 @@
 using namespace mdc;
 using namespace base;
 
-AreaGroup::AreaGroup(Layer *layer) : Group(layer), _dragged(false) {
+AreaGroup::AreaGroup(Layer *layer) : Group(layer), _dragged(false), _stacking_valid(false) {
   resize_to(Size(100, 100));
 
   _drag_selects_contents = false;
@@ -45,6 +45,68 @@ AreaGroup::AreaGroup(Layer *layer) : Group(layer), _dragged(false) {
 AreaGroup::~AreaGroup() {
 }
 
+void AreaGroup::add(CanvasItem *item) {
+  Group::add(item);
+
+  _index.insert(item, item->get_bounds());
+  _stacking_valid = false;
+}
+
+void AreaGroup::remove(CanvasItem *item) {
+  _index.remove(item);
+  _stacking_valid = false;
+
+  Group::remove(item);
+}
+
+void AreaGroup::raise_item(CanvasItem *item, CanvasItem *above) {
+  Group::raise_item(item, above);
+  _stacking_valid = false;
+}
+
+void AreaGroup::lower_item(CanvasItem *item) {
+  Group::lower_item(item);
+  _stacking_valid = false;
+}
+
+void AreaGroup::child_bounds_changed(CanvasItem *child) {
+  if (_index.contains(child))
+    _index.update(child, child->get_bounds());
+}
+
+//--------------------------------------------------------------------------------------------------
+
+struct StackingOrder {
+  const std::map<CanvasItem *, size_t> &stacking;
+
+  StackingOrder(const std::map<CanvasItem *, size_t> &s) : stacking(s) {
+  }
+
+  bool operator()(CanvasItem *a, CanvasItem *b) const {
+    return stacking.find(a)->second < stacking.find(b)->second;
+  }
+};
+
+std::vector<CanvasItem *> AreaGroup::get_contents_in(const Rect &rect) {
+  std::vector<CanvasItem *> items;
+  _index.query(rect, items);
+
+  if (items.size() > 1) {
+    if (!_stacking_valid) {
+      size_t i = 0;
+      _stacking.clear();
+      for (std::list<CanvasItem *>::const_iterator iter = _contents.begin(); iter != _contents.end(); ++iter)
+        _stacking[*iter] = i++;
+      _stacking_valid = true;
+    }
+    std::sort(items.begin(), items.end(), StackingOrder(_stacking));
+  }
+
+  return items;
+}
+
+//--------------------------------------------------------------------------------------------------
+
 void AreaGroup::repaint_contents(const Rect &localClipArea, bool direct) {
   if (_contents.size() > 0) {
     CairoCtx *cr = _layer->get_view()->cairoctx();
@@ -58,7 +120,8 @@ void AreaGroup::repaint_contents(const Rect &localClipArea, bool direct) {
       cr->translate(get_position());
     }
 
-    for (std::list<CanvasItem *>::reverse_iterator iter = _contents.rbegin(); iter != _contents.rend(); ++iter) {
+    std::vector<CanvasItem *> items(get_contents_in(localClipArea));
+    for (std::vector<CanvasItem *>::reverse_iterator iter = items.rbegin(); iter != items.rend(); ++iter) {
       if ((*iter)->get_visible() && (*iter)->intersects(localClipArea))
         (*iter)->repaint(localClipArea, direct);
     }
@@ -25,6 +25,7 @@
 #define _MDC_AREA_GROUP_H_
 
 #include "mdc_group.h"
+#include "mdc_spatial_index.h"
 
 namespace mdc {
 
@@ -47,10 +48,25 @@ namespace mdc {
 
     void repaint_contents(const base::Rect &localClipArea, bool direct);
 
+    virtual void add(CanvasItem *item);
+    virtual void remove(CanvasItem *item);
+
+    virtual void raise_item(CanvasItem *item, CanvasItem *above = 0);
+    virtual void lower_item(CanvasItem *item);
+
+    virtual std::vector<CanvasItem *> get_contents_in(const base::Rect &rect);
+
   protected:
     bool _dragged;
     bool _drag_selects_contents;
 
+    // Area groups can hold a whole diagram, so their contents are found through a spatial index.
+    SpatialIndex _index;
+    std::map<CanvasItem *, size_t> _stacking; //< position of each item in _contents, rebuilt on demand
+    bool _stacking_valid;
+
+    virtual void child_bounds_changed(CanvasItem *child);
+
     virtual void update_bounds();
     base::Rect constrain_rect_to_bounds(const base::Rect &rect);
 
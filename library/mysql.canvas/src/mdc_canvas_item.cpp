@@ -131,6 +131,8 @@ void CanvasItem::set_bounds(const Rect &rect) {
     _size = rect.size;
 
     //  _bounds_changed_signal.emit(obounds);
+    if (_parent)
+      _parent->child_bounds_changed(this);
 
     update_handles();
   }
@@ -143,6 +145,8 @@ void CanvasItem::set_position(const Point &pos) {
     _pos = pos.round();
 
     _bounds_changed_signal(obounds);
+    if (_parent)
+      _parent->child_bounds_changed(this);
 
     update_handles();
   }
@@ -155,6 +159,8 @@ void CanvasItem::set_size(const Size &size) {
     _size = size;
 
     _bounds_changed_signal(obounds);
+    if (_parent)
+      _parent->child_bounds_changed(this);
 
     update_handles();
   }
@@ -260,6 +266,8 @@ void CanvasItem::set_fixed_size(const Size &size) {
   _fixed_size = size;
   _size = size;
   _bounds_changed_signal(obounds);
+  if (_parent)
+    _parent->child_bounds_changed(this);
   set_needs_relayout();
 }
 
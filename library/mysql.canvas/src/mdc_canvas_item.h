@@ -329,6 +329,10 @@ namespace mdc {
     void repaint_cached();
     void regenerate_cache(base::Size size);
 
+    // Called on the parent whenever the position or size of one of its children changed.
+    virtual void child_bounds_changed(CanvasItem *child) {
+    }
+
     // virtual bool can_drag_handle_to(const base::Point &pos);
     // virtual void end_drag_handle_to(const base::Point &pos);
 
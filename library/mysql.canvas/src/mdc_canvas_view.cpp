@@ -40,6 +40,8 @@
 #include "mdc_back_layer.h"
 #include "mdc_interaction_layer.h"
 #include "mdc_area_group.h"
+#include "mdc_tile_cache.h"
+#include "mdc_png_writer.h"
 
 #include "mdc_line.h"
 
@@ -49,7 +51,12 @@ using namespace base;
 // XXX: use the values defined by the platform!
 #define DOUBLE_CLICK_TIME 0.5
 
+// Items are culled by their bounds, but can draw a bit beyond them (line widths, shadows). Exports consider
+// items within this distance to the exported area, so that tiles render the same pixels as a single pass.
+#define EXPORT_CULL_MARGIN 10
+
 #include <stdio.h>
+#include <future>
 
 //----------------------------------------------------------------------------------------------------------------------
 
@@ -98,6 +105,7 @@ CanvasView::CanvasView(int width, int height) : _fps(0), _total_item_cache_mem(0
 
   _repaint_lock = 0;
   _repaints_missed = 0;
+  _missed_full_repaint = false;
   _ui_lock = 0;
 
   _printout_mode = false;
@@ -225,7 +233,11 @@ void CanvasView::unlock_redraw() {
   _repaint_lock--;
 
   if (_repaint_lock == 0 && _repaints_missed > 0) {
-    queue_repaint();
+    // Only repaint what was damaged while locked, unless there was a request to repaint everything.
+    if (_missed_full_repaint || _missed_area.empty())
+      queue_repaint();
+    else
+      queue_repaint(_missed_area);
   }
 }
 
@@ -580,6 +592,12 @@ static bool is_line(CanvasItem *item) {
 
 void CanvasView::set_draws_line_hops(bool flag) {
   _line_hop_rendering = flag;
+
+  // Lines are drawn differently now, so tiles rendered before are outdated.
+  for (LayerList::iterator iter = _layers.begin(); iter != _layers.end(); ++iter) {
+    if ((*iter)->get_tile_cache())
+      (*iter)->get_tile_cache()->invalidate();
+  }
   queue_repaint();
 }
 
@@ -823,8 +841,12 @@ void CanvasView::repaint_area(const Rect &aBounds, int wx, int wy, int ww, int w
 
   // Repaint layers from back to front.
   for (LayerList::reverse_iterator iter = _layers.rbegin(); iter != _layers.rend(); ++iter) {
-    if ((*iter)->visible())
-      (*iter)->repaint(bounds);
+    if ((*iter)->visible()) {
+      if ((*iter)->get_tile_cache() && !has_gl())
+        repaint_layer_cached(*iter, bounds);
+      else
+        (*iter)->repaint(bounds);
+    }
   }
 
   _cairo->restore();
@@ -842,10 +864,13 @@ void CanvasView::repaint_area(const Rect &aBounds, int wx, int wy, int ww, int w
 void CanvasView::queue_repaint() {
   if (_repaint_lock > 0 || _destroying) {
     _repaints_missed++;
+    _missed_full_repaint = true;
     return;
   }
 
   _repaints_missed = 0;
+  _missed_full_repaint = false;
+  _missed_area = Rect();
   lock();
   _need_repaint_signal(0, 0, _view_width, _view_height);
   unlock();
@@ -856,10 +881,13 @@ void CanvasView::queue_repaint() {
 void CanvasView::queue_repaint(const Rect &bounds) {
   if (_repaint_lock > 0 || _destroying) {
     _repaints_missed++;
+    _missed_area = bounds_union(_missed_area, bounds);
     return;
   }
 
   _repaints_missed = 0;
+  _missed_full_repaint = false;
+  _missed_area = Rect();
 
   {
     int x, y;
@@ -872,6 +900,39 @@ void CanvasView::queue_repaint(const Rect &bounds) {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+/**
+ * Paints a layer from its tile cache, rendering only tiles which were invalidated since they were last used.
+ */
+void CanvasView::repaint_layer_cached(Layer *layer, const Rect &bounds) {
+  TileCache *cache = layer->get_tile_cache();
+
+  // Relayouting queues repaints, which invalidate tiles, so it must be done before any tile is used.
+  layer->relayout_pending();
+
+  cache->set_zoom(_zoom);
+  cache->paint(bounds, std::bind(&CanvasView::render_layer_tile, this, layer, std::placeholders::_1,
+                                 std::placeholders::_2),
+               [this](const Point &pos, cairo_surface_t *tile) { paint_item_cache(_cairo, pos.x, pos.y, tile); });
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void CanvasView::render_layer_tile(Layer *layer, CairoCtx *cr, const Rect &bounds) {
+  CairoCtx *oldcr = _cairo;
+  _cairo = cr;
+
+  try {
+    layer->repaint(bounds);
+  } catch (...) {
+    _cairo = oldcr;
+    throw;
+  }
+
+  _cairo = oldcr;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 Rect CanvasView::get_content_bounds() const {
   Size vs = get_total_view_size();
   double minx = vs.width, miny = vs.height, maxx = 0.0, maxy = 0.0;
@@ -895,7 +956,16 @@ Rect CanvasView::get_content_bounds() const {
 
 //----------------------------------------------------------------------------------------------------------------------
 
-void CanvasView::export_png(const std::string &filename, bool crop) {
+/**
+ * Exports the canvas (or only the area with content, if crop is true) as PNG image.
+ *
+ * The image is rendered in bands of tile_size rows, each split into tiles of tile_size columns which only paint
+ * the items intersecting them. Bands are compressed and written as soon as they are complete, so no more
+ * than two bands are in memory at any time. If threaded is true, a band is compressed in the background while
+ * the next one is rendered. A tile_size of 0 renders the whole image in one pass.
+ * The output doesn't depend on tile_size or threaded.
+ */
+void CanvasView::export_png(const std::string &filename, bool crop, int tile_size, bool threaded) {
   CanvasAutoLock lock(this);
 
   base::FileHandle fh(filename.c_str(), "wb");
@@ -907,30 +977,79 @@ void CanvasView::export_png(const std::string &filename, bool crop) {
     bounds.pos.y = 0;
     bounds.size = vsize;
   } else {
-    bounds.pos.x = std::max(bounds.pos.x - 10, 0.0);
-    bounds.pos.y = std::max(bounds.pos.y - 10, 0.0);
+    // Tiles must start on whole pixels to render exactly like a single pass.
+    bounds.pos.x = floor(std::max(bounds.pos.x - 10, 0.0));
+    bounds.pos.y = floor(std::max(bounds.pos.y - 10, 0.0));
     bounds.size.width += 20;
     bounds.size.height += 20;
   }
 
-  cairo_surface_t *surface = cairo_image_surface_create(CAIRO_FORMAT_RGB24, (int)bounds.width(), (int)bounds.height());
-  try {
-    CairoCtx ctx(surface);
+  int width = (int)bounds.width();
+  int height = (int)bounds.height();
+  if (tile_size <= 0)
+    tile_size = std::max(width, height);
+  int band_height = std::min(tile_size, height);
 
-    ctx.rectangle(0, 0, bounds.width(), bounds.height());
-    ctx.set_color(Color::white());
-    ctx.fill();
-    render_for_export(bounds, &ctx);
+  PNGStreamWriter writer(fh.file(), width, height);
 
-    cairo_status_t status;
+  struct Bands {
+    cairo_surface_t *surfaces[2];
+    Bands() {
+      surfaces[0] = surfaces[1] = 0;
+    }
+    ~Bands() {
+      for (int i = 0; i < 2; ++i)
+        if (surfaces[i])
+          cairo_surface_destroy(surfaces[i]);
+    }
+  } bands;
+
+  // Declared after the bands, so a pending compression is waited for before the surfaces go away.
+  std::future<void> compression;
+
+  int band = 0;
+  for (int y = 0; y < height; y += band_height, ++band) {
+    int rows = std::min(band_height, height - y);
+    cairo_surface_t *&surface = bands.surfaces[band % 2];
+    if (!surface) {
+      surface = cairo_image_surface_create(CAIRO_FORMAT_RGB24, width, band_height);
+      if (cairo_surface_status(surface) != CAIRO_STATUS_SUCCESS)
+        throw canvas_error(cairo_status_to_string(cairo_surface_status(surface)));
+    }
 
-    if ((status = cairo_surface_write_to_png_stream(surface, &write_to_surface, fh.file())) != CAIRO_STATUS_SUCCESS)
-      throw canvas_error(cairo_status_to_string(status));
-  } catch (std::exception &) {
-    cairo_surface_destroy(surface);
-    throw;
+    render_export_band(surface, Rect(bounds.left(), bounds.top() + y, width, rows), tile_size);
+
+    // The previous band uses the other surface, it must be done before the next one is rendered into it.
+    if (compression.valid())
+      compression.get();
+
+    if (threaded)
+      compression = std::async(std::launch::async, [&writer, surface, rows]() { writer.write_rows(surface, rows); });
+    else
+      writer.write_rows(surface, rows);
+  }
+
+  if (compression.valid())
+    compression.get();
+  writer.finish();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void CanvasView::render_export_band(cairo_surface_t *surface, const Rect &bounds, int tile_size) {
+  CairoCtx ctx(surface);
+
+  for (int x = 0; x < (int)bounds.width(); x += tile_size) {
+    Rect tile(bounds.left() + x, bounds.top(), std::min((double)tile_size, bounds.width() - x), bounds.height());
+
+    ctx.save();
+    ctx.translate(x, 0);
+    ctx.rectangle(0, 0, tile.width(), tile.height());
+    ctx.set_color(Color::white());
+    ctx.fill();
+    render_for_export(tile, &ctx);
+    ctx.restore();
   }
-  cairo_surface_destroy(surface);
 }
 
 //----------------------------------------------------------------------------------------------------------------------
@@ -1031,10 +1150,13 @@ void CanvasView::render_for_export(const Rect &bounds, CairoCtx *ctx) {
   _cairo->rectangle(bounds);
   _cairo->clip();
 
+  Rect area(bounds.left() - EXPORT_CULL_MARGIN, bounds.top() - EXPORT_CULL_MARGIN,
+            bounds.width() + 2 * EXPORT_CULL_MARGIN, bounds.height() + 2 * EXPORT_CULL_MARGIN);
+
   // repaint layers from bottom to top
   for (LayerList::reverse_iterator iter = _layers.rbegin(); iter != _layers.rend(); ++iter) {
     if ((*iter)->visible())
-      (*iter)->repaint_for_export(bounds);
+      (*iter)->repaint_for_export(area);
   }
 
   set_printout_mode(false);
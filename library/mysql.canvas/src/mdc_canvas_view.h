@@ -221,7 +221,7 @@ namespace mdc {
 
     virtual Surface *create_temp_surface(const base::Size &size) const;
 
-    void export_png(const std::string &filename, bool crop = false);
+    void export_png(const std::string &filename, bool crop = false, int tile_size = 1024, bool threaded = true);
     void export_pdf(const std::string &filename, const base::Size &size_in_pt);
     void export_ps(const std::string &filename, const base::Size &size_in_pt);
     void export_svg(const std::string &filename, const base::Size &size_in_pt);
@@ -271,6 +271,8 @@ namespace mdc {
     int _ui_lock;
     int _repaint_lock;
     int _repaints_missed;
+    base::Rect _missed_area; // Union of the areas queued while redraw was locked.
+    bool _missed_full_repaint;
 
     FontSpec _default_font;
 
@@ -330,6 +332,10 @@ namespace mdc {
     bool perform_auto_scroll(const base::Point &mouse_pos);
 
     void render_for_export(const base::Rect &bounds, CairoCtx *cr);
+    void render_export_band(cairo_surface_t *surface, const base::Rect &bounds, int tile_size);
+
+    void repaint_layer_cached(Layer *layer, const base::Rect &bounds);
+    void render_layer_tile(Layer *layer, CairoCtx *cr, const base::Rect &bounds);
 
   private:
     struct ClickInfo {
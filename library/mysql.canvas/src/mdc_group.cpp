@@ -33,6 +33,9 @@
 using namespace mdc;
 using namespace base;
 
+// Lines accept clicks slightly outside of their bounds, see Line::contains_point().
+#define HIT_TEST_SLACK 3
+
 Group::Group(Layer *layer) : Layouter(layer) {
 #ifdef no_group_activate
   _activated = false;
@@ -72,13 +75,18 @@ void Group::repaint(const Rect &clipArea, bool direct) {
 
   cr->save();
   cr->translate(get_position());
-  for (std::list<CanvasItem *>::reverse_iterator iter = _contents.rbegin(); iter != _contents.rend(); ++iter) {
+  std::vector<CanvasItem *> items(get_contents_in(clipRect));
+  for (std::vector<CanvasItem *>::reverse_iterator iter = items.rbegin(); iter != items.rend(); ++iter) {
     if ((*iter)->get_visible() && (*iter)->intersects(clipRect))
       (*iter)->repaint(clipRect, false);
   }
   cr->restore();
 }
 
+std::vector<CanvasItem *> Group::get_contents_in(const Rect &rect) {
+  return std::vector<CanvasItem *>(_contents.begin(), _contents.end());
+}
+
 void Group::add(CanvasItem *item) {
   Group *parent_group = dynamic_cast<Group *>(item->get_parent());
 
@@ -204,8 +212,10 @@ void Group::set_selected(bool flag) {
 
 CanvasItem *Group::get_direct_subitem_at(const Point &point) {
   Point npoint = point - get_position();
+  std::vector<CanvasItem *> items(
+    get_contents_in(Rect(npoint.x - HIT_TEST_SLACK, npoint.y - HIT_TEST_SLACK, 2 * HIT_TEST_SLACK, 2 * HIT_TEST_SLACK)));
 
-  for (std::list<CanvasItem *>::const_iterator iter = _contents.begin(); iter != _contents.end(); ++iter) {
+  for (std::vector<CanvasItem *>::const_iterator iter = items.begin(); iter != items.end(); ++iter) {
     if ((*iter)->get_visible() && (*iter)->contains_point(npoint)) {
       Group *subgroup = dynamic_cast<Group *>((*iter));
       if (subgroup) {
@@ -222,8 +232,10 @@ CanvasItem *Group::get_direct_subitem_at(const Point &point) {
 
 CanvasItem *Group::get_other_item_at(const Point &point, CanvasItem *other_item) {
   Point npoint = point - get_position();
+  std::vector<CanvasItem *> items(
+    get_contents_in(Rect(npoint.x - HIT_TEST_SLACK, npoint.y - HIT_TEST_SLACK, 2 * HIT_TEST_SLACK, 2 * HIT_TEST_SLACK)));
 
-  for (std::list<CanvasItem *>::const_iterator iter = _contents.begin(); iter != _contents.end(); ++iter) {
+  for (std::vector<CanvasItem *>::const_iterator iter = items.begin(); iter != items.end(); ++iter) {
     if ((*iter)->get_visible() && (*iter)->contains_point(npoint) && *iter != other_item) {
       Layouter *litem = dynamic_cast<Layouter *>(*iter);
       if (litem) {
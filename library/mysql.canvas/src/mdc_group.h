@@ -53,6 +53,10 @@ namespace mdc {
     void freeze();
     void thaw();
 
+    // Returns the direct children which may intersect the given rect (in local coordinates), topmost first.
+    // Callers still have to check the items themselves, the result can contain more than the matching ones.
+    virtual std::vector<CanvasItem *> get_contents_in(const base::Rect &rect);
+
     CanvasItem *get_direct_subitem_at(const base::Point &point);
     virtual CanvasItem *get_other_item_at(const base::Point &point, CanvasItem *item);
     virtual CanvasItem *get_item_at(const base::Point &point);
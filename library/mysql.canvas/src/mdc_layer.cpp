@@ -28,13 +28,14 @@
 #include "mdc_item_handle.h"
 #include "mdc_area_group.h"
 #include "mdc_selection.h"
+#include "mdc_tile_cache.h"
 
 using namespace mdc;
 using namespace base;
 
 Layer::Layer(CanvasView *view) : _owner(view) {
   _visible = true;
-  _needs_repaint = true;
+  _tile_cache = 0;
 
   _root_area = new AreaGroup(this);
   _root_area->resize_to(_owner->get_total_view_size());
@@ -54,6 +55,7 @@ void Layer::set_root_area(AreaGroup *group) {
 
 Layer::~Layer() {
   delete _root_area;
+  delete _tile_cache;
 }
 
 void Layer::set_name(const std::string &name) {
@@ -85,20 +87,24 @@ void Layer::add_item(CanvasItem *item, AreaGroup *location) {
 
   get_view()->unlock();
 
-  queue_repaint();
+  queue_repaint(item->get_padded_root_bounds());
 }
 
 void Layer::remove_item(CanvasItem *item) {
   get_view()->get_selection()->remove(item);
 
-  if (item->get_parent())
+  Rect bounds;
+  if (item->get_parent()) {
+    bounds = item->get_padded_root_bounds();
     dynamic_cast<Layouter *>(item->get_parent())->remove(item);
+  }
 
   std::list<CanvasItem *>::iterator iter = std::find(_relayout_queue.begin(), _relayout_queue.end(), item);
   if (iter != _relayout_queue.end())
     _relayout_queue.erase(iter);
 
-  queue_repaint();
+  if (!bounds.empty())
+    queue_repaint(bounds);
 }
 
 static void invalidate(CanvasItem *item) {
@@ -110,35 +116,39 @@ static void invalidate(CanvasItem *item) {
 
 void Layer::invalidate_caches() {
   _root_area->foreach(std::bind(&invalidate, std::placeholders::_1));
+  if (_tile_cache)
+    _tile_cache->invalidate();
 }
 
-void Layer::set_needs_repaint_all_items() {
-  _root_area->foreach (std::bind(&CanvasItem::set_needs_repaint, std::placeholders::_1));
+void Layer::set_tile_cache_enabled(bool flag) {
+  if (flag && !_tile_cache)
+    _tile_cache = new TileCache();
+  else if (!flag && _tile_cache) {
+    delete _tile_cache;
+    _tile_cache = 0;
+  }
 }
 
-void Layer::repaint_pending() {
-  if (_needs_repaint) {
-    // XXX record pending areas and repaint only what's needed
-    repaint(Rect(Point(0, 0), _owner->get_total_view_size()));
-    _needs_repaint = false;
-  }
+void Layer::set_needs_repaint_all_items() {
+  _root_area->foreach (std::bind(&CanvasItem::set_needs_repaint, std::placeholders::_1));
 }
 
-void Layer::repaint(const Rect &bounds) {
+void Layer::relayout_pending() {
   for (std::list<CanvasItem *>::iterator iter = _relayout_queue.begin(); iter != _relayout_queue.end(); ++iter) {
     (*iter)->relayout();
   }
   _relayout_queue.clear();
+}
+
+void Layer::repaint(const Rect &bounds) {
+  relayout_pending();
 
   if (_visible)
     _root_area->repaint(bounds, false);
 }
 
 void Layer::repaint_for_export(const Rect &aBounds) {
-  for (std::list<CanvasItem *>::iterator iter = _relayout_queue.begin(); iter != _relayout_queue.end(); ++iter) {
-    (*iter)->relayout();
-  }
-  _relayout_queue.clear();
+  relayout_pending();
 
   if (_visible)
     _root_area->repaint(aBounds, true);
@@ -147,14 +157,16 @@ void Layer::repaint_for_export(const Rect &aBounds) {
 //--------------------------------------------------------------------------------------------------
 
 void Layer::queue_repaint() {
-  _needs_repaint = true;
+  if (_tile_cache)
+    _tile_cache->invalidate();
   _owner->queue_repaint();
 }
 
 //--------------------------------------------------------------------------------------------------
 
 void Layer::queue_repaint(const Rect &bounds) {
-  _needs_repaint = true;
+  if (_tile_cache)
+    _tile_cache->invalidate(bounds);
   _owner->queue_repaint(bounds);
 }
 
@@ -183,10 +195,10 @@ CanvasItem *Layer::get_top_item_at(const Point &point) {
 }
 
 static std::list<CanvasItem *> get_items_bounded_by(const Rect &rect, const Layer::ItemCheckFunc &pred, Group *group) {
-  std::list<CanvasItem *> &items = group->get_contents();
+  std::vector<CanvasItem *> items(group->get_contents_in(Rect(rect.pos - group->get_root_position(), rect.size)));
   std::list<CanvasItem *> result;
 
-  for (std::list<CanvasItem *>::iterator iter = items.begin(); iter != items.end(); ++iter) {
+  for (std::vector<CanvasItem *>::iterator iter = items.begin(); iter != items.end(); ++iter) {
     Group *g;
 
     if (bounds_intersect((*iter)->get_root_bounds(), rect) && (!pred || pred(*iter)))
@@ -34,6 +34,7 @@ namespace mdc {
   class CanvasView;
   class CanvasItem;
   class AreaGroup;
+  class TileCache;
 
   class MYSQLCANVAS_PUBLIC_FUNC Layer : public base::trackable {
   public:
@@ -55,10 +56,18 @@ namespace mdc {
       return _visible;
     };
 
-    virtual void repaint_pending();
     virtual void repaint(const base::Rect &aBounds);
     void repaint_for_export(const base::Rect &aBounds);
 
+    void relayout_pending();
+
+    // A layer can keep its rendered content in tiles, which the view then paints from. Queued repaints only
+    // invalidate the tiles they touch, so scrolling and small changes don't render the whole layer again.
+    void set_tile_cache_enabled(bool flag);
+    TileCache *get_tile_cache() const {
+      return _tile_cache;
+    }
+
     inline CanvasView *get_view() const {
       return _owner;
     };
@@ -102,7 +111,7 @@ namespace mdc {
 
     bool _visible;
 
-    bool _needs_repaint;
+    TileCache *_tile_cache;
 
     Layer *get_layer_under_this();
 
@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include "mdc_png_writer.h"
+
+#include <stdint.h>
+#include <zlib.h>
+
+using namespace mdc;
+
+// Size of the IDAT chunks written.
+#define CHUNK_SIZE 65536
+
+static const unsigned char png_signature[] = {137, 80, 78, 71, 13, 10, 26, 10};
+
+static void put_uint32(unsigned char *buffer, uint32_t value) {
+  buffer[0] = (unsigned char)(value >> 24);
+  buffer[1] = (unsigned char)(value >> 16);
+  buffer[2] = (unsigned char)(value >> 8);
+  buffer[3] = (unsigned char)value;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+PNGStreamWriter::PNGStreamWriter(FILE *file, int width, int height)
+  : _file(file), _width(width), _height(height), _rows_written(0), _stream(0) {
+  if (width <= 0 || height <= 0)
+    throw canvas_error("Invalid image size for PNG export");
+
+  // One filter type byte per row, followed by the RGB samples.
+  _row.resize(1 + 3 * (size_t)width);
+  _buffer.resize(CHUNK_SIZE);
+
+  _stream = new z_stream();
+  if (deflateInit(_stream, Z_DEFAULT_COMPRESSION) != Z_OK) {
+    delete _stream;
+    _stream = 0;
+    throw canvas_error("Could not initialize compression for PNG export");
+  }
+
+  if (fwrite(png_signature, sizeof(png_signature), 1, _file) != 1)
+    throw canvas_error("Could not write PNG file");
+
+  unsigned char header[13];
+  put_uint32(header, (uint32_t)width);
+  put_uint32(header + 4, (uint32_t)height);
+  header[8] = 8;  // bit depth
+  header[9] = 2;  // color type: RGB
+  header[10] = 0; // compression: deflate
+  header[11] = 0; // filter method: adaptive
+  header[12] = 0; // no interlacing
+  write_chunk("IHDR", header, sizeof(header));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+PNGStreamWriter::~PNGStreamWriter() {
+  if (_stream) {
+    deflateEnd(_stream);
+    delete _stream;
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void PNGStreamWriter::write_chunk(const char *type, const unsigned char *data, size_t length) {
+  unsigned char buffer[4];
+
+  put_uint32(buffer, (uint32_t)length);
+  if (fwrite(buffer, 4, 1, _file) != 1 || fwrite(type, 4, 1, _file) != 1 ||
+      (length > 0 && fwrite(data, length, 1, _file) != 1))
+    throw canvas_error("Could not write PNG file");
+
+  uLong crc = crc32(0, (const Bytef *)type, 4);
+  if (length > 0)
+    crc = crc32(crc, data, (uInt)length);
+  put_uint32(buffer, (uint32_t)crc);
+  if (fwrite(buffer, 4, 1, _file) != 1)
+    throw canvas_error("Could not write PNG file");
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Feeds data to the compressor, writing an IDAT chunk whenever the output buffer is full. The chunk
+ * layout only depends on the compressed data, not on how the rows were passed in.
+ */
+void PNGStreamWriter::compress(const unsigned char *data, size_t length, bool last) {
+  _stream->next_in = (Bytef *)data;
+  _stream->avail_in = (uInt)length;
+
+  for (;;) {
+    if (_stream->avail_out == 0) {
+      if (_stream->next_out != 0)
+        write_chunk("IDAT", &_buffer[0], _buffer.size());
+      _stream->next_out = &_buffer[0];
+      _stream->avail_out = (uInt)_buffer.size();
+    }
+
+    int result = deflate(_stream, last ? Z_FINISH : Z_NO_FLUSH);
+    if (result == Z_STREAM_END)
+      break;
+    if (result != Z_OK && result != Z_BUF_ERROR)
+      throw canvas_error("Error compressing PNG data");
+    if (!last && _stream->avail_in == 0 && _stream->avail_out > 0)
+      break;
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Adds the given number of rows from the top of an RGB24 or ARGB32 cairo image surface (alpha is ignored).
+ * Rows are stored with the Sub filter, which works well for the large flat areas of diagrams.
+ */
+void PNGStreamWriter::write_rows(cairo_surface_t *surface, int rows) {
+  if (cairo_image_surface_get_width(surface) < _width || cairo_image_surface_get_height(surface) < rows)
+    throw canvas_error("Image band doesn't match the PNG size");
+  if (_rows_written + rows > _height)
+    throw canvas_error("Too many rows written to PNG");
+
+  cairo_surface_flush(surface);
+
+  const unsigned char *data = cairo_image_surface_get_data(surface);
+  int stride = cairo_image_surface_get_stride(surface);
+
+  for (int y = 0; y < rows; ++y) {
+    const uint32_t *pixels = (const uint32_t *)(data + (size_t)y * stride);
+    unsigned char *row = &_row[0];
+    unsigned char previous[3] = {0, 0, 0};
+
+    *row++ = 1; // Sub filter
+    for (int x = 0; x < _width; ++x) {
+      unsigned char rgb[3] = {(unsigned char)(pixels[x] >> 16), (unsigned char)(pixels[x] >> 8),
+                              (unsigned char)pixels[x]};
+      for (int i = 0; i < 3; ++i) {
+        *row++ = (unsigned char)(rgb[i] - previous[i]);
+        previous[i] = rgb[i];
+      }
+    }
+    compress(&_row[0], _row.size(), false);
+  }
+  _rows_written += rows;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void PNGStreamWriter::finish() {
+  if (_rows_written != _height)
+    throw canvas_error("PNG image is incomplete");
+
+  compress(0, 0, true);
+  size_t pending = _buffer.size() - _stream->avail_out;
+  if (pending > 0)
+    write_chunk("IDAT", &_buffer[0], pending);
+  write_chunk("IEND", 0, 0);
+}
+
+//--------------------------------------------------------------------------------------------------
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#ifndef _MDC_PNG_WRITER_H_
+#define _MDC_PNG_WRITER_H_
+
+#include "mdc_common.h"
+
+struct z_stream_s;
+
+namespace mdc {
+
+  /**
+   * Writes an 8 bit RGB PNG image row by row, so that an image can be produced in bands without having
+   * all of it in memory. The rows must be added from top to bottom and finish() must be called after the last one.
+   */
+  class MYSQLCANVAS_PUBLIC_FUNC PNGStreamWriter {
+  public:
+    PNGStreamWriter(FILE *file, int width, int height);
+    ~PNGStreamWriter();
+
+    void write_rows(cairo_surface_t *surface, int rows);
+    void finish();
+
+  private:
+    FILE *_file;
+    int _width;
+    int _height;
+    int _rows_written;
+    z_stream_s *_stream;
+    std::vector<unsigned char> _row;
+    std::vector<unsigned char> _buffer;
+
+    void write_chunk(const char *type, const unsigned char *data, size_t length);
+    void compress(const unsigned char *data, size_t length, bool last);
+  };
+
+} // end of mdc namespace
+
+#endif /* _MDC_PNG_WRITER_H_ */
@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include "mdc_spatial_index.h"
+#include "mdc_algorithms.h"
+
+#include <climits>
+#include <cmath>
+
+using namespace mdc;
+using namespace base;
+
+// Items spanning more cells than this are not put into the grid, but checked on every query.
+#define MAX_CELLS_PER_ITEM 64
+
+static inline int64_t cell_key(int x, int y) {
+  return ((int64_t)x << 32) | (uint32_t)y;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+SpatialIndex::SpatialIndex(double cell_size) : _cell_size(cell_size), _mark(0) {
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Computes the range of cells covered by the given rect. Returns false if that can't be done (the rect
+ * has no finite coordinates).
+ */
+bool SpatialIndex::cell_range(const Rect &rect, int &left, int &top, int &right, int &bottom) const {
+  if (!std::isfinite(rect.left()) || !std::isfinite(rect.top()) || !std::isfinite(rect.right()) ||
+      !std::isfinite(rect.bottom()))
+    return false;
+
+  double l = floor(rect.left() / _cell_size), t = floor(rect.top() / _cell_size);
+  double r = floor(rect.right() / _cell_size), b = floor(rect.bottom() / _cell_size);
+  if (l < INT_MIN || t < INT_MIN || r > INT_MAX || b > INT_MAX)
+    return false;
+
+  left = (int)l;
+  top = (int)t;
+  right = (int)r;
+  bottom = (int)b;
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void SpatialIndex::add_to_cells(Entry *entry) {
+  entry->oversized = !cell_range(entry->bounds, entry->left, entry->top, entry->right, entry->bottom) ||
+                     (double)(entry->right - entry->left + 1) * (entry->bottom - entry->top + 1) > MAX_CELLS_PER_ITEM;
+
+  if (entry->oversized)
+    _oversized.push_back(entry);
+  else {
+    for (int x = entry->left; x <= entry->right; ++x)
+      for (int y = entry->top; y <= entry->bottom; ++y)
+        _cells[cell_key(x, y)].push_back(entry);
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void SpatialIndex::remove_from_cells(Entry *entry) {
+  if (entry->oversized) {
+    std::vector<Entry *>::iterator iter = std::find(_oversized.begin(), _oversized.end(), entry);
+    if (iter != _oversized.end()) {
+      *iter = _oversized.back();
+      _oversized.pop_back();
+    }
+    return;
+  }
+
+  for (int x = entry->left; x <= entry->right; ++x) {
+    for (int y = entry->top; y <= entry->bottom; ++y) {
+      std::unordered_map<int64_t, std::vector<Entry *> >::iterator cell = _cells.find(cell_key(x, y));
+      if (cell == _cells.end())
+        continue;
+
+      std::vector<Entry *> &list = cell->second;
+      std::vector<Entry *>::iterator iter = std::find(list.begin(), list.end(), entry);
+      if (iter != list.end()) {
+        *iter = list.back();
+        list.pop_back();
+      }
+      if (list.empty())
+        _cells.erase(cell);
+    }
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void SpatialIndex::insert(CanvasItem *item, const Rect &bounds) {
+  if (_entries.find(item) != _entries.end()) {
+    update(item, bounds);
+    return;
+  }
+
+  Entry &entry = _entries[item];
+  entry.item = item;
+  entry.bounds = bounds;
+  entry.mark = 0;
+  add_to_cells(&entry);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void SpatialIndex::update(CanvasItem *item, const Rect &bounds) {
+  std::unordered_map<CanvasItem *, Entry>::iterator iter = _entries.find(item);
+  if (iter == _entries.end()) {
+    insert(item, bounds);
+    return;
+  }
+
+  Entry &entry = iter->second;
+  int left, top, right, bottom;
+  bool same_cells = !entry.oversized && cell_range(bounds, left, top, right, bottom) && left == entry.left &&
+                    top == entry.top && right == entry.right && bottom == entry.bottom;
+
+  // Small moves usually stay within the same cells.
+  if (!same_cells)
+    remove_from_cells(&entry);
+  entry.bounds = bounds;
+  if (!same_cells)
+    add_to_cells(&entry);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void SpatialIndex::remove(CanvasItem *item) {
+  std::unordered_map<CanvasItem *, Entry>::iterator iter = _entries.find(item);
+  if (iter != _entries.end()) {
+    remove_from_cells(&iter->second);
+    _entries.erase(iter);
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void SpatialIndex::clear() {
+  _entries.clear();
+  _cells.clear();
+  _oversized.clear();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool SpatialIndex::contains(CanvasItem *item) const {
+  return _entries.find(item) != _entries.end();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Adds all items whose bounds intersect the given rect to the list. A rect with no size can be used
+ * to query a point.
+ */
+void SpatialIndex::query(const Rect &rect, std::vector<CanvasItem *> &items) const {
+  int left, top, right, bottom;
+
+  // For large areas it is cheaper to go through all items than through all cells.
+  if (!cell_range(rect, left, top, right, bottom) ||
+      (double)(right - left + 1) * (bottom - top + 1) > (double)_entries.size()) {
+    for (std::unordered_map<CanvasItem *, Entry>::const_iterator iter = _entries.begin(); iter != _entries.end();
+         ++iter) {
+      if (bounds_intersect(iter->second.bounds, rect))
+        items.push_back(iter->first);
+    }
+    return;
+  }
+
+  // Entries can be in several cells, the mark makes sure each is reported only once.
+  if (++_mark == 0) {
+    for (std::unordered_map<CanvasItem *, Entry>::const_iterator iter = _entries.begin(); iter != _entries.end();
+         ++iter)
+      iter->second.mark = 0;
+    _mark = 1;
+  }
+
+  for (int x = left; x <= right; ++x) {
+    for (int y = top; y <= bottom; ++y) {
+      std::unordered_map<int64_t, std::vector<Entry *> >::const_iterator cell = _cells.find(cell_key(x, y));
+      if (cell == _cells.end())
+        continue;
+
+      for (std::vector<Entry *>::const_iterator iter = cell->second.begin(); iter != cell->second.end(); ++iter) {
+        if ((*iter)->mark != _mark && bounds_intersect((*iter)->bounds, rect)) {
+          (*iter)->mark = _mark;
+          items.push_back((*iter)->item);
+        }
+      }
+    }
+  }
+
+  for (std::vector<Entry *>::const_iterator iter = _oversized.begin(); iter != _oversized.end(); ++iter) {
+    if (bounds_intersect((*iter)->bounds, rect))
+      items.push_back((*iter)->item);
+  }
+}
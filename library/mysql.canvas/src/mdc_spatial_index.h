@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#ifndef _MDC_SPATIAL_INDEX_H_
+#define _MDC_SPATIAL_INDEX_H_
+
+#include "mdc_common.h"
+
+#include <unordered_map>
+
+namespace mdc {
+
+  class CanvasItem;
+
+  /**
+   * A uniform grid over the bounds of a set of canvas items, to find the items in an area or at a point
+   * without looking at every item. Items covering too many cells (e.g. long lines) are kept in a separate
+   * list which is always checked. Results are in no particular order.
+   */
+  class MYSQLCANVAS_PUBLIC_FUNC SpatialIndex {
+  public:
+    SpatialIndex(double cell_size = 256.0);
+
+    void insert(CanvasItem *item, const base::Rect &bounds);
+    void update(CanvasItem *item, const base::Rect &bounds);
+    void remove(CanvasItem *item);
+    void clear();
+
+    bool contains(CanvasItem *item) const;
+    size_t size() const {
+      return _entries.size();
+    }
+
+    void query(const base::Rect &rect, std::vector<CanvasItem *> &items) const;
+
+  private:
+    struct Entry {
+      CanvasItem *item;
+      base::Rect bounds;
+      int left, top, right, bottom; // covered cells, if not oversized
+      bool oversized;
+      mutable unsigned int mark;
+    };
+
+    double _cell_size;
+    std::unordered_map<CanvasItem *, Entry> _entries;
+    std::unordered_map<int64_t, std::vector<Entry *> > _cells;
+    std::vector<Entry *> _oversized;
+    mutable unsigned int _mark;
+
+    bool cell_range(const base::Rect &rect, int &left, int &top, int &right, int &bottom) const;
+    void add_to_cells(Entry *entry);
+    void remove_from_cells(Entry *entry);
+  };
+
+} // end of mdc namespace
+
+#endif /* _MDC_SPATIAL_INDEX_H_ */
@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include "mdc_tile_cache.h"
+#include "mdc_algorithms.h"
+
+#include <string.h>
+
+using namespace mdc;
+using namespace base;
+
+//--------------------------------------------------------------------------------------------------
+
+TileCache::TileCache(int tile_size, size_t max_tiles) : _tile_size(tile_size), _max_tiles(max_tiles), _zoom(1.0) {
+}
+
+//--------------------------------------------------------------------------------------------------
+
+TileCache::~TileCache() {
+  clear();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Tiles have a fixed size in pixels, so a different zoom level needs all of them to be created again.
+ */
+void TileCache::set_zoom(double zoom) {
+  if (zoom != _zoom) {
+    clear();
+    _zoom = zoom;
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void TileCache::invalidate() {
+  for (std::map<std::pair<int, int>, Tile>::iterator iter = _tiles.begin(); iter != _tiles.end(); ++iter)
+    iter->second.valid = false;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void TileCache::invalidate(const Rect &area) {
+  for (std::map<std::pair<int, int>, Tile>::iterator iter = _tiles.begin(); iter != _tiles.end(); ++iter) {
+    if (iter->second.valid && bounds_intersect(tile_bounds(iter->first.first, iter->first.second), area))
+      iter->second.valid = false;
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void TileCache::clear() {
+  for (std::map<std::pair<int, int>, Tile>::iterator iter = _tiles.begin(); iter != _tiles.end(); ++iter)
+    cairo_surface_destroy(iter->second.surface);
+  _tiles.clear();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+Rect TileCache::tile_bounds(int x, int y) const {
+  double size = _tile_size / _zoom;
+  return Rect(x * size, y * size, size, size);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void TileCache::drop_tiles_outside(int left, int top, int right, int bottom) {
+  std::map<std::pair<int, int>, Tile>::iterator iter = _tiles.begin();
+  while (iter != _tiles.end()) {
+    int x = iter->first.first;
+    int y = iter->first.second;
+    if (x < left || x > right || y < top || y > bottom) {
+      cairo_surface_destroy(iter->second.surface);
+      _tiles.erase(iter++);
+    } else
+      ++iter;
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Paints the given area (in canvas coordinates) from the tiles covering it. Tiles which don't exist yet or
+ * were invalidated are rendered first by calling render with a context set up for the tile's area.
+ * paint is then called for each tile, with the canvas position of its top left corner.
+ */
+void TileCache::paint(const Rect &area, const RenderSlot &render, const PaintSlot &paint) {
+  if (area.empty())
+    return;
+
+  double size = _tile_size / _zoom;
+  int left = (int)floor(area.left() / size);
+  int top = (int)floor(area.top() / size);
+  int right = std::max(left, (int)ceil(area.right() / size) - 1);
+  int bottom = std::max(top, (int)ceil(area.bottom() / size) - 1);
+
+  if (_tiles.size() + (right - left + 1) * (bottom - top + 1) > _max_tiles)
+    drop_tiles_outside(left, top, right, bottom);
+
+  for (int y = top; y <= bottom; ++y) {
+    for (int x = left; x <= right; ++x) {
+      Tile &tile = _tiles[std::make_pair(x, y)];
+      Rect bounds = tile_bounds(x, y);
+
+      if (!tile.surface) {
+        tile.surface = cairo_image_surface_create(CAIRO_FORMAT_ARGB32, _tile_size, _tile_size);
+        tile.valid = false;
+      }
+
+      if (!tile.valid) {
+        cairo_surface_flush(tile.surface);
+        memset(cairo_image_surface_get_data(tile.surface), 0,
+               cairo_image_surface_get_stride(tile.surface) * cairo_image_surface_get_height(tile.surface));
+        cairo_surface_mark_dirty(tile.surface);
+
+        CairoCtx ctx(tile.surface);
+        ctx.scale(_zoom, _zoom);
+        ctx.translate(-bounds.left(), -bounds.top());
+        ctx.rectangle(bounds);
+        ctx.clip();
+
+        render(&ctx, bounds);
+        tile.valid = true;
+      }
+
+      paint(bounds.pos, tile.surface);
+    }
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#ifndef _MDC_TILE_CACHE_H_
+#define _MDC_TILE_CACHE_H_
+
+#include "mdc_common.h"
+
+#include <functional>
+
+namespace mdc {
+
+  /**
+   * Backing store for a layer, made of fixed size image tiles at the current zoom level. Tiles are rendered
+   * on first use and kept until the area they cover is invalidated, so scrolling over a layer that doesn't
+   * change and repainting small areas don't have to render the layer contents again.
+   */
+  class MYSQLCANVAS_PUBLIC_FUNC TileCache {
+  public:
+    typedef std::function<void(CairoCtx *, const base::Rect &)> RenderSlot;
+    typedef std::function<void(const base::Point &, cairo_surface_t *)> PaintSlot;
+
+    TileCache(int tile_size = 256, size_t max_tiles = 64);
+    ~TileCache();
+
+    void set_zoom(double zoom);
+
+    void invalidate();
+    void invalidate(const base::Rect &area);
+    void clear();
+
+    void paint(const base::Rect &area, const RenderSlot &render, const PaintSlot &paint);
+
+    size_t tile_count() const {
+      return _tiles.size();
+    }
+
+  private:
+    struct Tile {
+      cairo_surface_t *surface;
+      bool valid;
+    };
+
+    int _tile_size; // in pixels
+    size_t _max_tiles;
+    double _zoom;
+    std::map<std::pair<int, int>, Tile> _tiles;
+
+    base::Rect tile_bounds(int x, int y) const;
+    void drop_tiles_outside(int left, int top, int right, int bottom);
+  };
+
+} // end of mdc namespace
+
+#endif /* _MDC_TILE_CACHE_H_ */
@@ -250,6 +250,24 @@ class MySQLResult:
 
     def fieldType(self, i):
         return modules.DbMySQLQuery.resultFieldType(self.result, i)
+
+    def fieldIndex(self, name):
+        return modules.DbMySQLQuery.resultFieldIndex(self.result, name)
+
+    def fetchRows(self, count=1000):
+        return modules.DbMySQLQuery.resultFetchRows(self.result, count)
+
+    def fetchColumns(self, count=1000):
+        return modules.DbMySQLQuery.resultFetchColumns(self.result, count)
+
+    def rows(self, batch_size=1000):
+        """Iterates over the remaining rows of the result, fetching them from the module in batches."""
+        while True:
+            batch = modules.DbMySQLQuery.resultFetchRows(self.result, batch_size)
+            if not batch:
+                break
+            for row in batch:
+                yield row
         
 
 class MySQLConnection:
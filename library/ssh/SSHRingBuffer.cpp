@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include "SSHRingBuffer.h"
+
+#include <algorithm>
+
+namespace ssh {
+
+  RingBuffer::RingBuffer(std::size_t capacity) : _data(capacity > 0 ? capacity : 1), _start(0), _size(0) {
+  }
+
+  std::size_t RingBuffer::capacity() const {
+    return _data.size();
+  }
+
+  std::size_t RingBuffer::size() const {
+    return _size;
+  }
+
+  bool RingBuffer::empty() const {
+    return _size == 0;
+  }
+
+  bool RingBuffer::full() const {
+    return _size == _data.size();
+  }
+
+  void RingBuffer::clear() {
+    _start = 0;
+    _size = 0;
+  }
+
+  char *RingBuffer::writePtr() {
+    return _data.data() + (_start + _size) % _data.size();
+  }
+
+  std::size_t RingBuffer::writeSize() const {
+    std::size_t end = (_start + _size) % _data.size();
+    if (full())
+      return 0;
+    if (end < _start)
+      return _start - end;
+    return _data.size() - end;
+  }
+
+  void RingBuffer::commit(std::size_t count) {
+    _size += count;
+  }
+
+  const char *RingBuffer::readPtr() const {
+    return _data.data() + _start;
+  }
+
+  std::size_t RingBuffer::readSize() const {
+    return std::min(_size, _data.size() - _start);
+  }
+
+  void RingBuffer::consume(std::size_t count) {
+    _size -= count;
+    // Start over at the beginning when empty, which gives the largest possible block to the next write.
+    _start = _size == 0 ? 0 : (_start + count) % _data.size();
+  }
+
+} /* namespace ssh */
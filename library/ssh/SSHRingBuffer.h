@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "SSHCommon.h"
+
+namespace ssh {
+
+  /**
+   * Fixed size byte queue which keeps the data between a client socket and an ssh channel of a tunnel. Data is
+   * added and taken in contiguous blocks, so they can be passed directly to recv()/send() and the channel
+   * functions without an intermediate copy.
+   */
+  class WBSSHLIBRARY_PUBLIC_FUNC RingBuffer {
+  public:
+    explicit RingBuffer(std::size_t capacity);
+
+    std::size_t capacity() const;
+    std::size_t size() const;
+    bool empty() const;
+    bool full() const;
+    void clear();
+
+    // Free space at the write position. Fill it and call commit() with the number of bytes written.
+    char *writePtr();
+    std::size_t writeSize() const;
+    void commit(std::size_t count);
+
+    // Data at the read position. Call consume() with the number of bytes processed.
+    const char *readPtr() const;
+    std::size_t readSize() const;
+    void consume(std::size_t count);
+
+  private:
+    std::vector<char> _data;
+    std::size_t _start;
+    std::size_t _size;
+  };
+
+} /* namespace ssh */
@@ -21,32 +21,115 @@
  * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#ifndef _MSC_VER
+#  include <sys/socket.h>
+#  include <netinet/in.h>
+#  include <arpa/inet.h>
+#endif
+#include <algorithm>
+
 #include "SSHTunnelHandler.h"
 
 #include "base/log.h"
 
 DEFAULT_LOG_DOMAIN("SSHTunnelHandler")
 
-#ifndef MSG_NOSIGNAL
-#  if _MSC_VER
-#     define MSG_NOSIGNAL 0
-#  else
-#    define MSG_NOSIGNAL 0x4000
-#  endif
-#endif
+// The longest time the event loop sleeps. New connections, stop requests and all socket and channel activity wake
+// it up earlier, so this only limits how late a broken session is noticed.
+#define EVENT_POLL_TIMEOUT 1000
 
 namespace ssh {
 
+  // Relays a tunnel over a forwarding channel of the session. The channel is polled with the session,
+  // its callbacks report the activity.
+  class ForwardChannel : public TunnelChannel {
+  public:
+    explicit ForwardChannel(std::unique_ptr<ssh::Channel> channel) : _channel(std::move(channel)) {
+      memset(&_callbacks, 0, sizeof(_callbacks));
+      _callbacks.userdata = this;
+      _callbacks.channel_data_function = onChannelData;
+      _callbacks.channel_eof_function = onChannelClosed;
+      _callbacks.channel_close_function = onChannelClosed;
+      ssh_callbacks_init(&_callbacks);
+    }
+
+    virtual bool attach(ssh_event event, std::function<void()> activity) override {
+      _activity = std::move(activity);
+      return ssh_set_channel_callbacks(_channel->getCChannel(), &_callbacks) == SSH_OK;
+    }
+
+    virtual void detach(ssh_event event) override {
+      ssh_remove_channel_callbacks(_channel->getCChannel(), &_callbacks);
+      _activity = nullptr;
+    }
+
+    virtual int write(const char *data, std::size_t size) override {
+      try {
+        return _channel->write(data, size);
+      } catch (SshException &exc) {
+        throw SSHTunnelException(exc.getError());
+      }
+    }
+
+    virtual int read(char *buffer, std::size_t size) override {
+      try {
+        return _channel->readNonblocking(buffer, size);
+      } catch (SshException &exc) {
+        throw SSHTunnelException(exc.getError());
+      }
+    }
+
+    virtual bool isClosed() override {
+      return _channel->isClosed();
+    }
+
+    virtual bool isEof() override {
+      return _channel->isEof();
+    }
+
+    virtual void close() override {
+      try {
+        _channel->close();
+      } catch (SshException &exc) {
+        logDebug2("Error closing channel: %s\n", exc.getError().c_str());
+      }
+    }
+
+  private:
+    // Channel data is left in the channel (returning 0 bytes consumed) and read once the client can take it.
+    // libssh doesn't grow the channel window while data is pending, which throttles the remote end.
+    static int onChannelData(ssh_session session, ssh_channel channel, void *data, uint32_t len, int isStderr,
+                             void *userdata) {
+      static_cast<ForwardChannel *>(userdata)->notify();
+      return 0;
+    }
+
+    static void onChannelClosed(ssh_session session, ssh_channel channel, void *userdata) {
+      static_cast<ForwardChannel *>(userdata)->notify();
+    }
+
+    void notify() {
+      if (_activity)
+        _activity();
+    }
+
+    std::unique_ptr<ssh::Channel> _channel;
+    ssh_channel_callbacks_struct _callbacks;
+    std::function<void()> _activity;
+  };
+
+  //--------------------------------------------------------------------------------------------------------------------
+
   SSHTunnelHandler::SSHTunnelHandler(uint16_t localPort, int localSocket, std::shared_ptr<SSHSession> session)
-      : _session(std::move(session)), _localPort(localPort), _localSocket(localSocket), _pollTimeout(-1) {
-    _event = ssh_event_new();
-    ssh_event_add_session(_event, _session->getSession()->getCSession());
+      : _session(std::move(session)), _localPort(localPort), _localSocket(localSocket),
+        _relay((std::size_t)std::max(_session->getConfig().bufferSize, (ssize_t)1)) {
+    ssh_event_add_session(_relay.getEvent(), _session->getSession()->getCSession());
   }
 
   SSHTunnelHandler::~SSHTunnelHandler() {
     stop();
-    ssh_event_remove_session(_event, _session->getSession()->getCSession());
-    ssh_event_free(_event);
+    _relay.closeAllTunnels();
+    ssh_event_remove_session(_relay.getEvent(), _session->getSession()->getCSession());
     if (_session) {
       _session->disconnect();
       _session.reset();
@@ -66,83 +149,52 @@ namespace ssh {
     return _session->getConfig();
   }
 
+  void SSHTunnelHandler::stop() {
+    _stop = true;
+    _relay.stop();
+    SSHThread::stop();
+  }
+
   void SSHTunnelHandler::run() {
     handleConnection();
   }
 
-  // This is noop function so ssh_even_dopoll will exit once client socket will have new data
-
-    static int onSocketEvent(socket_t fd, int revents, void *userdata) {
-      //the return should be:
-      //  0 success
-      // -1 the internal ssh_poll_handle was removed/freed and should be removed from the context
-      // -2 an error happened and the ssh_event_dopoll() should stop
-      return 0;
-    }
+  //--------------------------------------------------------------------------------------------------------------------
 
   void SSHTunnelHandler::handleConnection() {
     logDebug3("Start tunnel handler thread.\n");
     int rc = 0;
 
     do {
-      std::unique_lock<std::recursive_mutex> lock(_newConnMtx);
-      if(!_newConnection.empty()) {
-        prepareTunnel(_newConnection.back());
-        _newConnection.pop_back();
+      std::vector<int> newConnections;
+      {
+        std::lock_guard<std::recursive_mutex> lock(_newConnMtx);
+        newConnections.swap(_newConnection);
       }
-      lock.unlock();
-      rc = ssh_event_dopoll(_event, 100);
+      for (auto clientSocket : newConnections)
+        prepareTunnel(clientSocket);
+
+      rc = _relay.poll(EVENT_POLL_TIMEOUT);
 
       if (rc == SSH_ERROR) {
         logError("There was an error handling connection poll, retrying: %s\n", _session->getSession()->getError());
 
-        for (auto &sIt : _clientSocketList) {
-          ssh_event_remove_fd(_event, sIt.first);
-          sIt.second->close();
-          wbCloseSocket(sIt.first);
-          sIt.second.reset();
-        }
-        _clientSocketList.clear();
-
-        ssh_event_remove_session(_event, _session->getSession()->getCSession());
-        ssh_event_free(_event);
+        ssh_event_remove_session(_relay.getEvent(), _session->getSession()->getCSession());
+        _relay.resetEvent();
 
         if (!_session->isConnected())
           _session->reconnect();
+
+        ssh_event_add_session(_relay.getEvent(), _session->getSession()->getCSession());
+
         if (!_session->isConnected()) {
           logError("Unable to reconnect session.\n");
           break;
         }
-
-        _event = ssh_event_new();
-        ssh_event_add_session(_event, _session->getSession()->getCSession());
-        continue;
       }
-
-      for (auto it = _clientSocketList.begin(); it != _clientSocketList.end() && !_stop;) {
-        try {
-          transferDataFromClient(it->first, it->second.get());
-          transferDataToClient(it->first, it->second.get());
-          ++it;
-        } catch (SSHTunnelException &exc) {
-            ssh_event_remove_fd(_event, it->first);
-            it->second->close();
-            it->second.reset();
-            wbCloseSocket(it->first);
-            it = _clientSocketList.erase(it);
-          logError("Error during data transfer: %s\n", exc.what());
-        }
-      }
-
     } while (!_stop);
 
-    for (auto &sIt : _clientSocketList) {
-      ssh_event_remove_fd(_event, sIt.first);
-      sIt.second->close();
-      wbCloseSocket(sIt.first);
-      sIt.second.reset();
-    }
-    _clientSocketList.clear();
+    _relay.closeAllTunnels();
     logDebug3("Tunnel handler thread stopped.\n");
   }
 
@@ -162,55 +214,11 @@ namespace ssh {
 
     std::lock_guard<std::recursive_mutex> guard(_newConnMtx);
     _newConnection.push_back(clientSock);
+    _relay.wakeup();
     logDebug3("Accepted new connection.\n");
   }
 
-  void SSHTunnelHandler::transferDataFromClient(int sock, ssh::Channel *chan) {
-    ssize_t readlen = 0;
-    std::vector<char> buff(_session->getConfig().bufferSize, '\0');
-
-    while (!_stop && (readlen = recv(sock, buff.data(), buff.size(), 0)) > 0) {
-      int bWritten = 0;
-      for (char* buffPtr = buff.data(); readlen > 0 && !_stop; buffPtr += bWritten, readlen -= bWritten) {
-        try {
-          bWritten = chan->write(buffPtr, readlen);
-          if (bWritten <= 0) {
-            throw SSHTunnelException("unable to write, remote end disconnected");
-          }
-        } catch (SshException &exc) {
-          throw SSHTunnelException(exc.getError());
-        }
-      }
-    }
-  }
-
-  void SSHTunnelHandler::transferDataToClient(int sock, ssh::Channel *chan) {
-    ssize_t readlen = 0;
-    std::vector<char> buff(_session->getConfig().bufferSize, '\0');
-    do {
-      try {
-        readlen = chan->readNonblocking(buff.data(), buff.size());
-      } catch (SshException &exc) {
-        throw SSHTunnelException(exc.getError());
-      }
-
-      if (readlen < 0 && readlen != SSH_AGAIN)
-        throw SSHTunnelException("unable to read, remote end disconnected");
-
-      if (readlen == 0) {
-        if (chan->isClosed())
-          throw SSHTunnelException("channel is closed");
-        break;
-      }
-
-      ssize_t bWritten = 0;
-      for (char* buffPtr = buff.data(); readlen > 0 && !_stop; buffPtr += bWritten, readlen -= bWritten) {
-        bWritten = send(sock, buffPtr, readlen, MSG_NOSIGNAL);
-        if (bWritten <= 0)
-          throw SSHTunnelException("unable to write, client disconnected");
-      }
-    } while (!_stop && true);
-  }
+  //--------------------------------------------------------------------------------------------------------------------
 
   std::unique_ptr<ssh::Channel> SSHTunnelHandler::openTunnel() {
     std::unique_ptr<ssh::Channel> channel(new ssh::Channel(*(_session->getSession())));
@@ -253,18 +261,13 @@ namespace ssh {
       return;
     }
 
-    short events = POLLIN;
-    if (ssh_event_add_fd(_event, clientSocket, events, onSocketEvent, this) != SSH_OK) {
+    std::unique_ptr<TunnelChannel> forward(new ForwardChannel(std::move(channel)));
+    if (!_relay.addTunnel(clientSocket, std::move(forward))) {
       logError("Unable to open tunnel. Could not register event handler.\n");
-      channel.reset();
-      wbCloseSocket(clientSocket);
       return;
-    } else {
-      logDebug("Tunnel created.\n");
     }
 
-    _clientSocketList.insert(std::make_pair(clientSocket, std::move(channel)));
-    return;
+    logDebug("Tunnel created.\n");
   }
 
 } /* namespace ssh */
@@ -29,11 +29,11 @@
 #endif
 #include <string.h>
 #include <thread>
-#include <map>
 #include <mutex>
 #include <vector>
 #include "SSHCommon.h"
 #include "SSHSession.h"
+#include "SSHTunnelRelay.h"
 
 namespace ssh {
   class WBSSHLIBRARY_PUBLIC_FUNC SSHTunnelHandler : public SSHThread {
@@ -44,10 +44,10 @@ namespace ssh {
     int getLocalPort() const;
     SSHConnectionConfig getConfig() const;
 
+    virtual void stop() override;
+
     void handleConnection();
     void handleNewConnection(int incomingSocket);
-    void transferDataFromClient(int sock, ssh::Channel *chan);
-    void transferDataToClient(int sock, ssh::Channel *chan);
 
     std::unique_ptr<ssh::Channel> openTunnel();
     void prepareTunnel(int clientSocket);
@@ -58,10 +58,7 @@ namespace ssh {
     std::shared_ptr<SSHSession> _session;
     uint16_t _localPort;
     int _localSocket;
-    std::map<int, std::unique_ptr<ssh::Channel>> _clientSocketList;
-    int _pollTimeout;
-    ssh_event _event;
-    std::vector<int> _sockRemovalList;
+    TunnelRelay _relay;
     std::recursive_mutex _newConnMtx;
     std::vector<int> _newConnection;
   };
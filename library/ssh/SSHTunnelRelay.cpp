@@ -0,0 +1,401 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#ifndef _MSC_VER
+#  include <sys/socket.h>
+#  include <netinet/in.h>
+#  include <arpa/inet.h>
+#endif
+#include <algorithm>
+
+#include "SSHTunnelRelay.h"
+
+#include "base/log.h"
+
+DEFAULT_LOG_DOMAIN("SSHTunnelRelay")
+
+#ifndef MSG_NOSIGNAL
+#  if _MSC_VER
+#     define MSG_NOSIGNAL 0
+#  else
+#    define MSG_NOSIGNAL 0x4000
+#  endif
+#endif
+
+namespace ssh {
+
+  static bool wouldBlock() {
+#if _MSC_VER
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+  }
+
+  // Creates two connected loopback sockets. There's no socketpair() on Windows, so do it the same way everywhere.
+  void TunnelRelay::createSocketPair(int sockets[2]) {
+    sockets[0] = -1;
+    sockets[1] = -1;
+
+    errno = 0;
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    if (listener == -1)
+      throw SSHTunnelException("unable to create socket: " + getError());
+
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(struct sockaddr_in);
+    memset(&addr, 0, len);
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = inet_addr("127.0.0.1");
+    addr.sin_port = htons(0);
+
+    if (bind(listener, (struct sockaddr*) &addr, len) == 0 && getsockname(listener, (struct sockaddr*) &addr, &len) == 0
+      && listen(listener, 1) == 0) {
+      sockets[1] = socket(AF_INET, SOCK_STREAM, 0);
+      if (sockets[1] != -1 && connect(sockets[1], (struct sockaddr*) &addr, len) == 0)
+        sockets[0] = accept(listener, nullptr, nullptr);
+    }
+
+    std::string error = getError();
+    wbCloseSocket(listener);
+    if (sockets[0] == -1) {
+      if (sockets[1] != -1)
+        wbCloseSocket(sockets[1]);
+      throw SSHTunnelException("unable to create socket pair: " + error);
+    }
+
+    setSocketNonBlocking(sockets[0]);
+    setSocketNonBlocking(sockets[1]);
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  TunnelRelay::TunnelRelay(std::size_t bufferSize) : _bufferSize(std::max(bufferSize, (std::size_t)1)), _stop(false) {
+    createSocketPair(_wakeupSockets);
+    _event = ssh_event_new();
+    registerWakeupSocket();
+  }
+
+  TunnelRelay::~TunnelRelay() {
+    closeAllTunnels();
+    ssh_event_remove_fd(_event, _wakeupSockets[0]);
+    ssh_event_free(_event);
+    wbCloseSocket(_wakeupSockets[0]);
+    wbCloseSocket(_wakeupSockets[1]);
+  }
+
+  ssh_event TunnelRelay::getEvent() const {
+    return _event;
+  }
+
+  // Closes all tunnels and replaces the event by an empty one. Sessions added to the old event must be removed
+  // before.
+  void TunnelRelay::resetEvent() {
+    closeAllTunnels();
+    ssh_event_remove_fd(_event, _wakeupSockets[0]);
+    ssh_event_free(_event);
+
+    _event = ssh_event_new();
+    registerWakeupSocket();
+  }
+
+  void TunnelRelay::registerWakeupSocket() {
+    if (ssh_event_add_fd(_event, _wakeupSockets[0], POLLIN, onWakeupEvent, this) != SSH_OK)
+      logError("Could not register wakeup event handler.\n");
+  }
+
+  void TunnelRelay::wakeup() {
+    // If the socket buffer is full there's a wakeup pending already.
+    char c = 0;
+    send(_wakeupSockets[1], &c, 1, MSG_NOSIGNAL);
+  }
+
+  void TunnelRelay::stop() {
+    _stop = true;
+    wakeup();
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  // Event callbacks only note what happened, the actual transfer is done when ssh_event_dopoll() returned.
+  // The return value should be:
+  //   0 success
+  //  -1 the internal ssh_poll_handle was removed/freed and should be removed from the context
+  //  -2 an error happened and the ssh_event_dopoll() should stop
+  int TunnelRelay::onSocketEvent(socket_t fd, int revents, void *userdata) {
+    Tunnel *tunnel = static_cast<Tunnel *>(userdata);
+    if (revents & (POLLIN | POLLHUP | POLLERR))
+      tunnel->clientReadable = true;
+    tunnel->relay->markPending(*tunnel);
+    return 0;
+  }
+
+  int TunnelRelay::onWakeupEvent(socket_t fd, int revents, void *userdata) {
+    char buff[64];
+    while (recv(fd, buff, sizeof(buff), 0) > 0)
+      ;
+    return 0;
+  }
+
+  void TunnelRelay::markPending(Tunnel &tunnel) {
+    if (!tunnel.pending) {
+      tunnel.pending = true;
+      _pendingTunnels.push_back(&tunnel);
+    }
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  // Waits up to timeout ms for activity and relays the data of all tunnels which had some. Returns the result of
+  // ssh_event_dopoll(), nothing is transferred if that is SSH_ERROR.
+  int TunnelRelay::poll(int timeout) {
+    int rc = ssh_event_dopoll(_event, timeout);
+    if (rc == SSH_ERROR)
+      return rc;
+
+    // Only tunnels with socket or channel activity need to be looked at. Reading from a channel can trigger the
+    // callbacks of other channels, those go into the next round.
+    std::vector<Tunnel *> pending;
+    pending.swap(_pendingTunnels);
+    for (auto tunnel : pending)
+      tunnel->pending = false;
+
+    for (auto tunnel : pending) {
+      if (_stop)
+        break;
+
+      int clientSocket = tunnel->socket;
+      try {
+        transferDataFromClient(*tunnel);
+        transferDataToClient(*tunnel);
+        updateSocketEvents(*tunnel);
+
+        // Data still waiting for the channel means its window is used up. Try again after the next activity,
+        // which includes the window adjustment from the remote end.
+        if (!tunnel->toChannel->empty())
+          markPending(*tunnel);
+      } catch (SSHTunnelException &exc) {
+        closeTunnel(clientSocket);
+        logError("Error during data transfer: %s\n", exc.what());
+      }
+    }
+
+    return rc;
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  void TunnelRelay::transferDataFromClient(Tunnel &tunnel) {
+    RingBuffer &buffer = *tunnel.toChannel;
+
+    while (!_stop) {
+      // Pass on what's buffered first, as much as the channel window allows.
+      while (!buffer.empty()) {
+        int bWritten = tunnel.channel->write(buffer.readPtr(), buffer.readSize());
+        if (bWritten == 0 || bWritten == SSH_AGAIN) {
+          if (tunnel.channel->isClosed())
+            throw SSHTunnelException("unable to write, remote end disconnected");
+          break;
+        }
+        if (bWritten < 0)
+          throw SSHTunnelException("unable to write, remote end disconnected");
+        buffer.consume(bWritten);
+      }
+
+      // Keep reading while the channel is blocked, until the buffer is full. Only then the socket is no longer
+      // polled for reading, otherwise its pending data would wake up the event loop over and over.
+      if (!tunnel.clientReadable || buffer.full())
+        return;
+
+      errno = 0;
+      ssize_t readlen = recv(tunnel.socket, buffer.writePtr(), buffer.writeSize(), 0);
+      if (readlen == 0)
+        throw SSHTunnelException("client disconnected");
+      if (readlen < 0) {
+        if (wouldBlock()) {
+          tunnel.clientReadable = false;
+          return;
+        }
+        throw SSHTunnelException("unable to read, client disconnected: " + getError());
+      }
+      buffer.commit(readlen);
+    }
+  }
+
+  void TunnelRelay::transferDataToClient(Tunnel &tunnel) {
+    RingBuffer &buffer = *tunnel.toClient;
+
+    while (!_stop) {
+      while (!buffer.empty()) {
+        errno = 0;
+        ssize_t bWritten = send(tunnel.socket, buffer.readPtr(), buffer.readSize(), MSG_NOSIGNAL);
+        if (bWritten < 0 && wouldBlock())
+          return; // Continues once the socket reports it's writable again.
+        if (bWritten <= 0)
+          throw SSHTunnelException("unable to write, client disconnected");
+        buffer.consume(bWritten);
+      }
+
+      if (!tunnel.channelReadable)
+        return;
+
+      int readlen = tunnel.channel->read(buffer.writePtr(), buffer.writeSize());
+      if (readlen < 0 && readlen != SSH_AGAIN)
+        throw SSHTunnelException("unable to read, remote end disconnected");
+
+      if (readlen <= 0) {
+        if (tunnel.channel->isClosed() || tunnel.channel->isEof())
+          throw SSHTunnelException("channel is closed");
+        tunnel.channelReadable = false;
+        return;
+      }
+      buffer.commit(readlen);
+    }
+  }
+
+  // The client socket is only polled for reading while there's room to buffer what it sends, and for writing
+  // while it has data to take. Everything else is back pressure which stops the other side.
+  void TunnelRelay::updateSocketEvents(Tunnel &tunnel) {
+    short events = 0;
+    if (!tunnel.toChannel->full())
+      events |= POLLIN;
+    if (!tunnel.toClient->empty())
+      events |= POLLOUT;
+
+    if (events == tunnel.events)
+      return;
+
+    if (tunnel.events != 0)
+      ssh_event_remove_fd(_event, tunnel.socket);
+    tunnel.events = 0;
+
+    if (events != 0) {
+      if (ssh_event_add_fd(_event, tunnel.socket, events, onSocketEvent, &tunnel) != SSH_OK)
+        throw SSHTunnelException("could not register event handler");
+      tunnel.events = events;
+    }
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  std::unique_ptr<RingBuffer> TunnelRelay::acquireBuffer() {
+    if (_bufferPool.empty())
+      return std::unique_ptr<RingBuffer>(new RingBuffer(_bufferSize));
+
+    std::unique_ptr<RingBuffer> buffer = std::move(_bufferPool.back());
+    _bufferPool.pop_back();
+    return buffer;
+  }
+
+  void TunnelRelay::releaseBuffer(std::unique_ptr<RingBuffer> buffer) {
+    if (buffer) {
+      buffer->clear();
+      _bufferPool.push_back(std::move(buffer));
+    }
+  }
+
+  // Takes over the client socket and the channel. Both are closed if the tunnel can't be set up.
+  bool TunnelRelay::addTunnel(int clientSocket, std::unique_ptr<TunnelChannel> channel) {
+    std::unique_ptr<Tunnel> tunnel(new Tunnel());
+    tunnel->relay = this;
+    tunnel->socket = clientSocket;
+    tunnel->channel = std::move(channel);
+    tunnel->toChannel = acquireBuffer();
+    tunnel->toClient = acquireBuffer();
+    tunnel->events = 0;
+    tunnel->clientReadable = false;
+    tunnel->channelReadable = false;
+    tunnel->pending = false;
+
+    Tunnel &created = *tunnel;
+    _tunnels.insert(std::make_pair(clientSocket, std::move(tunnel)));
+
+    bool registered = created.channel->attach(_event, [this, &created]() {
+      created.channelReadable = true;
+      markPending(created);
+    });
+    if (registered) {
+      try {
+        updateSocketEvents(created);
+      } catch (SSHTunnelException &) {
+        registered = false;
+      }
+    }
+
+    if (!registered) {
+      closeTunnel(clientSocket);
+      return false;
+    }
+    return true;
+  }
+
+  void TunnelRelay::closeTunnel(int clientSocket) {
+    auto it = _tunnels.find(clientSocket);
+    if (it == _tunnels.end())
+      return;
+
+    Tunnel &tunnel = *it->second;
+    if (tunnel.events != 0)
+      ssh_event_remove_fd(_event, clientSocket);
+    if (tunnel.pending)
+      _pendingTunnels.erase(std::remove(_pendingTunnels.begin(), _pendingTunnels.end(), &tunnel),
+                            _pendingTunnels.end());
+
+    // The channel may outlive the tunnel (libssh keeps it until the remote end confirms the close), so it must
+    // stop reporting activity first.
+    tunnel.channel->detach(_event);
+    tunnel.channel->close();
+    tunnel.channel.reset();
+    wbCloseSocket(clientSocket);
+
+    releaseBuffer(std::move(tunnel.toChannel));
+    releaseBuffer(std::move(tunnel.toClient));
+    _tunnels.erase(it);
+  }
+
+  void TunnelRelay::closeAllTunnels() {
+    while (!_tunnels.empty())
+      closeTunnel(_tunnels.begin()->first);
+    _pendingTunnels.clear();
+  }
+
+  std::size_t TunnelRelay::tunnelCount() const {
+    return _tunnels.size();
+  }
+
+  bool TunnelRelay::getStatus(int clientSocket, Status &status) const {
+    auto it = _tunnels.find(clientSocket);
+    if (it == _tunnels.end())
+      return false;
+
+    const Tunnel &tunnel = *it->second;
+    status.events = tunnel.events;
+    status.clientReadable = tunnel.clientReadable;
+    status.channelReadable = tunnel.channelReadable;
+    status.pending = tunnel.pending;
+    status.toChannel = tunnel.toChannel->size();
+    status.toClient = tunnel.toClient->size();
+    return true;
+  }
+
+} /* namespace ssh */
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "SSHCommon.h"
+#include "SSHRingBuffer.h"
+
+namespace ssh {
+
+  /**
+   * The remote end of a tunnel as seen by the relay. For ssh tunnels this is a forwarding channel of the session,
+   * anything with the same behavior can be relayed too (which is how the relay is tested and benchmarked).
+   */
+  class WBSSHLIBRARY_PUBLIC_FUNC TunnelChannel {
+  public:
+    virtual ~TunnelChannel() {}
+
+    // Registers the channel with the event. The callback must be called from within ssh_event_dopoll() whenever
+    // new data arrived, the remote end closed the channel or a write that returned SSH_AGAIN can be retried.
+    virtual bool attach(ssh_event event, std::function<void()> activity) = 0;
+    virtual void detach(ssh_event event) = 0;
+
+    // Both return the number of bytes transferred, 0 or SSH_AGAIN if nothing can be transferred right now and
+    // a negative value on errors. Failures may also be reported with an SSHTunnelException.
+    virtual int write(const char *data, std::size_t size) = 0;
+    virtual int read(char *buffer, std::size_t size) = 0;
+
+    virtual bool isClosed() = 0;
+    virtual bool isEof() = 0;
+    virtual void close() = 0;
+  };
+
+  /**
+   * Moves data between client sockets and their channels, driven by a single ssh_event. All socket and channel
+   * callbacks only mark the tunnel as pending, the transfer is done for the pending tunnels after the poll returned.
+   * Each direction is buffered in a ring buffer of the configured size. A full buffer stops reading from its source
+   * (back pressure), so neither side can make the relay use more memory.
+   *
+   * Except for wakeup() and stop() everything must be called from the thread which calls poll().
+   */
+  class WBSSHLIBRARY_PUBLIC_FUNC TunnelRelay {
+  public:
+    // The state of a tunnel, for diagnostics and tests.
+    struct Status {
+      short events;         // The poll events the client socket is registered for.
+      bool clientReadable;
+      bool channelReadable;
+      bool pending;
+      std::size_t toChannel; // Buffered bytes in each direction.
+      std::size_t toClient;
+    };
+
+    explicit TunnelRelay(std::size_t bufferSize);
+    ~TunnelRelay();
+
+    ssh_event getEvent() const;
+    void resetEvent();
+
+    bool addTunnel(int clientSocket, std::unique_ptr<TunnelChannel> channel);
+    void closeTunnel(int clientSocket);
+    void closeAllTunnels();
+    std::size_t tunnelCount() const;
+    bool getStatus(int clientSocket, Status &status) const;
+
+    int poll(int timeout);
+    void wakeup();
+    void stop();
+
+    static void createSocketPair(int sockets[2]);
+
+  private:
+    // A client connection and the channel it is forwarded to.
+    struct Tunnel {
+      TunnelRelay *relay;
+      int socket;
+      std::unique_ptr<TunnelChannel> channel;
+      std::unique_ptr<RingBuffer> toChannel; // Data received from the client, not yet written to the channel.
+      std::unique_ptr<RingBuffer> toClient;  // Data read from the channel, not yet sent to the client.
+      short events;         // The poll events the socket is currently registered for, 0 if not registered.
+      bool clientReadable;  // Set by the socket callback, reset once recv() would block.
+      bool channelReadable; // Set by the channel callback, reset once the channel has no more data.
+      bool pending;         // Whether the tunnel is in _pendingTunnels.
+    };
+
+    void transferDataFromClient(Tunnel &tunnel);
+    void transferDataToClient(Tunnel &tunnel);
+    void updateSocketEvents(Tunnel &tunnel);
+    void markPending(Tunnel &tunnel);
+    void registerWakeupSocket();
+
+    std::unique_ptr<RingBuffer> acquireBuffer();
+    void releaseBuffer(std::unique_ptr<RingBuffer> buffer);
+
+    static int onSocketEvent(socket_t fd, int revents, void *userdata);
+    static int onWakeupEvent(socket_t fd, int revents, void *userdata);
+
+    std::size_t _bufferSize;
+    std::map<int, std::unique_ptr<Tunnel>> _tunnels;
+    std::vector<Tunnel *> _pendingTunnels;
+    std::vector<std::unique_ptr<RingBuffer>> _bufferPool;
+    int _wakeupSockets[2]; // Read and write end, used to interrupt the event poll from other threads.
+    ssh_event _event;
+    std::atomic<bool> _stop;
+  };
+
+} /* namespace ssh */
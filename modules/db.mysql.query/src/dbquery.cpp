@@ -30,6 +30,7 @@
 #include "grts/structs.db.mgmt.h"
 
 #include "wb_tunnel.h"
+#include "result_batch.h"
 
 #define DOC_DbMySQLQueryImpl                                                       \
   "Query execution and utility routines for  MySQL servers.\n"                     \
@@ -150,6 +151,32 @@ public:
                                 "Returns the string value in the given field of the resultset.",
                                 "result_id the resultset identifier, returned by executeQuery()\n"
                                 "name the name of the resultset field"),
+    DECLARE_MODULE_FUNCTION_DOC(DbMySQLQueryImpl::resultFieldIndex,
+                                "Returns the index of the field with the given name, for use with the result* "
+                                "functions taking a field index. Names are resolved only once per resultset.",
+                                "result_id the resultset identifier, returned by executeQuery()\n"
+                                "name the name of the resultset field"),
+    DECLARE_MODULE_FUNCTION_DOC(
+      DbMySQLQueryImpl::resultFetchRows,
+      "Advances the resultset by up to count rows and returns them as a list of rows, each a list with the values "
+      "of the row. Integer columns give integers, floating point columns floats and all others strings. NULL values "
+      "are returned as None. An empty list is returned at the end of the resultset.\n"
+      "This is much faster than reading values one by one with resultNextRow() and the resultField* functions.\n"
+      "Sample usage:\n"
+      "    rows = DbMySQLQuery.resultFetchRows(res, 1000)\n"
+      "    while rows:\n"
+      "        for row in rows:\n"
+      "            print row[0]\n"
+      "        rows = DbMySQLQuery.resultFetchRows(res, 1000)",
+      "result_id the resultset identifier, returned by executeQuery()\n"
+      "count the maximum number of rows to return"),
+    DECLARE_MODULE_FUNCTION_DOC(
+      DbMySQLQueryImpl::resultFetchColumns,
+      "Advances the resultset by up to count rows and returns them column wise, as a list with one list of values "
+      "per field. Integer columns give integer lists, floating point columns float lists and all others string lists. "
+      "NULL values are returned as None. The lists are empty at the end of the resultset.",
+      "result_id the resultset identifier, returned by executeQuery()\n"
+      "count the maximum number of rows to return"),
     DECLARE_MODULE_FUNCTION_DOC(DbMySQLQueryImpl::closeResult, "Closes the resultset freeing associated resources.",
                                 "result_id the resultset identifier, returned by executeQuery()"),
     DECLARE_MODULE_FUNCTION_DOC(DbMySQLQueryImpl::loadSchemata, "Deprecated.", ""),
@@ -212,6 +239,10 @@ public:
   double resultFieldDoubleValueByName(int result, const std::string &field);
   grt::StringRef resultFieldStringValueByName(int result, const std::string &field);
 
+  int resultFieldIndex(int result, const std::string &name);
+  grt::BaseListRef resultFetchRows(int result, int count);
+  grt::BaseListRef resultFetchColumns(int result, int count);
+
   int closeResult(int result);
 
   int loadSchemata(int conn, grt::StringListRef schemata);
@@ -261,6 +292,7 @@ private:
   base::Mutex _mutex;
   std::map<int, ConnectionInfo::Ref> _connections;
   std::map<int, sql::ResultSet *> _resultsets;
+  std::map<int, dbquery::ResultColumns> _result_columns;
   std::map<int, std::shared_ptr<wb::SSHTunnel> > _tunnels;
   std::string _last_error;
   int _last_error_code;
@@ -268,6 +300,9 @@ private:
   int _connection_id;
   base::refcount_t _resultset_id;
   int _tunnel_id;
+
+  sql::ResultSet *get_resultset(int result);
+  const dbquery::ResultColumns &get_result_columns(int result);
 };
 
 GRT_MODULE_ENTRY_POINT(DbMySQLQueryImpl);
@@ -614,10 +649,11 @@ grt::IntegerRef DbMySQLQueryImpl::resultFieldIntValueByName(int result, const st
   if (res == NULL)
     throw std::invalid_argument("Invalid resultset");
 
-  if (res->isNull(field))
+  int index = get_result_columns(result).indexOf(field);
+  if (res->isNull(index))
     return grt::IntegerRef(0);
   else
-    return grt::IntegerRef(res->getInt(field));
+    return grt::IntegerRef(res->getInt(index));
 }
 
 double DbMySQLQueryImpl::resultFieldDoubleValueByName(int result, const std::string &field) {
@@ -628,7 +664,7 @@ double DbMySQLQueryImpl::resultFieldDoubleValueByName(int result, const std::str
   if (res == NULL)
     throw std::invalid_argument("Invalid resultset");
 
-  return (double)res->getDouble(field);
+  return (double)res->getDouble(get_result_columns(result).indexOf(field));
 }
 
 grt::StringRef DbMySQLQueryImpl::resultFieldStringValueByName(int result, const std::string &field) {
@@ -639,10 +675,80 @@ grt::StringRef DbMySQLQueryImpl::resultFieldStringValueByName(int result, const
   if (res == NULL)
     throw std::invalid_argument("Invalid resultset");
 
-  if (res->isNull(field))
+  int index = get_result_columns(result).indexOf(field);
+  if (res->isNull(index))
     return grt::StringRef();
   else
-    return grt::StringRef(res->getString(field));
+    return grt::StringRef(res->getString(index));
+}
+
+int DbMySQLQueryImpl::resultFieldIndex(int result, const std::string &name) {
+  base::MutexLock lock(_mutex);
+  get_resultset(result);
+  return get_result_columns(result).indexOf(name);
+}
+
+grt::BaseListRef DbMySQLQueryImpl::resultFetchRows(int result, int count) {
+  base::MutexLock lock(_mutex);
+  sql::ResultSet *res = get_resultset(result);
+  if (count < 1)
+    throw std::invalid_argument("Invalid row count");
+  return dbquery::fetchRows(*res, get_result_columns(result), count);
+}
+
+grt::BaseListRef DbMySQLQueryImpl::resultFetchColumns(int result, int count) {
+  base::MutexLock lock(_mutex);
+  sql::ResultSet *res = get_resultset(result);
+  if (count < 1)
+    throw std::invalid_argument("Invalid row count");
+  return dbquery::fetchColumns(*res, get_result_columns(result), count);
+}
+
+// Must be called with _mutex locked.
+sql::ResultSet *DbMySQLQueryImpl::get_resultset(int result) {
+  std::map<int, sql::ResultSet *>::const_iterator iterator = _resultsets.find(result);
+  if (iterator == _resultsets.end() || iterator->second == NULL)
+    throw std::invalid_argument("Invalid resultset");
+  return iterator->second;
+}
+
+// Must be called with _mutex locked and for a valid result.
+const dbquery::ResultColumns &DbMySQLQueryImpl::get_result_columns(int result) {
+  std::map<int, dbquery::ResultColumns>::const_iterator iterator = _result_columns.find(result);
+  if (iterator != _result_columns.end())
+    return iterator->second;
+
+  dbquery::ResultColumns &columns = _result_columns[result];
+  sql::ResultSetMetaData *meta = _resultsets[result]->getMetaData();
+  unsigned int count = meta->getColumnCount();
+  for (unsigned int i = 1; i <= count; ++i) {
+    dbquery::ColumnKind kind = dbquery::StringColumn;
+    switch (meta->getColumnType(i)) {
+      case sql::DataType::TINYINT:
+      case sql::DataType::SMALLINT:
+      case sql::DataType::MEDIUMINT:
+      case sql::DataType::INTEGER:
+      case sql::DataType::YEAR:
+        kind = dbquery::IntegerColumn;
+        break;
+
+      case sql::DataType::BIGINT:
+        // Unsigned values beyond the signed range would not survive the conversion to a GRT integer.
+        kind = meta->isSigned(i) ? dbquery::IntegerColumn : dbquery::StringColumn;
+        break;
+
+      case sql::DataType::REAL:
+      case sql::DataType::DOUBLE:
+        kind = dbquery::DoubleColumn;
+        break;
+
+      default: // DECIMAL keeps its precision as string, everything else is text anyway.
+        break;
+    }
+    columns.add(meta->getColumnLabel(i), kind);
+  }
+
+  return columns;
 }
 
 int DbMySQLQueryImpl::closeResult(int result) {
@@ -652,6 +758,7 @@ int DbMySQLQueryImpl::closeResult(int result) {
   sql::ResultSet *res = _resultsets[result];
   delete res;
   _resultsets.erase(result);
+  _result_columns.erase(result);
   return 0;
 }
 
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#pragma once
+
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "grt.h"
+#include "base/string_utilities.h"
+
+// Batched reading of query results for the DbMySQLQuery module. Instead of one module call per row and field,
+// scripts get many rows per call, as rows or as columns. The functions work on any type with the row access
+// subset of sql::ResultSet (next(), isNull(), getInt64(), getDouble() and getString() with 1 based indexes).
+
+namespace dbquery {
+
+  // The GRT type the values of a result column are returned as.
+  enum ColumnKind { IntegerColumn, DoubleColumn, StringColumn };
+
+  /**
+   * What is resolved once per result instead of for every value: the kind of each column and the index
+   * of each column label. Lookups by name are case insensitive, like in the connector.
+   */
+  struct ResultColumns {
+    std::vector<ColumnKind> kinds;
+    std::map<std::string, int> indexes; // Upper case label -> 1 based column index.
+
+    void add(const std::string &label, ColumnKind kind) {
+      kinds.push_back(kind);
+      indexes.emplace(base::toupper(label), (int)kinds.size()); // For duplicate labels the first one wins.
+    }
+
+    int indexOf(const std::string &label) const {
+      auto iterator = indexes.find(base::toupper(label));
+      if (iterator == indexes.end())
+        throw std::invalid_argument("Invalid field name: " + label);
+      return iterator->second;
+    }
+  };
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  template <class ResultSet>
+  grt::ValueRef fieldValue(ResultSet &result, ColumnKind kind, uint32_t column) {
+    if (result.isNull(column))
+      return grt::ValueRef();
+
+    switch (kind) {
+      case IntegerColumn:
+        return grt::IntegerRef((ssize_t)result.getInt64(column));
+      case DoubleColumn:
+        return grt::DoubleRef((double)result.getDouble(column));
+      default:
+        return grt::StringRef(result.getString(column));
+    }
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  /**
+   * Advances the result by up to count rows and returns them as a list of rows, each a list of the row's values.
+   * NULL values are returned as None. An empty list means the end of the result was reached.
+   */
+  template <class ResultSet>
+  grt::BaseListRef fetchRows(ResultSet &result, const ResultColumns &columns, size_t count) {
+    grt::BaseListRef rows(true);
+    uint32_t columnCount = (uint32_t)columns.kinds.size();
+    for (size_t i = 0; i < count && result.next(); ++i) {
+      grt::BaseListRef row(true);
+      for (uint32_t column = 1; column <= columnCount; ++column)
+        row.ginsert(fieldValue(result, columns.kinds[column - 1], column));
+      rows.ginsert(row);
+    }
+
+    return rows;
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  /**
+   * Advances the result by up to count rows and returns them column wise: one typed list per column (integer,
+   * double or string list), all of the same length. NULL values are returned as None. The lists are empty when
+   * the end of the result was reached.
+   */
+  template <class ResultSet>
+  grt::BaseListRef fetchColumns(ResultSet &result, const ResultColumns &columns, size_t count) {
+    std::vector<grt::BaseListRef> lists;
+    for (ColumnKind kind : columns.kinds) {
+      switch (kind) {
+        case IntegerColumn:
+          lists.push_back(grt::IntegerListRef(grt::Initialized));
+          break;
+        case DoubleColumn:
+          lists.push_back(grt::DoubleListRef(grt::Initialized));
+          break;
+        default:
+          lists.push_back(grt::StringListRef(grt::Initialized));
+          break;
+      }
+    }
+
+    // Values always have the type of their column's list, no need to check that for each of them.
+    uint32_t columnCount = (uint32_t)columns.kinds.size();
+    for (size_t i = 0; i < count && result.next(); ++i) {
+      for (uint32_t column = 1; column <= columnCount; ++column)
+        lists[column - 1].ginsert_unchecked(fieldValue(result, columns.kinds[column - 1], column));
+    }
+
+    grt::BaseListRef columnLists(true);
+    for (auto &list : lists)
+      columnLists.ginsert(list);
+
+    return columnLists;
+  }
+
+} // namespace dbquery
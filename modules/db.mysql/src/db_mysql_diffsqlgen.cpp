@@ -34,10 +34,44 @@
 
 #include <algorithm>
 #include <ctype.h>
+#include <exception>
+#include <memory>
+#include <thread>
 
 #include "module_db_mysql.h"
 #include "module_db_mysql_shared_code.h"
 
+namespace {
+  /**
+   * Keeps the statements generated for a schema on a worker thread, until they can be passed on in order.
+   */
+  class SQLStatementBuffer : public SQLStatementSink {
+    struct Statement {
+      GrtNamedObjectRef object;
+      std::string sql;
+      int flags;
+    };
+    std::vector<Statement> _statements;
+    std::set<std::string> _object_ids;
+
+  public:
+    virtual void add_statement(const GrtNamedObjectRef &object, const std::string &sql, int flags) override {
+      _statements.push_back({object, sql, flags});
+      _object_ids.insert(object.id());
+    }
+
+    virtual bool has_statement(const GrtNamedObjectRef &object) override {
+      return _object_ids.find(object.id()) != _object_ids.end();
+    }
+
+    void replay(SQLStatementSink *sink) {
+      for (auto &statement : _statements)
+        sink->add_statement(statement.object, statement.sql, statement.flags);
+      _statements.clear();
+    }
+  };
+}
+
 void DiffSQLGeneratorBE::generate_set_partitioning(db_mysql_TableRef table, const grt::DiffChange *table_diffchange) {
   bool part_type_set = false, part_expr_set = false, subpart_type_set = false, subpart_expr_set = false,
        part_count_set = false, part_defs_set = false;
@@ -364,12 +398,59 @@ void DiffSQLGeneratorBE::generate_create_stmt(db_UserRef user) {
   callback->create_user(user);
 }
 
+void DiffSQLGeneratorBE::generate_schemata(size_t count,
+                                           const std::function<void(DiffSQLGeneratorBE &, size_t)> &generate) {
+  size_t batch_size = std::min(_generation_threads, count);
+
+  // every schema of a batch needs its own call-back, which the call-back has to provide
+  std::vector<SQLStatementBuffer> buffers(batch_size);
+  std::vector<std::unique_ptr<DiffSQLGeneratorBEActionInterface>> callbacks;
+  if (batch_size > 1 && sink != NULL) {
+    for (size_t i = 0; i < batch_size; i++) {
+      callbacks.emplace_back(callback->clone(&buffers[i]));
+      if (!callbacks.back())
+        break;
+    }
+  }
+
+  if (callbacks.size() < 2 || !callbacks.back()) {
+    for (size_t i = 0; i < count; i++)
+      generate(*this, i);
+    return;
+  }
+
+  for (size_t batch_start = 0; batch_start < count; batch_start += batch_size) {
+    size_t batch_end = std::min(batch_start + batch_size, count);
+    std::vector<std::exception_ptr> errors(batch_end - batch_start);
+    std::vector<std::thread> workers;
+    for (size_t i = batch_start; i < batch_end; i++) {
+      workers.emplace_back([this, &generate, &callbacks, &buffers, &errors, batch_start, i]() {
+        try {
+          DiffSQLGeneratorBE generator(*this);
+          generator.callback = callbacks[i - batch_start].get();
+          generator.sink = &buffers[i - batch_start];
+          generate(generator, i);
+        } catch (...) {
+          errors[i - batch_start] = std::current_exception();
+        }
+      });
+    }
+    for (auto &worker : workers)
+      worker.join();
+
+    for (size_t i = 0; i < errors.size(); i++) {
+      if (errors[i])
+        std::rethrow_exception(errors[i]);
+      buffers[i].replay(sink);
+    }
+  }
+}
+
 void DiffSQLGeneratorBE::generate_create_stmt(db_mysql_CatalogRef catalog) {
   grt::ListRef<db_mysql_Schema> schemata = catalog->schemata();
-  for (size_t count = schemata.count(), i = 0; i < count; i++) {
-    db_mysql_SchemaRef schema = schemata.get(i);
-    generate_create_stmt(schema);
-  }
+  generate_schemata(schemata.count(), [schemata](DiffSQLGeneratorBE &generator, size_t i) {
+    generator.generate_create_stmt(schemata.get(i));
+  });
 
   for (size_t count = catalog->users().count(), i = 0; i < count; i++) {
     db_UserRef user = catalog->users().get(i);
@@ -447,9 +528,10 @@ void DiffSQLGeneratorBE::generate_drop_stmt(db_mysql_SchemaRef schema) {
 }
 
 void DiffSQLGeneratorBE::generate_drop_stmt(db_mysql_CatalogRef catalog) {
+  // schemas are dropped in reverse order, like the objects in them
   grt::ListRef<db_mysql_Schema> schemata = catalog->schemata();
-  for (size_t count = schemata.count(), i = 0; i < count; i++) {
-    db_mysql_SchemaRef schema = schemata.get(i);
+  for (size_t i = schemata.count(); i > 0; i--) {
+    db_mysql_SchemaRef schema = schemata.get(i - 1);
     generate_drop_stmt(schema);
   }
 
@@ -1325,21 +1407,33 @@ void DiffSQLGeneratorBE::generate_alter_stmt(db_mysql_CatalogRef catalog, const
         if (objattr_subchange->get_change_type() == grt::ListModified) {
           const grt::MultiChange *schemata_list_change = static_cast<const grt::MultiChange *>(objattr_subchange);
 
+          // schema drops go first, last removed schema first
+          for (grt::ChangeSet::const_reverse_iterator schemata_e = schemata_list_change->subchanges()->rend(),
+                                                      schemata_it = schemata_list_change->subchanges()->rbegin();
+               schemata_it != schemata_e; schemata_it++) {
+            const grt::DiffChange *schema_subchange = schemata_it->get();
+            if (schema_subchange->get_change_type() == grt::ListItemRemoved)
+              generate_drop_stmt(db_mysql_SchemaRef::cast_from(
+                static_cast<const grt::ListItemRemovedChange *>(schema_subchange)->get_value()));
+          }
+
+          std::vector<const grt::DiffChange *> schema_changes;
           for (grt::ChangeSet::const_iterator schemata_e = schemata_list_change->subchanges()->end(),
                                               schemata_it = schemata_list_change->subchanges()->begin();
                schemata_it != schemata_e; schemata_it++) {
-            const grt::DiffChange *schema_subchange = schemata_it->get();
+            if ((*schemata_it)->get_change_type() != grt::ListItemRemoved)
+              schema_changes.push_back(schemata_it->get());
+          }
+
+          generate_schemata(schema_changes.size(), [&schema_changes](DiffSQLGeneratorBE &generator, size_t i) {
+            const grt::DiffChange *schema_subchange = schema_changes[i];
             switch (schema_subchange->get_change_type()) {
               case grt::ListItemAdded:
-                generate_create_stmt(db_mysql_SchemaRef::cast_from(
+                generator.generate_create_stmt(db_mysql_SchemaRef::cast_from(
                   static_cast<const grt::ListItemAddedChange *>(schema_subchange)->get_value()));
                 break;
-              case grt::ListItemRemoved:
-                generate_drop_stmt(db_mysql_SchemaRef::cast_from(
-                  static_cast<const grt::ListItemRemovedChange *>(schema_subchange)->get_value()));
-                break;
               case grt::ListItemModified:
-                generate_alter_stmt(
+                generator.generate_alter_stmt(
                   db_mysql_SchemaRef::cast_from(
                     static_cast<const grt::ListItemModifiedChange *>(schema_subchange)->get_new_value()),
                   static_cast<const grt::ListItemModifiedChange *>(schema_subchange)->get_subchange().get());
@@ -1347,13 +1441,13 @@ void DiffSQLGeneratorBE::generate_alter_stmt(db_mysql_CatalogRef catalog, const
               case grt::ListItemOrderChanged: {
                 const grt::ListItemOrderChange *oc = static_cast<const grt::ListItemOrderChange *>(schema_subchange);
                 if (oc->get_subchange())
-                  generate_alter_stmt(db_mysql_SchemaRef::cast_from(oc->get_subchange()->get_new_value()),
-                                      oc->get_subchange()->get_subchange().get());
+                  generator.generate_alter_stmt(db_mysql_SchemaRef::cast_from(oc->get_subchange()->get_new_value()),
+                                                oc->get_subchange()->get_subchange().get());
               } break;
               default:
                 break;
             }
-          }
+          });
         }
       }
     }
@@ -1368,13 +1462,15 @@ static void fill_set_from_list(grt::StringListRef string_list, std::set<std::str
 DiffSQLGeneratorBE::DiffSQLGeneratorBE(grt::DictRef options, grt::DictRef dbtraits,
                                        DiffSQLGeneratorBEActionInterface *cb)
   : callback(cb),
+    sink(NULL),
     _gen_create_index(false),
     _use_filtered_lists(true),
     _skip_foreign_keys(false),
     _skip_fk_indexes(false),
     _case_sensitive(false),
     _use_oid_as_dict_key(false),
-    _separate_foreign_keys(true) {
+    _separate_foreign_keys(true),
+    _generation_threads(1) {
   if (!options.is_valid())
     return;
   _case_sensitive = (dbtraits.get_int("CaseSensitive", _case_sensitive) != 0);
@@ -1386,6 +1482,12 @@ DiffSQLGeneratorBE::DiffSQLGeneratorBE(grt::DictRef options, grt::DictRef dbtrai
   _gen_create_index = (options.get_int("GenerateCreateIndex", _gen_create_index) != 0);
   _use_filtered_lists = options.get_int("UseFilteredLists", _use_filtered_lists) != 0;
   _separate_foreign_keys = options.get_int("SeparateForeignKeys", _separate_foreign_keys) != 0;
+  _generation_threads = (size_t)std::max(options.get_int("GenerationThreads", 1), (ssize_t)0);
+  if (_generation_threads == 0)
+    _generation_threads = std::max(std::thread::hardware_concurrency(), 1U);
+  // without schema names the SQL parser has to rewrite the object definitions, keep that on one thread
+  if (options.get_int("OmitSchemas", 0) != 0)
+    _generation_threads = 1;
   cb->setOmitSchemas(options.get_int("OmitSchemas", 0) != 0);
   cb->set_gen_use(options.get_int("GenerateUse", 0) != 0);
   fill_set_from_list(grt::StringListRef::cast_from(options.get("UserFilterList", empty_list)), _filtered_users);
@@ -1396,23 +1498,10 @@ DiffSQLGeneratorBE::DiffSQLGeneratorBE(grt::DictRef options, grt::DictRef dbtrai
   fill_set_from_list(grt::StringListRef::cast_from(options.get("TriggerFilterList", empty_list)), _filtered_triggers);
 }
 
-void DiffSQLGeneratorBE::process_diff_change(grt::ValueRef org_object, grt::DiffChange *diff, grt::DictRef map) {
-  this->target_list = grt::StringListRef();
-  this->target_map = map;
-
-  do_process_diff_change(org_object, diff);
-}
-
-void DiffSQLGeneratorBE::process_diff_change(grt::ValueRef org_object, grt::DiffChange *diff, grt::StringListRef list,
-                                             grt::ListRef<GrtNamedObject> objlist) {
-  this->target_map = grt::DictRef();
-  this->target_list = list;
-  this->target_object_list = objlist;
-
-  do_process_diff_change(org_object, diff);
-}
+void DiffSQLGeneratorBE::process_diff_change(grt::ValueRef org_object, grt::DiffChange *diff,
+                                             SQLStatementSink *sink) {
+  this->sink = sink;
 
-void DiffSQLGeneratorBE::do_process_diff_change(grt::ValueRef org_object, grt::DiffChange *diff) {
   switch (diff->get_change_type()) {
     // case SimpleValue:
     case grt::ValueAdded:
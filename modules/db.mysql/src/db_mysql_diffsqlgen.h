@@ -40,10 +40,14 @@
  * <br/>2. put the gereneated SQL together (e.g. into a string or  a file)
  *
  * The DiffSQLGeneratorBE class together with the code generation call-back implement the first step.
- * You pass the catalog object, the call-back object, the difference object, and output container (list
- * or map) to DiffSQLGeneratorBE::process_diff_change() (see below) and get back  the output container
- * filled with SQL code for objects in catalog. Filtering is available and is set through the options map
- * (also passed to the function).
+ * You pass the catalog object, the call-back object and the difference object to
+ * DiffSQLGeneratorBE::process_diff_change() (see below). The call-back passes the SQL code for the objects
+ * in the catalog to its output (a list, a map or any SQLStatementSink) as soon as it is generated.
+ * Filtering is available and is set through the options map.
+ *
+ * With the "GenerationThreads" option set to anything but 1 (0 means one per core) the statements of
+ * several schemas are generated at the same time, if the call-back supports that. They are still passed on
+ * in the same order as with a single thread, schema by schema.
  *
  * The call-back object serves to generate the SQL ot plain text. See the DiffSQLGeneratorBEActionInterface
  * interface declaraton in module_db_mysql.h.
@@ -51,7 +55,9 @@
 
 #include "grtpp_module_cpp.h"
 #include "grts/structs.db.mysql.h"
+#include "interfaces/sqlgenerator.h"
 
+#include <functional>
 #include <set>
 
 namespace grt {
@@ -80,11 +86,9 @@ class DiffSQLGeneratorBE {
   DiffSQLGeneratorBEActionInterface *callback;
 
   /**
-   * the SQL can be stored either to a list or to a map
+   * where the call-back passes the SQL to, needed to generate schemas in parallel
    */
-  grt::DictRef target_map;
-  grt::StringListRef target_list;
-  grt::ListRef<GrtNamedObject> target_object_list;
+  SQLStatementSink *sink;
 
   /**
    * processing options
@@ -96,6 +100,7 @@ class DiffSQLGeneratorBE {
   bool _case_sensitive;
   bool _use_oid_as_dict_key;
   bool _separate_foreign_keys;
+  size_t _generation_threads;
   std::set<std::string> _filtered_schemata, _filtered_tables, _filtered_views, _filtered_routines, _filtered_triggers,
     _filtered_users;
 
@@ -177,7 +182,12 @@ class DiffSQLGeneratorBE {
 
   void process_trigger_alter_stmts(db_mysql_TableRef table, const grt::DiffChange *triggers_cs);
 
-  void do_process_diff_change(grt::ValueRef org_object, grt::DiffChange *);
+  /**
+   * Calls generate for the indexes 0 to count - 1, each generating the SQL of one schema. Does that in
+   * parallel batches when enabled, in which case every schema gets its own copy of this generator and the
+   * call-back. The output is passed on in index order either way.
+   */
+  void generate_schemata(size_t count, const std::function<void(DiffSQLGeneratorBE &, size_t)> &generate);
 
 public:
   /**
@@ -189,14 +199,9 @@ public:
   DiffSQLGeneratorBE(grt::DictRef options, grt::DictRef dbtraits, DiffSQLGeneratorBEActionInterface *cb);
 
   /**
-   * function that starts generating SQL into a map (dictionary)
-   */
-  void process_diff_change(grt::ValueRef org_object, grt::DiffChange *, grt::DictRef);
-  /**
-   * function that starts generating SQL into a list
+   * function that starts generating SQL, sink must be the output of the call-back (if any)
    */
-  void process_diff_change(grt::ValueRef org_object, grt::DiffChange *, grt::StringListRef,
-                           grt::ListRef<GrtNamedObject>);
+  void process_diff_change(grt::ValueRef org_object, grt::DiffChange *, SQLStatementSink *sink = NULL);
 };
 
 #endif // _DB_MYSQL_DIFFSQLGEN_H_
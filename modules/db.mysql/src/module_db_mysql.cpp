@@ -26,6 +26,10 @@
 #include <stdio.h>
 #endif
 
+#include <functional>
+#include <memory>
+#include <set>
+
 #include "base/sqlstring.h"
 
 #include "grt/grt_manager.h"
@@ -279,21 +283,24 @@ namespace {
     std::list<std::string> partitions_to_change;
     std::list<std::string> partitions_to_add;
 
-    grt::DictRef target_map;
-    grt::StringListRef target_list;
-    grt::ListRef<GrtNamedObject> target_object_list;
+    grt::DictRef _options;
+    std::unique_ptr<SQLStatementSink> _own_sink;
+    SQLStatementSink* _sink;
     bool disable_object_list;
 
     void remember_alter(const GrtNamedObjectRef& obj, const std::string& sql);
-    void remember(const GrtNamedObjectRef& obj, const std::string& sql, const bool front = false);
+    void remember(const GrtNamedObjectRef& obj, const std::string& sql);
 
     void alter_table_property(std::string& to, const std::string& name, const std::string& value);
 
   public:
     ActionGenerateSQL(grt::ValueRef target, grt::ListRef<GrtNamedObject> obj_list, const grt::DictRef options,
                       bool use_oids_as_key);
+    ActionGenerateSQL(SQLStatementSink* sink, const grt::DictRef options);
     virtual ~ActionGenerateSQL();
 
+    virtual DiffSQLGeneratorBEActionInterface* clone(SQLStatementSink* sink) override;
+
     // create table
     void create_table_props_begin(db_mysql_TableRef);
     void create_table_props_end(db_mysql_TableRef);
@@ -423,9 +430,76 @@ namespace {
     };
   };
 
-  ActionGenerateSQL::ActionGenerateSQL(grt::ValueRef target, grt::ListRef<GrtNamedObject> obj_list,
-                                       const grt::DictRef options, bool use_oids_as_key = false)
-    : padding(2), _use_oids_as_dict_key(use_oids_as_key), disable_object_list(false) {
+  /**
+   * Stores the statements in a list, in script order, and the objects they are for in a parallel list.
+   * Statements implied by others are left out.
+   */
+  class SQLStatementList : public SQLStatementSink {
+    grt::StringListRef _list;
+    grt::ListRef<GrtNamedObject> _objects;
+
+  public:
+    SQLStatementList(grt::StringListRef list, grt::ListRef<GrtNamedObject> objects) : _list(list), _objects(objects) {
+    }
+
+    virtual void add_statement(const GrtNamedObjectRef& object, const std::string& sql, int flags) override {
+      if (flags & ImpliedStatement)
+        return;
+      _list.insert(grt::StringRef(sql));
+      if (_objects.is_valid())
+        _objects.insert(object);
+    }
+
+    virtual bool has_statement(const GrtNamedObjectRef& object) override {
+      return _objects.is_valid() && _objects.get_index(object) != grt::BaseListRef::npos;
+    }
+  };
+
+  /**
+   * Stores the statements in a map keyed by the full object name (or the object id). In case of ALTERs there
+   * can be more than one statement per object, those are stored as string list.
+   */
+  class SQLStatementMap : public SQLStatementSink {
+    grt::DictRef _map;
+    bool _use_oids_as_key;
+    bool _case_sensitive;
+
+    std::string key_for(const GrtNamedObjectRef& object) const {
+      return _use_oids_as_key ? object.id() : get_full_object_name_for_key(object, _case_sensitive);
+    }
+
+  public:
+    SQLStatementMap(grt::DictRef map, bool use_oids_as_key, bool case_sensitive)
+      : _map(map), _use_oids_as_key(use_oids_as_key), _case_sensitive(case_sensitive) {
+    }
+
+    virtual void add_statement(const GrtNamedObjectRef& object, const std::string& sql, int flags) override {
+      std::string key = key_for(object);
+      if (!(flags & AlterStatement) || !_map.has_key(key)) {
+        _map.set(key, grt::StringRef(sql));
+        return;
+      }
+
+      grt::ValueRef value = _map.get(key);
+      if (grt::StringRef::can_wrap(value)) {
+        grt::StringListRef list_value(grt::Initialized);
+        list_value.insert(grt::StringRef::cast_from(value));
+        list_value.insert(grt::StringRef(sql));
+        _map.set(key, list_value);
+      } else if (grt::StringListRef::can_wrap(value)) {
+        grt::StringListRef::cast_from(value).insert(grt::StringRef(sql));
+      } else {
+        // a bug
+      }
+    }
+
+    virtual bool has_statement(const GrtNamedObjectRef& object) override {
+      return _map.get(key_for(object)).is_valid();
+    }
+  };
+
+  ActionGenerateSQL::ActionGenerateSQL(SQLStatementSink* sink, const grt::DictRef options)
+    : padding(2), _use_oids_as_dict_key(false), _options(options), _sink(sink), disable_object_list(false) {
     first_column = false;
     first_change = false;
     empty_length = 0;
@@ -438,25 +512,34 @@ namespace {
     _algorithm_type = options.get_string("AlterAlgorithm");
     _lock_type = options.get_string("AlterLock");
 
-    _use_oids_as_dict_key = options.get_int("UseOIDAsResultDictKey", use_oids_as_key) != 0;
-
     SqlFacade::Ref sql_facade = SqlFacade::instance_for_rdbms_name("Mysql");
     Sql_specifics::Ref sql_specifics = sql_facade->sqlSpecifics();
     _non_std_sql_delimiter = bec::GRTManager::get()->get_app_option_string("SqlDelimiter", "$$");
+  }
 
-    if (target.type() == DictType) {
-      this->target_list = grt::StringListRef();
-      this->target_map = grt::DictRef::cast_from(target);
-    } else if (target.type() == ListType) {
-      this->target_list = grt::StringListRef::cast_from(target);
-      this->target_map = grt::DictRef();
-    }
-    this->target_object_list = obj_list;
+  ActionGenerateSQL::ActionGenerateSQL(grt::ValueRef target, grt::ListRef<GrtNamedObject> obj_list,
+                                       const grt::DictRef options, bool use_oids_as_key = false)
+    : ActionGenerateSQL(NULL, options) {
+    _use_oids_as_dict_key = options.get_int("UseOIDAsResultDictKey", use_oids_as_key) != 0;
+
+    if (target.type() == DictType)
+      _own_sink.reset(new SQLStatementMap(grt::DictRef::cast_from(target), _use_oids_as_dict_key, _case_sensitive));
+    else if (target.type() == ListType)
+      _own_sink.reset(new SQLStatementList(grt::StringListRef::cast_from(target), obj_list));
+    _sink = _own_sink.get();
   }
 
   ActionGenerateSQL::~ActionGenerateSQL() {
   }
 
+  DiffSQLGeneratorBEActionInterface* ActionGenerateSQL::clone(SQLStatementSink* sink) {
+    ActionGenerateSQL* result = new ActionGenerateSQL(sink, _options);
+    result->_put_if_exists = _put_if_exists;
+    result->_omitSchemas = _omitSchemas;
+    result->_gen_use = _gen_use;
+    return result;
+  }
+
   // create table methods
 
   void ActionGenerateSQL::create_table_props_begin(db_mysql_TableRef table) {
@@ -810,7 +893,7 @@ namespace {
   void ActionGenerateSQL::drop_schema(db_mysql_SchemaRef schema) {
     std::string schema_sql;
     schema_sql.append("DROP SCHEMA IF EXISTS `").append(schema->name().c_str()).append("` ");
-    remember(schema, schema_sql, true);
+    remember(schema, schema_sql);
   }
 
   // alter schema methods
@@ -1418,16 +1501,7 @@ namespace {
       db_mysql_TriggerRef preceding = find_ordering_for_trigger(trigger, position);
       if (preceding.is_valid()) {
         // check if the remember() at the end of this method was called for the "preceding" object
-        bool flag = false;
-        if (target_list.is_valid()) {
-          if (target_object_list.get_index(preceding) != grt::BaseListRef::npos)
-            flag = true;
-        } else {
-          if (target_map
-                .get(_use_oids_as_dict_key ? preceding.id() : get_full_object_name_for_key(preceding, _case_sensitive))
-                .is_valid())
-            flag = true;
-        }
+        bool flag = _sink->has_statement(preceding);
         if (!flag) {
           trigger_definition = "CREATE";
           if (!trigger->definer().empty()) {
@@ -1616,48 +1690,15 @@ namespace {
     remember(user, sql);
   }
 
-  void ActionGenerateSQL::remember(const GrtNamedObjectRef& obj, const std::string& sql, const bool front) {
-    if (target_list.is_valid()) {
-      if (disable_object_list)
-        return;
-      target_list.insert(grt::StringRef(sql), front ? 0 : (size_t)StringListRef::npos);
-      if (target_object_list.is_valid())
-        target_object_list.insert(obj, front ? 0 : (size_t)StringListRef::npos);
-    } else {
-      target_map.set(_use_oids_as_dict_key ? obj.id() : get_full_object_name_for_key(obj, _case_sensitive),
-                     grt::StringRef(sql));
-    }
+  void ActionGenerateSQL::remember(const GrtNamedObjectRef& obj, const std::string& sql) {
+    _sink->add_statement(obj, sql,
+                         disable_object_list ? SQLStatementSink::ImpliedStatement : SQLStatementSink::PlainStatement);
   }
 
   // in case of ALTERs there could be > 1 statement to remember
-  // so we use grt::StringListRefs as needed
   void ActionGenerateSQL::remember_alter(const GrtNamedObjectRef& obj, const std::string& sql) {
-    if (target_list.is_valid()) {
-      if (disable_object_list)
-        return;
-      target_list.insert(grt::StringRef(sql));
-      if (target_object_list.is_valid())
-        target_object_list.insert(obj);
-      return;
-    }
-
-    std::string key = _use_oids_as_dict_key ? obj.id() : get_full_object_name_for_key(obj, _case_sensitive);
-
-    if (target_map.has_key(key)) {
-      grt::ValueRef value = target_map.get(key);
-      if (grt::StringRef::can_wrap(value)) {
-        grt::StringListRef list_value(grt::Initialized);
-        list_value.insert(grt::StringRef::cast_from(value));
-        list_value.insert(grt::StringRef(sql));
-        target_map.set(key, list_value);
-      } else if (grt::StringListRef::can_wrap(value)) {
-        grt::StringListRef::cast_from(value).insert(grt::StringRef(sql));
-      } else {
-        // a bug
-      }
-    } else {
-      target_map.set(key, grt::StringRef(sql));
-    }
+    _sink->add_statement(obj, sql, SQLStatementSink::AlterStatement |
+                                     (disable_object_list ? SQLStatementSink::ImpliedStatement : 0));
   }
 
 } // namespace
@@ -1679,20 +1720,26 @@ ssize_t DbMySQLImpl::generateSQL(GrtNamedObjectRef org_object, const grt::DictRe
   if (options.has_key("OutputObjectContainer"))
     obj_list = grt::ListRef<GrtNamedObject>::cast_from(options.get("OutputObjectContainer"));
   if (result.type() == DictType) {
-    ActionGenerateSQL generator =
-      ActionGenerateSQL(result, obj_list, dbsettings, options.get_int("UseOIDAsResultDictKey", 0) != 0);
-    DiffSQLGeneratorBE(options, dbsettings, &generator)
-      .process_diff_change(org_object, changes.get(), grt::DictRef::cast_from(result));
+    bool use_oids_as_key =
+      dbsettings.get_int("UseOIDAsResultDictKey", options.get_int("UseOIDAsResultDictKey", 0)) != 0;
+    SQLStatementMap sink(grt::DictRef::cast_from(result), use_oids_as_key, dbsettings.get_int("CaseSensitive") != 0);
+    generateSQL(org_object, options, changes, &sink);
   } else if (result.type() == ListType) {
-    ActionGenerateSQL generator =
-      ActionGenerateSQL(result, obj_list, dbsettings, options.get_int("UseOIDAsResultDictKey", 0) != 0);
-    DiffSQLGeneratorBE(options, dbsettings, &generator)
-      .process_diff_change(org_object, changes.get(), grt::StringListRef::cast_from(result), obj_list);
+    SQLStatementList sink(grt::StringListRef::cast_from(result), obj_list);
+    generateSQL(org_object, options, changes, &sink);
   }
 
   return 0;
 }
 
+void DbMySQLImpl::generateSQL(GrtNamedObjectRef org_object, const grt::DictRef& options,
+                              std::shared_ptr<DiffChange> changes, SQLStatementSink* sink) {
+  grt::DictRef dbsettings = grt::DictRef::cast_from(options.get("DBSettings", getDefaultTraits()));
+
+  ActionGenerateSQL generator(sink, dbsettings);
+  DiffSQLGeneratorBE(options, dbsettings, &generator).process_diff_change(org_object, changes.get(), sink);
+}
+
 grt::StringRef DbMySQLImpl::generateReport(GrtNamedObjectRef org_object, const grt::DictRef& options,
                                            std::shared_ptr<DiffChange> changes) {
   grt::StringRef tpl_file = grt::StringRef::cast_from(options.get("TemplateFile"));
@@ -1701,7 +1748,7 @@ grt::StringRef DbMySQLImpl::generateReport(GrtNamedObjectRef org_object, const g
     ActionGenerateReport r(tpl_file);
 
     DiffSQLGeneratorBE(options, grt::DictRef::cast_from(options.get("DBSettings", getDefaultTraits())), &r)
-      .process_diff_change(org_object, changes.get(), grt::StringListRef(), grt::ListRef<GrtNamedObject>());
+      .process_diff_change(org_object, changes.get());
 
     grt::StringRef retval(r.generate_output());
 
@@ -1726,7 +1773,7 @@ grt::StringRef DbMySQLImpl::generateReportForDifferences(GrtNamedObjectRef org_o
     ActionGenerateReport r(tpl_file);
 
     DiffSQLGeneratorBE(options, grt::DictRef::cast_from(options.get("DBSettings", getDefaultTraits())), &r)
-      .process_diff_change(org_object, alter_change.get(), grt::StringListRef(), grt::ListRef<GrtNamedObject>());
+      .process_diff_change(org_object, alter_change.get());
 
     grt::StringRef retval(r.generate_output());
 
@@ -2431,92 +2478,109 @@ ssize_t DbMySQLImpl::makeSQLExportScript(GrtNamedObjectRef dbobject, grt::DictRe
   return 0;
 }
 
-class SQLSyncComposer : public SQLComposer {
+/**
+ * Puts the statements of a synchronization together into a script. Statements can be passed in while they
+ * are generated (the composer is a SQLStatementSink): plain statements are written to the output right away,
+ * only views, routines and triggers are kept until end(), as they have to go after everything else.
+ */
+class SQLSyncComposer : public SQLComposer, public SQLStatementSink {
+  std::function<void(const std::string&)> _output;
+  db_CatalogRef _catalog;
+  std::set<std::string> _object_ids;
+  std::list<std::pair<db_mysql_ViewRef, std::string>> _views;
+  std::string _view_placeholders;
+  std::string _routines;
+  std::string _triggers;
+
+  void output_user_scripts(const std::string& position) {
+    if (include_scripts && _catalog.is_valid() && _catalog->owner().is_valid()) {
+      GRTLIST_FOREACH(db_Script, workbench_physical_ModelRef::cast_from(_catalog->owner())->scripts(), script) {
+        if ((*script)->synchronizeScriptPosition() == position)
+          _output(user_script(*script));
+      }
+    }
+  }
+
 public:
-  SQLSyncComposer(const grt::DictRef options) : SQLComposer(options) {
+  SQLSyncComposer(const grt::DictRef options, const std::function<void(const std::string&)>& output = nullptr)
+    : SQLComposer(options), _output(output) {
   }
 
-  std::string get_sync_sql(const db_CatalogRef& cat, const grt::StringListRef& sql_list,
-                           const grt::ListRef<GrtNamedObject>& obj_list) {
-    std::string out_sql;
-    std::list<int> views_indices;
-    std::string view_placeholders;
-    std::string views;
-    std::string routines;
-    std::string triggers;
+  void begin(const db_CatalogRef& cat) {
+    _catalog = cat;
+    _object_ids.clear();
+    _views.clear();
+    _view_placeholders.clear();
+    _routines.clear();
+    _triggers.clear();
 
-    out_sql.append("-- MySQL Workbench Synchronization").append("\n");
+    std::string header("-- MySQL Workbench Synchronization\n");
     if (include_document_properties)
-      out_sql.append(generateDocumentProperties(cat));
-    out_sql.append("\n");
+      header.append(generateDocumentProperties(cat));
+    header.append("\n");
+    _output(header);
 
-    if (include_scripts && cat.is_valid() && cat->owner().is_valid()) {
-      GRTLIST_FOREACH(db_Script, workbench_physical_ModelRef::cast_from(cat->owner())->scripts(), script) {
-        if ((*script)->synchronizeScriptPosition() == "top_file")
-          out_sql.append(user_script(*script));
-      }
-    }
+    output_user_scripts("top_file");
+    _output(set_server_vars());
+    output_user_scripts("before_ddl");
+  }
 
-    out_sql.append(set_server_vars());
+  virtual void add_statement(const GrtNamedObjectRef& obj, const std::string& sql, int flags) override {
+    if (flags & ImpliedStatement)
+      return;
 
-    if (include_scripts && cat.is_valid() && cat->owner().is_valid()) {
-      GRTLIST_FOREACH(db_Script, workbench_physical_ModelRef::cast_from(cat->owner())->scripts(), script) {
-        if ((*script)->synchronizeScriptPosition() == "before_ddl")
-          out_sql.append(user_script(*script));
-      }
+    _object_ids.insert(obj.id());
+    if (db_TriggerRef::can_wrap(obj)) {
+      _triggers.append(sql).append(non_std_sql_delimiter).append("\n\n");
+    } else if (db_RoutineRef::can_wrap(obj)) {
+      _routines.append(sql);
+    } else if (db_ViewRef::can_wrap(obj)) {
+      if (sql.empty())
+        return;
+      db_mysql_ViewRef view = db_mysql_ViewRef::cast_from(obj);
+      _views.push_back(std::make_pair(view, sql));
+      _view_placeholders.append(generate_view_placeholder(view));
+    } else {
+      _output(sql + ";\n\n");
     }
+  }
 
-    for (size_t sz = sql_list.count(), i = 0; i < sz; i++) {
-      GrtNamedObjectRef obj = obj_list.get(i);
-      if (db_TriggerRef::can_wrap(obj)) {
-        triggers.append(sql_list[i]).append(non_std_sql_delimiter).append("\n\n");
-      } else if (db_RoutineRef::can_wrap(obj)) {
-        routines.append(sql_list[i]);
-      } else if (db_ViewRef::can_wrap(obj)) {
-        std::string view_ddl(sql_list[i]);
-        if (view_ddl.empty())
-          continue;
-        views_indices.push_back((int)i);
-        db_mysql_ViewRef view = db_mysql_ViewRef::cast_from(obj);
-        view_placeholders.append(generate_view_placeholder(view));
-      } else {
-        out_sql.append(sql_list.get(i)).append(";\n\n");
-      }
-    }
+  virtual bool has_statement(const GrtNamedObjectRef& obj) override {
+    return _object_ids.find(obj.id()) != _object_ids.end();
+  }
 
+  void end() {
     // views DDL
     // 2nd loop on views, 1st one creates view placeholders and filles alias_map
-    for (std::list<int>::const_iterator e = views_indices.end(), it = views_indices.begin(); it != e; it++) {
-      db_mysql_ViewRef view = db_mysql_ViewRef::cast_from(obj_list.get(*it));
-      std::string view_ddl(sql_list.get(*it));
-      views.append("\n\nUSE `").append(view->owner()->name()).append("`;\n");
-      views.append(generate_view_ddl(view, view_ddl));
+    std::string views;
+    for (auto& view : _views) {
+      views.append("\n\nUSE `").append(view.first->owner()->name()).append("`;\n");
+      views.append(generate_view_ddl(view.first, view.second));
     }
 
-    out_sql.append(view_placeholders);
-    out_sql.append(views);
-    out_sql.append(routines);
-    if (!triggers.empty()) {
-      out_sql.append("\nDELIMITER ").append(non_std_sql_delimiter).append("\n\n");
-      out_sql.append(triggers);
-      out_sql.append("\nDELIMITER ;\n\n");
+    _output(_view_placeholders);
+    _output(views);
+    _output(_routines);
+    if (!_triggers.empty()) {
+      _output(std::string("\nDELIMITER ").append(non_std_sql_delimiter).append("\n\n"));
+      _output(_triggers);
+      _output("\nDELIMITER ;\n\n");
     }
 
-    if (include_scripts && cat.is_valid() && cat->owner().is_valid()) {
-      GRTLIST_FOREACH(db_Script, workbench_physical_ModelRef::cast_from(cat->owner())->scripts(), script) {
-        if ((*script)->synchronizeScriptPosition() == "after_ddl")
-          out_sql.append(user_script(*script));
-      }
-    }
+    output_user_scripts("after_ddl");
+    _output(restore_server_vars());
+    output_user_scripts("bottom_file");
+  }
 
-    out_sql.append(restore_server_vars());
+  std::string get_sync_sql(const db_CatalogRef& cat, const grt::StringListRef& sql_list,
+                           const grt::ListRef<GrtNamedObject>& obj_list) {
+    std::string out_sql;
+    _output = [&out_sql](const std::string& text) { out_sql.append(text); };
 
-    if (include_scripts && cat.is_valid() && cat->owner().is_valid()) {
-      GRTLIST_FOREACH(db_Script, workbench_physical_ModelRef::cast_from(cat->owner())->scripts(), script) {
-        if ((*script)->synchronizeScriptPosition() == "bottom_file")
-          out_sql.append(user_script(*script));
-      }
-    }
+    begin(cat);
+    for (size_t sz = sql_list.count(), i = 0; i < sz; i++)
+      add_statement(obj_list.get(i), sql_list.get(i), PlainStatement);
+    end();
 
     return out_sql;
   };
@@ -2541,14 +2605,8 @@ std::string DbMySQLImpl::makeAlterScript(GrtNamedObjectRef source, GrtNamedObjec
     return "";
 
   grt::DictRef options(true);
-  grt::StringListRef alter_list(grt::Initialized);
-  options.set("OutputContainer", alter_list);
   options.set("UseFilteredLists", grt::IntegerRef(0));
   options.set("KeepOrder", grt::IntegerRef(1));
-  grt::ListRef<GrtNamedObject> alter_object_list(true);
-  options.set("OutputObjectContainer", alter_object_list);
-
-  generateSQL(source, options, diff);
 
   db_CatalogRef cat;
 
@@ -2563,17 +2621,23 @@ std::string DbMySQLImpl::makeAlterScript(GrtNamedObjectRef source, GrtNamedObjec
     }
   }
 
-  ssize_t res = makeSQLSyncScript(cat, options, alter_list, alter_object_list);
-  if (res != 0)
-    return "";
-
-  grt::StringRef script = grt::StringRef::cast_from(options.get("OutputScript"));
-  if (!script.is_valid())
-    return "";
+  std::string script;
+  generateSQLSyncScript(cat, source, options, diff, [&script](const std::string& text) { script.append(text); });
 
   return script;
 }
 
+void DbMySQLImpl::generateSQLSyncScript(db_CatalogRef cat, GrtNamedObjectRef org_object, const grt::DictRef& options,
+                                        std::shared_ptr<DiffChange> changes,
+                                        const std::function<void(const std::string&)>& output) {
+  // the statements go into the script as they are generated
+  SQLSyncComposer composer(options, output);
+  composer.begin(cat);
+  if (changes)
+    generateSQL(org_object, options, changes, &composer);
+  composer.end();
+}
+
 std::string DbMySQLImpl::makeAlterScriptForObject(GrtNamedObjectRef source, GrtNamedObjectRef target,
                                                   GrtNamedObjectRef obj, const grt::DictRef& diff_options) {
   grt::DbObjectMatchAlterOmf omf;
@@ -2597,7 +2661,7 @@ std::string DbMySQLImpl::makeAlterScriptForObject(GrtNamedObjectRef source, GrtN
                         grt::DictRef::cast_from(diff_options.get("DBSettings", getDefaultTraits())));
     generator.set_put_if_exists(false);
     DiffSQLGeneratorBE(options, grt::DictRef::cast_from(diff_options.get("DBSettings", getDefaultTraits())), &generator)
-      .process_diff_change(source, diff.get(), result);
+      .process_diff_change(source, diff.get());
     std::string objname = get_old_object_name_for_key(obj, omf.case_sensitive);
     ValueRef change = result.get(objname, StringRef(""));
     if (StringRef::can_wrap(change)) {
@@ -2694,11 +2758,30 @@ std::string DbMySQLImpl::makeAlterScriptForObject(GrtNamedObjectRef source, GrtN
   return sql;
 }
 
-// This function is used from scripts and HTML report generator.
-std::string DbMySQLImpl::makeCreateScriptForObject(GrtNamedObjectRef object) {
+// Generates the CREATE scripts for all objects in parent (without cloning it), keyed by
+// get_full_object_name_for_key(). case_sensitive receives the case sensitivity used for the keys.
+grt::DictRef DbMySQLImpl::generateCreateScripts(const ValueRef &parent, bool &case_sensitive) {
   DictRef options(true);
   DictRef result(true);
 
+  options.set("UseFilteredLists", IntegerRef(0));
+  default_omf omf;
+  grt::NormalizedComparer normalizer;
+  normalizer.init_omf(&omf);
+  case_sensitive = omf.case_sensitive;
+  std::shared_ptr<DiffChange> diff = diff_make(ValueRef(), parent, &omf, true); // do a diff without cloning the catalog
+
+  if (diff.get()) {
+    ActionGenerateSQL generator = ActionGenerateSQL(result, grt::ListRef<GrtNamedObject>(), getDefaultTraits());
+    DiffSQLGeneratorBE(options, grt::DictRef::cast_from(options.get("DBSettings", getDefaultTraits())), &generator)
+      .process_diff_change(ValueRef(), diff.get());
+  }
+
+  return result;
+}
+
+// This function is used from scripts and HTML report generator.
+std::string DbMySQLImpl::makeCreateScriptForObject(GrtNamedObjectRef object) {
   ValueRef parent;
 
   // TODO: check how this list is expected to be used
@@ -2725,22 +2808,43 @@ std::string DbMySQLImpl::makeCreateScriptForObject(GrtNamedObjectRef object) {
   else
     return "";
 
-  options.set("UseFilteredLists", IntegerRef(0));
-  default_omf omf;
-  grt::NormalizedComparer normalizer;
-  normalizer.init_omf(&omf);
-  std::shared_ptr<DiffChange> diff = diff_make(ValueRef(), parent, &omf, true); // do a diff without cloning the catalog
+  bool case_sensitive;
+  DictRef result = generateCreateScripts(parent, case_sensitive);
 
-  std::string sql;
+  return result.get_string(get_full_object_name_for_key(object, case_sensitive), "");
+}
 
-  if (diff.get()) {
-    ActionGenerateSQL generator = ActionGenerateSQL(result, grt::ListRef<GrtNamedObject>(), getDefaultTraits());
-    DiffSQLGeneratorBE(options, grt::DictRef::cast_from(options.get("DBSettings", getDefaultTraits())), &generator)
-      .process_diff_change(ValueRef(), diff.get(), result);
-    sql = result.get_string(get_full_object_name_for_key(object, omf.case_sensitive), "");
-  }
+// Same as makeCreateScriptForObject() for every object of the catalog, but the catalog is diffed only once
+// instead of once per object. Used by the model report generator.
+grt::DictRef DbMySQLImpl::makeCreateScriptsForCatalog(db_CatalogRef catalog) {
+  bool case_sensitive;
+  DictRef result = generateCreateScripts(catalog, case_sensitive);
+  DictRef scripts(true);
 
-  return sql;
+  auto add = [&](const GrtNamedObjectRef &object) {
+    scripts.set(object.id(), StringRef(result.get_string(get_full_object_name_for_key(object, case_sensitive), "")));
+  };
+
+  for (auto schema : catalog->schemata()) {
+    add(schema);
+    for (auto table : schema->tables()) {
+      add(table);
+      for (auto trigger : table->triggers())
+        add(trigger);
+    }
+    for (auto view : schema->views())
+      add(view);
+    for (auto routine : schema->routines())
+      add(routine);
+    for (auto group : schema->routineGroups())
+      add(group);
+  }
+  for (auto user : catalog->users())
+    add(user);
+  for (auto role : catalog->roles())
+    add(role);
+
+  return scripts;
 }
 
 db_mgmt_RdbmsRef DbMySQLImpl::initializeDBMSInfo() {
@@ -198,6 +198,12 @@ public:
   virtual void alter_schema_default_collate(db_mysql_SchemaRef, grt::StringRef value) = 0;
   virtual void alter_schema_props_end(db_mysql_SchemaRef) = 0;
   virtual void disable_list_insert(const bool flag) = 0;
+
+  // A new call-back with the same settings that passes its output to sink, used to generate the SQL for
+  // several schemas at the same time. Call-backs that don't support that return NULL.
+  virtual DiffSQLGeneratorBEActionInterface* clone(SQLStatementSink* sink) {
+    return NULL;
+  }
 };
 
 #define DOC_DbMySQLImpl                                          \
@@ -256,6 +262,19 @@ public:
   virtual ssize_t generateSQL(GrtNamedObjectRef, const grt::DictRef& options,
                               std::shared_ptr<grt::DiffChange>) override;
 
+  /**
+   * generate sql (create or alter) statement by statement into a sink, internal only
+   */
+  virtual void generateSQL(GrtNamedObjectRef, const grt::DictRef& options, std::shared_ptr<grt::DiffChange>,
+                           SQLStatementSink* sink) override;
+
+  /**
+   * generate a sync script, putting the statements into it while they are generated, internal only
+   */
+  virtual void generateSQLSyncScript(db_CatalogRef cat, GrtNamedObjectRef org_object, const grt::DictRef& options,
+                                     std::shared_ptr<grt::DiffChange> changes,
+                                     const std::function<void(const std::string&)>& output) override;
+
   /**
    * generate report (create or alter) internal only
    */
@@ -273,6 +292,11 @@ public:
    */
   virtual std::string makeCreateScriptForObject(GrtNamedObjectRef object) override;
 
+  /**
+   * generate CREATE SQL scripts for all objects of a catalog at once, keyed by object id
+   */
+  virtual grt::DictRef makeCreateScriptsForCatalog(db_CatalogRef catalog) override;
+
   /**
    * generate ALTER SQL script for an individual object
    */
@@ -306,6 +330,8 @@ public:
   };
 
 private:
+  grt::DictRef generateCreateScripts(const grt::ValueRef &parent, bool &case_sensitive);
+
   grt::ListRef<db_mysql_StorageEngine> _known_engines;
   grt::DictRef _default_traits;
 };
@@ -28,12 +28,36 @@
 #include "grts/structs.h"
 #include "grts/structs.db.h"
 
+#include <functional>
+
 // diff sql generation interface definition header
 
 namespace grt {
   class DiffChange;
 };
 
+/**
+ * Receives the statements generated from a diff one by one, in script order, while the generation is still
+ * running. Implementations can write them to a file, execute them or collect them, without the whole
+ * script being kept in memory first.
+ */
+class SQLStatementSink {
+public:
+  enum StatementFlags {
+    PlainStatement = 0,
+    AlterStatement = 1,  // One of possibly several statements altering the same object.
+    ImpliedStatement = 2 // Implied by a previous statement (e.g. the drops done by DROP SCHEMA), not for scripts.
+  };
+
+  virtual ~SQLStatementSink() {
+  }
+
+  virtual void add_statement(const GrtNamedObjectRef& object, const std::string& sql, int flags) = 0;
+
+  // Tells whether a statement was added for the object already.
+  virtual bool has_statement(const GrtNamedObjectRef& object) = 0;
+};
+
 class SQLGeneratorInterfaceImpl : public grt::InterfaceImplBase {
 public:
   DECLARE_REGISTER_INTERFACE(SQLGeneratorInterfaceImpl,
@@ -49,8 +73,18 @@ public:
   // For internal use only, atm
   virtual ssize_t generateSQL(grt::Ref<GrtNamedObject>, const grt::DictRef& options,
                               std::shared_ptr<grt::DiffChange>) = 0;
+  // Same as above, but the statements are passed to the sink as they are generated, instead of being stored
+  // in the "OutputContainer" of the options.
+  virtual void generateSQL(grt::Ref<GrtNamedObject>, const grt::DictRef& options, std::shared_ptr<grt::DiffChange>,
+                           SQLStatementSink* sink) = 0;
   virtual grt::StringRef generateReport(grt::Ref<GrtNamedObject> org_object, const grt::DictRef& options,
                                         std::shared_ptr<grt::DiffChange>) = 0;
+  // Generates the synchronization script for the changes. Each statement goes into the script as soon as it is
+  // generated, and the script is passed to output piece by piece. cat is the catalog whose user scripts and
+  // document properties are added to the script.
+  virtual void generateSQLSyncScript(db_CatalogRef cat, grt::Ref<GrtNamedObject> org_object,
+                                     const grt::DictRef& options, std::shared_ptr<grt::DiffChange>,
+                                     const std::function<void(const std::string&)>& output) = 0;
 
   virtual grt::DictRef generateSQLForDifferences(grt::Ref<GrtNamedObject>, grt::Ref<GrtNamedObject>,
                                                  grt::DictRef options) = 0;
@@ -62,6 +96,9 @@ public:
   virtual ssize_t makeSQLSyncScript(db_CatalogRef cat, grt::DictRef options, const grt::StringListRef& sql_list,
                                     const grt::ListRef<GrtNamedObject>& obj_list) = 0;
   virtual std::string makeCreateScriptForObject(GrtNamedObjectRef object) = 0;
+  // The CREATE scripts of all objects in the catalog, keyed by object id. Much faster than calling
+  // makeCreateScriptForObject() for each of them.
+  virtual grt::DictRef makeCreateScriptsForCatalog(db_CatalogRef catalog) = 0;
   virtual grt::DictRef getDefaultTraits() const = 0;
   virtual grt::DictRef getTraitsForServerVersion(const int major, const int minor, const int revision) = 0;
 };
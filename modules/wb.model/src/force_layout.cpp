@@ -0,0 +1,666 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "force_layout.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <random>
+#include <thread>
+
+// Coarsening stops when a graph has no more nodes than this or when a level doesn't shrink the graph enough.
+#define MIN_COARSE_NODES 30
+#define MIN_COARSENING_RATIO 0.8
+
+// Iterations spent on the coarsest level, intermediate levels and the final graph.
+#define COARSEST_ITERATIONS 300
+#define LEVEL_ITERATIONS 60
+#define FINEST_ITERATIONS 100
+
+// A quadtree cell is approximated by its center of mass when its size is below this fraction of the distance.
+#define BARNES_HUT_THETA 0.7
+#define MAX_TREE_DEPTH 24
+
+// Pull towards the center of the graph. It grows with the distance like the repulsion of all nodes closer to the
+// center does, which keeps the density of the layout independent of its size and disconnected parts together.
+#define GRAVITY 1.0
+
+// Forces are only computed on several threads when every thread gets at least this many nodes.
+#define MIN_NODES_PER_THREAD 128
+
+#define MAX_OVERLAP_PASSES 100
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+  /**
+   * Random numbers computed directly from the engine. The distributions of the standard library are implementation
+   * defined, which would make layouts differ between platforms for the same seed.
+   */
+  class Random {
+  public:
+    Random(unsigned int seed) : _engine(seed) {
+    }
+
+    // A value in [-1, 1).
+    double next() {
+      return (double)_engine() / 2147483648.0 - 1.0;
+    }
+
+    std::size_t below(std::size_t limit) {
+      return (std::size_t)(_engine() % limit);
+    }
+
+  private:
+    std::mt19937 _engine;
+  };
+
+  const std::size_t NoNode = std::numeric_limits<std::size_t>::max();
+
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+struct ForceLayout::Graph {
+  // Nodes are handled as circles around their center, with a radius covering the whole rectangle.
+  std::vector<double> x;
+  std::vector<double> y;
+  std::vector<double> radius;
+  std::vector<double> mass;
+  std::vector<char> pinned;
+  std::vector<std::vector<std::pair<std::size_t, double> > > edges; // Neighbour and edge weight.
+  std::vector<std::size_t> coarse; // The node this one was merged into on the next coarser level.
+
+  std::size_t size() const {
+    return x.size();
+  }
+
+  std::size_t add(double cx, double cy, double r, double m, bool p) {
+    x.push_back(cx);
+    y.push_back(cy);
+    radius.push_back(r);
+    mass.push_back(m);
+    pinned.push_back(p);
+    edges.resize(x.size());
+    return x.size() - 1;
+  }
+
+  double average_radius() const {
+    double sum = 0;
+    for (std::size_t i = 0; i < radius.size(); ++i)
+      sum += radius[i];
+    return radius.empty() ? 0 : sum / radius.size();
+  }
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+namespace {
+
+  /**
+   * Merges pairs of connected nodes (heavy edge matching). Returns false if that doesn't reduce the graph noticeably,
+   * in which case the coarse graph must not be used.
+   */
+  bool coarsen(ForceLayout::Graph &fine, ForceLayout::Graph &coarse, Random &random) {
+    std::size_t count = fine.size();
+
+    std::vector<std::size_t> order(count);
+    for (std::size_t i = 0; i < count; ++i)
+      order[i] = i;
+    for (std::size_t i = count; i > 1; --i)
+      std::swap(order[i - 1], order[random.below(i)]);
+
+    fine.coarse.assign(count, NoNode);
+    for (std::size_t i = 0; i < count; ++i) {
+      std::size_t node = order[i];
+      if (fine.coarse[node] != NoNode)
+        continue;
+
+      // Pinned nodes are never merged, they must keep their exact position on every level.
+      std::size_t partner = NoNode;
+      if (!fine.pinned[node]) {
+        double best = 0;
+        for (auto &edge : fine.edges[node]) {
+          std::size_t other = edge.first;
+          if (fine.coarse[other] != NoNode || fine.pinned[other])
+            continue;
+
+          // Prefer heavy edges between light nodes, which keeps the coarse nodes at a similar size.
+          double weight = edge.second / (fine.mass[node] + fine.mass[other]);
+          if (weight > best) {
+            best = weight;
+            partner = other;
+          }
+        }
+      }
+
+      if (partner == NoNode)
+        fine.coarse[node] =
+          coarse.add(fine.x[node], fine.y[node], fine.radius[node], fine.mass[node], fine.pinned[node] != 0);
+      else {
+        double m1 = fine.mass[node];
+        double m2 = fine.mass[partner];
+        double r1 = fine.radius[node];
+        double r2 = fine.radius[partner];
+        std::size_t merged =
+          coarse.add((fine.x[node] * m1 + fine.x[partner] * m2) / (m1 + m2),
+                     (fine.y[node] * m1 + fine.y[partner] * m2) / (m1 + m2), std::sqrt(r1 * r1 + r2 * r2), m1 + m2, false);
+        fine.coarse[node] = merged;
+        fine.coarse[partner] = merged;
+      }
+    }
+
+    if (coarse.size() > MIN_COARSENING_RATIO * count)
+      return false;
+
+    // Edges between merged nodes add up, edges within a merged node disappear.
+    std::vector<std::map<std::size_t, double> > edges(coarse.size());
+    for (std::size_t node = 0; node < count; ++node) {
+      for (auto &edge : fine.edges[node]) {
+        std::size_t from = fine.coarse[node];
+        std::size_t to = fine.coarse[edge.first];
+        if (from != to)
+          edges[from][to] += edge.second;
+      }
+    }
+    for (std::size_t i = 0; i < edges.size(); ++i)
+      coarse.edges[i].assign(edges[i].begin(), edges[i].end());
+
+    return true;
+  }
+
+  //--------------------------------------------------------------------------------------------------------------------
+
+  /**
+   * Barnes-Hut tree to approximate the repulsion of all nodes in O(n log n). Leafs at the maximum depth keep a list
+   * of bodies, which is only the case for (almost) identical positions.
+   */
+  class QuadTree {
+  public:
+    QuadTree(const ForceLayout::Graph &graph) : _graph(graph), _next(graph.size(), -1) {
+      double left = std::numeric_limits<double>::max();
+      double top = left;
+      double right = -left;
+      double bottom = -left;
+      for (std::size_t i = 0; i < graph.size(); ++i) {
+        left = std::min(left, graph.x[i]);
+        top = std::min(top, graph.y[i]);
+        right = std::max(right, graph.x[i]);
+        bottom = std::max(bottom, graph.y[i]);
+      }
+
+      _cells.reserve(graph.size() * 2);
+      new_cell(left, top, std::max(std::max(right - left, bottom - top), 1.0) * 1.001);
+      for (std::size_t i = 0; i < graph.size(); ++i)
+        insert(0, (int)i, 0);
+    }
+
+    /**
+     * Adds the repulsion all other nodes exert on the given one to fx/fy.
+     */
+    void add_repulsion(std::size_t node, double k, double &fx, double &fy) const {
+      add_repulsion(0, node, k, fx, fy);
+    }
+
+  private:
+    struct Cell {
+      double left;
+      double top;
+      double size;
+      double cx; // Center of mass.
+      double cy;
+      double mass;
+      int children[4];
+      int first_body;
+    };
+
+    const ForceLayout::Graph &_graph;
+    std::vector<Cell> _cells;
+    std::vector<int> _next;
+
+    int new_cell(double left, double top, double size) {
+      Cell cell = {left, top, size, 0, 0, 0, {-1, -1, -1, -1}, -1};
+      _cells.push_back(cell);
+      return (int)_cells.size() - 1;
+    }
+
+    bool is_leaf(int cell) const {
+      const Cell &c = _cells[cell];
+      return c.children[0] < 0 && c.children[1] < 0 && c.children[2] < 0 && c.children[3] < 0;
+    }
+
+    void insert(int cell, int body, int depth) {
+      double m = _graph.mass[body];
+      {
+        Cell &c = _cells[cell];
+        c.cx = (c.cx * c.mass + _graph.x[body] * m) / (c.mass + m);
+        c.cy = (c.cy * c.mass + _graph.y[body] * m) / (c.mass + m);
+        c.mass += m;
+
+        if (is_leaf(cell) && (c.first_body < 0 || depth >= MAX_TREE_DEPTH)) {
+          _next[body] = c.first_body;
+          c.first_body = body;
+          return;
+        }
+      }
+
+      if (is_leaf(cell)) {
+        // Split the leaf, its only body moves down.
+        int existing = _cells[cell].first_body;
+        _cells[cell].first_body = -1;
+        _next[existing] = -1;
+        insert_into_child(cell, existing, depth);
+      }
+      insert_into_child(cell, body, depth);
+    }
+
+    void insert_into_child(int cell, int body, int depth) {
+      double half = _cells[cell].size / 2;
+      double mid_x = _cells[cell].left + half;
+      double mid_y = _cells[cell].top + half;
+      int quadrant = (_graph.x[body] >= mid_x ? 1 : 0) + (_graph.y[body] >= mid_y ? 2 : 0);
+
+      int child = _cells[cell].children[quadrant];
+      if (child < 0) {
+        // Note: new_cell() may reallocate, so don't hold references into _cells across it.
+        child = new_cell((quadrant & 1) ? mid_x : _cells[cell].left, (quadrant & 2) ? mid_y : _cells[cell].top, half);
+        _cells[cell].children[quadrant] = child;
+      }
+      insert(child, body, depth + 1);
+    }
+
+    void add_repulsion(int cell, std::size_t node, double k, double &fx, double &fy) const {
+      const Cell &c = _cells[cell];
+      double x = _graph.x[node];
+      double y = _graph.y[node];
+
+      if (is_leaf(cell)) {
+        for (int body = c.first_body; body >= 0; body = _next[body]) {
+          if ((std::size_t)body != node)
+            add_force(node, x - _graph.x[body], y - _graph.y[body], _graph.radius[node] + _graph.radius[body],
+                      _graph.mass[body], body, k, fx, fy);
+        }
+        return;
+      }
+
+      double dx = x - c.cx;
+      double dy = y - c.cy;
+      double distance = std::sqrt(dx * dx + dy * dy);
+      bool inside = x >= c.left && x < c.left + c.size && y >= c.top && y < c.top + c.size;
+      if (!inside && c.size < BARNES_HUT_THETA * distance) {
+        add_force(node, dx, dy, _graph.radius[node], c.mass, cell, k, fx, fy);
+        return;
+      }
+
+      for (int i = 0; i < 4; ++i) {
+        if (c.children[i] >= 0)
+          add_repulsion(c.children[i], node, k, fx, fy);
+      }
+    }
+
+    void add_force(std::size_t node, double dx, double dy, double radii, double mass, int other, double k,
+                   double &fx, double &fy) const {
+      double distance = std::sqrt(dx * dx + dy * dy);
+      if (distance < 1e-6) {
+        // Coincident nodes: pick a direction that only depends on the pair, not on timing.
+        double angle = (double)((node * 7919 + (std::size_t)other * 104729) % 360) * 3.14159265358979323846 / 180;
+        dx = std::cos(angle);
+        dy = std::sin(angle);
+        distance = 1;
+      }
+
+      // The distance between the node borders counts, so large nodes keep their distance like small ones do.
+      double gap = std::max(distance - radii, 0.05 * k);
+      double force = mass * k * k / gap;
+      fx += dx / distance * force;
+      fy += dy / distance * force;
+    }
+  };
+
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+ForceLayout::ForceLayout(double area_width, double area_height, unsigned int seed)
+  : _area_width(area_width),
+    _area_height(area_height),
+    _seed(seed),
+    _spacing(40),
+    _thread_count(std::max(std::thread::hardware_concurrency(), 1U)) {
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::size_t ForceLayout::add_node(double x, double y, double width, double height, bool pinned) {
+  Node node = {x, y, width, height, pinned};
+  _nodes.push_back(node);
+  return _nodes.size() - 1;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void ForceLayout::add_edge(std::size_t node1, std::size_t node2) {
+  if (node1 != node2 && node1 < _nodes.size() && node2 < _nodes.size())
+    _edges.push_back(std::make_pair(node1, node2));
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void ForceLayout::set_spacing(double spacing) {
+  _spacing = spacing;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void ForceLayout::set_thread_count(unsigned int count) {
+  _thread_count = std::max(count, 1U);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void ForceLayout::run() {
+  if (_nodes.empty())
+    return;
+
+  Random random(_seed);
+
+  // Build the finest level from the nodes. Multiple edges between the same nodes add up to a heavier edge.
+  Graph finest;
+  double total_area = 0;
+  for (auto &node : _nodes) {
+    finest.add(node.x + node.width / 2, node.y + node.height / 2,
+               std::sqrt(node.width * node.width + node.height * node.height) / 2, 1, node.pinned);
+    total_area += (node.width + _spacing) * (node.height + _spacing);
+  }
+
+  {
+    std::vector<std::map<std::size_t, double> > edges(_nodes.size());
+    for (auto &edge : _edges) {
+      edges[edge.first][edge.second] += 1;
+      edges[edge.second][edge.first] += 1;
+    }
+    for (std::size_t i = 0; i < edges.size(); ++i)
+      finest.edges[i].assign(edges[i].begin(), edges[i].end());
+  }
+
+  // Ideal gap between two nodes.
+  double k = _spacing + finest.average_radius();
+
+  std::vector<Graph> levels;
+  levels.push_back(std::move(finest));
+  while (levels.back().size() > MIN_COARSE_NODES) {
+    Graph coarse;
+    if (!coarsen(levels.back(), coarse, random))
+      break;
+    levels.push_back(std::move(coarse));
+  }
+
+  // Free nodes on the coarsest level start at random positions around the pinned nodes, if there are any.
+  Graph &coarsest = levels.back();
+  double center_x = _area_width / 2;
+  double center_y = _area_height / 2;
+  {
+    double sum_x = 0;
+    double sum_y = 0;
+    std::size_t pinned = 0;
+    for (std::size_t i = 0; i < coarsest.size(); ++i) {
+      if (coarsest.pinned[i]) {
+        sum_x += coarsest.x[i];
+        sum_y += coarsest.y[i];
+        ++pinned;
+      }
+    }
+    if (pinned > 0) {
+      center_x = sum_x / pinned;
+      center_y = sum_y / pinned;
+    }
+  }
+
+  double extent = 1.5 * std::sqrt(total_area);
+  for (std::size_t i = 0; i < coarsest.size(); ++i) {
+    if (!coarsest.pinned[i]) {
+      coarsest.x[i] = center_x + random.next() * extent / 2;
+      coarsest.y[i] = center_y + random.next() * extent / 2;
+    }
+  }
+
+  for (std::size_t level = levels.size(); level > 0; --level) {
+    Graph &graph = levels[level - 1];
+    if (level == levels.size())
+      layout_level(graph, COARSEST_ITERATIONS, k, extent / 4);
+    else {
+      // Start from the position of the coarse node, spread a bit to separate nodes which were merged.
+      Graph &coarse = levels[level];
+      for (std::size_t i = 0; i < graph.size(); ++i) {
+        if (!graph.pinned[i]) {
+          graph.x[i] = coarse.x[graph.coarse[i]] + random.next() * graph.radius[i];
+          graph.y[i] = coarse.y[graph.coarse[i]] + random.next() * graph.radius[i];
+        }
+      }
+      layout_level(graph, level == 1 ? FINEST_ITERATIONS : LEVEL_ITERATIONS, k, 2 * k);
+    }
+  }
+
+  Graph &result = levels.front();
+  for (std::size_t i = 0; i < _nodes.size(); ++i) {
+    if (!_nodes[i].pinned) {
+      _nodes[i].x = result.x[i] - _nodes[i].width / 2;
+      _nodes[i].y = result.y[i] - _nodes[i].height / 2;
+    }
+  }
+
+  remove_overlaps();
+  move_into_area();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Fruchterman-Reingold style layout of a single level with a temperature that cools down geometrically. Connected
+ * nodes attract each other only logarithmically, a quadratic attraction pulls densely connected nodes into clumps.
+ */
+void ForceLayout::layout_level(Graph &graph, int iterations, double k, double temperature) {
+  std::size_t count = graph.size();
+  std::vector<double> dx(count);
+  std::vector<double> dy(count);
+
+  double final_temperature = 0.05 * k;
+  if (temperature < final_temperature)
+    temperature = final_temperature;
+  double cooling = std::pow(final_temperature / temperature, 1.0 / iterations);
+
+  // Every node only writes its own displacement, hence splitting the nodes over threads gives the same result
+  // as computing them in a single thread.
+  std::size_t thread_count = std::min((std::size_t)_thread_count, count / MIN_NODES_PER_THREAD);
+  if (thread_count < 1)
+    thread_count = 1;
+
+  for (int iteration = 0; iteration < iterations; ++iteration) {
+    QuadTree tree(graph);
+
+    double center_x = 0;
+    double center_y = 0;
+    double total_mass = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+      center_x += graph.x[i] * graph.mass[i];
+      center_y += graph.y[i] * graph.mass[i];
+      total_mass += graph.mass[i];
+    }
+    center_x /= total_mass;
+    center_y /= total_mass;
+
+    auto compute = [&](std::size_t begin, std::size_t end) {
+      for (std::size_t i = begin; i < end; ++i) {
+        double fx = 0;
+        double fy = 0;
+        if (!graph.pinned[i]) {
+          tree.add_repulsion(i, k, fx, fy);
+
+          for (auto &edge : graph.edges[i]) {
+            std::size_t other = edge.first;
+            double ex = graph.x[other] - graph.x[i];
+            double ey = graph.y[other] - graph.y[i];
+            double distance = std::sqrt(ex * ex + ey * ey);
+            if (distance < 1e-6)
+              continue;
+            double gap = std::max(distance - graph.radius[i] - graph.radius[other], 0.0);
+            double force = edge.second * k * std::log(1 + gap / k) / graph.mass[i];
+            fx += ex / distance * force;
+            fy += ey / distance * force;
+          }
+
+          fx += (center_x - graph.x[i]) * GRAVITY;
+          fy += (center_y - graph.y[i]) * GRAVITY;
+        }
+        dx[i] = fx;
+        dy[i] = fy;
+      }
+    };
+
+    if (thread_count == 1)
+      compute(0, count);
+    else {
+      std::vector<std::thread> threads;
+      std::size_t chunk = (count + thread_count - 1) / thread_count;
+      for (std::size_t begin = chunk; begin < count; begin += chunk)
+        threads.push_back(std::thread(compute, begin, std::min(begin + chunk, count)));
+      compute(0, std::min(chunk, count));
+      for (auto &thread : threads)
+        thread.join();
+    }
+
+    for (std::size_t i = 0; i < count; ++i) {
+      if (graph.pinned[i])
+        continue;
+
+      double length = std::sqrt(dx[i] * dx[i] + dy[i] * dy[i]);
+      if (length > 0) {
+        double scale = std::min(length, temperature) / length;
+        graph.x[i] += dx[i] * scale;
+        graph.y[i] += dy[i] * scale;
+      }
+    }
+
+    temperature *= cooling;
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Forces only keep nodes roughly apart. This pass pushes apart any rectangles which still overlap (including
+ * the spacing), along the axis that needs the smaller move. Pinned nodes are never moved.
+ */
+void ForceLayout::remove_overlaps() {
+  std::size_t count = _nodes.size();
+  std::vector<std::size_t> order(count);
+  for (std::size_t i = 0; i < count; ++i)
+    order[i] = i;
+
+  double gap = _spacing / 2;
+  for (int pass = 0; pass < MAX_OVERLAP_PASSES; ++pass) {
+    std::sort(order.begin(), order.end(), [this](std::size_t a, std::size_t b) {
+      return _nodes[a].x < _nodes[b].x || (_nodes[a].x == _nodes[b].x && a < b);
+    });
+
+    bool moved = false;
+    for (std::size_t i = 0; i < count; ++i) {
+      Node &a = _nodes[order[i]];
+      for (std::size_t j = i + 1; j < count; ++j) {
+        Node &b = _nodes[order[j]];
+        if (b.x >= a.x + a.width + gap)
+          break;
+        if (a.pinned && b.pinned)
+          continue;
+
+        double overlap_x = std::min(a.x + a.width + gap - b.x, b.x + b.width + gap - a.x);
+        double overlap_y = std::min(a.y + a.height + gap - b.y, b.y + b.height + gap - a.y);
+        if (overlap_x <= 0 || overlap_y <= 0)
+          continue;
+
+        moved = true;
+        double share = a.pinned ? 0 : (b.pinned ? 1 : 0.5); // Part of the move done by a.
+        if (overlap_x < overlap_y) {
+          double direction = (a.x + a.width / 2 <= b.x + b.width / 2) ? 1 : -1;
+          a.x -= direction * overlap_x * share;
+          b.x += direction * overlap_x * (1 - share);
+        } else {
+          double direction = (a.y + a.height / 2 <= b.y + b.height / 2) ? 1 : -1;
+          a.y -= direction * overlap_y * share;
+          b.y += direction * overlap_y * (1 - share);
+        }
+      }
+    }
+
+    if (!moved)
+      break;
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Positions are relative to the layout area. Without pinned nodes the whole layout goes to its top left corner,
+ * otherwise only the free nodes are moved, as far as needed to not end up at negative coordinates.
+ */
+void ForceLayout::move_into_area() {
+  double margin = _spacing / 2;
+  double left = std::numeric_limits<double>::max();
+  double top = left;
+  bool has_pinned = false;
+  for (auto &node : _nodes) {
+    if (node.pinned)
+      has_pinned = true;
+    else {
+      left = std::min(left, node.x);
+      top = std::min(top, node.y);
+    }
+  }
+
+  if (left == std::numeric_limits<double>::max())
+    return;
+
+  double dx = margin - left;
+  double dy = margin - top;
+  if (has_pinned) {
+    dx = std::max(dx, 0.0);
+    dy = std::max(dy, 0.0);
+    if (dx == 0 && dy == 0)
+      return;
+  }
+
+  for (auto &node : _nodes) {
+    if (!node.pinned) {
+      node.x += dx;
+      node.y += dy;
+    }
+  }
+
+  if (has_pinned)
+    remove_overlaps();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
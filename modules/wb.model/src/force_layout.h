@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#pragma once
+
+#include "wb_model_public_interface.h"
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * Multilevel force directed layout for diagram figures.
+ *
+ * The graph is repeatedly coarsened by merging connected nodes, the coarsest graph is laid out first and each
+ * finer level starts from the positions of the level above. Repulsion between nodes is approximated with a
+ * Barnes-Hut quadtree and the forces of a step are computed on several threads. Overlaps left at the end are
+ * removed in a final pass.
+ *
+ * Nodes are rectangles given by their top left corner and size. Pinned nodes keep their position, but still push
+ * other nodes away. The result only depends on the input and the seed, not on the number of threads used.
+ */
+class WB_MODEL_WBM_PUBLIC_FUNC ForceLayout {
+public:
+  struct Node {
+    double x; // top left corner
+    double y;
+    double width;
+    double height;
+    bool pinned;
+  };
+
+  struct Graph; // One level of the multilevel layout.
+
+  ForceLayout(double area_width, double area_height, unsigned int seed = 1);
+
+  std::size_t add_node(double x, double y, double width, double height, bool pinned = false);
+  void add_edge(std::size_t node1, std::size_t node2);
+
+  void set_spacing(double spacing);
+  void set_thread_count(unsigned int count);
+
+  void run();
+
+  std::size_t node_count() const {
+    return _nodes.size();
+  }
+
+  const Node &node(std::size_t index) const {
+    return _nodes[index];
+  }
+
+private:
+  double _area_width;
+  double _area_height;
+  unsigned int _seed;
+  double _spacing;
+  unsigned int _thread_count;
+
+  std::vector<Node> _nodes;
+  std::vector<std::pair<std::size_t, std::size_t> > _edges;
+
+  void layout_level(Graph &graph, int iterations, double k, double temperature);
+  void remove_overlaps();
+  void move_into_area();
+};
@@ -62,6 +62,13 @@
 
 #include "mtemplate/template.h"
 
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
 using namespace base;
 using namespace Scintilla;
 
@@ -824,43 +831,56 @@ const std::string markupFromStyle(int style) {
 
 //----------------------------------------------------------------------------------------------------------------------
 
-void set_ddl(mtemplate::DictionaryInterface *target, SQLGeneratorInterfaceImpl *sqlgenModule,
-             const GrtNamedObjectRef &object, const Scintilla::LexerModule *lexer, bool ddl_enabled) {
-  if (ddl_enabled && sqlgenModule != NULL) {
-    std::string sql = sqlgenModule->makeCreateScriptForObject(object);
-
-    if (lexer != NULL) {
-      // Add syntax highlighter markup.
-      LexerDocument *document = new LexerDocument(sql);
-      SCI_WRAPPER_NS PropSetSimple property_set;
-      SCI_WRAPPER_NS Accessor *accessor = new SCI_WRAPPER_NS Accessor(document, &property_set);
-
-      lexer->Lex(0, (int)sql.size(), 0, keywordLists, *accessor);
-
-      int currentStyle = SCE_MYSQL_DEFAULT;
-      int tokenStart = 0;
-      std::string markup = "";
-      int i;
-      for (i = 0; i < (int)sql.size(); i++)
-        if (currentStyle != accessor->StyleAt(i)) {
-          markup += base::replaceString(markupFromStyle(currentStyle), "%s", sql.substr(tokenStart, i - tokenStart));
-          tokenStart = i;
-          currentStyle = accessor->StyleAt(i);
-        }
+/**
+ * Returns the given SQL prepared for the DDL_SCRIPT variable, optionally with syntax highlighter markup.
+ * Does not touch any shared state, so it can run on several threads at once.
+ */
+static std::string ddl_markup(std::string sql, const Scintilla::LexerModule *lexer) {
+  if (lexer != NULL) {
+    // Add syntax highlighter markup.
+    LexerDocument *document = new LexerDocument(sql);
+    SCI_WRAPPER_NS PropSetSimple property_set;
+    SCI_WRAPPER_NS Accessor *accessor = new SCI_WRAPPER_NS Accessor(document, &property_set);
+
+    lexer->Lex(0, (int)sql.size(), 0, keywordLists, *accessor);
+
+    int currentStyle = SCE_MYSQL_DEFAULT;
+    int tokenStart = 0;
+    std::string markup = "";
+    int i;
+    for (i = 0; i < (int)sql.size(); i++)
+      if (currentStyle != accessor->StyleAt(i)) {
+        markup += base::replaceString(markupFromStyle(currentStyle), "%s", sql.substr(tokenStart, i - tokenStart));
+        tokenStart = i;
+        currentStyle = accessor->StyleAt(i);
+      }
 
-      markup += base::replaceString(markupFromStyle(currentStyle), "%s", sql.substr(tokenStart, i - tokenStart));
+    markup += base::replaceString(markupFromStyle(currentStyle), "%s", sql.substr(tokenStart, i - tokenStart));
 
-      delete accessor;
-      delete document;
+    delete accessor;
+    delete document;
 
-      sql = markup;
-    };
+    sql = markup;
+  };
 
-    std::string fixed_line_breaks = base::replaceString(sql, "\n", "<br />");
+  return base::replaceString(sql, "\n", "<br />");
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Adds the DDL of the given object, taken from the precomputed ddl map (object id -> markup). No DDL is shown if
+ * there is no map.
+ */
+void set_ddl(mtemplate::DictionaryInterface *target, const std::map<std::string, std::string> *ddl,
+             const GrtNamedObjectRef &object) {
+  if (ddl != NULL) {
+    std::map<std::string, std::string>::const_iterator iterator = ddl->find(object.id());
 
     // The DDL script is wrapped in an own section dir to allow switching it off entirely (including
     // the surrounding HTML code).
-    target->setValueAndShowSection(REPORT_DDL_SCRIPT, fixed_line_breaks, REPORT_DDL_LISTING);
+    if (iterator != ddl->end())
+      target->setValueAndShowSection(REPORT_DDL_SCRIPT, iterator->second, REPORT_DDL_LISTING);
   }
 }
 
@@ -891,6 +911,333 @@ static int count_template_files(const std::string template_dir) {
 
 //----------------------------------------------------------------------------------------------------------------------
 
+/**
+ * Runs work(i) for every i in [0, count) on as many threads as there are cores. Each index is processed exactly
+ * once, in no particular order. The first exception thrown by work is passed on to the caller.
+ */
+static void parallel_for(std::size_t count, const std::function<void(std::size_t)> &work) {
+  std::size_t threadCount = std::min<std::size_t>(std::max(std::thread::hardware_concurrency(), 1U), count);
+  if (threadCount < 2) {
+    for (std::size_t i = 0; i < count; ++i)
+      work(i);
+    return;
+  }
+
+  std::atomic<std::size_t> next(0);
+  std::exception_ptr error;
+  std::mutex errorMutex;
+
+  auto run = [&]() {
+    try {
+      for (std::size_t i = next++; i < count; i = next++)
+        work(i);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(errorMutex);
+      if (!error)
+        error = std::current_exception();
+      next = count;
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (std::size_t i = 1; i < threadCount; ++i)
+    threads.push_back(std::thread(run));
+  run();
+  for (auto &thread : threads)
+    thread.join();
+
+  if (error)
+    std::rethrow_exception(error);
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Creates the template dictionaries of the schemata in a report. Each schema gets a dictionary of its own, which
+ * does not depend on any other schema (the running ids of tables, columns etc. are computed upfront). So schemata
+ * can be processed in parallel and the report can be written schema by schema, instead of holding the dictionaries
+ * for the entire catalog.
+ */
+class SchemaReportBuilder {
+public:
+  struct Options {
+    bool columns_show;
+    bool indices_show;
+    bool fks_show;
+    bool fks_show_referred_fks;
+  };
+
+  // The running ids of the objects in a report.
+  struct Counters {
+    int tables = 0;
+    int columns = 0;
+    int indices = 0;
+    int fks = 0;
+    int triggers = 0;
+    int views = 0;
+    int routines = 0;
+  };
+
+  SchemaReportBuilder(const db_mysql_CatalogRef &catalog, const Options &options,
+                      const std::map<std::string, std::vector<db_mysql_ForeignKeyRef> > &tbl_fk_map,
+                      const std::map<std::string, std::string> *ddl, mtemplate::Dictionary *main_dictionary)
+    : _catalog(catalog), _options(options), _tbl_fk_map(tbl_fk_map), _ddl(ddl), _main_dictionary(main_dictionary),
+      _batch_start(0) {
+    for (std::size_t i = 0; i < catalog->schemata().count(); i++) {
+      db_mysql_SchemaRef schema = catalog->schemata().get(i);
+
+      _first_ids.push_back(_totals);
+      for (std::size_t j = 0; j < schema->tables().count(); j++) {
+        db_mysql_TableRef table = schema->tables().get(j);
+
+        _totals.tables++;
+        if (_options.columns_show)
+          _totals.columns += (int)table->columns().count();
+        if (_options.indices_show)
+          _totals.indices += (int)table->indices().count();
+        if (_options.fks_show) {
+          _totals.fks += (int)table->foreignKeys().count();
+          _totals.triggers += (int)table->triggers().count();
+        }
+      }
+      _totals.views += (int)schema->views().count();
+      _totals.routines += (int)schema->routines().count();
+    }
+  }
+
+  const Counters &totals() const {
+    return _totals;
+  }
+
+  std::size_t schemaCount() const {
+    return _first_ids.size();
+  }
+
+  /**
+   * Returns the dictionary for the schema at index, for expansion as a section of the main dictionary. It is not
+   * added to the main dictionary though, the caller takes ownership. Can be called from any thread.
+   */
+  mtemplate::Dictionary *createSchemaDictionary(std::size_t index);
+
+  /**
+   * Returns the dictionary for the schema at index or NULL if there is none, the caller takes ownership.
+   * Dictionaries are created ahead of time in parallel batches, so this is best called with increasing indices.
+   */
+  mtemplate::DictionaryInterface *nextSchemaDictionary(std::size_t index) {
+    if (index >= schemaCount())
+      return NULL;
+
+    if (index < _batch_start || index >= _batch_start + _batch.size() || !_batch[index - _batch_start]) {
+      std::size_t size =
+        std::min<std::size_t>(std::max(std::thread::hardware_concurrency(), 1U), schemaCount() - index);
+
+      _batch.clear();
+      _batch.resize(size);
+      _batch_start = index;
+      parallel_for(size, [&](std::size_t i) { _batch[i].reset(createSchemaDictionary(index + i)); });
+    }
+
+    return _batch[index - _batch_start].release();
+  }
+
+private:
+  db_mysql_CatalogRef _catalog;
+  Options _options;
+  const std::map<std::string, std::vector<db_mysql_ForeignKeyRef> > &_tbl_fk_map;
+  const std::map<std::string, std::string> *_ddl;
+  mtemplate::Dictionary *_main_dictionary;
+
+  std::vector<Counters> _first_ids; // The ids the objects of each schema start with.
+  Counters _totals;
+
+  std::size_t _batch_start;
+  std::vector<std::unique_ptr<mtemplate::Dictionary> > _batch;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+mtemplate::Dictionary *SchemaReportBuilder::createSchemaDictionary(std::size_t index) {
+  db_mysql_SchemaRef schema = _catalog->schemata().get(index);
+  Counters ids = _first_ids[index];
+
+  bool columns_show = _options.columns_show;
+  bool indices_show = _options.indices_show;
+  bool fks_show = _options.fks_show;
+  bool fks_show_referred_fks = _options.fks_show_referred_fks;
+
+  int i = (int)index;
+  mtemplate::Dictionary *schema_dictionary = _main_dictionary->createSectionDictionary(REPORT_SCHEMATA);
+  schema_dictionary->setIsLast(index + 1 == schemaCount());
+  schema_dictionary->setIntValue(REPORT_SCHEMA_ID, i);
+  schema_dictionary->setIntValue(REPORT_SCHEMA_NUMBER, i + 1);
+  schema_dictionary->setValue(REPORT_SCHEMA_NAME, *schema->name());
+
+  set_ddl(schema_dictionary, _ddl, schema);
+
+  schema_dictionary->setIntValue(REPORT_TABLE_COUNT, (int)schema->tables().count());
+
+  // Loop over all tables. Build the nested tables sub groups and at the same time the
+  // full collection of all columns, indices and foreign keys.
+  for (int j = 0; j < (int)schema->tables().count(); j++) {
+    db_mysql_TableRef table = schema->tables().get(j);
+
+    mtemplate::DictionaryInterface *table_dictionary = schema_dictionary->addSectionDictionary(REPORT_TABLES);
+
+    // The table id is used as unique id, e.g. in HTML anchors.
+    table_dictionary->setIntValue(REPORT_TABLE_ID, ids.tables++);
+
+    // The table number is used in visible counts like "Table 1 of 20".
+    table_dictionary->setIntValue(REPORT_TABLE_NUMBER, j + 1);
+
+    table_dictionary->setValue(REPORT_TABLE_NAME, *table->name());
+    table_dictionary->setValueAndShowSection(REPORT_TABLE_COMMENT, *table->comment(), REPORT_TABLE_COMMENT_LISTING);
+
+    fillTablePropertyDict(table, table_dictionary);
+    set_ddl(table_dictionary, _ddl, table);
+
+    if (columns_show) {
+      mtemplate::DictionaryInterface *columns_list_dictionary = NULL;
+
+      schema_dictionary->setIntValue(REPORT_COLUMN_COUNT, (long)table->columns().count());
+
+      for (int k = 0; k < (int)table->columns().count(); k++) {
+        // Create the dict for the outer section (including header)
+        if (k == 0)
+          columns_list_dictionary = table_dictionary->addSectionDictionary(REPORT_COLUMNS_LISTING);
+
+        db_mysql_ColumnRef col = table->columns().get(k);
+
+        // Fill data for table details.
+        mtemplate::DictionaryInterface *col_dictionary = columns_list_dictionary->addSectionDictionary(REPORT_COLUMNS);
+
+        fillColumnDict(col, table, col_dictionary, false);
+
+        // Fill data for full details.
+        col_dictionary = schema_dictionary->addSectionDictionary(REPORT_COLUMNS);
+
+        fillColumnDict(col, table, col_dictionary, true);
+
+        col_dictionary->setIntValue(REPORT_COLUMN_ID, ids.columns++);
+        col_dictionary->setIntValue(REPORT_COLUMN_NUMBER, k + 1);
+      }
+    }
+
+    if (indices_show) {
+      mtemplate::DictionaryInterface *idx_list_dictionary = NULL;
+
+      schema_dictionary->setIntValue(REPORT_INDEX_COUNT, (long)table->indices().count());
+
+      for (int k = 0; k < (int)table->indices().count(); k++) {
+        // Create the dict for the outer section (including header)
+        if (k == 0)
+          idx_list_dictionary = table_dictionary->addSectionDictionary(REPORT_INDICES_LISTING);
+
+        db_mysql_IndexRef idx = table->indices().get(k);
+
+        mtemplate::DictionaryInterface *idx_dictionary = idx_list_dictionary->addSectionDictionary(REPORT_INDICES);
+
+        fillIndexDict(idx, table, idx_dictionary, false);
+
+        idx_dictionary = schema_dictionary->addSectionDictionary(REPORT_INDICES);
+        fillIndexDict(idx, table, idx_dictionary, true);
+
+        idx_dictionary->setIntValue(REPORT_INDEX_ID, ids.indices++);
+        idx_dictionary->setIntValue(REPORT_INDEX_NUMBER, k + 1);
+      }
+    }
+
+    if (fks_show) {
+      mtemplate::DictionaryInterface *fk_list_dictionary = NULL;
+
+      schema_dictionary->setIntValue(REPORT_FOREIGN_KEY_COUNT, (long)table->foreignKeys().count());
+
+      for (int k = 0; k < (int)table->foreignKeys().count(); k++) {
+        // Create the dict for the outer section (inluding header)
+        if (k == 0)
+          fk_list_dictionary = table_dictionary->addSectionDictionary(REPORT_REL_LISTING);
+
+        db_mysql_ForeignKeyRef fk = table->foreignKeys().get(k);
+
+        mtemplate::DictionaryInterface *fk_dictionary = fk_list_dictionary->addSectionDictionary(REPORT_REL);
+        fillForeignKeyDict(fk, table, fk_dictionary, false);
+
+        fk_dictionary = schema_dictionary->addSectionDictionary(REPORT_FOREIGN_KEYS);
+        fillForeignKeyDict(fk, table, fk_dictionary, true);
+
+        fk_dictionary->setIntValue(REPORT_FOREIGN_KEY_ID, ids.fks++);
+        fk_dictionary->setIntValue(REPORT_FOREIGN_KEY_NUMBER, k + 1);
+      }
+
+      if (fks_show_referred_fks) {
+        std::map<std::string, std::vector<db_mysql_ForeignKeyRef> >::const_iterator tbl_fk_map_it =
+          _tbl_fk_map.find(table->id());
+        if (tbl_fk_map_it != _tbl_fk_map.end()) {
+          std::vector<db_mysql_ForeignKeyRef>::const_iterator fk_it = tbl_fk_map_it->second.begin();
+          for (; fk_it != tbl_fk_map_it->second.end(); fk_it++) {
+            if (fk_list_dictionary == NULL)
+              fk_list_dictionary = table_dictionary->addSectionDictionary(REPORT_REL_LISTING);
+
+            db_mysql_ForeignKeyRef fk = *fk_it;
+
+            mtemplate::DictionaryInterface *fk_dictionary = fk_list_dictionary->addSectionDictionary(REPORT_REL);
+            fk_dictionary->setValue(REPORT_REL_NAME, *fk->name());
+            fk_dictionary->setValue(REPORT_REL_TYPE, bec::TableHelper::is_identifying_foreign_key(table, fk)
+                                                       ? "Identifying"
+                                                       : "Non-Identifying");
+            fk_dictionary->setValue(REPORT_REL_PARENTTABLE, *table->name());
+            fk_dictionary->setValue(REPORT_REL_CHILDTABLE, *fk->owner()->name());
+            fk_dictionary->setValue(REPORT_REL_CARD, (fk->many() == 1) ? "1:n" : "1:1");
+          }
+        }
+      }
+
+      // Triggers.
+      schema_dictionary->setIntValue(REPORT_TRIGGER_COUNT, (long)table->triggers().count());
+
+      for (int k = 0; k < (int)table->triggers().count(); k++) {
+        db_mysql_TriggerRef trigger = table->triggers().get(k);
+
+        mtemplate::DictionaryInterface *trigger_dictionary = schema_dictionary->addSectionDictionary(REPORT_TRIGGERS);
+        fillTriggerDict(trigger, table, trigger_dictionary);
+        set_ddl(trigger_dictionary, _ddl, trigger);
+
+        trigger_dictionary->setIntValue(REPORT_TRIGGER_ID, ids.triggers++);
+        trigger_dictionary->setIntValue(REPORT_TRIGGER_NUMBER, k + 1);
+      }
+    }
+  }
+
+  // View section.
+  schema_dictionary->setIntValue(REPORT_VIEW_COUNT, (long)schema->views().count());
+  for (int j = 0; j < (int)schema->views().count(); j++) {
+    db_mysql_ViewRef view = schema->views().get(j);
+
+    mtemplate::DictionaryInterface *view_dictionary = schema_dictionary->addSectionDictionary(REPORT_VIEWS);
+    view_dictionary->setIntValue(REPORT_VIEW_ID, ids.views++);
+    view_dictionary->setIntValue(REPORT_VIEW_NUMBER, j + 1);
+    set_ddl(view_dictionary, _ddl, view);
+
+    fillViewDict(view, view_dictionary);
+  }
+
+  // Routine section.
+  schema_dictionary->setIntValue(REPORT_ROUTINE_COUNT, (long)schema->routines().count());
+  for (int j = 0; j < (int)schema->routines().count(); j++) {
+    db_mysql_RoutineRef routine = schema->routines().get(j);
+
+    mtemplate::DictionaryInterface *routine_dictionary = schema_dictionary->addSectionDictionary(REPORT_ROUTINES);
+    routine_dictionary->setIntValue(REPORT_ROUTINE_ID, ids.routines++);
+    routine_dictionary->setIntValue(REPORT_ROUTINE_NUMBER, j + 1);
+    set_ddl(routine_dictionary, _ddl, routine);
+
+    fillRoutineDict(routine, routine_dictionary);
+  }
+
+  return schema_dictionary;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
 /**
  * @brief Generates a schema report for the model passed in workbench_physical_Model.
  *
@@ -994,7 +1341,7 @@ ssize_t WbModelImpl::generateReport(workbench_physical_ModelRef model, const grt
   }
 
   // create main dictionary that will be used to expand the templates
-  mtemplate::DictionaryInterface *main_dictionary = mtemplate::CreateMainDictionary();
+  std::unique_ptr<mtemplate::Dictionary> main_dictionary(mtemplate::CreateMainDictionary());
 
   // Set some global project info.
   main_dictionary->setValue(REPORT_TITLE, title);
@@ -1020,200 +1367,74 @@ ssize_t WbModelImpl::generateReport(workbench_physical_ModelRef model, const grt
 
   main_dictionary->setIntValue(REPORT_SCHEMA_COUNT, (long int)catalog->schemata().count());
 
-  int total_column_count = 0;
-  int total_index_count = 0;
-  int total_fk_count = 0;
-  int total_table_count = 0;
-  int total_view_count = 0;
-  int total_sp_count = 0;
-  int total_trigger_count = 0;
-
-  SQLGeneratorInterfaceImpl *sqlgenModule = NULL;
-
+  // The DDL of all objects is generated in one go (instead of per object, which diffs the entire catalog each time)
+  // and highlighted in parallel. It is kept for the entire report, as several template files can show it.
+  std::map<std::string, std::string> ddl;
   if (show_ddl) {
-    sqlgenModule = dynamic_cast<SQLGeneratorInterfaceImpl *>(grt::GRT::get()->get_module("DbMySQL"));
+    SQLGeneratorInterfaceImpl *sqlgenModule =
+      dynamic_cast<SQLGeneratorInterfaceImpl *>(grt::GRT::get()->get_module("DbMySQL"));
     if (!sqlgenModule)
       throw std::logic_error("could not find SQL generation module for mysql");
-  }
-
-  // Build schema_dict by looping over all schemata, add it to the main_dict.
-  for (int i = 0; i < (int)catalog->schemata().count(); i++) {
-    db_mysql_SchemaRef schema = catalog->schemata().get(i);
-
-    mtemplate::DictionaryInterface *schema_dictionary = main_dictionary->addSectionDictionary(REPORT_SCHEMATA);
-    schema_dictionary->setIntValue(REPORT_SCHEMA_ID, i);
-    schema_dictionary->setIntValue(REPORT_SCHEMA_NUMBER, i + 1);
-    schema_dictionary->setValue(REPORT_SCHEMA_NAME, *schema->name());
-
-    set_ddl(schema_dictionary, sqlgenModule, schema, lexer, show_ddl);
-
-    schema_dictionary->setIntValue(REPORT_TABLE_COUNT, (int)schema->tables().count());
-
-    // Loop over all tables. Build the nested tables sub groups and at the same time the
-    // full collection of all columns, indices and foreign keys.
-    for (int j = 0; j < (int)schema->tables().count(); j++) {
-      db_mysql_TableRef table = schema->tables().get(j);
-
-      mtemplate::DictionaryInterface *table_dictionary = schema_dictionary->addSectionDictionary(REPORT_TABLES);
-
-      // The table id is used as unique id, e.g. in HTML anchors.
-      table_dictionary->setIntValue(REPORT_TABLE_ID, total_table_count++);
-
-      // The table number is used in visible counts like "Table 1 of 20".
-      table_dictionary->setIntValue(REPORT_TABLE_NUMBER, j + 1);
-
-      table_dictionary->setValue(REPORT_TABLE_NAME, *table->name());
-      table_dictionary->setValueAndShowSection(REPORT_TABLE_COMMENT, *table->comment(), REPORT_TABLE_COMMENT_LISTING);
-
-      fillTablePropertyDict(table, table_dictionary);
-      set_ddl(table_dictionary, sqlgenModule, table, lexer, show_ddl);
-
-      if (columns_show) {
-        mtemplate::DictionaryInterface *columns_list_dictionary = NULL;
-
-        schema_dictionary->setIntValue(REPORT_COLUMN_COUNT, (long)table->columns().count());
-
-        for (int k = 0; k < (int)table->columns().count(); k++) {
-          // Create the dict for the outer section (including header)
-          if (k == 0)
-            columns_list_dictionary = table_dictionary->addSectionDictionary(REPORT_COLUMNS_LISTING);
-
-          db_mysql_ColumnRef col = table->columns().get(k);
-
-          // Fill data for table details.
-          mtemplate::DictionaryInterface *col_dictionary =
-            columns_list_dictionary->addSectionDictionary(REPORT_COLUMNS);
-
-          fillColumnDict(col, table, col_dictionary, false);
-
-          // Fill data for full details.
-          col_dictionary = schema_dictionary->addSectionDictionary(REPORT_COLUMNS);
 
-          fillColumnDict(col, table, col_dictionary, true);
-
-          col_dictionary->setIntValue(REPORT_COLUMN_ID, total_column_count++);
-          col_dictionary->setIntValue(REPORT_COLUMN_NUMBER, k + 1);
-        }
-      }
-
-      if (indices_show) {
-        mtemplate::DictionaryInterface *idx_list_dictionary = NULL;
-
-        schema_dictionary->setIntValue(REPORT_INDEX_COUNT, (long)table->indices().count());
-
-        for (int k = 0; k < (int)table->indices().count(); k++) {
-          // Create the dict for the outer section (including header)
-          if (k == 0)
-            idx_list_dictionary = table_dictionary->addSectionDictionary(REPORT_INDICES_LISTING);
-
-          db_mysql_IndexRef idx = table->indices().get(k);
-
-          mtemplate::DictionaryInterface *idx_dictionary = idx_list_dictionary->addSectionDictionary(REPORT_INDICES);
-
-          fillIndexDict(idx, table, idx_dictionary, false);
-
-          idx_dictionary = schema_dictionary->addSectionDictionary(REPORT_INDICES);
-          fillIndexDict(idx, table, idx_dictionary, true);
-
-          idx_dictionary->setIntValue(REPORT_INDEX_ID, total_index_count++);
-          idx_dictionary->setIntValue(REPORT_INDEX_NUMBER, k + 1);
-        }
-      }
-
-      if (fks_show) {
-        mtemplate::DictionaryInterface *fk_list_dictionary = NULL;
-
-        schema_dictionary->setIntValue(REPORT_FOREIGN_KEY_COUNT, (long)table->foreignKeys().count());
-
-        for (int k = 0; k < (int)table->foreignKeys().count(); k++) {
-          // Create the dict for the outer section (inluding header)
-          if (k == 0)
-            fk_list_dictionary = table_dictionary->addSectionDictionary(REPORT_REL_LISTING);
-
-          db_mysql_ForeignKeyRef fk = table->foreignKeys().get(k);
-
-          mtemplate::DictionaryInterface *fk_dictionary = fk_list_dictionary->addSectionDictionary(REPORT_REL);
-          fillForeignKeyDict(fk, table, fk_dictionary, false);
-
-          fk_dictionary = schema_dictionary->addSectionDictionary(REPORT_FOREIGN_KEYS);
-          fillForeignKeyDict(fk, table, fk_dictionary, true);
-
-          fk_dictionary->setIntValue(REPORT_FOREIGN_KEY_ID, total_fk_count++);
-          fk_dictionary->setIntValue(REPORT_FOREIGN_KEY_NUMBER, k + 1);
-        }
-
-        if (fks_show_referred_fks) {
-          std::map<std::string, std::vector<db_mysql_ForeignKeyRef> >::iterator tbl_fk_map_it = tbl_fk_map.find(table->id());
-          if (tbl_fk_map_it != tbl_fk_map.end()) {
-            std::vector<db_mysql_ForeignKeyRef>::iterator fk_it = tbl_fk_map_it->second.begin();
-            for (; fk_it != tbl_fk_map_it->second.end(); fk_it++) {
-              if (fk_list_dictionary == NULL)
-                fk_list_dictionary = table_dictionary->addSectionDictionary(REPORT_REL_LISTING);
-
-              db_mysql_ForeignKeyRef fk = *fk_it;
-
-              mtemplate::DictionaryInterface *fk_dictionary = fk_list_dictionary->addSectionDictionary(REPORT_REL);
-              fk_dictionary->setValue(REPORT_REL_NAME, *fk->name());
-              fk_dictionary->setValue(REPORT_REL_TYPE, bec::TableHelper::is_identifying_foreign_key(table, fk)
-                                                         ? "Identifying"
-                                                         : "Non-Identifying");
-              fk_dictionary->setValue(REPORT_REL_PARENTTABLE, *table->name());
-              fk_dictionary->setValue(REPORT_REL_CHILDTABLE, *fk->owner()->name());
-              fk_dictionary->setValue(REPORT_REL_CARD, (fk->many() == 1) ? "1:n" : "1:1");
-            }
-          }
-        }
-
-        // Triggers.
-        schema_dictionary->setIntValue(REPORT_TRIGGER_COUNT, (long)table->triggers().count());
-
-        for (int k = 0; k < (int)table->triggers().count(); k++) {
-          db_mysql_TriggerRef trigger = table->triggers().get(k);
-
-          mtemplate::DictionaryInterface *trigger_dictionary = schema_dictionary->addSectionDictionary(REPORT_TRIGGERS);
-          fillTriggerDict(trigger, table, trigger_dictionary);
-          set_ddl(trigger_dictionary, sqlgenModule, trigger, lexer, show_ddl);
+    grt::DictRef scripts = sqlgenModule->makeCreateScriptsForCatalog(catalog);
+    std::vector<std::string> ids;
+    std::vector<std::string> sql;
+    auto add = [&](const GrtNamedObjectRef &object) {
+      ids.push_back(object.id());
+      sql.push_back(scripts.get_string(object.id(), ""));
+    };
 
-          trigger_dictionary->setIntValue(REPORT_TRIGGER_ID, total_trigger_count++);
-          trigger_dictionary->setIntValue(REPORT_TRIGGER_NUMBER, k + 1);
+    for (std::size_t i = 0; i < catalog->schemata().count(); i++) {
+      db_mysql_SchemaRef schema = catalog->schemata().get(i);
+      add(schema);
+      for (std::size_t j = 0; j < schema->tables().count(); j++) {
+        db_mysql_TableRef table = schema->tables().get(j);
+        add(table);
+        if (fks_show) {
+          for (std::size_t k = 0; k < table->triggers().count(); k++)
+            add(table->triggers().get(k));
         }
       }
+      for (std::size_t j = 0; j < schema->views().count(); j++)
+        add(schema->views().get(j));
+      for (std::size_t j = 0; j < schema->routines().count(); j++)
+        add(schema->routines().get(j));
     }
 
-    // View section.
-    schema_dictionary->setIntValue(REPORT_VIEW_COUNT, (long)schema->views().count());
-    for (int j = 0; j < (int)schema->views().count(); j++) {
-      db_mysql_ViewRef view = schema->views().get(j);
-
-      mtemplate::DictionaryInterface *view_dictionary = schema_dictionary->addSectionDictionary(REPORT_VIEWS);
-      view_dictionary->setIntValue(REPORT_VIEW_ID, total_view_count++);
-      view_dictionary->setIntValue(REPORT_VIEW_NUMBER, j + 1);
-      set_ddl(view_dictionary, sqlgenModule, view, lexer, show_ddl);
-
-      fillViewDict(view, view_dictionary);
-    }
-
-    // Routine section.
-    schema_dictionary->setIntValue(REPORT_ROUTINE_COUNT, (long)schema->routines().count());
-    for (int j = 0; j < (int)schema->routines().count(); j++) {
-      db_mysql_RoutineRef routine = schema->routines().get(j);
-
-      mtemplate::DictionaryInterface *routine_dictionary = schema_dictionary->addSectionDictionary(REPORT_ROUTINES);
-      routine_dictionary->setIntValue(REPORT_ROUTINE_ID, total_sp_count++);
-      routine_dictionary->setIntValue(REPORT_ROUTINE_NUMBER, j + 1);
-      set_ddl(routine_dictionary, sqlgenModule, routine, lexer, show_ddl);
-
-      fillRoutineDict(routine, routine_dictionary);
-    }
+    parallel_for(sql.size(), [&](std::size_t i) { sql[i] = ddl_markup(sql[i], lexer); });
+    for (std::size_t i = 0; i < ids.size(); i++)
+      ddl[ids[i]].swap(sql[i]);
   }
 
-  main_dictionary->setIntValue(REPORT_TOTAL_COLUMN_COUNT, total_column_count);
-  main_dictionary->setIntValue(REPORT_TOTAL_INDEX_COUNT, total_index_count);
-  main_dictionary->setIntValue(REPORT_TOTAL_FK_COUNT, total_fk_count);
-  main_dictionary->setIntValue(REPORT_TOTAL_TABLE_COUNT, total_table_count);
-  main_dictionary->setIntValue(REPORT_TOTAL_VIEW_COUNT, total_view_count);
-  main_dictionary->setIntValue(REPORT_TOTAL_TRIGGER_COUNT, total_trigger_count);
-  main_dictionary->setIntValue(REPORT_TOTAL_ROUTINE_COUNT, total_sp_count);
+  SchemaReportBuilder::Options builder_options = { columns_show, indices_show, fks_show, fks_show_referred_fks };
+  SchemaReportBuilder builder(catalog, builder_options, tbl_fk_map, show_ddl ? &ddl : NULL, main_dictionary.get());
+
+  main_dictionary->setIntValue(REPORT_TOTAL_COLUMN_COUNT, builder.totals().columns);
+  main_dictionary->setIntValue(REPORT_TOTAL_INDEX_COUNT, builder.totals().indices);
+  main_dictionary->setIntValue(REPORT_TOTAL_FK_COUNT, builder.totals().fks);
+  main_dictionary->setIntValue(REPORT_TOTAL_TABLE_COUNT, builder.totals().tables);
+  main_dictionary->setIntValue(REPORT_TOTAL_VIEW_COUNT, builder.totals().views);
+  main_dictionary->setIntValue(REPORT_TOTAL_TRIGGER_COUNT, builder.totals().triggers);
+  main_dictionary->setIntValue(REPORT_TOTAL_ROUTINE_COUNT, builder.totals().routines);
+
+  // Writes the template to the output. The schemata section is expanded one schema at a time, with the schema
+  // dictionaries created in parallel batches ahead of that. Only templates which use the schemata below their
+  // top level need all of them in the main dictionary.
+  bool schemata_added = false;
+  auto expand = [&](mtemplate::Template *template_index, mtemplate::TemplateOutput *output) {
+    if (template_index->hasNestedSection(REPORT_SCHEMATA)) {
+      if (!schemata_added) {
+        std::vector<mtemplate::Dictionary *> schemata(builder.schemaCount());
+        parallel_for(schemata.size(), [&](std::size_t i) { schemata[i] = builder.createSchemaDictionary(i); });
+        for (mtemplate::Dictionary *schema_dictionary : schemata)
+          main_dictionary->addSectionDictionary(REPORT_SCHEMATA, schema_dictionary);
+        schemata_added = true;
+      }
+      template_index->expand(main_dictionary.get(), output);
+    } else
+      template_index->expand(main_dictionary.get(), output, REPORT_SCHEMATA,
+                             [&](std::size_t index) { return builder.nextSchemaDictionary(index); });
+  };
 
   // Process template files
 
@@ -1234,8 +1455,8 @@ ssize_t WbModelImpl::generateReport(workbench_physical_ModelRef model, const grt
       if (g_file_test(path, (GFileTest)(G_FILE_TEST_EXISTS | G_FILE_TEST_IS_REGULAR))) {
         if (g_str_has_suffix(entry, ".tpl")) {
           // load template file
-          mtemplate::Template *template_index = mtemplate::GetTemplate(path, mtemplate::DO_NOT_STRIP);
-          if (template_index == 0) {
+          std::unique_ptr<mtemplate::Template> template_index(mtemplate::GetTemplate(path, mtemplate::DO_NOT_STRIP));
+          if (!template_index) {
             grt::GRT::get()->send_error(
               "Error while loading template files. Please check the log for more information.");
             grt::GRT::get()->send_error(path);
@@ -1243,10 +1464,6 @@ ssize_t WbModelImpl::generateReport(workbench_physical_ModelRef model, const grt
             return 0;
           }
 
-          // expand the template based on the dictionary
-          mtemplate::TemplateOutputString string_output;
-          template_index->expand(main_dictionary, &string_output);
-
           // build output file name
           std::string output_filename;
 
@@ -1267,12 +1484,12 @@ ssize_t WbModelImpl::generateReport(workbench_physical_ModelRef model, const grt
               single_file_output =
                 std::unique_ptr<mtemplate::TemplateOutputFile>(new mtemplate::TemplateOutputFile(output_filename));
 
-            template_index->expand(main_dictionary, single_file_output.get());
+            expand(template_index.get(), single_file_output.get());
           } else {
             std::string template_filename(entry);
             output_filename = base::makePath(output_path, template_filename.substr(0, template_filename.size() - 4));
             mtemplate::TemplateOutputFile output(output_filename);
-            template_index->expand(main_dictionary, &output);
+            expand(template_index.get(), &output);
           }
         } else {
           // Copy files/folders.
@@ -51,7 +51,7 @@ using namespace grt;
 
 DEFAULT_LOG_DOMAIN("alter_script_be");
 
-DbMySQLDiffAlter::DbMySQLDiffAlter() : _alter_list(grt::Initialized), _alter_object_list(grt::Initialized) {
+DbMySQLDiffAlter::DbMySQLDiffAlter() {
 }
 
 DbMySQLDiffAlter::~DbMySQLDiffAlter() {
@@ -115,22 +115,11 @@ std::string DbMySQLDiffAlter::generate_alter() {
   // enable this once the ALTER script generation code is able to properly generate USE statements
   // options.set("OmitSchemas", grt::IntegerRef(1));
 
-  grt::StringListRef alter_list(grt::Initialized);
-  grt::ListRef<GrtNamedObject> alter_object_list(true);
-  options.set("OutputContainer", alter_list);
-  options.set("OutputObjectContainer", alter_object_list);
+  std::string script;
+  diffsql_module->generateSQLSyncScript(_left_cat_copy, _left_cat_copy, options, _alter_change,
+                                        [&script](const std::string &text) { script.append(text); });
 
-  if (_alter_change) {
-    diffsql_module->generateSQL(_left_cat_copy, options, _alter_change);
-  }
-
-  ssize_t res = diffsql_module->makeSQLSyncScript(_left_cat_copy, options, alter_list, alter_object_list);
-  if (res != 0)
-    return "";
-
-  grt::StringRef script = grt::StringRef::cast_from(options.get("OutputScript"));
-
-  return *script;
+  return script;
 };
 
 std::shared_ptr<DiffTreeBE> DbMySQLDiffAlter::init_diff_tree(const std::vector<std::string> &schemata,
@@ -228,12 +217,11 @@ std::shared_ptr<DiffTreeBE> DbMySQLDiffAlter::init_diff_tree(const std::vector<s
 
   grt::DictRef genoptions(true);
   genoptions.set("DBSettings", get_db_options());
-  genoptions.set("OutputContainer", _alter_list);
-  genoptions.set("OutputObjectContainer", _alter_object_list);
   genoptions.set("UseFilteredLists", grt::IntegerRef(0));
 
+  _alter_sql.clear();
   if (_alter_change && diffsql_module) {
-    diffsql_module->generateSQL(_right_catalog, genoptions, _alter_change);
+    diffsql_module->generateSQL(_right_catalog, genoptions, _alter_change, &_alter_sql);
   }
 
   // 3. build the tree
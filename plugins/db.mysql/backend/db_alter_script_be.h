@@ -37,8 +37,7 @@ public:
 };
 
 class DbMySQLDiffAlter : public SynchronizeDifferencesPageBEInterface {
-  grt::StringListRef _alter_list;
-  grt::ListRef<GrtNamedObject> _alter_object_list;
+  ObjectSQLSink _alter_sql;
   db_mysql_CatalogRef _left_catalog, _right_catalog;
   std::shared_ptr<grt::DiffChange> _alter_change;
   db_mysql_CatalogRef _left_cat_copy;
@@ -71,12 +70,7 @@ public:
   virtual std::string get_col_name(const size_t col_id);
 
   virtual std::string get_sql_for_object(GrtNamedObjectRef obj) {
-    std::string result;
-    for (size_t i = 0; i < _alter_list.count(); ++i)
-      if (_alter_object_list.get(i) == obj) {
-        result.append(_alter_list.get(i)).append("\n");
-      }
-    return result;
+    return _alter_sql.sql_for(obj);
   }
 
   void restore_overriden_names();
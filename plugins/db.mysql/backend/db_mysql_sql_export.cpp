@@ -263,6 +263,49 @@ void DbMySQLSQLExport::start_export(bool wait_finish) {
 
 //--------------------------------------------------------------------------------------------------
 
+/**
+ * Stores the statements by full object name, where the export script composer looks them up. The composer
+ * puts the script together in an order of its own, so the statements can't go into the script right away.
+ */
+class ExportStatementMap : public SQLStatementSink {
+  grt::DictRef _map;
+  bool _case_sensitive;
+
+public:
+  ExportStatementMap(bool case_sensitive) : _map(true), _case_sensitive(case_sensitive) {
+  }
+
+  virtual void add_statement(const GrtNamedObjectRef &object, const std::string &sql, int flags) override {
+    _map.set(get_full_object_name_for_key(object, _case_sensitive), grt::StringRef(sql));
+  }
+
+  virtual bool has_statement(const GrtNamedObjectRef &object) override {
+    return _map.has_key(get_full_object_name_for_key(object, _case_sensitive));
+  }
+
+  grt::DictRef map() const {
+    return _map;
+  }
+};
+
+// Generates the statements turning source into target (creating or dropping the whole catalog).
+static grt::DictRef generate_statements(SQLGeneratorInterfaceImpl *module, const GrtNamedObjectRef &source,
+                                        const GrtNamedObjectRef &target, grt::DictRef options) {
+  default_omf omf;
+  grt::NormalizedComparer normalizer;
+  normalizer.init_omf(&omf);
+  std::shared_ptr<DiffChange> changes = diff_make(source, target, &omf);
+
+  options.set("DiffCaseSensitiveness", grt::IntegerRef(normalizer.is_case_sensitive()));
+
+  ExportStatementMap statements(grt::DictRef::cast_from(options.get("DBSettings")).get_int("CaseSensitive") != 0);
+  if (changes)
+    module->generateSQL(source, options, changes, &statements);
+  return statements.map();
+}
+
+//--------------------------------------------------------------------------------------------------
+
 void DbMySQLSQLExport::export_finished(grt::ValueRef res) {
   CatalogMap cmap;
   update_all_old_names(get_model_catalog(), false, cmap);
@@ -300,17 +343,20 @@ ValueRef DbMySQLSQLExport::export_task(grt::StringRef) {
       dboptions.set("CaseSensitive", grt::IntegerRef(1));
       options.set("DBSettings", dboptions);
     }
-    // grt::DictRef::cast_from(options.get("DBSettings", getDefaultTraits())),
-    create_map = diffsql_module->generateSQLForDifferences(GrtNamedObjectRef(), _catalog, options);
+    // Creating or dropping a whole catalog, the schemas don't depend on each other and can be generated in
+    // parallel. The statements are still passed on in the same order.
+    options.set("GenerationThreads", grt::IntegerRef(0));
+
+    create_map = generate_statements(diffsql_module, GrtNamedObjectRef(), _catalog, options);
 
     if (_gen_drops)
-      drop_map = diffsql_module->generateSQLForDifferences(_catalog, GrtNamedObjectRef(), options);
+      drop_map = generate_statements(diffsql_module, _catalog, GrtNamedObjectRef(), options);
     if (!drop_map.is_valid())
       drop_map = grt::DictRef(true);
 
     grt::StringListRef strlist = grt::StringListRef::cast_from(options.get("ViewFilterList"));
 
-    // generateSQLForDifferences() will set DiffCaseSensitiveness to the used value
+    // generate_statements() sets DiffCaseSensitiveness to the used value
     _case_sensitive = options.get_int("DiffCaseSensitiveness", _case_sensitive) != 0;
     options.set("CaseSensitive", grt::IntegerRef(_case_sensitive));
     if (_db_options.is_valid())
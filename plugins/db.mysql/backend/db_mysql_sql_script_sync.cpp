@@ -270,7 +270,7 @@ void update_all_old_names(db_mysql_CatalogRef cat, bool update_only_empty, Catal
 }
 
 DbMySQLScriptSync::DbMySQLScriptSync()
-  : DbMySQLValidationPage(), _alter_list(grt::Initialized), _alter_object_list(true) {
+  : DbMySQLValidationPage() {
 }
 
 DbMySQLScriptSync::~DbMySQLScriptSync() {
@@ -423,21 +423,15 @@ grt::StringRef DbMySQLScriptSync::generate_alter(db_mysql_CatalogRef org_cat, db
     return grt::StringRef("");
 
   grt::DictRef options(true);
-  grt::StringListRef alter_list(grt::Initialized);
-  options.set("OutputContainer", alter_list);
   options.set("UseFilteredLists", grt::IntegerRef(0));
   options.set("KeepOrder", grt::IntegerRef(1));
-  grt::ListRef<GrtNamedObject> alter_object_list(true);
-  options.set("OutputObjectContainer", alter_object_list);
   options.set("SQL_MODE", bec::GRTManager::get()->get_app_option("SqlGenerator.Mysql:SQL_MODE"));
 
-  diffsql_module->generateSQL(org_cat, options, alter_change);
+  std::string script;
+  diffsql_module->generateSQLSyncScript(org_cat, org_cat, options, alter_change,
+                                        [&script](const std::string& text) { script.append(text); });
 
-  ssize_t res = diffsql_module->makeSQLSyncScript(org_cat, options, alter_list, alter_object_list);
-  if (res != 0)
-    throw std::runtime_error("SQL Script Export Module Returned Error");
-
-  return grt::StringRef::cast_from(options.get("OutputScript"));
+  return grt::StringRef(script);
 }
 
 // Called once sync is finished, if there were no errors
@@ -587,13 +581,10 @@ std::shared_ptr<DiffTreeBE> DbMySQLScriptSync::init_diff_tree(const std::vector<
 
   DbMySQLImpl* diffsql_module = grt::GRT::get()->find_native_module<DbMySQLImpl>("DbMySQL");
 
-  _alter_list.remove_all();
-  _alter_object_list.remove_all();
+  _alter_sql.clear();
 
   grt::DictRef genoptions(true);
   genoptions.set("DBSettings", get_db_options());
-  genoptions.set("OutputContainer", _alter_list);
-  genoptions.set("OutputObjectContainer", _alter_object_list);
   genoptions.set("UseFilteredLists", grt::IntegerRef(0));
   // enable this once the ALTER script generation code is able to properly generate USE statements
   // options.set("OmitSchemas", grt::IntegerRef(1));
@@ -601,7 +592,7 @@ std::shared_ptr<DiffTreeBE> DbMySQLScriptSync::init_diff_tree(const std::vector<
 
   if (_alter_change && diffsql_module) {
     //    _alter_change->dump_log(0);
-    diffsql_module->generateSQL(_org_cat, genoptions, _alter_change);
+    diffsql_module->generateSQL(_org_cat, genoptions, _alter_change, &_alter_sql);
     // TODO: use this result in generate_diff_tree_report
   }
 
@@ -610,12 +601,7 @@ std::shared_ptr<DiffTreeBE> DbMySQLScriptSync::init_diff_tree(const std::vector<
 }
 
 std::string DbMySQLScriptSync::get_sql_for_object(GrtNamedObjectRef obj) {
-  std::string result;
-  for (size_t i = 0; i < _alter_list.count(); ++i)
-    if (_alter_object_list.get(i) == obj) {
-      result.append(_alter_list.get(i)).append("\n");
-    }
-  return result;
+  return _alter_sql.sql_for(obj);
 };
 
 inline void save_id(const GrtObjectRef& obj, std::set<std::string>& map) {
@@ -675,22 +661,11 @@ std::string DbMySQLScriptSync::generate_diff_tree_script() {
   options.set("KeepOrder", grt::IntegerRef(1));
   options.set("SQL_MODE", bec::GRTManager::get()->get_app_option("SqlGenerator.Mysql:SQL_MODE"));
 
-  grt::StringListRef alter_list(grt::Initialized);
-  grt::ListRef<GrtNamedObject> alter_object_list(true);
-  options.set("OutputContainer", alter_list);
-  options.set("OutputObjectContainer", alter_object_list);
-
-  if (_alter_change) {
-    diffsql_module->generateSQL(_org_cat, options, _alter_change);
-  }
-
-  ssize_t res = diffsql_module->makeSQLSyncScript(_mod_cat_copy, options, alter_list, alter_object_list);
-  if (res != 0)
-    return "";
-
-  grt::StringRef script = grt::StringRef::cast_from(options.get("OutputScript"));
+  std::string script;
+  diffsql_module->generateSQLSyncScript(_mod_cat_copy, _org_cat, options, _alter_change,
+                                        [&script](const std::string& text) { script.append(text); });
 
-  return std::string(script.c_str());
+  return script;
 }
 
 std::string DbMySQLScriptSync::generate_diff_tree_report() {
@@ -29,6 +29,39 @@
 #include "diff_tree.h"
 #include "db_mysql_validation_page.h"
 #include "grtdb/diff_dbobjectmatch.h"
+#include "interfaces/sqlgenerator.h"
+
+#include <map>
+
+/**
+ * Keeps the statements generated for each object, by object id, so the SQL for an object can be shown
+ * next to it in the differences tree.
+ */
+class ObjectSQLSink : public SQLStatementSink {
+  std::map<std::string, std::string> _sql;
+
+public:
+  virtual void add_statement(const GrtNamedObjectRef &object, const std::string &sql, int flags) override {
+    if ((flags & ImpliedStatement) || !object.is_valid())
+      return;
+    _sql[object.id()].append(sql).append("\n");
+  }
+
+  virtual bool has_statement(const GrtNamedObjectRef &object) override {
+    return object.is_valid() && _sql.find(object.id()) != _sql.end();
+  }
+
+  std::string sql_for(const GrtNamedObjectRef &object) const {
+    if (!object.is_valid())
+      return "";
+    std::map<std::string, std::string>::const_iterator iter = _sql.find(object.id());
+    return iter != _sql.end() ? iter->second : "";
+  }
+
+  void clear() {
+    _sql.clear();
+  }
+};
 
 class SynchronizeDifferencesPageBEInterface {
 protected:
@@ -78,8 +111,7 @@ class WBPLUGINDBMYSQLBE_PUBLIC_FUNC DbMySQLScriptSync : public DbMySQLValidation
   // db_mysql_CatalogRef _catalog;
   db_mysql_CatalogRef _org_cat;
   db_mysql_CatalogRef _mod_cat_copy;
-  grt::StringListRef _alter_list;
-  grt::ListRef<GrtNamedObject> _alter_object_list;
+  ObjectSQLSink _alter_sql;
   grt::DictRef _options;
   grt::DictRef _db_options;
 
@@ -29,6 +29,7 @@
 
 #include "grt.h"
 #include "grt/grt_reporter.h"
+#include "grt/validation_manager.h"
 
 using namespace grt;
 
@@ -88,11 +89,28 @@ ValueRef DbMySQLValidationPage::validation_task(grt::StringRef) {
     std::vector<WbValidationInterfaceWrapper*> validation_modules =
       grt::GRT::get()->get_implementing_modules<WbValidationInterfaceWrapper>();
 
-    if (validation_modules.empty())
+    if (validation_modules.empty() && !bec::ValidationManager::has_validators())
       return grt::StringRef("\nSQL Script Export Error: Not able to locate 'Validation' modules");
 
     GrtObjectRef catalog(GrtObjectRef::cast_from(grt::GRT::get()->get("/wb/doc/physicalModels/0/catalog")));
 
+    // The registered validators keep their results for the model, only changed objects are checked again.
+    if (bec::ValidationManager::has_validators()) {
+      grt::GRT::get()->send_info("Starting validation of model objects");
+
+      bec::ValidationCache* cache = bec::ValidationManager::cache_for(catalog);
+      int validation_res = cache->validate("All") ? 0 : 1;
+      for (auto& message : cache->messages("All")) {
+        if (message.level == grt::ErrorMsg)
+          grt::GRT::get()->send_error(message.text);
+        else if (message.level == grt::WarningMsg)
+          grt::GRT::get()->send_warning(message.text);
+      }
+
+      bec::GRTManager::get()->get_dispatcher()->call_from_main_thread<int>(
+        std::bind(_validation_step_finished_cb, validation_res), true, false);
+    }
+
     for (std::vector<WbValidationInterfaceWrapper*>::iterator module = validation_modules.begin();
          module != validation_modules.end(); ++module) {
       std::string caption = (*module)->getValidationDescription(catalog);
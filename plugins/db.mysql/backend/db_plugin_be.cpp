@@ -528,6 +528,11 @@ grt::StringRef Db_plugin::apply_script_to_db() {
 
   sql::SqlBatchExec sql_batch_exec;
 
+  // Scripts can have many thousands of statements, so send them in packets instead of one round trip each.
+  // The statement log isn't used here, so there is no need to keep a copy of the whole script in it.
+  sql_batch_exec.batch_size(1024 * 1024);
+  sql_batch_exec.sql_log_limit(100);
+
   sql_batch_exec.error_cb(std::bind(&Db_plugin::process_sql_script_error, this, std::placeholders::_1,
                                     std::placeholders::_2, std::placeholders::_3));
   sql_batch_exec.batch_exec_progress_cb(
@@ -26,6 +26,7 @@
 #include "grtui/wizard_progress_page.h"
 #include "grt/grt_manager.h"
 #include "grt/grt_message_list.h"
+#include "grt/validation_manager.h"
 #include "interfaces/wbvalidation.h"
 #include "grti/wbvalidation.h"
 
@@ -33,8 +34,9 @@ namespace grtui {
 
   class CatalogValidationPage : public WizardProgressPage {
   public:
-    static bool has_modules() {
-      return !grt::GRT::get()->get_implementing_modules<WbValidationInterfaceWrapper>().empty();
+    static bool has_validations() {
+      return !grt::GRT::get()->get_implementing_modules<WbValidationInterfaceWrapper>().empty() ||
+             bec::ValidationManager::has_validators();
     }
 
     CatalogValidationPage(WizardForm *form, bool optional = true) : WizardProgressPage(form, "validate", true) {
@@ -57,6 +59,12 @@ namespace grtui {
                          _("Performing catalog validations..."));
       }
 
+      // Validators registered for the model objects. Their results are cached for the model, so running the
+      // validations again (or forward engineering it again later) only checks the objects changed since.
+      if (bec::ValidationManager::has_validators())
+        add_async_task(_("Validate model objects"), std::bind(&CatalogValidationPage::object_validation_step, this),
+                       _("Validating model objects..."));
+
       end_adding_tasks(_("Validation Finished Successfully"));
 
       set_status_text("");
@@ -97,6 +105,28 @@ namespace grtui {
       return true;
     }
 
+    grt::ValueRef execute_object_validation() {
+      bec::ValidationCache *cache = bec::ValidationManager::cache_for(_target_catalog);
+      bool valid = cache->validate("All");
+
+      for (auto &message : cache->messages("All")) {
+        if (message.level == grt::ErrorMsg)
+          grt::GRT::get()->send_error(message.text);
+        else if (message.level == grt::WarningMsg)
+          grt::GRT::get()->send_warning(message.text);
+      }
+
+      return grt::IntegerRef(valid ? 0 : 1);
+    }
+
+    bool object_validation_step() {
+      add_log_text("Starting validation of model objects");
+
+      execute_grt_task(std::bind(&CatalogValidationPage::execute_object_validation, this), false);
+
+      return true;
+    }
+
     virtual void enter(bool advancing) {
       if (advancing && !_run_button) {
         run_validations();
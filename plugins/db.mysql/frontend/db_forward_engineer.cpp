@@ -527,7 +527,7 @@ namespace DBExport {
 
   WbPluginDbExport::WbPluginDbExport(grt::Module *module) : WizardPlugin(module) {
     set_name("DB Export Wizard");
-    if (CatalogValidationPage::has_modules())
+    if (CatalogValidationPage::has_validations())
       _validation_page = new CatalogValidationPage(this);
     else
       _validation_page = 0;
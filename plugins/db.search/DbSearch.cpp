@@ -0,0 +1,693 @@
+/*
+ * Copyright (c) 2012, 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include "DbSearch.h"
+
+#include <thread>
+
+#include "base/sqlstring.h"
+#include "base/string_utilities.h"
+#include "base/log.h"
+
+DEFAULT_LOG_DOMAIN("db.search");
+
+bool is_string_type(const std::string& type) {
+  // The string types are CHAR, VARCHAR, BINARY, VARBINARY, BLOB, TEXT, ENUM, and SET
+  static const std::set<std::string> chartypes = {"char", "varchar", "binary", "varbinary",
+                                                  "blob", "text",    "enum",   "set"};
+  std::string searchtype = type.substr(0, type.find("("));
+  return chartypes.find(searchtype) != chartypes.end();
+};
+
+bool is_numeric_type(const std::string& type) {
+  /*
+  MySQL supports all standard SQL numeric data types. These types include the exact numeric data types
+  (INTEGER, SMALLINT, DECIMAL, and NUMERIC), as well as the approximate numeric data types
+  (FLOAT, REAL, and DOUBLE PRECISION). The keyword INT is a synonym for INTEGER, and the keywords
+  DEC and FIXED are synonyms for DECIMAL. MySQL treats DOUBLE as a synonym for DOUBLE PRECISION
+  (a nonstandard extension). MySQL also treats REAL as a synonym for DOUBLE PRECISION (a nonstandard variation),
+  unless the REAL_AS_FLOAT SQL mode is enabled.
+  */
+  static const std::set<std::string> chartypes = {"integer", "smallint",         "decimal", "numeric", "float",
+                                                  "real",    "double precision", "int",     "dec",     "fixed",
+                                                  "double",  "double precision", "real"};
+  std::string searchtype = type.substr(0, type.find("("));
+  return chartypes.find(searchtype) != chartypes.end();
+};
+
+bool is_datetime_type(const std::string& type) {
+  // The date and time types for representing temporal values are DATE, TIME, DATETIME, TIMESTAMP, and YEAR.
+  static const std::set<std::string> chartypes = {"date", "time", "datetime", "timestamp", "year"};
+  std::string searchtype = type.substr(0, type.find("("));
+  return chartypes.find(searchtype) != chartypes.end();
+};
+
+DBSearch::DBSearch(const std::vector<sql::ConnectionWrapper>& connections, connect_func_t connect,
+                   const std::string& search_keyword, const grt::StringListRef& filter_list,
+                   const SearchMode search_mode, const int limit_total, const int limt_per_table, const bool invert,
+                   const int search_data_type, const std::string cast_to)
+  : _connections(connections),
+    _connect(connect),
+    _filter_list(filter_list),
+    _search_keyword(search_keyword),
+    _state("Starting"),
+    _progress(0),
+    _search_mode(search_mode),
+    _limit_total(limit_total),
+    _limt_per_table(limt_per_table),
+    _limit_counter(0),
+    _limit_reserved(0),
+    _working(false),
+    _stop(false),
+    _failed(false),
+    _starting(false),
+    _paused(false),
+    _invert(invert),
+    _searched_tables(0),
+    _matched_rows(0),
+    _cast_to(cast_to),
+    _search_data_type(search_data_type),
+    _next_task(0),
+    _finished_tasks(0) {
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void DBSearch::stop() {
+  if (is_paused())
+    toggle_pause();
+  if (!_working)
+    return;
+  _stop = true;
+  {
+    std::lock_guard<std::mutex> lock(_limit_mutex);
+    _limit_condition.notify_all();
+  }
+  kill_running_queries();
+
+  std::unique_lock<std::mutex> lock(_working_mutex);
+  _working_condition.wait(lock, [this]() { return !_working; });
+  _state = "Cancelled";
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Aborts the statements the search workers are currently running, so that stopping doesn't have to wait
+ * for a full table scan to finish. The connections themselves stay usable and go back to the pool.
+ * This is called from the UI, so it only uses the connection opened when the search started and never
+ * waits for a new one.
+ */
+void DBSearch::kill_running_queries() {
+  std::lock_guard<std::mutex> lock(_workers_mutex);
+  if (_connection_ids.empty() || _kill_connection.get() == nullptr)
+    return;
+
+  try {
+    std::unique_ptr<sql::Statement> stmt(_kill_connection->createStatement());
+    for (std::int64_t id : _connection_ids) {
+      try {
+        stmt->execute(base::strfmt("KILL QUERY %lli", (long long)id));
+      } catch (sql::SQLException& exc) {
+        // The query might have finished in the meantime.
+        logDebug("Could not kill search query on connection %lli: %s\n", (long long)id, exc.what());
+      }
+    }
+  } catch (std::exception& exc) {
+    logWarning("Could not cancel the running search queries: %s\n", exc.what());
+  }
+}
+
+std::string DBSearch::build_where(const std::string& col, const std::string& data) const {
+  static const std::vector<std::string> select_modes = {"LIKE", "=", "LIKE", "REGEXP"};
+  static const std::vector<std::string> inverted_select_modes = {"LIKE", "<>", "NOT LIKE", "NOT REGEXP"};
+
+  std::string where_condition;
+  if (_cast_to.empty())
+    where_condition.append(base::sqlstring("!", base::QuoteOnlyIfNeeded) << col);
+  else {
+    std::string tmpl("CAST(! AS ");
+    tmpl += _cast_to;
+    tmpl += ") ";
+    where_condition.append(base::sqlstring(tmpl.c_str(), base::QuoteOnlyIfNeeded) << col);
+  }
+
+  where_condition.append(" ");
+  where_condition.append(_invert ? inverted_select_modes[_search_mode].c_str() : select_modes[_search_mode].c_str());
+  if (_search_mode == Contains)
+    where_condition.append(std::string(base::sqlstring(" ? ", 0) << "%" + data + "%"));
+  else
+    where_condition.append(std::string(base::sqlstring(" ? ", 0) << data));
+  return where_condition;
+}
+
+std::string DBSearch::build_count_query(const std::string& schema, const std::string& table,
+                                        const std::list<std::string>& columns, const std::string& limit,
+                                        const bool match_PK) const {
+  if (columns.empty())
+    return std::string();
+  std::string result("SELECT COUNT(*) ");
+  std::string or_clause;
+  std::string where_condition;
+  for (std::list<std::string>::const_iterator It = columns.begin(); It != columns.end(); ++It) {
+    std::string col_where = build_where(*It, _search_keyword);
+    where_condition.append(or_clause).append(col_where);
+    or_clause = "OR ";
+  }
+
+  result.append(base::sqlstring(" FROM !.! WHERE ", 0) << schema << table);
+  result.append(where_condition).append(limit);
+  return result;
+}
+
+std::string DBSearch::build_select_query(const std::string& schema, const std::string& table,
+                                         const std::list<std::string>& columns, const std::string& limit,
+                                         const bool match_PK) const {
+  if (columns.empty())
+    return std::string();
+
+  std::string result("SELECT ");
+  bool pk_col = true;
+  std::string or_clause;
+  std::string where_condition;
+  for (std::list<std::string>::const_iterator It = columns.begin(); It != columns.end(); ++It) {
+    if (pk_col) // Add data for PK column
+    {
+      if (It->empty()) // No PK indicator
+      {
+        result.append("'N/A' ");
+        pk_col = false;
+      } else
+        result.append(base::sqlstring("! ", base::QuoteOnlyIfNeeded) << *It);
+      pk_col = false;
+      continue;
+    }
+    std::string col_where = build_where(*It, _search_keyword);
+    result.append(", IF(").append(col_where);
+    result.append(base::sqlstring(", !, '') AS ! ", base::QuoteOnlyIfNeeded) << *It << *It);
+
+    where_condition.append(or_clause).append(col_where);
+    or_clause = "OR ";
+  }
+  if (where_condition.empty()) {
+    return std::string();
+  }
+  result.append(base::sqlstring("FROM !.! WHERE ", base::QuoteOnlyIfNeeded) << schema << table);
+  result.append(where_condition).append(limit);
+  return result;
+}
+
+int DBSearch::count_data(sql::Connection* connection, const std::string& schema_name, const std::string& table_name,
+                         const std::list<std::string>& pk_columns, const std::list<std::string>& select_columns,
+                         const std::string& limit_clause, const bool match_PK, SearchResultEntry& result) {
+  std::string query = build_count_query(schema_name, table_name, select_columns, limit_clause, match_PK);
+  if (query.empty())
+    return 0;
+
+  std::unique_ptr<sql::Statement> stmt(connection->createStatement());
+  std::unique_ptr<sql::ResultSet> rs(stmt->executeQuery(query));
+  result.schema = schema_name;
+  result.table = table_name;
+  result.keys = pk_columns;
+  result.query = query;
+  while (rs->next()) {
+    std::vector<std::pair<std::string, std::string> > data;
+    data.reserve(select_columns.size());
+    data.push_back(std::pair<std::string, std::string>("COUNT", rs->getString(1)));
+    _matched_rows += rs->getInt(1);
+    result.data.push_back(data);
+  }
+  return (int)rs->rowsCount();
+};
+
+int DBSearch::select_data(sql::Connection* connection, const std::string& schema_name, const std::string& table_name,
+                          const std::list<std::string>& pk_columns, const std::list<std::string>& select_columns,
+                          const std::string& limit_clause, const bool match_PK, SearchResultEntry& result) {
+  std::string query = build_select_query(schema_name, table_name, select_columns, limit_clause, match_PK);
+  if (query.empty())
+    return 0;
+  std::unique_ptr<sql::Statement> stmt(connection->createStatement());
+  std::unique_ptr<sql::ResultSet> rs(stmt->executeQuery(query));
+  result.schema = schema_name;
+  result.table = table_name;
+  result.query = query;
+  result.keys = pk_columns;
+  while (rs->next()) {
+    size_t col_idx = 1;
+    std::vector<std::pair<std::string, std::string> > data;
+    data.reserve(select_columns.size());
+    for (std::list<std::string>::const_iterator It = select_columns.begin(); It != select_columns.end(); ++It)
+      data.push_back(std::pair<std::string, std::string>(*It, rs->getString((int)col_idx++)));
+    if (!data.empty())
+      result.data.push_back(data);
+  }
+  _matched_rows += (int)result.data.size();
+  return (int)rs->rowsCount();
+};
+
+void DBSearch::search() {
+  run(std::bind(&DBSearch::select_data, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3,
+                std::placeholders::_4, std::placeholders::_5, std::placeholders::_6, std::placeholders::_7,
+                std::placeholders::_8));
+};
+
+void DBSearch::count() {
+  run(std::bind(&DBSearch::count_data, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3,
+                std::placeholders::_4, std::placeholders::_5, std::placeholders::_6, std::placeholders::_7,
+                std::placeholders::_8));
+};
+
+void DBSearch::run(select_func_t select_func) {
+  struct working_state_guard {
+    DBSearch* _search;
+    working_state_guard(DBSearch* search) : _search(search) {
+    }
+    ~working_state_guard() {
+      _search->finish_run();
+    }
+  };
+  working_state_guard w(this);
+  if (is_paused())
+    toggle_pause();
+  _starting = false;
+  _working = true;
+  _stop = false;
+  _failed = false;
+  _error = nullptr;
+  _limit_counter = _limit_total;
+  _limit_reserved = 0;
+  _state = "Fetch schema list";
+  _searched_tables = 0;
+  _matched_rows = 0;
+  _tasks.clear();
+  _next_task = 0;
+  _finished_tasks = 0;
+
+  // Held only while searching, so the connections go back to the pool as soon as the search is done.
+  std::vector<sql::ConnectionWrapper> connections;
+  connections.swap(_connections);
+  sql::Connection* connection = connections.front().get();
+
+  if (_connect) {
+    try {
+      sql::ConnectionWrapper kill_connection = _connect();
+      std::lock_guard<std::mutex> lock(_workers_mutex);
+      _kill_connection = kill_connection;
+    } catch (std::exception& exc) {
+      logWarning("Could not open a connection to cancel search queries, stopping will wait for them: %s\n",
+                 exc.what());
+    }
+  }
+
+  std::map<std::string, std::vector<std::string> > schemas;
+  std::map<std::string, std::vector<std::string> > schemas_tables;
+  {
+    std::unique_ptr<sql::Statement> stmt(connection->createStatement());
+    for (size_t count = _filter_list.count(), i = 0; i < count; i++) {
+      wait_if_paused();
+      if (_stop)
+        return;
+      std::string schema_pattern = _filter_list.get(i);
+      size_t dotpos = schema_pattern.find('.');
+      std::string table_column;
+      if (dotpos != std::string::npos)
+        table_column = schema_pattern.substr(dotpos + 1);
+      schema_pattern = schema_pattern.substr(0, dotpos);
+      if (schema_pattern.empty() || schema_pattern.find('%') != std::string::npos) {
+        schema_pattern = "%";
+        std::unique_ptr<sql::ResultSet> rs(
+          stmt->executeQuery(std::string(base::sqlstring("SHOW DATABASES LIKE ?", 0) << schema_pattern)));
+        while (rs->next()) {
+          std::string schema = rs->getString(1);
+          schemas[schema].push_back(table_column);
+        }
+      } else
+        schemas[schema_pattern].push_back(table_column);
+    }
+  }
+  {
+    std::unique_ptr<sql::Statement> stmt(connection->createStatement());
+    for (std::map<std::string, std::vector<std::string> >::const_iterator It = schemas.begin(); It != schemas.end();
+         ++It) {
+      std::string schema_name = It->first;
+      _state = std::string("Populate tables in ") + schema_name;
+      std::vector<std::string> tables = It->second;
+      for (std::vector<std::string>::const_iterator It_tables = tables.begin(); It_tables != tables.end();
+           ++It_tables) {
+        wait_if_paused();
+        if (_stop)
+          return;
+        std::string table_pattern = *It_tables;
+        size_t dotpos = table_pattern.find('.');
+        std::string column_pattern;
+        if (dotpos != std::string::npos)
+          column_pattern = table_pattern.substr(dotpos + 1);
+        else
+          column_pattern = '%';
+        table_pattern = table_pattern.substr(0, dotpos);
+        if (table_pattern.empty())
+          table_pattern = "%";
+
+        std::string query;
+        if (table_pattern == "%") {
+          query.append(base::sqlstring("SHOW FULL TABLES FROM ! WHERE Table_type = 'BASE TABLE'", 0) << schema_name);
+        } else {
+          query.append(base::sqlstring("SHOW TABLES FROM ! LIKE ?", 0) << schema_name << table_pattern);
+        }
+        std::unique_ptr<sql::ResultSet> rs(stmt->executeQuery(query));
+        while (rs->next()) {
+          std::string table = rs->getString(1);
+          schemas_tables[schema_name + '.' + table].push_back(column_pattern);
+        }
+      }
+    }
+  }
+
+  for (std::map<std::string, std::vector<std::string> >::const_iterator It = schemas_tables.begin();
+       It != schemas_tables.end(); ++It) {
+    size_t dotpos = It->first.find('.');
+    TableTask task;
+    task.schema = It->first.substr(0, dotpos);
+    task.table = It->first.substr(dotpos + 1);
+    task.column_patterns = It->second;
+    task.estimated_size = 0;
+    task.searched = false;
+    task.has_result = false;
+    task.result.position = _tasks.size();
+    _tasks.push_back(task);
+  }
+
+  _state = "Estimate table sizes";
+  estimate_table_sizes(connection);
+  if (_stop)
+    return;
+
+  // Largest tables first, so that the small ones fill up the idle connections at the end instead of
+  // leaving a single big table scan running on its own.
+  std::stable_sort(_tasks.begin(), _tasks.end(), [](const TableTask& a, const TableTask& b) {
+    return a.estimated_size > b.estimated_size;
+  });
+
+  size_t worker_count = std::min(connections.size(), std::max(_tasks.size(), (size_t)1));
+  _state = base::strfmt("Searching %i tables using %i connections", (int)_tasks.size(), (int)worker_count);
+
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < worker_count; ++i)
+    workers.push_back(
+      std::thread(std::bind(&DBSearch::search_tables_in_thread, this, connections[i], select_func)));
+  search_tables(connections.front(), select_func);
+  for (auto& worker : workers)
+    worker.join();
+
+  if (_stop)
+    return;
+  if (_error)
+    std::rethrow_exception(_error);
+
+  if (_searched_tables == 0)
+    _state = "No tables were searched";
+  else
+    _state = base::strfmt("Search completed in %i tables", (int)_searched_tables);
+  _progress = 1;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Closes the cancel connection and wakes up a stop() waiting for the search to end.
+ */
+void DBSearch::finish_run() {
+  {
+    std::lock_guard<std::mutex> lock(_workers_mutex);
+    _kill_connection = sql::ConnectionWrapper();
+  }
+  std::lock_guard<std::mutex> lock(_working_mutex);
+  _working = false;
+  _working_condition.notify_all();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Reads the data size of all tables to be searched, which is what a search has to scan. These are only
+ * statistics, which is all that is needed for the search order. Without them tables are searched by name.
+ */
+void DBSearch::estimate_table_sizes(sql::Connection* connection) {
+  std::set<std::string> schemas;
+  for (const TableTask& task : _tasks)
+    schemas.insert(task.schema);
+
+  std::map<std::string, std::int64_t> sizes;
+  try {
+    std::unique_ptr<sql::Statement> stmt(connection->createStatement());
+    for (const std::string& schema : schemas) {
+      wait_if_paused();
+      if (_stop)
+        return;
+      std::unique_ptr<sql::ResultSet> rs(stmt->executeQuery(std::string(
+        base::sqlstring("SELECT TABLE_NAME, IFNULL(DATA_LENGTH, 0) FROM information_schema.TABLES WHERE TABLE_SCHEMA = ?",
+                        0)
+        << schema)));
+      while (rs->next())
+        sizes[schema + '.' + rs->getString(1)] = rs->getInt64(2);
+    }
+  } catch (std::exception& exc) {
+    logWarning("Could not get table sizes, tables will be searched in name order: %s\n", exc.what());
+  }
+
+  for (TableTask& task : _tasks) {
+    std::map<std::string, std::int64_t>::const_iterator size = sizes.find(task.schema + '.' + task.table);
+    if (size != sizes.end())
+      task.estimated_size = size->second;
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Worker loop, running on the search thread for the first connection and on its own thread for all others.
+ * Takes the next table from the task list until all are done, the search was stopped or the total limit is
+ * used up.
+ */
+void DBSearch::search_tables(sql::ConnectionWrapper connection, select_func_t select_func) {
+  std::int64_t connection_id = -1;
+  try {
+    std::unique_ptr<sql::Statement> stmt(connection->createStatement());
+    std::unique_ptr<sql::ResultSet> rs(stmt->executeQuery("SELECT CONNECTION_ID()"));
+    if (rs->next())
+      connection_id = rs->getInt64(1);
+  } catch (std::exception& exc) {
+    logWarning("Could not get the connection id, search queries on it can't be cancelled: %s\n", exc.what());
+  }
+  if (connection_id >= 0) {
+    std::lock_guard<std::mutex> lock(_workers_mutex);
+    _connection_ids.insert(connection_id);
+  }
+
+  try {
+    while (true) {
+      wait_if_paused();
+      if (_stop || _failed)
+        break;
+
+      size_t index = _next_task++;
+      if (index >= _tasks.size())
+        break;
+
+      bool more = search_table(connection.get(), _tasks[index], select_func);
+      publish(_tasks[index]);
+      if (!more)
+        break;
+    }
+  } catch (...) {
+    // Errors caused by killing the queries of a stopped search are expected.
+    if (!_stop) {
+      std::lock_guard<std::mutex> lock(_workers_mutex);
+      if (!_error)
+        _error = std::current_exception();
+      _failed = true;
+    }
+    std::lock_guard<std::mutex> lock(_limit_mutex);
+    _limit_condition.notify_all();
+  }
+
+  if (connection_id >= 0) {
+    std::lock_guard<std::mutex> lock(_workers_mutex);
+    _connection_ids.erase(connection_id);
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Runs the worker loop on a thread of its own, which the client library has to be set up for.
+ */
+void DBSearch::search_tables_in_thread(sql::ConnectionWrapper connection, select_func_t select_func) {
+  sql::Driver* driver = connection->getDriver();
+  driver->threadInit();
+  search_tables(connection, select_func);
+  driver->threadEnd();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Picks the columns to search in the given table and runs the search query for it. Returns false if the
+ * total limit is used up, in which case the table was not searched.
+ */
+bool DBSearch::search_table(sql::Connection* connection, TableTask& task, select_func_t select_func) {
+  const std::string& schema_name = task.schema;
+  const std::string& table_name = task.table;
+  std::string like_clause;
+  static const std::string like_pattern = "Field LIKE ? OR ";
+  for (std::vector<std::string>::const_iterator It_cols = task.column_patterns.begin();
+       It_cols != task.column_patterns.end(); ++It_cols)
+    like_clause.append(std::string(base::sqlstring(like_pattern.c_str(), base::UseAnsiQuotes) << *It_cols));
+  like_clause.append("FALSE");
+
+  std::list<std::string> pk_columns;
+  bool match_PK = false;
+  std::list<std::string> select_columns;
+  try {
+    std::unique_ptr<sql::Statement> stmt(connection->createStatement());
+    std::unique_ptr<sql::ResultSet> rs(
+      stmt->executeQuery(std::string(base::sqlstring("SHOW COLUMNS FROM !.! WHERE ", base::QuoteOnlyIfNeeded)
+                                     << schema_name << table_name)
+                           .append(like_clause)));
+    while (rs->next()) {
+      std::string column = rs->getString(1);
+      std::string column_type = rs->getString(2);
+      if ((_search_data_type == search_all_types) ||
+          ((_search_data_type & numeric_type) && is_numeric_type(column_type)) ||
+          ((_search_data_type & datetime_type) && is_datetime_type(column_type)) ||
+          ((_search_data_type & text_type) && is_string_type(column_type))) {
+        if (rs->getString(4) == "PRI") {
+          select_columns.push_front(column);
+          pk_columns.push_back(column);
+          match_PK = true; // PK should be searched, not just displayed
+        }
+        select_columns.push_back(column);
+      } else {
+        if (rs->getString(4) == "PRI") {
+          select_columns.push_front(column);
+          pk_columns.push_back(column);
+        }
+      }
+    }
+  } catch (std::exception& exc) {
+    logWarning("Could not get columns list from %s.%s: %s\n", schema_name.c_str(), table_name.c_str(), exc.what());
+  }
+  // Add PK col if there is at least one column matching pattern and it it wasn't added during col patterns search
+  if (pk_columns.empty() && !select_columns.empty()) {
+    try {
+      std::unique_ptr<sql::Statement> stmt(connection->createStatement());
+      std::unique_ptr<sql::ResultSet> rs(stmt->executeQuery(
+        std::string(base::sqlstring("SHOW COLUMNS FROM !.! WHERE `Key` = 'PRI'", base::QuoteOnlyIfNeeded)
+                    << schema_name << table_name)));
+      while (rs->next()) {
+        select_columns.push_back(rs->getString(1));
+        pk_columns.push_back(rs->getString(1));
+      }
+      // set PK col to be the first, or push empty string to indicate that there is no PK at all
+      if (pk_columns.empty())
+        select_columns.push_front("");
+    } catch (std::exception& exc) {
+      logWarning("Could not get columns list from %s.%s: %s\n", schema_name.c_str(), table_name.c_str(), exc.what());
+    }
+  }
+
+  // Build select from columns fetched on previous step and use it to collect data
+  wait_if_paused();
+  if (_stop)
+    return false;
+
+  int limit = 0;
+  if (!reserve_rows(limit))
+    return false;
+  std::string limit_clause;
+  if (limit > 0)
+    limit_clause = base::strfmt("LIMIT %i", limit);
+
+  int fetched = 0;
+  try {
+    fetched = select_func(connection, schema_name, table_name, pk_columns, select_columns, limit_clause, match_PK,
+                          task.result);
+  } catch (...) {
+    release_rows(limit, 0);
+    throw;
+  }
+  release_rows(limit, fetched);
+  task.searched = true;
+  task.has_result = !task.result.data.empty();
+  return true;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Moves the result of a finished task to the result list right away, so that a big table still being
+ * searched doesn't hold back the results of the tables done meanwhile.
+ */
+void DBSearch::publish(TableTask& task) {
+  base::MutexLock lock(_search_result_mutex);
+  ++_finished_tasks;
+  if (task.searched)
+    _searched_tables++;
+  if (task.has_result)
+    _search_result.push_back(std::move(task.result));
+  _progress = (_finished_tasks * 1.f) / _tasks.size();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Takes the limit for the next query from the total limit, if there is one. Rows a query doesn't use are
+ * given back when it is done, so while other queries are running there might be more rows to come even if
+ * the total limit is used up for now.
+ */
+bool DBSearch::reserve_rows(int& limit) {
+  limit = _limt_per_table;
+  if (_limit_total <= 0)
+    return true;
+
+  std::unique_lock<std::mutex> lock(_limit_mutex);
+  _limit_condition.wait(lock, [this]() { return _stop || _failed || _limit_counter > 0 || _limit_reserved == 0; });
+  if (_stop || _failed || _limit_counter <= 0)
+    return false;
+
+  if (limit <= 0 || limit > _limit_counter)
+    limit = _limit_counter;
+  _limit_counter -= limit;
+  _limit_reserved += limit;
+  return true;
+}
+
+void DBSearch::release_rows(int reserved, int used) {
+  if (_limit_total <= 0)
+    return;
+
+  std::lock_guard<std::mutex> lock(_limit_mutex);
+  _limit_reserved -= reserved;
+  _limit_counter += reserved - std::min(used, reserved);
+  _limit_condition.notify_all();
+}
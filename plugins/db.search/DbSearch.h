@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2012, 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#ifndef _DB_SEARCH_H_
+#define _DB_SEARCH_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+
+#include "grt.h"
+#include "base/threading.h"
+#include "cppdbc.h"
+
+enum SearchMode { Contains, ExactMatch, Like, Regexp };
+
+enum SearchDataType { numeric_type = 1, datetime_type = 1 << 1, text_type = 1 << 2, search_all_types = -1 };
+
+class DBSearch {
+public:
+  typedef std::vector<std::vector<std::pair<std::string, std::string> > > column_data_t;
+  typedef std::function<sql::ConnectionWrapper()> connect_func_t;
+  struct SearchResultEntry {
+    std::string schema;
+    std::string table;
+    std::list<std::string> keys;
+    std::string query;
+    column_data_t data;
+    size_t position; // Where the table goes in the result list, which is sorted by schema and table name.
+  };
+
+private:
+  // One table to be searched. Tables are handed out to the workers largest first and their results are
+  // published as soon as they are searched. The position of a result tells where it is to be shown.
+  struct TableTask {
+    std::string schema;
+    std::string table;
+    std::vector<std::string> column_patterns;
+    std::int64_t estimated_size;
+    bool searched;
+    bool has_result;
+    SearchResultEntry result;
+  };
+
+  std::vector<sql::ConnectionWrapper> _connections;
+  connect_func_t _connect;
+  grt::StringListRef _filter_list;
+  std::string _search_keyword;
+  std::string _state;
+  float _progress;
+  SearchMode _search_mode;
+  int _limit_total;
+  int _limt_per_table;
+  int _limit_counter;  // Rows of the total limit not yet reserved by a running query.
+  int _limit_reserved; // Rows reserved by running queries.
+  std::vector<SearchResultEntry> _search_result;
+  std::atomic<bool> _working;
+  std::atomic<bool> _stop;
+  std::atomic<bool> _failed;
+  volatile bool _starting;
+  volatile bool _paused;
+  bool _invert;
+  std::atomic<int> _searched_tables;
+  std::atomic<int> _matched_rows;
+  std::string _cast_to;
+  int _search_data_type;
+  base::Mutex _search_result_mutex;
+  base::Mutex _pause_mutex;
+  std::mutex _working_mutex;
+  std::condition_variable _working_condition; // Signaled when run() returns.
+
+  std::vector<TableTask> _tasks;
+  std::atomic<size_t> _next_task;
+  size_t _finished_tasks;
+  std::mutex _limit_mutex;
+  std::condition_variable _limit_condition;
+  std::mutex _workers_mutex;
+  std::set<std::int64_t> _connection_ids;  // Server side ids of the connections currently searching.
+  sql::ConnectionWrapper _kill_connection; // Opened when the search starts, to cancel the running queries on stop.
+  std::exception_ptr _error;               // First error a worker ran into, rethrown when all of them are done.
+
+protected:
+  typedef std::function<int(sql::Connection*, const std::string&, const std::string&, const std::list<std::string>&,
+                            const std::list<std::string>&, const std::string&, const bool match_PK,
+                            SearchResultEntry& result)>
+    select_func_t;
+  void run(select_func_t select_func);
+  void finish_run();
+  void estimate_table_sizes(sql::Connection* connection);
+  void search_tables(sql::ConnectionWrapper connection, select_func_t select_func);
+  void search_tables_in_thread(sql::ConnectionWrapper connection, select_func_t select_func);
+  bool search_table(sql::Connection* connection, TableTask& task, select_func_t select_func);
+  void publish(TableTask& task);
+  bool reserve_rows(int& limit);
+  void release_rows(int reserved, int used);
+  void kill_running_queries();
+  int select_data(sql::Connection* connection, const std::string& schema_name, const std::string& table_name,
+                  const std::list<std::string>& pk_columns, const std::list<std::string>& select_columns,
+                  const std::string& limit_clause, const bool match_PK, SearchResultEntry& result);
+  int count_data(sql::Connection* connection, const std::string& schema_name, const std::string& table_name,
+                 const std::list<std::string>& pk_columns, const std::list<std::string>& select_columns,
+                 const std::string& limit_clause, const bool match_PK, SearchResultEntry& result);
+
+public:
+  /**
+   * Tables are searched in parallel, one worker per given connection. The first connection is also used to
+   * collect the tables to search. All of them are released when the search is done. The connect function opens
+   * a separate connection when the search starts, which is used to cancel the running queries on the server
+   * when the search is stopped.
+   */
+  DBSearch(const std::vector<sql::ConnectionWrapper>& connections, connect_func_t connect,
+           const std::string& search_keyword, const grt::StringListRef& filter_list, const SearchMode search_mode,
+           const int limit_total, const int limt_per_table, const bool invert, const int search_data_type,
+           const std::string cast_to);
+
+  ~DBSearch() {
+    stop();
+  };
+
+  std::string get_keyword() {
+    return _search_keyword;
+  }
+
+  void prepare() {
+    _starting = true;
+  }
+  bool is_starting() const {
+    return _starting;
+  }
+  void toggle_pause() {
+    _paused = !_paused;
+    if (_paused)
+      _pause_mutex.lock();
+    else
+      _pause_mutex.unlock();
+  }
+  void wait_if_paused() {
+    if (is_paused()) {
+      base::MutexLock lock(_pause_mutex); // Wait for unlock
+    };
+  };
+  bool is_paused() const {
+    return _paused;
+  }
+  float get_progress() const {
+    return _progress;
+  }
+  std::string get_state() const {
+    return _state;
+  }
+  // The results in the order the tables were done, see SearchResultEntry::position for the order to show them.
+  const std::vector<SearchResultEntry>& search_results() const {
+    return _search_result;
+  }
+  base::Mutex& get_search_result_mutex() {
+    return _search_result_mutex;
+  };
+  int searched_table_count() {
+    return _searched_tables;
+  }
+  int matched_rows() {
+    return _matched_rows;
+  }
+  bool is_working() const {
+    return _working;
+  }
+  void stop();
+  std::string build_where(const std::string& col, const std::string& data) const;
+  std::string build_select_query(const std::string& schema, const std::string& table,
+                                 const std::list<std::string>& columns, const std::string& limit,
+                                 const bool match_PK) const;
+  std::string build_count_query(const std::string& schema, const std::string& table,
+                                const std::list<std::string>& columns, const std::string& limit,
+                                const bool match_PK) const;
+  void search();
+  void count();
+};
+
+#endif // _DB_SEARCH_H_
@@ -27,12 +27,7 @@
 #include "mforms/mforms.h"
 #include "grt/grt_manager.h"
 #include "grtui/db_conn_be.h"
-
-class DBSearch;
-
-enum SearchMode { Contains, ExactMatch, Like, Regexp };
-
-enum SearchDataType { numeric_type = 1, datetime_type = 1 << 1, text_type = 1 << 2, search_all_types = -1 };
+#include "DbSearch.h"
 
 class DBSearchPanel : public mforms::Box {
 protected:
@@ -55,10 +50,13 @@ protected:
 public:
   DBSearchPanel();
   ~DBSearchPanel();
-  void search(sql::ConnectionWrapper connection, const std::string& search_keyword,
-              const grt::StringListRef& filter_list, const SearchMode search_mode, const int limit_total,
-              const int limt_per_table, const bool invert, const int search_data_type, const std::string cast_to,
-              std::function<void(grt::ValueRef)> finished_callback, std::function<void()> failed_callback);
+  // Searches with one worker per connection. The connect function opens the connection used to cancel the
+  // running queries on stop.
+  void search(const std::vector<sql::ConnectionWrapper>& connections, std::function<sql::ConnectionWrapper()> connect,
+              const std::string& search_keyword, const grt::StringListRef& filter_list, const SearchMode search_mode,
+              const int limit_total, const int limt_per_table, const bool invert, const int search_data_type,
+              const std::string cast_to, std::function<void(grt::ValueRef)> finished_callback,
+              std::function<void()> failed_callback);
   void toggle_pause();
   bool stop_search_if_working();
   bool update();
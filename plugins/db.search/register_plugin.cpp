@@ -42,6 +42,8 @@
 #include <boost/assign/list_of.hpp>
 #include <boost/lambda/bind.hpp>
 
+DEFAULT_LOG_DOMAIN("db.search");
+
 class DBSearchView : public mforms::AppView, public grt::GRTObserver {
 private:
   db_query_EditorRef _editor;
@@ -159,9 +161,22 @@ private:
     bool invert = _filter_panel.exclude();
     sql::DriverManager *dm = sql::DriverManager::getDriverManager();
     mforms::App::get()->set_status_text("Opening new connection...");
-    sql::ConnectionWrapper wrapper;
+
+    // Tables are searched in parallel, one pooled connection each.
+    int connection_count = (int)bec::GRTManager::get()->get_app_option_int("db.search:SearchConnections", 4);
+    connection_count = std::max(1, std::min(connection_count, (int)sql::ConnectionPool::Options().maxConnections));
+    std::vector<sql::ConnectionWrapper> connections;
     try {
-      wrapper = dm->getConnection(_editor->connection());
+      connections.push_back(dm->getPooledConnection(_editor->connection()));
+      while ((int)connections.size() < connection_count) {
+        try {
+          connections.push_back(dm->getPooledConnection(_editor->connection()));
+        } catch (std::exception &exc) {
+          logWarning("Could not open more search connections, searching with %i: %s\n", (int)connections.size(),
+                     exc.what());
+          break;
+        }
+      }
     } catch (grt::user_cancelled &ucancel) {
       mforms::App::get()->set_status_text(ucancel.what());
       return;
@@ -176,8 +191,14 @@ private:
     _filter_panel.set_searching(true);
     _search_panel.show(true);
 
+    // The connection for cancelling is opened by the search itself, off the UI thread. It is not taken from the
+    // pool, so that it is there even if all pooled connections are searching.
+    db_mgmt_ConnectionRef connection_properties(_editor->connection());
     _search_panel.search(
-      wrapper, search_keyword, filters, SearchMode(search_type), limit_total, limit_table, invert,
+      connections, [connection_properties]() {
+        return sql::DriverManager::getDriverManager()->getConnection(connection_properties);
+      },
+      search_keyword, filters, SearchMode(search_type), limit_total, limit_table, invert,
       _filter_panel.search_all_types() ? search_all_types : text_type, _filter_panel.search_all_types() ? "CHAR" : "",
       std::bind(&DBSearchView::finished_search, this), std::bind(&DBSearchView::failed_search, this));
   }
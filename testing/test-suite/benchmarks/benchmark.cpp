@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+
+#include "rapidjson/document.h"
+#include "rapidjson/istreamwrapper.h"
+#include "rapidjson/ostreamwrapper.h"
+#include "rapidjson/prettywriter.h"
+
+#include "base/file_utilities.h"
+
+#include "benchmark.h"
+
+using namespace benchmarks;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+State::State(std::size_t repetitions) : _repetitions(std::max<std::size_t>(repetitions, 1)) {
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void State::measure(std::function<void()> const& run) {
+  run();
+
+  for (std::size_t i = 0; i < _repetitions; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    run();
+    _samples.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void State::measureCpuTime(std::function<void()> const& run) {
+  run();
+
+  for (std::size_t i = 0; i < _repetitions; ++i) {
+    std::clock_t start = std::clock();
+    run();
+    _samples.push_back(double(std::clock() - start) / CLOCKS_PER_SEC);
+  }
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+double Result::min() const {
+  if (samples.empty())
+    return 0;
+  return *std::min_element(samples.begin(), samples.end());
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+double Result::median() const {
+  if (samples.empty())
+    return 0;
+
+  std::vector<double> sorted = samples;
+  std::sort(sorted.begin(), sorted.end());
+  std::size_t middle = sorted.size() / 2;
+  if (sorted.size() % 2 == 0)
+    return (sorted[middle - 1] + sorted[middle]) / 2;
+  return sorted[middle];
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+double Result::mean() const {
+  if (samples.empty())
+    return 0;
+  return std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+Registry& Registry::get() {
+  static Registry instance;
+  return instance;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void Registry::add(std::string const& name, BenchmarkFunction function) {
+  if (_benchmarks.find(name) != _benchmarks.end())
+    throw std::logic_error("Duplicate benchmark name: " + name);
+  _benchmarks[name] = function;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::string benchmarks::dataDir() {
+  const char *value = getenv("MWB_DATA_DIR");
+  if (value == nullptr)
+    throw std::runtime_error("The MWB_DATA_DIR environment variable is not set");
+  return value;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::string benchmarks::outputDir() {
+  static std::string directory;
+  if (directory.empty()) {
+    const char *value = getenv("BENCHMARK_OUTPUT_DIR");
+    directory = value != nullptr ? value : "/tmp/wb-benchmarks";
+    base::create_directory(directory, 0700, true);
+  }
+  return directory;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+void benchmarks::writeResults(std::vector<Result> const& results, std::string const& path) {
+  rapidjson::Document document;
+  document.SetObject();
+  auto &allocator = document.GetAllocator();
+
+  rapidjson::Value list(rapidjson::kArrayType);
+  for (auto &result : results) {
+    rapidjson::Value entry(rapidjson::kObjectType);
+    entry.AddMember("name", rapidjson::Value(result.name, allocator), allocator);
+    entry.AddMember("runs", static_cast<uint64_t>(result.samples.size()), allocator);
+    entry.AddMember("items", static_cast<uint64_t>(result.items), allocator);
+    entry.AddMember("min", result.min(), allocator);
+    entry.AddMember("median", result.median(), allocator);
+    entry.AddMember("mean", result.mean(), allocator);
+    if (result.items > 0 && result.median() > 0)
+      entry.AddMember("itemsPerSecond", result.items / result.median(), allocator);
+    list.PushBack(entry, allocator);
+  }
+  document.AddMember("results", list, allocator);
+
+  std::ofstream stream(path);
+  if (!stream.good())
+    throw std::runtime_error("Cannot write the result file " + path);
+
+  rapidjson::OStreamWrapper wrapper(stream);
+  rapidjson::PrettyWriter<rapidjson::OStreamWrapper> writer(wrapper);
+  document.Accept(writer);
+  stream << std::endl;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::map<std::string, double> benchmarks::readBaseline(std::string const& path) {
+  std::ifstream stream(path);
+  if (!stream.good())
+    throw std::runtime_error("Cannot open the baseline file " + path);
+
+  rapidjson::IStreamWrapper wrapper(stream);
+  rapidjson::Document document;
+  document.ParseStream(wrapper);
+  if (document.HasParseError() || !document.IsObject() || !document.HasMember("results") ||
+      !document["results"].IsArray())
+    throw std::runtime_error("The baseline file " + path + " is not a benchmark result file");
+
+  std::map<std::string, double> baseline;
+  for (auto &entry : document["results"].GetArray()) {
+    if (entry.IsObject() && entry.HasMember("name") && entry["name"].IsString() && entry.HasMember("median") &&
+        entry["median"].IsNumber())
+      baseline[entry["name"].GetString()] = entry["median"].GetDouble();
+  }
+  return baseline;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::size_t benchmarks::compareWithBaseline(std::vector<Result> const& results,
+                                            std::map<std::string, double> const& baseline, double tolerance) {
+  std::size_t regressions = 0;
+
+  std::printf("\n%-40s %12s %12s %9s\n", "Benchmark", "Baseline ms", "Median ms", "Change");
+  for (auto &result : results) {
+    auto iterator = baseline.find(result.name);
+    if (iterator == baseline.end() || iterator->second <= 0) {
+      std::printf("%-40s %12s %12.3f %9s\n", result.name.c_str(), "-", result.median() * 1000, "new");
+      continue;
+    }
+
+    double change = (result.median() / iterator->second - 1) * 100;
+    bool regressed = change > tolerance;
+    if (regressed)
+      ++regressions;
+    std::printf("%-40s %12.3f %12.3f %+8.1f%%%s\n", result.name.c_str(), iterator->second * 1000,
+                result.median() * 1000, change, regressed ? "  REGRESSION" : "");
+  }
+
+  if (regressions > 0)
+    std::printf("\n%zu benchmark(s) slower than the baseline by more than %.1f%%\n", regressions, tolerance);
+
+  return regressions;
+}
@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#pragma once
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+// A minimal micro benchmark framework for the hot paths of Workbench. Benchmarks work only on synthetic input,
+// generated at run time, so they don't need a server or any external files.
+
+namespace benchmarks {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Passed to each benchmark. Everything a benchmark does outside of measure() is setup and not timed.
+ */
+class State {
+public:
+  State(std::size_t repetitions);
+
+  // Runs the given function once for warm up and then the configured number of times, timing each run.
+  void measure(std::function<void()> const& run);
+
+  // Like measure(), but records the processor time used by the whole process instead of the elapsed time. Meant for
+  // code which should stay idle.
+  void measureCpuTime(std::function<void()> const& run);
+
+  // The number of items (statements, rows, figures...) processed in each run, to report a throughput.
+  void setItems(std::size_t items) { _items = items; }
+
+  std::size_t items() const { return _items; }
+  std::vector<double> const& samples() const { return _samples; }
+
+private:
+  std::size_t _repetitions;
+  std::size_t _items = 0;
+  std::vector<double> _samples; // Seconds per run.
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+struct Result {
+  std::string name;
+  std::size_t items = 0;
+  std::vector<double> samples;
+
+  double min() const;
+  double median() const;
+  double mean() const;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+using BenchmarkFunction = std::function<void(State &)>;
+
+class Registry {
+public:
+  static Registry& get();
+
+  void add(std::string const& name, BenchmarkFunction function);
+
+  // Sorted by name, which groups benchmarks by their area prefix (e.g. "parser/").
+  std::map<std::string, BenchmarkFunction> const& benchmarks() const { return _benchmarks; }
+
+private:
+  std::map<std::string, BenchmarkFunction> _benchmarks;
+};
+
+// Registers a benchmark when a static instance is created.
+struct Registration {
+  Registration(std::string const& name, BenchmarkFunction function) {
+    Registry::get().add(name, function);
+  }
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// The repeatable pseudo random number source all generators use, so that each run works on the same input.
+class Random {
+public:
+  Random(unsigned int seed = 1) : _value(seed) {}
+
+  unsigned int next(unsigned int limit) {
+    _value = _value * 1103515245 + 12345;
+    return (_value >> 8) % limit;
+  }
+
+private:
+  unsigned int _value;
+};
+
+std::string dataDir();
+std::string outputDir();
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Result files are JSON documents: { "results": [ { "name": ..., "median": ..., ... }, ... ] }.
+void writeResults(std::vector<Result> const& results, std::string const& path);
+
+// Returns the median times (in seconds) of a result file, by benchmark name.
+std::map<std::string, double> readBaseline(std::string const& path);
+
+/**
+ * Prints a comparison of the results with the baseline and returns the number of benchmarks whose median is
+ * slower than the baseline by more than the given tolerance (in percent).
+ */
+std::size_t compareWithBaseline(std::vector<Result> const& results, std::map<std::string, double> const& baseline,
+                                double tolerance);
+
+} // namespace benchmarks
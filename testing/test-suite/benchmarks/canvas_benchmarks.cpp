@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <memory>
+
+#include "mdc.h"
+#include "mdc_canvas_view_image.h"
+
+#include "benchmark.h"
+
+using namespace benchmarks;
+
+namespace {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * A dense diagram: 20000 boxes with a caption each, on a grid of 200 x 100 cells.
+ */
+class DenseDiagram {
+public:
+  static const int columns = 200;
+  static const int rows = 100;
+
+  DenseDiagram(int width, int height, bool tileCache = false) : _view(width, height) {
+    _view.initialize();
+    _view.set_page_size(base::Size(columns * 60.0 + 20, rows * 60.0 + 20));
+    mdc::Layer *layer = _view.get_current_layer();
+    layer->set_tile_cache_enabled(tileCache);
+
+    Random random;
+    for (int i = 0; i < columns * rows; ++i) {
+      base::Point position((i % columns) * 60.0 + 10, (i / columns) * 60.0 + 10);
+
+      _figures.push_back(std::make_unique<mdc::RectangleFigure>(layer));
+      mdc::RectangleFigure *box = static_cast<mdc::RectangleFigure *>(_figures.back().get());
+      layer->add_item(box);
+      box->move_to(position);
+      box->set_fixed_size(base::Size(45.0 + random.next(10), 40.0 + random.next(10)));
+      box->set_pen_color(base::Color(random.next(10) / 9.0, random.next(10) / 9.0, random.next(10) / 9.0));
+      box->set_filled(true);
+      box->set_fill_color(base::Color(0.9, 0.9, random.next(10) / 9.0));
+      if (i % 3 == 0)
+        box->set_rounded_corners(6, mdc::CAll);
+
+      _figures.push_back(std::make_unique<mdc::TextFigure>(layer));
+      mdc::TextFigure *caption = static_cast<mdc::TextFigure *>(_figures.back().get());
+      layer->add_item(caption);
+      caption->set_text("table" + std::to_string(i));
+      caption->move_to(base::Point(position.x + 2, position.y + 2));
+      caption->set_fixed_size(base::Size(40, 14));
+    }
+  }
+
+  mdc::ImageCanvasView& view() {
+    return _view;
+  }
+
+private:
+  mdc::ImageCanvasView _view;
+  std::vector<std::unique_ptr<mdc::CanvasItem>> _figures;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Scrolls over the diagram in steps smaller than the view, as a user dragging the scroll bars does.
+void scroll(State &state, bool tileCache) {
+  DenseDiagram diagram(1600, 1000, tileCache);
+
+  const int steps = 50;
+  state.measure([&]() {
+    for (int i = 0; i < steps; ++i) {
+      diagram.view().set_offset(base::Point((i % 10) * 900.0, (i / 10) * 900.0));
+      diagram.view().repaint();
+    }
+  });
+  state.setItems(steps);
+}
+
+Registration repaintScrolling("canvas/repaint-scrolling", [](State &state) {
+  scroll(state, false);
+});
+
+Registration repaintScrollingCached("canvas/repaint-scrolling-tile-cache", [](State &state) {
+  scroll(state, true);
+});
+
+//----------------------------------------------------------------------------------------------------------------------
+
+Registration repaintZoomedOut("canvas/repaint-zoomed-out", [](State &state) {
+  DenseDiagram diagram(1600, 1000);
+
+  // The whole diagram is visible, so every figure gets painted.
+  diagram.view().set_zoom(0.125f);
+  const int repaints = 5;
+  state.measure([&]() {
+    for (int i = 0; i < repaints; ++i)
+      diagram.view().repaint();
+  });
+  state.setItems(repaints);
+});
+
+} // namespace
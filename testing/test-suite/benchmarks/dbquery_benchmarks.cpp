@@ -0,0 +1,218 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "grt.h"
+#include "grtpp_module_cpp.h"
+
+#include "result_batch.h"
+
+#include "benchmark.h"
+
+using namespace benchmarks;
+
+namespace {
+
+static const std::size_t rowCount = 1000000;
+static const std::size_t batchSize = 1000;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Stands in for a connector result set of rowCount rows with the columns id (integer), name (string),
+ * price (double), quantity (integer) and comment (string, every 10th is NULL). Values are computed from the
+ * row number or taken from a small pool, so the result costs no memory.
+ */
+class FakeResult {
+public:
+  FakeResult() {
+    for (std::size_t i = 0; i < 1000; ++i) {
+      _names.push_back("product name " + std::to_string(i));
+      _comments.push_back("a somewhat longer comment, for product number " + std::to_string(i));
+    }
+
+    _columns.add("id", dbquery::IntegerColumn);
+    _columns.add("name", dbquery::StringColumn);
+    _columns.add("price", dbquery::DoubleColumn);
+    _columns.add("quantity", dbquery::IntegerColumn);
+    _columns.add("comment", dbquery::StringColumn);
+  }
+
+  void rewind() {
+    _row = 0;
+  }
+
+  bool next() {
+    if (_row >= rowCount)
+      return false;
+    ++_row;
+    return true;
+  }
+
+  bool isNull(uint32_t column) const {
+    return column == 5 && _row % 10 == 0;
+  }
+
+  int64_t getInt64(uint32_t column) const {
+    return column == 1 ? (int64_t)_row : (int64_t)(_row % 100);
+  }
+
+  int32_t getInt(uint32_t column) const {
+    return (int32_t)getInt64(column);
+  }
+
+  long double getDouble(uint32_t column) const {
+    return _row * 0.25;
+  }
+
+  std::string getString(uint32_t column) const {
+    return column == 2 ? _names[_row % _names.size()] : _comments[_row % _comments.size()];
+  }
+
+  const dbquery::ResultColumns& columns() const {
+    return _columns;
+  }
+
+private:
+  std::size_t _row = 0;
+  std::vector<std::string> _names;
+  std::vector<std::string> _comments;
+  dbquery::ResultColumns _columns;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * The result access functions of the DbMySQLQuery module over a FakeResult (always result id 1). Calls go through
+ * the module dispatch, like those of scripts.
+ */
+class BenchmarkQueryImpl : public grt::ModuleImplBase {
+public:
+  BenchmarkQueryImpl(grt::CPPModuleLoader *loader) : grt::ModuleImplBase(loader) {
+  }
+
+  DEFINE_INIT_MODULE("1.0", "Oracle", grt::ModuleImplBase, DECLARE_MODULE_FUNCTION(BenchmarkQueryImpl::resultNextRow),
+                     DECLARE_MODULE_FUNCTION(BenchmarkQueryImpl::resultFieldIntValue),
+                     DECLARE_MODULE_FUNCTION(BenchmarkQueryImpl::resultFieldDoubleValue),
+                     DECLARE_MODULE_FUNCTION(BenchmarkQueryImpl::resultFieldStringValue),
+                     DECLARE_MODULE_FUNCTION(BenchmarkQueryImpl::resultFetchRows),
+                     DECLARE_MODULE_FUNCTION(BenchmarkQueryImpl::resultFetchColumns), NULL);
+
+  FakeResult result;
+
+  int resultNextRow(int) {
+    return result.next() ? 1 : 0;
+  }
+
+  grt::IntegerRef resultFieldIntValue(int, int field) {
+    if (result.isNull(field))
+      return grt::IntegerRef(0);
+    return grt::IntegerRef(result.getInt(field));
+  }
+
+  double resultFieldDoubleValue(int, int field) {
+    return (double)result.getDouble(field);
+  }
+
+  grt::StringRef resultFieldStringValue(int, int field) {
+    if (result.isNull(field))
+      return grt::StringRef();
+    return grt::StringRef(result.getString(field));
+  }
+
+  grt::BaseListRef resultFetchRows(int, int count) {
+    return dbquery::fetchRows(result, result.columns(), count);
+  }
+
+  grt::BaseListRef resultFetchColumns(int, int count) {
+    return dbquery::fetchColumns(result, result.columns(), count);
+  }
+};
+
+grt::BaseListRef arguments(int first, int second = -1) {
+  grt::BaseListRef list(true);
+  list.ginsert(grt::IntegerRef(first));
+  if (second >= 0)
+    list.ginsert(grt::IntegerRef(second));
+  return list;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+Registration readCells("dbquery/read-cells", [](State &state) {
+  BenchmarkQueryImpl *module = grt::GRT::get()->get_native_module<BenchmarkQueryImpl>();
+
+  // One call to advance each row plus one for each value, what resultNextRow() loops in scripts do.
+  grt::BaseListRef next = arguments(1);
+  std::vector<std::pair<std::string, grt::BaseListRef>> fields = {
+    { "resultFieldIntValue", arguments(1, 1) }, { "resultFieldStringValue", arguments(1, 2) },
+    { "resultFieldDoubleValue", arguments(1, 3) }, { "resultFieldIntValue", arguments(1, 4) },
+    { "resultFieldStringValue", arguments(1, 5) }
+  };
+
+  state.measure([&]() {
+    module->result.rewind();
+    std::size_t rows = 0;
+    while (*grt::IntegerRef::cast_from(module->call_function("resultNextRow", next)) != 0) {
+      for (auto &field : fields)
+        module->call_function(field.first, field.second);
+      ++rows;
+    }
+    if (rows != rowCount)
+      throw std::runtime_error("Unexpected row count " + std::to_string(rows));
+  });
+  state.setItems(rowCount);
+});
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Reads the result in batches of batchSize rows with the given batch function.
+void readBatches(State &state, std::string const& function) {
+  BenchmarkQueryImpl *module = grt::GRT::get()->get_native_module<BenchmarkQueryImpl>();
+  grt::BaseListRef batch = arguments(1, (int)batchSize);
+
+  state.measure([&]() {
+    module->result.rewind();
+    std::size_t rows = 0;
+    while (true) {
+      grt::BaseListRef values = grt::BaseListRef::cast_from(module->call_function(function, batch));
+      std::size_t count = function == "resultFetchRows" ? values.count()
+                                                        : grt::BaseListRef::cast_from(values[0]).count();
+      if (count == 0)
+        break;
+      rows += count;
+    }
+    if (rows != rowCount)
+      throw std::runtime_error("Unexpected row count " + std::to_string(rows));
+  });
+  state.setItems(rowCount);
+}
+
+Registration fetchRows("dbquery/fetch-rows", [](State &state) {
+  readBatches(state, "resultFetchRows");
+});
+
+Registration fetchColumns("dbquery/fetch-columns", [](State &state) {
+  readBatches(state, "resultFetchColumns");
+});
+
+} // namespace
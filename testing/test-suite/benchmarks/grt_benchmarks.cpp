@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "grt.h"
+#include "grtpp_util.h"
+#include "diff/diffchange.h"
+#include "grts/structs.db.mysql.h"
+
+#include "base/file_utilities.h"
+
+#include "benchmark.h"
+
+using namespace benchmarks;
+
+namespace {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Creates a catalog with tables linked by foreign keys, of about the size of a big model (200 tables with
+ * 30 columns each by default).
+ */
+db_mysql_CatalogRef createCatalog(std::size_t schemaCount = 4, std::size_t tableCount = 50,
+                                  std::size_t columnCount = 30) {
+  db_mysql_CatalogRef catalog(grt::Initialized);
+  for (std::size_t s = 0; s < schemaCount; ++s) {
+    db_mysql_SchemaRef schema(grt::Initialized);
+    schema->owner(catalog);
+    schema->name("schema" + std::to_string(s));
+    catalog->schemata().insert(schema);
+
+    db_mysql_TableRef previous;
+    for (std::size_t t = 0; t < tableCount; ++t) {
+      db_mysql_TableRef table(grt::Initialized);
+      table->owner(schema);
+      table->name("table" + std::to_string(t));
+      table->comment("Table number " + std::to_string(t) + " of schema " + *schema->name());
+      schema->tables().insert(table);
+
+      for (std::size_t c = 0; c < columnCount; ++c) {
+        db_mysql_ColumnRef column(grt::Initialized);
+        column->owner(table);
+        column->name("column" + std::to_string(c));
+        column->length(c == 0 ? -1 : 45);
+        column->defaultValue(c == 0 ? "0" : "NULL");
+        column->isNotNull(c == 0 ? 1 : 0);
+        column->comment("Column " + std::to_string(c) + " of " + *table->name());
+        table->columns().insert(column);
+      }
+
+      db_mysql_IndexRef index(grt::Initialized);
+      index->owner(table);
+      index->name("PRIMARY");
+      index->isPrimary(1);
+      db_mysql_IndexColumnRef indexColumn(grt::Initialized);
+      indexColumn->owner(index);
+      indexColumn->referencedColumn(table->columns()[0]);
+      index->columns().insert(indexColumn);
+      table->indices().insert(index);
+      table->primaryKey(index);
+
+      if (previous.is_valid()) {
+        db_mysql_ForeignKeyRef fk(grt::Initialized);
+        fk->owner(table);
+        fk->name("fk_" + *table->name());
+        fk->referencedTable(previous);
+        fk->columns().insert(table->columns()[1]);
+        fk->referencedColumns().insert(previous->columns()[0]);
+        table->foreignKeys().insert(fk);
+      }
+      previous = table;
+    }
+  }
+  return catalog;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+std::size_t countTables(db_mysql_CatalogRef catalog) {
+  std::size_t count = 0;
+  for (std::size_t i = 0; i < catalog->schemata().count(); ++i)
+    count += catalog->schemata()[i]->tables().count();
+  return count;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+Registration serializeXml("grt/serialize-xml", [](State &state) {
+  db_mysql_CatalogRef catalog = createCatalog();
+  std::string path = outputDir() + "/catalog.xml";
+
+  state.measure([&]() { grt::GRT::get()->serialize(catalog, path); });
+  state.setItems(countTables(catalog));
+});
+
+//----------------------------------------------------------------------------------------------------------------------
+
+Registration unserializeXml("grt/unserialize-xml", [](State &state) {
+  db_mysql_CatalogRef catalog = createCatalog();
+  std::string path = outputDir() + "/catalog.xml";
+  grt::GRT::get()->serialize(catalog, path);
+
+  state.measure([&]() {
+    if (!grt::GRT::get()->unserialize(path).is_valid())
+      throw std::runtime_error("Could not load " + path);
+  });
+  state.setItems(countTables(catalog));
+  base::remove(path);
+});
+
+//----------------------------------------------------------------------------------------------------------------------
+
+Registration serializeBinary("grt/serialize-binary", [](State &state) {
+  db_mysql_CatalogRef catalog = createCatalog();
+  std::string path = outputDir() + "/catalog.grtb";
+
+  state.measure([&]() { grt::GRT::get()->serialize_binary(catalog, path, "benchmark", "1.0"); });
+  state.setItems(countTables(catalog));
+  base::remove(path);
+});
+
+//----------------------------------------------------------------------------------------------------------------------
+
+Registration unserializeBinary("grt/unserialize-binary", [](State &state) {
+  db_mysql_CatalogRef catalog = createCatalog();
+  std::string path = outputDir() + "/catalog.grtb";
+  grt::GRT::get()->serialize_binary(catalog, path, "benchmark", "1.0");
+
+  state.measure([&]() {
+    std::string doctype, version;
+    if (!grt::GRT::get()->unserialize_binary(path, doctype, version).is_valid())
+      throw std::runtime_error("Could not load " + path);
+  });
+  state.setItems(countTables(catalog));
+  base::remove(path);
+});
+
+//----------------------------------------------------------------------------------------------------------------------
+
+Registration listDiff("grt/list-diff", [](State &state) {
+  // Two lists of 20000 values where the target has some values removed, inserted and moved.
+  Random random;
+  grt::IntegerListRef source(grt::Initialized);
+  grt::IntegerListRef target(grt::Initialized);
+  for (int i = 0; i < 20000; ++i) {
+    source.insert(i);
+    switch (random.next(40)) {
+      case 0: // Removed.
+        break;
+      case 1: // Inserted.
+        target.insert(100000 + i);
+        target.insert(i);
+        break;
+      case 2: // Moved to the front.
+        target.insert(i, 0);
+        break;
+      default:
+        target.insert(i);
+    }
+  }
+
+  grt::default_omf omf;
+  state.measure([&]() {
+    if (!grt::diff_make(source, target, &omf))
+      throw std::runtime_error("No differences found");
+  });
+  state.setItems(source.count());
+});
+
+//----------------------------------------------------------------------------------------------------------------------
+
+Registration catalogDiff("grt/catalog-diff", [](State &state) {
+  db_mysql_CatalogRef source = createCatalog();
+  db_mysql_CatalogRef target = createCatalog();
+
+  // Change every 10th table of the target: rename a column, drop one and add a new one.
+  Random random;
+  for (std::size_t s = 0; s < target->schemata().count(); ++s) {
+    grt::ListRef<db_mysql_Table> tables = target->schemata()[s]->tables();
+    for (std::size_t t = 0; t < tables.count(); t += 10) {
+      db_mysql_TableRef table = tables[t];
+      table->columns()[2 + random.next(10)]->name("renamed");
+      table->columns().remove(table->columns().count() - 1);
+
+      db_mysql_ColumnRef column(grt::Initialized);
+      column->owner(table);
+      column->name("added");
+      table->columns().insert(column);
+    }
+  }
+
+  grt::default_omf omf;
+  state.measure([&]() {
+    if (!grt::diff_make(source, target, &omf))
+      throw std::runtime_error("No differences found");
+  });
+  state.setItems(countTables(source));
+});
+
+} // namespace
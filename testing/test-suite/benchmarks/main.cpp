@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <cstdio>
+#include <iostream>
+
+#include "data_types.h"
+#include "grt.h"
+
+#include "benchmark.h"
+
+using namespace benchmarks;
+
+extern void register_all_metaclasses();
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Loads the GRT classes, which is all of the Workbench runtime the benchmarks need.
+ */
+static void initializeRuntime() {
+  grt::GRT::get()->setTesting(true);
+  if (grt::GRT::get()->metaclassesNeedRegister())
+    register_all_metaclasses();
+  grt::GRT::get()->scan_metaclasses_in(dataDir() + "/grt");
+  grt::GRT::get()->end_loading_metaclasses();
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+int main(int argc, const char *argv[]) {
+  dataTypes::OptionsList opts;
+  std::string filter;
+  std::string outputFile;
+  std::string baselineFile;
+  int repetitions = 5;
+  int tolerance = 10;
+
+  opts.addEntry(dataTypes::OptionEntry(dataTypes::OptionArgumentLogical,
+    'h', "help", "Show recognized options",
+    [&](const dataTypes::OptionEntry &entry, int *retval) {
+      std::cout << opts.getHelp(argv[0]);
+      *retval = 0;
+      return false;
+    })
+  );
+
+  opts.addEntry(dataTypes::OptionEntry(dataTypes::OptionArgumentLogical,
+    0, "list", "List all benchmarks",
+    [&](const dataTypes::OptionEntry &entry, int *retval) {
+      for (auto &benchmark : Registry::get().benchmarks())
+        std::cout << benchmark.first << std::endl;
+      *retval = 0;
+      return false;
+    })
+  );
+
+  opts.addEntry(dataTypes::OptionEntry(dataTypes::OptionArgumentText,
+    "filter", "Run only the benchmarks whose name contains the given text",
+    [&](const dataTypes::OptionEntry &entry, int *retval) {
+      filter = entry.value.textValue;
+      return true;
+    }, "<text>")
+  );
+
+  opts.addEntry(dataTypes::OptionEntry(dataTypes::OptionArgumentNumeric,
+    "repeat", "Number of timed runs per benchmark (default 5), the median of them is reported",
+    [&](const dataTypes::OptionEntry &entry, int *retval) {
+      repetitions = entry.value.numericValue;
+      return true;
+    }, "<count>")
+  );
+
+  opts.addEntry(dataTypes::OptionEntry(dataTypes::OptionArgumentText,
+    "output", "Write the results as JSON to the given file",
+    [&](const dataTypes::OptionEntry &entry, int *retval) {
+      outputFile = entry.value.textValue;
+      return true;
+    }, "<file>")
+  );
+
+  opts.addEntry(dataTypes::OptionEntry(dataTypes::OptionArgumentText,
+    "baseline", "Compare the results with a result file written by an earlier run",
+    [&](const dataTypes::OptionEntry &entry, int *retval) {
+      baselineFile = entry.value.textValue;
+      return true;
+    }, "<file>")
+  );
+
+  opts.addEntry(dataTypes::OptionEntry(dataTypes::OptionArgumentNumeric,
+    "tolerance", "Allowed slow down against the baseline, in percent (default 10)",
+    [&](const dataTypes::OptionEntry &entry, int *retval) {
+      tolerance = entry.value.numericValue;
+      return true;
+    }, "<percent>")
+  );
+
+  int rc = 0;
+  try {
+    if (!opts.parse(std::vector<std::string>(argv + 1, argv + argc), rc))
+      return rc;
+  } catch (std::runtime_error &re) {
+    std::cerr << re.what() << std::endl;
+    return 1;
+  }
+
+  std::map<std::string, double> baseline;
+  try {
+    if (!baselineFile.empty())
+      baseline = readBaseline(baselineFile);
+    initializeRuntime();
+  } catch (std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  std::vector<Result> results;
+  bool failed = false;
+  for (auto &benchmark : Registry::get().benchmarks()) {
+    if (!filter.empty() && benchmark.first.find(filter) == std::string::npos)
+      continue;
+
+    std::printf("%-40s ", benchmark.first.c_str());
+    std::fflush(stdout);
+
+    State state(repetitions);
+    try {
+      benchmark.second(state);
+    } catch (std::exception &e) {
+      std::printf("FAILED: %s\n", e.what());
+      failed = true;
+      continue;
+    }
+
+    Result result;
+    result.name = benchmark.first;
+    result.items = state.items();
+    result.samples = state.samples();
+    results.push_back(result);
+
+    std::printf("median %10.3f ms, min %10.3f ms", result.median() * 1000, result.min() * 1000);
+    if (result.items > 0 && result.median() > 0)
+      std::printf(", %12.0f items/s", result.items / result.median());
+    std::printf("\n");
+  }
+
+  try {
+    if (!outputFile.empty())
+      writeResults(results, outputFile);
+  } catch (std::exception &e) {
+    std::cerr << e.what() << std::endl;
+    return 1;
+  }
+
+  if (!baselineFile.empty() && compareWithBaseline(results, baseline, tolerance) > 0)
+    return 2;
+
+  return failed ? 1 : 0;
+}
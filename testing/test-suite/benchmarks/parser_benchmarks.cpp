@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "mysql/MySQLLexer.h"
+#include "mysql/MySQLParser.h"
+
+#include "base/string_utilities.h"
+
+#include "benchmark.h"
+
+using namespace antlr4;
+using namespace antlr4::atn;
+using namespace benchmarks;
+using namespace parsers;
+
+namespace {
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * Generates a script with a mix of DDL, multi row inserts and queries of varying complexity.
+ */
+std::vector<std::string> generateStatements(std::size_t count) {
+  static const char *types[] = { "INT", "BIGINT UNSIGNED", "VARCHAR(45)", "DECIMAL(10,2)", "DATETIME", "TEXT" };
+
+  Random random;
+  std::vector<std::string> statements;
+  for (std::size_t i = 0; i < count; ++i) {
+    std::string table = "table" + std::to_string(random.next(200));
+    switch (i % 5) {
+      case 0: {
+        std::string sql = "CREATE TABLE IF NOT EXISTS `" + table + "_" + std::to_string(i) +
+                          "` (id INT NOT NULL AUTO_INCREMENT";
+        unsigned int columnCount = 10 + random.next(20);
+        for (unsigned int c = 0; c < columnCount; ++c)
+          sql += base::strfmt(", `column%u` %s NULL DEFAULT NULL COMMENT 'column %u'", c, types[random.next(6)], c);
+        sql += ", PRIMARY KEY (id), INDEX idx_column1 (column1 ASC)) ENGINE = InnoDB DEFAULT CHARSET = utf8mb4";
+        statements.push_back(sql);
+        break;
+      }
+
+      case 1: {
+        std::string sql = "INSERT INTO " + table + " (id, title, price, created) VALUES ";
+        for (unsigned int r = 0; r < 50; ++r) {
+          if (r > 0)
+            sql += ", ";
+          sql += base::strfmt("(%u, 'name %u', %u.%02u, '2019-01-%02u 10:00:00')", random.next(100000), r,
+                              random.next(1000), random.next(100), 1 + random.next(28));
+        }
+        statements.push_back(sql);
+        break;
+      }
+
+      case 2:
+        statements.push_back(base::strfmt(
+          "SELECT t1.id, t1.title, SUM(t2.price * t2.quantity) AS total, COUNT(DISTINCT t2.order_id) "
+          "FROM %s t1 LEFT JOIN order_items t2 ON t2.product_id = t1.id AND t2.quantity > %u "
+          "WHERE t1.created BETWEEN '2019-01-01' AND '2019-06-30' AND t1.title LIKE 'a%%' "
+          "AND t1.category_id IN (SELECT id FROM categories WHERE parent_id = %u) "
+          "GROUP BY t1.id, t1.title HAVING total > %u ORDER BY total DESC LIMIT %u",
+          table.c_str(), random.next(10), random.next(50), random.next(10000), 1 + random.next(100)));
+        break;
+
+      case 3:
+        statements.push_back(base::strfmt(
+          "UPDATE %s SET price = price * 1.1, updated = NOW() WHERE id = %u AND (state = 'active' OR state IS NULL)",
+          table.c_str(), random.next(100000)));
+        break;
+
+      default:
+        statements.push_back(base::strfmt(
+          "WITH recent AS (SELECT customer_id, MAX(created) AS last_order FROM %s GROUP BY customer_id) "
+          "SELECT c.*, r.last_order, "
+          "ROW_NUMBER() OVER (PARTITION BY c.country ORDER BY r.last_order DESC) AS row_position "
+          "FROM customers c JOIN recent r ON r.customer_id = c.id WHERE c.id > %u",
+          table.c_str(), random.next(1000)));
+        break;
+    }
+  }
+  return statements;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+class Parser {
+public:
+  Parser() : _lexer(&_input), _tokens(&_lexer), _parser(&_tokens) {
+    _lexer.serverVersion = 80016;
+    _parser.serverVersion = 80016;
+    _lexer.sqlModeFromString("ANSI_QUOTES");
+    _parser.sqlModeFromString("ANSI_QUOTES");
+    _lexer.charsets = { "_utf8mb4", "_utf8", "_latin1", "_binary" };
+    _lexer.removeErrorListeners();
+    _parser.removeErrorListeners();
+  }
+
+  // Returns the number of tokens in the given text.
+  std::size_t tokenize(std::string const& sql) {
+    load(sql);
+    _tokens.fill();
+    return _tokens.size();
+  }
+
+  // Parses a single statement the way the editor does: SLL first and only if that fails again with LL.
+  std::size_t parse(std::string const& sql) {
+    load(sql);
+    _parser.reset();
+    _parser.setErrorHandler(_bailOut);
+    _parser.getInterpreter<ParserATNSimulator>()->setPredictionMode(PredictionMode::SLL);
+
+    try {
+      _parser.query();
+    } catch (ParseCancellationException &) {
+      _tokens.reset();
+      _parser.reset();
+      _parser.setErrorHandler(_defaultStrategy);
+      _parser.getInterpreter<ParserATNSimulator>()->setPredictionMode(PredictionMode::LL);
+      _parser.query();
+    }
+    return _lexer.getNumberOfSyntaxErrors() + _parser.getNumberOfSyntaxErrors();
+  }
+
+private:
+  ANTLRInputStream _input;
+  MySQLLexer _lexer;
+  CommonTokenStream _tokens;
+  MySQLParser _parser;
+  Ref<BailErrorStrategy> _bailOut = std::make_shared<BailErrorStrategy>();
+  Ref<DefaultErrorStrategy> _defaultStrategy = std::make_shared<DefaultErrorStrategy>();
+
+  void load(std::string const& sql) {
+    _input.load(sql);
+    _lexer.reset();
+    _lexer.setInputStream(&_input);
+    _tokens.setTokenSource(&_lexer);
+  }
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+Registration tokenizeScript("parser/tokenize-script", [](State &state) {
+  std::string script;
+  for (auto &statement : generateStatements(5000))
+    script += statement + ";\n";
+
+  Parser parser;
+  std::size_t tokens = 0;
+  state.measure([&]() { tokens = parser.tokenize(script); });
+  state.setItems(tokens);
+});
+
+//----------------------------------------------------------------------------------------------------------------------
+
+Registration parseStatements("parser/parse-statements", [](State &state) {
+  std::vector<std::string> statements = generateStatements(2000);
+
+  Parser parser;
+  state.measure([&]() {
+    std::size_t errors = 0;
+    for (auto &statement : statements)
+      errors += parser.parse(statement);
+    if (errors > 0)
+      throw std::runtime_error("The generated statements contain syntax errors");
+  });
+  state.setItems(statements.size());
+});
+
+} // namespace
@@ -0,0 +1,256 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <sqlite/connection.hpp>
+#include <sqlite/execute.hpp>
+#include <sqlite/query.hpp>
+
+#include "base/file_utilities.h"
+#include "base/string_utilities.h"
+
+#include "sqlide/recordset_be.h"
+#include "sqlide/recordset_sql_storage.h"
+#include "sqlide/recordset_sqlite_storage.h"
+#include "sqlide/recordset_text_writer.h"
+#include "sqlide/sqlide_generics.h"
+
+#include "benchmark.h"
+
+using namespace benchmarks;
+
+namespace {
+
+static const std::size_t rowCount = 20000;
+static const std::size_t columnCount = 40;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * A wide result set: rows of integer, real, short and long text and date columns, with some NULLs.
+ * Values are kept as the strings an export gets to see.
+ */
+struct WideResultSet {
+  std::vector<std::string> columnNames;
+  std::vector<std::string> columnTypes;
+  std::vector<std::vector<std::string>> rows;
+  std::vector<std::vector<bool>> nulls;
+
+  WideResultSet() {
+    static const char *types[] = { "INTEGER", "REAL", "VARCHAR(45)", "TEXT", "DATETIME" };
+
+    for (std::size_t c = 0; c < columnCount; ++c) {
+      columnNames.push_back("column" + std::to_string(c));
+      columnTypes.push_back(types[c % 5]);
+    }
+
+    Random random;
+    rows.resize(rowCount);
+    nulls.resize(rowCount);
+    for (std::size_t r = 0; r < rowCount; ++r) {
+      for (std::size_t c = 0; c < columnCount; ++c) {
+        bool isNull = c > 0 && random.next(20) == 0;
+        nulls[r].push_back(isNull);
+        if (isNull) {
+          rows[r].push_back("NULL");
+          continue;
+        }
+
+        switch (c % 5) {
+          case 0:
+            rows[r].push_back(std::to_string(c == 0 ? r : random.next(1000000)));
+            break;
+          case 1:
+            rows[r].push_back(base::strfmt("%u.%02u", random.next(100000), random.next(100)));
+            break;
+          case 2:
+            rows[r].push_back(base::strfmt("name %u, \"quoted\"", random.next(100000)));
+            break;
+          case 3:
+            rows[r].push_back(std::string(20 + random.next(200), 'a' + random.next(26)));
+            break;
+          default:
+            rows[r].push_back(base::strfmt("2019-%02u-%02u 12:%02u:00", 1 + random.next(12), 1 + random.next(28),
+                                           random.next(60)));
+            break;
+        }
+      }
+    }
+  }
+
+  // Stores the rows in an SQLite table named "wide", the way a recordset's data storage keeps them.
+  void store(std::string const& path) const {
+    base::tryRemove(path);
+    sqlite::connection connection(path);
+    sqlide::optimize_sqlite_connection_for_speed(&connection);
+
+    std::string create = "create table wide (";
+    std::string insert = "insert into wide values (";
+    for (std::size_t c = 0; c < columnCount; ++c) {
+      create += (c > 0 ? ", `" : "`") + columnNames[c] + "` " + columnTypes[c];
+      insert += c > 0 ? ", ?" : "?";
+    }
+    sqlite::execute(connection, create + ")", true);
+
+    sqlide::Sqlite_transaction_guarder transaction(&connection);
+    sqlite::query query(connection, insert + ")");
+    for (std::size_t r = 0; r < rowCount; ++r) {
+      for (std::size_t c = 0; c < columnCount; ++c) {
+        if (nulls[r][c])
+          query % sqlite::nil;
+        else if (c % 5 == 0)
+          query % base::atoi<int>(rows[r][c]);
+        else if (c % 5 == 1)
+          query % base::atof<double>(rows[r][c]);
+        else
+          query % rows[r][c];
+      }
+      query.emit();
+      query.clear();
+    }
+  }
+};
+
+WideResultSet& wideResultSet() {
+  static WideResultSet resultSet;
+  return resultSet;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+Recordset::Ref loadRecordset(std::string const& path) {
+  Recordset_sqlite_storage::Ref storage = Recordset_sqlite_storage::create();
+  storage->db_path(path);
+  storage->table_name("wide");
+
+  Recordset::Ref recordset = Recordset::create();
+  recordset->data_storage(storage);
+  recordset->reset(true);
+  if (recordset->row_count() != rowCount)
+    throw std::runtime_error("Unexpected row count " + std::to_string(recordset->row_count()));
+  return recordset;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+Registration loadSwapDb("recordset/load-swap-db", [](State &state) {
+  std::string path = outputDir() + "/wide_result.db";
+  wideResultSet().store(path);
+
+  state.measure([&]() { loadRecordset(path); });
+  state.setItems(rowCount);
+  base::tryRemove(path);
+});
+
+//----------------------------------------------------------------------------------------------------------------------
+
+Registration readFields("recordset/read-fields", [](State &state) {
+  std::string path = outputDir() + "/wide_result.db";
+  wideResultSet().store(path);
+  Recordset::Ref recordset = loadRecordset(path);
+
+  // Reads all values row by row, as scrolling through the result grid does.
+  state.measure([&]() {
+    std::string value;
+    for (std::size_t r = 0; r < rowCount; ++r) {
+      bec::NodeId node(r);
+      for (std::size_t c = 0; c < columnCount; ++c)
+        recordset->get_field_repr(node, c, value);
+    }
+  });
+  state.setItems(rowCount);
+
+  recordset.reset();
+  base::tryRemove(path);
+});
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Loading a table's stored inserts (INSERT statements of 1000 rows each), as opening its Inserts editor does.
+Registration loadInsertsScript("recordset/load-inserts-script", [](State &state) {
+  WideResultSet &resultSet = wideResultSet();
+
+  std::string header = "INSERT INTO `wide` (";
+  for (std::size_t c = 0; c < columnCount; ++c)
+    header += (c > 0 ? ", `" : "`") + resultSet.columnNames[c] + "`";
+  header += ") VALUES\n";
+
+  std::string script;
+  for (std::size_t r = 0; r < rowCount; ++r) {
+    script += r % 1000 == 0 ? header : ",\n";
+    for (std::size_t c = 0; c < columnCount; ++c) {
+      script += c > 0 ? ", " : "(";
+      bool quoted = !resultSet.nulls[r][c] && c % 5 > 1;
+      script += quoted ? "'" + resultSet.rows[r][c] + "'" : resultSet.rows[r][c];
+    }
+    script += r % 1000 == 999 || r + 1 == rowCount ? ");\n" : ")";
+  }
+
+  state.measure([&]() {
+    Recordset_sql_storage::Ref storage = Recordset_sql_storage::create();
+    storage->sql_script(script);
+    storage->table_name("wide");
+
+    Recordset::Ref recordset = Recordset::create();
+    recordset->data_storage(storage);
+    recordset->reset();
+    if (recordset->real_row_count() != rowCount)
+      throw std::runtime_error("Unexpected row count " + std::to_string(recordset->real_row_count()));
+  });
+  state.setItems(rowCount);
+});
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// The row formatting of result set exports (and of the data copy's INSERT generation) for the bundled formats.
+void writeRows(State &state, std::string const& format) {
+  WideResultSet &resultSet = wideResultSet();
+  std::string path = outputDir() + "/wide_result." + format;
+  Recordset_text_writer::Variables variables = {
+    { "TABLE_NAME", "wide" }, { "GENERATOR_QUERY", "SELECT * FROM wide" }, { "GENERATE_DATE", "2019-01-01" }
+  };
+
+  state.measure([&]() {
+    Recordset_text_writer::Ref writer = Recordset_text_writer::create(format, path, resultSet.columnNames, variables);
+    writer->write_header();
+    for (std::size_t r = 0; r < rowCount; ++r)
+      writer->write_row(resultSet.rows[r], resultSet.nulls[r], r + 1 == rowCount);
+    writer->write_footer();
+    writer->flush();
+  });
+  state.setItems(rowCount);
+  base::tryRemove(path);
+}
+
+Registration writeCsv("recordset/write-csv", [](State &state) {
+  writeRows(state, "CSV");
+});
+
+Registration writeInserts("recordset/write-sql-inserts", [](State &state) {
+  writeRows(state, "SQL_inserts");
+});
+
+Registration writeJson("recordset/write-json", [](State &state) {
+  writeRows(state, "JSON");
+});
+
+} // namespace
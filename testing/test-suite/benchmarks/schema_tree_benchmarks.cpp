@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <functional>
+
+#include "base/string_utilities.h"
+
+#include "stub/stub_mforms.h"
+#include "sqlide/wb_live_schema_tree.h"
+
+#include "benchmark.h"
+
+using namespace benchmarks;
+using namespace wb;
+
+namespace {
+
+static const std::size_t schemaCount = 100;
+static const std::size_t tableCount = 1000;
+
+// Typed one character at a time, each prefix matches less of the tables.
+static const std::vector<std::string> typedFilters = {
+  "*.c", "*.cu", "*.cus", "*.cust", "*.custo", "*.custom", "*.custome", "*.customer"
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * A sidebar with 100 schemas of 1000 tables each, like the schema tree of a big server, and a filtered copy of it.
+ * Table names are made of two words out of a small set, so each filter prefix still matches a good part of them.
+ */
+class BigSchemaTree {
+public:
+  BigSchemaTree() : _tree(base::MySQLVersion::MySQL57), _filtered(base::MySQLVersion::MySQL57) {
+    static const char *words[] = { "customer", "customs", "cursor", "catalog", "order", "product", "invoice", "stock" };
+
+    mforms::stub::init(nullptr);
+    _view = new mforms::TreeView(mforms::TreeNoColumns | mforms::TreeNoBorder | mforms::TreeSidebar |
+                                 mforms::TreeNoHeader);
+    _filteredView = new mforms::TreeView(mforms::TreeNoColumns | mforms::TreeNoBorder | mforms::TreeSidebar |
+                                         mforms::TreeNoHeader);
+    _tree.set_model_view(_view);
+    _filtered.set_model_view(_filteredView);
+    _filtered.set_base(&_tree);
+
+    base::StringListPtr schemas(new std::list<std::string>());
+    for (std::size_t s = 0; s < schemaCount; ++s)
+      schemas->push_back(base::strfmt("schema_%03zu", s));
+    _tree.update_schemata(schemas);
+
+    Random random;
+    mforms::TreeNodeRef root = _view->root_node();
+    for (std::size_t s = 0; s < schemaCount; ++s) {
+      base::StringListPtr tables(new std::list<std::string>());
+      for (std::size_t t = 0; t < tableCount; ++t)
+        tables->push_back(std::string(words[random.next(8)]) + "_" + words[random.next(8)] + "_" + std::to_string(t));
+      tables->sort(std::bind(base::stl_string_compare, std::placeholders::_1, std::placeholders::_2, false));
+
+      _tree.update_node_children(root->get_child((int)s)->get_child(LiveSchemaTree::TABLES_NODE_INDEX), tables,
+                                 LiveSchemaTree::Table, true);
+    }
+  }
+
+  ~BigSchemaTree() {
+    _filtered.set_model_view(nullptr);
+    _tree.set_model_view(nullptr);
+    _filteredView->release();
+    _view->release();
+  }
+
+  // Applies the given filter as the sidebar filter box does on each change of its text.
+  void filter(const std::string &text) {
+    _filtered.set_filter(text);
+    _filtered.filter_data();
+  }
+
+private:
+  LiveSchemaTree _tree;
+  LiveSchemaTree _filtered;
+  mforms::TreeView *_view = nullptr;
+  mforms::TreeView *_filteredView = nullptr;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Typing the filter: the first character rebuilds the filtered tree, the following ones only narrow it down.
+Registration filterNarrow("schema_tree/filter-narrow", [](State &state) {
+  BigSchemaTree tree;
+
+  state.measure([&]() {
+    for (auto &text : typedFilters)
+      tree.filter(text);
+  });
+  state.setItems(schemaCount * tableCount);
+});
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Deleting the filter with backspace: each shorter filter matches more, so the filtered tree is rebuilt every time.
+// The run ends by going back to the full filter, so that all runs start from the same state.
+Registration filterWiden("schema_tree/filter-widen", [](State &state) {
+  BigSchemaTree tree;
+  tree.filter(typedFilters.back());
+
+  state.measure([&]() {
+    for (auto text = typedFilters.rbegin() + 1; text != typedFilters.rend(); ++text)
+      tree.filter(*text);
+    tree.filter(typedFilters.back());
+  });
+  state.setItems(schemaCount * tableCount);
+});
+
+} // namespace
@@ -0,0 +1,302 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <sys/socket.h>
+#include <poll.h>
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "SSHTunnelRelay.h"
+
+#include "benchmark.h"
+
+using namespace benchmarks;
+
+namespace {
+
+static const std::size_t bufferSize = 10240; // The default of SSHConnectionConfig.
+static const std::size_t payloadSize = 32 * 1024 * 1024;
+static const int idleMilliseconds = 250;
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * A tunnel channel over one end of a socket pair, the benchmark plays the remote end on the other one. Like the data
+ * callback of an ssh channel, activity is reported once and then not again before the relay read everything (or
+ * a write which had to wait can be retried). So this exercises the relay without sshd and without encryption costs.
+ */
+class SocketChannel : public ssh::TunnelChannel {
+public:
+  explicit SocketChannel(int socket) : _socket(socket) {
+  }
+
+  virtual ~SocketChannel() {
+    close();
+  }
+
+  virtual bool attach(ssh_event event, std::function<void()> activity) override {
+    _event = event;
+    _activity = std::move(activity);
+    return update(POLLIN);
+  }
+
+  virtual void detach(ssh_event event) override {
+    update(0);
+    _activity = nullptr;
+  }
+
+  virtual int write(const char *data, std::size_t size) override {
+    ssize_t written = send(_socket, data, size, MSG_NOSIGNAL);
+    if (written >= 0)
+      return (int)written;
+    if (errno == EAGAIN || errno == EWOULDBLOCK)
+      return update(_events | POLLOUT) ? SSH_AGAIN : SSH_ERROR;
+    _closed = true;
+    return SSH_ERROR;
+  }
+
+  virtual int read(char *buffer, std::size_t size) override {
+    ssize_t count = recv(_socket, buffer, size, 0);
+    if (count > 0)
+      return (int)count;
+    if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+      return update(_events | POLLIN) ? SSH_AGAIN : SSH_ERROR;
+    _closed = true;
+    return count == 0 ? 0 : SSH_ERROR;
+  }
+
+  virtual bool isClosed() override {
+    return _closed;
+  }
+
+  virtual bool isEof() override {
+    return _closed;
+  }
+
+  virtual void close() override {
+    if (_socket != -1) {
+      ssh::wbCloseSocket(_socket);
+      _socket = -1;
+    }
+  }
+
+private:
+  bool update(short events) {
+    if (events == _events)
+      return true;
+
+    if (_events != 0)
+      ssh_event_remove_fd(_event, _socket);
+    _events = events;
+    return events == 0 || ssh_event_add_fd(_event, _socket, events, onEvent, this) == SSH_OK;
+  }
+
+  // Returns -1 if the poll handle was replaced, as ssh_event_dopoll() requires.
+  static int onEvent(socket_t fd, int revents, void *userdata) {
+    SocketChannel *channel = static_cast<SocketChannel *>(userdata);
+    short events = channel->_events;
+    if (revents & (POLLIN | POLLHUP | POLLERR))
+      events &= ~POLLIN;
+    if (revents & (POLLOUT | POLLHUP | POLLERR))
+      events &= ~POLLOUT;
+
+    bool replaced = events != channel->_events;
+    channel->update(events);
+    if (channel->_activity)
+      channel->_activity();
+    return replaced ? -1 : 0;
+  }
+
+  int _socket;
+  ssh_event _event = nullptr;
+  short _events = 0;
+  bool _closed = false;
+  std::function<void()> _activity;
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+/**
+ * A relay with the given number of tunnels, running on its own thread like in SSHTunnelHandler. The benchmark
+ * thread is the client application and the remote end of all tunnels.
+ */
+class Loopback {
+public:
+  struct Connection {
+    int client;
+    int remote;
+    std::size_t sent;
+    std::size_t received;
+    std::vector<char> echo; // Received by the remote end and not yet sent back.
+    std::size_t echoStart;
+  };
+
+  Loopback(std::size_t channels) : _relay(bufferSize) {
+    for (std::size_t i = 0; i < channels; ++i) {
+      int clientSockets[2];
+      int channelSockets[2];
+      ssh::TunnelRelay::createSocketPair(clientSockets);
+      ssh::TunnelRelay::createSocketPair(channelSockets);
+
+      _relay.addTunnel(clientSockets[1], std::unique_ptr<ssh::TunnelChannel>(new SocketChannel(channelSockets[1])));
+      _connections.push_back({ clientSockets[0], channelSockets[0], 0, 0, {}, 0 });
+    }
+    if (_relay.tunnelCount() != channels)
+      throw std::runtime_error("Could not set up the tunnels");
+  }
+
+  ~Loopback() {
+    stop();
+    for (auto &connection : _connections) {
+      ssh::wbCloseSocket(connection.client);
+      ssh::wbCloseSocket(connection.remote);
+    }
+  }
+
+  void start() {
+    _thread = std::thread([this]() {
+      while (!_stopped)
+        _relay.poll(1000);
+    });
+  }
+
+  void stop() {
+    if (_thread.joinable()) {
+      _stopped = true;
+      _relay.stop();
+      _thread.join();
+    }
+  }
+
+  // Sends size bytes from each client, which the remote ends send back, and returns once all came back.
+  void echo(std::size_t size) {
+    std::vector<char> chunk(64 * 1024, 'x');
+    for (auto &connection : _connections) {
+      connection.sent = 0;
+      connection.received = 0;
+    }
+
+    std::size_t finished = 0;
+    std::vector<pollfd> fds(2 * _connections.size());
+    while (finished < _connections.size()) {
+      for (std::size_t i = 0; i < _connections.size(); ++i) {
+        Connection &connection = _connections[i];
+        fds[2 * i] = { connection.client, (short)(POLLIN | (connection.sent < size ? POLLOUT : 0)), 0 };
+        fds[2 * i + 1] = { connection.remote, (short)(connection.echo.empty() ? POLLIN : POLLOUT), 0 };
+      }
+      if (::poll(fds.data(), fds.size(), 5000) <= 0)
+        throw std::runtime_error("The relay stopped moving data");
+
+      for (std::size_t i = 0; i < _connections.size(); ++i) {
+        Connection &connection = _connections[i];
+        if (fds[2 * i].revents & POLLOUT) {
+          ssize_t written = send(connection.client, chunk.data(), std::min(chunk.size(), size - connection.sent),
+                                 MSG_NOSIGNAL);
+          if (written > 0)
+            connection.sent += written;
+        }
+        if (fds[2 * i].revents & POLLIN) {
+          ssize_t count = recv(connection.client, chunk.data(), chunk.size(), 0);
+          if (count == 0)
+            throw std::runtime_error("A tunnel was closed");
+          if (count > 0) {
+            connection.received += count;
+            if (connection.received == size)
+              ++finished;
+          }
+        }
+
+        if (fds[2 * i + 1].revents & POLLIN) {
+          connection.echo.resize(chunk.size());
+          ssize_t count = recv(connection.remote, connection.echo.data(), connection.echo.size(), 0);
+          if (count == 0)
+            throw std::runtime_error("A channel was closed");
+          connection.echo.resize(count > 0 ? count : 0);
+          connection.echoStart = 0;
+        }
+        if (fds[2 * i + 1].revents & POLLOUT) {
+          ssize_t written = send(connection.remote, connection.echo.data() + connection.echoStart,
+                                 connection.echo.size() - connection.echoStart, MSG_NOSIGNAL);
+          if (written > 0)
+            connection.echoStart += written;
+          if (connection.echoStart == connection.echo.size())
+            connection.echo.clear();
+        }
+      }
+    }
+  }
+
+private:
+  ssh::TunnelRelay _relay;
+  std::vector<Connection> _connections;
+  std::thread _thread;
+  std::atomic<bool> _stopped { false };
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Relays payloadSize bytes in total from the clients to the remote ends and back. Items are bytes, so the
+// reported throughput is bytes per second.
+void relay(State &state, std::size_t channels) {
+  Loopback loopback(channels);
+  loopback.start();
+  state.measure([&]() {
+    loopback.echo(payloadSize / channels);
+  });
+  loopback.stop();
+  state.setItems(2 * (payloadSize / channels) * channels);
+}
+
+Registration relay1("ssh/relay-1-channel", [](State &state) {
+  relay(state, 1);
+});
+
+Registration relay64("ssh/relay-64-channels", [](State &state) {
+  relay(state, 64);
+});
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// The processor time the relay uses in idleMilliseconds while its tunnels have no traffic. That should be none.
+void idle(State &state, std::size_t channels) {
+  Loopback loopback(channels);
+  loopback.start();
+  loopback.echo(1); // Everything is set up and was used once.
+  state.measureCpuTime([&]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(idleMilliseconds));
+  });
+  loopback.stop();
+}
+
+Registration idle1("ssh/relay-idle-1-channel", [](State &state) {
+  idle(state, 1);
+});
+
+Registration idle64("ssh/relay-idle-64-channels", [](State &state) {
+  idle(state, 64);
+});
+
+} // namespace
@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <fstream>
+
+#include "base/file_utilities.h"
+#include "base/string_utilities.h"
+#include "sqlide/sql_history_store.h"
+
+#include "casmine.h"
+
+using namespace casmine;
+
+namespace {
+
+$ModuleEnvironment() {};
+
+$TestData {
+  std::string storePath;
+  std::string historyDir;
+
+  // Fills the store with a million statements, spread over 200 days, alternating between two schemas and connections.
+  void fillStore(SqlHistoryStore &store) {
+    static const char *tables[] = { "customers", "orders", "products", "invoices", "payments" };
+    unsigned int value = 1;
+    auto next = [&]() {
+      value = value * 1103515245 + 12345;
+      return (value >> 8) % 100000;
+    };
+
+    for (int day = 0; day < 200; ++day) {
+      std::list<std::string> statements;
+      for (int i = 0; i < 5000; ++i)
+        statements.push_back(base::strfmt("SELECT * FROM %s WHERE id = %u", tables[next() % 5], next()));
+      store.add_entries(base::strfmt("2018-%02d-%02d", 1 + day / 28, 1 + day % 28), "12:00:00", statements,
+                        day % 2 ? "sakila" : "world", day % 3 ? "local" : "remote");
+    }
+  }
+};
+
+$describe("SQL history store") {
+  $beforeEach([this]() {
+    data->storePath = CasmineContext::get()->tmpDataDir() + "/sql_history_specs.db";
+    data->historyDir = CasmineContext::get()->tmpDataDir() + "/sql_history_specs";
+    base::tryRemove(data->storePath);
+    base::remove_recursive(data->historyDir);
+  });
+
+  $it("Searches a history of a million entries by keyword, schema and connection", [this]() {
+    SqlHistoryStore store(data->storePath);
+    data->fillStore(store);
+    store.add_entries("2019-01-01", "13:00:00", { "SELECT needle_column FROM haystack" }, "sakila", "remote");
+    store.add_entries("2019-01-02", "14:00:00", { "select Needle_Column from other_table" }, "world", "local");
+
+    auto entries = store.search("needle", "", "");
+    $expect(entries).toHaveSize(2);
+    $expect(entries[0].statement).toBe("select Needle_Column from other_table");
+    $expect(entries[0].day).toBe("2019-01-02");
+    $expect(entries[1].statement).toBe("SELECT needle_column FROM haystack");
+
+    // Keywords match word prefixes, case insensitive, and all of them must be found.
+    $expect(store.search("NEEDLE_col hay", "", "")).toHaveSize(1);
+    $expect(store.search("needle missing", "", "")).toHaveSize(0);
+
+    entries = store.search("needle", "sakila", "remote");
+    $expect(entries).toHaveSize(1);
+    $expect(entries[0].schema).toBe("sakila");
+    $expect(entries[0].connection).toBe("remote");
+    $expect(store.search("needle", "world", "remote")).toHaveSize(0);
+
+    // Paging through the results of a frequent keyword returns the newest entries first, without overlaps.
+    auto first = store.search("invoices", "world", "", 0, 50);
+    auto second = store.search("invoices", "world", "", 50, 50);
+    $expect(first).toHaveSize(50);
+    $expect(second).toHaveSize(50);
+    $expect(first.back().id > second.front().id).toBeTrue();
+    $expect(first.front().day).toBe("2018-08-03");
+
+    $expect(store.search("", "sakila", "local", 0, 10)).toHaveSize(10);
+    $expect(store.days()).toHaveSize(202);
+    $expect(store.days().front()).toBe("2019-01-02");
+  });
+
+  $it("Loads the entries of a day page by page", [this]() {
+    SqlHistoryStore store(data->storePath);
+    std::list<std::string> statements;
+    for (int i = 0; i < 250; ++i)
+      statements.push_back(base::strfmt("SELECT %d", i));
+    store.add_entries("2019-01-02", "10:00:00", statements, "", "");
+    store.add_entries("2019-01-01", "09:00:00", { "SELECT 'yesterday'" }, "", "");
+
+    $expect(store.count("2019-01-02")).toBe(250U);
+    $expect(store.days()).toEqual({ "2019-01-02", "2019-01-01" });
+
+    auto page = store.entries("2019-01-02", 0, 100);
+    $expect(page).toHaveSize(100);
+    $expect(page.front().statement).toBe("SELECT 249");
+    page = store.entries("2019-01-02", 200, 100);
+    $expect(page).toHaveSize(50);
+    $expect(page.back().statement).toBe("SELECT 0");
+    $expect(store.entries("2019-01-02")).toHaveSize(250);
+  });
+
+  $it("Removes deleted days from the full text index", [this]() {
+    SqlHistoryStore store(data->storePath);
+    store.add_entries("2019-01-01", "09:00:00", { "SELECT * FROM actor", "SELECT * FROM film" }, "", "");
+    store.add_entries("2019-01-02", "10:00:00", { "SELECT * FROM actor" }, "", "");
+
+    store.delete_day("2019-01-01");
+    $expect(store.search("actor", "", "")).toHaveSize(1);
+    $expect(store.search("film", "", "")).toHaveSize(0);
+
+    store.delete_all();
+    $expect(store.days()).toHaveSize(0);
+    $expect(store.search("select", "", "")).toHaveSize(0);
+  });
+
+  $it("Imports the XML history files of older versions once", [this]() {
+    base::create_directory(data->historyDir, 0700, true);
+    {
+      std::ofstream file(data->historyDir + "/2017-05-06");
+      file << "<?xml version=\"1.0\" encoding=\"UTF-8\" ?>\n";
+      file << "<ENTRY timestamp='10:00:01'>select 1 &lt; 2</ENTRY>\n";
+      file << "<ENTRY timestamp='~'>select &apos;old&apos;&#x0A;from dual</ENTRY>\n";
+      file << "<ENTRY timestamp='10:00:05'>~</ENTRY>\n";
+    }
+    {
+      std::ofstream file(data->historyDir + "/notes.txt");
+      file << "not a history file";
+    }
+
+    SqlHistoryStore store(data->storePath);
+    $expect(store.import_directory(data->historyDir)).toBe(3U);
+    $expect(store.import_directory(data->historyDir)).toBe(0U);
+
+    auto entries = store.entries("2017-05-06");
+    $expect(entries).toHaveSize(3);
+    $expect(entries[0].time).toBe("10:00:05");
+    $expect(entries[0].statement).toBe("select 'old'\nfrom dual");
+    $expect(entries[1].time).toBe("10:00:01");
+    $expect(entries[2].statement).toBe("select 1 < 2");
+    $expect(store.search("old dual", "", "")).toHaveSize(2);
+  });
+}
+
+}
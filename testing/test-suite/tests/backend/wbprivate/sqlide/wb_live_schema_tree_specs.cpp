@@ -4120,6 +4120,24 @@ $describe("Live Schema Tree") {
     data->treeTestHelperFiltered.filter_data();
     data->verifyFilterResult("TF034CHK006", data->pModelViewFiltered->root_node(), schemas, tables, views, procedures, functions);
 
+    // Extending the filter narrows the current result...
+    tables.clear();
+    procedures.clear();
+    functions.clear();
+    data->treeTestHelperFiltered.set_filter("?asic_*.*s*_v");
+    data->treeTestHelperFiltered.filter_data();
+    data->verifyFilterResult("TF034CHK007", data->pModelViewFiltered->root_node(), schemas, tables, views, procedures, functions);
+
+    // ... while a shorter one brings the removed objects back.
+    tables.push_back("customer");
+    tables.push_back("store");
+    procedures.push_back("get_debths");
+    procedures.push_back("get_payments");
+    functions.push_back("calc_debth_list");
+    data->treeTestHelperFiltered.set_filter("?asic_*.*s");
+    data->treeTestHelperFiltered.filter_data();
+    data->verifyFilterResult("TF034CHK008", data->pModelViewFiltered->root_node(), schemas, tables, views, procedures, functions);
+
     data->pModelView->root_node()->remove_children();
     root_node_f->remove_children();
   });
@@ -101,6 +101,96 @@ $describe("Tests for WB model file") {
     $expect(*d2->name()).toBe("t2");
   });
 
+  $it("Binary document is only used when in sync with the XML document", [this]() {
+    ModelFile mf(data->outputDir);
+    workbench_DocumentRef doc(grt::Initialized);
+
+    mf.create();
+    doc->name("binary");
+
+    workbench_physical_ModelRef pmodel(grt::Initialized);
+    pmodel->owner(doc);
+    db_Catalog catalog;
+    pmodel->catalog(&catalog);
+    doc->physicalModels().insert(pmodel);
+
+    mf.store_document(doc);
+    $expect(mf.has_file(MAIN_DOCUMENT_BINARY_NAME)).toBeTrue();
+    mf.save_to(data->outputDir + "/binary.mwb");
+
+    ModelFile mf1(data->outputDir);
+    mf1.open(data->outputDir + "/binary.mwb");
+    $expect(mf1.has_file(MAIN_DOCUMENT_BINARY_NAME)).toBeTrue();
+    $expect(*mf1.retrieve_document()->name()).toBe("binary");
+    mf1.cleanup();
+
+    // Simulate a save by a version that only writes the XML document.
+    doc->name("xml only");
+    grt::GRT::get()->serialize(doc, mf.get_path_for(MAIN_DOCUMENT_NAME), "MySQL Workbench Model", "1.4.4");
+    mf.save_to(data->outputDir + "/binary.mwb");
+
+    ModelFile mf2(data->outputDir);
+    mf2.open(data->outputDir + "/binary.mwb");
+    $expect(*mf2.retrieve_document()->name()).toBe("xml only");
+  });
+
+  $it("Lazily opened model files extract entries on demand", [this]() {
+    ModelFile mf(data->outputDir);
+    mf.open(data->tmpDataDir + "/workbench/sakila.mwb", true);
+
+    // Nothing but the lock file should have been extracted yet.
+    $expect(base::file_exists(mf.get_tempdir_path() + "/" + MAIN_DOCUMENT_NAME)).toBeFalse();
+    $expect(mf.has_file(MAIN_DOCUMENT_NAME)).toBeTrue();
+
+    workbench_DocumentRef doc(mf.retrieve_document());
+    $expect(doc.is_valid()).toBeTrue();
+    $expect(base::file_exists(mf.get_tempdir_path() + "/" + MAIN_DOCUMENT_NAME)).toBeFalse();
+
+    // Asking for a path must produce the file.
+    $expect(base::file_exists(mf.get_db_file_path())).toBeTrue();
+
+    // Saving has to write the complete archive, including entries never touched.
+    mf.save_to(data->outputDir + "/lazy.mwb");
+    mf.cleanup();
+
+    ModelFile mf2(data->outputDir);
+    mf2.open(data->outputDir + "/lazy.mwb");
+    $expect(base::file_exists(mf2.get_tempdir_path() + "/" + MAIN_DOCUMENT_NAME)).toBeTrue();
+    $expect(*mf2.retrieve_document()->name()).toBe(*doc->name());
+    mf2.cleanup();
+  });
+
+  $it("Saving over the opened file updates the archive in place", [this]() {
+    std::string path = data->outputDir + "/inplace.mwb";
+    ModelFile::copy_file(data->tmpDataDir + "/workbench/sakila.mwb", path);
+
+    ModelFile mf(data->outputDir);
+    mf.open(path, true);
+    workbench_DocumentRef doc(mf.retrieve_document());
+    doc->name("in place");
+    mf.store_document(doc);
+    $expect(mf.save_to(path, "model-schemas: sakila")).toBeTrue();
+    $expect(base::file_exists(path + ".bak")).toBeTrue();
+
+    // The data file was never needed, so it must still not be extracted.
+    $expect(base::file_exists(mf.get_tempdir_path() + "/" + mf.get_rel_db_file_path())).toBeFalse();
+    $expect(mf.has_file(mf.get_rel_db_file_path())).toBeTrue();
+
+    // Saving again after the update must still find the entries that weren't extracted.
+    doc->name("in place again");
+    mf.store_document(doc);
+    $expect(mf.save_to(path)).toBeTrue();
+    mf.cleanup();
+
+    $expect(ModelFile::read_comment(path + ".bak")).toBe("sakila");
+
+    ModelFile mf2(data->outputDir);
+    mf2.open(path);
+    $expect(*mf2.retrieve_document()->name()).toBe("in place again");
+    $expect(base::file_exists(mf2.get_db_file_path())).toBeTrue();
+    mf2.cleanup();
+  });
+
   $it("Open file locking test", [this]() {
     $pending("test needs rework as accessing a locked model file no longer throws an exception");
     ModelFile mf(data->outputDir);
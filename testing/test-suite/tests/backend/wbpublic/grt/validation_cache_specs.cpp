@@ -0,0 +1,477 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "base/string_utilities.h"
+#include "grt/validation_manager.h"
+#include "grts/structs.db.mysql.h"
+
+#include "casmine.h"
+#include "wb_test_helpers.h"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+
+namespace {
+
+$ModuleEnvironment() {};
+
+static const grt::Validator::Tag testTag = "incremental-test";
+
+// Columns need a name of at most 64 characters.
+class ColumnValidator : public grt::Validator {
+public:
+  virtual int validate(const Tag &tag, const grt::ObjectRef &object) {
+    if (tag != testTag)
+      return 0;
+
+    std::string name = db_ColumnRef::cast_from(object)->name();
+    if (name.empty()) {
+      bec::ValidationManager::message(tag, object, "Column without name", grt::ErrorMsg);
+      return 1;
+    }
+    if (name.size() > 64)
+      bec::ValidationManager::message(tag, object, "Column name too long: " + name, grt::WarningMsg);
+    return 0;
+  }
+};
+
+// Tables need unique column names, they should have columns and a primary key.
+class TableValidator : public grt::Validator {
+public:
+  virtual int validate(const Tag &tag, const grt::ObjectRef &object) {
+    if (tag != testTag)
+      return 0;
+
+    db_TableRef table(db_TableRef::cast_from(object));
+    int result = 0;
+    std::set<std::string> names;
+    for (size_t i = 0; i < table->columns().count(); ++i) {
+      std::string name = table->columns()[i]->name();
+      if (!name.empty() && !names.insert(name).second) {
+        bec::ValidationManager::message(tag, object, "Duplicate column " + name + " in " + *table->name(),
+                                        grt::ErrorMsg);
+        result = 1;
+      }
+    }
+    if (table->columns().count() == 0)
+      bec::ValidationManager::message(tag, object, "No columns in " + *table->name(), grt::WarningMsg);
+    if (!table->primaryKey().is_valid())
+      bec::ValidationManager::message(tag, object, "No primary key in " + *table->name(), grt::WarningMsg);
+    return result;
+  }
+};
+
+// Foreign keys must refer to existing columns of an existing table, which should have a primary key.
+class ForeignKeyValidator : public grt::Validator {
+public:
+  virtual int validate(const Tag &tag, const grt::ObjectRef &object) {
+    if (tag != testTag)
+      return 0;
+
+    db_ForeignKeyRef fk(db_ForeignKeyRef::cast_from(object));
+    db_TableRef table(fk->referencedTable());
+    if (!table.is_valid()) {
+      bec::ValidationManager::message(tag, object, "No referenced table for " + *fk->name(), grt::ErrorMsg);
+      return 1;
+    }
+
+    db_SchemaRef schema(db_SchemaRef::cast_from(table->owner()));
+    if (!schema.is_valid() || schema->tables().get_index(table) == grt::BaseListRef::npos) {
+      bec::ValidationManager::message(tag, object, *fk->name() + " refers to dropped table " + *table->name(),
+                                      grt::ErrorMsg);
+      return 1;
+    }
+
+    int result = 0;
+    if (fk->columns().count() != fk->referencedColumns().count()) {
+      bec::ValidationManager::message(tag, object, "Column count mismatch in " + *fk->name(), grt::ErrorMsg);
+      result = 1;
+    }
+    for (size_t i = 0; i < fk->referencedColumns().count(); ++i) {
+      db_ColumnRef column(fk->referencedColumns()[i]);
+      if (table->columns().get_index(column) == grt::BaseListRef::npos) {
+        bec::ValidationManager::message(tag, object,
+                                        *fk->name() + " refers to column " + *column->name() + " not in " +
+                                          *table->name(),
+                                        grt::ErrorMsg);
+        result = 1;
+      }
+    }
+    if (!table->primaryKey().is_valid())
+      bec::ValidationManager::message(tag, object, *fk->name() + " refers to " + *table->name() +
+                                        " which has no primary key", grt::WarningMsg);
+    return result;
+  }
+};
+
+static const grt::Validator::Tag countTag = "counting-test";
+
+// Counts how often tables are validated, can change them while doing so.
+class CountingValidator : public grt::Validator {
+public:
+  std::atomic<size_t> calls;
+  std::function<void(const db_TableRef &)> during;
+
+  CountingValidator() : calls(0) {
+  }
+
+  virtual int validate(const Tag &tag, const grt::ObjectRef &object) {
+    if (tag != countTag)
+      return 0;
+
+    ++calls;
+    if (during)
+      during(db_TableRef::cast_from(object));
+    return 0;
+  }
+};
+
+static CountingValidator countingValidator;
+
+// Everything a validation came up with, in an order which does not depend on how it was done.
+static std::vector<std::string> outcome(bec::ValidationCache &cache, bool valid) {
+  std::vector<std::string> result;
+  result.push_back(valid ? "valid" : "invalid");
+  for (auto &message : cache.messages(testTag))
+    result.push_back(message.object->id() + " " + std::to_string(message.level) + " " + message.text);
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+class Random {
+public:
+  Random(unsigned int seed) : _value(seed) {
+  }
+
+  size_t next(size_t limit) {
+    _value = _value * 1103515245 + 12345;
+    return limit == 0 ? 0 : (_value >> 8) % limit;
+  }
+
+private:
+  unsigned int _value;
+};
+
+$TestData {
+  std::unique_ptr<WorkbenchTester> tester;
+  size_t counter = 0;
+
+  db_mysql_ColumnRef addColumn(const db_TableRef &table) {
+    db_mysql_ColumnRef column(grt::Initialized);
+    column->owner(table);
+    column->name("column" + std::to_string(counter++));
+    table->columns().insert(column);
+    return column;
+  }
+
+  db_mysql_TableRef addTable(const db_SchemaRef &schema, size_t columnCount) {
+    db_mysql_TableRef table(grt::Initialized);
+    table->owner(schema);
+    table->name("table" + std::to_string(counter++));
+    for (size_t i = 0; i < columnCount; ++i)
+      addColumn(table);
+
+    db_mysql_IndexRef index(grt::Initialized);
+    index->owner(table);
+    index->name("PRIMARY");
+    index->isPrimary(1);
+    if (columnCount > 0) {
+      db_mysql_IndexColumnRef indexColumn(grt::Initialized);
+      indexColumn->owner(index);
+      indexColumn->referencedColumn(table->columns()[0]);
+      index->columns().insert(indexColumn);
+    }
+    table->indices().insert(index);
+    table->primaryKey(index);
+
+    schema->tables().insert(table);
+    return table;
+  }
+
+  db_mysql_ForeignKeyRef addForeignKey(const db_TableRef &table, const db_TableRef &referenced) {
+    db_mysql_ForeignKeyRef fk(grt::Initialized);
+    fk->owner(table);
+    fk->name("fk" + std::to_string(counter++));
+    fk->referencedTable(db_mysql_TableRef::cast_from(referenced));
+    if (table->columns().count() > 0 && referenced->columns().count() > 0) {
+      fk->columns().insert(table->columns()[0]);
+      fk->referencedColumns().insert(referenced->columns()[0]);
+    }
+    table->foreignKeys().insert(fk);
+    return fk;
+  }
+
+  db_mysql_CatalogRef createCatalog(size_t schemaCount, size_t tableCount) {
+    db_mysql_CatalogRef catalog(grt::Initialized);
+    for (size_t s = 0; s < schemaCount; ++s) {
+      db_mysql_SchemaRef schema(grt::Initialized);
+      schema->owner(catalog);
+      schema->name("schema" + std::to_string(s));
+      catalog->schemata().insert(schema);
+
+      for (size_t t = 0; t < tableCount; ++t) {
+        db_TableRef table = addTable(schema, 1 + t % 5);
+        if (t > 0)
+          addForeignKey(table, schema->tables()[t / 2]);
+      }
+    }
+    return catalog;
+  }
+};
+
+$describe("Incremental validation") {
+  $beforeAll([this]() {
+    data->tester.reset(new WorkbenchTester());
+    data->tester->initializeRuntime();
+
+    static ColumnValidator columnValidator;
+    static TableValidator tableValidator;
+    static ForeignKeyValidator foreignKeyValidator;
+    bec::ValidationManager::register_validator("db.Column", &columnValidator);
+    bec::ValidationManager::register_validator("db.Table", &tableValidator);
+    bec::ValidationManager::register_validator("db.ForeignKey", &foreignKeyValidator);
+    bec::ValidationManager::register_validator("db.Table", &countingValidator);
+  });
+
+  $afterAll([this]() {
+    data->tester.reset();
+    WorkbenchTester::reinitGRT();
+  });
+
+  $it("Only changed objects and their dependents are validated again", [this]() {
+    db_mysql_CatalogRef catalog = data->createCatalog(2, 10);
+    bec::ValidationCache cache(catalog);
+    $expect(cache.pending_count(testTag)).toEqual(cache.object_count());
+    $expect(cache.validate(testTag)).toBeTrue();
+    $expect(cache.pending_count(testTag)).toEqual(0U);
+
+    // A column rename touches the column, its table, schema and catalog and the foreign keys referring to
+    // the table (with their tables).
+    db_TableRef table = catalog->schemata()[0]->tables()[2];
+    table->columns()[0]->name("");
+    $expect(cache.pending_count(testTag)).toBeGreaterThan(3U);
+    $expect(cache.pending_count(testTag)).toBeLessThan(cache.object_count() / 4);
+    $expect(cache.validate(testTag)).toBeFalse();
+    $expect(cache.messages(testTag).size()).toBeGreaterThan(0U);
+
+    table->columns()[0]->name("id");
+    $expect(cache.validate(testTag)).toBeTrue();
+
+    // Dropping a table makes the foreign keys referring to it fail.
+    catalog->schemata()[1]->tables().remove(1);
+    $expect(cache.validate(testTag)).toBeFalse();
+    bec::ValidationCache full(catalog);
+    $expect(outcome(cache, false)).toEqual(outcome(full, full.validate(testTag, 1)));
+  });
+
+  $it("Results after random changes match a full validation", [this]() {
+    db_mysql_CatalogRef catalog = data->createCatalog(3, 12);
+    bec::ValidationCache cache(catalog);
+    cache.validate(testTag);
+
+    Random random(4711);
+    auto anySchema = [&]() -> db_SchemaRef { return catalog->schemata()[random.next(catalog->schemata().count())]; };
+    auto anyTable = [&]() -> db_TableRef {
+      db_SchemaRef schema = anySchema();
+      if (schema->tables().count() == 0)
+        return data->addTable(schema, 2);
+      return schema->tables()[random.next(schema->tables().count())];
+    };
+
+    for (size_t step = 0; step < 400; ++step) {
+      db_TableRef table = anyTable();
+      switch (random.next(11)) {
+        case 0: // Rename a column, sometimes to the name of another one or to nothing.
+          if (table->columns().count() > 0) {
+            db_ColumnRef column = table->columns()[random.next(table->columns().count())];
+            size_t kind = random.next(4);
+            if (kind == 0)
+              column->name("");
+            else if (kind == 1)
+              column->name(table->columns()[0]->name());
+            else if (kind == 2)
+              column->name(std::string(70, 'c'));
+            else
+              column->name("renamed" + std::to_string(step));
+          }
+          break;
+
+        case 1:
+          data->addColumn(table);
+          break;
+
+        case 2:
+          if (table->columns().count() > 0)
+            table->columns().remove(random.next(table->columns().count()));
+          break;
+
+        case 3:
+          table->name("table_renamed" + std::to_string(step));
+          break;
+
+        case 4:
+          data->addTable(anySchema(), random.next(4));
+          break;
+
+        case 5: {
+          db_SchemaRef schema = db_SchemaRef::cast_from(table->owner());
+          schema->tables().remove_value(table);
+          break;
+        }
+
+        case 6:
+          data->addForeignKey(table, anyTable());
+          break;
+
+        case 7:
+          if (table->foreignKeys().count() > 0)
+            table->foreignKeys()[random.next(table->foreignKeys().count())]->referencedTable(anyTable());
+          break;
+
+        case 8:
+          if (table->foreignKeys().count() > 0)
+            table->foreignKeys().remove(random.next(table->foreignKeys().count()));
+          break;
+
+        case 9:
+          if (table->primaryKey().is_valid())
+            table->primaryKey(db_IndexRef());
+          else if (table->indices().count() > 0)
+            table->primaryKey(table->indices()[0]);
+          break;
+
+        default: { // Move a table to another schema.
+          db_SchemaRef::cast_from(table->owner())->tables().remove_value(table);
+          db_SchemaRef schema = anySchema();
+          table->owner(schema);
+          schema->tables().insert(table);
+          break;
+        }
+      }
+
+      if (step % 3 != 0)
+        continue;
+
+      bool valid = cache.validate(testTag, step % 2 == 0 ? 1 : 4);
+      bec::ValidationCache full(catalog);
+      $expect(outcome(cache, valid))
+        .toEqual(outcome(full, full.validate(testTag, 1)), "after step " + std::to_string(step));
+    }
+  });
+
+  $it("The default validators check names, foreign keys, columns and types", [this]() {
+    bec::ValidationManager::register_default_validators();
+    bec::ValidationManager::register_default_validators(); // Adds nothing the second time.
+
+    db_mysql_CatalogRef catalog = data->createCatalog(1, 4);
+    db_SchemaRef schema = catalog->schemata()[0];
+    bec::ValidationCache cache(catalog);
+    $expect(cache.validate(CHECK_NAME)).toBeTrue();
+    $expect(cache.messages(CHECK_NAME).size()).toEqual(0U);
+    $expect(cache.validate("chk_fk_lgc")).toBeTrue();
+
+    // Duplicate names are reported by the owner of the objects.
+    db_TableRef table = schema->tables()[1];
+    table->columns()[1]->name(base::toupper(table->columns()[0]->name()));
+    schema->tables()[2]->name(schema->tables()[3]->name());
+    $expect(cache.validate(CHECK_NAME)).toBeFalse();
+    std::vector<bec::ValidationCache::Message> messages = cache.messages(CHECK_NAME);
+    $expect(messages.size()).toEqual(2U);
+    $expect(messages[0].object->id()).toEqual(schema->id());
+    $expect(messages[1].object->id()).toEqual(table->id());
+
+    // The foreign key of the second table refers to the only column of the first one.
+    schema->tables()[0]->columns().remove(0);
+    $expect(cache.validate("chk_fk_lgc")).toBeFalse();
+    messages = cache.messages("chk_fk_lgc");
+    $expect(messages.size()).toEqual(1U);
+    $expect(messages[0].object->id()).toEqual(table->foreignKeys()[0]->id());
+
+    $expect(cache.validate("columns-count")).toBeTrue();
+    messages = cache.messages("columns-count");
+    $expect(messages.size()).toEqual(1U);
+    $expect(messages[0].level).toEqual((int)grt::WarningMsg);
+
+    // None of the columns has a type.
+    size_t columnCount = 0;
+    for (size_t i = 0; i < schema->tables().count(); ++i)
+      columnCount += schema->tables()[i]->columns().count();
+    $expect(cache.validate(CHECK_SYNTAX)).toBeFalse();
+    $expect(cache.messages(CHECK_SYNTAX).size()).toEqual(columnCount);
+    $expect(cache.validate("All")).toBeFalse();
+  });
+
+  $it("validate_instance uses the cache of the object's tree", [this]() {
+    db_mysql_CatalogRef catalog = data->createCatalog(1, 3);
+    db_TableRef table = catalog->schemata()[0]->tables()[1];
+    countingValidator.calls = 0;
+
+    // Without a cache every call validates.
+    $expect(bec::ValidationManager::validate_instance(table, countTag)).toBeTrue();
+    $expect(bec::ValidationManager::validate_instance(table, countTag)).toBeTrue();
+    $expect(countingValidator.calls.load()).toEqual(2U);
+
+    bec::ValidationManager::cache_for(catalog);
+    $expect(bec::ValidationManager::validate_instance(table, countTag)).toBeTrue();
+    $expect(bec::ValidationManager::validate_instance(table, countTag)).toBeTrue();
+    $expect(countingValidator.calls.load()).toEqual(3U);
+
+    table->name("renamed");
+    $expect(bec::ValidationManager::validate_instance(table, countTag)).toBeTrue();
+    $expect(countingValidator.calls.load()).toEqual(4U);
+
+    // Tables not in the catalog are not cached.
+    db_TableRef other = data->addTable(db_mysql_SchemaRef(grt::Initialized), 1);
+    bec::ValidationManager::validate_instance(other, countTag);
+    bec::ValidationManager::validate_instance(other, countTag);
+    $expect(countingValidator.calls.load()).toEqual(6U);
+
+    bec::ValidationManager::clear();
+    bec::ValidationManager::validate_instance(table, countTag);
+    $expect(countingValidator.calls.load()).toEqual(7U);
+  });
+
+  $it("Results of objects changed while validating are not kept", [this]() {
+    db_mysql_CatalogRef catalog = data->createCatalog(1, 3);
+    db_TableRef changed = catalog->schemata()[0]->tables()[1];
+    bec::ValidationCache cache(catalog);
+
+    // The change signals come while the validators run, as they would from another thread.
+    countingValidator.during = [&](const db_TableRef &table) {
+      if (table == changed && *table->name() != "changed")
+        table->name("changed");
+    };
+    cache.validate(countTag, 1);
+    countingValidator.during = nullptr;
+
+    // The table, its schema and the catalog, plus the table with a foreign key referring to it.
+    $expect(cache.pending_count(countTag)).toBeGreaterThanOrEqual(4U);
+    countingValidator.calls = 0;
+    cache.validate(countTag, 1);
+    $expect(cache.pending_count(countTag)).toEqual(0U);
+    $expect(countingValidator.calls.load()).toEqual(2U);
+  });
+}
+
+}
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "sqlide/recordset_row_cursor.h"
+#include "sqlide/recordset_text_storage.h"
+#include "mtemplate/template.h"
+#include "base/file_utilities.h"
+#include "base/string_utilities.h"
+
+#include "casmine.h"
+
+using namespace casmine;
+
+namespace {
+
+$ModuleEnvironment() {};
+
+$TestData {
+  std::string templateDir = CasmineContext::get()->baseDir() + "/../../res/sqlidedata/templates";
+
+  std::vector<std::string> names = { "id", "name", "note" };
+  std::vector<std::string> types = { "Number", "String", "String" };
+  Recordset_row_cursor::Parameters parameters = {
+    { "TABLE_NAME", "people" }, { "GENERATE_DATE", "2019-01-01" }, { "DATE_ONLY", "2019-01-01" }
+  };
+  std::string rowSeparator = ",";
+
+  // Null values are already replaced by the null syntax of the format, like the export does.
+  std::vector<std::vector<std::string>> rows = {
+    { "1", "a,b", "NULL" }, { "2", "<tab\there>", "say \"hi\"" }, { "NULL", "", "it's; &" }
+  };
+  std::vector<std::vector<bool>> nulls = { { false, false, true }, { false, false, false }, { true, false, false } };
+
+  // What the export did before the row template was compiled: a dictionary tree per row, holding the parameters,
+  // a ROW with its ROW_SEPARATOR and a FIELD per column.
+  std::string expandDictionaries(mtemplate::Template &tpl, const std::vector<std::string> *fieldTypes) {
+    mtemplate::TemplateOutputString output;
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+      std::unique_ptr<mtemplate::Dictionary> base(mtemplate::CreateMainDictionary());
+      mtemplate::DictionaryInterface *row = base->addSectionDictionary("ROW");
+      for (auto &parameter : parameters)
+        base->setValue(parameter.first, parameter.second);
+
+      for (std::size_t column = 0; column < names.size(); ++column) {
+        mtemplate::DictionaryInterface *field = row->addSectionDictionary("FIELD");
+        if (nulls[i][column])
+          field->addSectionDictionary("FIELD_is_null");
+        else
+          field->addSectionDictionary("FIELD_is_not_null");
+        if (fieldTypes != nullptr)
+          field->setValue("FIELD_TYPE", (*fieldTypes)[column]);
+        field->setValue("FIELD_NAME", names[column]);
+        field->setValue("FIELD_VALUE", rows[i][column]);
+      }
+
+      row->setValue("ROW_SEPARATOR", i + 1 < rows.size() ? rowSeparator : "");
+      tpl.expand(base.get(), &output);
+    }
+    return output.get();
+  }
+
+  std::string expandCursor(mtemplate::Template &tpl, const std::vector<std::string> *fieldTypes) {
+    mtemplate::CompiledTemplate compiled(tpl);
+    Recordset_row_cursor cursor(compiled, parameters, names, fieldTypes, rowSeparator);
+    mtemplate::TemplateWriter writer;
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+      cursor.values = rows[i];
+      cursor.nulls = nulls[i];
+      cursor.last = i + 1 == rows.size();
+      compiled.expand(&cursor, writer);
+    }
+    return writer.buffer();
+  }
+};
+
+$describe("Recordset row cursor") {
+  $beforeAll([this]() {
+    // Registers the x-csv_quote modifier of the export.
+    Recordset_text_storage::create();
+    mtemplate::SetGlobalValue("INDENT", "\t");
+  });
+
+  $it("Expands the shipped row templates like a dictionary per row", [this]() {
+    std::list<std::string> files = base::scan_for_files_matching(data->templateDir + "/*.tpl");
+    std::size_t count = 0;
+    for (auto &file : files) {
+      if (base::hasSuffix(file, ".pre.tpl") || base::hasSuffix(file, ".post.tpl"))
+        continue;
+
+      ++count;
+      std::unique_ptr<mtemplate::Template> tpl(mtemplate::GetTemplate(file));
+      $expect(tpl.get()).Not.toBeNull(file);
+      $expect(data->expandCursor(*tpl, nullptr)).toEqual(data->expandDictionaries(*tpl, nullptr), file);
+      $expect(data->expandCursor(*tpl, &data->types)).toEqual(data->expandDictionaries(*tpl, &data->types),
+                                                             file + " with types");
+    }
+    $expect(count).toBeGreaterThanOrEqual(9U);
+  });
+
+  $it("Marks null fields, separates rows and looks up other names like the dictionaries", [this]() {
+    mtemplate::SetGlobalValue("GLOBAL_ONLY", "global");
+    mtemplate::Template tpl(mtemplate::parseTemplate(
+      "{{#ROW}}[{{TABLE_NAME}}|{{GLOBAL_ONLY}}|{{MISSING}}{{INDENT}}{{#FIELD}}{{FIELD_NAME}}="
+      "{{#FIELD_is_null}}null {{FIELD_VALUE}}{{/FIELD_is_null}}"
+      "{{#FIELD_is_not_null}}{{FIELD_VALUE:x-csv_quote=comma}}{{/FIELD_is_not_null}}"
+      ":{{FIELD_TYPE}}/{{DATE_ONLY}}{{#FIELD_separator}};{{/FIELD_separator}}{{/FIELD}}]"
+      "{{#ROW_separator}}never{{/ROW_separator}}{{ROW_SEPARATOR}}\n{{/ROW}}{{FIELD_NAME}}{{ROW_SEPARATOR}}.",
+      mtemplate::DO_NOT_STRIP));
+
+    std::string expected = data->expandDictionaries(tpl, nullptr);
+    $expect(data->expandCursor(tpl, nullptr)).toEqual(expected);
+    $expect(expected).toEqual(
+      "[people|global|\tid=1:/2019-01-01;name=\"a,b\":/2019-01-01;note=null NULL:/2019-01-01],\n."
+      "[people|global|\tid=2:/2019-01-01;name=\"<tab\there>\":/2019-01-01;note=\"say \"\"hi\"\"\":/2019-01-01],\n."
+      "[people|global|\tid=null NULL:/2019-01-01;name=:/2019-01-01;note=\"it's; &\":/2019-01-01]\n.");
+    $expect(data->expandCursor(tpl, &data->types)).toEqual(data->expandDictionaries(tpl, &data->types));
+
+    // Without column types FIELD_TYPE comes from the parameters, if there is one.
+    data->parameters["FIELD_TYPE"] = "parameter";
+    $expect(data->expandCursor(tpl, nullptr)).toEqual(data->expandDictionaries(tpl, nullptr));
+    data->parameters.erase("FIELD_TYPE");
+
+    // A single row is the last one.
+    data->rows.resize(1);
+    data->nulls.resize(1);
+    $expect(data->expandCursor(tpl, nullptr)).toEqual(data->expandDictionaries(tpl, nullptr));
+  });
+}
+
+}
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+
+#include "sqlide/recordset_text_writer.h"
+#include "sqlide/recordset_text_storage.h"
+#include "mtemplate/template.h"
+#include "base/config_file.h"
+
+#include "casmine.h"
+
+#include <fstream>
+#include <sstream>
+
+using namespace casmine;
+
+namespace {
+
+$ModuleEnvironment() {};
+
+$TestData {
+  std::string outputDir = CasmineContext::get()->outputDir();
+  std::string templateDir = CasmineContext::get()->baseDir() + "/../../res/sqlidedata/templates";
+
+  std::vector<std::string> names = { "id", "name", "note" };
+  Recordset_text_writer::Variables variables = {
+    { "TABLE_NAME", "people" }, { "GENERATOR_QUERY", "SELECT * FROM people" }, { "GENERATE_DATE", "2019-01-01" }
+  };
+
+  // Writes two rows with the given (already quoted) values, the last field of the first row being NULL.
+  std::string write(const std::string &format, const std::vector<std::string> &first,
+                    const std::vector<std::string> &second) {
+    std::string path = outputDir + "/text_writer." + format;
+
+    {
+      Recordset_text_writer::Ref writer = Recordset_text_writer::create(format, path, names, variables);
+      writer->write_header();
+      writer->write_row(first, { false, false, true }, false);
+      writer->write_row(second, { false, false, false }, true);
+      writer->write_footer();
+      writer->flush();
+    }
+
+    std::ifstream stream(path.c_str(), std::ifstream::binary);
+    std::stringstream content;
+    content << stream.rdbuf();
+    return content.str();
+  }
+
+  // The same rows expanded with the bundled templates of the format, the way the export did it before: the header
+  // and footer from one dictionary with the columns, each row from a dictionary of its own.
+  std::string expand(const std::string &format, const std::vector<std::string> &first,
+                     const std::vector<std::string> &second) {
+    base::ConfigurationFile info(base::AutoCreateNothing);
+    $expect(info.load(templateDir + "/" + format + ".tpli")).toBeTrue(format);
+    std::string rowSeparator = info.get_value("row_separator");
+
+    std::unique_ptr<mtemplate::Dictionary> dictionary(mtemplate::CreateMainDictionary());
+    for (auto &variable : variables)
+      dictionary->setValue(variable.first, variable.second);
+    for (auto &name : names)
+      dictionary->addSectionDictionary("COLUMN")->setValue("COLUMN_NAME", name);
+
+    mtemplate::TemplateOutputString output;
+    std::unique_ptr<mtemplate::Template> pre(mtemplate::GetTemplate(templateDir + "/" + format + ".pre.tpl"));
+    if (pre)
+      pre->expand(dictionary.get(), &output);
+
+    std::unique_ptr<mtemplate::Template> body(mtemplate::GetTemplate(templateDir + "/" + format + ".tpl"));
+    $expect(body.get()).Not.toBeNull(format);
+    std::vector<std::vector<std::string>> rows = { first, second };
+    std::vector<std::vector<bool>> nulls = { { false, false, true }, { false, false, false } };
+    for (std::size_t i = 0; i < rows.size(); ++i) {
+      std::unique_ptr<mtemplate::Dictionary> base(mtemplate::CreateMainDictionary());
+      for (auto &variable : variables)
+        base->setValue(variable.first, variable.second);
+
+      mtemplate::DictionaryInterface *row = base->addSectionDictionary("ROW");
+      for (std::size_t column = 0; column < names.size(); ++column) {
+        mtemplate::DictionaryInterface *field = row->addSectionDictionary("FIELD");
+        field->addSectionDictionary(nulls[i][column] ? "FIELD_is_null" : "FIELD_is_not_null");
+        field->setValue("FIELD_NAME", names[column]);
+        field->setValue("FIELD_VALUE", rows[i][column]);
+      }
+      row->setValue("ROW_SEPARATOR", i + 1 < rows.size() ? rowSeparator : "");
+      body->expand(base.get(), &output);
+    }
+
+    std::unique_ptr<mtemplate::Template> post(mtemplate::GetTemplate(templateDir + "/" + format + ".post.tpl"));
+    if (post)
+      post->expand(dictionary.get(), &output);
+
+    return output.get();
+  }
+
+  void check(const std::string &format, const std::vector<std::string> &first, const std::vector<std::string> &second) {
+    std::string expected = expand(format, first, second);
+    $expect(expected.empty()).toBeFalse(format);
+    $expect(write(format, first, second)).toEqual(expected, format);
+  }
+};
+
+$describe("Recordset text writer") {
+  $beforeAll([this]() {
+    // Registers the x-csv_quote modifier the CSV templates use.
+    Recordset_text_storage::create();
+    mtemplate::SetGlobalValue("INDENT", "\t");
+  });
+
+  $it("Writes CSV and tab separated files with the template quoting rules", [this]() {
+    data->check("CSV", { "1", "a,b", "NULL" }, { "2", "tab\there", "say \"hi\"" });
+    data->check("CSV", { "1", "semi;colon", "NULL" }, { "2", "line\nbreak", "" });
+    data->check("CSV_semicolon", { "1", "a,b", "NULL" }, { "2", "a;b", "x" });
+    data->check("CSV_semicolon", { "1", "with space", "NULL" }, { "2", "\"quoted\"", "" });
+    data->check("tab", { "1", "a,b", "NULL" }, { "2", "tab\there", "say \"hi\"" });
+  });
+
+  $it("Writes JSON", [this]() {
+    data->check("JSON", { "1", "\"a,b\"", "null" }, { "2", "\"tab\\there\"", "\"x\"" });
+  });
+
+  $it("Writes XML", [this]() {
+    data->check("XML_mysql", { "1", "a", "NULL" }, { "2", "b", "x" });
+    data->check("XML", { "1", "a", "NULL" }, { "2", "b", "x" });
+  });
+
+  $it("Writes HTML", [this]() {
+    data->check("HTML", { "1", "a <b>", "NULL" }, { "2", "c & d", "x" });
+  });
+
+  $it("Writes SQL INSERT statements", [this]() {
+    data->check("SQL_inserts", { "1", "'a,b'", "NULL" }, { "2", "'it\\'s'", "'x'" });
+  });
+
+  $it("Leaves other formats to their templates", [this]() {
+    $expect(Recordset_text_writer::create("XLS", data->outputDir + "/text_writer.xls", {}, {}).get()).toBeNull();
+  });
+}
+
+}
@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include "grtsqlparser/sql_facade.h"
+#include "sqlide/sql_inserts_scanner.h"
+#include "sqlide/recordset_sql_storage.h"
+#include "sqlide/recordset_be.h"
+
+#include "casmine.h"
+#include "wb_test_helpers.h"
+
+namespace {
+
+$ModuleEnvironment() {};
+
+$TestData {
+  std::unique_ptr<WorkbenchTester> tester;
+};
+
+// One line per reported row: schema, table, field names and values (NULL for null fields).
+static std::vector<std::string> loadRows(Sql_inserts_loader::Ref loader, const std::string &sql) {
+  std::vector<std::string> rows;
+  loader->process_insert_cb([&](const std::string &, const std::pair<std::string, std::string> &schema_table,
+                                const Sql_inserts_loader::Strings &fields_names,
+                                const Sql_inserts_loader::Strings &fields_values, const std::vector<bool> &null_fields) {
+    std::string row = schema_table.first + "." + schema_table.second + " (";
+    for (const auto &name : fields_names)
+      row += "[" + name + "]";
+    row += ") = (";
+    for (size_t i = 0; i < fields_values.size(); ++i)
+      row += null_fields[i] ? std::string("NULL") : "[" + fields_values[i] + "]";
+    rows.push_back(row + ")");
+  });
+  loader->load(sql, "db");
+  return rows;
+}
+
+// INSERT forms the parser based loader supports, as written by Workbench and by hand.
+static const char *corpus[] = {
+  "INSERT INTO `table` (`id`, `name`, `ts`, `pic`, `bitcol`) VALUES (1, 'test', '2012-01-01', NULL, 1);\n",
+  "INSERT INTO `db`.`table` (`id`, `name`) VALUES (DEFAULT, 'a'), (2, 'b'), (3, NULL);\n",
+  "insert into t (a, b) values (1, 2),(3,4) , (5, 6);\n",
+  "INSERT LOW_PRIORITY IGNORE INTO other.t (a) VALUE (1);\n",
+  "INSERT t (a, b) VALUES ('it''s', 'it\\'s');\n",
+  "INSERT INTO t (a, b) VALUES (\"double\", 'with \"quotes\"');\n",
+  "INSERT INTO `we``ird` (`co``l`, `x y`) VALUES (1, '');\n",
+  "INSERT INTO t (a, b, c) VALUES (null, \\N, 'NULL');\n",
+  "INSERT INTO t (a, b, c) VALUES (-1, 1.5, .5);\n",
+  "INSERT INTO t (a, b) VALUES (now(), concat('a,', (1 + 2), ')'));\n",
+  "INSERT INTO t (a, b) VALUES (x'ff', 0x1F);\n",
+  "INSERT INTO t (a, b) VALUES ('\\\\func x', '\\func y');\n",
+  "INSERT INTO t (a, b) VALUES (1 + 1, a);\n",
+  "INSERT INTO t (a) VALUES (1) ON DUPLICATE KEY UPDATE a = a + 1;\n",
+  "INSERT INTO t (t.a, db.t.b) VALUES (1, 2);\n",
+  "INSERT INTO t VALUES (1, 2);\n",
+  "/* comment */ INSERT INTO t (a, b) -- comment\n VALUES (1, /* inline */ 2); # comment\n",
+  "INSERT INTO t (a,\n  b)\nVALUES\n  (1,\n  'multi\nline');\n",
+  "CREATE TABLE t (a int);\nUPDATE t SET a = 1;\nINSERT INTO t (a) VALUES (1);\n",
+};
+
+$describe("Inserts script scanner") {
+  $beforeAll([this]() {
+    data->tester.reset(new WorkbenchTester());
+    data->tester->initializeRuntime();
+  });
+
+  $it("Reports the same rows as the parser based loader", [this]() {
+    SqlFacade::Ref facade = SqlFacade::instance_for_rdbms_name("Mysql");
+
+    std::string script;
+    for (const char *sql : corpus) {
+      $expect(loadRows(Sql_inserts_scanner::create(""), sql)).toEqual(loadRows(facade->sqlInsertsLoader(), sql), sql);
+      script += sql;
+    }
+
+    // Also as a single script, together with a long multi row statement.
+    script += "INSERT INTO `table` (`id`, `name`, `note`) VALUES ";
+    for (size_t i = 0; i < 1000; ++i) {
+      script += i > 0 ? ",\n" : "\n";
+      script += "(" + std::to_string(i) + ", 'name " + std::to_string(i) + "', ";
+      script += i % 3 == 0 ? "NULL)" : "'" + std::to_string(i * 7) + "')";
+    }
+    script += ";\n";
+
+    std::vector<std::string> rows = loadRows(Sql_inserts_scanner::create(""), script);
+    $expect(rows.size()).toBeGreaterThan(1000U);
+    $expect(rows).toEqual(loadRows(facade->sqlInsertsLoader(), script));
+  });
+
+  $it("Reads quotes as the sql mode says", []() {
+    std::string sql = "INSERT INTO \"t\" (\"a\", b) VALUES ('x\\', \"y\");";
+    $expect(loadRows(Sql_inserts_scanner::create("ANSI_QUOTES,NO_BACKSLASH_ESCAPES"), sql))
+      .toEqual(std::vector<std::string>({ "db.t ([a][b]) = ([x\\][y])" }));
+  });
+
+  $it("Handles delimiters, version comments and malformed statements", []() {
+    std::string sql =
+      "/*!40000 INSERT INTO t (a) VALUES (1),(2) */;\n"
+      "INSERT INTO t (a) VALUES (3), (4,);\n"
+      "DELIMITER $$\n"
+      "INSERT INTO t (a) VALUES (';')$$\n"
+      "DELIMITER ;\n"
+      "INSERT INTO t (a) VALUES (5);\n";
+    $expect(loadRows(Sql_inserts_scanner::create(""), sql))
+      .toEqual(std::vector<std::string>({ "db.t ([a]) = ([1])", "db.t ([a]) = ([2])", "db.t ([a]) = ([3])",
+                                          "db.t ([a]) = ([;])", "db.t ([a]) = ([5])" }));
+  });
+
+  $it("Loads a table's inserts into a recordset", []() {
+    std::string script = "INSERT INTO `db`.`people` (`name`, `id`) VALUES ('a', 1), ('b', 2);\n"
+                         "INSERT INTO `people` (`id`, `note`) VALUES (3, 'c');\n"
+                         "INSERT INTO `other` (`id`) VALUES (4);\n";
+    for (size_t i = 5; i <= 5000; ++i)
+      script += "INSERT INTO `people` (`id`, `name`, `note`) VALUES (" + std::to_string(i) + ", 'n', NULL);\n";
+
+    Recordset_sql_storage::Ref storage = Recordset_sql_storage::create();
+    storage->sql_script(script);
+    storage->schema_name("db");
+    storage->table_name("people");
+    storage->affective_columns({ "id", "name", "note" });
+
+    Recordset::Ref rs = Recordset::create();
+    rs->data_storage(storage);
+    rs->reset();
+
+    $expect(rs->real_row_count()).toEqual(4999U);
+    $expect(rs->get_column_count()).toEqual(3U);
+
+    std::string value;
+    rs->get_field(bec::NodeId(0), 0, value);
+    $expect(value).toEqual("1");
+    rs->get_field(bec::NodeId(0), 1, value);
+    $expect(value).toEqual("a");
+    $expect(rs->is_field_null(bec::NodeId(0), 2)).toBeTrue();
+
+    rs->get_field(bec::NodeId(2), 0, value);
+    $expect(value).toEqual("3");
+    $expect(rs->is_field_null(bec::NodeId(2), 1)).toBeTrue();
+    rs->get_field(bec::NodeId(2), 2, value);
+    $expect(value).toEqual("c");
+
+    rs->get_field(bec::NodeId(4998), 0, value);
+    $expect(value).toEqual("5000");
+  });
+}
+
+}
@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "base/threaded_timer.h"
+
+#include "casmine.h"
+
+namespace {
+
+$ModuleEnvironment() {};
+
+$TestData {
+  // The scheduler's clock. Tests move it forward by hand, so nothing depends on real time.
+  double time = 0;
+
+  // Takes out and runs all due tasks, in the order the scheduler hands them out. Each run takes the given time.
+  std::vector<int> runDue(TimerScheduler &scheduler, double runTime = 0) {
+    std::vector<int> result;
+    while (TimerTask *task = scheduler.take_due()) {
+      double start = time;
+      result.push_back(task->task_id);
+      bool stop = task->callback(task->task_id);
+      time += runTime;
+      scheduler.finished(task, start, stop);
+    }
+    return result;
+  }
+};
+
+$describe("Threaded timer scheduler") {
+  $beforeEach([this]() {
+    data->time = 0;
+  });
+
+  $it("Hands out tasks when they are due, in deadline order", [this]() {
+    TimerScheduler scheduler([this]() { return data->time; });
+    auto keepRunning = [](int) { return false; };
+
+    int slow = scheduler.add(1.0, false, keepRunning);
+    int fast = scheduler.add(0.25, false, keepRunning);
+    int once = scheduler.add(0.5, true, keepRunning);
+    $expect(scheduler.next_time()).toBe(0.25);
+
+    data->time = 0.2;
+    $expect(data->runDue(scheduler)).toHaveSize(0);
+
+    data->time = 0.5;
+    $expect(data->runDue(scheduler)).toEqual({ fast, once });
+    $expect(scheduler.next_time()).toBe(0.75);
+    $expect(scheduler.find(once) == nullptr).toBeTrue();
+
+    data->time = 1.0;
+    $expect(data->runDue(scheduler)).toEqual({ fast, slow });
+    $expect(scheduler.next_time()).toBe(1.25);
+    $expect(scheduler.count()).toBe(2U);
+  });
+
+  $it("Removes tasks whose callback asks to stop", [this]() {
+    TimerScheduler scheduler([this]() { return data->time; });
+    int runs = 0;
+    int task = scheduler.add(0.25, false, [&](int) { return ++runs == 3; });
+
+    for (int i = 1; i <= 5; ++i) {
+      data->time = i * 0.25;
+      data->runDue(scheduler);
+    }
+    $expect(runs).toBe(3);
+    $expect(scheduler.find(task) == nullptr).toBeTrue();
+    $expect(scheduler.next_time()).toBe(-1.0);
+  });
+
+  $it("Skips the runs a slow task missed and records run time statistics", [this]() {
+    TimerScheduler scheduler([this]() { return data->time; });
+    int task = scheduler.add(1.0, false, [](int) { return false; });
+
+    // Started half a second late and runs for 2.5 seconds, so the runs due at 2 and 3 are skipped.
+    data->time = 1.5;
+    data->runDue(scheduler, 2.5);
+    $expect(data->time).toBe(4.0);
+    $expect(scheduler.next_time()).toBe(5.0);
+
+    data->time = 5.0;
+    data->runDue(scheduler, 0.5);
+
+    TimerTaskStatistics statistics;
+    $expect(scheduler.statistics(task, statistics)).toBeTrue();
+    $expect(statistics.runs).toBe(2U);
+    $expect(statistics.total_run_time).toBe(3.0);
+    $expect(statistics.max_run_time).toBe(2.5);
+    $expect(statistics.max_delay).toBe(0.5);
+  });
+
+  $it("Cancels waiting tasks right away and running tasks after they finish", [this]() {
+    TimerScheduler scheduler([this]() { return data->time; });
+    auto keepRunning = [](int) { return false; };
+
+    int waiting = scheduler.add(2.0, false, keepRunning);
+    int running = scheduler.add(1.0, false, keepRunning);
+    $expect(scheduler.cancel(waiting)).toBeTrue();
+    $expect(scheduler.find(waiting) == nullptr).toBeTrue();
+
+    data->time = 1.0;
+    TimerTask *task = scheduler.take_due();
+    $expect(task->task_id).toBe(running);
+    $expect(scheduler.cancel(running)).toBeFalse();
+    $expect(scheduler.find(running) != nullptr).toBeTrue();
+
+    scheduler.finished(task, 1.0, false);
+    $expect(scheduler.find(running) == nullptr).toBeTrue();
+    $expect(scheduler.count()).toBe(0U);
+    $expect(scheduler.cancel(running)).toBeTrue();
+  });
+
+  $it("Keeps the deadline order when many tasks are added and cancelled", [this]() {
+    TimerScheduler scheduler([this]() { return data->time; });
+    unsigned int value = 1;
+    auto next = [&]() {
+      value = value * 1103515245 + 12345;
+      return (value >> 8) % 10000;
+    };
+
+    std::vector<int> tasks;
+    for (int i = 0; i < 2000; ++i)
+      tasks.push_back(scheduler.add(0.001 * (1 + next()), true, [](int) { return false; }));
+    for (size_t i = 0; i < tasks.size(); i += 2)
+      $expect(scheduler.cancel(tasks[i])).toBeTrue();
+    $expect(scheduler.count()).toBe(1000U);
+
+    data->time = 100;
+    double last = 0;
+    bool ordered = true;
+    size_t count = 0;
+    while (TimerTask *task = scheduler.take_due()) {
+      ordered = ordered && task->next_time >= last && task->task_id % 2 == 0;
+      last = task->next_time;
+      scheduler.finished(task, data->time, false);
+      ++count;
+    }
+    $expect(ordered).toBeTrue();
+    $expect(count).toBe(1000U);
+    $expect(scheduler.count()).toBe(0U);
+  });
+}
+
+}
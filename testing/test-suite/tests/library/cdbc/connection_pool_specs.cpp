@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+
+#include "cdbc/src/connection_pool.h"
+
+#include "casmine.h"
+
+#include <atomic>
+#include <thread>
+
+namespace {
+
+$ModuleEnvironment() {};
+
+// Stands in for a driver connection, so the pool can be tested without a server.
+struct FakeConnection {
+  int id;
+  bool alive = true;
+  bool inTransaction = false;
+  bool resettable = true;
+
+  FakeConnection(int id) : id(id) {
+  }
+};
+
+typedef sql::BasicConnectionPool<FakeConnection> FakePool;
+
+$TestData {
+  std::atomic<int> opened;
+
+  FakePool::ConnectFunction connect = [this]() { return std::make_shared<FakeConnection>(++opened); };
+
+  std::unique_ptr<FakePool> createPool(size_t maxConnections, std::chrono::milliseconds idleTimeout,
+                                       std::chrono::milliseconds waitTimeout) {
+    FakePool::Options options;
+    options.maxConnections = maxConnections;
+    options.idleTimeout = idleTimeout;
+    options.waitTimeout = waitTimeout;
+    return std::unique_ptr<FakePool>(new FakePool(options, [](FakeConnection &connection) { return connection.alive; },
+                                                  [](FakeConnection &connection) {
+                                                    connection.inTransaction = false;
+                                                    return connection.resettable;
+                                                  }));
+  }
+};
+
+$describe("Connection pool") {
+  $beforeEach([this]() {
+    data->opened = 0;
+  });
+
+  $it("Reuses returned connections and resets their session state", [this]() {
+    auto pool = data->createPool(4, std::chrono::minutes(1), std::chrono::seconds(1));
+
+    FakePool::Handle first = pool->acquire(data->connect);
+    first->inTransaction = true;
+    $expect(pool->statistics().inUse).toBe(1U);
+    first.reset();
+    $expect(pool->statistics().idle).toBe(1U);
+
+    FakePool::Handle second = pool->acquire(data->connect);
+    $expect(second->id).toBe(1);
+    $expect(second->inTransaction).toBeFalse();
+
+    FakePool::Statistics statistics = pool->statistics();
+    $expect(statistics.created).toBe(1U);
+    $expect(statistics.reused).toBe(1U);
+  });
+
+  $it("Discards connections that fail the health check or the reset", [this]() {
+    auto pool = data->createPool(4, std::chrono::minutes(1), std::chrono::seconds(1));
+
+    FakePool::Handle connection = pool->acquire(data->connect);
+    FakeConnection *raw = connection.get();
+    connection.reset();
+    raw->alive = false;
+
+    connection = pool->acquire(data->connect);
+    $expect(connection->id).toBe(2);
+
+    connection->resettable = false;
+    connection.reset();
+    $expect(pool->statistics().idle).toBe(0U);
+    $expect(pool->statistics().discarded).toBe(2U);
+  });
+
+  $it("Evicts connections that stay idle too long", [this]() {
+    auto pool = data->createPool(4, std::chrono::milliseconds(20), std::chrono::seconds(1));
+
+    pool->acquire(data->connect).reset();
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    pool->evictExpired();
+
+    FakePool::Statistics statistics = pool->statistics();
+    $expect(statistics.evicted).toBe(1U);
+    $expect(statistics.idle).toBe(0U);
+    $expect(pool->acquire(data->connect)->id).toBe(2);
+  });
+
+  $it("Makes checkouts wait when all connections are in use", [this]() {
+    auto pool = data->createPool(2, std::chrono::minutes(1), std::chrono::seconds(5));
+
+    FakePool::Handle first = pool->acquire(data->connect);
+    FakePool::Handle second = pool->acquire(data->connect);
+
+    std::atomic<int> waitingFor(0);
+    std::thread waiter([&]() { waitingFor = pool->acquire(data->connect)->id; });
+    while (pool->statistics().waits == 0)
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    $expect(waitingFor.load()).toBe(0);
+
+    second.reset();
+    waiter.join();
+    $expect(waitingFor.load()).toBe(2);
+    $expect(pool->statistics().created).toBe(2U);
+  });
+
+  $it("Gives up waiting after the wait timeout", [this]() {
+    auto pool = data->createPool(1, std::chrono::minutes(1), std::chrono::milliseconds(30));
+
+    FakePool::Handle connection = pool->acquire(data->connect);
+    $expect([&]() { pool->acquire(data->connect); }).toThrow();
+  });
+
+  $it("Never opens more connections than allowed under concurrent use", [this]() {
+    auto pool = data->createPool(3, std::chrono::minutes(1), std::chrono::seconds(30));
+
+    std::atomic<int> active(0);
+    std::atomic<int> maxActive(0);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 8; ++i) {
+      threads.push_back(std::thread([&]() {
+        for (int j = 0; j < 50; ++j) {
+          FakePool::Handle connection = pool->acquire(data->connect);
+          int current = ++active;
+          int previous = maxActive;
+          while (current > previous && !maxActive.compare_exchange_weak(previous, current))
+            ;
+          std::this_thread::yield();
+          --active;
+        }
+      }));
+    }
+    for (auto &thread : threads)
+      thread.join();
+
+    $expect(maxActive.load() <= 3).toBeTrue();
+    $expect(data->opened.load() <= 3).toBeTrue();
+    $expect(pool->statistics().idle).toBe((size_t)data->opened.load());
+  });
+}
+
+}
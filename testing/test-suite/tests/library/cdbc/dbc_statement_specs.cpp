@@ -374,6 +374,55 @@ $describe("DBC: statement tests") {
       throw;
     }
   });
+
+  $it("Batch execution in multi-statement packets reports the failing statement", [this]() {
+    auto connection = data->connection();
+    std::unique_ptr<sql::Statement> stmt(connection->createStatement());
+
+    std::list<std::string> statements = {
+      "DROP DATABASE IF EXISTS dbc_statement_test_16",
+      "CREATE DATABASE dbc_statement_test_16;",
+      "CREATE TABLE dbc_statement_test_16.t1 (id int) -- comment",
+      "SELECT 1",
+      "INSERT INTO dbc_statement_test_16.t1 VALUES (1), (2)",
+      "INSERT INTO dbc_statement_test_16.no_such_table VALUES (1)",
+      "INSERT INTO dbc_statement_test_16.t1 VALUES (3)",
+      "DROP DATABASE dbc_statement_test_16"
+    };
+
+    std::vector<std::string> failed;
+    int progressCalls = 0;
+    sql::SqlBatchExec batchExec;
+    batchExec.batch_size(64);
+    batchExec.sql_log_limit(2);
+    batchExec.error_cb([&](long long, const std::string &, const std::string &statement) {
+      failed.push_back(statement);
+      return 0;
+    });
+    batchExec.batch_exec_progress_cb([&](float) {
+      ++progressCalls;
+      return 0;
+    });
+
+    // Stops at the first error, after the statements before it were run.
+    $expect(batchExec(stmt.get(), statements)).toBe(1);
+    $expect(failed.size()).toBe(1U);
+    $expect(failed[0]).toBe("INSERT INTO dbc_statement_test_16.no_such_table VALUES (1)");
+    $expect(progressCalls).toBe(6);
+    $expect(batchExec.sql_log().size()).toBe(2U);
+    $expect(batchExec.sql_log().back()).toBe(failed[0]);
+
+    std::unique_ptr<sql::ResultSet> rs(stmt->executeQuery("SELECT COUNT(*) FROM dbc_statement_test_16.t1"));
+    $expect(rs->next()).toBeTrue();
+    $expect(rs->getInt(1)).toBe(2);
+
+    // Goes on after the error otherwise.
+    failed.clear();
+    batchExec.stop_on_error(false);
+    $expect(batchExec(stmt.get(), statements)).toBe(1);
+    $expect(failed.size()).toBe(1U);
+    $expect(batchExec.sql_log().back()).toBe("DROP DATABASE dbc_statement_test_16");
+  });
 }
 
 }
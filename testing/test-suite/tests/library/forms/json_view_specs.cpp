@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA 
+ */
+
+#include "mforms/jsonview.h"
+#include "stub/stub_mforms.h"
+
+#include "casmine.h"
+
+using namespace mforms;
+
+namespace {
+
+$ModuleEnvironment() {};
+
+// Gives access to the tree of the view.
+class TestJsonTreeView : public JsonTreeView {
+public:
+  TestJsonTreeView(rapidjson::Document &doc) : JsonTreeView(doc) {
+  }
+
+  TreeNodeRef rootNode() {
+    return _treeView->root_node();
+  }
+
+  TreeNodeRef topNode() {
+    return rootNode()->get_child(0);
+  }
+
+  void expand(TreeNodeRef node) {
+    node->expand();
+    _treeView->expand_toggle(node, true);
+  }
+};
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Lists key and type of all rows below the given node, indented by level.
+std::string dumpRows(TreeNodeRef node, const std::string &indent = "") {
+  std::string result;
+  for (int i = 0; i < node->count(); ++i) {
+    TreeNodeRef child = node->get_child(i);
+    result += indent + child->get_string(0) + " | " + child->get_string(2) + "\n";
+    result += dumpRows(child, indent + "  ");
+  }
+  return result;
+}
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// An array of 5000 objects, one of them with a value that occurs nowhere else.
+std::string bigDocument() {
+  std::string json = "[";
+  for (int i = 0; i < 5000; ++i) {
+    if (i > 0)
+      json += ", ";
+    json += "{\"id\": " + std::to_string(i) + ", \"name\": \"" + (i == 4321 ? "needle" : "item") + "\"}";
+  }
+  return json + "]";
+}
+
+$describe("mforms JSON tree view") {
+
+  $beforeAll([]() {
+    mforms::stub::init(nullptr);
+  });
+
+  $it("Small documents show the same rows as before", []() {
+    rapidjson::Document document;
+    document.Parse("{\"name\": \"test\", \"count\": 3, \"tags\": [\"a\", 1.5, null], "
+                   "\"nested\": {\"flag\": true, \"list\": [{\"id\": 1}, [2]]}}");
+
+    TestJsonTreeView view(document);
+    view.setJson(document);
+
+    // This is what the view showed when it still created all rows at once. Everything is created and expanded.
+    std::string expected =
+      "<unnamed> | Object\n"
+      "  name | String\n"
+      "  count | Long Integer\n"
+      "  tags[3] | Array\n"
+      "    tags[3][0] | String\n"
+      "    tags[3][1] | Double\n"
+      "    null | Null\n"
+      "  nested{2} | Object\n"
+      "    flag | Boolean\n"
+      "    list[2] | Array\n"
+      "      list[2][0] | Object\n"
+      "        id | Long Integer\n"
+      "      list[2][1] | Array\n"
+      "        key[0] | Long Integer\n";
+    $expect(dumpRows(view.rootNode())).toBe(expected);
+    $expect(view.topNode()->get_child(3)->is_expanded()).toBeTrue();
+    $expect(view.topNode()->get_child(3)->get_child(1)->is_expanded()).toBeTrue();
+  });
+
+  $it("Rows of big documents are created on demand", []() {
+    rapidjson::Document document;
+    document.Parse(bigDocument());
+
+    TestJsonTreeView view(document);
+    view.setJson(document);
+
+    // 5000 items are split into 5 ranges. Only the first range got its rows, the other ones have a placeholder.
+    TreeNodeRef top = view.topNode();
+    $expect(top->count()).toBe(5);
+    $expect(top->get_child(0)->get_string(0)).toBe("[0..999]");
+    $expect(top->get_child(4)->get_string(0)).toBe("[4000..4999]");
+    $expect(top->get_child(0)->count()).toBe(1000);
+    $expect(top->get_child(1)->count()).toBe(1);
+    $expect(top->get_child(0)->get_child(0)->is_expanded()).toBeFalse();
+
+    TreeNodeRef range = top->get_child(1);
+    view.expand(range);
+    $expect(range->count()).toBe(1000);
+    $expect(range->get_child(0)->get_string(0)).toBe("key[1000]");
+
+    TreeNodeRef item = range->get_child(0);
+    view.expand(item);
+    $expect(dumpRows(item)).toBe("id | Long Integer\nname | String\n");
+
+    // Expanding again must not add the rows twice.
+    view.expand(item);
+    $expect(item->count()).toBe(2);
+  });
+
+  $it("Search and filter work on the document", []() {
+    rapidjson::Document document;
+    document.Parse(bigDocument());
+
+    TestJsonTreeView view(document);
+    view.setJson(document);
+
+    // Searching runs in the background, the match is shown when it's done. Highlighting a match creates the rows
+    // on the way to it.
+    view.highlightMatchNode("needle");
+    view.waitForSearch();
+    TreeNodeRef range = view.topNode()->get_child(4);
+    $expect(range->is_expanded()).toBeTrue();
+    $expect(range->count()).toBe(1000);
+
+    TreeNodeRef item = range->get_child(321);
+    $expect(item->get_string(0)).toBe("key[4321]");
+    $expect(item->is_expanded()).toBeTrue();
+    $expect(item->get_child(1)->get_string(1)).toBe("needle");
+
+    $expect(view.filterView("no such value", document)).toBeFalse();
+    view.waitForSearch();
+    $expect(view.topNode()->count()).toBe(5);
+
+    // The filter keeps only matches and their parents. Other members of a matching object stay visible.
+    $expect(view.filterView("needle", document)).toBeFalse();
+    view.waitForSearch();
+    $expect(view.filterView("needle", document)).toBeTrue();
+    view.waitForSearch();
+    $expect(view.rootNode()->count()).toBe(1);
+    $expect(view.topNode()->count()).toBe(1);
+    $expect(view.topNode()->get_child(0)->get_string(0)).toBe("key[4321]");
+    $expect(view.topNode()->get_child(0)->count()).toBe(2);
+
+    view.reCreateTree(document);
+    $expect(view.topNode()->count()).toBe(5);
+  });
+}
+
+}
@@ -62,6 +62,7 @@ namespace mforms {
       }
 
       static void clear(TreeView *self) {
+        self->root_node()->remove_children();
       }
 
       static TreeSelectionMode get_selection_mode(TreeView *self) {
@@ -127,6 +127,12 @@ $TestData {
       diffsqlModule->makeSQLSyncScript(mod_cat, options, alter_map, alter_object_list);
       std::string export_sql_script = options.get_string("OutputScript");
 
+      // The streamed script must be the same as the one put together from the statement list.
+      std::string streamed_script;
+      diffsqlModule->generateSQLSyncScript(mod_cat, mod_cat, options, alter_change,
+                                           [&](const std::string &text) { streamed_script.append(text); });
+      $expect(streamed_script).toBe(export_sql_script, entry.description);
+
       // 2. apply it to server
       std::unique_ptr<sql::Statement> stmt(connection->createStatement());
 
@@ -30,6 +30,8 @@
 #include "wb_test_helpers.h"
 #include "casmine.h"
 
+#include "base/file_functions.h"
+
 using namespace grt;
 using namespace casmine;
 
@@ -49,6 +51,70 @@ $TestData {
     ValueRef res_val(GRT::get()->unserialize(filename));
     deepCompareGrtValues("serialization test", res_val, val, true);
   }
+
+  void runBinarySerialization(const ValueRef& val) {
+    static const std::string filename(outputDir + "/serialization_test.grtb");
+    GRT::get()->serialize_binary(val, filename, "test", "1.0");
+
+    std::string doctype, version;
+    ValueRef res_val(GRT::get()->unserialize_binary(filename, doctype, version));
+    $expect(doctype).toBe("test");
+    $expect(version).toBe("1.0");
+    deepCompareGrtValues("binary serialization test", res_val, val, true);
+  }
+
+  // Creates a catalog with tables linked by foreign keys, as a stand-in for a large model.
+  db_mysql_CatalogRef createLargeCatalog(size_t schemaCount, size_t tableCount, size_t columnCount) {
+    db_mysql_CatalogRef catalog(grt::Initialized);
+    for (size_t s = 0; s < schemaCount; ++s) {
+      db_mysql_SchemaRef schema(grt::Initialized);
+      schema->owner(catalog);
+      schema->name("schema" + std::to_string(s));
+      catalog->schemata().insert(schema);
+
+      db_mysql_TableRef previous;
+      for (size_t t = 0; t < tableCount; ++t) {
+        db_mysql_TableRef table(grt::Initialized);
+        table->owner(schema);
+        table->name("table" + std::to_string(t));
+        table->comment("Table number " + std::to_string(t) + " of schema " + *schema->name());
+        schema->tables().insert(table);
+
+        for (size_t c = 0; c < columnCount; ++c) {
+          db_mysql_ColumnRef column(grt::Initialized);
+          column->owner(table);
+          column->name("column" + std::to_string(c));
+          column->length(c == 0 ? -1 : 45);
+          column->defaultValue(c == 0 ? "0" : "NULL");
+          column->isNotNull(c == 0 ? 1 : 0);
+          table->columns().insert(column);
+        }
+
+        db_mysql_IndexRef index(grt::Initialized);
+        index->owner(table);
+        index->name("PRIMARY");
+        index->isPrimary(1);
+        db_mysql_IndexColumnRef indexColumn(grt::Initialized);
+        indexColumn->owner(index);
+        indexColumn->referencedColumn(table->columns()[0]);
+        index->columns().insert(indexColumn);
+        table->indices().insert(index);
+        table->primaryKey(index);
+
+        if (previous.is_valid()) {
+          db_mysql_ForeignKeyRef fk(grt::Initialized);
+          fk->owner(table);
+          fk->name("fk_" + *table->name());
+          fk->referencedTable(previous);
+          fk->columns().insert(table->columns()[1]);
+          fk->referencedColumns().insert(previous->columns()[0]);
+          table->foreignKeys().insert(fk);
+        }
+        previous = table;
+      }
+    }
+    return catalog;
+  }
 };
 
 $describe("GRT: serialization") {
@@ -113,6 +179,7 @@ $describe("GRT: serialization") {
     extras.set("extra_obj", author);
 
     data->runSerialization(obj);
+    data->runBinarySerialization(obj);
   });
 
   $it("Serialization of a hierarchy", [this]() {
@@ -134,6 +201,7 @@ $describe("GRT: serialization") {
     list.insert(book2);
 
     data->runSerialization(list);
+    data->runBinarySerialization(list);
   });
 
   $it("Catalog serialization", [this]() {
@@ -160,6 +228,116 @@ $describe("GRT: serialization") {
     $expect(list[2].is_valid()).toBeTrue();
   });
 
+  $it("Binary serialization of simple values and lists with NULL values", [this]() {
+    data->runBinarySerialization(StringRef("<tag1>%string_value/</tag1>"));
+    data->runBinarySerialization(StringRef(std::string(1000, 'x')));
+    data->runBinarySerialization(IntegerRef(-1));
+    data->runBinarySerialization(IntegerRef((ssize_t)0x7fffffffffffLL));
+    data->runBinarySerialization(DoubleRef(1.12345678901234));
+
+    grt::ListRef<db_Table> list(true);
+    list.insert(db_TableRef(grt::Initialized));
+    list.insert(db_TableRef());
+    list.insert(db_TableRef(grt::Initialized));
+
+    std::string doctype, version;
+    grt::GRT::get()->serialize_binary(list, data->outputDir + "/null_list.grtb");
+    list = grt::ListRef<db_Table>::cast_from(
+      grt::GRT::get()->unserialize_binary(data->outputDir + "/null_list.grtb", doctype, version));
+
+    $expect(list[0].is_valid()).toBeTrue();
+    $expect(list[1].is_valid()).toBeFalse();
+    $expect(list[2].is_valid()).toBeTrue();
+  });
+
+  $it("Binary serialization keeps the source tag and rejects other data", [this]() {
+    std::string filename = data->outputDir + "/tagged.grtb";
+    grt::GRT::get()->serialize_binary(IntegerRef(1), filename, "doc", "1.2.3", "tag");
+
+    std::string doctype, version, tag;
+    $expect(grt::GRT::get()->get_binary_metainfo(filename, doctype, version, tag)).toBeTrue();
+    $expect(doctype).toBe("doc");
+    $expect(version).toBe("1.2.3");
+    $expect(tag).toBe("tag");
+
+    std::string xmlFilename = data->outputDir + "/tagged.xml";
+    grt::GRT::get()->serialize(IntegerRef(1), xmlFilename);
+    $expect(grt::GRT::get()->get_binary_metainfo(xmlFilename, doctype, version, tag)).toBeFalse();
+    $expect([&]() { grt::GRT::get()->unserialize_binary(xmlFilename, doctype, version); }).toThrow();
+  });
+
+  $it("Binary serialization keeps the content type of dicts", [this]() {
+    std::string filename = data->outputDir + "/typed_dicts.grtb";
+
+    DictRef typedDicts(true);
+    DictRef integers(IntegerType);
+    integers.set("one", IntegerRef(1));
+    typedDicts.set("integers", integers);
+    DictRef authors(ObjectType, "test.Author");
+    authors.set("author", test_AuthorRef(grt::Initialized));
+    typedDicts.set("authors", authors);
+    typedDicts.set("any", DictRef(true));
+
+    grt::GRT::get()->serialize_binary(typedDicts, filename);
+    std::string doctype, version;
+    DictRef loaded(DictRef::cast_from(grt::GRT::get()->unserialize_binary(filename, doctype, version)));
+
+    DictRef loadedIntegers(DictRef::cast_from(loaded.get("integers")));
+    $expect(loadedIntegers.content_type()).toBe(IntegerType);
+    DictRef loadedAuthors(DictRef::cast_from(loaded.get("authors")));
+    $expect(loadedAuthors.content_type()).toBe(ObjectType);
+    $expect(loadedAuthors.content_class_name()).toBe("test.Author");
+    $expect(DictRef::cast_from(loaded.get("any")).content_type()).toBe(AnyType);
+  });
+
+  $it("Binary and XML serialization of a large catalog", [this]() {
+    db_mysql_CatalogRef catalog = data->createLargeCatalog(10, 150, 15);
+
+    std::string xmlFile = data->outputDir + "/large_catalog.xml";
+    std::string binaryFile = data->outputDir + "/large_catalog.grtb";
+
+    grt::GRT::get()->serialize(catalog, xmlFile);
+    grt::GRT::get()->serialize_binary(catalog, binaryFile);
+
+    ValueRef xmlValue = grt::GRT::get()->unserialize(xmlFile);
+    std::string doctype, version;
+    ValueRef binaryValue = grt::GRT::get()->unserialize_binary(binaryFile, doctype, version);
+
+    $expect(base_get_file_size(binaryFile.c_str())).toBeLessThan(base_get_file_size(xmlFile.c_str()));
+    deepCompareGrtValues("binary vs XML catalog", binaryValue, xmlValue, true);
+
+    // Foreign keys must point to the tables of the loaded catalog, not to the ones in memory.
+    db_mysql_CatalogRef loaded(db_mysql_CatalogRef::cast_from(binaryValue));
+    db_mysql_TableRef table(loaded->schemata()[0]->tables()[1]);
+    $expect(table->foreignKeys()[0]->referencedTable().valueptr())
+      .toEqual(loaded->schemata()[0]->tables()[0].valueptr());
+    $expect(table->indices()[0]->owner().valueptr()).toEqual(table.valueptr());
+  });
+
+  $it("Binary encoding of an XML document matches the one of its values", [this]() {
+    db_mysql_CatalogRef catalog = data->createLargeCatalog(3, 20, 8);
+
+    xmlDocPtr xmldoc = grt::GRT::get()->create_xml_document(catalog, "test", "1.0");
+    std::string fromXml = grt::GRT::get()->serialize_binary_data(xmldoc, "tag");
+    xmlFreeDoc(xmldoc);
+    std::string fromValues = grt::GRT::get()->serialize_binary_data(catalog, "test", "1.0", "tag");
+
+    std::string doctype, version, tag;
+    $expect(grt::GRT::get()->get_binary_data_metainfo(fromXml, doctype, version, tag)).toBeTrue();
+    $expect(doctype).toBe("test");
+    $expect(version).toBe("1.0");
+    $expect(tag).toBe("tag");
+
+    ValueRef xmlValue = grt::GRT::get()->unserialize_binary_data(fromXml, doctype, version);
+    ValueRef binaryValue = grt::GRT::get()->unserialize_binary_data(fromValues, doctype, version);
+    deepCompareGrtValues("binary from XML vs binary from values", xmlValue, binaryValue, true);
+
+    db_mysql_CatalogRef loaded(db_mysql_CatalogRef::cast_from(xmlValue));
+    db_mysql_TableRef table(loaded->schemata()[0]->tables()[1]);
+    $expect(table->foreignKeys()[0]->referencedTable().valueptr())
+      .toEqual(loaded->schemata()[0]->tables()[0].valueptr());
+  });
+
 #ifdef badtest
   $it("", [this]() {
     // "dontfollow" means the object will be saved as a link, not that it won't be saved at all.
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2018, 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "grt.h"
+#include "wb_test_helpers.h"
+
+#include "casmine.h"
+
+using namespace casmine;
+
+namespace {
+
+$ModuleEnvironment() {};
+
+$TestData {
+  std::unique_ptr<WorkbenchTester> tester;
+
+  // Runs the script in the Python context, a failing assert in it makes the run fail.
+  bool runScript(const std::string &script) {
+    grt::ModuleLoader *loader = grt::GRT::get()->get_module_loader("python");
+    return loader != nullptr && loader->run_script(script);
+  }
+};
+
+// The lists are larger than the size from which membership tests use a hashed index.
+static const char *createLists =
+  "import grt\n"
+  "tables = grt.List(grt.OBJECT, 'db.mysql.Table')\n"
+  "names = grt.List(grt.STRING)\n"
+  "for i in range(200):\n"
+  "  table = grt.classes.db_mysql_Table()\n"
+  "  table.name = 'table%i' % i\n"
+  "  tables.append(table)\n"
+  "  names.append(table.name)\n"
+  "other = grt.classes.db_mysql_Table()\n"
+  "other.name = 'table1'\n";
+
+$describe("Python GRT collections") {
+  $beforeAll([this]() {
+    data->tester.reset(new WorkbenchTester(true));
+    data->tester->initializeRuntime();
+  });
+
+  $it("Iteration and indexing return the same items", [this]() {
+    $expect(data->runScript(createLists)).toBeTrue();
+    $expect(data->runScript(
+      "assert [t.name for t in tables] == [tables[i].name for i in range(len(tables))]\n"
+      "assert [t.name for t in tables] == ['table%i' % i for i in range(200)]\n"
+      "assert list(names) == ['table%i' % i for i in range(200)]\n"
+      "assert tables[3] == tables[3]\n"
+      "assert tables[3] != tables[4]\n"
+      "seen = []\n"
+      "for t in tables:\n"
+      "  if len(seen) == 0:\n"
+      "    tables.append(other)\n"
+      "  seen.append(t)\n"
+      "assert len(seen) == 201 and seen[-1] == other\n"
+      "tables.remove(other)\n"
+      "assert len(tables) == 200\n"
+    )).toBeTrue();
+  });
+
+  $it("Slicing returns Python lists of the items", [this]() {
+    $expect(data->runScript(createLists)).toBeTrue();
+    $expect(data->runScript(
+      "assert [t.name for t in tables[10:20]] == ['table%i' % i for i in range(10, 20)]\n"
+      "assert [t.name for t in tables[-3:]] == ['table197', 'table198', 'table199']\n"
+      "assert tables[150:300] == [tables[i] for i in range(150, 200)]\n"
+      "assert tables[300:] == [] and tables[20:10] == []\n"
+      "assert names[:2] == ['table0', 'table1'] and len(names[:]) == 200\n"
+    )).toBeTrue();
+  });
+
+  $it("Membership tests in object lists", [this]() {
+    $expect(data->runScript(createLists)).toBeTrue();
+    $expect(data->runScript(
+      "for repeat in range(3):\n"
+      "  assert all(t in tables for t in tables)\n"
+      "  assert other not in tables\n"
+      "  assert None not in tables and 'table1' not in tables and 1 not in tables\n"
+      "removed = tables[5]\n"
+      "tables.remove(removed)\n"
+      "assert removed not in tables and removed not in tables\n"
+      "tables.append(other)\n"
+      "assert other in tables and other in tables\n"
+      "objects = grt.List(grt.OBJECT)\n"
+      "objects.append(other)\n"
+      "assert other in objects and tables[0] not in objects\n"
+    )).toBeTrue();
+  });
+
+  $it("Membership tests in string lists", [this]() {
+    $expect(data->runScript(createLists)).toBeTrue();
+    $expect(data->runScript(
+      "for repeat in range(3):\n"
+      "  assert 'table7' in names and u'table7' in names\n"
+      "  assert 'table200' not in names and 7 not in names and None not in names\n"
+      "names[7] = 'changed'\n"
+      "assert 'table7' not in names and 'changed' in names\n"
+      "names.remove('changed')\n"
+      "assert 'changed' not in names and 'changed' not in names\n"
+      "mixed = grt.List()\n"
+      "mixed.append('a')\n"
+      "mixed.append(1)\n"
+      "mixed.append(None)\n"
+      "assert 'a' in mixed and 1 in mixed and None in mixed and 'b' not in mixed\n"
+    )).toBeTrue();
+  });
+}
+
+}
@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "structs.test.h"
+
+#include "casmine.h"
+#include "wb_test_helpers.h"
+
+$ModuleEnvironment() {};
+
+namespace {
+
+// Everything the undo steps below change, as one string.
+static std::string snapshot(const test_PublisherRef &publisher) {
+  std::string result = *publisher->name() + "|" + *publisher->phone();
+  for (size_t i = 0; i < publisher->books().count(); ++i) {
+    test_BookRef book = publisher->books()[i];
+    result += "|" + *book->title() + ":" + std::to_string(*book->pages());
+
+    grt::DictRef extras = book->extras();
+    for (grt::DictRef::const_iterator iter = extras.begin(); iter != extras.end(); ++iter)
+      result += "," + iter->first + "=" + iter->second.toString();
+  }
+  return result;
+}
+
+static std::string long_text(const std::string &prefix, size_t i) {
+  return prefix + std::to_string(i) + std::string(1000, 'a' + (char)(i % 26));
+}
+
+// One undoable step, which kind depends on i.
+static void change(const test_PublisherRef &publisher, size_t i) {
+  grt::AutoUndo undo;
+
+  switch (i % 5) {
+    case 0:
+      publisher->name(long_text("name ", i));
+      break;
+
+    case 1: {
+      test_BookRef book(grt::Initialized);
+      book->title(long_text("title ", i));
+      publisher->books().insert(book);
+      break;
+    }
+
+    case 2: {
+      test_BookRef book = publisher->books()[0];
+      book->title(long_text("changed title ", i));
+      book->pages(grt::IntegerRef((ssize_t)i));
+      break;
+    }
+
+    case 3: {
+      grt::DictRef extras = publisher->books()[0]->extras();
+      extras.set("key" + std::to_string(i), grt::StringRef(long_text("extra ", i)));
+      extras.set("number", grt::DoubleRef(i * 0.5));
+      if (extras.has_key("key" + std::to_string(i - 5)))
+        extras.remove("key" + std::to_string(i - 5));
+      break;
+    }
+
+    default: {
+      grt::ListRef<test_Book> books = publisher->books();
+      books.remove(books.count() - 1);
+      books.reorder(0, books.count() - 1);
+      break;
+    }
+  }
+
+  undo.end("step " + std::to_string(i));
+}
+
+$describe("GRT: undo history memory budget") {
+  $beforeAll([]() {
+    register_structs_test_xml();
+    grt::GRT::get()->load_metaclasses(casmine::CasmineContext::get()->tmpDataDir() + "/structs.test.xml");
+    grt::GRT::get()->end_loading_metaclasses();
+  });
+
+  $afterAll([]() {
+    grt::GRT::get()->get_undo_manager()->set_undo_memory_limit(0);
+    grt::GRT::get()->get_undo_manager()->reset();
+    WorkbenchTester::reinitGRT();
+  });
+
+  $beforeEach([]() {
+    grt::GRT::get()->get_undo_manager()->reset();
+    grt::GRT::get()->get_undo_manager()->set_undo_limit(0);
+    grt::GRT::get()->get_undo_manager()->set_undo_memory_limit(0);
+  });
+
+  $it("Undo and redo with a small budget", []() {
+    grt::UndoManager *um = grt::GRT::get()->get_undo_manager();
+    um->set_undo_memory_limit(32 * 1024);
+
+    test_PublisherRef publisher(grt::Initialized);
+    publisher->name("publisher");
+    for (size_t i = 0; i < 3; ++i) {
+      test_BookRef book(grt::Initialized);
+      book->title("book " + std::to_string(i));
+      publisher->books().insert(book);
+    }
+    publisher.mark_global();
+
+    const size_t steps = 40;
+    std::vector<std::string> states;
+    states.push_back(snapshot(publisher));
+    for (size_t i = 0; i < steps; ++i) {
+      change(publisher, i);
+      states.push_back(snapshot(publisher));
+    }
+
+    $expect(um->get_undo_stack().size()).toEqual(steps, "no step was dropped");
+    $expect(um->get_spilled_undo_count()).toBeGreaterThan(0U, "older steps were spilled");
+    $expect(um->get_undo_memory_usage()).toBeLessThanOrEqual(um->get_undo_memory_limit());
+
+    for (size_t i = steps; i > 0; --i) {
+      um->undo();
+      $expect(snapshot(publisher)).toEqual(states[i - 1], "state after undoing step " + std::to_string(i - 1));
+    }
+    $expect(um->can_undo()).toBeFalse();
+
+    for (size_t i = 0; i < steps; ++i) {
+      um->redo();
+      $expect(snapshot(publisher)).toEqual(states[i + 1], "state after redoing step " + std::to_string(i));
+    }
+    $expect(um->can_redo()).toBeFalse();
+
+    publisher.unmark_global();
+  });
+
+  $it("Repeated changes of the same object are merged", []() {
+    grt::UndoManager *um = grt::GRT::get()->get_undo_manager();
+    um->set_undo_memory_limit(8 * 1024);
+
+    test_PublisherRef publisher(grt::Initialized);
+    publisher->name("publisher");
+    publisher.mark_global();
+
+    for (size_t i = 0; i < 30; ++i) {
+      grt::AutoUndo undo;
+      publisher->name(long_text("name ", i));
+      undo.end("rename");
+    }
+
+    // All but the latest rename were merged into the first one.
+    $expect(um->get_undo_stack().size()).toEqual(2U);
+    $expect(um->get_undo_memory_usage()).toBeLessThanOrEqual(um->get_undo_memory_limit());
+
+    um->undo();
+    $expect(*publisher->name()).toEqual(long_text("name ", 28));
+    um->undo();
+    $expect(*publisher->name()).toEqual("publisher");
+    $expect(um->can_undo()).toBeFalse();
+
+    publisher.unmark_global();
+  });
+
+  $it("Without a limit nothing is merged or spilled", []() {
+    grt::UndoManager *um = grt::GRT::get()->get_undo_manager();
+
+    test_PublisherRef publisher(grt::Initialized);
+    publisher.mark_global();
+
+    for (size_t i = 0; i < 30; ++i) {
+      grt::AutoUndo undo;
+      publisher->name(long_text("name ", i));
+      undo.end("rename");
+    }
+
+    $expect(um->get_undo_stack().size()).toEqual(30U);
+    $expect(um->get_spilled_undo_count()).toEqual(0U);
+
+    publisher.unmark_global();
+  });
+}
+
+}
@@ -869,6 +869,43 @@ $describe("GRT values") {
     $expect(*lv.get(3)).toEqual(2U);
   });
 
+  $it("list revision changes with the content", [&]() {
+    grt::StringListRef list(grt::Initialized);
+    size_t revision = list.content().revision();
+
+    list.insert(grt::StringRef("a"));
+    list.insert(grt::StringRef("b"));
+    list.insert(grt::StringRef("c"));
+    $expect(list.content().revision()).Not.toEqual(revision);
+
+    revision = list.content().revision();
+    list.get(1);
+    list.get_index(grt::StringRef("b"));
+    $expect(list.content().revision()).toEqual(revision);
+
+    list.content().set_unchecked(0, grt::StringRef("x"));
+    $expect(list.content().revision()).Not.toEqual(revision);
+
+    revision = list.content().revision();
+    list.reorder(0, 2);
+    $expect(list.content().revision()).Not.toEqual(revision);
+
+    revision = list.content().revision();
+    list.gremove_value(grt::StringRef("unknown"));
+    $expect(list.content().revision()).toEqual(revision);
+    list.gremove_value(grt::StringRef("b"));
+    $expect(list.content().revision()).Not.toEqual(revision);
+
+    revision = list.content().revision();
+    list.remove(0);
+    $expect(list.content().revision()).Not.toEqual(revision);
+
+    // A new list doesn't repeat the revision of any other list.
+    grt::StringListRef other(grt::Initialized);
+    $expect(other.content().revision()).Not.toEqual(list.content().revision());
+    $expect(other.content().revision()).Not.toEqual(revision);
+  });
+
 }
 
 }
@@ -23,7 +23,9 @@
 
 #include "base/utf8string.h"
 #include "mtemplate/template.h"
+#include "mtemplate/compiled_template.h"
 #include "base/string_utilities.h"
+#include "base/file_utilities.h"
 #include <fstream>
 
 #include "casmine.h"
@@ -81,9 +83,127 @@ struct SQLQuoteModifier : public mtemplate::Modifier {
   }
 };
 
+// Rows of two fields, straight from vectors. Field values are computed, only the row cursor is ever stored.
+class RowsCursor : public mtemplate::TemplateCursor {
+  class FieldCursor : public mtemplate::TemplateCursor {
+  public:
+    std::size_t nameSlot;
+    std::size_t valueSlot;
+    const std::pair<std::string, base::utf8string> *field;
+    bool last;
+
+    virtual bool getValue(std::size_t slot, std::string &value) {
+      if (slot == nameSlot)
+        value = field->first;
+      else if (slot == valueSlot)
+        value = field->second;
+      else
+        return false;
+      return true;
+    }
+
+    virtual mtemplate::TemplateCursor *getSection(std::size_t slot, std::size_t row) {
+      return nullptr;
+    }
+
+    virtual bool isLast() {
+      return last;
+    }
+  };
+
+  const std::map<std::string, base::utf8string> &_rows;
+  std::map<std::string, base::utf8string>::const_iterator _row;
+  std::size_t _rowSlot;
+  std::size_t _fieldSlot;
+  std::pair<std::string, base::utf8string> _fields[2];
+  FieldCursor _field;
+
+public:
+  RowsCursor(const mtemplate::CompiledTemplate &tpl, const std::map<std::string, base::utf8string> &rows)
+    : _rows(rows), _rowSlot(tpl.slot("ROW")), _fieldSlot(tpl.slot("FIELD")) {
+    _field.nameSlot = tpl.slot("FIELD_NAME");
+    _field.valueSlot = tpl.slot("FIELD_VALUE");
+  }
+
+  virtual bool getValue(std::size_t slot, std::string &value) {
+    return false;
+  }
+
+  virtual mtemplate::TemplateCursor *getSection(std::size_t slot, std::size_t row) {
+    if (slot == _rowSlot) {
+      _row = row == 0 ? _rows.begin() : std::next(_row);
+      if (_row == _rows.end())
+        return nullptr;
+      _fields[0] = { "Language", _row->first };
+      _fields[1] = { "Phrase", _row->second };
+      return this;
+    }
+
+    if (slot == _fieldSlot && row < 2) {
+      _field.field = &_fields[row];
+      _field.last = row == 1;
+      return &_field;
+    }
+    return nullptr;
+  }
+};
+
+// Data for everything a template refers to: every section gets two rows (so separators show up) and every
+// variable a value of its own, with characters the escaping modifiers deal with.
+void fillDictionary(mtemplate::DictionaryInterface *dictionary, const mtemplate::TemplateDocument &document,
+                    std::size_t &counter) {
+  for (mtemplate::NodeStorageType node : document) {
+    switch (node->type()) {
+      case mtemplate::TemplateObject_Variable:
+        dictionary->setValue(node->text(), node->text() + " " + std::to_string(++counter) + " <\"a, b\"> & 'c;\td'");
+        break;
+
+      case mtemplate::TemplateObject_Section:
+      case mtemplate::TemplateObject_SectionSeparator: {
+        mtemplate::NodeSection *section = static_cast<mtemplate::NodeSection *>(node.get());
+        if (section->is_separator()) {
+          fillDictionary(dictionary, section->_contents, counter);
+          break;
+        }
+
+        // Sections used more than once share their rows, as they do with real data.
+        if (dictionary->getSectionDictionaries(section->text()).empty()) {
+          dictionary->addSectionDictionary(section->text());
+          dictionary->addSectionDictionary(section->text());
+        }
+        for (mtemplate::DictionaryInterface *row : dictionary->getSectionDictionaries(section->text()))
+          fillDictionary(row, section->_contents, counter);
+        break;
+      }
+
+      default:
+        break;
+    }
+  }
+}
+
 $TestData {
   std::string outputDir = CasmineContext::get()->outputDir();
   std::string dataDir = CasmineContext::get()->tmpDataDir();
+  std::string sourceDir = CasmineContext::get()->baseDir() + "/../..";
+
+  // Expands the template with the dictionary the regular way and compiled, in small and in one big chunk.
+  void checkCompiled(mtemplate::Template &tpl, mtemplate::DictionaryInterface *dictionary, const std::string &name) {
+    mtemplate::TemplateOutputString expected;
+    tpl.expand(dictionary, &expected);
+
+    mtemplate::CompiledTemplate compiled(tpl);
+    mtemplate::TemplateOutputString output;
+    {
+      mtemplate::TemplateWriter writer(&output, 16); // Flush often.
+      compiled.expand(dictionary, writer);
+    }
+    $expect(std::string(output.get())).toEqual(std::string(expected.get()), name);
+
+    mtemplate::TemplateWriter buffer;
+    compiled.expand(dictionary, buffer);
+    $expect(buffer.buffer()).toEqual(std::string(expected.get()), name + " (buffered)");
+  }
 
   std::map<std::string, base::utf8string> language_details_map = {
     {"english", base::utf8string("I can eat glass and it doesn't hurt me. ")},
@@ -260,6 +380,176 @@ $describe("mtemplate") {
     $expect(compare_file_contents(data->dataDir + "/mtemplate/test_result.html", data->outputDir + "/test_result.html")).toBeTrue();
   });
 
+  $it("Expand a section from dictionaries created on demand", []() {
+    mtemplate::Template tpl(mtemplate::parseTemplate(
+      "{{TITLE}}:{{#ITEM}}[{{NAME}}={{VALUE}}{{#ITEM_separator}},{{/ITEM_separator}}]{{/ITEM}}.{{#ITEM}}{{NAME}}{{/ITEM}}",
+      mtemplate::DO_NOT_STRIP));
+    $expect(tpl.hasNestedSection("ITEM")).toBeFalse();
+    $expect(tpl.hasNestedSection("ITEM_separator")).toBeTrue();
+
+    auto fill = [](mtemplate::DictionaryInterface *item, std::size_t i) {
+      item->setValue("NAME", "item" + std::to_string(i));
+    };
+
+    // All dictionaries at once, the regular way.
+    std::unique_ptr<mtemplate::Dictionary> dictionary(mtemplate::CreateMainDictionary());
+    dictionary->setValue("TITLE", "items");
+    dictionary->setValue("VALUE", "v");
+    for (std::size_t i = 0; i < 3; ++i)
+      fill(dictionary->addSectionDictionary("ITEM"), i);
+    mtemplate::TemplateOutputString expected;
+    tpl.expand(dictionary.get(), &expected);
+
+    // The same, one by one. Values not in the item dictionaries still come from the parent.
+    std::unique_ptr<mtemplate::Dictionary> main(mtemplate::CreateMainDictionary());
+    main->setValue("TITLE", "items");
+    main->setValue("VALUE", "v");
+    std::size_t created = 0;
+    mtemplate::TemplateOutputString output;
+    tpl.expand(main.get(), &output, "ITEM", [&](std::size_t index) -> mtemplate::DictionaryInterface * {
+      if (index >= 3)
+        return nullptr;
+      ++created;
+      mtemplate::Dictionary *item = main->createSectionDictionary("ITEM");
+      item->setIsLast(index == 2);
+      fill(item, index);
+      return item;
+    });
+
+    $expect(std::string(output.get())).toEqual("items:[item0=v,][item1=v,][item2=v].item0item1item2");
+    $expect(std::string(output.get())).toEqual(std::string(expected.get()));
+    $expect(created).toEqual(6U);
+    $expect(main->getSectionDictionaries("ITEM").size()).toEqual(0U);
+  });
+
+  $it("Compiled templates produce the same output as parsed ones", [this]() {
+    mtemplate::Modifier::addModifier<CSVTokenQuoteModifier>("csv_quote");
+    mtemplate::Modifier::addModifier<SQLQuoteModifier>("sql_quote");
+    mtemplate::SetGlobalValue("INDENT", "\t");
+    mtemplate::SetGlobalValue("TABLE_NAME", "some_table");
+
+    auto check = [this](mtemplate::Template &tpl, mtemplate::DictionaryInterface *dictionary, const std::string &name) {
+      data->checkCompiled(tpl, dictionary, name);
+    };
+
+    // The bundled test templates, with the data of the specs above.
+    std::unique_ptr<mtemplate::Dictionary> dictionary(mtemplate::CreateMainDictionary());
+    dictionary->addSectionDictionary("COLUMN")->setValue("COLUMN_NAME", "Language");
+    dictionary->addSectionDictionary("COLUMN")->setValue("COLUMN_NAME", "Phrase");
+    for (auto item : data->language_details_map) {
+      mtemplate::DictionaryInterface *row = dictionary->addSectionDictionary("ROW");
+      mtemplate::DictionaryInterface *field = row->addSectionDictionary("FIELD");
+      field->setValue("FIELD_NAME", "Language");
+      field->setValue("FIELD_VALUE", item.first);
+      field = row->addSectionDictionary("FIELD");
+      field->setValue("FIELD_NAME", "Phrase");
+      field->setValue("FIELD_VALUE", item.second);
+    }
+
+    for (std::string name : { "CSV_semicolon", "HTML", "JSON", "SQL_inserts" }) {
+      for (std::string part : { ".pre", "", ".post" }) {
+        std::string path = data->dataDir + "/mtemplate/" + name + part + ".tpl";
+        std::unique_ptr<mtemplate::Template> tpl(mtemplate::GetTemplate(path));
+        if (tpl)
+          check(*tpl, dictionary.get(), name + part);
+      }
+    }
+
+    // Nested sections, separators, hidden sections, modifiers and values from parents and the global dictionary.
+    mtemplate::Template tpl(mtemplate::parseTemplate(
+      "{{#TABLE}}{{TABLE_NAME}}({{#COLUMN}}{{NAME:x-sql_quote}} {{TYPE}}{{#COLUMN_separator}}, {{/COLUMN_separator}}"
+      "{{/COLUMN}}){{#NOTE}}\n  -- {{TEXT:x-csv_quote=comma}} in {{SCHEMA}}{{/NOTE}}{{#TABLE_separator}};\n"
+      "{{/TABLE_separator}}{{/TABLE}}\n{{#EMPTY}}not shown{{/EMPTY}}{{INDENT}}{{MISSING}}end\n",
+      mtemplate::DO_NOT_STRIP));
+    std::unique_ptr<mtemplate::Dictionary> schema(mtemplate::CreateMainDictionary());
+    schema->setValue("SCHEMA", "sakila");
+    for (std::size_t i = 0; i < 3; ++i) {
+      mtemplate::DictionaryInterface *table = schema->addSectionDictionary("TABLE");
+      table->setValue("TABLE_NAME", "table" + std::to_string(i));
+      for (std::size_t j = 0; j <= i; ++j) {
+        mtemplate::DictionaryInterface *column = table->addSectionDictionary("COLUMN");
+        column->setValue("NAME", "column" + std::to_string(j));
+        column->setValue("TYPE", j % 2 == 0 ? "INT" : "TEXT");
+      }
+      if (i != 1)
+        table->addSectionDictionary("NOTE")->setValue("TEXT", "note, number " + std::to_string(i));
+    }
+    check(tpl, schema.get(), "inline template");
+    std::unique_ptr<mtemplate::Dictionary> empty(mtemplate::CreateMainDictionary());
+    check(tpl, empty.get(), "inline template without data");
+
+    mtemplate::CompiledTemplate compiled(tpl);
+    $expect(compiled.slot("COLUMN")).Not.toEqual(mtemplate::CompiledTemplate::npos);
+    $expect(compiled.slot("UNUSED")).toEqual(mtemplate::CompiledTemplate::npos);
+  });
+
+  $it("Compiled templates produce the same output as parsed ones for all shipped templates", [this]() {
+    mtemplate::Modifier::addModifier<CSVTokenQuoteModifier>("csv_quote");
+    mtemplate::SetGlobalValue("INDENT", "\t");
+
+    // Result set export formats, model reports (a folder per report, with a template per file) and catalog reports.
+    std::vector<std::pair<std::string, std::size_t>> folders = {
+      { "/res/sqlidedata/templates", 23 },
+      { "/modules/wb.model/res/wb_model_reporting", 19 },
+      { "/modules/db.mysql/res/db_mysql_catalog_reporting", 1 },
+    };
+
+    for (auto &folder : folders) {
+      std::list<std::string> files;
+      for (auto &entry : base::scan_for_files_matching(data->sourceDir + folder.first + "/*.tpl")) {
+        if (base::is_directory(entry)) {
+          std::list<std::string> reportFiles = base::scan_for_files_matching(entry + "/*.tpl");
+          files.insert(files.end(), reportFiles.begin(), reportFiles.end());
+        } else
+          files.push_back(entry);
+      }
+      $expect(files.size()).toBeGreaterThanOrEqual(folder.second, folder.first);
+
+      for (auto &file : files) {
+        for (mtemplate::PARSE_TYPE type : { mtemplate::DO_NOT_STRIP, mtemplate::STRIP_BLANK_LINES }) {
+          std::unique_ptr<mtemplate::Template> tpl(mtemplate::GetTemplate(file, type));
+          $expect(tpl.get()).Not.toBeNull(file);
+
+          std::size_t counter = 0;
+          std::unique_ptr<mtemplate::Dictionary> dictionary(mtemplate::CreateMainDictionary());
+          fillDictionary(dictionary.get(), tpl->document(), counter);
+          data->checkCompiled(*tpl, dictionary.get(), file);
+
+          std::unique_ptr<mtemplate::Dictionary> empty(mtemplate::CreateMainDictionary());
+          data->checkCompiled(*tpl, empty.get(), file + " without data");
+        }
+      }
+    }
+  });
+
+  $it("Expand a compiled template with a custom cursor", [this]() {
+    mtemplate::Modifier::addModifier<SQLQuoteModifier>("sql_quote");
+    mtemplate::SetGlobalValue("TABLE_NAME", "some_table");
+
+    std::unique_ptr<mtemplate::Template> tpl(mtemplate::GetTemplate(data->dataDir + "/mtemplate/SQL_inserts.tpl"));
+    std::unique_ptr<mtemplate::CompiledTemplate> compiled(
+      mtemplate::GetCompiledTemplate(data->dataDir + "/mtemplate/SQL_inserts.tpl"));
+
+    mtemplate::TemplateOutputString expected;
+    for (auto item : data->language_details_map) {
+      std::unique_ptr<mtemplate::Dictionary> dictionary(mtemplate::CreateMainDictionary());
+      mtemplate::DictionaryInterface *row = dictionary->addSectionDictionary("ROW");
+      mtemplate::DictionaryInterface *field = row->addSectionDictionary("FIELD");
+      field->setValue("FIELD_NAME", "Language");
+      field->setValue("FIELD_VALUE", item.first);
+      field = row->addSectionDictionary("FIELD");
+      field->setValue("FIELD_NAME", "Phrase");
+      field->setValue("FIELD_VALUE", item.second);
+      tpl->expand(dictionary.get(), &expected);
+    }
+
+    // All rows in one go, no dictionaries at all.
+    RowsCursor cursor(*compiled, data->language_details_map);
+    mtemplate::TemplateWriter writer;
+    compiled->expand(&cursor, writer);
+    $expect(writer.buffer()).toEqual(std::string(expected.get()));
+  });
+
 }
 
 }
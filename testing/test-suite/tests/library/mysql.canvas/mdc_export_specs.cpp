@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "mdc.h"
+#include "mdc_canvas_view_image.h"
+
+#include "base/file_utilities.h"
+
+#include "casmine.h"
+
+#include <algorithm>
+
+using namespace casmine;
+
+namespace {
+
+$ModuleEnvironment() {};
+
+// Exposes the export rendering, to write a reference image the way export_png() did before it rendered tiles.
+class ReferenceCanvasView : public mdc::ImageCanvasView {
+public:
+  ReferenceCanvasView(int width, int height) : mdc::ImageCanvasView(width, height) {
+  }
+
+  // Renders the cropped diagram into one image surface and writes it with cairo's own PNG writer.
+  void export_reference_png(const std::string &filename) {
+    base::Rect bounds = get_content_bounds();
+    bounds.pos.x = std::max(bounds.pos.x - 10, 0.0);
+    bounds.pos.y = std::max(bounds.pos.y - 10, 0.0);
+    bounds.size.width += 20;
+    bounds.size.height += 20;
+
+    cairo_surface_t *surface =
+      cairo_image_surface_create(CAIRO_FORMAT_RGB24, (int)bounds.width(), (int)bounds.height());
+    {
+      mdc::CairoCtx ctx(surface);
+      ctx.rectangle(0, 0, bounds.width(), bounds.height());
+      ctx.set_color(base::Color::white());
+      ctx.fill();
+      render_for_export(bounds, &ctx);
+    }
+    cairo_surface_write_to_png(surface, filename.c_str());
+    cairo_surface_destroy(surface);
+  }
+};
+
+$TestData {
+  std::string outputDir = CasmineContext::get()->outputDir();
+
+  // Compares the pixels of two PNG files. The files themselves differ, as the encoders do.
+  std::string comparePixels(const std::string &expected, const std::string &actual) {
+    cairo_surface_t *a = cairo_image_surface_create_from_png(expected.c_str());
+    cairo_surface_t *b = cairo_image_surface_create_from_png(actual.c_str());
+
+    std::string result;
+    if (cairo_surface_status(a) != CAIRO_STATUS_SUCCESS || cairo_surface_status(b) != CAIRO_STATUS_SUCCESS)
+      result = "could not load the images";
+    else if (cairo_image_surface_get_width(a) != cairo_image_surface_get_width(b) ||
+             cairo_image_surface_get_height(a) != cairo_image_surface_get_height(b))
+      result = "image sizes differ";
+    else {
+      int width = cairo_image_surface_get_width(a);
+      for (int y = 0; y < cairo_image_surface_get_height(a) && result.empty(); ++y) {
+        const unsigned char *dataA = cairo_image_surface_get_data(a) + y * cairo_image_surface_get_stride(a);
+        const unsigned char *dataB = cairo_image_surface_get_data(b) + y * cairo_image_surface_get_stride(b);
+        const uint32_t *rowA = (const uint32_t *)dataA;
+        const uint32_t *rowB = (const uint32_t *)dataB;
+        for (int x = 0; x < width; ++x) {
+          // Only color is compared, the alpha byte of RGB images is unused.
+          if ((rowA[x] & 0xffffff) != (rowB[x] & 0xffffff)) {
+            result = "pixel " + std::to_string(x) + "," + std::to_string(y) + " differs";
+            break;
+          }
+        }
+      }
+    }
+
+    cairo_surface_destroy(a);
+    cairo_surface_destroy(b);
+    return result;
+  }
+};
+
+$describe("mdc diagram export") {
+  $it("Single pass and tiled PNG export match the image written by cairo", [this]() {
+    ReferenceCanvasView view(100, 100);
+    view.initialize();
+    view.set_page_size(base::Size(5200, 2700));
+    mdc::Layer *layer = view.get_current_layer();
+
+    // A synthetic diagram with 5000 figures, some of them overlapping tile borders.
+    std::vector<std::unique_ptr<mdc::RectangleFigure>> figures;
+    for (int i = 0; i < 5000; ++i) {
+      figures.push_back(std::make_unique<mdc::RectangleFigure>(layer));
+      mdc::RectangleFigure *figure = figures.back().get();
+      layer->add_item(figure);
+      figure->move_to(base::Point((i % 100) * 51.0 + 10, (i / 100) * 53.0 + 10));
+      figure->set_fixed_size(base::Size(40 + i % 7, 30 + i % 11));
+      figure->set_pen_color(base::Color((i % 3) / 2.0, (i % 5) / 4.0, (i % 7) / 6.0));
+      figure->set_filled(i % 2 == 0);
+      figure->set_fill_color(base::Color(0.5, 0.8, (i % 10) / 9.0));
+      if (i % 4 == 0)
+        figure->set_rounded_corners(8, mdc::CAll);
+    }
+
+    std::string reference = data->outputDir + "/export_reference.png";
+    std::string single = data->outputDir + "/export_single.png";
+    std::string tiled = data->outputDir + "/export_tiled.png";
+    view.export_reference_png(reference);
+    view.export_png(single, true, 0, false);
+    view.export_png(tiled, true, 256, true);
+
+    $expect(data->comparePixels(reference, single)).toEqual("", "Single pass export differs from the reference");
+    $expect(data->comparePixels(reference, tiled)).toEqual("", "Tiled export differs from the reference");
+
+    cairo_surface_t *image = cairo_image_surface_create_from_png(tiled.c_str());
+    $expect((int)cairo_surface_status(image)).toBe(CAIRO_STATUS_SUCCESS);
+    $expect(cairo_image_surface_get_width(image)).toBeGreaterThan(5000);
+    $expect(cairo_image_surface_get_height(image)).toBeGreaterThan(2600);
+    cairo_surface_destroy(image);
+
+    base::remove(reference);
+    base::remove(single);
+    base::remove(tiled);
+  });
+}
+
+}
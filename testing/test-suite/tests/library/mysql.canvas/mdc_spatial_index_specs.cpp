@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "mdc.h"
+#include "mdc_canvas_view_image.h"
+
+#include "casmine.h"
+
+namespace {
+
+$ModuleEnvironment() {};
+
+$TestData {
+  std::unique_ptr<mdc::ImageCanvasView> view;
+  std::vector<std::unique_ptr<mdc::RectangleFigure>> figures;
+
+  mdc::RectangleFigure *add_figure(double x, double y, double width, double height) {
+    mdc::Layer *layer = view->get_current_layer();
+    figures.push_back(std::make_unique<mdc::RectangleFigure>(layer));
+
+    mdc::RectangleFigure *figure = figures.back().get();
+    layer->add_item(figure);
+    figure->move_to(base::Point(x, y));
+    figure->set_fixed_size(base::Size(width, height));
+
+    return figure;
+  }
+};
+
+$describe("mdc spatial index") {
+  $beforeEach([this]() {
+    data->figures.clear();
+    data->view = std::make_unique<mdc::ImageCanvasView>(2000, 2000);
+    data->view->initialize();
+  });
+
+  $afterEach([this]() {
+    data->figures.clear();
+    data->view.reset();
+  });
+
+  $it("Index queries", []() {
+    mdc::ImageCanvasView view(100, 100);
+    view.initialize();
+    mdc::Layer *layer = view.get_current_layer();
+
+    mdc::RectangleFigure small(layer), large(layer);
+    mdc::SpatialIndex index(100);
+
+    index.insert(&small, base::Rect(10, 10, 20, 20));
+    index.insert(&large, base::Rect(-50000, 0, 100000, 10)); // Spans more cells than worth tracking.
+    $expect(index.size()).toBe(2U);
+
+    std::vector<mdc::CanvasItem *> items;
+    index.query(base::Rect(0, 0, 50, 50), items);
+    $expect(items.size()).toBe(2U);
+
+    items.clear();
+    index.query(base::Rect(500, 500, 10, 10), items);
+    $expect(items.empty()).toBeTrue();
+
+    index.update(&small, base::Rect(505, 505, 20, 20));
+    items.clear();
+    index.query(base::Rect(500, 500, 10, 10), items);
+    $expect(items.size()).toBe(1U);
+    $expect(items[0]).toBe(&small);
+
+    index.remove(&small);
+    $expect(index.contains(&small)).toBeFalse();
+    items.clear();
+    index.query(base::Rect(500, 500, 10, 10), items);
+    $expect(items.empty()).toBeTrue();
+  });
+
+  $it("Hit testing follows moved and restacked items", [this]() {
+    mdc::Layer *layer = data->view->get_current_layer();
+
+    for (int i = 0; i < 400; ++i)
+      data->add_figure((i % 20) * 90.0, (i / 20) * 90.0, 60, 60);
+
+    mdc::RectangleFigure *bottom = data->add_figure(1000, 1000, 50, 50);
+    mdc::RectangleFigure *top = data->add_figure(1500, 1500, 50, 50);
+
+    $expect(layer->get_top_item_at(base::Point(1520, 1520))).toBe(top);
+    $expect(layer->get_top_item_at(base::Point(1020, 1020))).toBe(bottom);
+
+    // Move the item so both overlap; the one added last stays on top.
+    top->move_to(base::Point(1010, 1010));
+    $expect(layer->get_top_item_at(base::Point(1520, 1520))).toBe(nullptr);
+    $expect(layer->get_top_item_at(base::Point(1020, 1020))).toBe(top);
+
+    layer->get_root_area_group()->raise_item(bottom);
+    $expect(layer->get_top_item_at(base::Point(1020, 1020))).toBe(bottom);
+
+    layer->remove_item(bottom);
+    $expect(layer->get_top_item_at(base::Point(1020, 1020))).toBe(top);
+  });
+
+  $it("Items in an area are reported in stacking order", [this]() {
+    mdc::Layer *layer = data->view->get_current_layer();
+
+    std::list<mdc::CanvasItem *> expected;
+    for (int i = 0; i < 50; ++i)
+      expected.push_front(data->add_figure(i * 20.0, i * 20.0, 100, 100));
+
+    // Add far away items too, which must not show up.
+    for (int i = 0; i < 50; ++i)
+      data->add_figure(1500 + i, 1500, 10, 10);
+
+    std::list<mdc::CanvasItem *> items = layer->get_items_bounded_by(base::Rect(0, 0, 1200, 1200));
+    $expect(items.size()).toBe(expected.size());
+    $expect(items == expected).toBeTrue();
+  });
+}
+
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "mdc.h"
+#include "mdc_tile_cache.h"
+
+#include "casmine.h"
+
+namespace {
+
+$ModuleEnvironment() {};
+
+$TestData {
+  std::vector<base::Rect> rendered;
+  std::vector<base::Point> painted;
+
+  void paint(mdc::TileCache &cache, const base::Rect &area) {
+    rendered.clear();
+    painted.clear();
+    cache.paint(area, [this](mdc::CairoCtx *, const base::Rect &bounds) { rendered.push_back(bounds); },
+                [this](const base::Point &pos, cairo_surface_t *) { painted.push_back(pos); });
+  }
+};
+
+$describe("mdc tile cache") {
+  $it("Tiles are only rendered when needed", [this]() {
+    mdc::TileCache cache(100, 16);
+
+    data->paint(cache, base::Rect(50, 50, 100, 100));
+    $expect(data->rendered.size()).toBe(4U);
+    $expect(data->painted.size()).toBe(4U);
+    $expect(cache.tile_count()).toBe(4U);
+
+    // Everything is cached now.
+    data->paint(cache, base::Rect(50, 50, 100, 100));
+    $expect(data->rendered.empty()).toBeTrue();
+    $expect(data->painted.size()).toBe(4U);
+
+    // A change in one tile only renders that tile again.
+    cache.invalidate(base::Rect(120, 120, 10, 10));
+    data->paint(cache, base::Rect(50, 50, 100, 100));
+    $expect(data->rendered.size()).toBe(1U);
+    $expect(data->rendered[0] == base::Rect(100, 100, 100, 100)).toBeTrue();
+
+    cache.invalidate();
+    data->paint(cache, base::Rect(0, 0, 50, 50));
+    $expect(data->rendered.size()).toBe(1U);
+  });
+
+  $it("Zooming and scrolling", [this]() {
+    mdc::TileCache cache(100, 4);
+
+    data->paint(cache, base::Rect(0, 0, 150, 150));
+    $expect(cache.tile_count()).toBe(4U);
+
+    // Tiles keep their size in pixels, so at 2x zoom they cover half the canvas area.
+    cache.set_zoom(2.0);
+    $expect(cache.tile_count()).toBe(0U);
+    data->paint(cache, base::Rect(0, 0, 75, 75));
+    $expect(data->rendered.size()).toBe(4U);
+    $expect(data->rendered[3] == base::Rect(50, 50, 50, 50)).toBeTrue();
+
+    // Scrolling away must not grow the cache beyond its limit.
+    data->paint(cache, base::Rect(1000, 1000, 75, 75));
+    $expect(data->rendered.size()).toBe(4U);
+    $expect(cache.tile_count()).toBe(4U);
+  });
+}
+
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <algorithm>
+
+#include "SSHRingBuffer.h"
+
+#include "casmine.h"
+
+namespace {
+
+$ModuleEnvironment() {};
+
+$TestData {
+  // Appends as much of the given text as fits and returns the number of bytes taken.
+  std::size_t write(ssh::RingBuffer &buffer, const std::string &text) {
+    std::size_t written = 0;
+    while (written < text.size() && buffer.writeSize() > 0) {
+      std::size_t count = std::min(buffer.writeSize(), text.size() - written);
+      memcpy(buffer.writePtr(), text.data() + written, count);
+      buffer.commit(count);
+      written += count;
+    }
+    return written;
+  }
+
+  std::string read(ssh::RingBuffer &buffer, std::size_t limit) {
+    std::string result;
+    while (result.size() < limit && buffer.readSize() > 0) {
+      std::size_t count = std::min(buffer.readSize(), limit - result.size());
+      result.append(buffer.readPtr(), count);
+      buffer.consume(count);
+    }
+    return result;
+  }
+};
+
+$describe("SSH tunnel ring buffer") {
+  $it("Takes data until full and gives it back in order", [this]() {
+    ssh::RingBuffer buffer(8);
+    $expect(buffer.empty()).toBeTrue();
+    $expect(buffer.writeSize()).toBe(8U);
+
+    $expect(data->write(buffer, "0123456789")).toBe(8U);
+    $expect(buffer.full()).toBeTrue();
+    $expect(buffer.writeSize()).toBe(0U);
+
+    $expect(data->read(buffer, 100)).toBe("01234567");
+    $expect(buffer.empty()).toBeTrue();
+  });
+
+  $it("Wraps around at the end of its memory", [this]() {
+    ssh::RingBuffer buffer(8);
+    data->write(buffer, "abcdef");
+    $expect(data->read(buffer, 4)).toBe("abcd");
+
+    // The free space is split now: 2 bytes at the end, 4 at the start.
+    $expect(buffer.writeSize()).toBe(2U);
+    $expect(data->write(buffer, "ghijkl")).toBe(6U);
+    $expect(buffer.full()).toBeTrue();
+
+    $expect(buffer.readSize()).toBe(4U);
+    $expect(data->read(buffer, 100)).toBe("efghijkl");
+  });
+
+  $it("Starts over at the front when emptied", [this]() {
+    ssh::RingBuffer buffer(8);
+    data->write(buffer, "abcde");
+    data->read(buffer, 5);
+
+    // An empty buffer offers its whole capacity as one block again.
+    $expect(buffer.writeSize()).toBe(8U);
+
+    data->write(buffer, "xyz");
+    buffer.clear();
+    $expect(buffer.empty()).toBeTrue();
+    $expect(buffer.writeSize()).toBe(8U);
+  });
+}
+
+}
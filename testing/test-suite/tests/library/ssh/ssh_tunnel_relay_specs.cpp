@@ -0,0 +1,348 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef _MSC_VER
+#include <sys/socket.h>
+#endif
+#include <functional>
+
+#include "SSHTunnelRelay.h"
+
+#include "casmine.h"
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace {
+
+static bool wouldBlock() {
+#if _MSC_VER
+  return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+  return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+#endif
+}
+
+// A tunnel channel over one end of a socket pair, the test plays the remote end on the other one.
+// Like the data callback of an ssh channel, activity is reported once and then not again before the relay read
+// everything (or a write which had to wait can be retried).
+class SocketChannel : public ssh::TunnelChannel {
+public:
+  explicit SocketChannel(int socket) : _socket(socket), _event(nullptr), _events(0), _closed(false) {
+  }
+
+  virtual ~SocketChannel() {
+    close();
+  }
+
+  virtual bool attach(ssh_event event, std::function<void()> activity) override {
+    _event = event;
+    _activity = std::move(activity);
+    return update(POLLIN);
+  }
+
+  virtual void detach(ssh_event event) override {
+    update(0);
+    _activity = nullptr;
+  }
+
+  virtual int write(const char *data, std::size_t size) override {
+    errno = 0;
+    ssize_t written = send(_socket, data, size, MSG_NOSIGNAL);
+    if (written >= 0)
+      return (int)written;
+    if (wouldBlock())
+      return update(_events | POLLOUT) ? SSH_AGAIN : SSH_ERROR;
+    _closed = true;
+    return SSH_ERROR;
+  }
+
+  virtual int read(char *buffer, std::size_t size) override {
+    errno = 0;
+    ssize_t count = recv(_socket, buffer, size, 0);
+    if (count > 0)
+      return (int)count;
+    if (count < 0 && wouldBlock())
+      return update(_events | POLLIN) ? SSH_AGAIN : SSH_ERROR;
+    _closed = true;
+    return count == 0 ? 0 : SSH_ERROR;
+  }
+
+  virtual bool isClosed() override {
+    return _closed;
+  }
+
+  virtual bool isEof() override {
+    return _closed;
+  }
+
+  virtual void close() override {
+    if (_socket != -1) {
+      ssh::wbCloseSocket(_socket);
+      _socket = -1;
+    }
+  }
+
+  // The events the channel currently waits for.
+  short events() const {
+    return _events;
+  }
+
+private:
+  bool update(short events) {
+    if (events == _events)
+      return true;
+
+    if (_events != 0)
+      ssh_event_remove_fd(_event, _socket);
+    _events = events;
+    return events == 0 || ssh_event_add_fd(_event, _socket, events, onEvent, this) == SSH_OK;
+  }
+
+  // Returns -1 if the poll handle was replaced, as ssh_event_dopoll() requires.
+  static int onEvent(socket_t fd, int revents, void *userdata) {
+    SocketChannel *channel = static_cast<SocketChannel *>(userdata);
+    short events = channel->_events;
+    if (revents & (POLLIN | POLLHUP | POLLERR))
+      events &= ~POLLIN;
+    if (revents & (POLLOUT | POLLHUP | POLLERR))
+      events &= ~POLLOUT;
+
+    bool replaced = events != channel->_events;
+    channel->update(events);
+    if (channel->_activity)
+      channel->_activity();
+    return replaced ? -1 : 0;
+  }
+
+  int _socket;
+  ssh_event _event;
+  short _events;
+  bool _closed;
+  std::function<void()> _activity;
+};
+
+$ModuleEnvironment() {};
+
+$TestData {
+  static constexpr std::size_t bufferSize = 4096;
+
+  std::unique_ptr<ssh::TunnelRelay> relay;
+  int client = -1;  // The application end of the client connection.
+  int remote = -1;  // The far end of the channel.
+  SocketChannel *channel = nullptr;
+  int tunnel = -1;
+
+  void open() {
+    relay.reset(new ssh::TunnelRelay(bufferSize));
+
+    int clientSockets[2];
+    int channelSockets[2];
+    ssh::TunnelRelay::createSocketPair(clientSockets);
+    ssh::TunnelRelay::createSocketPair(channelSockets);
+    client = clientSockets[0];
+    remote = channelSockets[0];
+    tunnel = clientSockets[1];
+
+    channel = new SocketChannel(channelSockets[1]);
+    relay->addTunnel(tunnel, std::unique_ptr<ssh::TunnelChannel>(channel));
+  }
+
+  void close() {
+    relay.reset();
+    ssh::wbCloseSocket(client);
+    ssh::wbCloseSocket(remote);
+  }
+
+  ssh::TunnelRelay::Status status() {
+    ssh::TunnelRelay::Status result;
+    memset(&result, 0, sizeof(result));
+    relay->getStatus(tunnel, result);
+    return result;
+  }
+
+  // Polls the relay until the condition holds, returns false if that doesn't happen within the given rounds.
+  bool pump(std::function<bool()> condition, int rounds = 1000) {
+    for (int i = 0; i < rounds; ++i) {
+      if (condition())
+        return true;
+      relay->poll(10);
+    }
+    return condition();
+  }
+
+  // Sends until the socket would block and returns the number of bytes sent.
+  std::size_t fill(int socket) {
+    std::string chunk(bufferSize, 'x');
+    std::size_t total = 0;
+    while (true) {
+      ssize_t written = send(socket, chunk.data(), chunk.size(), MSG_NOSIGNAL);
+      if (written <= 0)
+        return total;
+      total += written;
+    }
+  }
+
+  // Reads all that is available.
+  std::string drain(int socket) {
+    std::string result;
+    char buffer[16384];
+    ssize_t count;
+    while ((count = recv(socket, buffer, sizeof(buffer), 0)) > 0)
+      result.append(buffer, count);
+    return result;
+  }
+};
+
+$describe("SSH tunnel relay") {
+  $beforeEach([this]() {
+    data->open();
+  });
+
+  $afterEach([this]() {
+    data->close();
+  });
+
+  $it("Relays data in both directions", [this]() {
+    send(data->client, "request", 7, MSG_NOSIGNAL);
+    std::string received;
+    $expect(data->pump([&]() {
+      received += data->drain(data->remote);
+      return received.size() >= 7;
+    })).toBeTrue();
+    $expect(received).toBe("request");
+
+    send(data->remote, "response", 8, MSG_NOSIGNAL);
+    received.clear();
+    $expect(data->pump([&]() {
+      received += data->drain(data->client);
+      return received.size() >= 8;
+    })).toBeTrue();
+    $expect(received).toBe("response");
+
+    // All is passed on, the tunnel waits for new data from either side.
+    auto status = data->status();
+    $expect(status.pending).toBeFalse();
+    $expect(status.clientReadable).toBeFalse();
+    $expect(status.channelReadable).toBeFalse();
+    $expect(status.toChannel).toBe(0U);
+    $expect(status.toClient).toBe(0U);
+    $expect(status.events).toBe((short)POLLIN);
+    $expect(data->channel->events()).toBe((short)POLLIN);
+  });
+
+  $it("Stops reading from the client while the channel is blocked", [this]() {
+    // Nothing is read from the remote end. Once the socket buffers on the way are full the relay buffer fills up
+    // and the client socket is no longer polled.
+    std::size_t sent = 0;
+    $expect(data->pump([&]() {
+      sent += data->fill(data->client);
+      return data->status().toChannel == data->bufferSize;
+    })).toBeTrue();
+    sent += data->fill(data->client);
+
+    auto status = data->status();
+    $expect(status.toChannel).toBe(data->bufferSize);
+    $expect(status.events & POLLIN).toBe(0);
+    $expect(status.pending).toBeTrue();
+    $expect(data->channel->events() & POLLOUT).toBe((short)POLLOUT);
+
+    // More polls don't change anything.
+    for (int i = 0; i < 5; ++i)
+      data->relay->poll(10);
+    $expect(data->status().toChannel).toBe(data->bufferSize);
+
+    // Once the remote end reads, everything arrives and the client is polled again.
+    std::size_t received = 0;
+    $expect(data->pump([&]() {
+      received += data->drain(data->remote).size();
+      return received == sent;
+    }, 10000)).toBeTrue();
+
+    // A write which had to wait may still be reported as possible, the tunnel is idle after that.
+    data->pump([&]() { return data->channel->events() == POLLIN; }, 10);
+    status = data->status();
+    $expect(status.toChannel).toBe(0U);
+    $expect(status.pending).toBeFalse();
+    $expect(status.events).toBe((short)POLLIN);
+    $expect(data->channel->events()).toBe((short)POLLIN);
+  });
+
+  $it("Stops reading from the channel while the client is blocked", [this]() {
+    std::size_t sent = 0;
+    $expect(data->pump([&]() {
+      sent += data->fill(data->remote);
+      auto status = data->status();
+      return status.toClient > 0 && (status.events & POLLOUT) != 0 && data->channel->events() == 0;
+    })).toBeTrue();
+    sent += data->fill(data->remote);
+
+    // The client doesn't read, so the relay keeps data for it and no longer waits for the channel.
+    auto status = data->status();
+    $expect(status.toClient > 0).toBeTrue();
+    $expect(status.events & POLLOUT).toBe((short)POLLOUT);
+    $expect(status.channelReadable).toBeTrue();
+    $expect(data->channel->events()).toBe((short)0);
+
+    std::size_t buffered = status.toClient;
+    for (int i = 0; i < 5; ++i)
+      data->relay->poll(10);
+    $expect(data->status().toClient).toBe(buffered);
+
+    std::size_t received = 0;
+    $expect(data->pump([&]() {
+      received += data->drain(data->client).size();
+      return received == sent;
+    }, 10000)).toBeTrue();
+
+    // A write which had to wait may still be reported as possible, the tunnel is idle after that.
+    data->pump([&]() { return data->channel->events() == POLLIN; }, 10);
+    status = data->status();
+    $expect(status.toClient).toBe(0U);
+    $expect(status.channelReadable).toBeFalse();
+    $expect(status.events).toBe((short)POLLIN);
+    $expect(data->channel->events()).toBe((short)POLLIN);
+  });
+
+  $it("Closes the tunnel when the client disconnects", [this]() {
+    ssh::wbCloseSocket(data->client);
+    data->client = -1;
+    $expect(data->pump([&]() { return data->relay->tunnelCount() == 0; })).toBeTrue();
+
+    // The channel was closed with it.
+    char c;
+    $expect(data->pump([&]() { return recv(data->remote, &c, 1, 0) == 0; })).toBeTrue();
+  });
+
+  $it("Closes the tunnel when the channel is closed", [this]() {
+    ssh::wbCloseSocket(data->remote);
+    data->remote = -1;
+    $expect(data->pump([&]() { return data->relay->tunnelCount() == 0; })).toBeTrue();
+
+    char c;
+    $expect(data->pump([&]() { return recv(data->client, &c, 1, 0) == 0; })).toBeTrue();
+  });
+}
+
+}
@@ -61,6 +61,24 @@ $TestData {
   }
 };
 
+// Collects the statements it gets as "<object id>: <sql>".
+class StatementCollector : public SQLStatementSink {
+public:
+  std::string statements;
+  std::set<std::string> objectIds;
+
+  virtual void add_statement(const GrtNamedObjectRef &object, const std::string &sql, int flags) override {
+    if ((flags & ImpliedStatement) != 0)
+      return;
+    statements += object.id() + ": " + sql + "\n";
+    objectIds.insert(object.id());
+  }
+
+  virtual bool has_statement(const GrtNamedObjectRef &object) override {
+    return objectIds.count(object.id()) > 0;
+  }
+};
+
 $describe("SQL code generation") {
 
   $beforeAll([this] () {
@@ -464,6 +482,56 @@ $describe("SQL code generation") {
     }
   });
 
+  $it("Generate statements into a sink, sequentially and in parallel", [this]() {
+    ValueRef e;
+    NormalizedComparer cmp;
+    DbObjectMatchAlterOmf omf;
+    cmp.init_omf(&omf);
+
+    casmine::SyntheticMySQLModel model;
+    db_mysql_CatalogRef catalog = model.catalog;
+    for (size_t i = 1; i < 6; ++i) {
+      db_mysql_SchemaRef schema = grt::copy_object(model.schema);
+      schema->name("test_schema" + std::to_string(i));
+      schema->owner(catalog);
+      catalog->schemata().insert(schema);
+    }
+
+    std::shared_ptr<DiffChange> create_change = diff_make(e, catalog, &omf);
+    std::shared_ptr<DiffChange> drop_change = diff_make(catalog, e, &omf);
+
+    for (auto change : { create_change, drop_change }) {
+      grt::StringListRef list(grt::Initialized);
+      grt::ListRef<GrtNamedObject> objects(true);
+      grt::DictRef options(true);
+      options.set("UseFilteredLists", grt::IntegerRef(0));
+      options.set("OutputContainer", list);
+      options.set("OutputObjectContainer", objects);
+      data->diffsqlModule->generateSQL(catalog, options, change);
+
+      std::string expected;
+      for (size_t i = 0; i < list.count(); ++i)
+        expected += objects[i].id() + ": " + *list[i] + "\n";
+      $expect(list.count()).toBeGreaterThan(5U);
+
+      for (ssize_t threads : { 1, 4, 0 }) {
+        StatementCollector sink;
+        options.set("GenerationThreads", grt::IntegerRef(threads));
+        data->diffsqlModule->generateSQL(catalog, options, change, &sink);
+        $expect(sink.statements).toEqual(expected, "statements with " + std::to_string(threads) + " threads");
+      }
+    }
+
+    // Schemas are dropped last to first.
+    grt::StringListRef list(grt::Initialized);
+    grt::DictRef options(true);
+    options.set("UseFilteredLists", grt::IntegerRef(0));
+    options.set("OutputContainer", list);
+    data->diffsqlModule->generateSQL(catalog, options, drop_change);
+    $expect(*list[0]).toContain("DROP SCHEMA IF EXISTS `test_schema5`");
+    $expect(*list[5]).toContain("DROP SCHEMA IF EXISTS `test_schema`");
+  });
+
   $it("Forward engineering after renaming a schema", [this]() {
     ValueRef e;
     std::unique_ptr<sql::Statement> stmt(data->connection->createStatement());
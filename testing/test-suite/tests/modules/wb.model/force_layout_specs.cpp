@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "force_layout.h"
+
+#include "casmine.h"
+
+namespace {
+
+$ModuleEnvironment() {};
+
+$TestData {
+  // Fills the layout with tables of different sizes and random relationships between them, always the same ones.
+  void fillLayout(ForceLayout &layout, std::size_t tables, std::size_t relationships) {
+    unsigned int value = 1;
+    auto next = [&]() {
+      value = value * 1103515245 + 12345;
+      return (value >> 8) % 100000;
+    };
+
+    for (std::size_t i = 0; i < tables; ++i)
+      layout.add_node(0, 0, 150 + next() % 100, 100 + next() % 200);
+    for (std::size_t i = 0; i < relationships; ++i)
+      layout.add_edge(next() % tables, next() % tables);
+  }
+
+  std::size_t countOverlaps(const ForceLayout &layout) {
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < layout.node_count(); ++i) {
+      const ForceLayout::Node &a = layout.node(i);
+      for (std::size_t j = i + 1; j < layout.node_count(); ++j) {
+        const ForceLayout::Node &b = layout.node(j);
+        if (a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height)
+          ++count;
+      }
+    }
+    return count;
+  }
+};
+
+$describe("Force directed autolayout") {
+  $it("Produces the same layout for the same seed, regardless of the thread count", [this]() {
+    ForceLayout single(10000, 10000, 42);
+    ForceLayout multi(10000, 10000, 42);
+    data->fillLayout(single, 600, 1000);
+    data->fillLayout(multi, 600, 1000);
+
+    single.set_thread_count(1);
+    multi.set_thread_count(4);
+    single.run();
+    multi.run();
+
+    bool identical = true;
+    for (std::size_t i = 0; i < single.node_count(); ++i) {
+      if (single.node(i).x != multi.node(i).x || single.node(i).y != multi.node(i).y)
+        identical = false;
+    }
+    $expect(identical).toBeTrue();
+  });
+
+  $it("Keeps pinned nodes in place and moves the others out of their way", [this]() {
+    ForceLayout layout(2000, 2000);
+    std::size_t pinned = layout.add_node(300, 300, 200, 200, true);
+    for (std::size_t i = 0; i < 20; ++i) {
+      std::size_t node = layout.add_node(350, 350, 100, 80);
+      layout.add_edge(pinned, node);
+    }
+    layout.run();
+
+    $expect(layout.node(pinned).x).toBe(300);
+    $expect(layout.node(pinned).y).toBe(300);
+    $expect(data->countOverlaps(layout)).toBe(0U);
+    for (std::size_t i = 0; i < layout.node_count(); ++i) {
+      $expect(layout.node(i).x >= 0).toBeTrue();
+      $expect(layout.node(i).y >= 0).toBeTrue();
+    }
+  });
+
+  $it("Lays out large models without overlaps", [this]() {
+    ForceLayout layout(100000, 100000);
+    data->fillLayout(layout, 2000, 4000);
+    layout.run();
+
+    $expect(data->countOverlaps(layout)).toBe(0U);
+  });
+}
+
+}
@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "wb_model.h"
+
+#include "grts/structs.db.mysql.h"
+#include "interfaces/sqlgenerator.h"
+#include "grtsqlparser/mysql_parser_services.h"
+
+#include "base/file_utilities.h"
+#include "base/string_utilities.h"
+
+#include "casmine.h"
+#include "wb_test_helpers.h"
+
+namespace {
+
+$ModuleEnvironment() {};
+
+$TestData {
+  std::unique_ptr<WorkbenchTester> tester;
+  WbModelImpl *module = nullptr;
+  std::string dataDir;
+  std::string outputDir;
+
+  db_mysql_ColumnRef addColumn(const db_mysql_TableRef &table, const std::string &name, const std::string &type,
+                               int length, bool notNull, const std::string &comment = "") {
+    db_mysql_CatalogRef catalog = db_mysql_CatalogRef::cast_from(tester->getCatalog());
+
+    db_mysql_ColumnRef column(grt::Initialized);
+    column->owner(table);
+    column->name(name);
+    column->simpleType(parsers::MySQLParserServices::findDataType(catalog->simpleDatatypes(), catalog->version(), type));
+    column->length(length);
+    column->isNotNull(notNull ? 1 : 0);
+    column->defaultValueIsNull(notNull ? 0 : 1);
+    column->comment(comment);
+    table->columns().insert(column);
+    return column;
+  }
+
+  db_mysql_IndexRef addIndex(const db_mysql_TableRef &table, const std::string &name, const std::string &type,
+                             const db_mysql_ColumnRef &column) {
+    db_mysql_IndexRef index(grt::Initialized);
+    index->owner(table);
+    index->name(name);
+    index->indexType(type);
+    index->isPrimary(type == "PRIMARY" ? 1 : 0);
+    index->unique(type == "UNIQUE" ? 1 : 0);
+
+    db_mysql_IndexColumnRef indexColumn(grt::Initialized);
+    indexColumn->owner(index);
+    indexColumn->referencedColumn(column);
+    index->columns().insert(indexColumn);
+
+    table->indices().insert(index);
+    if (type == "PRIMARY")
+      table->primaryKey(index);
+    return index;
+  }
+
+  db_mysql_TableRef addTable(const db_mysql_SchemaRef &schema, const std::string &name) {
+    db_mysql_TableRef table(grt::Initialized);
+    table->owner(schema);
+    table->name(name);
+    table->tableEngine("InnoDB");
+    schema->tables().insert(table);
+
+    addIndex(table, "PRIMARY", "PRIMARY", addColumn(table, "id", "INT", -1, true));
+    return table;
+  }
+
+  // Two schemata, with a relationship between two tables of the first one.
+  void fillModel() {
+    db_mysql_CatalogRef catalog = db_mysql_CatalogRef::cast_from(tester->getCatalog());
+    catalog->schemata().remove_all();
+
+    db_mysql_SchemaRef shop(grt::Initialized);
+    shop->owner(catalog);
+    shop->name("shop");
+    catalog->schemata().insert(shop);
+
+    db_mysql_TableRef customer = addTable(shop, "customer");
+    addColumn(customer, "name", "VARCHAR", 45, true, "Full name");
+
+    db_mysql_TableRef purchase = addTable(shop, "purchase");
+    db_mysql_ColumnRef customerId = addColumn(purchase, "customer_id", "INT", -1, true);
+    addColumn(purchase, "note", "VARCHAR", 100, false, "Notes & remarks");
+    addIndex(purchase, "fk_purchase_customer_idx", "INDEX", customerId);
+
+    db_mysql_ForeignKeyRef fk(grt::Initialized);
+    fk->owner(purchase);
+    fk->name("fk_purchase_customer");
+    fk->referencedTable(customer);
+    fk->columns().insert(customerId);
+    fk->referencedColumns().insert(customer->columns()[0]);
+    purchase->foreignKeys().insert(fk);
+
+    db_mysql_SchemaRef staff(grt::Initialized);
+    staff->owner(catalog);
+    staff->name("staff");
+    catalog->schemata().insert(staff);
+
+    db_mysql_TableRef employee = addTable(staff, "employee");
+    addIndex(employee, "email_UNIQUE", "UNIQUE", addColumn(employee, "email", "VARCHAR", 100, true, "<work> address"));
+  }
+
+  void generateReport(const std::string &templateName, const std::string &styleName, const std::string &path,
+                      bool showDdl = false) {
+    grt::DictRef options(true);
+    options.set("template_name", grt::StringRef(templateName));
+    options.set("template_style_name", grt::StringRef(styleName));
+    options.set("title", grt::StringRef("model_report"));
+    options.set("output_path", grt::StringRef(path));
+    options.set("show_ddl", grt::IntegerRef(showDdl ? 1 : 0));
+
+    $expect(module->generateReport(tester->getPmodel(), options)).toEqual(1, templateName);
+  }
+
+  // The contents of all <pre> blocks of the file, in order.
+  std::vector<std::string> preformattedBlocks(const std::string &file) {
+    std::string content = base::getTextFileContent(file);
+    std::vector<std::string> blocks;
+    for (std::size_t start = content.find("<pre>"); start != std::string::npos; start = content.find("<pre>", start)) {
+      start += 5;
+      std::size_t end = content.find("</pre>", start);
+      if (end == std::string::npos)
+        break;
+      blocks.push_back(content.substr(start, end - start));
+    }
+    return blocks;
+  }
+
+  void compareToBaseline(const std::string &path, const std::string &baseline, const std::string &file) {
+    std::string expected = base::getTextFileContent(base::makePath(baseline, file));
+    $expect(expected.empty()).toBeFalse("baseline " + file);
+    $expect(base::getTextFileContent(base::makePath(path, file))).toEqual(expected, file);
+  }
+};
+
+$describe("Model reporting") {
+  $beforeAll([this]() {
+    data->dataDir = casmine::CasmineContext::get()->tmpDataDir() + "/reporting/model_report";
+    data->outputDir = casmine::CasmineContext::get()->outputDir();
+
+    data->tester.reset(new WorkbenchTester());
+    data->tester->initializeRuntime();
+
+    data->module = grt::GRT::get()->get_native_module<WbModelImpl>();
+    $expect(data->module).Not.toBeNull("WbModel module initialization");
+  });
+
+  $afterAll([this]() {
+    data->tester.reset();
+    WorkbenchTester::reinitGRT();
+  });
+
+  $it("Single file report of a model with several schemata matches the baseline", [this]() {
+    data->tester->createNewDocument();
+    data->fillModel();
+
+    std::string path = data->outputDir + "/model_report_text";
+    data->generateReport("Text Basic", "", path);
+    data->compareToBaseline(path, data->dataDir + "/Text_Basic", "model_report.txt");
+
+    data->tester->wb->close_document();
+    data->tester->wb->close_document_finish();
+  });
+
+  $it("Report with a file per template of a model with several schemata matches the baseline", [this]() {
+    data->tester->createNewDocument();
+    data->fillModel();
+
+    std::string path = data->outputDir + "/model_report_html";
+    data->generateReport("HTML Basic Frames", "Colorful", path);
+    for (auto file : { "index.html", "overview.html", "table_details.html" })
+      data->compareToBaseline(path, data->dataDir + "/HTML_Basic_Frames", file);
+    $expect(base::file_exists(base::makePath(path, "basic.css"))).toBeTrue();
+    $expect(base::file_exists(base::makePath(path, "restrained.css"))).toBeTrue();
+
+    data->tester->wb->close_document();
+    data->tester->wb->close_document_finish();
+  });
+
+  $it("DDL scripts in a report match the ones generated per object", [this]() {
+    data->tester->createNewDocument();
+    data->fillModel();
+
+    std::string path = data->outputDir + "/model_report_ddl";
+    data->generateReport("HTML Detailed Frames", "Vibrant", path, true);
+
+    // The baseline is what the report showed before the DDL of the entire catalog was generated in one go:
+    // the script of each object on its own, with the line breaks made HTML.
+    SQLGeneratorInterfaceImpl *sqlgenModule =
+      dynamic_cast<SQLGeneratorInterfaceImpl *>(grt::GRT::get()->get_module("DbMySQL"));
+    $expect(sqlgenModule).Not.toBeNull("DbMySQL module");
+
+    std::vector<std::string> expected;
+    db_mysql_CatalogRef catalog = db_mysql_CatalogRef::cast_from(data->tester->getCatalog());
+    for (auto schema : catalog->schemata()) {
+      expected.push_back(base::replaceString(sqlgenModule->makeCreateScriptForObject(schema), "\n", "<br />"));
+      for (auto table : schema->tables())
+        expected.push_back(base::replaceString(sqlgenModule->makeCreateScriptForObject(table), "\n", "<br />"));
+    }
+
+    std::vector<std::string> blocks = data->preformattedBlocks(base::makePath(path, "table_details.html"));
+    $expect(blocks.size()).toBe(expected.size());
+    for (std::size_t i = 0; i < expected.size() && i < blocks.size(); ++i) {
+      $expect(expected[i].empty()).toBeFalse("DDL of object " + std::to_string(i));
+      $expect(blocks[i]).toEqual(expected[i], "DDL of object " + std::to_string(i));
+    }
+
+    data->tester->wb->close_document();
+    data->tester->wb->close_document_finish();
+  });
+}
+
+}
@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2019, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License, version 2.0,
+ * as published by the Free Software Foundation.
+ *
+ * This program is also distributed with certain software (including
+ * but not limited to OpenSSL) that is licensed under separate terms, as
+ * designated in a particular file or component or in included license
+ * documentation.  The authors of MySQL hereby grant you an additional
+ * permission to link the program and your derivative works with the
+ * separately licensed software that they have included with MySQL.
+ * This program is distributed in the hope that it will be useful,  but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See
+ * the GNU General Public License, version 2.0, for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+#include "base/string_utilities.h"
+#include "DbSearch.h"
+
+#include "casmine.h"
+#include "wb_test_helpers.h"
+#include "wb_connection_helpers.h"
+
+namespace {
+
+$ModuleEnvironment() {};
+
+$TestData {
+  std::unique_ptr<WorkbenchTester> tester;
+  db_mgmt_ConnectionRef connectionProperties;
+
+  sql::ConnectionWrapper connect() {
+    return sql::DriverManager::getDriverManager()->getConnection(connectionProperties);
+  }
+
+  std::shared_ptr<DBSearch> createSearch(size_t connectionCount, const std::string &filter) {
+    std::vector<sql::ConnectionWrapper> connections;
+    for (size_t i = 0; i < connectionCount; ++i)
+      connections.push_back(connect());
+
+    grt::StringListRef filters(grt::Initialized);
+    filters.insert(filter);
+    db_mgmt_ConnectionRef properties = connectionProperties;
+    return std::make_shared<DBSearch>(
+      connections, [properties]() { return sql::DriverManager::getDriverManager()->getConnection(properties); },
+      "needle", filters, Contains, 0, 0, false, search_all_types, "CHAR");
+  }
+
+  static std::vector<DBSearch::SearchResultEntry> byPosition(std::vector<DBSearch::SearchResultEntry> results) {
+    std::sort(results.begin(), results.end(),
+              [](const DBSearch::SearchResultEntry &a, const DBSearch::SearchResultEntry &b) {
+                return a.position < b.position;
+              });
+    return results;
+  }
+
+  void fillTable(sql::Statement *stmt, const std::string &table, int rows, int matchEvery) {
+    stmt->execute("CREATE TABLE " + table + " (id INT PRIMARY KEY, name VARCHAR(40), amount INT)");
+    std::string insert = "INSERT INTO " + table + " VALUES ";
+    for (int i = 1; i <= rows; ++i) {
+      if (i > 1)
+        insert += ", ";
+      std::string name = (matchEvery > 0 && i % matchEvery == 0) ? "has a needle in it" : "hay";
+      insert += base::strfmt("(%i, '%s', %i)", i, name.c_str(), i * 10);
+    }
+    stmt->execute(insert);
+  }
+};
+
+$describe("DB search") {
+  $beforeAll([this]() {
+    data->tester.reset(new WorkbenchTester());
+    data->connectionProperties = db_mgmt_ConnectionRef(grt::Initialized);
+    setupConnectionEnvironment(data->connectionProperties);
+
+    sql::ConnectionWrapper connection = data->connect();
+    $expect(connection.get()).Not.toBeNull("Couldn't get a connection from driver");
+
+    std::unique_ptr<sql::Statement> stmt(connection->createStatement());
+    stmt->execute("DROP SCHEMA IF EXISTS db_search_test");
+    stmt->execute("CREATE SCHEMA db_search_test");
+    stmt->execute("USE db_search_test");
+    data->fillTable(stmt.get(), "large", 3000, 7);
+    data->fillTable(stmt.get(), "medium", 400, 9);
+    data->fillTable(stmt.get(), "small", 3, 2);
+    data->fillTable(stmt.get(), "nothing", 50, 0);
+    data->fillTable(stmt.get(), "tiny", 1, 1);
+
+    // Fixed statistics, so that both searches hand out the tables in the same order.
+    stmt->execute("ANALYZE TABLE large, medium, small, nothing, tiny");
+  });
+
+  $afterAll([this]() {
+    sql::ConnectionWrapper connection = data->connect();
+    std::unique_ptr<sql::Statement> stmt(connection->createStatement());
+    stmt->execute("DROP SCHEMA IF EXISTS db_search_test");
+  });
+
+  $it("Finds the same rows in the same order with one and with several connections", [this]() {
+    std::shared_ptr<DBSearch> sequential = data->createSearch(1, "db_search_test");
+    sequential->search();
+
+    std::shared_ptr<DBSearch> parallel = data->createSearch(4, "db_search_test");
+    parallel->search();
+
+    $expect(sequential->is_working()).toBeFalse();
+    $expect(parallel->is_working()).toBeFalse();
+    $expect(sequential->searched_table_count()).toBe(5);
+    $expect(parallel->searched_table_count()).toBe(5);
+    $expect(sequential->matched_rows()).toBe(3000 / 7 + 400 / 9 + 3 / 2 + 1);
+    $expect(parallel->matched_rows()).toBe(sequential->matched_rows());
+
+    // One connection searches the tables in the order they are handed out, the biggest first.
+    $expect(sequential->search_results().size()).toBe(4U);
+    if (!sequential->search_results().empty())
+      $expect(sequential->search_results().front().table).toBe("large");
+
+    // Several connections finish them in any order, the positions sort them by name.
+    std::vector<DBSearch::SearchResultEntry> expected = data->byPosition(sequential->search_results());
+    std::vector<DBSearch::SearchResultEntry> results = data->byPosition(parallel->search_results());
+    std::vector<std::string> names;
+    for (auto &entry : expected)
+      names.push_back(entry.table);
+    $expect(names == std::vector<std::string>({"large", "medium", "small", "tiny"})).toBeTrue();
+    $expect(results.size()).toBe(expected.size());
+    for (size_t i = 0; i < std::min(results.size(), expected.size()); ++i) {
+      $expect(results[i].schema).toBe(expected[i].schema);
+      $expect(results[i].table).toBe(expected[i].table);
+      $expect(results[i].query).toBe(expected[i].query);
+      $expect(results[i].keys == expected[i].keys).toBeTrue("keys of " + expected[i].table);
+      $expect(results[i].data == expected[i].data).toBeTrue("rows of " + expected[i].table);
+    }
+  });
+
+  $it("Cancels running queries when stopped", [this]() {
+    // Keeps the search queries for this table waiting on the server until they are killed.
+    sql::ConnectionWrapper locker = data->connect();
+    std::unique_ptr<sql::Statement> stmt(locker->createStatement());
+    stmt->execute("LOCK TABLES db_search_test.large WRITE");
+
+    std::shared_ptr<DBSearch> search = data->createSearch(2, "db_search_test");
+    search->prepare();
+    std::thread searchThread([search]() {
+      try {
+        search->search();
+      } catch (...) {
+      }
+    });
+
+    bool blocked = false;
+    for (int i = 0; i < 1000 && !blocked; ++i) {
+      std::unique_ptr<sql::ResultSet> rs(stmt->executeQuery(
+        "SELECT COUNT(*) FROM information_schema.PROCESSLIST WHERE STATE = 'Waiting for table metadata lock'"));
+      blocked = rs->next() && rs->getInt(1) > 0;
+      if (!blocked)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    $expect(blocked).toBeTrue("search query did not start");
+
+    // The other connection searches all the other tables meanwhile, their results don't wait for the
+    // blocked one.
+    size_t published = 0;
+    for (int i = 0; i < 1000 && published < 3; ++i) {
+      {
+        base::MutexLock lock(search->get_search_result_mutex());
+        published = search->search_results().size();
+      }
+      if (published < 3)
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    $expect(published).toBe(3U);
+
+    search->stop();
+    $expect(search->is_working()).toBeFalse();
+    $expect(search->get_state()).toBe("Cancelled");
+
+    stmt->execute("UNLOCK TABLES");
+    searchThread.join();
+
+    for (auto &entry : search->search_results())
+      $expect(entry.table).Not.toBe("large");
+  });
+}
+
+}